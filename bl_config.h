@@ -96,6 +96,27 @@
 //*****************************************************************************
 #define VTABLE_START_ADDRESS    0x8000
 
+//*****************************************************************************
+//
+// The address in SRAM at which the boot loader leaves the number of processor
+// cycles from reset to the branch to the application, as counted by the DWT
+// cycle counter, which it starts at reset.  An application or a debugger can
+// read it from there to compare the boot time of different configurations.
+// The count is in cycles of the precision internal oscillator unless the
+// boot loader has run an update first.  When none of BL_CHECK_UPDATE_FN_HOOK,
+// BL_HW_INIT_FN_HOOK, CHECK_CRC, CHECK_SIGNATURE and ENABLE_UPDATE_CHECK are
+// defined, the reset handler checks the application's vector table before
+// copying the boot loader to SRAM and so reaches a valid application in a
+// few tens of cycles.  The application must keep this word out of its stack
+// and data.
+//
+// Depends on: None
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define BOOT_CYCLES_ADDRESS     0x2003ff18
+
 //*****************************************************************************
 //
 // The size of a single, erasable page in the flash.  This must be a power
@@ -122,6 +143,68 @@
 //*****************************************************************************
 //#define FLASH_RSVD_SPACE        0x00000800
 
+//*****************************************************************************
+//
+// The address of the flash used for the progress journal.  If this is
+// defined, the boot loader records its progress through each download in a
+// journal that fills one erasable region of flash (16 KB on TM4C129 devices)
+// at this address, and accepts a resume command (a write to register 0x6009
+// with the parameters of the download command) that carries on an
+// interrupted download from the last point recorded instead of erasing the
+// image and starting again.  This survives both a lost link and a reset.  The
+// journal must lie outside the boot loader and the images downloaded, for
+// example in the reserved space at the top of flash; downloads that would
+// overwrite it are refused.
+//
+// Depends on: None
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define FLASH_JOURNAL_ADDRESS   0x000fc000
+
+//*****************************************************************************
+//
+// The byte offset in the EEPROM of the flash erase counters.  If this is
+// defined, the boot loader keeps a 16 bit count of the erases of every
+// erasable block of flash in the EEPROM (WEAR_EEPROM_SIZE bytes from this
+// offset, 128 bytes on TM4C129 devices), and skips erasing any block that
+// already reads as erased, which neither wears it nor takes any time.  A read
+// of register 0x600D returns the counters (see bl_commands.h).  A new boot
+// loader staged by BL_UPDATE_STAGED is placed wherever in the application
+// region the blocks have been erased least, rather than always at
+// APP_START_ADDRESS.  This must be a multiple of 4.
+//
+// Depends on: None
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define FLASH_WEAR_EEPROM_ADDRESS 0x00000000
+
+//*****************************************************************************
+//
+// The byte offset and size in the EEPROM of the boot loader's key/value
+// store.  If these are defined, the boot loader keeps state that has to
+// survive a reset, such as the number of downloads completed, as small
+// values of up to four words under numbered keys (see bl_meta.h).  Each
+// update appends a single record, written with one EEPROMProgram() call, to
+// a log in one half of the region, and an index built in SRAM when the store
+// is first used finds the latest record of a key without a search.  Once a
+// half is full, the latest records are copied to the other half, so the
+// size must leave room in each half for one record of every key (at least
+// 0x280 bytes).  The offset must be a multiple of 4 and the size a multiple
+// of 8, and the region must not overlap the erase counters of
+// FLASH_WEAR_EEPROM_ADDRESS.
+//
+// Depends on: None
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define META_EEPROM_ADDRESS     0x00000200
+//#define META_EEPROM_SIZE        0x00000300
+
 //*****************************************************************************
 //
 // The number of words of stack space to reserve for the boot loader.
@@ -152,7 +235,7 @@
 // Enables updates to the boot loader.  Updating the boot loader is an unsafe
 // operation since it is not fully fault tolerant (losing power to the device
 // part way through could result in the boot loader no longer being present in
-// flash).
+// flash).  BL_UPDATE_STAGED makes it safe.
 //
 // Depends on: None
 // Exclusive of: None
@@ -161,6 +244,33 @@
 //*****************************************************************************
 //#define ENABLE_BL_UPDATE
 
+//*****************************************************************************
+//
+// Stages updates to the boot loader instead of erasing it in place.  If this
+// is defined, a download to address 0, which must be no larger than
+// APP_START_ADDRESS, is programmed into the application region instead, and
+// the boot loader is left untouched while it is transferred.  Once it has
+// all been received, the host sends its SHA-256 digest to register 0x600B
+// (see bl_commands.h).  If that matches the staged copy read back from flash
+// and the copy has a plausible vector table, the boot loader replies, then
+// copies it over itself using the flash write buffer and resets.
+//
+// The copy takes a few hundred milliseconds, rather than the whole transfer,
+// and is ordered so that losing power part way through cannot leave a broken
+// boot loader to run.  The block holding the vector table is erased first,
+// so that the ROM boot loader runs at reset (the reset vector reads as
+// 0xFFFFFFFF), and the first two words of the vector table are programmed
+// last, after the staged copy has been erased so that it is not mistaken for
+// an application.  The application itself must be downloaded again once the
+// new boot loader is running.
+//
+// Depends on: ENABLE_BL_UPDATE
+// Exclusive of: None
+// Requires: IMAGE_DIGEST
+//
+//*****************************************************************************
+//#define BL_UPDATE_STAGED
+
 //*****************************************************************************
 //
 // Enables runtime and download CRC32 checking of the main firmware image.
@@ -177,9 +287,9 @@
 //
 // Note that firmware images intended for use with CRC checking must have been
 // built with an 8 word image header appended to the top of the vector table
-// and the binary must have been processed by a tool such as tools/binpack.exe
-// to ensure that the required length (3rd word) and CRC32 (4th word) fields
-// are populated in the header.
+// and the binary must have been processed by a tool such as tools/blpack (or
+// TI's tools/binpack.exe) to ensure that the required length (3rd word) and
+// CRC32 (4th word) fields are populated in the header.
 //
 // Depends on: ENFORCE_CRC
 // Exclusive of: None
@@ -203,6 +313,100 @@
 //*****************************************************************************
 //#define ENFORCE_CRC
 
+//*****************************************************************************
+//
+// This definition makes the boot loader compute a SHA-256 digest of each
+// image as it is downloaded, reading every block back from flash once it has
+// been programmed, and answer a read of register 0x6004 with the digest of
+// the image so far.  With CRYPTO_ENABLE_HW the blocks are streamed from
+// flash through the SHA/MD5 module by the uDMA controller; otherwise a
+// compact software SHA-256 is used instead.
+//
+// Depends on: None
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define IMAGE_DIGEST
+
+//*****************************************************************************
+//
+// Enables manifest sessions, which update several regions of flash, such as
+// the application and the parameter block reserved by FLASH_RSVD_SPACE, in
+// one download.  The host sends a manifest listing the start, size and
+// SHA-256 digest of each region to register 0x600C (see bl_commands.h) in
+// place of the download command.  The boot loader erases all of the regions
+// at once, takes their data as one stream of blocks, and checks the digest
+// of every region, read back from flash, once the last block is programmed.
+//
+// Depends on: None
+// Exclusive of: None
+// Requires: IMAGE_DIGEST
+//
+//*****************************************************************************
+//#define ENABLE_MANIFEST_UPDATE
+
+//*****************************************************************************
+//
+// Enables checking that the main firmware image is signed before it is run.
+// If this is defined, the boot loader computes the SHA-256 digest of the
+// image, from its start to the length given by its image information header
+// (see CHECK_CRC), and checks the ECDSA signature over the NIST P-256 curve
+// that follows the image in flash, as 64 bytes holding r and s, big-endian,
+// against the public key given by SIGN_PUBLIC_KEY.  An image that has no
+// header or is not signed by the matching private key is not run, and the
+// boot loader retains control and waits for a new download.  tools/blpack
+// signs images with its -s option.
+//
+// The signature check takes around 5,000 multiplications of 256-bit values,
+// which is a noticeable delay at the clock that the device starts with, on
+// top of the time to hash the image.  With CRYPTO_ENABLE_HW the image is
+// hashed by the SHA/MD5 module, and with SIGN_CACHE_ADDRESS the signature is
+// only verified again when the image has changed.
+//
+// Depends on: None
+// Exclusive of: BL_CHECK_UPDATE_FN_HOOK
+// Requires: SIGN_PUBLIC_KEY
+//
+//*****************************************************************************
+//#define CHECK_SIGNATURE
+
+//*****************************************************************************
+//
+// The public key used by CHECK_SIGNATURE, as a list of sixteen words that
+// hold the x and then the y coordinate of the point, each most significant
+// word first, so that the key is written as the 128 hex digits that follow
+// the 04 of its uncompressed form.  "blpack -K <key.pem>" prints this
+// definition, split over several lines, for the key used to sign images.
+//
+// Depends on: CHECK_SIGNATURE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define SIGN_PUBLIC_KEY         MY_SIGN_PUBLIC_KEY_WORDS
+
+//*****************************************************************************
+//
+// The address of the flash used to remember which image has been verified
+// by CHECK_SIGNATURE.  If this is defined, the boot loader records the
+// SHA-256 digest of each image that passes the check in one erasable region
+// of flash (16 KB on TM4C129 devices) at this address.  The image is still
+// hashed at every reset, but the ECDSA verification, which takes most of the
+// time, is skipped if the digest matches the one recorded, so an image that
+// has been changed in any way is always checked in full.  The record is also
+// cleared whenever the boot loader is entered to perform an update, by any
+// transport.  As with FLASH_JOURNAL_ADDRESS, the region must lie outside the
+// boot loader and the images downloaded; downloads that would overwrite it
+// are refused.
+//
+// Depends on: CHECK_SIGNATURE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define SIGN_CACHE_ADDRESS      0x000f8000
+
 //*****************************************************************************
 //
 // This definition will cause the the boot loader to erase the entire flash on
@@ -233,6 +437,57 @@
 //*****************************************************************************
 //#define ENABLE_DECRYPTION
 
+//*****************************************************************************
+//
+// Makes the DecryptData() function called by ENABLE_DECRYPTION decrypt the
+// downloaded data with AES-128 in the mode given, which is either
+// AES_CFG_MODE_CTR or AES_CFG_MODE_CBC from driverlib/aes.h.  The key is
+// given by DECRYPT_AES_KEY, and the host writes the initial counter block or
+// IV of each download to register 0x600A after the download command (see
+// bl_commands.h).  In CBC mode the image must be padded to a multiple of 16
+// bytes before it is encrypted.  With CRYPTO_ENABLE_HW the AES module
+// decrypts the data, fed by the uDMA controller, and in CTR mode generates
+// the key stream for each block while the one before it is being programmed;
+// otherwise a compact software AES is used instead.
+//
+// Depends on: ENABLE_DECRYPTION
+// Exclusive of: BL_DECRYPT_FN_HOOK
+// Requires: DECRYPT_AES_KEY
+//
+//*****************************************************************************
+//#define DECRYPT_AES_MODE        AES_CFG_MODE_CTR
+
+//*****************************************************************************
+//
+// The AES-128 key used by DECRYPT_AES_MODE, as a list of four words that
+// hold its bytes in order, most significant byte first, so that the key is
+// written as the 32 hex digits that it is usually given as.  The key is held
+// in the boot loader's flash, so the boot loader should be protected from
+// being read back by a debugger.
+//
+// Depends on: DECRYPT_AES_MODE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define DECRYPT_AES_KEY         0x2b7e1516, 0x28aed2a6, 0xabf71588, 0x09cf4f3c
+
+//*****************************************************************************
+//
+// Lets IMAGE_DIGEST, CHECK_SIGNATURE and DECRYPT_AES_MODE use the SHA/MD5 and
+// AES modules of the TM4C129 devices that have them, fed by the uDMA
+// controller, in place of their software versions.  Only define this for a
+// device with these modules; the devices without them still report the CRC
+// module that shares their peripheral as present, so the boot loader cannot
+// tell at run time.
+//
+// Depends on: IMAGE_DIGEST, CHECK_SIGNATURE or DECRYPT_AES_MODE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define CRYPTO_ENABLE_HW
+
 //*****************************************************************************
 //
 // Enables support for the MOSCFAIL handler in the NMI interrupt.
@@ -346,10 +601,14 @@
 //*****************************************************************************
 //
 // Selects the UART as the port for communicating with the boot loader.
+// This may be enabled together with SSI_ENABLE_UPDATE, in which case both
+// ports are polled and the boot loader uses whichever one delivers the first
+// valid packet for the rest of the update.  The pins of the two ports must
+// not overlap.
 //
 // Depends on: None
 // Exclusive of: CAN_ENABLE_UPDATE, ENET_ENABLE_UPDATE, I2C_ENABLE_UPDATE,
-//               SSI_ENABLE_UPDATE, USB_ENABLE_UPDATE
+//               USB_ENABLE_UPDATE
 // Requires: UART_AUTOBAUD or UART_FIXED_BAUDRATE, UART_CLOCK_ENABLE, 
 //           UARTx_BASE, UART_RXPIN_CLOCK_ENABLE, UART_RXPIN_BASE, 
 //           UART_RXPIN_PCTL, UART_RXPIN_POS, UART_TXPIN_CLOCK_ENABLE,
@@ -381,6 +640,28 @@
 //*****************************************************************************
 #define UART_FIXED_BAUDRATE     115200
 
+//*****************************************************************************
+//
+// The address in SRAM of a handoff (see boot_loader/bl_handoff.h) through
+// which an application that enters the boot loader via the SVCall vector
+// passes its system clock frequency, UART base and baud rate.  If this is
+// defined and a valid handoff for UARTx_BASE is found there, the boot loader
+// takes the clock frequency as it is and keeps using the UART without
+// reprogramming either, so it is ready for the next packet within
+// microseconds and the host does not have to reconnect; a UART that the
+// application has left disabled is set up at the handed-off baud rate.  If
+// no valid handoff is found, the clock and UART are configured as they are
+// after a reset.  The application must keep these 20 bytes out of its stack
+// and data, and may fill them in from BL_REINIT_FN_HOOK, which is called
+// first.
+//
+// Depends on: UART_ENABLE_UPDATE
+// Exclusive of: CAN_ENABLE_UPDATE, ENET_ENABLE_UPDATE, USB_ENABLE_UPDATE
+// Requires: None
+//
+//*****************************************************************************
+//#define BL_HANDOFF_ADDRESS      0x2003ff00
+
 //*****************************************************************************
 //
 // Selects the clock enable for the UART peripheral module
@@ -491,13 +772,143 @@
 //*****************************************************************************
 #define UART_TXPIN_POS     1
 
+//*****************************************************************************
+//
+// The longest idle gap, in milliseconds, allowed between two bytes of the
+// same packet.  If the line stays idle for longer than this part way through
+// a packet, the partial packet is discarded and the boot loader goes back to
+// hunting for the start of the next one, so the host only has to retransmit
+// the damaged packet.  This must comfortably exceed any latency added by the
+// host's serial adapter.
+//
+// Depends on: UART_ENABLE_UPDATE or SSI_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: BL_TIMER_BASE and BL_TIMER_CLOCK_ENABLE
+//
+//*****************************************************************************
+#define UART_RX_TIMEOUT     20
+
+//*****************************************************************************
+//
+// Selects the base address of the general purpose timer used to time out
+// partially received packets.
+//
+// Depends on: UART_ENABLE_UPDATE or SSI_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: BL_TIMER_CLOCK_ENABLE
+//
+//*****************************************************************************
+#define BL_TIMER_BASE     TIMER0_BASE
+
+//*****************************************************************************
+//
+// Selects the clock enable for the timer used to time out partially received
+// packets.
+//
+// Depends on: UART_ENABLE_UPDATE or SSI_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: BL_TIMER_BASE
+//
+//*****************************************************************************
+#define BL_TIMER_CLOCK_ENABLE     SYSCTL_RCGCTIMER_R0
+
+//*****************************************************************************
+//
+// The time, in milliseconds, that an update session may go without progress
+// before the watchdog resets the microcontroller.  If this is defined, the
+// first packet received intact starts watchdog 0, and every later packet
+// received intact, and every page erased for a download, feeds it; waiting
+// for the host does not.  A host that disappears part way through an update
+// then leaves the device reset within this time instead of waiting for it
+// forever: the application runs if it is still intact, and otherwise the
+// boot loader waits for the host to start again.  With FLASH_JOURNAL_ADDRESS
+// the boot loader also keeps control at reset while the journal holds an
+// unfinished download of the application, whose first blocks may already
+// look like a valid image, so that the host can resume it.  The time must
+// exceed the longest single command, such as a signature check, and may be
+// at most 60000.
+//
+// Depends on: UART_ENABLE_UPDATE or SSI_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define BL_WATCHDOG_TIMEOUT     2000
+
+//*****************************************************************************
+//
+// Enables checking of the CRC16 that terminates every received packet.  The
+// CRC uses the 0xA001 (reflected 0x8005) polynomial with an initial value of
+// 0xFFFF, covers every byte from the ID byte up to the end of the payload and
+// is transmitted most significant byte first.  Packets that fail the check
+// are silently discarded and the host retransmits them once its response
+// timeout expires.  The original protocol ends every packet with a fixed
+// 0x11, 0x22, as the boot loader's ACKs still do, and the vendor host tool
+// may send the same, so this is left undefined.  Without it a damaged data
+// packet is programmed as it was received, so define it whenever the host
+// tool in use computes the CRC, as blupdate does, and always on a shared bus.
+//
+// Depends on: UART_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define CHECK_PACKET_CRC
+
+//*****************************************************************************
+//
+// Enables reading flash back over the update port.  A read of register
+// 0x600E (see bl_commands.h) streams a region of flash to the host in frames
+// of up to DUMP_FRAME_SIZE bytes, each with its own CRC16, sent back to back
+// without waiting for the host, so that a unit can be verified or its image
+// pulled without a debugger.  A region that runs off the end of flash or
+// into a block marked execute-only is refused, and every read is refused if
+// FLASH_CODE_PROTECTION is defined.
+//
+// Depends on: UART_ENABLE_UPDATE or SSI_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define ENABLE_FLASH_DUMP
+
+//*****************************************************************************
+//
+// Gives this node an address on a multi-drop (RS-485) bus so that a whole bus
+// segment can be updated in one pass.  Only packets whose ID byte matches
+// this address or UART_BROADCAST_ID are accepted, and responses start with
+// this address instead of 0x21.  Broadcast packets are acted on without a
+// response; the host instead broadcasts sequenced data packets (0x6007) and
+// polls each node's progress (a read of 0x6005) to find and resend any block
+// a node has missed.  CHECK_PACKET_CRC should be enabled on a shared bus.
+//
+// Depends on: UART_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define UART_NODE_ID     0x21
+
+//*****************************************************************************
+//
+// The ID byte of packets broadcast to every node on the bus.  This defaults
+// to 0x00 and must differ from UART_NODE_ID.
+//
+// Depends on: UART_NODE_ID
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define UART_BROADCAST_ID     0x00
+
 //*****************************************************************************
 //
 // Selects the SSI port as the port for communicating with the boot loader.
+// This may be enabled together with UART_ENABLE_UPDATE.
 //
 // Depends on: None
 // Exclusive of: CAN_ENABLE_UPDATE, ENET_ENABLE_UPDATE, I2C_ENABLE_UPDATE,
-//               UART_ENABLE_UPDATE, USB_ENABLE_UPDATE
+//               USB_ENABLE_UPDATE
 // Requires: SSI_CLOCK_ENABLE, SSIx_BASE, SSI_CLKPIN_CLOCK_ENABLE, 
 //           SSI_CLKPIN_BASE, SSI_CLKPIN_PCTL, SSI_CLKPIN_POS, 
 //           SSI_FSSPIN_CLOCK_ENABLE, SSI_FSSPIN_BASE, SSI_FSSPIN_PCTL,
@@ -706,6 +1117,102 @@
 //*****************************************************************************
 //#define SSI_MOSIPIN_POS          4
 
+//*****************************************************************************
+//
+// Enables receiving packet payloads from the SSI port by uDMA.  The receive
+// FIFO is only eight entries deep, so at the faster SSI clock rates the
+// processor may not keep up with every byte on its own.
+//
+// Depends on: SSI_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: SSI_RX_DMA_CHANNEL
+//
+//*****************************************************************************
+//#define SSI_ENABLE_DMA
+
+//*****************************************************************************
+//
+// Selects the uDMA channel assignment of the SSI receive channel, as one of
+// the UDMA_CHn_SSIxRX values in driverlib/udma.h.
+//
+// Depends on: SSI_ENABLE_DMA
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define SSI_RX_DMA_CHANNEL          UDMA_CH10_SSI0RX
+
+//*****************************************************************************
+//
+// Selects the clock enable for the GPIO used as the ready/busy handshake
+// output.  The output is driven high while the boot loader is waiting for a
+// packet or has a response for the host to clock out, and low otherwise.  The
+// host waits for it to be high before clocking each packet or response and
+// must not clock data while it is low, which keeps the host from overrunning
+// the boot loader while it erases or programs the flash.
+//
+// Depends on: SSI_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: SSI_READYPIN_BASE and SSI_READYPIN_POS
+//
+//*****************************************************************************
+//#define SSI_READYPIN_CLOCK_ENABLE          SYSCTL_RCGCGPIO_R0
+
+//*****************************************************************************
+//
+// Selects the base address for the GPIO used as the ready/busy handshake
+// output.  Leave this undefined if no handshake line is wired.
+//
+// Depends on: SSI_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: SSI_READYPIN_CLOCK_ENABLE and SSI_READYPIN_POS
+//
+//*****************************************************************************
+//#define SSI_READYPIN_BASE          GPIO_PORTA_BASE
+
+//*****************************************************************************
+//
+// Selects the pin number for the GPIO used as the ready/busy handshake
+// output.
+//
+// Depends on: SSI_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: SSI_READYPIN_CLOCK_ENABLE and SSI_READYPIN_BASE
+//
+//*****************************************************************************
+//#define SSI_READYPIN_POS          6
+
+//*****************************************************************************
+//
+// Adds a transport that passes packets through a mailbox in SRAM, polled
+// along with the UART and SSI ports.  Whatever else can reach the SRAM, such
+// as a debugger or a test harness, writes packets to the receive ring of the
+// mailbox and reads the responses from its transmit ring, so that the packet
+// protocol can be driven without a serial port.  The layout of the mailbox
+// is in bl_loopback.h.
+//
+// Depends on: UART_ENABLE_UPDATE or SSI_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: LOOPBACK_ADDRESS
+//
+//*****************************************************************************
+//#define LOOPBACK_ENABLE_UPDATE
+
+//*****************************************************************************
+//
+// The address in SRAM of the mailbox used by LOOPBACK_ENABLE_UPDATE, which
+// takes LOOPBACK_SIZE bytes (528 bytes with the default ring size).  The
+// boot loader empties it when it is entered from reset, and the application
+// must keep it out of its own stack and data if it enters the boot loader
+// through the SVCall vector.
+//
+// Depends on: LOOPBACK_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define LOOPBACK_ADDRESS        0x2003fc00
+
 //*****************************************************************************
 //
 // Selects the I2C port as the port for communicating with the boot loader.
@@ -903,6 +1410,36 @@
 //*****************************************************************************
 //#define ENET_BOOTP_SERVER       "stellaris"
 
+//*****************************************************************************
+//
+// Specifies the number of receive and transmit DMA descriptors in the static
+// descriptor rings used by the Ethernet update.  Each descriptor owns a
+// 1536 byte buffer in SRAM, so more receive descriptors allow more frames to
+// be queued while a block is programmed into flash at the cost of SRAM.
+//
+// Depends on: ENET_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define ENET_NUM_RX_DESCRIPTORS 4
+//#define ENET_NUM_TX_DESCRIPTORS 2
+
+//*****************************************************************************
+//
+// Specifies the TFTP block size requested from the server with the blksize
+// option (RFC 2348).  Larger blocks reduce the number of lock-step round
+// trips needed for an image.  This must be a multiple of 4 bytes and no more
+// than 1468 bytes so that a block fits in a single Ethernet frame.  Servers
+// that do not support the option fall back to 512 byte blocks.
+//
+// Depends on: ENET_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define ENET_TFTP_BLOCK_SIZE    1024
+
 //*****************************************************************************
 //
 // Selects USB update via Device Firmware Update class.
@@ -979,6 +1516,62 @@
 //*****************************************************************************
 //#define USB_BUS_POWERED         1
 
+//*****************************************************************************
+//
+// Specifies the DFU transfer size, which is the largest block that the host
+// sends in a single DFU_DNLOAD request.  Larger blocks reduce the number of
+// control transfers and status polls needed for an image.  This must be a
+// multiple of 4 bytes.
+//
+// Depends on: USB_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define USB_DFU_TRANSFER_SIZE   1024
+
+//*****************************************************************************
+//
+// Specifies the poll timeout, in milliseconds, that the DFU device reports to
+// the host while a block is being written to flash.
+//
+// Depends on: USB_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define USB_POLL_TIMEOUT        10
+
+//*****************************************************************************
+//
+// Enables bulk downloads.  The DFU interface gains a bulk OUT endpoint which
+// is unloaded by the USB controller's integrated DMA engine into a pair of
+// buffers, one being filled while the other is programmed into flash.  A
+// download is started with a vendor request (0x42) to the DFU interface whose
+// eight byte data stage holds the little endian flash address and length of
+// the data that follows.  The address must be a valid image start address on
+// an erase block boundary and the length must be a multiple of 64 bytes.  The
+// host follows the progress with DFU_GETSTATUS as for a normal download.
+//
+// Depends on: USB_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define USB_ENABLE_BULK_DMA
+
+//*****************************************************************************
+//
+// Specifies the size of each of the two bulk download buffers.  This must be
+// a multiple of 64 bytes.
+//
+// Depends on: USB_ENABLE_UPDATE, USB_ENABLE_BULK_DMA
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define USB_BULK_BUFFER_SIZE    1024
+
 //*****************************************************************************
 //
 // Specifies whether the target board uses a multiplexer to select between USB
@@ -1363,6 +1956,35 @@
 //*****************************************************************************
 //#define CAN_BIT_RATE            1000000
 
+//*****************************************************************************
+//
+// The port control value that selects the CAN0 function on the CAN0 Rx and Tx
+// pins.  This is the value written to the pin's field in the GPIOPCTL
+// register.
+//
+// Depends on: CAN_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define CAN_RX_PCTL             0x7
+//#define CAN_TX_PCTL             0x7
+
+//*****************************************************************************
+//
+// The address of this node on the CAN bus, between 0 and 62.  Every node on a
+// bus must have its own address.  The host can address commands to a single
+// node or to all nodes at once, so a single broadcast stream of data programs
+// every node in the session, with each node then polled for a bitmap of the
+// frames it holds so that only the missing frames are sent again.
+//
+// Depends on: CAN_ENABLE_UPDATE
+// Exclusive of: None
+// Requires: None
+//
+//*****************************************************************************
+//#define CAN_NODE_ID             1
+
 //*****************************************************************************
 //
 // Performs application-specific low level hardware initialization on system
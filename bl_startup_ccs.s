@@ -29,6 +29,7 @@
 ;;*****************************************************************************
     .cdecls C, NOLIST, WARN
     %{
+        #include "inc/hw_flash.h"
         #include "inc/hw_nvic.h"
         #include "inc/hw_sysctl.h"
         #include "bl_config.h"
@@ -239,6 +240,25 @@ zero_loop:
 ;;*****************************************************************************
     .thumbfunc ResetISR
 ResetISR: .asmfunc
+    ;;
+    ;; Start the DWT cycle counter from zero so that the time taken to reach
+    ;; the application can be recorded.
+    ;;
+ .if $$defined(BOOT_CYCLES_ADDRESS)
+    movw    r0, #(NVIC_DBG_INT & 0xffff)
+    movt    r0, #(NVIC_DBG_INT >> 16)
+    ldr     r1, [r0]
+    orr     r1, r1, #NVIC_DBG_INT_TRCENA
+    str     r1, [r0]
+    movw    r0, #0x1000                     ;; DWT_CTRL
+    movt    r0, #0xE000
+    movs    r1, #0x0000
+    str     r1, [r0, #4]                    ;; DWT_CYCCNT
+    ldr     r1, [r0]
+    orr     r1, r1, #0x00000001             ;; DWT_CTRL_CYCCNTENA
+    str     r1, [r0]
+ .endif
+
     ;;
     ;; Enable the floating-point unit.  This must be done here in case any
     ;; later C functions use floating point.  Note that some toolchains will
@@ -251,9 +271,48 @@ ResetISR: .asmfunc
     orr     r1, r1, #0x00F00000
     str     r1, [r0]
 
+    ;;
+    ;; If all that the update check has to do is look for a valid stack
+    ;; pointer and reset vector at the start of the application, do it here,
+    ;; still running from flash on the precision internal oscillator that the
+    ;; device resets to, and branch straight to the application if they are
+    ;; there.  This saves copying the boot loader to SRAM; the clocks and the
+    ;; update port are only configured once the boot loader decides to stay.
+    ;; The reset vector must be a Thumb address from the start of the
+    ;; application to the end of the flash that FLASH_PP reports, so that a
+    ;; vector into the boot loader or past the flash is left to the full
+    ;; check.
+    ;;
+ .if ($$defined(BL_CHECK_UPDATE_FN_HOOK) | $$defined(BL_HW_INIT_FN_HOOK) | $$defined(CHECK_CRC) | $$defined(CHECK_SIGNATURE) | $$defined(ENABLE_UPDATE_CHECK) | ($$defined(BL_WATCHDOG_TIMEOUT) & $$defined(FLASH_JOURNAL_ADDRESS)))
+ .else
+    movw    r0, #(APP_START_ADDRESS & 0xffff)
+ .if (APP_START_ADDRESS > 0xffff)
+    movt    r0, #(APP_START_ADDRESS >> 16)
+ .endif
+    ldr     r1, [r0]
+    lsrs    r1, r1, #20
+    cmp     r1, #0x200
+    bne     FullCheck
+    ldr     r1, [r0, #4]
+    tst     r1, #1
+    beq     FullCheck
+    cmp     r1, r0
+    bls     FullCheck
+    movw    r2, #(FLASH_PP & 0xffff)
+    movt    r2, #(FLASH_PP >> 16)
+    ldr     r2, [r2]
+    ubfx    r2, r2, #0, #16                 ;; FLASH_PP_SIZE_M
+    adds    r2, r2, #1
+    lsls    r2, r2, #11
+    cmp     r1, r2
+    bhs     FullCheck
+    b       CallApplication
+ .endif
+
     ;;
     ;; Initialize the processor.
     ;;
+FullCheck:
     bl      ProcessorInit
 
     ;;
@@ -277,6 +336,15 @@ ResetISR: .asmfunc
     ;;
     .thumbfunc EnterBootLoader
 EnterBootLoader:
+    ;;
+    ;; Forget the image that last passed the signature check, since it may
+    ;; be changed by the update.
+    ;;
+ .if $$defined(SIGN_CACHE_ADDRESS)
+    .ref    SignCacheClear
+    bl      SignCacheClear
+ .endif
+
  .if $$defined(ENET_ENABLE_UPDATE)
     .ref    ConfigureEnet
     bl      ConfigureEnet
@@ -387,6 +455,18 @@ VectorCopyLoop:
  .endif
     ldr     sp, [r0]
 
+    ;;
+    ;; Record the number of cycles since reset.
+    ;;
+ .if $$defined(BOOT_CYCLES_ADDRESS)
+    movw    r1, #0x1004                     ;; DWT_CYCCNT
+    movt    r1, #0xE000
+    ldr     r2, [r1]
+    movw    r1, #(BOOT_CYCLES_ADDRESS & 0xffff)
+    movt    r1, #(BOOT_CYCLES_ADDRESS >> 16)
+    str     r2, [r1]
+ .endif
+
     ;;
     ;; Load the initial PC from the application's vector table and branch to
     ;; the application's entry point.
@@ -430,6 +510,22 @@ UpdateHandler: .asmfunc
     bl      BL_REINIT_FN_HOOK
  .endif
 
+    ;;
+    ;; Forget the image that last passed the signature check.
+    ;;
+ .if $$defined(SIGN_CACHE_ADDRESS)
+    bl      SignCacheClear
+ .endif
+
+    ;;
+    ;; Take over the system clock and UART that the application handed off,
+    ;; or configure them if it did not.
+    ;;
+ .if $$defined(BL_HANDOFF_ADDRESS)
+    .ref    HandoffConfigure
+    bl      HandoffConfigure
+ .endif
+
     ;;
     ;; Branch to the update handler.
     ;;
@@ -0,0 +1,613 @@
+//*****************************************************************************
+//
+// bl_can.c - Functions to update via CAN with broadcast programming.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_can.h"
+#include "inc/hw_flash.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "bl_config.h"
+#include "driverlib/can.h"
+#include "driverlib/sysctl.h"
+#include "boot_loader/bl_can.h"
+#include "boot_loader/bl_commands.h"
+#include "boot_loader/bl_flash.h"
+#include "boot_loader/bl_hooks.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_can_api
+//! @{
+//
+//*****************************************************************************
+#if defined(CAN_ENABLE_UPDATE) || defined(DOXYGEN)
+
+//*****************************************************************************
+//
+// The message objects used by the boot loader.  Commands addressed to this
+// node and to all nodes each have their own object, data frames go through a
+// FIFO built from a run of objects, and the last object sends the replies.
+//
+//*****************************************************************************
+#define CAN_OBJ_CMD_NODE        1
+#define CAN_OBJ_CMD_ALL         2
+#define CAN_OBJ_DATA_FIRST      3
+#define CAN_OBJ_DATA_LAST       18
+#define CAN_OBJ_TX              32
+
+//*****************************************************************************
+//
+// The identifier bits that are compared when filtering commands and data.
+//
+//*****************************************************************************
+#define CAN_ID_CMD_MASK         (CAN_ID_DATA | 0x3f)
+
+//*****************************************************************************
+//
+// The image being downloaded.
+//
+//*****************************************************************************
+static uint32_t g_ui32Status;
+static bool g_bDownloading;
+static uint32_t g_ui32ImageStart;
+static uint32_t g_ui32ImageEnd;
+static uint32_t g_ui32Programmed;
+
+//*****************************************************************************
+//
+// The block being received.  Each bit of the bitmap records a data frame that
+// has arrived, so that the host only needs to resend the missing frames.
+//
+//*****************************************************************************
+static uint32_t g_pui32Block[CAN_BLOCK_SIZE / 4];
+static uint32_t g_pui32Bitmap[2];
+static uint32_t g_pui32Complete[2];
+static uint32_t g_ui32NextBlock;
+static bool g_bBlockActive;
+
+//*****************************************************************************
+//
+// The system clock frequency.
+//
+//*****************************************************************************
+static uint32_t g_ui32CANSysClock;
+
+//*****************************************************************************
+//
+// Sends a reply from this node.
+//
+//*****************************************************************************
+static void
+CANReply(uint32_t ui32Cmd, uint8_t *pui8Data, uint32_t ui32Size)
+{
+    tCANMsgObject sMsg;
+
+    //
+    // Wait for the previous reply to leave.
+    //
+    while(CANStatusGet(CAN0_BASE, CAN_STS_TXREQUEST) &
+          (1 << (CAN_OBJ_TX - 1)))
+    {
+    }
+
+    sMsg.ui32MsgID = CAN_ID(ui32Cmd, CAN_NODE_ID);
+    sMsg.ui32MsgIDMask = 0;
+    sMsg.ui32Flags = MSG_OBJ_NO_FLAGS;
+    sMsg.ui32MsgLen = ui32Size;
+    sMsg.pui8MsgData = pui8Data;
+    CANMessageSet(CAN0_BASE, CAN_OBJ_TX, &sMsg, MSG_OBJ_TYPE_TX);
+}
+
+//*****************************************************************************
+//
+// Sends the status of this node along with the next block that it expects.
+//
+//*****************************************************************************
+static void
+CANStatusReply(void)
+{
+    uint8_t pui8Data[3];
+
+    pui8Data[0] = g_ui32Status;
+    pui8Data[1] = g_ui32NextBlock;
+    pui8Data[2] = g_ui32NextBlock >> 8;
+    CANReply(CAN_CMD_STATUS, pui8Data, 3);
+}
+
+//*****************************************************************************
+//
+// Sends the frame bitmap of the given block.
+//
+//*****************************************************************************
+static void
+CANBitmapReply(uint32_t ui32Block)
+{
+    uint32_t pui32Bitmap[2];
+
+    if(ui32Block < g_ui32NextBlock)
+    {
+        pui32Bitmap[0] = 0xffffffff;
+        pui32Bitmap[1] = 0xffffffff;
+    }
+    else if(g_bBlockActive && (ui32Block == g_ui32NextBlock))
+    {
+        pui32Bitmap[0] = g_pui32Bitmap[0];
+        pui32Bitmap[1] = g_pui32Bitmap[1];
+    }
+    else
+    {
+        pui32Bitmap[0] = 0;
+        pui32Bitmap[1] = 0;
+    }
+
+    CANReply(CAN_CMD_BITMAP, (uint8_t *)pui32Bitmap, 8);
+}
+
+//*****************************************************************************
+//
+// Starts a download, erasing the flash that the image will occupy.
+//
+//*****************************************************************************
+static uint32_t
+CANDownload(uint32_t ui32Address, uint32_t ui32Size)
+{
+    uint32_t ui32Erase, ui32End;
+
+    g_bDownloading = false;
+    g_bBlockActive = false;
+    if((ui32Size == 0) || !BL_FLASH_AD_CHECK_FN_HOOK(ui32Address, ui32Size))
+    {
+        return(COMMAND_RET_INVALID_ADR);
+    }
+
+    ui32End = ui32Address + ui32Size;
+#ifdef FLASH_CODE_PROTECTION
+    if(ui32Address == APP_START_ADDRESS)
+    {
+        ui32End = BL_FLASH_SIZE_FN_HOOK();
+#ifdef FLASH_RSVD_SPACE
+        ui32End -= FLASH_RSVD_SPACE;
+#endif
+    }
+#endif
+
+    BL_FLASH_CL_ERR_FN_HOOK();
+    for(ui32Erase = ui32Address; ui32Erase < ui32End;
+        ui32Erase += BL_FLASH_ERASE_SIZE)
+    {
+        BL_FLASH_ERASE_FN_HOOK(ui32Erase);
+    }
+    if(BL_FLASH_ERROR_FN_HOOK())
+    {
+        return(COMMAND_RET_FLASH_FAIL);
+    }
+
+    g_ui32ImageStart = ui32Address;
+    g_ui32ImageEnd = ui32Address + ui32Size;
+    g_ui32Programmed = 0;
+    g_ui32NextBlock = 0;
+    g_bDownloading = true;
+
+#ifdef BL_START_FN_HOOK
+    BL_START_FN_HOOK();
+#endif
+
+    return(COMMAND_RET_SUCCESS);
+}
+
+//*****************************************************************************
+//
+// Starts receiving a block.  A block that is already being received, or that
+// has already been programmed, is being resent for another node and is
+// ignored.
+//
+//*****************************************************************************
+static void
+CANBlockStart(uint32_t ui32Block, uint32_t ui32Frames)
+{
+    uint32_t ui32Loop;
+
+    if(!g_bDownloading || (g_ui32Status != COMMAND_RET_SUCCESS) ||
+       (ui32Block != g_ui32NextBlock) || g_bBlockActive ||
+       (ui32Frames == 0) || (ui32Frames > CAN_BLOCK_FRAMES) ||
+       ((g_ui32ImageStart + (ui32Block * CAN_BLOCK_SIZE)) >= g_ui32ImageEnd))
+    {
+        return;
+    }
+
+    for(ui32Loop = 0; ui32Loop < (CAN_BLOCK_SIZE / 4); ui32Loop++)
+    {
+        g_pui32Block[ui32Loop] = 0xffffffff;
+    }
+
+    //
+    // Work out the bitmap of a complete block.
+    //
+    g_pui32Bitmap[0] = 0;
+    g_pui32Bitmap[1] = 0;
+    g_pui32Complete[0] = ((ui32Frames >= 32) ? 0xffffffff :
+                          (0xffffffff >> (32 - ui32Frames)));
+    g_pui32Complete[1] = ((ui32Frames > 32) ?
+                          (0xffffffff >> (64 - ui32Frames)) : 0);
+    g_bBlockActive = true;
+}
+
+//*****************************************************************************
+//
+// Programs a complete block into flash.
+//
+//*****************************************************************************
+static void
+CANBlockProgram(void)
+{
+    uint32_t ui32Address, ui32Size;
+
+    ui32Address = g_ui32ImageStart + (g_ui32NextBlock * CAN_BLOCK_SIZE);
+    ui32Size = g_ui32ImageEnd - ui32Address;
+    if(ui32Size > CAN_BLOCK_SIZE)
+    {
+        ui32Size = CAN_BLOCK_SIZE;
+    }
+
+#ifdef BL_DECRYPT_FN_HOOK
+    BL_DECRYPT_FN_HOOK((uint8_t *)g_pui32Block, ui32Size);
+#endif
+
+    BL_FLASH_CL_ERR_FN_HOOK();
+    BL_FLASH_PROGRAM_FN_HOOK(ui32Address, (uint8_t *)g_pui32Block,
+                             (ui32Size + 3) & ~3);
+    if(BL_FLASH_ERROR_FN_HOOK())
+    {
+        g_ui32Status = COMMAND_RET_FLASH_FAIL;
+        g_bDownloading = false;
+    }
+
+    g_bBlockActive = false;
+    g_ui32NextBlock++;
+    g_ui32Programmed += ui32Size;
+
+#ifdef BL_PROGRESS_FN_HOOK
+    BL_PROGRESS_FN_HOOK(g_ui32Programmed, g_ui32ImageEnd - g_ui32ImageStart);
+#endif
+}
+
+//*****************************************************************************
+//
+// Stores a data frame of the current block, programming the block once every
+// frame has arrived.
+//
+//*****************************************************************************
+static void
+CANDataReceive(uint32_t ui32Index, uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint8_t *pui8Dest;
+
+    if(!g_bBlockActive || (ui32Size > 8) ||
+       !(g_pui32Complete[ui32Index / 32] & (1 << (ui32Index % 32))))
+    {
+        return;
+    }
+
+    pui8Dest = (uint8_t *)g_pui32Block + (ui32Index * 8);
+    while(ui32Size--)
+    {
+        *pui8Dest++ = *pui8Data++;
+    }
+    g_pui32Bitmap[ui32Index / 32] |= 1 << (ui32Index % 32);
+
+    if((g_pui32Bitmap[0] == g_pui32Complete[0]) &&
+       (g_pui32Bitmap[1] == g_pui32Complete[1]))
+    {
+        CANBlockProgram();
+    }
+}
+
+//*****************************************************************************
+//
+// Resets the device to run the new image.
+//
+//*****************************************************************************
+static void
+CANRun(void)
+{
+    //
+    // Make sure that the reply has left before resetting.
+    //
+    while(CANStatusGet(CAN0_BASE, CAN_STS_TXREQUEST) &
+          (1 << (CAN_OBJ_TX - 1)))
+    {
+    }
+
+#ifdef BL_END_FN_HOOK
+    BL_END_FN_HOOK();
+#endif
+
+    HWREG(NVIC_APINT) = (NVIC_APINT_VECTKEY | NVIC_APINT_SYSRESETREQ);
+    while(1)
+    {
+    }
+}
+
+//*****************************************************************************
+//
+// Handles a command from the host.
+//
+//*****************************************************************************
+static void
+CANCommand(uint32_t ui32ID, uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint32_t ui32Value;
+
+    switch(CAN_ID_CMD(ui32ID))
+    {
+        case CAN_CMD_PING:
+        {
+            CANStatusReply();
+            break;
+        }
+
+        case CAN_CMD_DOWNLOAD:
+        {
+            if(ui32Size != 8)
+            {
+                g_ui32Status = COMMAND_RET_INVALID_CMD;
+            }
+            else
+            {
+                g_ui32Status = CANDownload(
+                    pui8Data[0] | (pui8Data[1] << 8) | (pui8Data[2] << 16) |
+                    (pui8Data[3] << 24),
+                    pui8Data[4] | (pui8Data[5] << 8) | (pui8Data[6] << 16) |
+                    (pui8Data[7] << 24));
+            }
+            CANStatusReply();
+            break;
+        }
+
+        case CAN_CMD_BLOCK:
+        {
+            if(ui32Size == 3)
+            {
+                CANBlockStart(pui8Data[0] | (pui8Data[1] << 8), pui8Data[2]);
+            }
+            break;
+        }
+
+        case CAN_CMD_POLL:
+        {
+            //
+            // Polls must be addressed to a single node so that the replies do
+            // not collide.
+            //
+            if((CAN_ID_NODE(ui32ID) == CAN_NODE_ALL) || (ui32Size != 2))
+            {
+                break;
+            }
+            ui32Value = pui8Data[0] | (pui8Data[1] << 8);
+            if(g_ui32Status != COMMAND_RET_SUCCESS)
+            {
+                CANStatusReply();
+            }
+            else
+            {
+                CANBitmapReply(ui32Value);
+            }
+            break;
+        }
+
+        case CAN_CMD_RUN:
+        {
+            if(!g_bDownloading || (g_ui32Programmed < (g_ui32ImageEnd -
+                                                       g_ui32ImageStart)))
+            {
+                g_ui32Status = COMMAND_RET_INVALID_CMD;
+                CANStatusReply();
+                break;
+            }
+            CANStatusReply();
+            CANRun();
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Sets up a receive message object.
+//
+//*****************************************************************************
+static void
+CANReceiveObjectSet(uint32_t ui32Obj, uint32_t ui32ID, uint32_t ui32Mask,
+                    uint32_t ui32Flags)
+{
+    tCANMsgObject sMsg;
+
+    sMsg.ui32MsgID = ui32ID;
+    sMsg.ui32MsgIDMask = ui32Mask;
+    sMsg.ui32Flags = MSG_OBJ_USE_ID_FILTER | ui32Flags;
+    sMsg.ui32MsgLen = 8;
+    sMsg.pui8MsgData = 0;
+    CANMessageSet(CAN0_BASE, ui32Obj, &sMsg, MSG_OBJ_TYPE_RX);
+}
+
+//*****************************************************************************
+//
+//! Configures the CAN controller.
+//!
+//! This function sets the system clock, routes the CAN0 pins and sets up the
+//! message objects that receive the commands for this node, the commands for
+//! all nodes and the data frames.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ConfigureCAN(void)
+{
+    uint32_t ui32Obj;
+
+    g_ui32CANSysClock = SysCtlClockFreqSet((SYSCTL_XTAL_16MHZ |
+                                            SYSCTL_OSC_MAIN |
+                                            SYSCTL_USE_PLL |
+                                            SYSCTL_CFG_VCO_480), 120000000);
+
+    //
+    // Route the CAN0 pins.  The legacy SYSCTL_RCGC2_GPIOx values match the
+    // SYSCTL_RCGCGPIO_Rx bits.
+    //
+    HWREG(SYSCTL_RCGCGPIO) |= CAN_RX_PERIPH | CAN_TX_PERIPH;
+    while((HWREG(SYSCTL_PRGPIO) & (CAN_RX_PERIPH | CAN_TX_PERIPH)) !=
+          (CAN_RX_PERIPH | CAN_TX_PERIPH))
+    {
+    }
+    HWREG(CAN_RX_PORT + GPIO_O_PCTL) =
+        ((HWREG(CAN_RX_PORT + GPIO_O_PCTL) & ~(0xf << (CAN_RX_PIN * 4))) |
+         (CAN_RX_PCTL << (CAN_RX_PIN * 4)));
+    HWREG(CAN_RX_PORT + GPIO_O_AFSEL) |= (1 << CAN_RX_PIN);
+    HWREG(CAN_RX_PORT + GPIO_O_DEN) |= (1 << CAN_RX_PIN);
+    HWREG(CAN_TX_PORT + GPIO_O_PCTL) =
+        ((HWREG(CAN_TX_PORT + GPIO_O_PCTL) & ~(0xf << (CAN_TX_PIN * 4))) |
+         (CAN_TX_PCTL << (CAN_TX_PIN * 4)));
+    HWREG(CAN_TX_PORT + GPIO_O_AFSEL) |= (1 << CAN_TX_PIN);
+    HWREG(CAN_TX_PORT + GPIO_O_DEN) |= (1 << CAN_TX_PIN);
+
+    //
+    // Reset and initialize the controller.
+    //
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_CAN0);
+    SysCtlPeripheralReset(SYSCTL_PERIPH_CAN0);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_CAN0))
+    {
+    }
+    CANInit(CAN0_BASE);
+    CANBitRateSet(CAN0_BASE, g_ui32CANSysClock, CAN_BIT_RATE);
+
+    //
+    // Commands for this node and for every node.
+    //
+    CANReceiveObjectSet(CAN_OBJ_CMD_NODE, CAN_ID(0, CAN_NODE_ID),
+                        CAN_ID_CMD_MASK, MSG_OBJ_NO_FLAGS);
+    CANReceiveObjectSet(CAN_OBJ_CMD_ALL, CAN_ID(0, CAN_NODE_ALL),
+                        CAN_ID_CMD_MASK, MSG_OBJ_NO_FLAGS);
+
+    //
+    // The data frames are queued in a FIFO so that none are lost while a
+    // block is being programmed.
+    //
+    for(ui32Obj = CAN_OBJ_DATA_FIRST; ui32Obj <= CAN_OBJ_DATA_LAST; ui32Obj++)
+    {
+        CANReceiveObjectSet(ui32Obj, CAN_ID_DATA, CAN_ID_DATA,
+                            (ui32Obj == CAN_OBJ_DATA_LAST) ?
+                            MSG_OBJ_NO_FLAGS : MSG_OBJ_FIFO);
+    }
+
+    g_ui32Status = COMMAND_RET_SUCCESS;
+    CANEnable(CAN0_BASE);
+}
+
+//*****************************************************************************
+//
+//! Performs an update over CAN.
+//!
+//! This function services the commands and data frames received by the
+//! message objects.  The host broadcasts each block of the image once to all
+//! of the nodes in the session, polls every node for the bitmap of the frames
+//! it holds and then rebroadcasts only the frames that are missing somewhere,
+//! so updating many nodes takes about as long as updating one.
+//!
+//! \return Never returns.
+//
+//*****************************************************************************
+void
+UpdaterCAN(void)
+{
+    tCANMsgObject sMsg;
+    uint8_t pui8Data[8];
+    uint32_t ui32NewData, ui32Obj;
+
+    sMsg.pui8MsgData = pui8Data;
+
+    while(1)
+    {
+        ui32NewData = CANStatusGet(CAN0_BASE, CAN_STS_NEWDAT);
+
+        //
+        // Drain the data FIFO in order before looking at any commands, since
+        // the frames of a block are sent before the poll that follows them.
+        //
+        for(ui32Obj = CAN_OBJ_DATA_FIRST; ui32Obj <= CAN_OBJ_DATA_LAST;
+            ui32Obj++)
+        {
+            if(ui32NewData & (1 << (ui32Obj - 1)))
+            {
+                CANMessageGet(CAN0_BASE, ui32Obj, &sMsg, true);
+                CANDataReceive(CAN_ID_NODE(sMsg.ui32MsgID), pui8Data,
+                               sMsg.ui32MsgLen);
+            }
+        }
+
+        for(ui32Obj = CAN_OBJ_CMD_NODE; ui32Obj <= CAN_OBJ_CMD_ALL; ui32Obj++)
+        {
+            if(ui32NewData & (1 << (ui32Obj - 1)))
+            {
+                CANMessageGet(CAN0_BASE, ui32Obj, &sMsg, true);
+                CANCommand(sMsg.ui32MsgID, pui8Data, sMsg.ui32MsgLen);
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Performs an update over CAN when called from the application.
+//!
+//! This function takes the CAN controller over from the application and then
+//! performs the update.
+//!
+//! \return Never returns.
+//
+//*****************************************************************************
+void
+AppUpdaterCAN(void)
+{
+    ConfigureCAN();
+    UpdaterCAN();
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+#endif
@@ -0,0 +1,146 @@
+//*****************************************************************************
+//
+// bl_can.h - Definitions for the CAN transport functions.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_CAN_H__
+#define __BL_CAN_H__
+
+//*****************************************************************************
+//
+// This section maps the defines to default for the CAN boot loader for
+// projects that do not specify them in bl_config.h.
+//
+//*****************************************************************************
+#ifndef CAN_RX_PERIPH
+#define CAN_RX_PERIPH           SYSCTL_RCGCGPIO_R0
+#endif
+
+#ifndef CAN_RX_PORT
+#define CAN_RX_PORT             GPIO_PORTA_BASE
+#endif
+
+#ifndef CAN_RX_PIN
+#define CAN_RX_PIN              0
+#endif
+
+#ifndef CAN_TX_PERIPH
+#define CAN_TX_PERIPH           SYSCTL_RCGCGPIO_R0
+#endif
+
+#ifndef CAN_TX_PORT
+#define CAN_TX_PORT             GPIO_PORTA_BASE
+#endif
+
+#ifndef CAN_TX_PIN
+#define CAN_TX_PIN              1
+#endif
+
+#ifndef CAN_BIT_RATE
+#define CAN_BIT_RATE            1000000
+#endif
+
+#ifndef CAN_NODE_ID
+#define CAN_NODE_ID             1
+#endif
+
+#ifndef CAN_RX_PCTL
+#define CAN_RX_PCTL             0x7
+#endif
+
+#ifndef CAN_TX_PCTL
+#define CAN_TX_PCTL             0x7
+#endif
+
+//*****************************************************************************
+//
+// The boot loader uses standard 11-bit identifiers.  A command identifier
+// holds the command in bits 9:6 and the node it is addressed to in bits 5:0,
+// where CAN_NODE_ALL addresses every node on the bus at once.  Replies use
+// the same layout with the node that is replying.  A data frame has bit 10
+// set and holds the index of the frame within the current block in bits 5:0.
+//
+//*****************************************************************************
+#define CAN_NODE_ALL            0x3f
+#define CAN_ID_DATA             0x400
+#define CAN_ID(ui32Cmd, ui32Node)                                             \
+                                (((ui32Cmd) << 6) | (ui32Node))
+#define CAN_ID_CMD(ui32ID)      (((ui32ID) >> 6) & 0xf)
+#define CAN_ID_NODE(ui32ID)     ((ui32ID) & 0x3f)
+
+//*****************************************************************************
+//
+// A block is made up of up to 64 data frames of 8 bytes each.
+//
+//*****************************************************************************
+#define CAN_BLOCK_FRAMES        64
+#define CAN_BLOCK_SIZE          (CAN_BLOCK_FRAMES * 8)
+
+//*****************************************************************************
+//
+// The commands sent by the host.  Multi-byte values are little endian.
+//
+// CAN_CMD_PING: no data.  Each addressed node replies with CAN_CMD_STATUS.
+//
+// CAN_CMD_DOWNLOAD: 4 byte address and 4 byte size.  The node erases the
+// image area and replies with CAN_CMD_STATUS once it is ready for data.
+//
+// CAN_CMD_BLOCK: 2 byte block number and 1 byte frame count.  Starts a block
+// of the image at address + (block number * CAN_BLOCK_SIZE).  The data frames
+// that follow are broadcast to all nodes in the session.
+//
+// CAN_CMD_POLL: 2 byte block number.  Only valid for a single node, which
+// replies with CAN_CMD_BITMAP holding a bit for each data frame of the block
+// that it holds (all ones once the block has been programmed), or with
+// CAN_CMD_STATUS if the download has failed.  The host then rebroadcasts only
+// the frames missing from one or more nodes.
+//
+// CAN_CMD_RUN: no data.  Each addressed node replies with CAN_CMD_STATUS and,
+// if the whole image has been programmed, resets to run it.
+//
+//*****************************************************************************
+#define CAN_CMD_PING            1
+#define CAN_CMD_DOWNLOAD        2
+#define CAN_CMD_BLOCK           3
+#define CAN_CMD_POLL            4
+#define CAN_CMD_RUN             5
+
+//*****************************************************************************
+//
+// The replies sent by a node.  CAN_CMD_STATUS holds a COMMAND_RET_* status
+// code followed by the 2 byte number of the next block that the node expects.
+// CAN_CMD_BITMAP holds the 64-bit frame bitmap of the polled block.
+//
+//*****************************************************************************
+#define CAN_CMD_STATUS          8
+#define CAN_CMD_BITMAP          9
+
+//*****************************************************************************
+//
+// CAN Transport APIs
+//
+//*****************************************************************************
+extern void ConfigureCAN(void);
+extern void UpdaterCAN(void);
+extern void AppUpdaterCAN(void);
+
+#endif // __BL_CAN_H__
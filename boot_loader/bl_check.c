@@ -34,6 +34,15 @@
 #ifdef CHECK_CRC
 #include "boot_loader/bl_crc32.h"
 #endif
+#ifdef CHECK_SIGNATURE
+#include "inc/hw_flash.h"
+#include "boot_loader/bl_ecdsa.h"
+#include "boot_loader/bl_flash.h"
+#include "boot_loader/bl_sha256.h"
+#endif
+#if defined(BL_WATCHDOG_TIMEOUT) && defined(FLASH_JOURNAL_ADDRESS)
+#include "boot_loader/bl_journal.h"
+#endif
 
 //*****************************************************************************
 //
@@ -51,6 +60,26 @@
 uint32_t g_ui32Forced;
 #endif
 
+//*****************************************************************************
+//
+// The markers and size of the records in the signature cache.  Each record
+// is ten words: the marker, the eight words of a SHA-256 digest and the
+// inverse of the exclusive OR of those eight words.  A valid record holds the
+// digest of the image that passed the check, and a clear record forgets it.
+//
+//*****************************************************************************
+#ifdef SIGN_CACHE_ADDRESS
+#if (SIGN_CACHE_ADDRESS & (BL_FLASH_ERASE_SIZE - 1))
+#error ERROR: SIGN_CACHE_ADDRESS must be a multiple of the flash erase size!
+#endif
+#define SIGN_CACHE_VALID        0x5347e132
+#define SIGN_CACHE_CLEAR        0x5347e130
+#define SIGN_CACHE_WORDS        (SHA256_DIGEST_SIZE / 4)
+#define SIGN_CACHE_RECORD_SIZE  ((SIGN_CACHE_WORDS + 2) * 4)
+#define SIGN_CACHE_LAST         (SIGN_CACHE_ADDRESS + BL_FLASH_ERASE_SIZE -   \
+                                 SIGN_CACHE_RECORD_SIZE)
+#endif
+
 //*****************************************************************************
 //
 // A prototype for the function (in the startup code) for a predictable length
@@ -165,6 +194,226 @@ CheckGPIOForceUpdate(void)
 }
 #endif
 
+#ifdef SIGN_CACHE_ADDRESS
+//*****************************************************************************
+//
+// Finds the last record in the signature cache that was completely written,
+// returning its address or 0 if there is none, and the address of the first
+// unused record.
+//
+//*****************************************************************************
+static uint32_t
+SignCacheLast(uint32_t *pui32Next)
+{
+    uint32_t ui32Record, ui32Last, ui32Idx, ui32Blank, ui32Check;
+
+    ui32Last = 0;
+    for(ui32Record = SIGN_CACHE_ADDRESS; ui32Record <= SIGN_CACHE_LAST;
+        ui32Record += SIGN_CACHE_RECORD_SIZE)
+    {
+        ui32Blank = HWREG(ui32Record);
+        ui32Check = 0;
+        for(ui32Idx = 1; ui32Idx <= SIGN_CACHE_WORDS; ui32Idx++)
+        {
+            ui32Blank &= HWREG(ui32Record + (ui32Idx * 4));
+            ui32Check ^= HWREG(ui32Record + (ui32Idx * 4));
+        }
+        ui32Blank &= HWREG(ui32Record + (ui32Idx * 4));
+        if(ui32Blank == 0xffffffff)
+        {
+            break;
+        }
+        if(((HWREG(ui32Record) == SIGN_CACHE_VALID) ||
+            (HWREG(ui32Record) == SIGN_CACHE_CLEAR)) &&
+           (HWREG(ui32Record + (ui32Idx * 4)) == ~ui32Check))
+        {
+            ui32Last = ui32Record;
+        }
+    }
+
+    *pui32Next = ui32Record;
+    return(ui32Last);
+}
+
+//*****************************************************************************
+//
+// Packs the bytes of a digest into words, in the order that they are stored
+// in a record, or zeros the words if there is no digest.
+//
+//*****************************************************************************
+static void
+SignCacheWords(uint32_t *pui32Words, const uint8_t *pui8Digest)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < SIGN_CACHE_WORDS; ui32Idx++)
+    {
+        pui32Words[ui32Idx] = (pui8Digest ?
+                               ((pui8Digest[(ui32Idx * 4) + 0] << 24) |
+                                (pui8Digest[(ui32Idx * 4) + 1] << 16) |
+                                (pui8Digest[(ui32Idx * 4) + 2] << 8) |
+                                pui8Digest[(ui32Idx * 4) + 3]) : 0);
+    }
+}
+
+//*****************************************************************************
+//
+// Appends a record to the signature cache, erasing it first if it is full.
+//
+//*****************************************************************************
+static void
+SignCacheWrite(uint32_t ui32Marker, const uint8_t *pui8Digest)
+{
+    uint32_t pui32Record[SIGN_CACHE_RECORD_SIZE / 4], ui32Next, ui32Idx;
+
+    SignCacheLast(&ui32Next);
+    if(ui32Next > SIGN_CACHE_LAST)
+    {
+        BL_FLASH_ERASE_FN_HOOK(SIGN_CACHE_ADDRESS);
+        ui32Next = SIGN_CACHE_ADDRESS;
+    }
+
+    pui32Record[0] = ui32Marker;
+    SignCacheWords(&pui32Record[1], pui8Digest);
+    pui32Record[SIGN_CACHE_WORDS + 1] = 0xffffffff;
+    for(ui32Idx = 1; ui32Idx <= SIGN_CACHE_WORDS; ui32Idx++)
+    {
+        pui32Record[SIGN_CACHE_WORDS + 1] ^= pui32Record[ui32Idx];
+    }
+    BL_FLASH_PROGRAM_FN_HOOK(ui32Next, (uint8_t *)pui32Record,
+                             SIGN_CACHE_RECORD_SIZE);
+}
+
+//*****************************************************************************
+//
+//! Checks whether an image has already passed the signature check.
+//!
+//! \param pui8Digest is the SHA-256 digest of the image, as computed by
+//! ImageSignatureDigest().
+//!
+//! This function checks whether the signature cache holds a valid record of
+//! an image with this digest passing the check, and no record since that
+//! clears it.  The digest is of the image as it is in flash now, so an image
+//! that has been changed since it was recorded is checked again.
+//!
+//! \return Returns non-zero if the image has passed the check or 0
+//! otherwise.
+//
+//*****************************************************************************
+uint32_t
+SignCacheCheck(const uint8_t *pui8Digest)
+{
+    uint32_t pui32Words[SIGN_CACHE_WORDS], ui32Last, ui32Next, ui32Idx;
+
+    ui32Last = SignCacheLast(&ui32Next);
+    if(!ui32Last || (HWREG(ui32Last) != SIGN_CACHE_VALID))
+    {
+        return(0);
+    }
+
+    SignCacheWords(pui32Words, pui8Digest);
+    for(ui32Idx = 0; ui32Idx < SIGN_CACHE_WORDS; ui32Idx++)
+    {
+        if(HWREG(ui32Last + 4 + (ui32Idx * 4)) != pui32Words[ui32Idx])
+        {
+            return(0);
+        }
+    }
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+//! Records that an image has passed the signature check.
+//!
+//! \param pui8Digest is the SHA-256 digest of the image, whose signature has
+//! been checked.
+//!
+//! This function appends a valid record holding the digest of the image to
+//! the signature cache, so that SignCacheCheck() finds it on later resets.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SignCacheRecord(const uint8_t *pui8Digest)
+{
+    SignCacheWrite(SIGN_CACHE_VALID, pui8Digest);
+}
+
+//*****************************************************************************
+//
+//! Forgets the image that passed the signature check.
+//!
+//! This function is called by the startup code whenever the boot loader is
+//! entered to perform an update, before any transport can change the image,
+//! so that whatever image is in place at the next reset is checked again.
+//! Nothing is written unless the cache holds a valid record.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SignCacheClear(void)
+{
+    uint32_t ui32Last, ui32Next;
+
+    ui32Last = SignCacheLast(&ui32Next);
+    if(ui32Last && (HWREG(ui32Last) == SIGN_CACHE_VALID))
+    {
+        SignCacheWrite(SIGN_CACHE_CLEAR, 0);
+    }
+}
+#endif
+
+#ifdef CHECK_SIGNATURE
+//*****************************************************************************
+//
+//! Checks the signature of an image, unless it has already passed the check.
+//!
+//! \param ui32Image is the address of the start of the image in flash.
+//!
+//! This function hashes the image as it is in flash and, with
+//! SIGN_CACHE_ADDRESS, skips verifying the signature if the signature cache
+//! holds the same digest.  Otherwise the signature is verified and, if it is
+//! good, the digest is recorded in the cache.
+//!
+//! \return Returns \b CHECK_SIGN_OK if the image is signed or one of the
+//! other \b CHECK_SIGN_ values returned by CheckImageSignature() if not.
+//
+//*****************************************************************************
+uint32_t
+SignCheckImage(uint32_t ui32Image)
+{
+    uint8_t pui8Digest[SHA256_DIGEST_SIZE];
+    uint32_t ui32Retcode;
+
+    ui32Retcode = ImageSignatureDigest(ui32Image, pui8Digest);
+    if(ui32Retcode != CHECK_SIGN_OK)
+    {
+        return(ui32Retcode);
+    }
+
+#ifdef SIGN_CACHE_ADDRESS
+    if(SignCacheCheck(pui8Digest))
+    {
+        return(CHECK_SIGN_OK);
+    }
+#endif
+
+    ui32Retcode = ImageSignatureVerify(ui32Image, pui8Digest);
+#ifdef SIGN_CACHE_ADDRESS
+    if(ui32Retcode == CHECK_SIGN_OK)
+    {
+        SignCacheRecord(pui8Digest);
+    }
+#endif
+
+    return(ui32Retcode);
+}
+#endif
+
 //*****************************************************************************
 //
 //! Checks if an update is needed or is being requested.
@@ -191,8 +440,6 @@ CheckForceUpdate(void)
     //
     return(BL_CHECK_UPDATE_FN_HOOK());
 #else
-    uint32_t *pui32App;
-
 #ifdef ENABLE_UPDATE_CHECK
     g_ui32Forced = 0;
 #endif
@@ -202,22 +449,33 @@ CheckForceUpdate(void)
     // look like a stack pointer, or if the second location is 0xffffffff or
     // something that does not look like a reset vector.
     //
-    pui32App = (uint32_t *)APP_START_ADDRESS;
-    if((pui32App[0] == 0xffffffff) ||
-       ((pui32App[0] & 0xfff00000) != 0x20000000) ||
-       (pui32App[1] == 0xffffffff) ||
-       ((pui32App[1] & 0xfff00001) != 0x00000001))
+    if((HWREG(APP_START_ADDRESS) == 0xffffffff) ||
+       ((HWREG(APP_START_ADDRESS) & 0xfff00000) != 0x20000000) ||
+       (HWREG(APP_START_ADDRESS + 4) == 0xffffffff) ||
+       ((HWREG(APP_START_ADDRESS + 4) & 0xfff00001) != 0x00000001))
     {
         return(1);
     }
 
+    //
+    // An update session that the watchdog cut short may have left the
+    // application part programmed, starting with a vector table that looks
+    // valid.  Keep control so that the host can resume the download.
+    //
+#if defined(BL_WATCHDOG_TIMEOUT) && defined(FLASH_JOURNAL_ADDRESS)
+    if(JournalUnfinished(APP_START_ADDRESS))
+    {
+        return(1);
+    }
+#endif
+
     //
     // If required, scan the image for an embedded CRC and ensure that it
     // matches the current CRC of the image.
     //
 #ifdef CHECK_CRC
     InitCRC32Table();
-    ui32Retcode = CheckImageCRC32(pui32App);
+    ui32Retcode = CheckImageCRC32((uint32_t *)APP_START_ADDRESS);
 
     //
     // If ENFORCE_CRC is defined, we only boot the image if the CRC is
@@ -242,6 +500,25 @@ CheckForceUpdate(void)
     }
 #endif
 
+    //
+    // If required, check that the image is signed by the holder of the
+    // private key matching the public key configured.  If the image hashes
+    // to the digest of the one that last passed the check, and the boot
+    // loader has not been entered for an update since, the signature is not
+    // verified again.
+    //
+#ifdef CHECK_SIGNATURE
+    if(SignCheckImage(APP_START_ADDRESS) != CHECK_SIGN_OK)
+    {
+        //
+        // The image is not signed, has been changed or is missing its
+        // signature, so fail the update check and force the boot loader to
+        // retain control.
+        //
+        return(2);
+    }
+#endif
+
 #ifdef ENABLE_UPDATE_CHECK
     //
     // If simple GPIO checking is configured, determine whether or not to force
@@ -35,5 +35,13 @@ extern uint32_t CheckForceUpdate(void);
 extern uint32_t CheckGPIOForceUpdate(void);
 extern uint32_t g_ui32Forced;
 #endif
+#ifdef CHECK_SIGNATURE
+extern uint32_t SignCheckImage(uint32_t ui32Image);
+#endif
+#ifdef SIGN_CACHE_ADDRESS
+extern uint32_t SignCacheCheck(const uint8_t *pui8Digest);
+extern void SignCacheRecord(const uint8_t *pui8Digest);
+extern void SignCacheClear(void);
+#endif
 
 #endif // __BL_CHECK_H__
@@ -201,7 +201,11 @@
 //*****************************************************************************
 //
 // This is returned in response to a COMMAND_GET_STATUS command and indicates
-// that the previous download command contained an invalid address value.
+// that the previous download command contained an invalid address value.  It
+// is also returned once a plain data (0x6006) packet past the end of the
+// image shows that an earlier block sent again was programmed twice, in which
+// case the start of the image has been erased and every further data packet
+// is answered with this status in place of COMMAND_RET_SUCCESS.
 //
 //*****************************************************************************
 #define COMMAND_RET_INVALID_ADR 0x43
@@ -239,4 +243,189 @@
 //*****************************************************************************
 #define COMMAND_NAK             0x33
 
+//*****************************************************************************
+//
+// The counters returned by a status read (register 0x6003, function 0x03),
+// which the serial boot loader answers with its current status and these
+// counters, so that a host can watch a transfer as it runs.  The reply is:
+//
+//     uint8_t ui8Reply[6 + (4 * NUM_STATS) + 2];
+//
+//     ui8Reply[0] = node ID;
+//     ui8Reply[1] = 0x03;
+//     ui8Reply[2] = 0x00;
+//     ui8Reply[3] = 0x06;
+//     ui8Reply[4] = status of the last command;
+//     ui8Reply[5] = NUM_STATS;
+//     ui8Reply[6 + (4 * n)] to ui8Reply[9 + (4 * n)] = counter n, MSB first;
+//     followed by the CRC16 of the bytes before it, MSB first.
+//
+// The counters are the packets received intact, those dropped for a bad
+// CRC16, those dropped part way through when the line went idle, the data
+// packets received out of sequence (which the host has to send again), the
+// receive FIFO overruns seen, the time in microseconds spent programming and
+// erasing flash, and the bytes of flash programmed, all since the boot
+// loader started.
+//
+//*****************************************************************************
+#define STAT_FRAMES             0
+#define STAT_CRC_ERRORS         1
+#define STAT_TIMEOUTS           2
+#define STAT_RETRANSMITS        3
+#define STAT_OVERRUNS           4
+#define STAT_PROGRAM_TIME       5
+#define STAT_ERASE_TIME         6
+#define STAT_PROGRAMMED         7
+#define NUM_STATS               8
+
+//*****************************************************************************
+//
+// A read of register 0x6004 (function 0x03, no data) returns the SHA-256
+// digest of the image downloaded so far if IMAGE_DIGEST is defined in the
+// boot loader configuration.  The reply is:
+//
+//     ui8Reply[0] = node ID;
+//     ui8Reply[1] = 0x03;
+//     ui8Reply[2] = 0x60;
+//     ui8Reply[3] = 0x04;
+//     ui8Reply[4] = status of the last command;
+//     ui8Reply[5] to ui8Reply[36] = the digest;
+//     ui8Reply[37] to ui8Reply[38] = the CRC16 of ui8Reply[0] to
+//                                    ui8Reply[36], MSB first.
+//
+// The digest covers the bytes of the download from its start address up to
+// the next block expected, or up to its size once it is complete, as read
+// back from flash.
+//
+//*****************************************************************************
+#define DIGEST_REPLY_SIZE       39
+
+//*****************************************************************************
+//
+// A write of register 0x600B (function 0x10, 32 bytes of data) installs a
+// new boot loader, if BL_UPDATE_STAGED is defined in the boot loader
+// configuration.  The host sends it once a download to address 0 has been
+// completed, with the SHA-256 digest of the new boot loader as its data.
+// The reply takes the same form as a digest read, with 0x0B in ui8Reply[3],
+// and gives the digest of the staged copy as read back from flash.  If the
+// status is COMMAND_RET_SUCCESS the boot loader then copies the staged copy
+// over itself and resets; otherwise COMMAND_RET_CRC_FAIL means the digests
+// differ or the copy has no valid vector table, and COMMAND_RET_INVALID_CMD
+// that no complete download to address 0 has been staged.
+//
+//*****************************************************************************
+#define INSTALL_DIGEST_SIZE     32
+
+//*****************************************************************************
+//
+// A write of register 0x600C (function 0x10, MANIFEST_SIZE bytes of data)
+// starts a manifest session, if ENABLE_MANIFEST_UPDATE is defined in the
+// boot loader configuration.  It takes the place of the download command
+// when more than one region of flash is to be updated, such as the
+// application and the parameter block reserved by FLASH_RSVD_SPACE.  The
+// data is:
+//
+//     ui8Data[0] = the number of regions, from 1 to MANIFEST_MAX_REGIONS;
+//     ui8Data[1 + (40 * n)] to ui8Data[4 + (40 * n)] = region n start
+//                                                      address, MSB first;
+//     ui8Data[5 + (40 * n)] to ui8Data[8 + (40 * n)] = region n size, MSB
+//                                                      first;
+//     ui8Data[9 + (40 * n)] to ui8Data[40 + (40 * n)] = the SHA-256 digest
+//                                                       of region n;
+//
+// with any unused regions filled with zeros.  Each region must be one that a
+// download command could start, other than the boot loader, and the regions
+// must not overlap.  The boot loader erases all of them and answers with a
+// progress report (as for a read of 0x6005) giving the status and block 0.
+// The data blocks that follow carry the regions one after another, each
+// padded with 0xFF to a whole number of blocks, and are numbered from 0
+// across all of them; a skip (0x6008) must not run past the end of a region.
+// Once the last block has been programmed, the boot loader reads every
+// region back from flash and compares its digest with the one given here,
+// setting the status to COMMAND_RET_CRC_FAIL if any differs.  A manifest
+// session cannot be resumed with 0x6009.
+//
+//*****************************************************************************
+#define MANIFEST_MAX_REGIONS    3
+#define MANIFEST_SIZE           (1 + (40 * MANIFEST_MAX_REGIONS))
+
+//*****************************************************************************
+//
+// A write of register 0x600A (function 0x10, 16 bytes of data) sets the
+// initial counter block (CTR mode) or IV (CBC mode) from which the data
+// blocks that follow are decrypted, if DECRYPT_AES_MODE is defined in the
+// boot loader configuration, and is answered with an ACK.  The host sends it
+// after the download command.  After a resume command it sends the value
+// that decrypts the block the transfer resumes from: the initial counter
+// block plus the number of 16 byte blocks before it in CTR mode, or the last
+// 16 bytes of ciphertext before it in CBC mode.  The same goes for the block
+// after a skip (0x6008) in CBC mode; CTR mode counts past skipped blocks by
+// itself.
+//
+//*****************************************************************************
+#define DECRYPT_IV_SIZE         16
+
+//*****************************************************************************
+//
+// A read of register 0x600D (function 0x03, 2 bytes of data giving the first
+// block wanted, MSB first) returns the erase counters of WEAR_REPLY_BLOCKS
+// erasable blocks of flash from that one on, if FLASH_WEAR_EEPROM_ADDRESS is
+// defined in the boot loader configuration.  Block n is the one at n times
+// the erase size (16 KB on TM4C129 devices).  The reply is:
+//
+//     ui8Reply[0] = node ID;
+//     ui8Reply[1] = 0x03;
+//     ui8Reply[2] = 0x60;
+//     ui8Reply[3] = 0x0D;
+//     ui8Reply[4] = status of the last command;
+//     ui8Reply[5] to ui8Reply[6] = the first block, MSB first;
+//     ui8Reply[7] = WEAR_REPLY_BLOCKS;
+//     ui8Reply[8] to ui8Reply[11] = the erases skipped since the boot loader
+//                                   started because the block was already
+//                                   blank, MSB first;
+//     ui8Reply[12 + (2 * n)] to ui8Reply[13 + (2 * n)] = the erases of block
+//                                                        first + n, MSB
+//                                                        first;
+//     followed by the CRC16 of the bytes before it, MSB first.
+//
+// Blocks past the end of the flash read as never erased.  The counters stop
+// at 65535.
+//
+//*****************************************************************************
+#define WEAR_REPLY_BLOCKS       32
+#define WEAR_REPLY_SIZE         (12 + (2 * WEAR_REPLY_BLOCKS) + 2)
+
+//*****************************************************************************
+//
+// A read of register 0x600E (function 0x03, 8 bytes of data giving the start
+// address and the size of a region of flash, both MSB first) reads that
+// region back, if ENABLE_FLASH_DUMP is defined in the boot loader
+// configuration.  The reply is a run of frames, sent back to back, that
+// each carry the next DUMP_FRAME_SIZE bytes of the region or what is left of
+// it:
+//
+//     ui8Reply[0] = node ID;
+//     ui8Reply[1] = 0x03;
+//     ui8Reply[2] = 0x60;
+//     ui8Reply[3] = 0x0E;
+//     ui8Reply[4] = status;
+//     ui8Reply[5] to ui8Reply[8] = the address of the first byte, MSB first;
+//     ui8Reply[9] to ui8Reply[10] = the number of bytes n, MSB first;
+//     ui8Reply[11] to ui8Reply[10 + n] = the bytes of flash;
+//     ui8Reply[11 + n] to ui8Reply[12 + n] = the CRC16 of ui8Reply[0] to
+//                                            ui8Reply[10 + n], MSB first.
+//
+// The CRC16 is the one that terminates a packet (see CHECK_PACKET_CRC).  The
+// start address and size must be multiples of four and the region must lie
+// within flash and clear of any block marked execute-only; otherwise one
+// frame with no data and a status of COMMAND_RET_INVALID_ADR is sent, or
+// COMMAND_RET_INVALID_CMD if the boot loader was built with
+// FLASH_CODE_PROTECTION.  The boot loader does not wait for the host between
+// frames, so a host that finds a frame damaged lets the rest arrive and then
+// reads again from that frame's address.
+//
+//*****************************************************************************
+#define DUMP_FRAME_SIZE         1024
+#define DUMP_HEADER_SIZE        11
+
 #endif // __BL_COMMANDS_H__
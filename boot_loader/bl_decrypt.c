@@ -0,0 +1,867 @@
+//*****************************************************************************
+//
+// bl_decrypt.c - Code for performing an in-place decryption of the firmware
+//                image as it is downloaded.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_aes.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "bl_config.h"
+#include "driverlib/aes.h"
+#include "driverlib/udma.h"
+#include "boot_loader/bl_dma.h"
+#include "boot_loader/bl_decrypt.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_decrypt_api
+//! @{
+//
+//*****************************************************************************
+#if defined(ENABLE_DECRYPTION) || defined(DOXYGEN)
+
+#if defined(DECRYPT_AES_MODE) || defined(DOXYGEN)
+#if defined(DECRYPT_AES_MODE) && \
+    (DECRYPT_AES_MODE != AES_CFG_MODE_CTR) && \
+    (DECRYPT_AES_MODE != AES_CFG_MODE_CBC)
+#error ERROR: DECRYPT_AES_MODE must be AES_CFG_MODE_CTR or AES_CFG_MODE_CBC!
+#endif
+
+//*****************************************************************************
+//
+// The uDMA channels that move data into and out of the AES module.
+//
+//*****************************************************************************
+#define DECRYPT_DMA_IN          UDMA_CH14_AES0DIN
+#define DECRYPT_DMA_IN_NUM      14
+#define DECRYPT_DMA_OUT         UDMA_CH15_AES0DOUT
+#define DECRYPT_DMA_OUT_NUM     15
+
+//*****************************************************************************
+//
+// The most bytes that one uDMA transfer of at most 1024 words can move.
+//
+//*****************************************************************************
+#define DECRYPT_DMA_MAX         (1024 * 4)
+
+//*****************************************************************************
+//
+// The key, and the round keys that the software AES expands it into.
+//
+//*****************************************************************************
+static const uint32_t g_pui32DecryptKey[AES_KEY_SIZE / 4] =
+{
+    DECRYPT_AES_KEY
+};
+static uint8_t g_pui8DecryptRoundKeys[AES_BLOCK_SIZE * 11];
+
+//*****************************************************************************
+//
+// In CTR mode, the counter block from which the next key stream is
+// generated, and the key stream, of which the first g_ui32DecryptUsed bytes
+// have been used.  In CBC mode, the IV for the next block, which is the last
+// block of ciphertext decrypted.
+//
+//*****************************************************************************
+static uint8_t g_pui8DecryptIV[AES_BLOCK_SIZE];
+#if DECRYPT_AES_MODE == AES_CFG_MODE_CTR
+static uint32_t g_pui32DecryptStream[DECRYPT_STREAM_SIZE / 4];
+#endif
+static uint32_t g_ui32DecryptUsed;
+
+//*****************************************************************************
+//
+// The point that DecryptRewind() goes back to, as left by the last block
+// programmed: the counter block and the bytes used of the key stream
+// generated from it in CTR mode, or the IV in CBC mode.  In CTR mode, the
+// counter block that the key stream was generated from is also kept, so that
+// it can be generated again.
+//
+//*****************************************************************************
+static uint8_t g_pui8DecryptCommitIV[AES_BLOCK_SIZE];
+#if DECRYPT_AES_MODE == AES_CFG_MODE_CTR
+static uint32_t g_ui32DecryptCommitUsed;
+static uint8_t g_pui8DecryptStreamIV[AES_BLOCK_SIZE];
+#endif
+
+//*****************************************************************************
+//
+// Set once the key has been expanded and, with CRYPTO_ENABLE_HW, the AES
+// module enabled, and set while the module is generating key stream.
+//
+//*****************************************************************************
+static bool g_bDecryptReady;
+#ifdef CRYPTO_ENABLE_HW
+static bool g_bDecryptBusy;
+
+//*****************************************************************************
+//
+// The word of zeros that the AES module encrypts in CTR mode, leaving only
+// the key stream.
+//
+//*****************************************************************************
+#if DECRYPT_AES_MODE == AES_CFG_MODE_CTR
+static const uint32_t g_ui32DecryptZero = 0;
+#endif
+#endif
+
+//*****************************************************************************
+//
+// The AES substitution box and its inverse.
+//
+//*****************************************************************************
+static const uint8_t g_pui8AESSBox[256] =
+{
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5,
+    0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0,
+    0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc,
+    0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a,
+    0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0,
+    0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b,
+    0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85,
+    0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5,
+    0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17,
+    0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88,
+    0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c,
+    0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9,
+    0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6,
+    0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e,
+    0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94,
+    0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68,
+    0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16
+};
+
+static const uint8_t g_pui8AESInvSBox[256] =
+{
+    0x52, 0x09, 0x6a, 0xd5, 0x30, 0x36, 0xa5, 0x38,
+    0xbf, 0x40, 0xa3, 0x9e, 0x81, 0xf3, 0xd7, 0xfb,
+    0x7c, 0xe3, 0x39, 0x82, 0x9b, 0x2f, 0xff, 0x87,
+    0x34, 0x8e, 0x43, 0x44, 0xc4, 0xde, 0xe9, 0xcb,
+    0x54, 0x7b, 0x94, 0x32, 0xa6, 0xc2, 0x23, 0x3d,
+    0xee, 0x4c, 0x95, 0x0b, 0x42, 0xfa, 0xc3, 0x4e,
+    0x08, 0x2e, 0xa1, 0x66, 0x28, 0xd9, 0x24, 0xb2,
+    0x76, 0x5b, 0xa2, 0x49, 0x6d, 0x8b, 0xd1, 0x25,
+    0x72, 0xf8, 0xf6, 0x64, 0x86, 0x68, 0x98, 0x16,
+    0xd4, 0xa4, 0x5c, 0xcc, 0x5d, 0x65, 0xb6, 0x92,
+    0x6c, 0x70, 0x48, 0x50, 0xfd, 0xed, 0xb9, 0xda,
+    0x5e, 0x15, 0x46, 0x57, 0xa7, 0x8d, 0x9d, 0x84,
+    0x90, 0xd8, 0xab, 0x00, 0x8c, 0xbc, 0xd3, 0x0a,
+    0xf7, 0xe4, 0x58, 0x05, 0xb8, 0xb3, 0x45, 0x06,
+    0xd0, 0x2c, 0x1e, 0x8f, 0xca, 0x3f, 0x0f, 0x02,
+    0xc1, 0xaf, 0xbd, 0x03, 0x01, 0x13, 0x8a, 0x6b,
+    0x3a, 0x91, 0x11, 0x41, 0x4f, 0x67, 0xdc, 0xea,
+    0x97, 0xf2, 0xcf, 0xce, 0xf0, 0xb4, 0xe6, 0x73,
+    0x96, 0xac, 0x74, 0x22, 0xe7, 0xad, 0x35, 0x85,
+    0xe2, 0xf9, 0x37, 0xe8, 0x1c, 0x75, 0xdf, 0x6e,
+    0x47, 0xf1, 0x1a, 0x71, 0x1d, 0x29, 0xc5, 0x89,
+    0x6f, 0xb7, 0x62, 0x0e, 0xaa, 0x18, 0xbe, 0x1b,
+    0xfc, 0x56, 0x3e, 0x4b, 0xc6, 0xd2, 0x79, 0x20,
+    0x9a, 0xdb, 0xc0, 0xfe, 0x78, 0xcd, 0x5a, 0xf4,
+    0x1f, 0xdd, 0xa8, 0x33, 0x88, 0x07, 0xc7, 0x31,
+    0xb1, 0x12, 0x10, 0x59, 0x27, 0x80, 0xec, 0x5f,
+    0x60, 0x51, 0x7f, 0xa9, 0x19, 0xb5, 0x4a, 0x0d,
+    0x2d, 0xe5, 0x7a, 0x9f, 0x93, 0xc9, 0x9c, 0xef,
+    0xa0, 0xe0, 0x3b, 0x4d, 0xae, 0x2a, 0xf5, 0xb0,
+    0xc8, 0xeb, 0xbb, 0x3c, 0x83, 0x53, 0x99, 0x61,
+    0x17, 0x2b, 0x04, 0x7e, 0xba, 0x77, 0xd6, 0x26,
+    0xe1, 0x69, 0x14, 0x63, 0x55, 0x21, 0x0c, 0x7d
+};
+
+//*****************************************************************************
+//
+// Multiplies a byte by x in GF(2^8).
+//
+//*****************************************************************************
+#define XTIME(x)                ((uint8_t)(((x) << 1) ^ (((x) & 0x80) ? \
+                                                         0x1b : 0)))
+
+//*****************************************************************************
+//
+// Mixes each column of the state, as the MixColumns() step of AES.
+//
+//*****************************************************************************
+static void
+AESMixColumns(uint8_t *pui8State)
+{
+    uint8_t ui8A0, ui8A1, ui8A2, ui8A3, ui8All;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx += 4)
+    {
+        ui8A0 = pui8State[ui32Idx];
+        ui8A1 = pui8State[ui32Idx + 1];
+        ui8A2 = pui8State[ui32Idx + 2];
+        ui8A3 = pui8State[ui32Idx + 3];
+        ui8All = ui8A0 ^ ui8A1 ^ ui8A2 ^ ui8A3;
+        pui8State[ui32Idx] ^= ui8All ^ XTIME(ui8A0 ^ ui8A1);
+        pui8State[ui32Idx + 1] ^= ui8All ^ XTIME(ui8A1 ^ ui8A2);
+        pui8State[ui32Idx + 2] ^= ui8All ^ XTIME(ui8A2 ^ ui8A3);
+        pui8State[ui32Idx + 3] ^= ui8All ^ XTIME(ui8A3 ^ ui8A0);
+    }
+}
+
+//*****************************************************************************
+//
+// Expands the key into the round keys, and checks whether the device has an
+// AES module that the boot loader is configured to use.  If so, the module
+// is enabled along with the uDMA channels that feed it.
+//
+//*****************************************************************************
+static void
+DecryptInit(void)
+{
+    uint8_t pui8Word[4], ui8Temp, ui8RCon;
+    uint32_t ui32Idx;
+
+    g_bDecryptReady = true;
+    g_ui32DecryptUsed = DECRYPT_STREAM_SIZE;
+
+    //
+    // Each word of the round keys is the one before it, rotated, substituted
+    // and with the round constant added once every four words, added to the
+    // word four before it.
+    //
+    ui8RCon = 1;
+    for(ui32Idx = 0; ui32Idx < sizeof(g_pui8DecryptRoundKeys); ui32Idx += 4)
+    {
+        if(ui32Idx < AES_KEY_SIZE)
+        {
+            for(ui8Temp = 0; ui8Temp < 4; ui8Temp++)
+            {
+                g_pui8DecryptRoundKeys[ui32Idx + ui8Temp] =
+                    (uint8_t)(g_pui32DecryptKey[ui32Idx / 4] >>
+                              (24 - (8 * ui8Temp)));
+            }
+            continue;
+        }
+        for(ui8Temp = 0; ui8Temp < 4; ui8Temp++)
+        {
+            pui8Word[ui8Temp] = g_pui8DecryptRoundKeys[ui32Idx - 4 + ui8Temp];
+        }
+        if(!(ui32Idx % AES_KEY_SIZE))
+        {
+            ui8Temp = pui8Word[0];
+            pui8Word[0] = g_pui8AESSBox[pui8Word[1]] ^ ui8RCon;
+            pui8Word[1] = g_pui8AESSBox[pui8Word[2]];
+            pui8Word[2] = g_pui8AESSBox[pui8Word[3]];
+            pui8Word[3] = g_pui8AESSBox[ui8Temp];
+            ui8RCon = XTIME(ui8RCon);
+        }
+        for(ui8Temp = 0; ui8Temp < 4; ui8Temp++)
+        {
+            g_pui8DecryptRoundKeys[ui32Idx + ui8Temp] =
+                (g_pui8DecryptRoundKeys[ui32Idx - AES_KEY_SIZE + ui8Temp] ^
+                 pui8Word[ui8Temp]);
+        }
+    }
+
+#ifdef CRYPTO_ENABLE_HW
+    //
+    // Enable the clock to the cryptographic modules and let the AES module
+    // exchange its data with the uDMA controller.  The devices without the
+    // module still report the CRC module that shares its peripheral as
+    // present, so CRYPTO_ENABLE_HW, rather than a run-time check, says that
+    // the module is there.
+    //
+    HWREG(SYSCTL_RCGCCCM) |= SYSCTL_RCGCCCM_R0;
+    while(!(HWREG(SYSCTL_PRCCM) & SYSCTL_PRCCM_R0))
+    {
+    }
+    AESReset(AES_BASE);
+    BLDMAInit();
+    uDMAChannelAssign(DECRYPT_DMA_IN);
+    uDMAChannelAssign(DECRYPT_DMA_OUT);
+    uDMAChannelAttributeDisable(DECRYPT_DMA_IN_NUM, UDMA_ATTR_ALL);
+    uDMAChannelAttributeDisable(DECRYPT_DMA_OUT_NUM, UDMA_ATTR_ALL);
+#endif
+}
+
+#ifdef CRYPTO_ENABLE_HW
+//*****************************************************************************
+//
+// Starts the AES module on a number of bytes, which are read by one uDMA
+// channel from pvSrc, or all from the word at pvSrc if bSrcFixed is set, and
+// written by the other to pui8Dst.  The key is loaded along with the mode,
+// since nothing else in the boot loader keeps it.
+//
+//*****************************************************************************
+static void
+DecryptHardwareStart(uint32_t ui32Config, const void *pvSrc, bool bSrcFixed,
+                     uint8_t *pui8Dst, uint32_t ui32Size)
+{
+    uint32_t pui32Words[4], ui32Idx;
+
+    AESConfigSet(AES_BASE, (AES_CFG_KEY_SIZE_128BIT | ui32Config));
+    for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+    {
+        pui32Words[ui32Idx] =
+            ((g_pui32DecryptKey[ui32Idx] >> 24) |
+             ((g_pui32DecryptKey[ui32Idx] >> 8) & 0x0000ff00) |
+             ((g_pui32DecryptKey[ui32Idx] << 8) & 0x00ff0000) |
+             (g_pui32DecryptKey[ui32Idx] << 24));
+    }
+    AESKey1Set(AES_BASE, pui32Words, AES_CFG_KEY_SIZE_128BIT);
+    for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+    {
+        pui32Words[ui32Idx] = ((g_pui8DecryptIV[(4 * ui32Idx) + 3] << 24) |
+                               (g_pui8DecryptIV[(4 * ui32Idx) + 2] << 16) |
+                               (g_pui8DecryptIV[(4 * ui32Idx) + 1] << 8) |
+                               g_pui8DecryptIV[4 * ui32Idx]);
+    }
+    AESIVSet(AES_BASE, pui32Words);
+    AESLengthSet(AES_BASE, (uint64_t)ui32Size);
+
+    uDMAChannelControlSet(DECRYPT_DMA_IN_NUM | UDMA_PRI_SELECT,
+                          (UDMA_SIZE_32 |
+                           (bSrcFixed ? UDMA_SRC_INC_NONE : UDMA_SRC_INC_32) |
+                           UDMA_DST_INC_NONE | UDMA_ARB_4));
+    uDMAChannelTransferSet(DECRYPT_DMA_IN_NUM | UDMA_PRI_SELECT,
+                           UDMA_MODE_BASIC, (void *)pvSrc,
+                           (void *)(AES_BASE + AES_O_DATA_IN_0), ui32Size / 4);
+    uDMAChannelControlSet(DECRYPT_DMA_OUT_NUM | UDMA_PRI_SELECT,
+                          (UDMA_SIZE_32 | UDMA_SRC_INC_NONE |
+                           UDMA_DST_INC_32 | UDMA_ARB_4));
+    uDMAChannelTransferSet(DECRYPT_DMA_OUT_NUM | UDMA_PRI_SELECT,
+                           UDMA_MODE_BASIC,
+                           (void *)(AES_BASE + AES_O_DATA_IN_0), pui8Dst,
+                           ui32Size / 4);
+    AESDMAEnable(AES_BASE, AES_DMA_DATA_IN | AES_DMA_DATA_OUT);
+    uDMAChannelEnable(DECRYPT_DMA_IN_NUM);
+    uDMAChannelEnable(DECRYPT_DMA_OUT_NUM);
+}
+#endif
+
+//*****************************************************************************
+//
+// Waits for the AES module to finish generating key stream, if it is.
+//
+//*****************************************************************************
+static void
+DecryptWait(void)
+{
+#ifdef CRYPTO_ENABLE_HW
+    if(g_bDecryptBusy)
+    {
+        while(uDMAChannelIsEnabled(DECRYPT_DMA_OUT_NUM))
+        {
+        }
+        AESDMADisable(AES_BASE, AES_DMA_DATA_IN | AES_DMA_DATA_OUT);
+        g_bDecryptBusy = false;
+    }
+#endif
+}
+
+#if DECRYPT_AES_MODE == AES_CFG_MODE_CTR
+//*****************************************************************************
+//
+// Adds a number of blocks to the counter block, which is a 128-bit big-endian
+// number.
+//
+//*****************************************************************************
+static void
+DecryptCount(uint32_t ui32Blocks)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = AES_BLOCK_SIZE; ui32Blocks && ui32Idx--; )
+    {
+        ui32Blocks += g_pui8DecryptIV[ui32Idx];
+        g_pui8DecryptIV[ui32Idx] = (uint8_t)ui32Blocks;
+        ui32Blocks >>= 8;
+    }
+}
+
+//*****************************************************************************
+//
+// Starts generating the key stream for the next DECRYPT_STREAM_SIZE bytes
+// from the counter block.  The AES module carries on in the background while
+// the software AES finishes before returning.
+//
+//*****************************************************************************
+static void
+DecryptStreamFill(void)
+{
+    uint8_t *pui8Stream;
+    uint32_t ui32Idx;
+
+    DecryptWait();
+    g_ui32DecryptUsed = 0;
+    pui8Stream = (uint8_t *)g_pui32DecryptStream;
+    for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+    {
+        g_pui8DecryptStreamIV[ui32Idx] = g_pui8DecryptIV[ui32Idx];
+    }
+
+#ifdef CRYPTO_ENABLE_HW
+    DecryptHardwareStart((AES_CFG_DIR_ENCRYPT | AES_CFG_MODE_CTR |
+                          AES_CFG_CTR_WIDTH_128), &g_ui32DecryptZero,
+                         true, pui8Stream, DECRYPT_STREAM_SIZE);
+    g_bDecryptBusy = true;
+    DecryptCount(DECRYPT_STREAM_SIZE / AES_BLOCK_SIZE);
+#else
+    for(ui32Idx = 0; ui32Idx < DECRYPT_STREAM_SIZE; ui32Idx++)
+    {
+        pui8Stream[ui32Idx] = g_pui8DecryptIV[ui32Idx % AES_BLOCK_SIZE];
+        if((ui32Idx % AES_BLOCK_SIZE) == (AES_BLOCK_SIZE - 1))
+        {
+            AES128Encrypt(pui8Stream + ui32Idx + 1 - AES_BLOCK_SIZE);
+            DecryptCount(1);
+        }
+    }
+#endif
+}
+#endif
+
+//*****************************************************************************
+//
+//! Encrypts one block with the AES-128 key.
+//!
+//! \param pui8Block points to the block, which is replaced by its ciphertext.
+//!
+//! This function runs the AES cipher in software with the key given by
+//! DECRYPT_AES_KEY.  It generates the key stream in CTR mode when there is no
+//! AES module to do so.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+AES128Encrypt(uint8_t *pui8Block)
+{
+    uint8_t pui8State[AES_BLOCK_SIZE];
+    uint32_t ui32Round, ui32Idx;
+
+    if(!g_bDecryptReady)
+    {
+        DecryptInit();
+    }
+
+    for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+    {
+        pui8Block[ui32Idx] ^= g_pui8DecryptRoundKeys[ui32Idx];
+    }
+    for(ui32Round = 1; ui32Round <= 10; ui32Round++)
+    {
+        //
+        // Substitute the bytes and shift row n of the state left by n
+        // columns in one pass.
+        //
+        for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+        {
+            pui8State[ui32Idx] =
+                g_pui8AESSBox[pui8Block[(ui32Idx + (4 * (ui32Idx & 3))) &
+                                        (AES_BLOCK_SIZE - 1)]];
+        }
+        if(ui32Round != 10)
+        {
+            AESMixColumns(pui8State);
+        }
+        for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+        {
+            pui8Block[ui32Idx] = (pui8State[ui32Idx] ^
+                                  g_pui8DecryptRoundKeys[(ui32Round *
+                                                          AES_BLOCK_SIZE) +
+                                                         ui32Idx]);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Decrypts one block with the AES-128 key.
+//!
+//! \param pui8Block points to the block, which is replaced by its plaintext.
+//!
+//! This function runs the inverse AES cipher in software with the key given
+//! by DECRYPT_AES_KEY.  It decrypts the data in CBC mode when there is no AES
+//! module to do so.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+AES128Decrypt(uint8_t *pui8Block)
+{
+    uint8_t pui8State[AES_BLOCK_SIZE], ui8U, ui8V;
+    uint32_t ui32Round, ui32Idx;
+
+    if(!g_bDecryptReady)
+    {
+        DecryptInit();
+    }
+
+    for(ui32Round = 10; ui32Round--; )
+    {
+        //
+        // Remove the round key, then undo the mixing of the columns, which
+        // is the same mixing after each column has been multiplied by
+        // 4x^2 + 5 (for all but the last round of the cipher).
+        //
+        for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+        {
+            pui8Block[ui32Idx] ^=
+                g_pui8DecryptRoundKeys[((ui32Round + 1) * AES_BLOCK_SIZE) +
+                                       ui32Idx];
+        }
+        if(ui32Round != 9)
+        {
+            for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx += 4)
+            {
+                ui8U = XTIME(pui8Block[ui32Idx] ^ pui8Block[ui32Idx + 2]);
+                ui8U = XTIME(ui8U);
+                ui8V = XTIME(pui8Block[ui32Idx + 1] ^ pui8Block[ui32Idx + 3]);
+                ui8V = XTIME(ui8V);
+                pui8Block[ui32Idx] ^= ui8U;
+                pui8Block[ui32Idx + 1] ^= ui8V;
+                pui8Block[ui32Idx + 2] ^= ui8U;
+                pui8Block[ui32Idx + 3] ^= ui8V;
+            }
+            AESMixColumns(pui8Block);
+        }
+
+        //
+        // Shift row n of the state right by n columns and undo the
+        // substitution of the bytes in one pass.
+        //
+        for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+        {
+            pui8State[ui32Idx] =
+                g_pui8AESInvSBox[pui8Block[(ui32Idx - (4 * (ui32Idx & 3))) &
+                                           (AES_BLOCK_SIZE - 1)]];
+        }
+        for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+        {
+            pui8Block[ui32Idx] = pui8State[ui32Idx];
+        }
+    }
+    for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+    {
+        pui8Block[ui32Idx] ^= g_pui8DecryptRoundKeys[ui32Idx];
+    }
+}
+
+//*****************************************************************************
+//
+//! Starts decrypting a download.
+//!
+//! \param pui8IV points to the initial counter block in CTR mode, or to the
+//! IV in CBC mode, of the data that follows.
+//!
+//! This function sets the point in the encrypted image from which
+//! DecryptData() carries on.  The host sets it after the download command,
+//! and again after a resume command with the counter block or IV that
+//! decrypts the first block that the transfer resumes from.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DecryptStart(const uint8_t *pui8IV)
+{
+    uint32_t ui32Idx;
+
+    if(!g_bDecryptReady)
+    {
+        DecryptInit();
+    }
+
+    //
+    // Discard any key stream generated from the last counter block.
+    //
+    DecryptWait();
+    g_ui32DecryptUsed = DECRYPT_STREAM_SIZE;
+
+    for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+    {
+        g_pui8DecryptIV[ui32Idx] = pui8IV[ui32Idx];
+    }
+    DecryptCommit();
+}
+
+//*****************************************************************************
+//
+//! Keeps the point that decryption has reached.
+//!
+//! This function is called once a decrypted block has been programmed, so
+//! that DecryptRewind() carries on from after it.  DecryptStart() and
+//! DecryptSkip() also keep the point that they set.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DecryptCommit(void)
+{
+    uint32_t ui32Idx;
+
+#if DECRYPT_AES_MODE == AES_CFG_MODE_CTR
+    //
+    // Part way through the key stream, go back to the counter block that
+    // generated it.
+    //
+    g_ui32DecryptCommitUsed = g_ui32DecryptUsed;
+    if(g_ui32DecryptUsed != DECRYPT_STREAM_SIZE)
+    {
+        for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+        {
+            g_pui8DecryptCommitIV[ui32Idx] = g_pui8DecryptStreamIV[ui32Idx];
+        }
+        return;
+    }
+#endif
+    for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+    {
+        g_pui8DecryptCommitIV[ui32Idx] = g_pui8DecryptIV[ui32Idx];
+    }
+}
+
+//*****************************************************************************
+//
+//! Goes back to the point that decryption was last kept at.
+//!
+//! This function is called when a decrypted block could not be programmed.
+//! The host sends the block again, which must be decrypted with the same
+//! counter block or IV as before, so the decryption of the block that failed
+//! is undone.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DecryptRewind(void)
+{
+    uint32_t ui32Idx;
+
+    DecryptWait();
+    for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+    {
+        g_pui8DecryptIV[ui32Idx] = g_pui8DecryptCommitIV[ui32Idx];
+    }
+#if DECRYPT_AES_MODE == AES_CFG_MODE_CTR
+    //
+    // Generate the key stream that was part used again.
+    //
+    g_ui32DecryptUsed = DECRYPT_STREAM_SIZE;
+    if(g_ui32DecryptCommitUsed != DECRYPT_STREAM_SIZE)
+    {
+        DecryptStreamFill();
+        g_ui32DecryptUsed = g_ui32DecryptCommitUsed;
+    }
+#endif
+}
+
+//*****************************************************************************
+//
+//! Starts generating the key stream for the next packet.
+//!
+//! In CTR mode with an AES module, this function starts the module on the
+//! key stream that the next packet will need once the last one has been used
+//! up, so that it is generated while the packet just decrypted is being
+//! programmed.  It does nothing otherwise.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DecryptPrefetch(void)
+{
+#if (DECRYPT_AES_MODE == AES_CFG_MODE_CTR) && defined(CRYPTO_ENABLE_HW)
+    if(!g_bDecryptBusy && (g_ui32DecryptUsed == DECRYPT_STREAM_SIZE))
+    {
+        DecryptStreamFill();
+    }
+#endif
+}
+
+//*****************************************************************************
+//
+//! Moves the decryption past data that is not sent.
+//!
+//! \param ui32Size is the number of bytes of the image skipped.
+//!
+//! In CTR mode this function moves the key stream on past a run of the image
+//! that the host skipped rather than sending.  CBC mode cannot carry on past
+//! a gap, so there the host must set the IV again before the next block.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DecryptSkip(uint32_t ui32Size)
+{
+#if DECRYPT_AES_MODE == AES_CFG_MODE_CTR
+    if(ui32Size <= (DECRYPT_STREAM_SIZE - g_ui32DecryptUsed))
+    {
+        g_ui32DecryptUsed += ui32Size;
+        DecryptCommit();
+        return;
+    }
+
+    //
+    // The counter block already follows the key stream, so count on from it
+    // past the rest of the skipped data, then use up the part of its block
+    // that falls in the skip.
+    //
+    ui32Size -= DECRYPT_STREAM_SIZE - g_ui32DecryptUsed;
+    DecryptWait();
+    DecryptCount(ui32Size / AES_BLOCK_SIZE);
+    g_ui32DecryptUsed = DECRYPT_STREAM_SIZE;
+    if(ui32Size % AES_BLOCK_SIZE)
+    {
+        DecryptStreamFill();
+        g_ui32DecryptUsed = ui32Size % AES_BLOCK_SIZE;
+    }
+    DecryptCommit();
+#else
+    //
+    // The host sets the IV again before the next block.
+    //
+    (void)ui32Size;
+#endif
+}
+#endif
+
+//*****************************************************************************
+//
+//! Performs an in-place decryption of downloaded data.
+//!
+//! \param pui8Buffer is the buffer that holds the data to decrypt.
+//! \param ui32Size is the size, in bytes, of the buffer that was passed in
+//! via the pui8Buffer parameter.
+//!
+//! With DECRYPT_AES_MODE defined, this function decrypts the data with
+//! AES-128, carrying on from the data before it.  In CTR mode the data is
+//! combined with the key stream, generated a packet at a time.  In CBC mode
+//! whole blocks are decrypted, by the AES module through the uDMA controller
+//! if the buffer is word aligned, and a partial block at the end is left
+//! alone.  Without DECRYPT_AES_MODE this function is a stub that could
+//! provide in-place decryption of the data that is being downloaded to the
+//! device.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DecryptData(uint8_t *pui8Buffer, uint32_t ui32Size)
+{
+#if defined(DECRYPT_AES_MODE)
+#if DECRYPT_AES_MODE == AES_CFG_MODE_CTR
+    uint8_t *pui8Stream;
+
+    if(!g_bDecryptReady)
+    {
+        DecryptInit();
+    }
+
+    pui8Stream = (uint8_t *)g_pui32DecryptStream;
+    while(ui32Size--)
+    {
+        if(g_ui32DecryptUsed == DECRYPT_STREAM_SIZE)
+        {
+            DecryptStreamFill();
+        }
+        DecryptWait();
+        *pui8Buffer++ ^= pui8Stream[g_ui32DecryptUsed++];
+    }
+#else
+    uint8_t pui8Next[AES_BLOCK_SIZE];
+    uint32_t ui32Idx, ui32Chunk;
+
+    if(!g_bDecryptReady)
+    {
+        DecryptInit();
+    }
+
+    ui32Size &= ~(AES_BLOCK_SIZE - 1);
+    while(ui32Size)
+    {
+#ifdef CRYPTO_ENABLE_HW
+        if(!((uint32_t)pui8Buffer & 3))
+        {
+            //
+            // Decrypt as much as one uDMA transfer can move, keeping the last
+            // block of ciphertext, which the decryption overwrites, as the IV
+            // of the data that follows.
+            //
+            ui32Chunk = ((ui32Size > DECRYPT_DMA_MAX) ? DECRYPT_DMA_MAX :
+                         ui32Size);
+            for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+            {
+                pui8Next[ui32Idx] =
+                    pui8Buffer[ui32Chunk - AES_BLOCK_SIZE + ui32Idx];
+            }
+            DecryptHardwareStart((AES_CFG_DIR_DECRYPT | AES_CFG_MODE_CBC),
+                                 pui8Buffer, false, pui8Buffer, ui32Chunk);
+            g_bDecryptBusy = true;
+            DecryptWait();
+        }
+        else
+#endif
+        {
+            ui32Chunk = AES_BLOCK_SIZE;
+            for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+            {
+                pui8Next[ui32Idx] = pui8Buffer[ui32Idx];
+            }
+            AES128Decrypt(pui8Buffer);
+            for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+            {
+                pui8Buffer[ui32Idx] ^= g_pui8DecryptIV[ui32Idx];
+            }
+        }
+        for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+        {
+            g_pui8DecryptIV[ui32Idx] = pui8Next[ui32Idx];
+        }
+        pui8Buffer += ui32Chunk;
+        ui32Size -= ui32Chunk;
+    }
+#endif
+#endif
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+#endif
@@ -0,0 +1,59 @@
+//*****************************************************************************
+//
+// bl_decrypt.h - The definitions used for decrypting the downloaded image.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_DECRYPT_H__
+#define __BL_DECRYPT_H__
+
+//*****************************************************************************
+//
+// The size of an AES block and of an AES-128 key, in bytes.
+//
+//*****************************************************************************
+#define AES_BLOCK_SIZE          16
+#define AES_KEY_SIZE            16
+
+//*****************************************************************************
+//
+// The number of bytes of key stream that CTR mode generates at a time, which
+// is the size of a serial data packet so that the key stream for the next
+// packet can be generated while the last one is being programmed.
+//
+//*****************************************************************************
+#define DECRYPT_STREAM_SIZE     128
+
+//*****************************************************************************
+//
+// Decryption APIs
+//
+//*****************************************************************************
+extern void DecryptData(uint8_t *pui8Buffer, uint32_t ui32Size);
+extern void DecryptStart(const uint8_t *pui8IV);
+extern void DecryptPrefetch(void);
+extern void DecryptSkip(uint32_t ui32Size);
+extern void DecryptCommit(void);
+extern void DecryptRewind(void);
+extern void AES128Encrypt(uint8_t *pui8Block);
+extern void AES128Decrypt(uint8_t *pui8Block);
+
+#endif // __BL_DECRYPT_H__
@@ -0,0 +1,117 @@
+//*****************************************************************************
+//
+// bl_dma.c - The uDMA controller set up shared by the boot loader.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "bl_config.h"
+#include "driverlib/udma.h"
+#include "boot_loader/bl_dma.h"
+#include "boot_loader/bl_ssi.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_dma_api
+//! @{
+//
+//*****************************************************************************
+#if defined(SSI_ENABLE_DMA) || defined(CRYPTO_ENABLE_HW) || defined(DOXYGEN)
+
+//*****************************************************************************
+//
+// The number of channels whose control structures are used.  The AES data
+// output channel, channel 15, is the highest that the cryptographic modules
+// use; the SSI receive channel is the one given in bl_config.h.
+//
+//*****************************************************************************
+#if defined(SSI_ENABLE_DMA) && \
+    (!defined(CRYPTO_ENABLE_HW) || ((SSI_RX_DMA_CHANNEL & 0xff) > 15))
+#define BL_DMA_NUM_CHANNELS     ((SSI_RX_DMA_CHANNEL & 0xff) + 1)
+#else
+#define BL_DMA_NUM_CHANNELS     16
+#endif
+
+//*****************************************************************************
+//
+// The uDMA channel control table.  Only the primary structures of the
+// channels used by the boot loader are needed, but the table must still start
+// on a 1024 byte boundary.
+//
+//*****************************************************************************
+#if defined(ewarm)
+#pragma data_alignment=1024
+static tDMAControlTable g_psDMAControlTable[BL_DMA_NUM_CHANNELS];
+#elif defined(ccs)
+#pragma DATA_ALIGN(g_psDMAControlTable, 1024)
+static tDMAControlTable g_psDMAControlTable[BL_DMA_NUM_CHANNELS];
+#else
+static tDMAControlTable g_psDMAControlTable[BL_DMA_NUM_CHANNELS]
+                                            __attribute__((aligned(1024)));
+#endif
+
+//*****************************************************************************
+//
+// Set once the uDMA controller has been enabled.
+//
+//*****************************************************************************
+static bool g_bDMAReady;
+
+//*****************************************************************************
+//
+//! Enables the uDMA controller.
+//!
+//! This function enables the uDMA controller and gives it the control table
+//! that every part of the boot loader that moves data with it shares.  It may
+//! be called any number of times; only the first call does anything.  Each
+//! caller then assigns and configures its own channels.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BLDMAInit(void)
+{
+    if(g_bDMAReady)
+    {
+        return;
+    }
+    g_bDMAReady = true;
+
+    HWREG(SYSCTL_RCGCDMA) |= SYSCTL_RCGCDMA_R0;
+    while(!(HWREG(SYSCTL_PRDMA) & SYSCTL_PRDMA_R0))
+    {
+    }
+    uDMAEnable();
+    uDMAControlBaseSet(g_psDMAControlTable);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+#endif
@@ -0,0 +1,813 @@
+//*****************************************************************************
+//
+// bl_ecdsa.c - ECDSA P-256 verification of signed firmware images.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "bl_config.h"
+#include "boot_loader/bl_ecdsa.h"
+#include "boot_loader/bl_flash.h"
+#include "boot_loader/bl_sha256.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_ecdsa_api
+//! @{
+//
+//*****************************************************************************
+#if defined(CHECK_SIGNATURE) || defined(DOXYGEN)
+
+//*****************************************************************************
+//
+// The number of words in a value modulo the field prime or the group order.
+// Values are held least significant word first.
+//
+//*****************************************************************************
+#define EC_WORDS                8
+
+//*****************************************************************************
+//
+// A modulus, together with the values needed to multiply modulo it in the
+// Montgomery domain with R = 2^256: -1/m modulo 2^32 and R^2 modulo m.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t pui32M[EC_WORDS];
+    uint32_t pui32R2[EC_WORDS];
+    uint32_t ui32Inv;
+}
+tECModulus;
+
+//*****************************************************************************
+//
+// A point in Jacobian coordinates, with its coordinates in the Montgomery
+// domain.  The point at infinity has a Z coordinate of zero.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t pui32X[EC_WORDS];
+    uint32_t pui32Y[EC_WORDS];
+    uint32_t pui32Z[EC_WORDS];
+}
+tECPoint;
+
+//*****************************************************************************
+//
+// The prime p of the field and the order n of the group of the NIST P-256
+// curve, with their Montgomery constants precomputed.
+//
+//*****************************************************************************
+static const tECModulus g_sECFieldP =
+{
+    {
+        0xffffffff, 0xffffffff, 0xffffffff, 0x00000000,
+        0x00000000, 0x00000000, 0x00000001, 0xffffffff
+    },
+    {
+        0x00000003, 0x00000000, 0xffffffff, 0xfffffffb,
+        0xfffffffe, 0xffffffff, 0xfffffffd, 0x00000004
+    },
+    0x00000001
+};
+static const tECModulus g_sECOrderN =
+{
+    {
+        0xfc632551, 0xf3b9cac2, 0xa7179e84, 0xbce6faad,
+        0xffffffff, 0xffffffff, 0x00000000, 0xffffffff
+    },
+    {
+        0xbe79eea2, 0x83244c95, 0x49bd6fa6, 0x4699799c,
+        0x2b6bec59, 0x2845b239, 0xf3d95620, 0x66e12d94
+    },
+    0xee00bc4f
+};
+
+//*****************************************************************************
+//
+// The base point G of the curve and the value one, in the Montgomery domain
+// of the field, precomputed.
+//
+//*****************************************************************************
+static const uint32_t g_pui32ECGx[EC_WORDS] =
+{
+    0x18a9143c, 0x79e730d4, 0x5fedb601, 0x75ba95fc,
+    0x77622510, 0x79fb732b, 0xa53755c6, 0x18905f76
+};
+static const uint32_t g_pui32ECGy[EC_WORDS] =
+{
+    0xce95560a, 0xddf25357, 0xba19e45c, 0x8b4ab8e4,
+    0xdd21f325, 0xd2e88688, 0x25885d85, 0x8571ff18
+};
+static const uint32_t g_pui32ECOne[EC_WORDS] =
+{
+    0x00000001, 0x00000000, 0x00000000, 0xffffffff,
+    0xffffffff, 0xffffffff, 0xfffffffe, 0x00000000
+};
+
+//*****************************************************************************
+//
+// The public key that images must be signed with.
+//
+//*****************************************************************************
+static const uint32_t g_pui32SignKey[ECDSA_KEY_SIZE / 4] =
+{
+    SIGN_PUBLIC_KEY
+};
+
+//*****************************************************************************
+//
+// Loads a value from big-endian bytes, as values are given in signatures and
+// digests.
+//
+//*****************************************************************************
+static void
+ECLoad(uint32_t *pui32R, const uint8_t *pui8Bytes)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < EC_WORDS; ui32Idx++)
+    {
+        pui32R[EC_WORDS - 1 - ui32Idx] = ((pui8Bytes[0] << 24) |
+                                          (pui8Bytes[1] << 16) |
+                                          (pui8Bytes[2] << 8) |
+                                          pui8Bytes[3]);
+        pui8Bytes += 4;
+    }
+}
+
+//*****************************************************************************
+//
+// Compares two values, returning -1, 0 or 1 as the first is less than, equal
+// to or greater than the second.
+//
+//*****************************************************************************
+static int32_t
+ECCompare(const uint32_t *pui32A, const uint32_t *pui32B)
+{
+    int32_t i32Idx;
+
+    for(i32Idx = EC_WORDS - 1; i32Idx >= 0; i32Idx--)
+    {
+        if(pui32A[i32Idx] != pui32B[i32Idx])
+        {
+            return((pui32A[i32Idx] > pui32B[i32Idx]) ? 1 : -1);
+        }
+    }
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Returns true if a value is zero.
+//
+//*****************************************************************************
+static bool
+ECIsZero(const uint32_t *pui32A)
+{
+    uint32_t ui32Idx, ui32Or;
+
+    for(ui32Idx = 0, ui32Or = 0; ui32Idx < EC_WORDS; ui32Idx++)
+    {
+        ui32Or |= pui32A[ui32Idx];
+    }
+    return(ui32Or == 0);
+}
+
+//*****************************************************************************
+//
+// Adds two values, returning the carry out.
+//
+//*****************************************************************************
+static uint32_t
+ECAddWords(uint32_t *pui32R, const uint32_t *pui32A, const uint32_t *pui32B)
+{
+    uint64_t ui64Acc;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0, ui64Acc = 0; ui32Idx < EC_WORDS; ui32Idx++)
+    {
+        ui64Acc += (uint64_t)pui32A[ui32Idx] + pui32B[ui32Idx];
+        pui32R[ui32Idx] = (uint32_t)ui64Acc;
+        ui64Acc >>= 32;
+    }
+    return((uint32_t)ui64Acc);
+}
+
+//*****************************************************************************
+//
+// Subtracts one value from another, returning the borrow out.
+//
+//*****************************************************************************
+static uint32_t
+ECSubWords(uint32_t *pui32R, const uint32_t *pui32A, const uint32_t *pui32B)
+{
+    int64_t i64Acc;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0, i64Acc = 0; ui32Idx < EC_WORDS; ui32Idx++)
+    {
+        i64Acc += (int64_t)pui32A[ui32Idx] - pui32B[ui32Idx];
+        pui32R[ui32Idx] = (uint32_t)i64Acc;
+        i64Acc >>= 32;
+    }
+    return((uint32_t)i64Acc & 1);
+}
+
+//*****************************************************************************
+//
+// Adds two values modulo m.
+//
+//*****************************************************************************
+static void
+ECAdd(uint32_t *pui32R, const uint32_t *pui32A, const uint32_t *pui32B,
+      const tECModulus *psMod)
+{
+    if(ECAddWords(pui32R, pui32A, pui32B) ||
+       (ECCompare(pui32R, psMod->pui32M) >= 0))
+    {
+        ECSubWords(pui32R, pui32R, psMod->pui32M);
+    }
+}
+
+//*****************************************************************************
+//
+// Subtracts one value from another modulo m.
+//
+//*****************************************************************************
+static void
+ECSub(uint32_t *pui32R, const uint32_t *pui32A, const uint32_t *pui32B,
+      const tECModulus *psMod)
+{
+    if(ECSubWords(pui32R, pui32A, pui32B))
+    {
+        ECAddWords(pui32R, pui32R, psMod->pui32M);
+    }
+}
+
+//*****************************************************************************
+//
+// Multiplies two values modulo m in the Montgomery domain, returning
+// A * B / R modulo m.  The product and the reduction are interleaved a word
+// at a time, which keeps the intermediate result to ten words.
+//
+//*****************************************************************************
+static void
+ECMul(uint32_t *pui32R, const uint32_t *pui32A, const uint32_t *pui32B,
+      const tECModulus *psMod)
+{
+    uint32_t pui32T[EC_WORDS + 2], ui32Idx, ui32Word, ui32M;
+    uint64_t ui64Acc;
+
+    for(ui32Idx = 0; ui32Idx < (EC_WORDS + 2); ui32Idx++)
+    {
+        pui32T[ui32Idx] = 0;
+    }
+
+    for(ui32Idx = 0; ui32Idx < EC_WORDS; ui32Idx++)
+    {
+        //
+        // Add A times the next word of B.
+        //
+        ui64Acc = 0;
+        for(ui32Word = 0; ui32Word < EC_WORDS; ui32Word++)
+        {
+            ui64Acc += ((uint64_t)pui32A[ui32Word] * pui32B[ui32Idx] +
+                        pui32T[ui32Word]);
+            pui32T[ui32Word] = (uint32_t)ui64Acc;
+            ui64Acc >>= 32;
+        }
+        ui64Acc += pui32T[EC_WORDS];
+        pui32T[EC_WORDS] = (uint32_t)ui64Acc;
+        pui32T[EC_WORDS + 1] = (uint32_t)(ui64Acc >> 32);
+
+        //
+        // Add the multiple of m that clears the low word, and shift that
+        // word out.
+        //
+        ui32M = pui32T[0] * psMod->ui32Inv;
+        ui64Acc = ((uint64_t)ui32M * psMod->pui32M[0] + pui32T[0]) >> 32;
+        for(ui32Word = 1; ui32Word < EC_WORDS; ui32Word++)
+        {
+            ui64Acc += ((uint64_t)ui32M * psMod->pui32M[ui32Word] +
+                        pui32T[ui32Word]);
+            pui32T[ui32Word - 1] = (uint32_t)ui64Acc;
+            ui64Acc >>= 32;
+        }
+        ui64Acc += pui32T[EC_WORDS];
+        pui32T[EC_WORDS - 1] = (uint32_t)ui64Acc;
+        pui32T[EC_WORDS] = pui32T[EC_WORDS + 1] + (uint32_t)(ui64Acc >> 32);
+    }
+
+    //
+    // The result is less than 2m, so at most one subtraction brings it into
+    // range.
+    //
+    if(pui32T[EC_WORDS] || (ECCompare(pui32T, psMod->pui32M) >= 0))
+    {
+        ECSubWords(pui32R, pui32T, psMod->pui32M);
+    }
+    else
+    {
+        for(ui32Idx = 0; ui32Idx < EC_WORDS; ui32Idx++)
+        {
+            pui32R[ui32Idx] = pui32T[ui32Idx];
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Inverts a non-zero value modulo the prime m in the Montgomery domain by
+// raising it to the power m - 2.  The low word of neither modulus is below
+// two, so the exponent differs from m only in its low word.
+//
+//*****************************************************************************
+static void
+ECInvert(uint32_t *pui32R, const uint32_t *pui32A, const tECModulus *psMod)
+{
+    uint32_t pui32T[EC_WORDS], ui32Idx, ui32Word;
+    int32_t i32Bit;
+
+    for(ui32Idx = 0; ui32Idx < EC_WORDS; ui32Idx++)
+    {
+        pui32T[ui32Idx] = pui32A[ui32Idx];
+    }
+
+    //
+    // The top bit of the exponent is set, so start from the one below it.
+    //
+    for(i32Bit = (EC_WORDS * 32) - 2; i32Bit >= 0; i32Bit--)
+    {
+        ECMul(pui32T, pui32T, pui32T, psMod);
+        ui32Word = psMod->pui32M[i32Bit / 32] - ((i32Bit < 32) ? 2 : 0);
+        if((ui32Word >> (i32Bit % 32)) & 1)
+        {
+            ECMul(pui32T, pui32T, pui32A, psMod);
+        }
+    }
+
+    for(ui32Idx = 0; ui32Idx < EC_WORDS; ui32Idx++)
+    {
+        pui32R[ui32Idx] = pui32T[ui32Idx];
+    }
+}
+
+//*****************************************************************************
+//
+// Doubles a point, using the formulas for a curve with a = -3 that take
+// three multiplications and five squarings.
+//
+//*****************************************************************************
+static void
+ECDouble(tECPoint *psP)
+{
+    uint32_t pui32Delta[EC_WORDS], pui32Gamma[EC_WORDS], pui32Beta[EC_WORDS];
+    uint32_t pui32Alpha[EC_WORDS], pui32T[EC_WORDS];
+    const tECModulus *psMod;
+
+    psMod = &g_sECFieldP;
+
+    //
+    // alpha = 3 * (X - delta) * (X + delta), with delta = Z^2, and beta =
+    // X * gamma, with gamma = Y^2.
+    //
+    ECMul(pui32Delta, psP->pui32Z, psP->pui32Z, psMod);
+    ECMul(pui32Gamma, psP->pui32Y, psP->pui32Y, psMod);
+    ECMul(pui32Beta, psP->pui32X, pui32Gamma, psMod);
+    ECSub(pui32T, psP->pui32X, pui32Delta, psMod);
+    ECAdd(pui32Alpha, psP->pui32X, pui32Delta, psMod);
+    ECMul(pui32Alpha, pui32Alpha, pui32T, psMod);
+    ECAdd(pui32T, pui32Alpha, pui32Alpha, psMod);
+    ECAdd(pui32Alpha, pui32Alpha, pui32T, psMod);
+
+    //
+    // Z3 = (Y + Z)^2 - gamma - delta.
+    //
+    ECAdd(pui32T, psP->pui32Y, psP->pui32Z, psMod);
+    ECMul(pui32T, pui32T, pui32T, psMod);
+    ECSub(pui32T, pui32T, pui32Gamma, psMod);
+    ECSub(psP->pui32Z, pui32T, pui32Delta, psMod);
+
+    //
+    // X3 = alpha^2 - 8 * beta, leaving 4 * beta in beta.
+    //
+    ECAdd(pui32Beta, pui32Beta, pui32Beta, psMod);
+    ECAdd(pui32Beta, pui32Beta, pui32Beta, psMod);
+    ECAdd(pui32T, pui32Beta, pui32Beta, psMod);
+    ECMul(psP->pui32X, pui32Alpha, pui32Alpha, psMod);
+    ECSub(psP->pui32X, psP->pui32X, pui32T, psMod);
+
+    //
+    // Y3 = alpha * (4 * beta - X3) - 8 * gamma^2.
+    //
+    ECMul(pui32Gamma, pui32Gamma, pui32Gamma, psMod);
+    ECAdd(pui32Gamma, pui32Gamma, pui32Gamma, psMod);
+    ECAdd(pui32Gamma, pui32Gamma, pui32Gamma, psMod);
+    ECAdd(pui32Gamma, pui32Gamma, pui32Gamma, psMod);
+    ECSub(pui32T, pui32Beta, psP->pui32X, psMod);
+    ECMul(psP->pui32Y, pui32Alpha, pui32T, psMod);
+    ECSub(psP->pui32Y, psP->pui32Y, pui32Gamma, psMod);
+}
+
+//*****************************************************************************
+//
+// Adds a point given in affine coordinates to a point, taking eight
+// multiplications and three squarings.
+//
+//*****************************************************************************
+static void
+ECAddAffine(tECPoint *psP, const uint32_t *pui32X, const uint32_t *pui32Y)
+{
+    uint32_t pui32ZZ[EC_WORDS], pui32H[EC_WORDS], pui32R[EC_WORDS];
+    uint32_t pui32HHH[EC_WORDS], pui32V[EC_WORDS];
+    const tECModulus *psMod;
+    uint32_t ui32Idx;
+
+    psMod = &g_sECFieldP;
+
+    //
+    // Adding to the point at infinity gives the affine point.
+    //
+    if(ECIsZero(psP->pui32Z))
+    {
+        for(ui32Idx = 0; ui32Idx < EC_WORDS; ui32Idx++)
+        {
+            psP->pui32X[ui32Idx] = pui32X[ui32Idx];
+            psP->pui32Y[ui32Idx] = pui32Y[ui32Idx];
+            psP->pui32Z[ui32Idx] = g_pui32ECOne[ui32Idx];
+        }
+        return;
+    }
+
+    //
+    // H = x * Z^2 - X and r = y * Z^3 - Y.
+    //
+    ECMul(pui32ZZ, psP->pui32Z, psP->pui32Z, psMod);
+    ECMul(pui32H, pui32X, pui32ZZ, psMod);
+    ECSub(pui32H, pui32H, psP->pui32X, psMod);
+    ECMul(pui32R, psP->pui32Z, pui32ZZ, psMod);
+    ECMul(pui32R, pui32R, pui32Y, psMod);
+    ECSub(pui32R, pui32R, psP->pui32Y, psMod);
+
+    //
+    // If the points have the same x coordinate, they are either the same
+    // point or each other's negative.
+    //
+    if(ECIsZero(pui32H))
+    {
+        if(ECIsZero(pui32R))
+        {
+            ECDouble(psP);
+        }
+        else
+        {
+            for(ui32Idx = 0; ui32Idx < EC_WORDS; ui32Idx++)
+            {
+                psP->pui32Z[ui32Idx] = 0;
+            }
+        }
+        return;
+    }
+
+    //
+    // X3 = r^2 - H^3 - 2 * X * H^2, Y3 = r * (X * H^2 - X3) - Y * H^3 and
+    // Z3 = Z * H.
+    //
+    ECMul(pui32ZZ, pui32H, pui32H, psMod);
+    ECMul(pui32HHH, pui32H, pui32ZZ, psMod);
+    ECMul(pui32V, psP->pui32X, pui32ZZ, psMod);
+    ECMul(psP->pui32Z, psP->pui32Z, pui32H, psMod);
+    ECMul(psP->pui32X, pui32R, pui32R, psMod);
+    ECSub(psP->pui32X, psP->pui32X, pui32HHH, psMod);
+    ECSub(psP->pui32X, psP->pui32X, pui32V, psMod);
+    ECSub(psP->pui32X, psP->pui32X, pui32V, psMod);
+    ECSub(pui32V, pui32V, psP->pui32X, psMod);
+    ECMul(pui32V, pui32V, pui32R, psMod);
+    ECMul(pui32HHH, pui32HHH, psP->pui32Y, psMod);
+    ECSub(psP->pui32Y, pui32V, pui32HHH, psMod);
+}
+
+//*****************************************************************************
+//
+//! Verifies an ECDSA signature.
+//!
+//! \param pui32Key is the public key, given as the x and then the y
+//! coordinate of a point on the P-256 curve, each as eight words with the
+//! most significant word first.
+//! \param pui8Digest is the SHA256_DIGEST_SIZE byte SHA-256 digest of the
+//! data that was signed.
+//! \param pui8Signature is the ECDSA_SIGNATURE_SIZE byte signature, which is
+//! the values r and s as big-endian numbers of 32 bytes each.
+//!
+//! This function checks that the signature is one made over the digest with
+//! the private key that belongs to the public key, using the NIST P-256
+//! curve.  It computes u1 * G + u2 * Q, with u1 = e / s and u2 = r / s,
+//! in a single pass of 256 point doublings that adds G, Q or their sum,
+//! precomputed, as the bits of u1 and u2 require.  The point is left in
+//! Jacobian coordinates, its x coordinate being compared with r by
+//! multiplying r by Z^2 rather than by inverting Z.  Only public values are
+//! involved, so nothing is done to make the time taken constant.
+//!
+//! \return Returns non-zero if the signature is valid or 0 otherwise.
+//
+//*****************************************************************************
+uint32_t
+ECDSAVerify(const uint32_t *pui32Key, const uint8_t *pui8Digest,
+            const uint8_t *pui8Signature)
+{
+    uint32_t pui32R[EC_WORDS], pui32S[EC_WORDS], pui32U1[EC_WORDS];
+    uint32_t pui32U2[EC_WORDS], pui32Qx[EC_WORDS], pui32Qy[EC_WORDS];
+    uint32_t pui32SumX[EC_WORDS], pui32SumY[EC_WORDS], ui32Idx, ui32Bits;
+    tECPoint sPoint;
+    bool bSum;
+    int32_t i32Bit;
+
+    //
+    // r and s must both lie in [1, n - 1].
+    //
+    ECLoad(pui32R, pui8Signature);
+    ECLoad(pui32S, pui8Signature + 32);
+    if(ECIsZero(pui32R) || ECIsZero(pui32S) ||
+       (ECCompare(pui32R, g_sECOrderN.pui32M) >= 0) ||
+       (ECCompare(pui32S, g_sECOrderN.pui32M) >= 0))
+    {
+        return(0);
+    }
+
+    //
+    // u1 = e / s and u2 = r / s modulo n, where e is the digest reduced
+    // modulo n.  1 / s is found in the Montgomery domain, so multiplying by
+    // it brings e and r back out of it.
+    //
+    ECLoad(pui32U1, pui8Digest);
+    if(ECCompare(pui32U1, g_sECOrderN.pui32M) >= 0)
+    {
+        ECSubWords(pui32U1, pui32U1, g_sECOrderN.pui32M);
+    }
+    ECMul(pui32S, pui32S, g_sECOrderN.pui32R2, &g_sECOrderN);
+    ECInvert(pui32S, pui32S, &g_sECOrderN);
+    ECMul(pui32U1, pui32U1, pui32S, &g_sECOrderN);
+    ECMul(pui32U2, pui32R, pui32S, &g_sECOrderN);
+
+    //
+    // Bring the public key into the Montgomery domain and precompute G + Q
+    // in affine coordinates.  If Q is -G the sum is the point at infinity,
+    // which adds nothing.
+    //
+    for(ui32Idx = 0; ui32Idx < EC_WORDS; ui32Idx++)
+    {
+        pui32Qx[ui32Idx] = pui32Key[EC_WORDS - 1 - ui32Idx];
+        pui32Qy[ui32Idx] = pui32Key[(2 * EC_WORDS) - 1 - ui32Idx];
+    }
+    ECMul(pui32Qx, pui32Qx, g_sECFieldP.pui32R2, &g_sECFieldP);
+    ECMul(pui32Qy, pui32Qy, g_sECFieldP.pui32R2, &g_sECFieldP);
+    for(ui32Idx = 0; ui32Idx < EC_WORDS; ui32Idx++)
+    {
+        sPoint.pui32X[ui32Idx] = g_pui32ECGx[ui32Idx];
+        sPoint.pui32Y[ui32Idx] = g_pui32ECGy[ui32Idx];
+        sPoint.pui32Z[ui32Idx] = g_pui32ECOne[ui32Idx];
+    }
+    ECAddAffine(&sPoint, pui32Qx, pui32Qy);
+    bSum = !ECIsZero(sPoint.pui32Z);
+    if(bSum)
+    {
+        ECInvert(sPoint.pui32Z, sPoint.pui32Z, &g_sECFieldP);
+        ECMul(pui32SumY, sPoint.pui32Z, sPoint.pui32Z, &g_sECFieldP);
+        ECMul(pui32SumX, sPoint.pui32X, pui32SumY, &g_sECFieldP);
+        ECMul(pui32SumY, pui32SumY, sPoint.pui32Z, &g_sECFieldP);
+        ECMul(pui32SumY, sPoint.pui32Y, pui32SumY, &g_sECFieldP);
+    }
+
+    //
+    // Compute u1 * G + u2 * Q a bit at a time from the top.
+    //
+    for(ui32Idx = 0; ui32Idx < EC_WORDS; ui32Idx++)
+    {
+        sPoint.pui32Z[ui32Idx] = 0;
+    }
+    for(i32Bit = (EC_WORDS * 32) - 1; i32Bit >= 0; i32Bit--)
+    {
+        if(!ECIsZero(sPoint.pui32Z))
+        {
+            ECDouble(&sPoint);
+        }
+        ui32Bits = (((pui32U1[i32Bit / 32] >> (i32Bit % 32)) & 1) |
+                    (((pui32U2[i32Bit / 32] >> (i32Bit % 32)) & 1) << 1));
+        if(ui32Bits == 1)
+        {
+            ECAddAffine(&sPoint, g_pui32ECGx, g_pui32ECGy);
+        }
+        else if(ui32Bits == 2)
+        {
+            ECAddAffine(&sPoint, pui32Qx, pui32Qy);
+        }
+        else if((ui32Bits == 3) && bSum)
+        {
+            ECAddAffine(&sPoint, pui32SumX, pui32SumY);
+        }
+    }
+    if(ECIsZero(sPoint.pui32Z))
+    {
+        return(0);
+    }
+
+    //
+    // The signature is valid if the x coordinate X / Z^2, reduced modulo n,
+    // is r.  As x is below p, it is either r or, if that is below p, r + n.
+    //
+    ECMul(pui32U1, sPoint.pui32Z, sPoint.pui32Z, &g_sECFieldP);
+    ECMul(pui32U2, pui32R, g_sECFieldP.pui32R2, &g_sECFieldP);
+    ECMul(pui32U2, pui32U2, pui32U1, &g_sECFieldP);
+    if(ECCompare(pui32U2, sPoint.pui32X) == 0)
+    {
+        return(1);
+    }
+    if(ECAddWords(pui32R, pui32R, g_sECOrderN.pui32M) ||
+       (ECCompare(pui32R, g_sECFieldP.pui32M) >= 0))
+    {
+        return(0);
+    }
+    ECMul(pui32U2, pui32R, g_sECFieldP.pui32R2, &g_sECFieldP);
+    ECMul(pui32U2, pui32U2, pui32U1, &g_sECFieldP);
+
+    return(ECCompare(pui32U2, sPoint.pui32X) == 0);
+}
+
+//*****************************************************************************
+//
+// Finds the image information header of an image and checks the length that
+// it gives, which must leave room for the signature after the image in
+// flash.
+//
+//*****************************************************************************
+static uint32_t
+ImageLength(uint32_t ui32Image, uint32_t *pui32Length)
+{
+    uint32_t ui32Loop, ui32Length;
+
+    //
+    // As in CheckImageCRC32(), the header lies within the first 257 words.
+    //
+    for(ui32Loop = 0; ui32Loop < 257; ui32Loop++)
+    {
+        if((HWREG(ui32Image + (ui32Loop * 4)) == 0xFF01FF02) &&
+           (HWREG(ui32Image + (ui32Loop * 4) + 4) == 0xFF03FF04))
+        {
+            ui32Length = HWREG(ui32Image + (ui32Loop * 4) + 8);
+            if((ui32Length & 3) ||
+               (ui32Length < ((ui32Loop + 4) * sizeof(uint32_t))) ||
+               (ui32Length > (BLInternalFlashSizeGet() - ui32Image -
+                              ECDSA_SIGNATURE_SIZE)))
+            {
+                return(CHECK_SIGN_BAD_LENGTH);
+            }
+            *pui32Length = ui32Length;
+            return(CHECK_SIGN_OK);
+        }
+    }
+
+    return(CHECK_SIGN_NO_HEADER);
+}
+
+//*****************************************************************************
+//
+//! Computes the digest of the part of an image that its signature covers.
+//!
+//! \param ui32Image is the address of the start of the image in flash.
+//! \param pui8Digest is the SHA256_DIGEST_SIZE byte buffer that receives the
+//! digest.
+//!
+//! This function computes the SHA-256 digest of the image, from its start to
+//! the length given by its image information header.  With CRYPTO_ENABLE_HW
+//! the digest is computed by the SHA/MD5 module, reading the image from flash
+//! by uDMA.
+//!
+//! \return Returns \b CHECK_SIGN_OK if the digest was computed, \b
+//! CHECK_SIGN_NO_HEADER if no image information header was found or \b
+//! CHECK_SIGN_BAD_LENGTH if the header gives a length that leaves no room
+//! for the signature in flash.
+//
+//*****************************************************************************
+uint32_t
+ImageSignatureDigest(uint32_t ui32Image, uint8_t *pui8Digest)
+{
+    uint32_t ui32Length, ui32Retcode;
+    tSHA256Context sContext;
+
+    ui32Retcode = ImageLength(ui32Image, &ui32Length);
+    if(ui32Retcode != CHECK_SIGN_OK)
+    {
+        return(ui32Retcode);
+    }
+
+    SHA256Init(&sContext);
+    SHA256UpdateFlash(&sContext, ui32Image, ui32Length);
+    SHA256Final(&sContext, pui8Digest);
+
+    return(CHECK_SIGN_OK);
+}
+
+//*****************************************************************************
+//
+//! Checks the signature of an image against its digest.
+//!
+//! \param ui32Image is the address of the start of the image in flash.
+//! \param pui8Digest is the digest of the image, as computed by
+//! ImageSignatureDigest().
+//!
+//! This function checks the ECDSA_SIGNATURE_SIZE byte signature that follows
+//! the image against the public key given by SIGN_PUBLIC_KEY.
+//!
+//! \return Returns \b CHECK_SIGN_OK if the signature is valid, \b
+//! CHECK_SIGN_NO_HEADER or \b CHECK_SIGN_BAD_LENGTH if the signature cannot
+//! be found or \b CHECK_SIGN_BAD_SIGN if the signature does not match the
+//! digest.
+//
+//*****************************************************************************
+uint32_t
+ImageSignatureVerify(uint32_t ui32Image, const uint8_t *pui8Digest)
+{
+    uint32_t pui32Signature[ECDSA_SIGNATURE_SIZE / 4], ui32Length;
+    uint32_t ui32Idx, ui32Retcode;
+
+    ui32Retcode = ImageLength(ui32Image, &ui32Length);
+    if(ui32Retcode != CHECK_SIGN_OK)
+    {
+        return(ui32Retcode);
+    }
+
+    for(ui32Idx = 0; ui32Idx < (ECDSA_SIGNATURE_SIZE / 4); ui32Idx++)
+    {
+        pui32Signature[ui32Idx] = HWREG(ui32Image + ui32Length +
+                                        (ui32Idx * 4));
+    }
+
+    return(ECDSAVerify(g_pui32SignKey, pui8Digest,
+                       (const uint8_t *)pui32Signature) ?
+           CHECK_SIGN_OK : CHECK_SIGN_BAD_SIGN);
+}
+
+//*****************************************************************************
+//
+//! Checks the signature of an image.
+//!
+//! \param ui32Image is the address of the start of the image in flash.
+//!
+//! This function computes the SHA-256 digest of the image, from its start to
+//! the length given by its image information header, and checks the
+//! signature that follows it against the public key given by
+//! SIGN_PUBLIC_KEY.  A truncated image, which is missing its signature,
+//! fails the check in the same way as one that has been changed.
+//!
+//! \return Returns \b CHECK_SIGN_OK if the signature is valid, \b
+//! CHECK_SIGN_NO_HEADER if no image information header was found, \b
+//! CHECK_SIGN_BAD_LENGTH if the header gives a length that leaves no room
+//! for the signature in flash or \b CHECK_SIGN_BAD_SIGN if the signature
+//! does not match the image.
+//
+//*****************************************************************************
+uint32_t
+CheckImageSignature(uint32_t ui32Image)
+{
+    uint8_t pui8Digest[SHA256_DIGEST_SIZE];
+    uint32_t ui32Retcode;
+
+    ui32Retcode = ImageSignatureDigest(ui32Image, pui8Digest);
+    if(ui32Retcode != CHECK_SIGN_OK)
+    {
+        return(ui32Retcode);
+    }
+
+    return(ImageSignatureVerify(ui32Image, pui8Digest));
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+#endif
@@ -0,0 +1,59 @@
+//*****************************************************************************
+//
+// bl_ecdsa.h - Definitions for the boot loader ECDSA signature functions.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_ECDSA_H__
+#define __BL_ECDSA_H__
+
+//*****************************************************************************
+//
+// The sizes of an ECDSA P-256 signature, which is the values r and s, and of
+// a public key, which is the coordinates x and y of a point, in bytes.
+//
+//*****************************************************************************
+#define ECDSA_SIGNATURE_SIZE    64
+#define ECDSA_KEY_SIZE          64
+
+//*****************************************************************************
+//
+// Return codes generated by CheckImageSignature().
+//
+//*****************************************************************************
+#define CHECK_SIGN_OK           0
+#define CHECK_SIGN_NO_HEADER    1
+#define CHECK_SIGN_BAD_LENGTH   2
+#define CHECK_SIGN_BAD_SIGN     3
+
+//*****************************************************************************
+//
+// ECDSA APIs
+//
+//*****************************************************************************
+extern uint32_t ECDSAVerify(const uint32_t *pui32Key, const uint8_t *pui8Digest,
+                            const uint8_t *pui8Signature);
+extern uint32_t ImageSignatureDigest(uint32_t ui32Image, uint8_t *pui8Digest);
+extern uint32_t ImageSignatureVerify(uint32_t ui32Image,
+                                     const uint8_t *pui8Digest);
+extern uint32_t CheckImageSignature(uint32_t ui32Image);
+
+#endif // __BL_ECDSA_H__
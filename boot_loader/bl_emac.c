@@ -0,0 +1,1209 @@
+//*****************************************************************************
+//
+// bl_emac.c - Functions to update via Ethernet using BOOTP and TFTP.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_flash.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "bl_config.h"
+#include "driverlib/emac.h"
+#include "driverlib/flash.h"
+#include "driverlib/gpio.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/sysctl.h"
+#include "boot_loader/bl_emac.h"
+#include "boot_loader/bl_flash.h"
+#include "boot_loader/bl_hooks.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_emac_api
+//! @{
+//
+//*****************************************************************************
+#if defined(ENET_ENABLE_UPDATE) || defined(DOXYGEN)
+
+//*****************************************************************************
+//
+// The Ethernet, IP and UDP values used by the transport.
+//
+//*****************************************************************************
+#define ETH_TYPE_IP             0x0800
+#define ETH_TYPE_ARP            0x0806
+#define ARP_REQUEST             1
+#define ARP_REPLY               2
+#define IP_PROTO_UDP            17
+#define BOOTP_SERVER_PORT       67
+#define BOOTP_CLIENT_PORT       68
+#define TFTP_SERVER_PORT        69
+
+//*****************************************************************************
+//
+// The TFTP opcodes (RFC 1350 and RFC 2347).
+//
+//*****************************************************************************
+#define TFTP_RRQ                1
+#define TFTP_DATA               3
+#define TFTP_ACK                4
+#define TFTP_ERROR              5
+#define TFTP_OACK               6
+
+//*****************************************************************************
+//
+// Offsets of the fields used within a frame.  Frames sent by the boot loader
+// never carry IP options, so the UDP header always directly follows a 20 byte
+// IP header.
+//
+//*****************************************************************************
+#define ETH_O_DEST              0
+#define ETH_O_SRC               6
+#define ETH_O_TYPE              12
+#define ETH_HDR_LEN             14
+#define IP_O_VERLEN             (ETH_HDR_LEN + 0)
+#define IP_O_LEN                (ETH_HDR_LEN + 2)
+#define IP_O_ID                 (ETH_HDR_LEN + 4)
+#define IP_O_FRAG               (ETH_HDR_LEN + 6)
+#define IP_O_TTL                (ETH_HDR_LEN + 8)
+#define IP_O_PROTO              (ETH_HDR_LEN + 9)
+#define IP_O_CHKSUM             (ETH_HDR_LEN + 10)
+#define IP_O_SRC                (ETH_HDR_LEN + 12)
+#define IP_O_DEST               (ETH_HDR_LEN + 16)
+#define IP_HDR_LEN              20
+#define UDP_O_SRC               (ETH_HDR_LEN + IP_HDR_LEN + 0)
+#define UDP_O_DEST              (ETH_HDR_LEN + IP_HDR_LEN + 2)
+#define UDP_O_LEN               (ETH_HDR_LEN + IP_HDR_LEN + 4)
+#define UDP_O_CHKSUM            (ETH_HDR_LEN + IP_HDR_LEN + 6)
+#define UDP_HDR_LEN             8
+#define UDP_O_DATA              (ETH_HDR_LEN + IP_HDR_LEN + UDP_HDR_LEN)
+#define ARP_O_OPER              (ETH_HDR_LEN + 6)
+#define ARP_O_SHA               (ETH_HDR_LEN + 8)
+#define ARP_O_SPA               (ETH_HDR_LEN + 14)
+#define ARP_O_THA               (ETH_HDR_LEN + 18)
+#define ARP_O_TPA               (ETH_HDR_LEN + 24)
+#define ARP_LEN                 28
+
+//*****************************************************************************
+//
+// Offsets of the fields used within a BOOTP packet (RFC 951).
+//
+//*****************************************************************************
+#define BOOTP_O_OP              0
+#define BOOTP_O_XID             4
+#define BOOTP_O_FLAGS           10
+#define BOOTP_O_YIADDR          16
+#define BOOTP_O_SIADDR          20
+#define BOOTP_O_CHADDR          28
+#define BOOTP_O_SNAME           44
+#define BOOTP_O_FILE            108
+#define BOOTP_O_VEND            236
+#define BOOTP_FILE_LEN          128
+#define BOOTP_LEN               300
+
+//*****************************************************************************
+//
+// The states of the update.
+//
+//*****************************************************************************
+#define STATE_BOOTP             0
+#define STATE_ARP               1
+#define STATE_TFTP              2
+
+//*****************************************************************************
+//
+// The number of times a request is retried, and the interval between the
+// retries, before falling back to the previous state.
+//
+//*****************************************************************************
+#define ENET_MAX_RETRIES        10
+#define ENET_RETRY_TICKS        (ENET_TICKS_PER_SECOND / 2)
+
+//*****************************************************************************
+//
+// The static receive and transmit descriptor rings and their buffers.  Both
+// rings are chained and are owned by the DMA engine for the whole session, so
+// no descriptor is ever allocated or freed.
+//
+//*****************************************************************************
+static tEMACDMADescriptor g_psRxDescriptor[ENET_NUM_RX_DESCRIPTORS];
+static tEMACDMADescriptor g_psTxDescriptor[ENET_NUM_TX_DESCRIPTORS];
+static uint32_t g_ppui32RxBuffer[ENET_NUM_RX_DESCRIPTORS][ENET_BUFFER_SIZE / 4];
+static uint32_t g_ppui32TxBuffer[ENET_NUM_TX_DESCRIPTORS][ENET_BUFFER_SIZE / 4];
+static uint32_t g_ui32RxIndex;
+static uint32_t g_ui32TxIndex;
+
+//*****************************************************************************
+//
+// A word aligned copy of the TFTP block being programmed.  The payload of a
+// received frame starts on an odd halfword, so it is not safe to hand it to
+// the flash programming function directly.
+//
+//*****************************************************************************
+static uint32_t g_pui32Block[ENET_TFTP_BLOCK_SIZE / 4];
+
+//*****************************************************************************
+//
+// The system clock frequency and the SysTick based time, in ticks of
+// 1/ENET_TICKS_PER_SECOND seconds, since the update started.
+//
+//*****************************************************************************
+static uint32_t g_ui32EnetSysClock;
+static volatile uint32_t g_ui32Ticks;
+
+//*****************************************************************************
+//
+// The addressing information for this session.  IP addresses are held in host
+// byte order.
+//
+//*****************************************************************************
+static uint8_t g_pui8MACAddr[6];
+static uint8_t g_pui8ServerMAC[6];
+static uint32_t g_ui32LocalIP;
+static uint32_t g_ui32ServerIP;
+static uint32_t g_ui32ServerPort;
+static uint32_t g_ui32LocalPort;
+static uint32_t g_ui32XID;
+static uint32_t g_ui32IPID;
+static char g_pcFileName[BOOTP_FILE_LEN];
+
+//*****************************************************************************
+//
+// The progress of the update.
+//
+//*****************************************************************************
+static uint32_t g_ui32State;
+static uint32_t g_ui32Retries;
+static uint32_t g_ui32Deadline;
+static uint32_t g_ui32Block;
+static uint32_t g_ui32BlockSize;
+static uint32_t g_ui32Offset;
+static uint32_t g_ui32ImageEnd;
+
+//*****************************************************************************
+//
+// Reads and writes big endian (network order) fields within a frame.
+//
+//*****************************************************************************
+static uint32_t
+Get16(const uint8_t *pui8Data)
+{
+    return((pui8Data[0] << 8) | pui8Data[1]);
+}
+
+static uint32_t
+Get32(const uint8_t *pui8Data)
+{
+    return((pui8Data[0] << 24) | (pui8Data[1] << 16) | (pui8Data[2] << 8) |
+           pui8Data[3]);
+}
+
+static void
+Put16(uint8_t *pui8Data, uint32_t ui32Value)
+{
+    pui8Data[0] = ui32Value >> 8;
+    pui8Data[1] = ui32Value;
+}
+
+static void
+Put32(uint8_t *pui8Data, uint32_t ui32Value)
+{
+    pui8Data[0] = ui32Value >> 24;
+    pui8Data[1] = ui32Value >> 16;
+    pui8Data[2] = ui32Value >> 8;
+    pui8Data[3] = ui32Value;
+}
+
+//*****************************************************************************
+//
+// Copies, fills and compares blocks of bytes without pulling in the C
+// library.
+//
+//*****************************************************************************
+static void
+Copy(uint8_t *pui8Dst, const uint8_t *pui8Src, uint32_t ui32Size)
+{
+    while(ui32Size--)
+    {
+        *pui8Dst++ = *pui8Src++;
+    }
+}
+
+static void
+Fill(uint8_t *pui8Dst, uint8_t ui8Value, uint32_t ui32Size)
+{
+    while(ui32Size--)
+    {
+        *pui8Dst++ = ui8Value;
+    }
+}
+
+static uint32_t
+Compare(const uint8_t *pui8A, const uint8_t *pui8B, uint32_t ui32Size)
+{
+    while(ui32Size--)
+    {
+        if(*pui8A++ != *pui8B++)
+        {
+            return(1);
+        }
+    }
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Handles the SysTick interrupt.
+//!
+//! This function counts the ticks used to time out and retransmit BOOTP,
+//! ARP and TFTP requests.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SysTickIntHandler(void)
+{
+    g_ui32Ticks++;
+}
+
+//*****************************************************************************
+//
+// Restarts the retry timer for the request that has just been sent.
+//
+//*****************************************************************************
+static void
+RetryTimerStart(void)
+{
+    g_ui32Deadline = g_ui32Ticks + ENET_RETRY_TICKS;
+}
+
+//*****************************************************************************
+//
+// Returns the buffer of the next free transmit descriptor, waiting for the DMA
+// engine to finish with it if necessary.
+//
+//*****************************************************************************
+static uint8_t *
+EnetTxBufferGet(void)
+{
+    while(g_psTxDescriptor[g_ui32TxIndex].ui32CtrlStatus & DES0_TX_CTRL_OWN)
+    {
+    }
+
+    return((uint8_t *)g_ppui32TxBuffer[g_ui32TxIndex]);
+}
+
+//*****************************************************************************
+//
+// Hands the frame built in the buffer returned by EnetTxBufferGet() to the
+// DMA engine.  The MAC fills in the IP and UDP checksums and pads short
+// frames.
+//
+//*****************************************************************************
+static void
+EnetTxSend(uint32_t ui32Length)
+{
+    tEMACDMADescriptor *psDesc;
+
+    psDesc = &g_psTxDescriptor[g_ui32TxIndex];
+    psDesc->ui32Count = ui32Length << DES1_TX_CTRL_BUFF1_SIZE_S;
+    psDesc->ui32CtrlStatus = (DES0_TX_CTRL_OWN | DES0_TX_CTRL_FIRST_SEG |
+                              DES0_TX_CTRL_LAST_SEG | DES0_TX_CTRL_CHAINED |
+                              DES0_TX_CTRL_IP_ALL_CKHSUMS);
+    EMACTxDMAPollDemand(EMAC0_BASE);
+
+    g_ui32TxIndex = (g_ui32TxIndex + 1) % ENET_NUM_TX_DESCRIPTORS;
+}
+
+//*****************************************************************************
+//
+// Fills in the Ethernet, IP and UDP headers of a frame whose UDP payload has
+// already been written, and sends it.
+//
+//*****************************************************************************
+static void
+UDPSend(uint8_t *pui8Frame, const uint8_t *pui8DestMAC, uint32_t ui32DestIP,
+        uint32_t ui32SrcPort, uint32_t ui32DestPort, uint32_t ui32Length)
+{
+    Copy(pui8Frame + ETH_O_DEST, pui8DestMAC, 6);
+    Copy(pui8Frame + ETH_O_SRC, g_pui8MACAddr, 6);
+    Put16(pui8Frame + ETH_O_TYPE, ETH_TYPE_IP);
+
+    //
+    // The IP header checksum is left at zero for the MAC to insert.
+    //
+    pui8Frame[IP_O_VERLEN] = 0x45;
+    pui8Frame[IP_O_VERLEN + 1] = 0;
+    Put16(pui8Frame + IP_O_LEN, IP_HDR_LEN + UDP_HDR_LEN + ui32Length);
+    Put16(pui8Frame + IP_O_ID, g_ui32IPID++);
+    Put16(pui8Frame + IP_O_FRAG, 0);
+    pui8Frame[IP_O_TTL] = 64;
+    pui8Frame[IP_O_PROTO] = IP_PROTO_UDP;
+    Put16(pui8Frame + IP_O_CHKSUM, 0);
+    Put32(pui8Frame + IP_O_SRC, g_ui32LocalIP);
+    Put32(pui8Frame + IP_O_DEST, ui32DestIP);
+
+    //
+    // The UDP checksum is also left at zero for the MAC to insert.
+    //
+    Put16(pui8Frame + UDP_O_SRC, ui32SrcPort);
+    Put16(pui8Frame + UDP_O_DEST, ui32DestPort);
+    Put16(pui8Frame + UDP_O_LEN, UDP_HDR_LEN + ui32Length);
+    Put16(pui8Frame + UDP_O_CHKSUM, 0);
+
+    EnetTxSend(UDP_O_DATA + ui32Length);
+}
+
+//*****************************************************************************
+//
+// Sends an ARP packet.
+//
+//*****************************************************************************
+static void
+ARPSend(uint32_t ui32Oper, const uint8_t *pui8DestMAC, uint32_t ui32DestIP)
+{
+    static const uint8_t pui8Broadcast[6] =
+    {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+    };
+    static const uint8_t pui8Header[6] =
+    {
+        0x00, 0x01, 0x08, 0x00, 0x06, 0x04
+    };
+    uint8_t *pui8Frame;
+
+    pui8Frame = EnetTxBufferGet();
+    Copy(pui8Frame + ETH_O_DEST,
+         (ui32Oper == ARP_REQUEST) ? pui8Broadcast : pui8DestMAC, 6);
+    Copy(pui8Frame + ETH_O_SRC, g_pui8MACAddr, 6);
+    Put16(pui8Frame + ETH_O_TYPE, ETH_TYPE_ARP);
+    Copy(pui8Frame + ETH_HDR_LEN, pui8Header, 6);
+    Put16(pui8Frame + ARP_O_OPER, ui32Oper);
+    Copy(pui8Frame + ARP_O_SHA, g_pui8MACAddr, 6);
+    Put32(pui8Frame + ARP_O_SPA, g_ui32LocalIP);
+    if(ui32Oper == ARP_REQUEST)
+    {
+        Fill(pui8Frame + ARP_O_THA, 0, 6);
+    }
+    else
+    {
+        Copy(pui8Frame + ARP_O_THA, pui8DestMAC, 6);
+    }
+    Put32(pui8Frame + ARP_O_TPA, ui32DestIP);
+
+    EnetTxSend(ETH_HDR_LEN + ARP_LEN);
+}
+
+//*****************************************************************************
+//
+// Broadcasts a BOOTP request for our IP address and the boot file.
+//
+//*****************************************************************************
+static void
+BOOTPSend(void)
+{
+    static const uint8_t pui8Broadcast[6] =
+    {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+    };
+    uint8_t *pui8Frame, *pui8BOOTP;
+
+    pui8Frame = EnetTxBufferGet();
+    pui8BOOTP = pui8Frame + UDP_O_DATA;
+    Fill(pui8BOOTP, 0, BOOTP_LEN);
+
+    //
+    // Ask for a broadcast reply since we cannot answer an ARP request for an
+    // address that we do not have yet.
+    //
+    pui8BOOTP[BOOTP_O_OP] = 1;
+    pui8BOOTP[BOOTP_O_OP + 1] = 1;
+    pui8BOOTP[BOOTP_O_OP + 2] = 6;
+    Put32(pui8BOOTP + BOOTP_O_XID, g_ui32XID);
+    Put16(pui8BOOTP + BOOTP_O_FLAGS, 0x8000);
+    Copy(pui8BOOTP + BOOTP_O_CHADDR, g_pui8MACAddr, 6);
+#ifdef ENET_BOOTP_SERVER
+    Copy(pui8BOOTP + BOOTP_O_SNAME, (const uint8_t *)ENET_BOOTP_SERVER,
+         sizeof(ENET_BOOTP_SERVER));
+#endif
+
+    //
+    // Start the vendor area with the RFC 1497 magic cookie and an empty
+    // option list.
+    //
+    Put32(pui8BOOTP + BOOTP_O_VEND, 0x63825363);
+    pui8BOOTP[BOOTP_O_VEND + 4] = 0xff;
+
+    g_ui32LocalIP = 0;
+    UDPSend(pui8Frame, pui8Broadcast, 0xffffffff, BOOTP_CLIENT_PORT,
+            BOOTP_SERVER_PORT, BOOTP_LEN);
+    RetryTimerStart();
+}
+
+//*****************************************************************************
+//
+// Sends a TFTP read request for the boot file.  The request asks for large
+// blocks, to cut the number of lock-step round trips, and for the transfer
+// size, so that the flash can be erased once up front.
+//
+//*****************************************************************************
+static void
+TFTPRequestSend(void)
+{
+    static const uint8_t pui8Options[] = "octet\0blksize\0";
+    static const uint8_t pui8TSize[] = "tsize\0" "0";
+    uint8_t *pui8Frame, *pui8Data;
+    uint32_t ui32Len, ui32Value, ui32Div;
+
+    pui8Frame = EnetTxBufferGet();
+    pui8Data = pui8Frame + UDP_O_DATA;
+    Put16(pui8Data, TFTP_RRQ);
+    ui32Len = 2;
+
+    //
+    // The file name, as given by the BOOTP server.
+    //
+    for(ui32Value = 0; g_pcFileName[ui32Value]; ui32Value++)
+    {
+        pui8Data[ui32Len++] = g_pcFileName[ui32Value];
+    }
+    pui8Data[ui32Len++] = 0;
+
+    //
+    // The transfer mode and the block size option.
+    //
+    Copy(pui8Data + ui32Len, pui8Options, sizeof(pui8Options) - 1);
+    ui32Len += sizeof(pui8Options) - 1;
+    for(ui32Div = 1000; ui32Div; ui32Div /= 10)
+    {
+        ui32Value = (ENET_TFTP_BLOCK_SIZE / ui32Div) % 10;
+        if(ui32Value || (ui32Div <= ENET_TFTP_BLOCK_SIZE))
+        {
+            pui8Data[ui32Len++] = '0' + ui32Value;
+        }
+    }
+    pui8Data[ui32Len++] = 0;
+
+    //
+    // The transfer size option.
+    //
+    Copy(pui8Data + ui32Len, pui8TSize, sizeof(pui8TSize));
+    ui32Len += sizeof(pui8TSize);
+
+    //
+    // Use a new local port for each session so that stray packets from a
+    // previous attempt are ignored.
+    //
+    g_ui32LocalPort = 0xc000 | (g_ui32XID & 0x3fff);
+    g_ui32ServerPort = TFTP_SERVER_PORT;
+    UDPSend(pui8Frame, g_pui8ServerMAC, g_ui32ServerIP, g_ui32LocalPort,
+            TFTP_SERVER_PORT, ui32Len);
+    RetryTimerStart();
+}
+
+//*****************************************************************************
+//
+// Acknowledges a TFTP block (block 0 acknowledges an option acknowledgement).
+//
+//*****************************************************************************
+static void
+TFTPAckSend(uint32_t ui32Block)
+{
+    uint8_t *pui8Frame;
+
+    pui8Frame = EnetTxBufferGet();
+    Put16(pui8Frame + UDP_O_DATA, TFTP_ACK);
+    Put16(pui8Frame + UDP_O_DATA + 2, ui32Block);
+    UDPSend(pui8Frame, g_pui8ServerMAC, g_ui32ServerIP, g_ui32LocalPort,
+            g_ui32ServerPort, 4);
+    RetryTimerStart();
+}
+
+//*****************************************************************************
+//
+// Tells the server that the transfer has been abandoned.
+//
+//*****************************************************************************
+static void
+TFTPErrorSend(void)
+{
+    uint8_t *pui8Frame;
+
+    pui8Frame = EnetTxBufferGet();
+    Put16(pui8Frame + UDP_O_DATA, TFTP_ERROR);
+    Put16(pui8Frame + UDP_O_DATA + 2, 3);
+    pui8Frame[UDP_O_DATA + 4] = 0;
+    UDPSend(pui8Frame, g_pui8ServerMAC, g_ui32ServerIP, g_ui32LocalPort,
+            g_ui32ServerPort, 5);
+}
+
+//*****************************************************************************
+//
+// Goes back to the start of the update, asking for a new BOOTP lease.
+//
+//*****************************************************************************
+static void
+BOOTPStart(void)
+{
+    g_ui32State = STATE_BOOTP;
+    g_ui32Retries = 0;
+    g_ui32XID++;
+    BOOTPSend();
+}
+
+//*****************************************************************************
+//
+// Starts the TFTP transfer once the server's MAC address is known.
+//
+//*****************************************************************************
+static void
+TFTPStart(void)
+{
+    g_ui32State = STATE_TFTP;
+    g_ui32Retries = 0;
+    g_ui32Block = 1;
+    g_ui32BlockSize = 512;
+    g_ui32Offset = 0;
+    g_ui32ImageEnd = 0;
+    TFTPRequestSend();
+}
+
+//*****************************************************************************
+//
+// Erases the flash that the image will be written to.  If the size of the
+// image is not known, the entire application area is erased.
+//
+//*****************************************************************************
+static uint32_t
+EraseImage(uint32_t ui32Size)
+{
+    uint32_t ui32Addr;
+
+    if(ui32Size == 0)
+    {
+        ui32Size = BL_FLASH_SIZE_FN_HOOK() - APP_START_ADDRESS;
+#ifdef FLASH_RSVD_SPACE
+        ui32Size -= FLASH_RSVD_SPACE;
+#endif
+    }
+
+    //
+    // Refuse the image if it does not fit in the application area.
+    //
+    if(!BL_FLASH_AD_CHECK_FN_HOOK(APP_START_ADDRESS, ui32Size))
+    {
+        return(1);
+    }
+
+    BL_FLASH_CL_ERR_FN_HOOK();
+    for(ui32Addr = APP_START_ADDRESS; ui32Addr < (APP_START_ADDRESS + ui32Size);
+        ui32Addr += BL_FLASH_ERASE_SIZE)
+    {
+        BL_FLASH_ERASE_FN_HOOK(ui32Addr);
+    }
+    if(BL_FLASH_ERROR_FN_HOOK())
+    {
+        return(1);
+    }
+
+    g_ui32ImageEnd = APP_START_ADDRESS + ui32Size;
+
+#ifdef BL_START_FN_HOOK
+    BL_START_FN_HOOK();
+#endif
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Finishes the update by resetting into the new image.
+//
+//*****************************************************************************
+static void
+UpdateDone(void)
+{
+#ifdef BL_END_FN_HOOK
+    BL_END_FN_HOOK();
+#endif
+
+    //
+    // Make sure that the final acknowledgement has left the MAC.
+    //
+    while(g_psTxDescriptor[(g_ui32TxIndex + ENET_NUM_TX_DESCRIPTORS - 1) %
+                           ENET_NUM_TX_DESCRIPTORS].ui32CtrlStatus &
+          DES0_TX_CTRL_OWN)
+    {
+    }
+
+    HWREG(NVIC_APINT) = (NVIC_APINT_VECTKEY | NVIC_APINT_SYSRESETREQ);
+    while(1)
+    {
+    }
+}
+
+//*****************************************************************************
+//
+// Parses the options in a TFTP option acknowledgement, then erases the flash
+// and accepts the options by acknowledging block 0.
+//
+//*****************************************************************************
+static void
+TFTPOptionsReceive(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+    static const uint8_t pui8BlkSize[] = "blksize";
+    static const uint8_t pui8TSize[] = "tsize";
+    const uint8_t *pui8Name, *pui8End;
+    uint32_t ui32Value, ui32Size;
+
+    ui32Size = 0;
+    pui8End = pui8Data + ui32Len;
+    pui8Data += 2;
+    while(pui8Data < pui8End)
+    {
+        //
+        // Each option is a name and a decimal value, both NUL terminated.
+        //
+        pui8Name = pui8Data;
+        while((pui8Data < pui8End) && *pui8Data)
+        {
+            pui8Data++;
+        }
+        pui8Data++;
+        ui32Value = 0;
+        while((pui8Data < pui8End) && *pui8Data)
+        {
+            ui32Value = (ui32Value * 10) + (*pui8Data++ - '0');
+        }
+        pui8Data++;
+
+        if(!Compare(pui8Name, pui8BlkSize, sizeof(pui8BlkSize)))
+        {
+            g_ui32BlockSize = ui32Value;
+        }
+        else if(!Compare(pui8Name, pui8TSize, sizeof(pui8TSize)))
+        {
+            ui32Size = ui32Value;
+        }
+    }
+
+    if((g_ui32BlockSize > ENET_TFTP_BLOCK_SIZE) || (g_ui32BlockSize & 3) ||
+       (g_ui32BlockSize == 0) || EraseImage(ui32Size))
+    {
+        TFTPErrorSend();
+        BOOTPStart();
+        return;
+    }
+
+    TFTPAckSend(0);
+}
+
+//*****************************************************************************
+//
+// Handles a TFTP data block.
+//
+//*****************************************************************************
+static void
+TFTPDataReceive(const uint8_t *pui8Data, uint32_t ui32Len)
+{
+    uint32_t ui32Block, ui32Loop;
+
+    ui32Block = Get16(pui8Data + 2);
+    pui8Data += 4;
+    ui32Len -= 4;
+
+    //
+    // A repeat of the previous block means that our acknowledgement was lost,
+    // so send it again.  Anything else out of sequence is ignored.
+    //
+    if(ui32Block == ((g_ui32Block - 1) & 0xffff))
+    {
+        TFTPAckSend(ui32Block);
+        return;
+    }
+    if((ui32Block != (g_ui32Block & 0xffff)) || (ui32Len > g_ui32BlockSize))
+    {
+        return;
+    }
+
+    //
+    // The server ignored our options, so the image size is unknown.
+    //
+    if((g_ui32ImageEnd == 0) && EraseImage(0))
+    {
+        TFTPErrorSend();
+        BOOTPStart();
+        return;
+    }
+    if((APP_START_ADDRESS + g_ui32Offset + ui32Len) > g_ui32ImageEnd)
+    {
+        TFTPErrorSend();
+        BOOTPStart();
+        return;
+    }
+
+    //
+    // Acknowledge the block before programming it so that the server sends
+    // the next block while this one is written to flash.
+    //
+    TFTPAckSend(ui32Block);
+
+    //
+    // Copy the block to a word aligned buffer, padding the last word with the
+    // erased value.
+    //
+    Copy((uint8_t *)g_pui32Block, pui8Data, ui32Len);
+    for(ui32Loop = ui32Len; ui32Loop & 3; ui32Loop++)
+    {
+        ((uint8_t *)g_pui32Block)[ui32Loop] = 0xff;
+    }
+
+#ifdef BL_DECRYPT_FN_HOOK
+    BL_DECRYPT_FN_HOOK((uint8_t *)g_pui32Block, ui32Loop);
+#endif
+
+    BL_FLASH_CL_ERR_FN_HOOK();
+    BL_FLASH_PROGRAM_FN_HOOK(APP_START_ADDRESS + g_ui32Offset,
+                             (uint8_t *)g_pui32Block, ui32Loop);
+    if(BL_FLASH_ERROR_FN_HOOK())
+    {
+        TFTPErrorSend();
+        BOOTPStart();
+        return;
+    }
+
+    g_ui32Offset += ui32Len;
+    g_ui32Block++;
+    g_ui32Retries = 0;
+
+#ifdef BL_PROGRESS_FN_HOOK
+    BL_PROGRESS_FN_HOOK(g_ui32Offset, g_ui32ImageEnd - APP_START_ADDRESS);
+#endif
+
+    //
+    // A short block ends the transfer.
+    //
+    if(ui32Len < g_ui32BlockSize)
+    {
+        UpdateDone();
+    }
+}
+
+//*****************************************************************************
+//
+// Handles a received UDP datagram.
+//
+//*****************************************************************************
+static void
+UDPReceive(const uint8_t *pui8Frame, const uint8_t *pui8UDP, uint32_t ui32Len)
+{
+    const uint8_t *pui8Data;
+    uint32_t ui32DestPort, ui32Opcode;
+
+    if((ui32Len < UDP_HDR_LEN) || (Get16(pui8UDP + 4) > ui32Len))
+    {
+        return;
+    }
+    ui32Len = Get16(pui8UDP + 4) - UDP_HDR_LEN;
+    pui8Data = pui8UDP + UDP_HDR_LEN;
+    ui32DestPort = Get16(pui8UDP + 2);
+
+    //
+    // A reply to our BOOTP request.
+    //
+    if((g_ui32State == STATE_BOOTP) && (ui32DestPort == BOOTP_CLIENT_PORT))
+    {
+        if((ui32Len < BOOTP_O_VEND) || (pui8Data[BOOTP_O_OP] != 2) ||
+           (Get32(pui8Data + BOOTP_O_XID) != g_ui32XID) ||
+           Compare(pui8Data + BOOTP_O_CHADDR, g_pui8MACAddr, 6))
+        {
+            return;
+        }
+
+        g_ui32LocalIP = Get32(pui8Data + BOOTP_O_YIADDR);
+        g_ui32ServerIP = Get32(pui8Data + BOOTP_O_SIADDR);
+        if(g_ui32ServerIP == 0)
+        {
+            g_ui32ServerIP = Get32(pui8Frame + IP_O_SRC);
+        }
+        Copy((uint8_t *)g_pcFileName, pui8Data + BOOTP_O_FILE,
+             BOOTP_FILE_LEN);
+        g_pcFileName[BOOTP_FILE_LEN - 1] = 0;
+
+        //
+        // Find the MAC address of the TFTP server.
+        //
+        g_ui32State = STATE_ARP;
+        g_ui32Retries = 0;
+        ARPSend(ARP_REQUEST, 0, g_ui32ServerIP);
+        RetryTimerStart();
+        return;
+    }
+
+    //
+    // A TFTP packet for the current session.  The first reply fixes the
+    // server's transfer port.
+    //
+    if((g_ui32State != STATE_TFTP) || (ui32DestPort != g_ui32LocalPort) ||
+       (ui32Len < 4) || (Get32(pui8Frame + IP_O_SRC) != g_ui32ServerIP))
+    {
+        return;
+    }
+    if(g_ui32ServerPort == TFTP_SERVER_PORT)
+    {
+        g_ui32ServerPort = Get16(pui8UDP);
+    }
+    else if(g_ui32ServerPort != Get16(pui8UDP))
+    {
+        return;
+    }
+
+    ui32Opcode = Get16(pui8Data);
+    if(ui32Opcode == TFTP_DATA)
+    {
+        TFTPDataReceive(pui8Data, ui32Len);
+    }
+    else if((ui32Opcode == TFTP_OACK) && (g_ui32Block == 1) &&
+            (g_ui32ImageEnd == 0))
+    {
+        TFTPOptionsReceive(pui8Data, ui32Len);
+    }
+    else if(ui32Opcode == TFTP_ERROR)
+    {
+        BOOTPStart();
+    }
+}
+
+//*****************************************************************************
+//
+// Handles a received Ethernet frame.
+//
+//*****************************************************************************
+static void
+EnetFrameReceive(const uint8_t *pui8Frame, uint32_t ui32Len)
+{
+    uint32_t ui32HdrLen, ui32IPLen;
+
+    if(ui32Len < (ETH_HDR_LEN + ARP_LEN))
+    {
+        return;
+    }
+
+    if(Get16(pui8Frame + ETH_O_TYPE) == ETH_TYPE_ARP)
+    {
+        //
+        // Answer requests for our address once we have one, and pick up the
+        // server's MAC address from its reply.
+        //
+        if((Get16(pui8Frame + ARP_O_OPER) == ARP_REQUEST) && g_ui32LocalIP &&
+           (Get32(pui8Frame + ARP_O_TPA) == g_ui32LocalIP))
+        {
+            ARPSend(ARP_REPLY, pui8Frame + ARP_O_SHA,
+                    Get32(pui8Frame + ARP_O_SPA));
+        }
+        else if((Get16(pui8Frame + ARP_O_OPER) == ARP_REPLY) &&
+                (g_ui32State == STATE_ARP) &&
+                (Get32(pui8Frame + ARP_O_SPA) == g_ui32ServerIP))
+        {
+            Copy(g_pui8ServerMAC, pui8Frame + ARP_O_SHA, 6);
+            TFTPStart();
+        }
+        return;
+    }
+
+    if(Get16(pui8Frame + ETH_O_TYPE) != ETH_TYPE_IP)
+    {
+        return;
+    }
+
+    //
+    // Only unfragmented IPv4 UDP datagrams are of interest.
+    //
+    ui32HdrLen = (pui8Frame[IP_O_VERLEN] & 0x0f) * 4;
+    ui32IPLen = Get16(pui8Frame + IP_O_LEN);
+    if(((pui8Frame[IP_O_VERLEN] & 0xf0) != 0x40) || (ui32HdrLen < IP_HDR_LEN) ||
+       (ui32IPLen > (ui32Len - ETH_HDR_LEN)) || (ui32IPLen < ui32HdrLen) ||
+       (Get16(pui8Frame + IP_O_FRAG) & 0x3fff) ||
+       (pui8Frame[IP_O_PROTO] != IP_PROTO_UDP))
+    {
+        return;
+    }
+
+    UDPReceive(pui8Frame, pui8Frame + ETH_HDR_LEN + ui32HdrLen,
+               ui32IPLen - ui32HdrLen);
+}
+
+//*****************************************************************************
+//
+// Processes every frame that the DMA engine has completed, handing each
+// descriptor straight back to it.  The ring is only walked once the DMA
+// engine has reported a frame received; the report is cleared first, so that
+// a frame completed while the ring is being walked is not missed.
+//
+//*****************************************************************************
+static void
+EnetPoll(void)
+{
+    tEMACDMADescriptor *psDesc;
+    uint32_t ui32Status;
+
+    if(!(EMACIntStatus(EMAC0_BASE, false) & EMAC_INT_RECEIVE))
+    {
+        return;
+    }
+    EMACIntClear(EMAC0_BASE, EMAC_INT_RECEIVE);
+
+    psDesc = &g_psRxDescriptor[g_ui32RxIndex];
+    while(!(psDesc->ui32CtrlStatus & DES0_RX_CTRL_OWN))
+    {
+        ui32Status = psDesc->ui32CtrlStatus;
+
+        //
+        // Drop frames that span descriptors, have errors or, since the MAC
+        // checks them, have bad IP or UDP checksums.
+        //
+        if(!(ui32Status & DES0_RX_STAT_ERR) &&
+           ((ui32Status & (DES0_RX_STAT_FIRST_DESC | DES0_RX_STAT_LAST_DESC)) ==
+            (DES0_RX_STAT_FIRST_DESC | DES0_RX_STAT_LAST_DESC)) &&
+           !((ui32Status & DES0_RX_STAT_EXT_AVAILABLE) &&
+             (psDesc->ui32ExtRxStatus & (DES4_RX_STAT_IP_HEADER_ERR |
+                                         DES4_RX_STAT_IP_PAYLOAD_ERR))))
+        {
+            EnetFrameReceive((uint8_t *)psDesc->pvBuffer1,
+                             (ui32Status & DES0_RX_STAT_FRAME_LENGTH_M) >>
+                             DES0_RX_STAT_FRAME_LENGTH_S);
+        }
+
+        psDesc->ui32CtrlStatus = DES0_RX_CTRL_OWN;
+        EMACRxDMAPollDemand(EMAC0_BASE);
+
+        g_ui32RxIndex = (g_ui32RxIndex + 1) % ENET_NUM_RX_DESCRIPTORS;
+        psDesc = &g_psRxDescriptor[g_ui32RxIndex];
+    }
+}
+
+//*****************************************************************************
+//
+//! Configures the Ethernet controller.
+//!
+//! This function sets the system clock to 120 MHz, powers up the internal
+//! PHY and MAC, builds the static receive and transmit descriptor rings and
+//! starts the SysTick interrupt used for the protocol timers.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ConfigureEnet(void)
+{
+    uint32_t ui32Loop;
+#ifndef ENET_MAC_ADDR0
+    uint32_t ui32User0, ui32User1;
+#endif
+
+    g_ui32EnetSysClock = SysCtlClockFreqSet((SYSCTL_XTAL_16MHZ |
+                                             SYSCTL_OSC_MAIN |
+                                             SYSCTL_USE_PLL |
+                                             SYSCTL_CFG_VCO_480), 120000000);
+
+#ifdef ENET_ENABLE_LEDS
+    //
+    // Route the link and activity LEDs to PF0 and PF4.
+    //
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOF);
+    GPIOPinConfigure(GPIO_PF0_EN0LED0);
+    GPIOPinConfigure(GPIO_PF4_EN0LED1);
+    GPIOPinTypeEthernetLED(GPIO_PORTF_BASE, GPIO_PIN_0 | GPIO_PIN_4);
+#endif
+
+    //
+    // Find the MAC address, either from bl_config.h or from the user
+    // registers where it is programmed at the factory.
+    //
+#ifdef ENET_MAC_ADDR0
+    g_pui8MACAddr[0] = ENET_MAC_ADDR0;
+    g_pui8MACAddr[1] = ENET_MAC_ADDR1;
+    g_pui8MACAddr[2] = ENET_MAC_ADDR2;
+    g_pui8MACAddr[3] = ENET_MAC_ADDR3;
+    g_pui8MACAddr[4] = ENET_MAC_ADDR4;
+    g_pui8MACAddr[5] = ENET_MAC_ADDR5;
+#else
+    FlashUserGet(&ui32User0, &ui32User1);
+    g_pui8MACAddr[0] = ui32User0;
+    g_pui8MACAddr[1] = ui32User0 >> 8;
+    g_pui8MACAddr[2] = ui32User0 >> 16;
+    g_pui8MACAddr[3] = ui32User1;
+    g_pui8MACAddr[4] = ui32User1 >> 8;
+    g_pui8MACAddr[5] = ui32User1 >> 16;
+#endif
+
+    //
+    // Enable and reset the MAC and the internal PHY.
+    //
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_EMAC0);
+    SysCtlPeripheralReset(SYSCTL_PERIPH_EMAC0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_EPHY0);
+    SysCtlPeripheralReset(SYSCTL_PERIPH_EPHY0);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_EMAC0))
+    {
+    }
+
+    EMACPHYConfigSet(EMAC0_BASE, (EMAC_PHY_TYPE_INTERNAL |
+                                  EMAC_PHY_INT_MDIX_EN |
+                                  EMAC_PHY_AN_100B_T_FULL_DUPLEX));
+    EMACReset(EMAC0_BASE);
+    EMACInit(EMAC0_BASE, g_ui32EnetSysClock,
+             EMAC_BCONFIG_MIXED_BURST | EMAC_BCONFIG_PRIORITY_FIXED, 4, 4, 0);
+    EMACConfigSet(EMAC0_BASE, (EMAC_CONFIG_FULL_DUPLEX |
+                               EMAC_CONFIG_CHECKSUM_OFFLOAD |
+                               EMAC_CONFIG_7BYTE_PREAMBLE |
+                               EMAC_CONFIG_IF_GAP_96BITS |
+                               EMAC_CONFIG_USE_MACADDR0 |
+                               EMAC_CONFIG_SA_FROM_DESCRIPTOR |
+                               EMAC_CONFIG_BO_LIMIT_1024),
+                  (EMAC_MODE_RX_STORE_FORWARD |
+                   EMAC_MODE_TX_STORE_FORWARD |
+                   EMAC_MODE_TX_THRESHOLD_64_BYTES |
+                   EMAC_MODE_RX_THRESHOLD_64_BYTES), 0);
+
+    //
+    // Build the descriptor rings.  Every receive descriptor starts out owned
+    // by the DMA engine.
+    //
+    for(ui32Loop = 0; ui32Loop < ENET_NUM_RX_DESCRIPTORS; ui32Loop++)
+    {
+        g_psRxDescriptor[ui32Loop].ui32Count =
+            (DES1_RX_CTRL_CHAINED |
+             (ENET_BUFFER_SIZE << DES1_RX_CTRL_BUFF1_SIZE_S));
+        g_psRxDescriptor[ui32Loop].pvBuffer1 = g_ppui32RxBuffer[ui32Loop];
+        g_psRxDescriptor[ui32Loop].DES3.pLink =
+            &g_psRxDescriptor[(ui32Loop + 1) % ENET_NUM_RX_DESCRIPTORS];
+        g_psRxDescriptor[ui32Loop].ui32CtrlStatus = DES0_RX_CTRL_OWN;
+    }
+    for(ui32Loop = 0; ui32Loop < ENET_NUM_TX_DESCRIPTORS; ui32Loop++)
+    {
+        g_psTxDescriptor[ui32Loop].ui32Count = 0;
+        g_psTxDescriptor[ui32Loop].pvBuffer1 = g_ppui32TxBuffer[ui32Loop];
+        g_psTxDescriptor[ui32Loop].DES3.pLink =
+            &g_psTxDescriptor[(ui32Loop + 1) % ENET_NUM_TX_DESCRIPTORS];
+        g_psTxDescriptor[ui32Loop].ui32CtrlStatus = DES0_TX_CTRL_CHAINED;
+    }
+    g_ui32RxIndex = 0;
+    g_ui32TxIndex = 0;
+    EMACRxDMADescriptorListSet(EMAC0_BASE, g_psRxDescriptor);
+    EMACTxDMADescriptorListSet(EMAC0_BASE, g_psTxDescriptor);
+
+    //
+    // Accept frames for our address and broadcasts, then start the MAC.
+    //
+    EMACAddrSet(EMAC0_BASE, 0, g_pui8MACAddr);
+    EMACFrameFilterSet(EMAC0_BASE, 0);
+    EMACIntClear(EMAC0_BASE, EMACIntStatus(EMAC0_BASE, false));
+    EMACTxEnable(EMAC0_BASE);
+    EMACRxEnable(EMAC0_BASE);
+
+    //
+    // Start the protocol timer.
+    //
+    HWREG(NVIC_ST_RELOAD) = (g_ui32EnetSysClock / ENET_TICKS_PER_SECOND) - 1;
+    HWREG(NVIC_ST_CTRL) = (NVIC_ST_CTRL_CLK_SRC | NVIC_ST_CTRL_INTEN |
+                           NVIC_ST_CTRL_ENABLE);
+}
+
+//*****************************************************************************
+//
+//! Performs an update over Ethernet.
+//!
+//! This function requests an IP address and a boot file name from a BOOTP
+//! server, resolves the TFTP server's MAC address and then fetches the boot
+//! file with TFTP, programming each block into flash as it arrives.  Requests
+//! are retried on a timeout, and a transfer that stalls is restarted from the
+//! BOOTP stage.  Once the last block is written, the device is reset to run
+//! the new image.
+//!
+//! \return Never returns.
+//
+//*****************************************************************************
+void
+UpdateBOOTP(void)
+{
+    //
+    // When entered from the application, the Ethernet controller has not been
+    // set up by the boot loader yet.
+    //
+    if(g_ui32EnetSysClock == 0)
+    {
+        ConfigureEnet();
+    }
+
+    //
+    // Vary the transaction ID between devices and between sessions.
+    //
+    g_ui32XID = ((g_pui8MACAddr[2] << 24) | (g_pui8MACAddr[3] << 16) |
+                 (g_pui8MACAddr[4] << 8) | g_pui8MACAddr[5]) ^ g_ui32Ticks;
+    BOOTPStart();
+
+    while(1)
+    {
+        EnetPoll();
+
+        //
+        // Retransmit the outstanding request if it has gone unanswered.
+        //
+        if((int32_t)(g_ui32Ticks - g_ui32Deadline) >= 0)
+        {
+            if(++g_ui32Retries > ENET_MAX_RETRIES)
+            {
+                BOOTPStart();
+            }
+            else if(g_ui32State == STATE_BOOTP)
+            {
+                BOOTPSend();
+            }
+            else if(g_ui32State == STATE_ARP)
+            {
+                ARPSend(ARP_REQUEST, 0, g_ui32ServerIP);
+                RetryTimerStart();
+            }
+            else if((g_ui32Block == 1) && (g_ui32ImageEnd == 0))
+            {
+                TFTPRequestSend();
+            }
+            else
+            {
+                TFTPAckSend(g_ui32Block - 1);
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+#endif
@@ -0,0 +1,84 @@
+//*****************************************************************************
+//
+// bl_emac.h - Definitions for the Ethernet (BOOTP/TFTP) transport.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_EMAC_H__
+#define __BL_EMAC_H__
+
+//*****************************************************************************
+//
+// This section maps the defines to default for the Ethernet boot loader for
+// projects that do not specify them in bl_config.h.
+//
+//*****************************************************************************
+#ifndef ENET_NUM_RX_DESCRIPTORS
+#define ENET_NUM_RX_DESCRIPTORS 4
+#endif
+
+#ifndef ENET_NUM_TX_DESCRIPTORS
+#define ENET_NUM_TX_DESCRIPTORS 2
+#endif
+
+#ifndef ENET_TFTP_BLOCK_SIZE
+#define ENET_TFTP_BLOCK_SIZE    1024
+#endif
+
+//*****************************************************************************
+//
+// The size of each descriptor buffer.  This holds the largest Ethernet frame,
+// including the trailing FCS, rounded up to a whole number of words.
+//
+//*****************************************************************************
+#define ENET_BUFFER_SIZE        1536
+
+//*****************************************************************************
+//
+// The rate of the SysTick interrupt that drives the protocol timers.
+//
+//*****************************************************************************
+#define ENET_TICKS_PER_SECOND   100
+
+//*****************************************************************************
+//
+// Make sure that a TFTP data block, along with its IP, UDP and TFTP headers,
+// always fits in a single 1500 byte Ethernet payload and can be programmed a
+// word at a time.
+//
+//*****************************************************************************
+#if ((ENET_TFTP_BLOCK_SIZE + 20 + 8 + 4) > 1500)
+#error ERROR: ENET_TFTP_BLOCK_SIZE is too large for a single Ethernet frame!
+#endif
+#if (ENET_TFTP_BLOCK_SIZE & 3)
+#error ERROR: ENET_TFTP_BLOCK_SIZE must be a multiple of 4 bytes!
+#endif
+
+//*****************************************************************************
+//
+// Ethernet Transport APIs
+//
+//*****************************************************************************
+extern void ConfigureEnet(void);
+extern void UpdateBOOTP(void);
+extern void SysTickIntHandler(void);
+
+#endif // __BL_EMAC_H__
@@ -29,6 +29,9 @@
 #include "inc/hw_memmap.h"
 #include "bl_config.h"
 #include "boot_loader/bl_flash.h"
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+#include "boot_loader/bl_wear.h"
+#endif
 
 //*****************************************************************************
 //
@@ -39,12 +42,43 @@
 //! This function erases a single 1KB block of the internal flash, blocking
 //! until the erase has completed.
 //!
+//! If \b FLASH_WEAR_EEPROM_ADDRESS is defined, the erase is skipped if the
+//! whole erasable block holding \e ui32Address already reads as erased, and
+//! is otherwise counted against that block before it is started.
+//!
 //! \return None
 //
 //*****************************************************************************
 void
 BLInternalFlashErase(uint32_t ui32Address)
 {
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+    uint32_t ui32Word;
+
+    //
+    // Leave the block alone if it is already blank.  Callers step through
+    // flash by BL_FLASH_ERASE_SIZE, so each block is only scanned once.
+    //
+    ui32Address &= ~(BL_FLASH_ERASE_SIZE - 1);
+    for(ui32Word = 0; ui32Word < BL_FLASH_ERASE_SIZE; ui32Word += 4)
+    {
+        if(HWREG(ui32Address + ui32Word) != 0xffffffff)
+        {
+            break;
+        }
+    }
+    if(ui32Word == BL_FLASH_ERASE_SIZE)
+    {
+        g_ui32WearSkips++;
+        return;
+    }
+
+    //
+    // Count the erase before it starts.
+    //
+    WearCount(ui32Address);
+#endif
+
     //
     // Erase this block of the flash.
     //
@@ -162,6 +196,21 @@ BLInternalFlashStartAddrCheck(uint32_t ui32Addr, uint32_t ui32ImgSize)
     }
 #endif
 
+#ifdef BL_UPDATE_STAGED
+    //
+    // A new boot loader is staged in the application region, so it must fit
+    // in the space that it is to replace and is checked where it is staged.
+    //
+    if(ui32Addr == 0)
+    {
+        if(ui32ImgSize > APP_START_ADDRESS)
+        {
+            return(0);
+        }
+        ui32Addr = APP_START_ADDRESS;
+    }
+#endif
+
     //
     // Is the address we were passed a valid start address?  We allow:
     //
@@ -171,8 +220,9 @@ BLInternalFlashStartAddrCheck(uint32_t ui32Addr, uint32_t ui32ImgSize)
     // 3. The application start address specified in bl_config.h.
     //
     // The function fails if the address is not one of these, if the image
-    // size is larger than the available space or if the address is not word
-    // aligned.
+    // size is larger than the available space, if the address is not word
+    // aligned or if the image would overwrite the progress journal or the
+    // signature cache.
     //
     if((
 #ifdef ENABLE_BL_UPDATE
@@ -182,7 +232,16 @@ BLInternalFlashStartAddrCheck(uint32_t ui32Addr, uint32_t ui32ImgSize)
         (ui32Addr != (ui32FlashSize - FLASH_RSVD_SPACE)) &&
 #endif
         (ui32Addr != APP_START_ADDRESS)) ||
-       ((ui32Addr + ui32ImgSize) > ui32FlashSize) || ((ui32Addr & 3) != 0))
+       ((ui32Addr + ui32ImgSize) > ui32FlashSize) || ((ui32Addr & 3) != 0)
+#ifdef FLASH_JOURNAL_ADDRESS
+       || (((ui32Addr + ui32ImgSize) > FLASH_JOURNAL_ADDRESS) &&
+           (ui32Addr < (FLASH_JOURNAL_ADDRESS + BL_FLASH_ERASE_SIZE)))
+#endif
+#ifdef SIGN_CACHE_ADDRESS
+       || (((ui32Addr + ui32ImgSize) > SIGN_CACHE_ADDRESS) &&
+           (ui32Addr < (SIGN_CACHE_ADDRESS + BL_FLASH_ERASE_SIZE)))
+#endif
+       )
     {
         return(0);
     }
@@ -228,3 +287,158 @@ BLInternalFlashErrorCheck(void)
 {
     return(HWREG(FLASH_FCRIS) & FLASH_FCRIS_ARIS);
 }
+
+#if defined(ENABLE_FLASH_DUMP) || defined(DOXYGEN)
+//*****************************************************************************
+//
+//! Checks whether a region of flash may be read back to the host.
+//!
+//! \param ui32Addr is the start address of the region.
+//! \param ui32Size is the size of the region in bytes.
+//!
+//! This function checks that the region is word aligned, not empty, lies
+//! within the flash of the part in use and does not touch any block whose
+//! read enable bit in the FMPREn registers is clear.  Such a block is
+//! execute-only, and reading it as data would fault.
+//!
+//! \return Returns non-zero if the region may be read or 0 otherwise.
+//
+//*****************************************************************************
+uint32_t
+BLInternalFlashReadCheck(uint32_t ui32Addr, uint32_t ui32Size)
+{
+    uint32_t ui32FlashSize, ui32Block;
+
+    ui32FlashSize = BLInternalFlashSizeGet();
+    if(!ui32Size || ((ui32Addr | ui32Size) & 3) ||
+       (ui32Addr >= ui32FlashSize) || (ui32Size > (ui32FlashSize - ui32Addr)))
+    {
+        return(0);
+    }
+
+    //
+    // Each FMPREn register holds the read enables of 32 protection blocks.
+    //
+    for(ui32Block = ui32Addr & ~(FLASH_PROTECT_SIZE - 1);
+        ui32Block < (ui32Addr + ui32Size); ui32Block += FLASH_PROTECT_SIZE)
+    {
+        if(!(HWREG(FLASH_FMPRE0 +
+                   ((ui32Block / (FLASH_PROTECT_SIZE * 32)) * 4)) &
+             (1 << ((ui32Block / FLASH_PROTECT_SIZE) % 32))))
+        {
+            return(0);
+        }
+    }
+
+    return(1);
+}
+#endif
+
+#if defined(BL_UPDATE_STAGED) || defined(DOXYGEN)
+//*****************************************************************************
+//
+// Make sure that the boot loader can be erased without erasing the start of
+// the application region, where its replacement is staged.
+//
+//*****************************************************************************
+#if (APP_START_ADDRESS & (BL_FLASH_ERASE_SIZE - 1))
+#error ERROR: APP_START_ADDRESS must be a multiple of the flash erase size!
+#endif
+
+//*****************************************************************************
+//
+//! Programs one word of the internal flash.
+//!
+//! \param ui32Address is the address of the word to program.
+//! \param ui32Data is the value to program it with.
+//!
+//! \return None
+//
+//*****************************************************************************
+static void
+StagedWordProgram(uint32_t ui32Address, uint32_t ui32Data)
+{
+    HWREG(FLASH_FMA) = ui32Address;
+    HWREG(FLASH_FMD) = ui32Data;
+    HWREG(FLASH_FMC) = FLASH_FMC_WRKEY | FLASH_FMC_WRITE;
+    while(HWREG(FLASH_FMC) & FLASH_FMC_WRITE)
+    {
+    }
+}
+
+//*****************************************************************************
+//
+//! Replaces the boot loader with one staged in the application region.
+//!
+//! \param ui32Stage is the address of the staged boot loader.
+//! \param ui32Size is the size of the staged boot loader in bytes.
+//!
+//! This function erases the flash below \b APP_START_ADDRESS and programs the
+//! staged boot loader into it, 32 words at a time through the flash write
+//! buffer.  It only touches the flash controller registers, and like the rest
+//! of the boot loader it runs from SRAM, so it carries on once the code in
+//! flash has gone.
+//!
+//! The order is what makes the copy safe against losing power.  The first
+//! block, holding the vector table, is erased first, so that from then on
+//! the reset vector reads as 0xFFFFFFFF and the ROM boot loader runs at reset
+//! instead.  The stack pointer and reset vector are programmed last, once
+//! everything else is in place and the staged copy has been erased so that
+//! it cannot be taken for an application by the new boot loader.  Power lost
+//! at any point therefore leaves either the old boot loader, the ROM boot
+//! loader or the new boot loader to run.
+//!
+//! \return None
+//
+//*****************************************************************************
+void
+BLInternalFlashStagedCopy(uint32_t ui32Stage, uint32_t ui32Size)
+{
+    uint32_t ui32Addr, ui32Idx, ui32StackPtr, ui32ResetVector;
+
+    for(ui32Addr = 0; ui32Addr < APP_START_ADDRESS; ui32Addr += 128)
+    {
+        //
+        // Erase each block as it is reached, starting with the one holding
+        // the vector table.
+        //
+        if((ui32Addr & (BL_FLASH_ERASE_SIZE - 1)) == 0)
+        {
+            BLInternalFlashErase(ui32Addr);
+        }
+
+        //
+        // Program the next 32 words through the write buffer, leaving the
+        // first two words of the vector table erased for now.  Words past the
+        // end of the staged boot loader are left erased too.
+        //
+        if(ui32Addr < ui32Size)
+        {
+            HWREG(FLASH_FMA) = ui32Addr;
+            for(ui32Idx = (ui32Addr == 0) ? 8 : 0; ui32Idx < 128; ui32Idx += 4)
+            {
+                HWREG(FLASH_FWBN + ui32Idx) = HWREG(ui32Stage + ui32Addr +
+                                                    ui32Idx);
+            }
+            HWREG(FLASH_FMC2) = FLASH_FMC2_WRKEY | FLASH_FMC2_WRBUF;
+            while(HWREG(FLASH_FMC2) & FLASH_FMC2_WRBUF)
+            {
+            }
+        }
+    }
+
+    //
+    // Keep the stack pointer and reset vector, then erase the start of the
+    // staged copy so that the new boot loader does not try to run it.
+    //
+    ui32StackPtr = HWREG(ui32Stage);
+    ui32ResetVector = HWREG(ui32Stage + 4);
+    BLInternalFlashErase(ui32Stage);
+
+    //
+    // The new boot loader is complete once the reset vector is programmed.
+    //
+    StagedWordProgram(0, ui32StackPtr);
+    StagedWordProgram(4, ui32ResetVector);
+}
+#endif
@@ -40,15 +40,27 @@ extern uint32_t BLInternalFlashStartAddrCheck(uint32_t ui32Addr,
                                               uint32_t ui32ImgSize);
 extern uint32_t BLInternalFlashErrorCheck(void);
 extern void BLInternalFlashErrorClear(void);
+#ifdef ENABLE_FLASH_DUMP
+extern uint32_t BLInternalFlashReadCheck(uint32_t ui32Addr,
+                                         uint32_t ui32Size);
+#endif
+#ifdef BL_UPDATE_STAGED
+extern void BLInternalFlashStagedCopy(uint32_t ui32Stage, uint32_t ui32Size);
+#endif
 
 //*****************************************************************************
 //
 // If the user has not specified which flash programming functions to use,
 // default to the basic, internal flash functions on Sandstorm, Fury and
 // DustDevil parts or the ROM-resident function for Tempest-class parts.
+// Erases go through BLInternalFlashErase() if FLASH_WEAR_EEPROM_ADDRESS is
+// defined, so that each one is counted.
 //
 //*****************************************************************************
-#ifndef BL_FLASH_ERASE_FN_HOOK
+#if !defined(BL_FLASH_ERASE_FN_HOOK) && defined(FLASH_WEAR_EEPROM_ADDRESS)
+#define BL_FLASH_ERASE_FN_HOOK(ui32Address)                                   \
+        BLInternalFlashErase(ui32Address)
+#elif !defined(BL_FLASH_ERASE_FN_HOOK)
 #define BL_FLASH_ERASE_FN_HOOK(ui32Address)                                   \
         {                                                                     \
             HWREG(FLASH_FMA) = (ui32Address);                                 \
@@ -116,6 +128,22 @@ extern uint32_t BL_FLASH_SIZE_FN_HOOK(void);
 extern uint32_t BL_FLASH_END_FN_HOOK(void);
 #endif
 
+//*****************************************************************************
+//
+// The size of the region cleared by a single erase.  On TM4C129 devices an
+// erase always clears a whole 16 KB block, even when FLASH_PAGE_SIZE is set
+// smaller, so transports that erase as an image grows must step by this size.
+//
+//*****************************************************************************
+#if defined(TARGET_IS_TM4C129_RA0) ||                                         \
+    defined(TARGET_IS_TM4C129_RA1) ||                                         \
+    defined(TARGET_IS_TM4C129_RA2)
+#define BL_FLASH_ERASE_SIZE     ((FLASH_PAGE_SIZE > 0x4000) ?                 \
+                                 FLASH_PAGE_SIZE : 0x4000)
+#else
+#define BL_FLASH_ERASE_SIZE     FLASH_PAGE_SIZE
+#endif
+
 #ifndef BL_FLASH_AD_CHECK_FN_HOOK
 #define BL_FLASH_AD_CHECK_FN_HOOK(ui32Addr, ui32Size)                         \
         BLInternalFlashStartAddrCheck((ui32Addr), (ui32Size))
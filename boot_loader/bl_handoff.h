@@ -0,0 +1,73 @@
+//*****************************************************************************
+//
+// bl_handoff.h - Definitions for the handoff from an application to the
+//                boot loader.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_HANDOFF_H__
+#define __BL_HANDOFF_H__
+
+//*****************************************************************************
+//
+// The handoff that an application leaves at BL_HANDOFF_ADDRESS before it
+// enters the boot loader through the SVCall vector, so that the boot loader
+// can reuse the system clock and UART the application has already set up.
+// The application fills in the clock frequency, the base address of the UART
+// it is talking to the host on and the baud rate of that UART, then sets
+// ui32Check to BL_HANDOFF_CHECK() of the handoff and ui32Marker to
+// BL_HANDOFF_MARKER.  The boot loader clears ui32Marker once it has read the
+// handoff, so that a stale one is never used on a later entry.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Marker;
+    uint32_t ui32SysClock;
+    uint32_t ui32UARTBase;
+    uint32_t ui32BaudRate;
+    uint32_t ui32Check;
+}
+tBLHandoff;
+
+//*****************************************************************************
+//
+// The value of ui32Marker in a valid handoff, and the value of ui32Check,
+// which covers the other words.
+//
+//*****************************************************************************
+#define BL_HANDOFF_MARKER       0x424c4830
+#define BL_HANDOFF_CHECK(psHandoff)                                           \
+        (~((psHandoff)->ui32Marker ^ (psHandoff)->ui32SysClock ^              \
+           (psHandoff)->ui32UARTBase ^ (psHandoff)->ui32BaudRate))
+
+//*****************************************************************************
+//
+// The offsets of the words of the handoff from BL_HANDOFF_ADDRESS.
+//
+//*****************************************************************************
+#define BL_HANDOFF_O_MARKER     0x00000000
+#define BL_HANDOFF_O_CLOCK      0x00000004
+#define BL_HANDOFF_O_UART       0x00000008
+#define BL_HANDOFF_O_BAUD       0x0000000C
+#define BL_HANDOFF_O_CHECK      0x00000010
+
+#endif // __BL_HANDOFF_H__
@@ -0,0 +1,376 @@
+//*****************************************************************************
+//
+// bl_journal.c - Progress journal used to resume an interrupted download.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_types.h"
+#include "inc/hw_flash.h"
+#include "bl_config.h"
+#include "boot_loader/bl_crc32.h"
+#include "boot_loader/bl_flash.h"
+#include "boot_loader/bl_journal.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_journal_api
+//! @{
+//
+//*****************************************************************************
+#if defined(FLASH_JOURNAL_ADDRESS) || defined(DOXYGEN)
+
+//*****************************************************************************
+//
+// Make sure that the journal starts on an erasable flash boundary.
+//
+//*****************************************************************************
+#if (FLASH_JOURNAL_ADDRESS & (BL_FLASH_ERASE_SIZE - 1))
+#error ERROR: FLASH_JOURNAL_ADDRESS must be a multiple of the flash erase size!
+#endif
+
+//*****************************************************************************
+//
+// The address of the first unused record in the journal.
+//
+//*****************************************************************************
+static uint32_t g_ui32JournalRecord;
+
+//*****************************************************************************
+//
+// The size of the image being downloaded and the number of bytes of it
+// between commit records, or zero if no download is being journaled.
+//
+//*****************************************************************************
+static uint32_t g_ui32JournalSize;
+static uint32_t g_ui32JournalStride;
+
+//*****************************************************************************
+//
+// The number of bytes of the image that have been programmed, the number at
+// which the next commit record is due and the running CRC32 of the bytes
+// programmed.
+//
+//*****************************************************************************
+static uint32_t g_ui32JournalOffset;
+static uint32_t g_ui32JournalNext;
+static uint32_t g_ui32JournalCRC;
+
+//*****************************************************************************
+//
+// Returns the number of bytes of an image of the given size to program
+// between commit records.  This is the smallest multiple of the flash page
+// size that leaves room in the journal for every commit record.
+//
+//*****************************************************************************
+static uint32_t
+JournalStride(uint32_t ui32Size)
+{
+    uint32_t ui32Span;
+
+    ui32Span = FLASH_PAGE_SIZE * (JOURNAL_NUM_RECORDS - 2);
+
+    return(FLASH_PAGE_SIZE * (((ui32Size + ui32Span - 1) / ui32Span) +
+                              ((ui32Size == 0) ? 1 : 0)));
+}
+
+//*****************************************************************************
+//
+// Appends a record to the journal.
+//
+//*****************************************************************************
+static void
+JournalWrite(uint32_t ui32Marker, uint32_t ui32Value1, uint32_t ui32Value2)
+{
+    uint32_t pui32Record[JOURNAL_RECORD_SIZE / 4];
+
+    if(g_ui32JournalRecord >= (FLASH_JOURNAL_ADDRESS + BL_FLASH_ERASE_SIZE))
+    {
+        return;
+    }
+
+    pui32Record[0] = ui32Marker;
+    pui32Record[1] = ui32Value1;
+    pui32Record[2] = ui32Value2;
+    pui32Record[3] = ~(ui32Value1 ^ ui32Value2);
+    BL_FLASH_PROGRAM_FN_HOOK(g_ui32JournalRecord, (uint8_t *)pui32Record,
+                             JOURNAL_RECORD_SIZE);
+    g_ui32JournalRecord += JOURNAL_RECORD_SIZE;
+}
+
+//*****************************************************************************
+//
+// Checks whether a record of the journal is valid and has the given marker.
+//
+//*****************************************************************************
+static bool
+JournalValid(uint32_t ui32Record, uint32_t ui32Marker)
+{
+    return((HWREG(ui32Record) == ui32Marker) &&
+           (HWREG(ui32Record + 12) ==
+            ~(HWREG(ui32Record + 4) ^ HWREG(ui32Record + 8))));
+}
+
+//*****************************************************************************
+//
+//! Erases the journal.
+//!
+//! This function forgets any earlier download.  It is called before the flash
+//! for a new image is erased, and JournalStart() only once that erase has
+//! succeeded, so that a reset part way through the erase leaves an empty
+//! journal and nothing is resumed into flash that was only partly erased.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+JournalErase(void)
+{
+    BL_FLASH_ERASE_FN_HOOK(FLASH_JOURNAL_ADDRESS);
+    g_ui32JournalRecord = FLASH_JOURNAL_ADDRESS;
+    g_ui32JournalStride = 0;
+}
+
+//*****************************************************************************
+//
+//! Starts the journal of a new download.
+//!
+//! \param ui32Address is the address to which the image is downloaded.
+//! \param ui32Size is the size of the image in bytes.
+//!
+//! This function writes the start record of a download to the journal erased
+//! by JournalErase().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+JournalStart(uint32_t ui32Address, uint32_t ui32Size)
+{
+    JournalWrite(JOURNAL_START, ui32Address, ui32Size);
+    g_ui32JournalSize = ui32Size;
+    g_ui32JournalStride = JournalStride(ui32Size);
+    g_ui32JournalOffset = 0;
+    g_ui32JournalNext = g_ui32JournalStride;
+    g_ui32JournalCRC = 0xffffffff;
+}
+
+//*****************************************************************************
+//
+//! Records that data has been programmed.
+//!
+//! \param pui8Data is the data programmed, or 0 if the data was skipped and
+//! left erased.
+//! \param ui32Length is the number of bytes programmed.
+//!
+//! This function adds the data to the running CRC32 of the image and,
+//! whenever another stride of the image has been programmed or the image is
+//! complete, appends a commit record holding the number of bytes programmed
+//! and the CRC32 of them.  Bytes padding the last block beyond the end of
+//! the image are not included in the CRC32.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+JournalData(const uint8_t *pui8Data, uint32_t ui32Length)
+{
+    uint32_t ui32Count;
+    uint8_t ui8Erased;
+
+    if((g_ui32JournalStride == 0) ||
+       (g_ui32JournalOffset >= g_ui32JournalSize))
+    {
+        return;
+    }
+
+    ui32Count = g_ui32JournalSize - g_ui32JournalOffset;
+    if(ui32Count > ui32Length)
+    {
+        ui32Count = ui32Length;
+    }
+    if(pui8Data)
+    {
+        g_ui32JournalCRC = CalculateCRC32((uint8_t *)pui8Data, ui32Count,
+                                          g_ui32JournalCRC);
+    }
+    else
+    {
+        ui8Erased = 0xff;
+        while(ui32Count--)
+        {
+            g_ui32JournalCRC = CalculateCRC32(&ui8Erased, 1,
+                                              g_ui32JournalCRC);
+        }
+    }
+    g_ui32JournalOffset += ui32Length;
+
+    if((g_ui32JournalOffset >= g_ui32JournalNext) ||
+       (g_ui32JournalOffset >= g_ui32JournalSize))
+    {
+        JournalWrite(JOURNAL_COMMIT, g_ui32JournalOffset, g_ui32JournalCRC);
+        g_ui32JournalNext = (((g_ui32JournalOffset / g_ui32JournalStride) +
+                              1) * g_ui32JournalStride);
+    }
+}
+
+//*****************************************************************************
+//
+//! Returns the address of the download that the journal records.
+//!
+//! This function lets a download whose address the boot loader chose itself,
+//! such as a staged boot loader, be resumed at the same address.
+//!
+//! \return Returns the address given to JournalStart(), or 0xFFFFFFFF if the
+//! journal does not hold a download.
+//
+//*****************************************************************************
+uint32_t
+JournalAddress(void)
+{
+    if(!JournalValid(FLASH_JOURNAL_ADDRESS, JOURNAL_START))
+    {
+        return(0xffffffff);
+    }
+
+    return(HWREG(FLASH_JOURNAL_ADDRESS + 4));
+}
+
+//*****************************************************************************
+//
+//! Checks whether the journal holds an unfinished download.
+//!
+//! \param ui32Address is the address of the download to look for.
+//!
+//! This function finds whether the journal holds a download to the given
+//! address whose last valid commit record falls short of the end of the
+//! image, which is then only partly programmed.  It is used at reset, so it
+//! reads the journal without changing the state kept for a download.
+//!
+//! \return Returns non-zero if the download is unfinished or 0 otherwise.
+//
+//*****************************************************************************
+uint32_t
+JournalUnfinished(uint32_t ui32Address)
+{
+    uint32_t ui32Record, ui32Offset;
+
+    if(!JournalValid(FLASH_JOURNAL_ADDRESS, JOURNAL_START) ||
+       (HWREG(FLASH_JOURNAL_ADDRESS + 4) != ui32Address))
+    {
+        return(0);
+    }
+
+    ui32Offset = 0;
+    for(ui32Record = FLASH_JOURNAL_ADDRESS + JOURNAL_RECORD_SIZE;
+        ui32Record < (FLASH_JOURNAL_ADDRESS + BL_FLASH_ERASE_SIZE);
+        ui32Record += JOURNAL_RECORD_SIZE)
+    {
+        if(JournalValid(ui32Record, JOURNAL_COMMIT))
+        {
+            ui32Offset = HWREG(ui32Record + 4);
+        }
+        else if(HWREG(ui32Record) == 0xffffffff)
+        {
+            break;
+        }
+    }
+
+    return(ui32Offset < HWREG(FLASH_JOURNAL_ADDRESS + 8));
+}
+
+//*****************************************************************************
+//
+//! Finds the point from which an interrupted download can be resumed.
+//!
+//! \param ui32Address is the address to which the image is downloaded.
+//! \param ui32Size is the size of the image in bytes.
+//! \param pui32Offset is where the number of bytes already programmed is
+//! returned.
+//! \param pui32CRC is where the CRC32 of those bytes is returned.
+//!
+//! This function checks that the journal holds a download of an image of
+//! the same size to the same address and, if so, finds its last valid commit
+//! record and carries on journaling from there.  Records left partially
+//! programmed by a reset are skipped.  The host compares the CRC32 returned
+//! with that of the start of its own image before continuing, so that a
+//! different image of the same size is never resumed.
+//!
+//! \return Returns non-zero if the download can be resumed or 0 otherwise.
+//
+//*****************************************************************************
+uint32_t
+JournalResume(uint32_t ui32Address, uint32_t ui32Size, uint32_t *pui32Offset,
+              uint32_t *pui32CRC)
+{
+    uint32_t ui32Record;
+
+    g_ui32JournalStride = 0;
+    if(!JournalValid(FLASH_JOURNAL_ADDRESS, JOURNAL_START) ||
+       (HWREG(FLASH_JOURNAL_ADDRESS + 4) != ui32Address) ||
+       (HWREG(FLASH_JOURNAL_ADDRESS + 8) != ui32Size))
+    {
+        return(0);
+    }
+
+    //
+    // Find the last valid commit record and the first unused record.
+    //
+    g_ui32JournalOffset = 0;
+    g_ui32JournalCRC = 0xffffffff;
+    for(ui32Record = FLASH_JOURNAL_ADDRESS + JOURNAL_RECORD_SIZE;
+        ui32Record < (FLASH_JOURNAL_ADDRESS + BL_FLASH_ERASE_SIZE);
+        ui32Record += JOURNAL_RECORD_SIZE)
+    {
+        if((HWREG(ui32Record) == 0xffffffff) &&
+           (HWREG(ui32Record + 4) == 0xffffffff) &&
+           (HWREG(ui32Record + 8) == 0xffffffff) &&
+           (HWREG(ui32Record + 12) == 0xffffffff))
+        {
+            break;
+        }
+        if(JournalValid(ui32Record, JOURNAL_COMMIT))
+        {
+            g_ui32JournalOffset = HWREG(ui32Record + 4);
+            g_ui32JournalCRC = HWREG(ui32Record + 8);
+        }
+    }
+
+    g_ui32JournalRecord = ui32Record;
+    g_ui32JournalSize = ui32Size;
+    g_ui32JournalStride = JournalStride(ui32Size);
+    g_ui32JournalNext = (((g_ui32JournalOffset / g_ui32JournalStride) + 1) *
+                         g_ui32JournalStride);
+
+    *pui32Offset = g_ui32JournalOffset;
+    *pui32CRC = ~g_ui32JournalCRC;
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+#endif
@@ -0,0 +1,69 @@
+//*****************************************************************************
+//
+// bl_journal.h - Definitions for the download progress journal.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_JOURNAL_H__
+#define __BL_JOURNAL_H__
+
+//*****************************************************************************
+//
+// The markers that start the records of the journal.  A download is
+// described by one start record followed by a commit record for every part
+// of the image that has been programmed since.
+//
+//*****************************************************************************
+#define JOURNAL_START           0x4a524e31
+#define JOURNAL_COMMIT          0x4a524e32
+
+//*****************************************************************************
+//
+// The size of each record in bytes.  Every record is four words: the marker,
+// two values and the inverse of the exclusive OR of the two values, so a
+// record left partially programmed by a reset is never mistaken for a valid
+// one.
+//
+//*****************************************************************************
+#define JOURNAL_RECORD_SIZE     16
+
+//*****************************************************************************
+//
+// The number of records that the journal holds.  The journal fills a whole
+// erasable region of flash so that no other data is lost when it is erased.
+//
+//*****************************************************************************
+#define JOURNAL_NUM_RECORDS     (BL_FLASH_ERASE_SIZE / JOURNAL_RECORD_SIZE)
+
+//*****************************************************************************
+//
+// Journal APIs
+//
+//*****************************************************************************
+extern void JournalErase(void);
+extern void JournalStart(uint32_t ui32Address, uint32_t ui32Size);
+extern void JournalData(const uint8_t *pui8Data, uint32_t ui32Length);
+extern uint32_t JournalAddress(void);
+extern uint32_t JournalUnfinished(uint32_t ui32Address);
+extern uint32_t JournalResume(uint32_t ui32Address, uint32_t ui32Size,
+                              uint32_t *pui32Offset, uint32_t *pui32CRC);
+
+#endif // __BL_JOURNAL_H__
@@ -0,0 +1,232 @@
+//*****************************************************************************
+//
+// bl_loopback.c - Functions used to transfer data through an SRAM mailbox.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "bl_config.h"
+#include "boot_loader/bl_loopback.h"
+#include "boot_loader/bl_timer.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_loopback_api
+//! @{
+//
+//*****************************************************************************
+#if defined(LOOPBACK_ENABLE_UPDATE) || defined(DOXYGEN)
+#if !defined(UART_ENABLE_UPDATE) && !defined(SSI_ENABLE_UPDATE)
+#error ERROR: LOOPBACK_ENABLE_UPDATE requires the UART or SSI transport!
+#endif
+#ifndef LOOPBACK_ADDRESS
+#error ERROR: LOOPBACK_ENABLE_UPDATE requires LOOPBACK_ADDRESS!
+#endif
+#if (LOOPBACK_ADDRESS & 3)
+#error ERROR: LOOPBACK_ADDRESS must be a multiple of 4!
+#endif
+
+//*****************************************************************************
+//
+// Accesses a word of the mailbox, and a byte of one of its rings at a head
+// or tail count.
+//
+//*****************************************************************************
+#define LOOPBACK_REG(ui32Offset)                                              \
+        HWREG(LOOPBACK_ADDRESS + (ui32Offset))
+#define LOOPBACK_BYTE(ui32Ring, ui32Count)                                    \
+        HWREGB(LOOPBACK_ADDRESS + (ui32Ring) +                                \
+               ((ui32Count) & (LOOPBACK_RING_SIZE - 1)))
+
+//*****************************************************************************
+//
+//! Empties the loopback mailbox.
+//!
+//! This function sets both rings of the mailbox at \b LOOPBACK_ADDRESS to
+//! empty.  The other end must not write to the mailbox until the boot loader
+//! has started.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ConfigureLoopback(void)
+{
+    LOOPBACK_REG(LOOPBACK_O_RX_HEAD) = 0;
+    LOOPBACK_REG(LOOPBACK_O_RX_TAIL) = 0;
+    LOOPBACK_REG(LOOPBACK_O_TX_HEAD) = 0;
+    LOOPBACK_REG(LOOPBACK_O_TX_TAIL) = 0;
+}
+
+//*****************************************************************************
+//
+//! Checks whether the other end has written a byte to the mailbox.
+//!
+//! \return Returns non-zero if a byte is waiting to be read or 0 otherwise.
+//
+//*****************************************************************************
+uint32_t
+LoopbackPoll(void)
+{
+    return(LOOPBACK_REG(LOOPBACK_O_RX_HEAD) !=
+           LOOPBACK_REG(LOOPBACK_O_RX_TAIL));
+}
+
+//*****************************************************************************
+//
+//! Writes data to the transmit ring of the mailbox.
+//!
+//! \param pui8Data is the location of the data to be sent.
+//! \param ui32Size is the number of bytes of data to send.
+//!
+//! This function writes the data to the transmit ring, waiting whenever the
+//! ring is full for the other end to read from it.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LoopbackWrite(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint32_t ui32Head;
+
+    ui32Head = LOOPBACK_REG(LOOPBACK_O_TX_HEAD);
+    while(ui32Size--)
+    {
+        while((ui32Head - LOOPBACK_REG(LOOPBACK_O_TX_TAIL)) >=
+              LOOPBACK_RING_SIZE)
+        {
+        }
+        LOOPBACK_BYTE(LOOPBACK_O_TX, ui32Head) = *pui8Data++;
+        LOOPBACK_REG(LOOPBACK_O_TX_HEAD) = ++ui32Head;
+    }
+}
+
+//*****************************************************************************
+//
+//! Sends data through the mailbox.
+//!
+//! \param pui8Data is the location of the data to be sent.
+//! \param ui32Size is the number of bytes of data to send.
+//!
+//! This function writes the data to the transmit ring as LoopbackWrite()
+//! does; the other end sees each byte as soon as it is written.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LoopbackSend(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    LoopbackWrite(pui8Data, ui32Size);
+}
+
+//*****************************************************************************
+//
+//! Waits until the other end has read all of the data sent.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LoopbackFlush(void)
+{
+    while(LOOPBACK_REG(LOOPBACK_O_TX_TAIL) !=
+          LOOPBACK_REG(LOOPBACK_O_TX_HEAD))
+    {
+    }
+}
+
+//*****************************************************************************
+//
+//! Receives data from the receive ring of the mailbox.
+//!
+//! \param pui8Data is the location to store the data received.
+//! \param ui32Size is the number of bytes of data to receive.
+//!
+//! This function will not return until \e ui32Size number of bytes have
+//! been received.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LoopbackReceive(uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint32_t ui32Tail;
+
+    ui32Tail = LOOPBACK_REG(LOOPBACK_O_RX_TAIL);
+    while(ui32Size--)
+    {
+        while(LOOPBACK_REG(LOOPBACK_O_RX_HEAD) == ui32Tail)
+        {
+        }
+        *pui8Data++ = LOOPBACK_BYTE(LOOPBACK_O_RX, ui32Tail);
+        LOOPBACK_REG(LOOPBACK_O_RX_TAIL) = ++ui32Tail;
+    }
+}
+
+//*****************************************************************************
+//
+//! Receives data from the mailbox with an inter-byte timeout.
+//!
+//! \param pui8Data is the location to store the data received.
+//! \param ui32Size is the number of bytes of data to receive.
+//!
+//! This function behaves like LoopbackReceive() except that it gives up if
+//! the gap before any one of the requested bytes exceeds \b UART_RX_TIMEOUT
+//! milliseconds.
+//!
+//! \return Returns zero if all \e ui32Size bytes were received or a negative
+//! value if the other end stopped writing first.
+//
+//*****************************************************************************
+int
+LoopbackReceiveTimeout(uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint32_t ui32Tail;
+
+    ui32Tail = LOOPBACK_REG(LOOPBACK_O_RX_TAIL);
+    while(ui32Size--)
+    {
+        BLTimerStart();
+        while(LOOPBACK_REG(LOOPBACK_O_RX_HEAD) == ui32Tail)
+        {
+            if(BLTimerExpired())
+            {
+                return(-1);
+            }
+        }
+        *pui8Data++ = LOOPBACK_BYTE(LOOPBACK_O_RX, ui32Tail);
+        LOOPBACK_REG(LOOPBACK_O_RX_TAIL) = ++ui32Tail;
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+#endif
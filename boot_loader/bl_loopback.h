@@ -0,0 +1,71 @@
+//*****************************************************************************
+//
+// bl_loopback.h - Definitions for the SRAM loopback transport functions.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_LOOPBACK_H__
+#define __BL_LOOPBACK_H__
+
+//*****************************************************************************
+//
+// The size of each of the two rings of the loopback mailbox.  This must be a
+// power of 2.
+//
+//*****************************************************************************
+#ifndef LOOPBACK_RING_SIZE
+#define LOOPBACK_RING_SIZE      256
+#endif
+#if (LOOPBACK_RING_SIZE & (LOOPBACK_RING_SIZE - 1))
+#error ERROR: LOOPBACK_RING_SIZE must be a power of 2!
+#endif
+
+//*****************************************************************************
+//
+// The layout of the loopback mailbox at LOOPBACK_ADDRESS.  Each ring has a
+// head, the number of bytes ever written to it, and a tail, the number of
+// bytes ever read from it, each only written by its own side.  The other end
+// writes packets to the receive ring and advances its head, and reads the
+// responses from the transmit ring and advances its tail.
+//
+//*****************************************************************************
+#define LOOPBACK_O_RX_HEAD      0x00000000  // Written by the other end
+#define LOOPBACK_O_RX_TAIL      0x00000004  // Written by the boot loader
+#define LOOPBACK_O_TX_HEAD      0x00000008  // Written by the boot loader
+#define LOOPBACK_O_TX_TAIL      0x0000000c  // Written by the other end
+#define LOOPBACK_O_RX           0x00000010  // The receive ring
+#define LOOPBACK_O_TX           (LOOPBACK_O_RX + LOOPBACK_RING_SIZE)
+#define LOOPBACK_SIZE           (LOOPBACK_O_TX + LOOPBACK_RING_SIZE)
+
+//*****************************************************************************
+//
+// Loopback Transport APIs
+//
+//*****************************************************************************
+extern void ConfigureLoopback(void);
+extern uint32_t LoopbackPoll(void);
+extern void LoopbackSend(const uint8_t *pui8Data, uint32_t ui32Size);
+extern void LoopbackWrite(const uint8_t *pui8Data, uint32_t ui32Size);
+extern void LoopbackReceive(uint8_t *pui8Data, uint32_t ui32Size);
+extern int LoopbackReceiveTimeout(uint8_t *pui8Data, uint32_t ui32Size);
+extern void LoopbackFlush(void);
+
+#endif // __BL_LOOPBACK_H__
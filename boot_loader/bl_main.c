@@ -46,12 +46,32 @@
 #include "boot_loader/bl_i2c.h"
 #include "boot_loader/bl_packet.h"
 #include "boot_loader/bl_ssi.h"
+#include "boot_loader/bl_timer.h"
+#include "boot_loader/bl_transport.h"
 #include "boot_loader/bl_uart.h"
 #include "driverlib/flash.h"
 
-#ifdef CHECK_CRC
+#if defined(CHECK_CRC) || defined(FLASH_JOURNAL_ADDRESS)
 #include "boot_loader/bl_crc32.h"
 #endif
+#ifdef FLASH_JOURNAL_ADDRESS
+#include "boot_loader/bl_journal.h"
+#endif
+#ifdef IMAGE_DIGEST
+#include "boot_loader/bl_sha256.h"
+#endif
+#ifdef BL_HANDOFF_ADDRESS
+#include "boot_loader/bl_handoff.h"
+#endif
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+#include "boot_loader/bl_wear.h"
+#endif
+#ifdef META_EEPROM_ADDRESS
+#include "boot_loader/bl_meta.h"
+#endif
+#ifdef BL_WATCHDOG_TIMEOUT
+#include "driverlib/watchdog.h"
+#endif
 extern void BOOTRun(uint32_t BaseAddr);
 //*****************************************************************************
 //
@@ -71,6 +91,45 @@ extern void BOOTRun(uint32_t BaseAddr);
 #error ERROR: FLASH_RSVD_SPACE must be a multiple of FLASH_PAGE_SIZE bytes!
 #endif
 
+//*****************************************************************************
+//
+// Make sure that a staged boot loader update can be checked before it is
+// installed.
+//
+//*****************************************************************************
+#if defined(BL_UPDATE_STAGED) &&                                              \
+    (!defined(ENABLE_BL_UPDATE) || !defined(IMAGE_DIGEST))
+#error ERROR: BL_UPDATE_STAGED requires ENABLE_BL_UPDATE and IMAGE_DIGEST!
+#endif
+
+//*****************************************************************************
+//
+// Make sure that a handoff from the application names a UART to keep using.
+//
+//*****************************************************************************
+#if defined(BL_HANDOFF_ADDRESS) && !defined(UART_ENABLE_UPDATE)
+#error ERROR: BL_HANDOFF_ADDRESS requires UART_ENABLE_UPDATE!
+#endif
+
+//*****************************************************************************
+//
+// Make sure that the regions of a manifest session can be checked.
+//
+//*****************************************************************************
+#if defined(ENABLE_MANIFEST_UPDATE) && !defined(IMAGE_DIGEST)
+#error ERROR: ENABLE_MANIFEST_UPDATE requires IMAGE_DIGEST!
+#endif
+
+//*****************************************************************************
+//
+// Make sure that the watchdog can be loaded with half of the session timeout
+// at the fastest system clock.
+//
+//*****************************************************************************
+#if defined(BL_WATCHDOG_TIMEOUT) && (BL_WATCHDOG_TIMEOUT > 60000)
+#error ERROR: BL_WATCHDOG_TIMEOUT must be no more than 60000!
+#endif
+
 //*****************************************************************************
 //
 //! \addtogroup bl_main_api
@@ -104,6 +163,15 @@ extern void Delay(uint32_t ui32Count);
 //*****************************************************************************
 uint8_t g_ui8Status;
 
+//*****************************************************************************
+//
+// Holds the system clock frequency set up by ConfigureDevice() or handed off
+// by the application, or zero if the boot loader was entered from the
+// application and the frequency is unknown.
+//
+//*****************************************************************************
+uint32_t g_ui32SysClock;
+
 //*****************************************************************************
 //
 // This holds the current remaining size in bytes to be downloaded.
@@ -128,10 +196,90 @@ uint32_t g_ui32ImageSize;
 //
 //*****************************************************************************
 uint32_t g_ui32TransferAddress;
+
+//*****************************************************************************
+//
+// This holds the number of the next 128 byte data block expected since the
+// start of the download.  The host polls it to find out which, if any, of the
+// blocks broadcast to a whole bus segment a node has missed.
+//
+//*****************************************************************************
+uint32_t g_ui32NextBlock;
+
+//*****************************************************************************
+//
+// These hold the last data block programmed, as it was received, whether
+// there is one, whether it was the same as the block before it, whether a
+// different block has since followed such a repeat, and the address that the
+// first block of the download was programmed at.  A plain data packet carries
+// no block number, so these are all there is to tell one sent again from the
+// next.
+//
+//*****************************************************************************
+static uint8_t g_pui8LastBlock[PACKET_DATA_SIZE];
+static bool g_bLastBlock;
+static bool g_bLastRepeat;
+static bool g_bRepeatShifted;
+static uint32_t g_ui32DataStart;
+
+//*****************************************************************************
+//
+// The copy of a data block that is decrypted and programmed, which leaves the
+// block as received alone.  It is word aligned so that the AES module can
+// decrypt it through the uDMA controller.
+//
+//*****************************************************************************
+#ifdef BL_DECRYPT_FN_HOOK
+static uint32_t g_pui32DecryptBlock[PACKET_DATA_SIZE / 4];
+#endif
 #ifdef CHECK_CRC
 uint32_t g_ui32ImageAddress;
 #endif
 
+//*****************************************************************************
+//
+// This holds the SHA-256 digest of the image downloaded so far, which is
+// computed from flash as each block is programmed.
+//
+//*****************************************************************************
+#ifdef IMAGE_DIGEST
+tSHA256Context g_sImageDigest;
+#endif
+
+//*****************************************************************************
+//
+// This holds the size of the new boot loader being staged in the application
+// region by a download to address 0, or zero if the download in progress is
+// not one, and the address at which it is staged.
+//
+//*****************************************************************************
+#ifdef BL_UPDATE_STAGED
+uint32_t g_ui32StageSize;
+uint32_t g_ui32StageAddress = APP_START_ADDRESS;
+#endif
+
+//*****************************************************************************
+//
+// The regions listed by the manifest of a manifest session, which are
+// downloaded one after another, the number of them, or zero if the download
+// in progress is not a manifest session, and the index of the region being
+// downloaded.
+//
+//*****************************************************************************
+#ifdef ENABLE_MANIFEST_UPDATE
+typedef struct
+{
+    uint32_t ui32Address;
+    uint32_t ui32Size;
+    uint8_t pui8Digest[SHA256_DIGEST_SIZE];
+}
+tManifestRegion;
+
+static tManifestRegion g_psManifest[MANIFEST_MAX_REGIONS];
+static uint32_t g_ui32ManifestRegions;
+static uint32_t g_ui32ManifestRegion;
+#endif
+
 //*****************************************************************************
 //
 // This is the data buffer used during transfers to the boot loader.
@@ -193,22 +341,16 @@ SwapWord(uint32_t x)
 //
 //*****************************************************************************
 void ConfigureDevice(void){
-    uint32_t g_ui32SysClock;
     g_ui32SysClock = SysCtlClockFreqSet((SYSCTL_XTAL_16MHZ |
                                              SYSCTL_OSC_MAIN |
                                              SYSCTL_USE_PLL |
                                          SYSCTL_CFG_VCO_480),80000000);
-            SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
-            SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
-            GPIOPinConfigure(GPIO_PA0_U0RX);
-            GPIOPinConfigure(GPIO_PA1_U0TX);
-            GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
-            UARTConfigSetExpClk(UART0_BASE, g_ui32SysClock, 115200,
-                                    (UART_CONFIG_WLEN_8 |  UART_CONFIG_STOP_ONE |
-                                     UART_CONFIG_PAR_NONE));
-            UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
-            SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
-            GPIOPinTypeGPIOOutput(GPIO_PORTA_BASE, GPIO_PIN_2);
+#if defined(SSI_ENABLE_UPDATE) || defined(UART_ENABLE_UPDATE)
+    //
+    // Configure every port that packets may arrive on.
+    //
+    TransportInit();
+#endif
 }
 /*
 void
@@ -414,115 +556,626 @@ ConfigureDevice(void)
 #endif
 }
 */
+#if defined(BL_HANDOFF_ADDRESS) || defined(DOXYGEN)
 //*****************************************************************************
 //
-//! This function performs the update on the selected port.
+//! Takes over the system clock and UART from the application.
 //!
-//! This function is called directly by the boot loader or it is called as a
-//! result of an update request from the application.
+//! This function is called when the application enters the boot loader
+//! through the SVCall vector.  If the application has left a valid handoff
+//! for the boot loader's UART at \b BL_HANDOFF_ADDRESS, the clock frequency
+//! it gives is taken as the system clock, and the UART is left as it is
+//! unless the application has not enabled it, in which case it is set up at
+//! the handed-off baud rate.  Otherwise the microcontroller is configured as
+//! it is after a reset.  The handoff is then invalidated.
 //!
-//! \return Never returns.
+//! \return None.
 //
 //*****************************************************************************
-union
+void
+HandoffConfigure(void)
 {
-    uint32_t g_pui32DataBuffer;
-    union
+    tBLHandoff sHandoff;
+
+    sHandoff.ui32Marker = HWREG(BL_HANDOFF_ADDRESS + BL_HANDOFF_O_MARKER);
+    sHandoff.ui32SysClock = HWREG(BL_HANDOFF_ADDRESS + BL_HANDOFF_O_CLOCK);
+    sHandoff.ui32UARTBase = HWREG(BL_HANDOFF_ADDRESS + BL_HANDOFF_O_UART);
+    sHandoff.ui32BaudRate = HWREG(BL_HANDOFF_ADDRESS + BL_HANDOFF_O_BAUD);
+    sHandoff.ui32Check = HWREG(BL_HANDOFF_ADDRESS + BL_HANDOFF_O_CHECK);
+
+    if((sHandoff.ui32Marker == BL_HANDOFF_MARKER) &&
+       (sHandoff.ui32Check == BL_HANDOFF_CHECK(&sHandoff)) &&
+       (sHandoff.ui32UARTBase == UARTx_BASE) &&
+       (sHandoff.ui32SysClock != 0) && (sHandoff.ui32BaudRate != 0))
     {
-        uint16_t u16ADD_H;
-        struct
+        g_ui32SysClock = sHandoff.ui32SysClock;
+
+        //
+        // Only set up the UART if the application has not, so that a byte
+        // already on its way from the host is not lost.
+        //
+        if(!(HWREG(UARTx_BASE + UART_O_CTL) & UART_CTL_UARTEN))
         {
-            uint8_t add_H;
-            uint8_t add_L;
-        };
-    }ADD_H;
-    union
+            g_ui32UARTBaudRate = sHandoff.ui32BaudRate;
+            ConfigureUART();
+        }
+#ifdef SSI_ENABLE_UPDATE
+        ConfigureSSI();
+#endif
+    }
+    else
     {
-        uint16_t u16ADD_L;
-        struct
-        {
-            uint8_t add_H;
-            uint8_t add_L;
-        };
-    }ADD_L;
-}Program_Address;
-union
+        ConfigureDevice();
+    }
+
+    HWREG(BL_HANDOFF_ADDRESS + BL_HANDOFF_O_MARKER) = 0;
+}
+
+#endif
+#ifdef BL_UPDATE_STAGED
+//*****************************************************************************
+//
+//! Finds the least worn place to stage a new boot loader.
+//!
+//! \param ui32Size is the size of the new boot loader.
+//!
+//! This function looks at each erasable block of the application region from
+//! \b APP_START_ADDRESS on where the new boot loader could start, leaving
+//! out places that run into the reserved space, the progress journal or the
+//! signature cache, and adds up the erase counters of the blocks that staging
+//! it there would erase.  The first block of the application is left out of
+//! the sum, since it is erased wherever the new boot loader goes so that the
+//! application that it overwrites is not run.
+//!
+//! \return Returns the address with the lowest total, the lowest such address
+//! if there is more than one.
+//
+//*****************************************************************************
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+static uint32_t
+StagePlace(uint32_t ui32Size)
 {
-    uint32_t g_pui32DataSize;
-    struct
+    uint32_t ui32Addr, ui32End, ui32Block, ui32Wear, ui32Best, ui32BestWear;
+
+    ui32End = BL_FLASH_SIZE_FN_HOOK();
+#ifdef FLASH_RSVD_SPACE
+    ui32End -= FLASH_RSVD_SPACE;
+#endif
+    ui32Best = APP_START_ADDRESS;
+    ui32BestWear = 0xffffffff;
+    for(ui32Addr = APP_START_ADDRESS; (ui32Addr + ui32Size) <= ui32End;
+        ui32Addr += BL_FLASH_ERASE_SIZE)
     {
-        union
+#ifdef FLASH_JOURNAL_ADDRESS
+        if(((ui32Addr + ui32Size) > FLASH_JOURNAL_ADDRESS) &&
+           (ui32Addr < (FLASH_JOURNAL_ADDRESS + BL_FLASH_ERASE_SIZE)))
         {
-            uint16_t u16size_H;
-            struct
-            {
-                uint8_t size_H;
-                uint8_t size_L;
-            };
-        }Size_H;
-        union
+            continue;
+        }
+#endif
+#ifdef SIGN_CACHE_ADDRESS
+        if(((ui32Addr + ui32Size) > SIGN_CACHE_ADDRESS) &&
+           (ui32Addr < (SIGN_CACHE_ADDRESS + BL_FLASH_ERASE_SIZE)))
         {
-            uint16_t u16size_L;
-            struct
+            continue;
+        }
+#endif
+        ui32Wear = 0;
+        for(ui32Block = ui32Addr; ui32Block < (ui32Addr + ui32Size);
+            ui32Block += BL_FLASH_ERASE_SIZE)
+        {
+            if(ui32Block != APP_START_ADDRESS)
             {
-                uint8_t size_H;
-                uint8_t size_L;
-            };
-        }Size_L;
-    };
-}Program_Size;
-
-union FlashBuff
-    {
-        uint8_t flash_buff[128];
-        struct flash
+                ui32Wear += WearGet(ui32Block / BL_FLASH_ERASE_SIZE);
+            }
+        }
+        if(ui32Wear < ui32BestWear)
         {
-         uint8_t buff_1;
-         uint8_t buff_2;
-         uint8_t buff_3;
-         uint8_t buff_4;
-        }flashbuff[32];
-    }FlashBuff;
-int i;
-void
-Updater(void)
+            ui32Best = ui32Addr;
+            ui32BestWear = ui32Wear;
+        }
+    }
+
+    return(ui32Best);
+}
+#endif
+
+//*****************************************************************************
+//
+//! Moves a download of a new boot loader to where it is staged.
+//!
+//! \param bResume is true if the download is being resumed.
+//!
+//! This function is called once the address and size of a download have been
+//! checked.  A download to address 0 is a new boot loader, which is programmed
+//! into the application region, starting at \b APP_START_ADDRESS, until it is
+//! installed by a write of register 0x600B.  If \b FLASH_WEAR_EEPROM_ADDRESS
+//! is defined, it starts wherever StagePlace() finds instead, and a resumed
+//! download carries on where the progress journal says that it was started.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+StageAddress(bool bResume)
 {
-    uint32_t ui32Temp, ui32FlashSize;
+#if !defined(FLASH_WEAR_EEPROM_ADDRESS) || !defined(FLASH_JOURNAL_ADDRESS)
     //
-    // Insure that the COMMAND_SEND_DATA cannot be sent to erase the boot
-    // loader before the application is erased.
+    // Only a placed stage needs to know whether it is being resumed.
     //
-    g_ui32TransferAddress = 0xffffffff;
+    (void)bResume;
+#endif
+
+    g_ui32StageSize = 0;
+    if(g_ui32TransferAddress == 0)
+    {
+        g_ui32StageSize = g_ui32TransferSize;
+        g_ui32TransferAddress = APP_START_ADDRESS;
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+#ifdef FLASH_JOURNAL_ADDRESS
+        if(bResume)
+        {
+            g_ui32TransferAddress = JournalAddress();
+        }
+        else
+#endif
+        {
+            g_ui32TransferAddress = StagePlace(g_ui32StageSize);
+        }
+#endif
+        g_ui32StageAddress = g_ui32TransferAddress;
+    }
+}
+
+#endif
+
+#ifdef BL_WATCHDOG_TIMEOUT
+//*****************************************************************************
+//
+//! Feeds the watchdog that bounds an update session.
+//!
+//! This function is called each time the session makes progress.  The first
+//! call starts watchdog 0, which resets the microcontroller if
+//! \b BL_WATCHDOG_TIMEOUT milliseconds then pass without another call.  The
+//! watchdog only resets on its second time-out, so it is loaded with half of
+//! that, timed at \b BL_TIMER_DEFAULT_CLOCK if the system clock is unknown.
+//! Later calls restart the count.  Once started, only a reset stops it.  If
+//! the application left watchdog 0 running, it is fed as the application set
+//! it up.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+WatchdogFeed(void)
+{
+    uint32_t ui32Clock;
+
+    if(!WatchdogRunning(WATCHDOG0_BASE))
+    {
+        HWREG(SYSCTL_RCGCWD) |= SYSCTL_RCGCWD_R0;
+        while(!(HWREG(SYSCTL_PRWD) & SYSCTL_PRWD_R0))
+        {
+        }
+        ui32Clock = g_ui32SysClock ? g_ui32SysClock : BL_TIMER_DEFAULT_CLOCK;
+        WatchdogReloadSet(WATCHDOG0_BASE,
+                          (ui32Clock / 2000) * BL_WATCHDOG_TIMEOUT);
+        WatchdogResetEnable(WATCHDOG0_BASE);
+        WatchdogStallEnable(WATCHDOG0_BASE);
+        WatchdogEnable(WATCHDOG0_BASE);
+    }
 
     //
-    // Read any data from the serial port in use.
+    // Clearing the time-out interrupt reloads the counter.
     //
-    while(1)
+    WatchdogIntClear(WATCHDOG0_BASE);
+}
+#endif
+
+//*****************************************************************************
+//
+//! Erases the flash that a download is about to be programmed into.
+//!
+//! \param ui32Address is the start of the download.
+//! \param ui32Size is the size of the download in bytes.
+//!
+//! This function erases every block from the one holding \e ui32Address up to
+//! the end of the download, adding the time taken to the erase time counter.
+//! Each block is erased once, even on TM4C129 devices where an erase clears
+//! more than \b FLASH_PAGE_SIZE, and counts as progress for the session
+//! watchdog.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+DownloadErase(uint32_t ui32Address, uint32_t ui32Size)
+{
+    uint32_t ui32Temp, ui32Stamp;
+
+    for(ui32Temp = ui32Address & ~(BL_FLASH_ERASE_SIZE - 1);
+        ui32Temp < (ui32Address + ui32Size);
+        ui32Temp += BL_FLASH_ERASE_SIZE)
     {
         //
-        // Receive a packet from the port in use.
-        //
-        ReceivePacket(&rxbuff);
-        //
-        // The first byte of the data buffer has the command and determines
-        // the format of the rest of the bytes.
+        // Erase this block, timing each erase separately since the timer
+        // wraps.
         //
-        switch(rxbuff.ADDRESS.Address)
+        ui32Stamp = BLTimerStamp();
+        BL_FLASH_ERASE_FN_HOOK(ui32Temp);
+        g_pui32Stats[STAT_ERASE_TIME] += BLTimerElapsed(ui32Stamp);
+#ifdef BL_WATCHDOG_TIMEOUT
+        WatchdogFeed();
+#endif
+    }
+}
+
+//*****************************************************************************
+//
+//! Compares a data block with the last one programmed.
+//!
+//! \param pui8Data is the data block, as received.
+//!
+//! \return Returns \b true if the block is the same as the last one
+//! programmed.
+//
+//*****************************************************************************
+static bool
+BlockSame(const uint8_t *pui8Data)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < PACKET_DATA_SIZE; ui32Idx++)
+    {
+        if(pui8Data[ui32Idx] != g_pui8LastBlock[ui32Idx])
         {
-            //
-            // This was a simple ping command.
-            //
-            case 0x6001:
-            {
-                //
-                // This command always sets the status to COMMAND_RET_SUCCESS.
-                //
-              //  g_ui8Status = COMMAND_RET_SUCCESS;
+            return(false);
+        }
+    }
 
-                //
-                // Just acknowledge that the command was received.
-                //
-                APP_PingACK();
+    return(true);
+}
+
+//*****************************************************************************
+//
+//! Records a data block that has been programmed.
+//!
+//! \param pui8Data is the data block, as received.
+//!
+//! A plain data (0x6006) packet that the host sends again after losing the
+//! ACK to it is programmed again at the next address, moving the rest of the
+//! image up by a block.  That only changes what ends up in flash if a block
+//! different from the one repeated follows it, so this function keeps a copy
+//! of the block and notes when that happens.  The host sends one packet past
+//! the end of the image for each block moved, which is then checked against
+//! this record.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+BlockRecord(const uint8_t *pui8Data)
+{
+    uint32_t ui32Idx;
+    bool bRepeat;
+
+    if(!g_bLastBlock)
+    {
+        g_ui32DataStart = g_ui32TransferAddress;
+        g_bLastRepeat = false;
+        g_bRepeatShifted = false;
+        bRepeat = false;
+    }
+    else
+    {
+        bRepeat = BlockSame(pui8Data);
+    }
+    if(g_bLastRepeat && !bRepeat)
+    {
+        g_bRepeatShifted = true;
+    }
+    g_bLastRepeat = bRepeat;
+    g_bLastBlock = true;
+
+    for(ui32Idx = 0; ui32Idx < PACKET_DATA_SIZE; ui32Idx++)
+    {
+        g_pui8LastBlock[ui32Idx] = pui8Data[ui32Idx];
+    }
+}
+
+#ifdef META_EEPROM_ADDRESS
+//*****************************************************************************
+//
+//! Counts a completed download.
+//!
+//! This function adds one to the number of downloads whose last block has
+//! been programmed, which is kept in the EEPROM under \b META_KEY_DOWNLOADS.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+DownloadCount(void)
+{
+    uint32_t ui32Count;
+
+    if(!MetaGet(META_KEY_DOWNLOADS, &ui32Count, 1))
+    {
+        ui32Count = 0;
+    }
+    ui32Count++;
+    MetaSet(META_KEY_DOWNLOADS, &ui32Count, 1);
+}
+#endif
+
+#ifdef ENABLE_MANIFEST_UPDATE
+//*****************************************************************************
+//
+//! Starts a manifest session.
+//!
+//! \param pui8Data is the manifest, in the format described in
+//! bl_commands.h.
+//!
+//! This function checks the regions that the manifest lists, erases them all
+//! and sets up the transfer of the first.  If any region is not one that a
+//! download could be made to, is the boot loader or overlaps another, nothing
+//! is erased and the session is not started.
+//!
+//! \return Returns the status of the command.
+//
+//*****************************************************************************
+static uint8_t
+ManifestStart(const uint8_t *pui8Data)
+{
+    tManifestRegion *psRegion;
+    uint32_t ui32Count, ui32Idx, ui32Other;
+
+    g_ui32ManifestRegions = 0;
+    ui32Count = pui8Data[0];
+    if((ui32Count == 0) || (ui32Count > MANIFEST_MAX_REGIONS))
+    {
+        return(COMMAND_RET_INVALID_CMD);
+    }
+
+    //
+    // Unpack and check the regions.
+    //
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        psRegion = &g_psManifest[ui32Idx];
+        psRegion->ui32Address = ((pui8Data[1] << 24) | (pui8Data[2] << 16) |
+                                 (pui8Data[3] << 8) | pui8Data[4]);
+        psRegion->ui32Size = ((pui8Data[5] << 24) | (pui8Data[6] << 16) |
+                              (pui8Data[7] << 8) | pui8Data[8]);
+        for(ui32Other = 0; ui32Other < SHA256_DIGEST_SIZE; ui32Other++)
+        {
+            psRegion->pui8Digest[ui32Other] = pui8Data[9 + ui32Other];
+        }
+        pui8Data += 40;
+
+        if((psRegion->ui32Address == 0) || (psRegion->ui32Size == 0) ||
+           !BL_FLASH_AD_CHECK_FN_HOOK(psRegion->ui32Address,
+                                      psRegion->ui32Size))
+        {
+            return(COMMAND_RET_INVALID_ADR);
+        }
+        for(ui32Other = 0; ui32Other < ui32Idx; ui32Other++)
+        {
+            if((psRegion->ui32Address <
+                (g_psManifest[ui32Other].ui32Address +
+                 g_psManifest[ui32Other].ui32Size)) &&
+               (g_psManifest[ui32Other].ui32Address <
+                (psRegion->ui32Address + psRegion->ui32Size)))
+            {
+                return(COMMAND_RET_INVALID_ADR);
+            }
+        }
+    }
+
+    //
+    // Erase all of the regions in one go.
+    //
+    BL_FLASH_CL_ERR_FN_HOOK();
+#ifdef FLASH_JOURNAL_ADDRESS
+    JournalErase();
+#endif
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+    {
+        DownloadErase(g_psManifest[ui32Idx].ui32Address,
+                      g_psManifest[ui32Idx].ui32Size);
+    }
+    if(BL_FLASH_ERROR_FN_HOOK())
+    {
+        return(COMMAND_RET_FLASH_FAIL);
+    }
+
+    g_ui32ManifestRegions = ui32Count;
+    g_ui32ManifestRegion = 0;
+    g_ui32TransferAddress = g_psManifest[0].ui32Address;
+    g_ui32TransferSize = g_psManifest[0].ui32Size;
+
+    return(COMMAND_RET_SUCCESS);
+}
+
+//*****************************************************************************
+//
+//! Moves a manifest session on once a region has been downloaded.
+//!
+//! This function is called when the transfer of a region of a manifest
+//! session has completed.  It starts the transfer of the next region or,
+//! after the last one, reads every region back from flash and checks its
+//! digest against the manifest, setting the status to
+//! \b COMMAND_RET_CRC_FAIL if any differs.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+ManifestNext(void)
+{
+    tSHA256Context sDigest;
+    uint8_t pui8Digest[SHA256_DIGEST_SIZE];
+    uint32_t ui32Idx, ui32Byte;
+
+    if(++g_ui32ManifestRegion < g_ui32ManifestRegions)
+    {
+        g_ui32TransferAddress =
+            g_psManifest[g_ui32ManifestRegion].ui32Address;
+        g_ui32TransferSize = g_psManifest[g_ui32ManifestRegion].ui32Size;
+        return;
+    }
+
+    for(ui32Idx = 0; ui32Idx < g_ui32ManifestRegions; ui32Idx++)
+    {
+        SHA256Init(&sDigest);
+        SHA256UpdateFlash(&sDigest, g_psManifest[ui32Idx].ui32Address,
+                          g_psManifest[ui32Idx].ui32Size);
+        SHA256Final(&sDigest, pui8Digest);
+        for(ui32Byte = 0; ui32Byte < SHA256_DIGEST_SIZE; ui32Byte++)
+        {
+            if(pui8Digest[ui32Byte] !=
+               g_psManifest[ui32Idx].pui8Digest[ui32Byte])
+            {
+                g_ui8Status = COMMAND_RET_CRC_FAIL;
+            }
+        }
+    }
+    g_ui32ManifestRegions = 0;
+}
+
+#endif
+//*****************************************************************************
+//
+//! This function performs the update on the selected port.
+//!
+//! This function is called directly by the boot loader or it is called as a
+//! result of an update request from the application.
+//!
+//! \return Never returns.
+//
+//*****************************************************************************
+union
+{
+    uint32_t g_pui32DataBuffer;
+    union
+    {
+        uint16_t u16ADD_H;
+        struct
+        {
+            uint8_t add_H;
+            uint8_t add_L;
+        };
+    }ADD_H;
+    union
+    {
+        uint16_t u16ADD_L;
+        struct
+        {
+            uint8_t add_H;
+            uint8_t add_L;
+        };
+    }ADD_L;
+}Program_Address;
+union
+{
+    uint32_t g_pui32DataSize;
+    struct
+    {
+        union
+        {
+            uint16_t u16size_H;
+            struct
+            {
+                uint8_t size_H;
+                uint8_t size_L;
+            };
+        }Size_H;
+        union
+        {
+            uint16_t u16size_L;
+            struct
+            {
+                uint8_t size_H;
+                uint8_t size_L;
+            };
+        }Size_L;
+    };
+}Program_Size;
+
+union FlashBuff
+    {
+        uint8_t flash_buff[128];
+        struct flash
+        {
+         uint8_t buff_1;
+         uint8_t buff_2;
+         uint8_t buff_3;
+         uint8_t buff_4;
+        }flashbuff[32];
+    }FlashBuff;
+int i;
+void
+Updater(void)
+{
+    uint32_t ui32Temp, ui32FlashSize, ui32Stamp;
+    //
+    // Insure that the COMMAND_SEND_DATA cannot be sent to erase the boot
+    // loader before the application is erased.
+    //
+    g_ui32TransferAddress = 0xffffffff;
+
+    //
+    // Set up the timer used to discard partially received packets.
+    //
+    BLTimerInit(g_ui32SysClock);
+
+#ifdef FLASH_JOURNAL_ADDRESS
+    //
+    // The progress journal keeps a CRC32 of the data programmed.
+    //
+    InitCRC32Table();
+#endif
+
+    //
+    // Read any data from the serial port in use.
+    //
+    while(1)
+    {
+        //
+        // Receive a packet from the port in use.  A damaged or incomplete
+        // packet is dropped without a response so that the host retransmits
+        // it.
+        //
+        if(ReceivePacket(&rxbuff) != 0)
+        {
+            continue;
+        }
+#ifdef BL_WATCHDOG_TIMEOUT
+        //
+        // A packet received intact shows that the host is still there.
+        //
+        WatchdogFeed();
+#endif
+        //
+        // The first byte of the data buffer has the command and determines
+        // the format of the rest of the bytes.
+        //
+        switch(rxbuff.ADDRESS.Address)
+        {
+            //
+            // This was a simple ping command.
+            //
+            case 0x6001:
+            {
+                //
+                // This command always sets the status to COMMAND_RET_SUCCESS.
+                //
+              //  g_ui8Status = COMMAND_RET_SUCCESS;
+
+                //
+                // Just acknowledge that the command was received.
+                //
+                APP_PingACK();
 
                 //
                 // Go back and wait for a new command.
@@ -549,6 +1202,11 @@ Updater(void)
 
                     g_ui32TransferAddress = Program_Address.g_pui32DataBuffer;
                     g_ui32TransferSize = Program_Size.g_pui32DataSize;
+                    g_ui32NextBlock = 0;
+                    g_bLastBlock = false;
+#ifdef ENABLE_MANIFEST_UPDATE
+                    g_ui32ManifestRegions = 0;
+#endif
                     // Check for a valid starting address and image size.
                     if(!BL_FLASH_AD_CHECK_FN_HOOK(g_ui32TransferAddress,
                                                   g_ui32TransferSize))
@@ -561,17 +1219,28 @@ Updater(void)
                         // This packet has been handled.
                         break;
                     }
-                    ui32FlashSize = g_ui32TransferAddress + g_ui32TransferSize;
+#ifdef BL_UPDATE_STAGED
+                    // A new boot loader is staged in the application region.
+                    StageAddress(false);
+#endif
                     // Clear the flash access interrupt.
                     BL_FLASH_CL_ERR_FN_HOOK();
+#ifdef FLASH_JOURNAL_ADDRESS
+                    // Forget any earlier download before erasing its image.
+                    JournalErase();
+#endif
                         // Leave the boot loader present until we start getting an
                         // image.
-                    for(ui32Temp = g_ui32TransferAddress;
-                        ui32Temp < ui32FlashSize; ui32Temp += FLASH_PAGE_SIZE)
+                    DownloadErase(g_ui32TransferAddress, g_ui32TransferSize);
+#if defined(BL_UPDATE_STAGED) && defined(FLASH_WEAR_EEPROM_ADDRESS)
+                    // A new boot loader staged further up still leaves no
+                    // application to run.
+                    if(g_ui32StageSize &&
+                       (g_ui32TransferAddress != APP_START_ADDRESS))
                     {
-                        // Erase this block.
-                        BL_FLASH_ERASE_FN_HOOK(ui32Temp);
+                        DownloadErase(APP_START_ADDRESS, 4);
                     }
+#endif
                     // Return an error if an access violation occurred.
                     if(BL_FLASH_ERROR_FN_HOOK())
                     {
@@ -582,6 +1251,19 @@ Updater(void)
                     {
                         g_ui32TransferSize = 0;
                     }
+#ifdef FLASH_JOURNAL_ADDRESS
+                    else
+                    {
+                        // The image is erased so the download can be resumed
+                        // from here on.
+                        JournalStart(g_ui32TransferAddress,
+                                     g_ui32TransferSize);
+                    }
+#endif
+#ifdef IMAGE_DIGEST
+                    // Start the digest of the image being downloaded.
+                    SHA256Init(&g_sImageDigest);
+#endif
 
                     APP_ADDACK();
                     // Go back and wait for a new command.
@@ -589,16 +1271,12 @@ Updater(void)
                 }
                 else if(rxbuff.CMD == 0x03){
                     //
-                    // Acknowledge that this command was received correctly.  This
-                    // does not indicate success, just that the command was
-                    // received.
-                    //
-
-                    uint8_t ReadStatus[8] ={0x21,0x03,0x00,0x06,0x40,0x00,0x11,0x22};
-                    //
-                    // Return the status to the updater.
+                    // Return the status of the last command to the updater,
+                    // along with the counters that show how the transfer is
+                    // going.  This may be read at any time, including part
+                    // way through a transfer.
                     //
-                    SendData(ReadStatus, 8);
+                    StatusPacket(g_ui8Status);
 
                     //
                     // Go back and wait for a new command.
@@ -669,6 +1347,16 @@ Updater(void)
                 HWREG(SYSCTL_SRSSI) = SSI_CLOCK_ENABLE;
                 HWREG(SYSCTL_SRSSI) = 0;
 #endif
+#ifdef BL_WATCHDOG_TIMEOUT
+                HWREG(SYSCTL_SRWD) = SYSCTL_SRWD_R0;
+                HWREG(SYSCTL_SRWD) = 0;
+                HWREG(SYSCTL_RCGCWD) &= ~SYSCTL_RCGCWD_R0;
+#endif
+
+                //
+                // Stop SysTick, which times the flash operations.
+                //
+                HWREG(NVIC_ST_CTRL) = 0;
 
                 //
                 // Branch to the specified address.  This should never return.
@@ -695,16 +1383,434 @@ Updater(void)
                 }
             }
 
+            //
+            // This command polls the progress of the download, returning the
+            // status of the last command and the next data block expected.
+            //
+            case 0x6005:
+            {
+                ProgressPacket(g_ui8Status, g_ui32NextBlock);
+
+                //
+                // Go back and wait for a new command.
+                //
+                break;
+            }
+
+#ifdef IMAGE_DIGEST
+            //
+            // This command reads the SHA-256 digest of the image downloaded
+            // so far, so that the host can check what was programmed.
+            //
+            case 0x6004:
+            {
+                tSHA256Context sDigest;
+                uint8_t pui8Digest[SHA256_DIGEST_SIZE];
+
+                //
+                // Complete a copy of the digest so that the download can
+                // carry on adding to it.
+                //
+                sDigest = g_sImageDigest;
+                SHA256Final(&sDigest, pui8Digest);
+                DigestPacket(0x04, g_ui8Status, pui8Digest);
+
+                //
+                // Go back and wait for a new command.
+                //
+                break;
+            }
+#endif
+
+            //
+            // This command skips a run of data blocks that are entirely
+            // erased (0xFF) in the image.  The download command has already
+            // erased them, so they are left unprogrammed and the transfer
+            // moves on to the block given.  The first block of the run is
+            // given too, so that the command is ignored, like an out of
+            // sequence 0x6007 block, if a block before the run was missed.
+            //
+            case 0x6008:
+            {
+                ui32Temp = (((uint32_t)rxbuff.packetData[2] << 8) |
+                            rxbuff.packetData[3]);
+                if((g_ui32TransferSize != 0) &&
+                   ((((uint32_t)rxbuff.packetData[0] << 8) |
+                     rxbuff.packetData[1]) == (g_ui32NextBlock & 0xffff)) &&
+                   (ui32Temp > (g_ui32NextBlock & 0xffff)))
+                {
+                    ui32Temp -= g_ui32NextBlock & 0xffff;
+                    g_ui32NextBlock += ui32Temp;
+                    ui32Temp *= PACKET_DATA_SIZE;
+#ifdef DECRYPT_AES_MODE
+                    DecryptSkip(ui32Temp);
+#endif
+#ifdef IMAGE_DIGEST
+                    SHA256UpdateFlash(&g_sImageDigest, g_ui32TransferAddress,
+                                      ((g_ui32TransferSize > ui32Temp) ?
+                                       ui32Temp : g_ui32TransferSize));
+#endif
+                    g_ui32TransferAddress += ui32Temp;
+                    g_ui32TransferSize -= ((g_ui32TransferSize > ui32Temp) ?
+                                           ui32Temp : g_ui32TransferSize);
+#ifdef FLASH_JOURNAL_ADDRESS
+                    JournalData(0, ui32Temp);
+#endif
+#ifdef ENABLE_MANIFEST_UPDATE
+                    if((g_ui32TransferSize == 0) && g_ui32ManifestRegions)
+                    {
+                        ManifestNext();
+                    }
+#endif
+#ifdef META_EEPROM_ADDRESS
+                    if(g_ui32TransferSize == 0)
+                    {
+                        DownloadCount();
+                    }
+#endif
+                }
+                else if(g_ui32TransferSize != 0)
+                {
+                    g_pui32Stats[STAT_RETRANSMITS]++;
+                }
+                ProgressPacket(g_ui8Status, g_ui32NextBlock);
+
+                //
+                // Go back and wait for a new command.
+                //
+                break;
+            }
+
+#ifdef FLASH_JOURNAL_ADDRESS
+            //
+            // This command resumes the download that its parameters, given in
+            // the same form as for the download command, describe.  If the
+            // progress journal holds that download the transfer carries on
+            // from the last point committed to it, without erasing anything,
+            // and the reply gives the next block expected and the CRC32 of
+            // the image up to it.  Otherwise the command fails and the host
+            // must start the download again.
+            //
+            case 0x6009:
+            {
+                uint32_t ui32CRC;
+
+                g_ui8Status = COMMAND_RET_SUCCESS;
+                Program_Address.ADD_L.add_H = rxbuff.packetData[2];
+                Program_Address.ADD_L.add_L = rxbuff.packetData[3];
+                Program_Address.ADD_H.add_H = rxbuff.packetData[4];
+                Program_Address.ADD_H.add_L = rxbuff.packetData[5];
+                Program_Size.Size_L.size_H = rxbuff.packetData[7];
+                Program_Size.Size_L.size_L = rxbuff.packetData[8];
+                Program_Size.Size_H.size_H = rxbuff.packetData[9];
+                Program_Size.Size_H.size_L = rxbuff.packetData[10];
+
+                g_ui32TransferAddress = Program_Address.g_pui32DataBuffer;
+                g_ui32TransferSize = Program_Size.g_pui32DataSize;
+                g_ui32NextBlock = 0;
+                g_bLastBlock = false;
+#ifdef ENABLE_MANIFEST_UPDATE
+                g_ui32ManifestRegions = 0;
+#endif
+                ui32Temp = BL_FLASH_AD_CHECK_FN_HOOK(g_ui32TransferAddress,
+                                                     g_ui32TransferSize);
+#ifdef BL_UPDATE_STAGED
+                StageAddress(true);
+#endif
+                if(!ui32Temp ||
+                   !JournalResume(g_ui32TransferAddress, g_ui32TransferSize,
+                                  &ui32Temp, &ui32CRC))
+                {
+                    g_ui8Status = COMMAND_RET_INVALID_ADR;
+                    g_ui32TransferSize = 0;
+                    ui32CRC = 0;
+                }
+                else
+                {
+#ifdef IMAGE_DIGEST
+                    // Digest the part of the image that is already there.
+                    SHA256Init(&g_sImageDigest);
+                    SHA256UpdateFlash(&g_sImageDigest, g_ui32TransferAddress,
+                                      ((g_ui32TransferSize > ui32Temp) ?
+                                       ui32Temp : g_ui32TransferSize));
+#endif
+                    g_ui32TransferAddress += ui32Temp;
+                    g_ui32TransferSize -= ((g_ui32TransferSize > ui32Temp) ?
+                                           ui32Temp : g_ui32TransferSize);
+                    g_ui32NextBlock = ui32Temp / PACKET_DATA_SIZE;
+                }
+                ResumePacket(g_ui8Status, g_ui32NextBlock, ui32CRC);
+
+                //
+                // Go back and wait for a new command.
+                //
+                break;
+            }
+#endif
+
+#ifdef DECRYPT_AES_MODE
+            //
+            // This command sets the counter block or IV from which the data
+            // blocks that follow are decrypted.  The host sends it after the
+            // download command and after a resume command.
+            //
+            case 0x600A:
+            {
+                if(rxbuff.CMD == 0x10)
+                {
+                    DecryptStart(rxbuff.packetData);
+                }
+                AckPacket();
+
+                //
+                // Go back and wait for a new command.
+                //
+                break;
+            }
+#endif
+
+#ifdef BL_UPDATE_STAGED
+            //
+            // This command installs the new boot loader staged by a download
+            // to address 0.  The digest given must match the staged copy, as
+            // read back from flash, and the copy must start with a vector
+            // table that resets into it with the stack in SRAM.  The reply is
+            // sent before the copy starts, since the boot loader resets once
+            // it is done.
+            //
+            case 0x600B:
+            {
+                tSHA256Context sDigest;
+                uint8_t pui8Digest[SHA256_DIGEST_SIZE];
+
+                g_ui8Status = COMMAND_RET_INVALID_CMD;
+                for(ui32Temp = 0; ui32Temp < SHA256_DIGEST_SIZE; ui32Temp++)
+                {
+                    pui8Digest[ui32Temp] = 0;
+                }
+                if((rxbuff.CMD == 0x10) && (g_ui32StageSize != 0) &&
+                   (g_ui32TransferSize == 0))
+                {
+                    SHA256Init(&sDigest);
+                    SHA256UpdateFlash(&sDigest, g_ui32StageAddress,
+                                      g_ui32StageSize);
+                    SHA256Final(&sDigest, pui8Digest);
+
+                    g_ui8Status = COMMAND_RET_SUCCESS;
+                    for(ui32Temp = 0; ui32Temp < SHA256_DIGEST_SIZE;
+                        ui32Temp++)
+                    {
+                        if(pui8Digest[ui32Temp] != rxbuff.packetData[ui32Temp])
+                        {
+                            g_ui8Status = COMMAND_RET_CRC_FAIL;
+                        }
+                    }
+                    ui32Temp = HWREG(g_ui32StageAddress + 4);
+                    if(((HWREG(g_ui32StageAddress) & 0xfff00000) !=
+                        0x20000000) ||
+                       ((ui32Temp & 1) == 0) || (ui32Temp >= g_ui32StageSize))
+                    {
+                        g_ui8Status = COMMAND_RET_CRC_FAIL;
+                    }
+                }
+                DigestPacket(0x0B, g_ui8Status, pui8Digest);
+                if(g_ui8Status != COMMAND_RET_SUCCESS)
+                {
+                    break;
+                }
+
+                //
+                // Make sure that the reply has been sent, then replace the
+                // boot loader and reset into the new one.
+                //
+                FlushData();
+                HWREG(NVIC_ST_CTRL) = 0;
+                BLInternalFlashStagedCopy(g_ui32StageAddress, g_ui32StageSize);
+                HWREG(NVIC_APINT) = (NVIC_APINT_VECTKEY |
+                                     NVIC_APINT_SYSRESETREQ);
+                while(1)
+                {
+                }
+            }
+#endif
+
+#ifdef ENABLE_MANIFEST_UPDATE
+            //
+            // This command starts a manifest session, which downloads each
+            // of the regions that it lists in turn as one stream of data
+            // blocks.  It takes the place of the download command.
+            //
+            case 0x600C:
+            {
+                g_ui8Status = COMMAND_RET_INVALID_CMD;
+                g_ui32TransferSize = 0;
+                g_ui32NextBlock = 0;
+                g_bLastBlock = false;
+                if(rxbuff.CMD == 0x10)
+                {
+                    g_ui8Status = ManifestStart(rxbuff.packetData);
+                }
+
+                //
+                // Start the digest of the data being downloaded.
+                //
+                SHA256Init(&g_sImageDigest);
+                ProgressPacket(g_ui8Status, g_ui32NextBlock);
+
+                //
+                // Go back and wait for a new command.
+                //
+                break;
+            }
+#endif
+
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+            //
+            // This command reads the erase counters of a run of flash blocks,
+            // so that the host can see how worn the flash is getting.
+            //
+            case 0x600D:
+            {
+                WearPacket(g_ui8Status, (rxbuff.packetData[0] << 8) |
+                                        rxbuff.packetData[1]);
+
+                //
+                // Go back and wait for a new command.
+                //
+                break;
+            }
+#endif
+
+#ifdef ENABLE_FLASH_DUMP
+            //
+            // This command reads a region of flash back, streaming it to the
+            // host in frames sent one after the other.  It does not change
+            // the status of the last command.
+            //
+            case 0x600E:
+            {
+                uint32_t ui32Address;
+#ifndef FLASH_CODE_PROTECTION
+                uint32_t ui32Size, ui32Length;
+#endif
+
+                ui32Address = ((rxbuff.packetData[0] << 24) |
+                               (rxbuff.packetData[1] << 16) |
+                               (rxbuff.packetData[2] << 8) |
+                               rxbuff.packetData[3]);
+#ifdef FLASH_CODE_PROTECTION
+                //
+                // The flash contents are not to leave the part.
+                //
+                DumpPacket(COMMAND_RET_INVALID_CMD, ui32Address, 0, true);
+#else
+                ui32Size = ((rxbuff.packetData[4] << 24) |
+                            (rxbuff.packetData[5] << 16) |
+                            (rxbuff.packetData[6] << 8) |
+                            rxbuff.packetData[7]);
+                if(!BLInternalFlashReadCheck(ui32Address, ui32Size))
+                {
+                    DumpPacket(COMMAND_RET_INVALID_ADR, ui32Address, 0, true);
+                    break;
+                }
+                while(ui32Size)
+                {
+                    ui32Length = ((ui32Size > DUMP_FRAME_SIZE) ?
+                                  DUMP_FRAME_SIZE : ui32Size);
+                    DumpPacket(COMMAND_RET_SUCCESS, ui32Address, ui32Length,
+                               ui32Length == ui32Size);
+                    ui32Address += ui32Length;
+                    ui32Size -= ui32Length;
+#ifdef BL_WATCHDOG_TIMEOUT
+                    WatchdogFeed();
+#endif
+                }
+#endif
+
+                //
+                // Go back and wait for a new command.
+                //
+                break;
+            }
+#endif
+
+            //
+            // This command transfers data like 0x6006 but is followed by the
+            // number of the block, so that it can be broadcast to every node
+            // on the bus.  A node that missed a block ignores every block
+            // after it until the host, having polled the node's progress,
+            // resends the missing block to it.
+            //
+            case 0x6007:
+            {
+                if((g_ui32TransferSize == 0) ||
+                   ((((uint32_t)rxbuff.packetData[PACKET_DATA_SIZE] << 8) |
+                     rxbuff.packetData[PACKET_DATA_SIZE + 1]) !=
+                    (g_ui32NextBlock & 0xffff)))
+                {
+                    if(g_ui32TransferSize != 0)
+                    {
+                        g_pui32Stats[STAT_RETRANSMITS]++;
+                    }
+                    ProgressPacket(g_ui8Status, g_ui32NextBlock);
+                    break;
+                }
+
+                //
+                // The block is the next one expected so program it.
+                //
+            }
+
+            //
+            // Fall through.
+            //
+
             //
             // This command is sent to transfer data to the device following
-            // a download command.
+            // a download command.  It carries no block number, so a block
+            // that the host sends again after losing the ACK to it cannot be
+            // told from the next one; hosts should send 0x6007 instead.
             //
             case 0x6006:
             {
+                uint8_t *pui8Data;
+
+                //
+                // Once the whole image has been received, a block can only
+                // be one sent again.  If it is the last block and no block
+                // was moved up by a repeat, the image is intact, so
+                // acknowledge it without programming it.  Otherwise an
+                // earlier block was programmed twice, so refuse the image and
+                // erase the start of it so that it cannot be run.
+                //
+                if(g_ui32TransferSize == 0)
+                {
+                    if(!g_bLastBlock ||
+                       (BlockSame(rxbuff.packetData) && !g_bRepeatShifted))
+                    {
+                        g_pui32Stats[STAT_RETRANSMITS]++;
+                        AckPacket();
+                        break;
+                    }
+                    if(g_ui8Status != COMMAND_RET_INVALID_ADR)
+                    {
+                        g_ui8Status = COMMAND_RET_INVALID_ADR;
+                        BL_FLASH_CL_ERR_FN_HOOK();
+#ifdef FLASH_JOURNAL_ADDRESS
+                        JournalErase();
+#endif
+                        DownloadErase(g_ui32DataStart, 4);
+                    }
+                    RefusePacket(g_ui8Status);
+                    break;
+                }
+
+                //
                 // Until determined otherwise, the command status is success.
                 //
                 g_ui8Status = COMMAND_RET_SUCCESS;
 
+#ifndef BL_UPDATE_STAGED
                 //
                 // If this is overwriting the boot loader then the application
                 // has already been erased so now erase the boot loader.
@@ -720,12 +1826,15 @@ Updater(void)
                     // Erase the boot loader.
                     //
                     for(ui32Temp = 0; ui32Temp < APP_START_ADDRESS;
-                        ui32Temp += FLASH_PAGE_SIZE)
+                        ui32Temp += BL_FLASH_ERASE_SIZE)
                     {
                         //
                         // Erase this block.
                         //
+                        ui32Stamp = BLTimerStamp();
                         BL_FLASH_ERASE_FN_HOOK(ui32Temp);
+                        g_pui32Stats[STAT_ERASE_TIME] +=
+                            BLTimerElapsed(ui32Stamp);
                     }
 
                     //
@@ -745,10 +1854,39 @@ Updater(void)
                         g_ui8Status = COMMAND_RET_FLASH_FAIL;
                     }
                 }
+#endif
 
-                BL_FLASH_PROGRAM_FN_HOOK(g_ui32TransferAddress,
-                                         (uint8_t *) &rxbuff.packetData[0],
-                                         128);
+                pui8Data = (uint8_t *) &rxbuff.packetData[0];
+#ifdef BL_DECRYPT_FN_HOOK
+                //
+                // Decrypt a copy of the block, which is what is programmed,
+                // leaving the block as received to compare the next with.
+                //
+                for(ui32Temp = 0; ui32Temp < PACKET_DATA_SIZE; ui32Temp++)
+                {
+                    ((uint8_t *)g_pui32DecryptBlock)[ui32Temp] =
+                        rxbuff.packetData[ui32Temp];
+                }
+                pui8Data = (uint8_t *)g_pui32DecryptBlock;
+                BL_DECRYPT_FN_HOOK(pui8Data, PACKET_DATA_SIZE);
+#endif
+#ifdef DECRYPT_AES_MODE
+                //
+                // Have the key stream for the next block generated while
+                // this one is programmed.
+                //
+                DecryptPrefetch();
+#endif
+
+                //
+                // Clear the flash access interrupt, so that an error is this
+                // block's and a block sent again after one can program.
+                //
+                BL_FLASH_CL_ERR_FN_HOOK();
+                ui32Stamp = BLTimerStamp();
+                BL_FLASH_PROGRAM_FN_HOOK(g_ui32TransferAddress, pui8Data,
+                                         PACKET_DATA_SIZE);
+                g_pui32Stats[STAT_PROGRAM_TIME] += BLTimerElapsed(ui32Stamp);
                 //
                 // Return an error if an access violation occurred.
                 //
@@ -758,17 +1896,63 @@ Updater(void)
                     // Indicate that the flash programming failed.
                     //
                     g_ui8Status = COMMAND_RET_FLASH_FAIL;
+#ifdef DECRYPT_AES_MODE
+                    //
+                    // Go back to decrypting this block, in case the host
+                    // sends it again.
+                    //
+                    DecryptRewind();
+#endif
                 }
                 else
                 {
+#ifdef DECRYPT_AES_MODE
+                    DecryptCommit();
+#endif
+                    BlockRecord(rxbuff.packetData);
+
                     //
-                    // Now update the address to program.
+                    // Now update the address to program.  The last block may
+                    // be padded past the end of the image.
                     //
-                    g_ui32TransferSize -= 128;
-                    g_ui32TransferAddress += 128;
-
+                    ui32Temp = ((g_ui32TransferSize > PACKET_DATA_SIZE) ?
+                                PACKET_DATA_SIZE : g_ui32TransferSize);
+#ifdef IMAGE_DIGEST
+                    SHA256UpdateFlash(&g_sImageDigest, g_ui32TransferAddress,
+                                      ui32Temp);
+#endif
+                    g_ui32TransferSize -= ui32Temp;
+                    g_ui32TransferAddress += PACKET_DATA_SIZE;
+                    g_ui32NextBlock++;
+                    g_pui32Stats[STAT_PROGRAMMED] += PACKET_DATA_SIZE;
+#ifdef FLASH_JOURNAL_ADDRESS
+                    JournalData(pui8Data, PACKET_DATA_SIZE);
+#endif
+#ifdef ENABLE_MANIFEST_UPDATE
+                    //
+                    // Move on to the next region of a manifest session, or
+                    // check them all after the last.
+                    //
+                    if((g_ui32TransferSize == 0) && g_ui32ManifestRegions)
+                    {
+                        ManifestNext();
+                    }
+#endif
+#ifdef META_EEPROM_ADDRESS
+                    if(g_ui32TransferSize == 0)
+                    {
+                        DownloadCount();
+                    }
+#endif
+                }
+                if(rxbuff.ADDRESS.Address == 0x6007)
+                {
+                    ProgressPacket(g_ui8Status, g_ui32NextBlock);
+                }
+                else
+                {
+                    AckPacket();
                 }
-                AckPacket();
                 break;
             }
 
@@ -0,0 +1,451 @@
+//*****************************************************************************
+//
+// bl_meta.c - A small key/value store in the EEPROM.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_types.h"
+#include "bl_config.h"
+#include "boot_loader/bl_crc32.h"
+#include "boot_loader/bl_flash.h"
+#include "boot_loader/bl_meta.h"
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+#include "boot_loader/bl_wear.h"
+#endif
+#include "driverlib/eeprom.h"
+#include "driverlib/sysctl.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_meta_api
+//! @{
+//
+//*****************************************************************************
+#if defined(META_EEPROM_ADDRESS) || defined(DOXYGEN)
+
+//*****************************************************************************
+//
+// Make sure that the store is made of two halves of whole words, each with
+// room for at least one of every key, and that it does not share the EEPROM
+// with the erase counters.
+//
+//*****************************************************************************
+#ifndef META_EEPROM_SIZE
+#error ERROR: META_EEPROM_SIZE must be defined with META_EEPROM_ADDRESS!
+#endif
+#if (META_EEPROM_ADDRESS & 3) || (META_EEPROM_SIZE & 7)
+#error ERROR: META_EEPROM_ADDRESS and META_EEPROM_SIZE must be word aligned!
+#endif
+#if (META_EEPROM_SIZE / 2) < (META_NUM_KEYS * 4 * (META_MAX_WORDS + 1))
+#error ERROR: META_EEPROM_SIZE is too small for every key!
+#endif
+#if defined(FLASH_WEAR_EEPROM_ADDRESS) &&                                    \
+    ((META_EEPROM_ADDRESS + META_EEPROM_SIZE) > FLASH_WEAR_EEPROM_ADDRESS) && \
+    (META_EEPROM_ADDRESS < (FLASH_WEAR_EEPROM_ADDRESS + WEAR_EEPROM_SIZE))
+#error ERROR: META_EEPROM_ADDRESS overlaps the flash erase counters!
+#endif
+
+//*****************************************************************************
+//
+// The size of each half of the store, and the start of a half.
+//
+//*****************************************************************************
+#define META_HALF_SIZE          (META_EEPROM_SIZE / 2)
+#define META_HALF(h)            (META_EEPROM_ADDRESS + ((h) * META_HALF_SIZE))
+
+//*****************************************************************************
+//
+// The EEPROM address of the latest record of each key, or META_NO_RECORD if
+// the key has none.  This is built once by MetaInit() so that a lookup never
+// has to search the store.
+//
+//*****************************************************************************
+#define META_NO_RECORD          0xffff
+static uint16_t g_pui16MetaIndex[META_NUM_KEYS];
+
+//*****************************************************************************
+//
+// The half of the store in use, its generation and the address at which the
+// next record is written.
+//
+//*****************************************************************************
+static uint32_t g_ui32MetaHalf;
+static uint32_t g_ui32MetaGen;
+static uint32_t g_ui32MetaTail;
+
+//*****************************************************************************
+//
+// Whether MetaInit() has been called, and whether the EEPROM could be
+// started.
+//
+//*****************************************************************************
+static bool g_bMetaStarted;
+static bool g_bMetaReady;
+
+//*****************************************************************************
+//
+// Returns the header of a record of the given key and value in the given
+// generation.
+//
+//*****************************************************************************
+static uint32_t
+MetaHeader(uint32_t ui32Key, uint32_t ui32Gen, const uint32_t *pui32Value,
+           uint32_t ui32Words)
+{
+    uint32_t ui32Header, ui32CRC;
+
+    ui32Header = ((ui32Key << META_HDR_KEY_S) | (ui32Gen << META_HDR_GEN_S) |
+                  ((ui32Words - 1) << META_HDR_LEN_S));
+    ui32CRC = CalculateCRC32((uint8_t *)&ui32Header, 4, 0xffffffff);
+    ui32CRC = CalculateCRC32((uint8_t *)pui32Value, ui32Words * 4, ui32CRC);
+
+    return(ui32Header | ((ui32CRC ^ (ui32CRC >> 16)) & META_HDR_CHECK_M));
+}
+
+//*****************************************************************************
+//
+// Reads the record at the given address, which must end by the given
+// address, into pui32Record (the header followed by the value).  Returns the
+// number of words in the value, or 0 if there is no valid record there.
+//
+//*****************************************************************************
+static uint32_t
+MetaRead(uint32_t ui32Address, uint32_t ui32End, uint32_t *pui32Record)
+{
+    uint32_t ui32Words;
+
+    if((ui32Address + 8) > ui32End)
+    {
+        return(0);
+    }
+    EEPROMRead(pui32Record, ui32Address, 4);
+    ui32Words = ((pui32Record[0] >> META_HDR_LEN_S) & META_HDR_LEN_M) + 1;
+    if(((pui32Record[0] >> META_HDR_KEY_S) >= META_NUM_KEYS) ||
+       ((ui32Address + (4 * (ui32Words + 1))) > ui32End))
+    {
+        return(0);
+    }
+    EEPROMRead(pui32Record + 1, ui32Address + 4, ui32Words * 4);
+    if(MetaHeader(pui32Record[0] >> META_HDR_KEY_S,
+                  (pui32Record[0] >> META_HDR_GEN_S) & META_HDR_GEN_M,
+                  pui32Record + 1, ui32Words) != pui32Record[0])
+    {
+        return(0);
+    }
+
+    return(ui32Words);
+}
+
+//*****************************************************************************
+//
+// Indexes the half of the store in use, up to the first record that is not
+// valid or is left from an earlier generation, which is where the next
+// record is written.
+//
+//*****************************************************************************
+static void
+MetaScan(void)
+{
+    uint32_t pui32Record[META_MAX_WORDS + 1];
+    uint32_t ui32Key, ui32Words, ui32End;
+
+    for(ui32Key = 0; ui32Key < META_NUM_KEYS; ui32Key++)
+    {
+        g_pui16MetaIndex[ui32Key] = META_NO_RECORD;
+    }
+
+    g_ui32MetaTail = META_HALF(g_ui32MetaHalf);
+    ui32End = g_ui32MetaTail + META_HALF_SIZE;
+    while(((ui32Words = MetaRead(g_ui32MetaTail, ui32End, pui32Record)) !=
+           0) &&
+          (((pui32Record[0] >> META_HDR_GEN_S) & META_HDR_GEN_M) ==
+           g_ui32MetaGen))
+    {
+        g_pui16MetaIndex[pui32Record[0] >> META_HDR_KEY_S] = g_ui32MetaTail;
+        g_ui32MetaTail += 4 * (ui32Words + 1);
+    }
+}
+
+//*****************************************************************************
+//
+//! Finds the records in the store.
+//!
+//! This function starts the EEPROM and the CRC32 table used to check
+//! records, and builds the index of the latest record of every key.  The
+//! store is split into two halves, and records are only ever appended to the
+//! half in use.  Once it is full, the latest record of every key is copied
+//! into the other half, with the header of the first copied last, so that
+//! the other half only takes over once it is complete.  The half in use is
+//! the one whose first record is valid and of the later generation.
+//!
+//! It is called by the first MetaGet() or MetaSet(), so need not be called
+//! at all, but may be called again to rebuild the index from the EEPROM.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+MetaInit(void)
+{
+    uint32_t pui32Record[META_MAX_WORDS + 1];
+    uint32_t ui32Gen0, ui32Gen1;
+    bool bValid0, bValid1;
+
+    if(!g_bMetaStarted)
+    {
+        g_bMetaStarted = true;
+        InitCRC32Table();
+        SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
+        g_bMetaReady = (EEPROMInit() == EEPROM_INIT_OK);
+    }
+    if(!g_bMetaReady)
+    {
+        return;
+    }
+
+    //
+    // Find the generation of each half from its first record.
+    //
+    bValid0 = (MetaRead(META_HALF(0), META_HALF(1), pui32Record) != 0);
+    ui32Gen0 = (pui32Record[0] >> META_HDR_GEN_S) & META_HDR_GEN_M;
+    bValid1 = (MetaRead(META_HALF(1), META_HALF(2), pui32Record) != 0);
+    ui32Gen1 = (pui32Record[0] >> META_HDR_GEN_S) & META_HDR_GEN_M;
+
+    //
+    // Use the later of the two, or start the first half if neither has been
+    // written.
+    //
+    g_ui32MetaHalf = 0;
+    g_ui32MetaGen = bValid0 ? ui32Gen0 : 0;
+    if(bValid1 &&
+       (!bValid0 || (((ui32Gen1 - ui32Gen0) & META_HDR_GEN_M) == 1)))
+    {
+        g_ui32MetaHalf = 1;
+        g_ui32MetaGen = ui32Gen1;
+    }
+    MetaScan();
+}
+
+//*****************************************************************************
+//
+//! Reads a value from the store.
+//!
+//! \param ui32Key is the key of the value.
+//! \param pui32Value is where the value is returned.
+//! \param ui32Words is the most words of the value to return.
+//!
+//! \return Returns the number of words in the value, which may be more than
+//! \e ui32Words, or 0 if the key has no value.
+//
+//*****************************************************************************
+uint32_t
+MetaGet(uint32_t ui32Key, uint32_t *pui32Value, uint32_t ui32Words)
+{
+    uint32_t pui32Record[META_MAX_WORDS + 1];
+    uint32_t ui32Idx, ui32Length;
+
+    if(!g_bMetaStarted)
+    {
+        MetaInit();
+    }
+    if(!g_bMetaReady || (ui32Key >= META_NUM_KEYS) ||
+       (g_pui16MetaIndex[ui32Key] == META_NO_RECORD))
+    {
+        return(0);
+    }
+
+    ui32Length = MetaRead(g_pui16MetaIndex[ui32Key],
+                          META_HALF(g_ui32MetaHalf) + META_HALF_SIZE,
+                          pui32Record);
+    for(ui32Idx = 0; (ui32Idx < ui32Length) && (ui32Idx < ui32Words);
+        ui32Idx++)
+    {
+        pui32Value[ui32Idx] = pui32Record[ui32Idx + 1];
+    }
+
+    return(ui32Length);
+}
+
+//*****************************************************************************
+//
+// Copies the latest record of every key other than the one being set into
+// the other half of the store, followed by the new record, and makes that
+// half the one in use.  Returns non-zero if it succeeded.
+//
+//*****************************************************************************
+static uint32_t
+MetaCompact(uint32_t *pui32New, uint32_t ui32Words)
+{
+    uint32_t pui32Record[META_MAX_WORDS + 1];
+    uint32_t ui32Key, ui32Gen, ui32Half, ui32Addr, ui32Length, ui32First;
+    uint32_t ui32Idx, ui32Status;
+
+    ui32Half = g_ui32MetaHalf ^ 1;
+    ui32Gen = (g_ui32MetaGen + 1) & META_HDR_GEN_M;
+    ui32Addr = META_HALF(ui32Half);
+    ui32First = 0;
+    ui32Status = 0;
+    for(ui32Key = 0; ui32Key <= META_NUM_KEYS; ui32Key++)
+    {
+        //
+        // Take each key's record from the half in use, and the new record
+        // last.
+        //
+        if(ui32Key == META_NUM_KEYS)
+        {
+            ui32Length = ui32Words;
+            for(ui32Idx = 0; ui32Idx <= ui32Words; ui32Idx++)
+            {
+                pui32Record[ui32Idx] = pui32New[ui32Idx];
+            }
+        }
+        else if((ui32Key == (pui32New[0] >> META_HDR_KEY_S)) ||
+                (g_pui16MetaIndex[ui32Key] == META_NO_RECORD) ||
+                !(ui32Length = MetaRead(g_pui16MetaIndex[ui32Key],
+                                        (META_HALF(g_ui32MetaHalf) +
+                                         META_HALF_SIZE), pui32Record)))
+        {
+            continue;
+        }
+        if((ui32Addr + (4 * (ui32Length + 1))) >
+           (META_HALF(ui32Half) + META_HALF_SIZE))
+        {
+            return(0);
+        }
+
+        //
+        // Write it with the new generation, leaving the header of the first
+        // record until everything else is in place.
+        //
+        pui32Record[0] = MetaHeader(pui32Record[0] >> META_HDR_KEY_S, ui32Gen,
+                                    pui32Record + 1, ui32Length);
+        if(ui32Addr == META_HALF(ui32Half))
+        {
+            ui32First = pui32Record[0];
+            ui32Status |= EEPROMProgram(pui32Record + 1, ui32Addr + 4,
+                                        ui32Length * 4);
+        }
+        else
+        {
+            ui32Status |= EEPROMProgram(pui32Record, ui32Addr,
+                                        (ui32Length + 1) * 4);
+        }
+        ui32Addr += 4 * (ui32Length + 1);
+    }
+
+    //
+    // The other half takes over once its first header is written.
+    //
+    ui32Status |= EEPROMProgram(&ui32First, META_HALF(ui32Half), 4);
+    if(ui32Status)
+    {
+        return(0);
+    }
+    g_ui32MetaHalf = ui32Half;
+    g_ui32MetaGen = ui32Gen;
+    MetaScan();
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+//! Writes a value to the store.
+//!
+//! \param ui32Key is the key of the value.
+//! \param pui32Value is the value.
+//! \param ui32Words is the number of words in the value, from 1 to
+//! \b META_MAX_WORDS.
+//!
+//! This function appends a record of the value to the store with a single
+//! write of the header and the value, unless the key already has this value,
+//! in which case nothing is written.  A record is only valid once all of it
+//! has been written, so losing power part way through leaves the key with
+//! its earlier value.
+//!
+//! \return Returns non-zero if the value was stored or 0 otherwise.
+//
+//*****************************************************************************
+uint32_t
+MetaSet(uint32_t ui32Key, const uint32_t *pui32Value, uint32_t ui32Words)
+{
+    uint32_t pui32Record[META_MAX_WORDS + 1];
+    uint32_t ui32Idx, ui32Same;
+
+    if(!g_bMetaStarted)
+    {
+        MetaInit();
+    }
+    if(!g_bMetaReady || (ui32Key >= META_NUM_KEYS) || (ui32Words == 0) ||
+       (ui32Words > META_MAX_WORDS))
+    {
+        return(0);
+    }
+
+    //
+    // Leave the store alone if the key already has this value.
+    //
+    ui32Same = (MetaGet(ui32Key, pui32Record + 1, META_MAX_WORDS) ==
+                ui32Words);
+    for(ui32Idx = 0; ui32Same && (ui32Idx < ui32Words); ui32Idx++)
+    {
+        ui32Same = (pui32Record[ui32Idx + 1] == pui32Value[ui32Idx]);
+    }
+    if(ui32Same)
+    {
+        return(1);
+    }
+
+    for(ui32Idx = 0; ui32Idx < ui32Words; ui32Idx++)
+    {
+        pui32Record[ui32Idx + 1] = pui32Value[ui32Idx];
+    }
+    pui32Record[0] = MetaHeader(ui32Key, g_ui32MetaGen, pui32Record + 1,
+                                ui32Words);
+
+    //
+    // Start on the other half if this one is full.
+    //
+    if((g_ui32MetaTail + (4 * (ui32Words + 1))) >
+       (META_HALF(g_ui32MetaHalf) + META_HALF_SIZE))
+    {
+        return(MetaCompact(pui32Record, ui32Words));
+    }
+
+    if(EEPROMProgram(pui32Record, g_ui32MetaTail, 4 * (ui32Words + 1)))
+    {
+        return(0);
+    }
+    g_pui16MetaIndex[ui32Key] = g_ui32MetaTail;
+    g_ui32MetaTail += 4 * (ui32Words + 1);
+
+    return(1);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+#endif
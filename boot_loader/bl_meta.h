@@ -0,0 +1,71 @@
+//*****************************************************************************
+//
+// bl_meta.h - Definitions for the boot loader's EEPROM key/value store.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_META_H__
+#define __BL_META_H__
+
+//*****************************************************************************
+//
+// The keys of the values that the boot loader keeps in the store.  Keys from
+// META_KEY_USER up to META_NUM_KEYS - 1 are free for an application to use.
+//
+//*****************************************************************************
+#define META_KEY_DOWNLOADS      0
+#define META_KEY_USER           8
+#define META_NUM_KEYS           16
+
+//*****************************************************************************
+//
+// The largest value that a key can hold, in words.
+//
+//*****************************************************************************
+#define META_MAX_WORDS          4
+
+//*****************************************************************************
+//
+// Each record is a header word followed by its value.  The header holds the
+// key, the generation of the half of the store that the record was written
+// to, the length of the value less one and a 16 bit check of the rest of the
+// header and the value.
+//
+//*****************************************************************************
+#define META_HDR_KEY_S          24
+#define META_HDR_GEN_S          18
+#define META_HDR_GEN_M          0x3f
+#define META_HDR_LEN_S          16
+#define META_HDR_LEN_M          0x3
+#define META_HDR_CHECK_M        0xffff
+
+//*****************************************************************************
+//
+// Key/value store APIs
+//
+//*****************************************************************************
+extern void MetaInit(void);
+extern uint32_t MetaGet(uint32_t ui32Key, uint32_t *pui32Value,
+                        uint32_t ui32Words);
+extern uint32_t MetaSet(uint32_t ui32Key, const uint32_t *pui32Value,
+                        uint32_t ui32Words);
+
+#endif // __BL_META_H__
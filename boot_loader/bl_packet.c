@@ -22,13 +22,19 @@
 //
 //*****************************************************************************
 
+#include <stdbool.h>
 #include <stdint.h>
+#include "inc/hw_types.h"
 #include "bl_config.h"
 #include "boot_loader/bl_commands.h"
 #include "boot_loader/bl_i2c.h"
 #include "boot_loader/bl_packet.h"
 #include "boot_loader/bl_ssi.h"
+#include "boot_loader/bl_transport.h"
 #include "boot_loader/bl_uart.h"
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+#include "boot_loader/bl_wear.h"
+#endif
 
 //*****************************************************************************
 //
@@ -44,8 +50,8 @@
 // The packet that is sent to acknowledge a received packet.
 //
 //*****************************************************************************
-static const uint8_t g_pui8ACK[8] = {0x21,0x10,0x60,0x06,0x00,0x40,0x11,0x22};
-static const uint8_t PingACK[9] =   {0x21,0x03,0x60,0x01,0x00,0x02,0xCC,0x11,0x22};
+static const uint8_t g_pui8ACK[8] = {PACKET_REPLY_ID,0x10,0x60,0x06,0x00,0x40,0x11,0x22};
+static const uint8_t PingACK[9] =   {PACKET_REPLY_ID,0x03,0x60,0x01,0x00,0x02,0xCC,0x11,0x22};
 
 
 //*****************************************************************************
@@ -55,6 +61,21 @@ static const uint8_t PingACK[9] =   {0x21,0x03,0x60,0x01,0x00,0x02,0xCC,0x11,0x2
 //*****************************************************************************
 static const uint8_t g_pui8NAK[2] = { 0, COMMAND_NAK };
 
+//*****************************************************************************
+//
+// Set when the last packet received was broadcast to every node on the bus,
+// in which case no response may be sent for it.
+//
+//*****************************************************************************
+static bool g_bBroadcast;
+
+//*****************************************************************************
+//
+// The counters returned by a status read, indexed by the STAT_* values.
+//
+//*****************************************************************************
+uint32_t g_pui32Stats[NUM_STATS];
+
 //*****************************************************************************
 //
 //! Calculates an 8-bit checksum
@@ -92,6 +113,30 @@ CheckSum(const uint8_t *pui8Data, uint32_t ui32Size)
     return(ui32CheckSum & 0xff);
 }
 
+//*****************************************************************************
+//
+//! Sends the response to the last packet received.
+//!
+//! \param pui8Data is the location of the response to be sent.
+//! \param ui32Size is the number of bytes in the response.
+//!
+//! This function sends a response unless the packet being responded to was
+//! broadcast.  Every node on the bus acts on a broadcast packet, so were they
+//! all to respond, the responses would collide on the bus.  The host instead
+//! polls each node for its progress once the broadcast is complete.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ReplyPacket(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    if(!g_bBroadcast)
+    {
+        SendData(pui8Data, ui32Size);
+    }
+}
+
 //*****************************************************************************
 //
 //! Sends an Acknowledge packet.
@@ -105,18 +150,338 @@ CheckSum(const uint8_t *pui8Data, uint32_t ui32Size)
 void
 AckPacket(void)
 {
-    SendData(g_pui8ACK, 8);
+    ReplyPacket(g_pui8ACK, 8);
+}
+
+//*****************************************************************************
+//
+//! Sends a packet refusing a data packet.
+//!
+//! \param ui8Status is the status of the command.
+//!
+//! This function answers a data (0x6006) packet that the boot loader refuses
+//! with the same packet as AckPacket(), so that the host reads it as the
+//! response to its data packet, but with \e ui8Status in place of
+//! \b COMMAND_RET_SUCCESS.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RefusePacket(uint8_t ui8Status)
+{
+    uint8_t pui8Refuse[8];
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+    {
+        pui8Refuse[ui32Idx] = g_pui8ACK[ui32Idx];
+    }
+    pui8Refuse[5] = ui8Status;
+
+    ReplyPacket(pui8Refuse, 8);
 }
 
 void APP_PingACK(void)
 {
-    SendData(PingACK, 9);
+    ReplyPacket(PingACK, 9);
 }
 
 void APP_ADDACK(void){
-    SendData(PingACK, 9);
+    ReplyPacket(PingACK, 9);
+}
+
+//*****************************************************************************
+//
+//! Fills in the CRC16 that ends a reply.
+//!
+//! \param pui8Reply is the reply, with room for the CRC16 at its end.
+//! \param ui32Size is the size of the reply in bytes, including the CRC16.
+//!
+//! This function ends a reply with the CRC16 of the rest of it, most
+//! significant byte first, as it ends a packet from the host, so that the
+//! host can tell a reply that was damaged on the way back.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+ReplyCRC(uint8_t *pui8Reply, uint32_t ui32Size)
+{
+    uint32_t ui32CRC;
+
+    ui32CRC = CalculateCRC16(pui8Reply, ui32Size - 2, 0xffff);
+    pui8Reply[ui32Size - 2] = (uint8_t)(ui32CRC >> 8);
+    pui8Reply[ui32Size - 1] = (uint8_t)ui32CRC;
+}
+
+//*****************************************************************************
+//
+//! Sends a progress report packet.
+//!
+//! \param ui8Status is the status of the last command.
+//! \param ui32Block is the number of the next data block expected.
+//!
+//! This function answers a progress poll (a read of register 0x6005) and
+//! every addressed sequenced data (0x6007) or skip (0x6008) packet.  It
+//! reports the status of the last command and the number of the next 128
+//! byte data block that the node expects, which tells the host whether the
+//! node missed any of the blocks broadcast since the last poll and, if so,
+//! which block to resend.  It ends with a CRC16, so that a damaged report is
+//! not taken for the node's progress.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ProgressPacket(uint8_t ui8Status, uint32_t ui32Block)
+{
+    uint8_t pui8Progress[9];
+
+    pui8Progress[0] = PACKET_REPLY_ID;
+    pui8Progress[1] = 0x03;
+    pui8Progress[2] = 0x04;
+    pui8Progress[3] = 0x00;
+    pui8Progress[4] = ui8Status;
+    pui8Progress[5] = (uint8_t)(ui32Block >> 8);
+    pui8Progress[6] = (uint8_t)ui32Block;
+    ReplyCRC(pui8Progress, 9);
+
+    ReplyPacket(pui8Progress, 9);
+}
+
+//*****************************************************************************
+//
+//! Sends the reply to a resume command.
+//!
+//! \param ui8Status is the status of the resume command.
+//! \param ui32Block is the number of the next data block expected.
+//! \param ui32CRC is the CRC32 of the image up to that block.
+//!
+//! This function answers a resume command (a write to register 0x6009).  It
+//! extends the progress report with the CRC32 recorded in the progress
+//! journal, which the host checks against the start of its own image before
+//! sending the rest of it.  Like the progress report, it ends with a CRC16,
+//! so that a damaged reply does not move the host to the wrong block.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ResumePacket(uint8_t ui8Status, uint32_t ui32Block, uint32_t ui32CRC)
+{
+    uint8_t pui8Resume[13];
+
+    pui8Resume[0] = PACKET_REPLY_ID;
+    pui8Resume[1] = 0x03;
+    pui8Resume[2] = 0x08;
+    pui8Resume[3] = 0x00;
+    pui8Resume[4] = ui8Status;
+    pui8Resume[5] = (uint8_t)(ui32Block >> 8);
+    pui8Resume[6] = (uint8_t)ui32Block;
+    pui8Resume[7] = (uint8_t)(ui32CRC >> 24);
+    pui8Resume[8] = (uint8_t)(ui32CRC >> 16);
+    pui8Resume[9] = (uint8_t)(ui32CRC >> 8);
+    pui8Resume[10] = (uint8_t)ui32CRC;
+    ReplyCRC(pui8Resume, 13);
+
+    ReplyPacket(pui8Resume, 13);
+}
+
+//*****************************************************************************
+//
+//! Sends the reply to a status read.
+//!
+//! \param ui8Status is the status of the last command.
+//!
+//! This function answers a read of register 0x6003 with the status of the
+//! last command followed by the counters in \b g_pui32Stats, in the format
+//! described in bl_commands.h.  It may be sent at any time, including part
+//! way through a transfer.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+StatusPacket(uint8_t ui8Status)
+{
+    uint8_t pui8Status[6 + (4 * NUM_STATS) + 2];
+    uint32_t ui32Idx;
+
+    pui8Status[0] = PACKET_REPLY_ID;
+    pui8Status[1] = 0x03;
+    pui8Status[2] = 0x00;
+    pui8Status[3] = 0x06;
+    pui8Status[4] = ui8Status;
+    pui8Status[5] = NUM_STATS;
+    for(ui32Idx = 0; ui32Idx < NUM_STATS; ui32Idx++)
+    {
+        pui8Status[6 + (4 * ui32Idx)] = (uint8_t)(g_pui32Stats[ui32Idx] >> 24);
+        pui8Status[7 + (4 * ui32Idx)] = (uint8_t)(g_pui32Stats[ui32Idx] >> 16);
+        pui8Status[8 + (4 * ui32Idx)] = (uint8_t)(g_pui32Stats[ui32Idx] >> 8);
+        pui8Status[9 + (4 * ui32Idx)] = (uint8_t)g_pui32Stats[ui32Idx];
+    }
+    ReplyCRC(pui8Status, sizeof(pui8Status));
+
+    ReplyPacket(pui8Status, sizeof(pui8Status));
+}
+
+//*****************************************************************************
+//
+//! Sends the reply to a digest read.
+//!
+//! \param ui8Register is the low byte of the register being answered.
+//! \param ui8Status is the status of the last command.
+//! \param pui8Digest points to the 32 byte SHA-256 digest to send.
+//!
+//! This function answers a read of register 0x6004 with the status of the
+//! last command followed by the digest of the image downloaded so far, in
+//! the format described in bl_commands.h.  A write of register 0x600B is
+//! answered in the same way with the digest of the staged boot loader.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DigestPacket(uint8_t ui8Register, uint8_t ui8Status,
+             const uint8_t *pui8Digest)
+{
+    uint8_t pui8Reply[DIGEST_REPLY_SIZE];
+    uint32_t ui32Idx;
+
+    pui8Reply[0] = PACKET_REPLY_ID;
+    pui8Reply[1] = 0x03;
+    pui8Reply[2] = 0x60;
+    pui8Reply[3] = ui8Register;
+    pui8Reply[4] = ui8Status;
+    for(ui32Idx = 0; ui32Idx < 32; ui32Idx++)
+    {
+        pui8Reply[5 + ui32Idx] = pui8Digest[ui32Idx];
+    }
+    ReplyCRC(pui8Reply, sizeof(pui8Reply));
+
+    ReplyPacket(pui8Reply, sizeof(pui8Reply));
 }
 
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+//*****************************************************************************
+//
+//! Sends the reply to an erase counter read.
+//!
+//! \param ui8Status is the status of the last command.
+//! \param ui32Block is the first block whose counter is sent.
+//!
+//! This function answers a read of register 0x600D with the status of the
+//! last command, the number of erases skipped so far and the erase counters
+//! of \b WEAR_REPLY_BLOCKS blocks from \e ui32Block on, in the format
+//! described in bl_commands.h.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+WearPacket(uint8_t ui8Status, uint32_t ui32Block)
+{
+    uint8_t pui8Reply[WEAR_REPLY_SIZE];
+    uint32_t ui32Idx, ui32Count;
+
+    pui8Reply[0] = PACKET_REPLY_ID;
+    pui8Reply[1] = 0x03;
+    pui8Reply[2] = 0x60;
+    pui8Reply[3] = 0x0D;
+    pui8Reply[4] = ui8Status;
+    pui8Reply[5] = (uint8_t)(ui32Block >> 8);
+    pui8Reply[6] = (uint8_t)ui32Block;
+    pui8Reply[7] = WEAR_REPLY_BLOCKS;
+    pui8Reply[8] = (uint8_t)(g_ui32WearSkips >> 24);
+    pui8Reply[9] = (uint8_t)(g_ui32WearSkips >> 16);
+    pui8Reply[10] = (uint8_t)(g_ui32WearSkips >> 8);
+    pui8Reply[11] = (uint8_t)g_ui32WearSkips;
+    for(ui32Idx = 0; ui32Idx < WEAR_REPLY_BLOCKS; ui32Idx++)
+    {
+        ui32Count = WearGet(ui32Block + ui32Idx);
+        pui8Reply[12 + (2 * ui32Idx)] = (uint8_t)(ui32Count >> 8);
+        pui8Reply[13 + (2 * ui32Idx)] = (uint8_t)ui32Count;
+    }
+    ReplyCRC(pui8Reply, sizeof(pui8Reply));
+
+    ReplyPacket(pui8Reply, sizeof(pui8Reply));
+}
+#endif
+
+#ifdef ENABLE_FLASH_DUMP
+//*****************************************************************************
+//
+//! Sends one frame of a flash read back.
+//!
+//! \param ui8Status is the status of the read.
+//! \param ui32Address is the address of the first byte of flash to send.
+//! \param ui32Size is the number of bytes to send, a multiple of four and no
+//! more than \b DUMP_FRAME_SIZE.
+//! \param bLast is true for the last frame of the read.
+//!
+//! This function answers part of a read of register 0x600E, in the format
+//! described in bl_commands.h.  The flash is read a few words at a time, and
+//! their part of the CRC16 is worked out while the words before them are
+//! still in the transmit FIFO, so that the port never runs dry.  Only the
+//! last frame waits for the port to finish sending, so a run of frames goes
+//! out back to back.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+DumpPacket(uint8_t ui8Status, uint32_t ui32Address, uint32_t ui32Size,
+           bool bLast)
+{
+    uint8_t pui8Header[DUMP_HEADER_SIZE], pui8CRC[2];
+    uint32_t pui32Data[4], ui32CRC, ui32Idx, ui32Chunk;
+
+    if(g_bBroadcast)
+    {
+        return;
+    }
+
+    pui8Header[0] = PACKET_REPLY_ID;
+    pui8Header[1] = 0x03;
+    pui8Header[2] = 0x60;
+    pui8Header[3] = 0x0E;
+    pui8Header[4] = ui8Status;
+    pui8Header[5] = (uint8_t)(ui32Address >> 24);
+    pui8Header[6] = (uint8_t)(ui32Address >> 16);
+    pui8Header[7] = (uint8_t)(ui32Address >> 8);
+    pui8Header[8] = (uint8_t)ui32Address;
+    pui8Header[9] = (uint8_t)(ui32Size >> 8);
+    pui8Header[10] = (uint8_t)ui32Size;
+    ui32CRC = CalculateCRC16(pui8Header, DUMP_HEADER_SIZE, 0xffff);
+    WriteData(pui8Header, DUMP_HEADER_SIZE);
+
+    while(ui32Size)
+    {
+        ui32Chunk = (ui32Size > sizeof(pui32Data)) ? sizeof(pui32Data) :
+                                                     ui32Size;
+        for(ui32Idx = 0; ui32Idx < (ui32Chunk / 4); ui32Idx++)
+        {
+            pui32Data[ui32Idx] = HWREG(ui32Address + (ui32Idx * 4));
+        }
+        ui32CRC = CalculateCRC16((uint8_t *)pui32Data, ui32Chunk, ui32CRC);
+        WriteData((uint8_t *)pui32Data, ui32Chunk);
+        ui32Address += ui32Chunk;
+        ui32Size -= ui32Chunk;
+    }
+
+    pui8CRC[0] = (uint8_t)(ui32CRC >> 8);
+    pui8CRC[1] = (uint8_t)ui32CRC;
+    if(bLast)
+    {
+        SendData(pui8CRC, 2);
+    }
+    else
+    {
+        WriteData(pui8CRC, 2);
+    }
+}
+#endif
 
 //*****************************************************************************
 //
@@ -139,79 +504,314 @@ NakPacket(void)
 
 //*****************************************************************************
 //
-//! Receives a data packet.
+//! Calculates a CRC16 over a block of data.
 //!
-//! \param pui8Data is the location to store the data that is sent to the boot
-//! loader.
-//! \param pui32Size is the number of bytes returned in the pui8Data buffer
-//! that was provided.
+//! \param pui8Data is a pointer to an array of 8-bit data of size ui32Size.
+//! \param ui32Size is the number of bytes to include in the calculation.
+//! \param ui32CRC is the CRC value returned by the previous call or 0xffff if
+//! this is the first block of the packet.
 //!
-//! This function receives a packet of data from specified transfer function.
+//! This function updates a running CRC16 with the data passed in, using the
+//! reflected 0x8005 polynomial.  Since it is only run over one packet at a
+//! time it is calculated bit by bit, avoiding the SRAM a lookup table would
+//! take.
 //!
-//! \return Returns zero to indicate success while any non-zero value indicates
-//! a failure.
+//! \return Returns the updated CRC value.
 //
 //*****************************************************************************
-int ReceivePacket(Receive_Package *packet)
+uint32_t
+CalculateCRC16(const uint8_t *pui8Data, uint32_t ui32Size, uint32_t ui32CRC)
 {
-    int index,num;
-    UARTReceive(&rxbuff.ID,1);
-    UARTReceive(&rxbuff.CMD, 1);
-    UARTReceive(&rxbuff.ADDRESS.addressH, 1);
-    UARTReceive(&rxbuff.ADDRESS.addressL, 1);
-    if(rxbuff.ADDRESS.Address == 0x6000){
-        if(rxbuff.CMD == 0x06){
-            UARTReceive(&rxbuff.packetData[0], 1);
-        }
-        else if(rxbuff.CMD == 0x10){
-            for (index = 0;index < 3; index++) {
-                UARTReceive(&rxbuff.packetData[index], 1);
+    uint32_t ui32Bit;
+
+    while(ui32Size--)
+    {
+        ui32CRC ^= *pui8Data++;
+        for(ui32Bit = 0; ui32Bit < 8; ui32Bit++)
+        {
+            if(ui32CRC & 1)
+            {
+                ui32CRC = (ui32CRC >> 1) ^ 0xa001;
+            }
+            else
+            {
+                ui32CRC >>= 1;
             }
-        }
-        else{
-         //None for 0x6004
         }
     }
-    else if(rxbuff.ADDRESS.Address == 0x6001){
-        UARTReceive(&rxbuff.packetData[0], 1);
-        UARTReceive(&rxbuff.packetData[1], 1);
+
+    return(ui32CRC);
+}
+
+//*****************************************************************************
+//
+//! Determines the payload size of a packet from its header.
+//!
+//! \param ui8Cmd is the command (function code) byte of the packet.
+//! \param ui16Address is the register address carried by the packet.
+//!
+//! Every packet addresses one of the boot loader registers 0x6000 to 0x600E
+//! using one of the 0x03, 0x06 or 0x10 commands.  Any other combination
+//! cannot be the start of a packet, which is what allows the receiver to
+//! find the next packet boundary after a byte has been lost or corrupted.
+//!
+//! \return Returns the number of payload bytes between the header and the
+//! CRC or a negative value if the header is not valid.
+//
+//*****************************************************************************
+static int32_t
+PacketPayloadSize(uint8_t ui8Cmd, uint16_t ui16Address)
+{
+    if((ui16Address < 0x6000) || (ui16Address > 0x600E) ||
+       ((ui8Cmd != 0x03) && (ui8Cmd != 0x06) && (ui8Cmd != 0x10)))
+    {
+        return(-1);
     }
-    else if(rxbuff.ADDRESS.Address == 0x6002){
-        for (index = 0;index < 3; index++) {
-            UARTReceive(&rxbuff.packetData[index], 1);
+
+    switch(ui16Address)
+    {
+        case 0x6000:
+        {
+            if(ui8Cmd == 0x06)
+            {
+                return(1);
+            }
+            else if(ui8Cmd == 0x10)
+            {
+                return(3);
+            }
+
+            //
+            // None for 0x6004.
+            //
+            return(0);
         }
-    }
-    else if(rxbuff.ADDRESS.Address == 0x6003){
-        if(rxbuff.CMD == 0x10){
-            for(index = 0;index < 11; index++){
-            UARTReceive(&rxbuff.packetData[index], 1);
+
+        case 0x6001:
+        {
+            return(2);
+        }
+
+        case 0x6002:
+        {
+            return(3);
+        }
+
+        case 0x6003:
+        {
+            if(ui8Cmd == 0x10)
+            {
+                return(11);
             }
+            else if(ui8Cmd == 0x03)
+            {
+                return(2);
+            }
+            return(0);
+        }
+
+        case 0x6005:
+        {
+            if(ui8Cmd == 0x03)
+            {
+                return(2);
+            }
+            return(0);
         }
-        else if(rxbuff.CMD == 0x03){
-            UARTReceive(&rxbuff.packetData[0], 1);
-            UARTReceive(&rxbuff.packetData[1], 1);
+
+        case 0x6006:
+        {
+            if(ui8Cmd == 0x10)
+            {
+                return(PACKET_DATA_SIZE);
+            }
+            return(0);
         }
-        else{
-            //none
+
+        case 0x6007:
+        {
+            if(ui8Cmd == 0x10)
+            {
+                return(PACKET_DATA_SIZE + 2);
+            }
+            return(0);
+        }
+
+        case 0x6008:
+        {
+            if(ui8Cmd == 0x10)
+            {
+                return(4);
+            }
+            return(0);
+        }
+
+        case 0x6009:
+        {
+            if(ui8Cmd == 0x10)
+            {
+                return(11);
+            }
+            return(0);
+        }
+
+        case 0x600A:
+        {
+            if(ui8Cmd == 0x10)
+            {
+                return(DECRYPT_IV_SIZE);
+            }
+            return(0);
+        }
+
+        case 0x600B:
+        {
+            if(ui8Cmd == 0x10)
+            {
+                return(INSTALL_DIGEST_SIZE);
+            }
+            return(0);
+        }
+
+        case 0x600C:
+        {
+            if(ui8Cmd == 0x10)
+            {
+                return(MANIFEST_SIZE);
+            }
+            return(0);
+        }
+
+        case 0x600D:
+        {
+            if(ui8Cmd == 0x03)
+            {
+                return(2);
+            }
+            return(0);
+        }
+
+        case 0x600E:
+        {
+            if(ui8Cmd == 0x03)
+            {
+                return(8);
+            }
+            return(0);
+        }
+
+        default:
+        {
+            return(0);
         }
     }
-    else if(rxbuff.ADDRESS.Address == 0x6006){
-        if(rxbuff.CMD == 0x10){
-             num = 128;
-             for (index = 0; index < num; index++) {
-                 UARTReceive(&rxbuff.packetData[index], 1);
-             }
-         }
-        else{
-            //none
+}
+
+//*****************************************************************************
+//
+//! Receives a data packet.
+//!
+//! \param packet is the location to store the packet that is sent to the
+//! boot loader.
+//!
+//! This function waits for the start of a packet, then receives the rest of
+//! it from the transport in use.  The four header bytes are used as a start of
+//! packet pattern: while they do not form a valid header, the receive window
+//! slides forward one byte at a time until they do.  Once the first byte has
+//! arrived, every following byte must arrive within \b UART_RX_TIMEOUT
+//! milliseconds of the one before it.  Should the line go idle part way
+//! through, the partial packet is dropped; the host, still waiting for its
+//! response, then times out and retransmits just that packet.
+//!
+//! When \b UART_NODE_ID is defined, a header is only accepted if its ID byte
+//! is either this node's ID or \b UART_BROADCAST_ID.  Packets addressed to
+//! other nodes, and the responses that those nodes send back, are hunted
+//! through like any other noise on the bus.
+//!
+//! \return Returns zero to indicate success while any non-zero value indicates
+//! that a damaged or incomplete packet was discarded.
+//
+//*****************************************************************************
+int
+ReceivePacket(Receive_Package *packet)
+{
+    uint8_t pui8Header[4], pui8CRC[2];
+    int32_t i32Size;
+#ifdef CHECK_PACKET_CRC
+    uint32_t ui32CRC;
+#endif
+
+    //
+    // Wait as long as it takes for the first byte of a packet, then give the
+    // rest of the header a bounded time to follow.
+    //
+    ReceiveData(&pui8Header[0], 1);
+    if(ReceiveDataTimeout(&pui8Header[1], 3) != 0)
+    {
+        g_pui32Stats[STAT_TIMEOUTS]++;
+        return(-1);
+    }
+
+    //
+    // Hunt for a valid header, dropping one byte at a time.
+    //
+    while(((i32Size = PacketPayloadSize(pui8Header[1],
+                                        (pui8Header[2] << 8) |
+                                        pui8Header[3])) < 0)
+#ifdef UART_NODE_ID
+          || ((pui8Header[0] != UART_NODE_ID) &&
+              (pui8Header[0] != UART_BROADCAST_ID))
+#endif
+          )
+    {
+        pui8Header[0] = pui8Header[1];
+        pui8Header[1] = pui8Header[2];
+        pui8Header[2] = pui8Header[3];
+        if(ReceiveDataTimeout(&pui8Header[3], 1) != 0)
+        {
+            g_pui32Stats[STAT_TIMEOUTS]++;
+            return(-1);
         }
     }
-    else{
-        //none for 0x6000
+
+    packet->ID = pui8Header[0];
+#ifdef UART_NODE_ID
+    g_bBroadcast = (packet->ID == UART_BROADCAST_ID);
+#endif
+    packet->CMD = pui8Header[1];
+    packet->ADDRESS.addressH = pui8Header[2];
+    packet->ADDRESS.addressL = pui8Header[3];
+
+    //
+    // Receive the payload and the CRC that terminates the packet.
+    //
+    if((ReceiveDataTimeout(packet->packetData, i32Size) != 0) ||
+       (ReceiveDataTimeout(pui8CRC, 2) != 0))
+    {
+        g_pui32Stats[STAT_TIMEOUTS]++;
+        return(-1);
+    }
+    packet->CRC.crc_H = pui8CRC[0];
+    packet->CRC.crc_L = pui8CRC[1];
+
+#ifdef CHECK_PACKET_CRC
+    //
+    // Drop the packet if it was corrupted on the way.
+    //
+    ui32CRC = CalculateCRC16(pui8Header, 4, 0xffff);
+    ui32CRC = CalculateCRC16(packet->packetData, i32Size, ui32CRC);
+    if(ui32CRC != packet->CRC.CRC)
+    {
+        g_pui32Stats[STAT_CRC_ERRORS]++;
+        return(-1);
     }
-    rxbuff.CRC.crc_H= UARTCharGet(UART0_BASE);
-    rxbuff.CRC.crc_L= UARTCharGet(UART0_BASE);
+#endif
+    g_pui32Stats[STAT_FRAMES]++;
 
+    //
+    // Only the port that delivered this packet is used from now on.
+    //
+    TransportLock();
 
     return(0);
 }
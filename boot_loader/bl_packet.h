@@ -26,6 +26,40 @@
 #define __BL_PACKET_H__
 #define UART0_BASE 0x4000C000
 
+//*****************************************************************************
+//
+// The ID byte that packets broadcast to every node on a shared bus carry.
+//
+//*****************************************************************************
+#ifndef UART_BROADCAST_ID
+#define UART_BROADCAST_ID       0x00
+#endif
+
+//*****************************************************************************
+//
+// The ID byte that starts every response.  A node that has been given an
+// address responds with it so that the host can tell which node on a shared
+// bus responded.
+//
+//*****************************************************************************
+#ifdef UART_NODE_ID
+#if UART_NODE_ID == UART_BROADCAST_ID
+#error ERROR: UART_NODE_ID must not be the same as UART_BROADCAST_ID!
+#endif
+#define PACKET_REPLY_ID         UART_NODE_ID
+#else
+#define PACKET_REPLY_ID         0x21
+#endif
+
+//*****************************************************************************
+//
+// The number of firmware bytes carried by each data packet.  Sequenced data
+// packets (0x6007) follow them with a two byte block number, and skip packets
+// (0x6008) move past whole blocks of this size.
+//
+//*****************************************************************************
+#define PACKET_DATA_SIZE        128
+
 typedef struct {
     union CRC
     {
@@ -45,7 +79,7 @@ typedef struct {
          uint8_t addressH;
         };
     }ADDRESS;
-    uint8_t packetData[128];
+    uint8_t packetData[PACKET_DATA_SIZE + 2];
     uint8_t Num;
     uint8_t CMD;
     uint8_t ID;
@@ -53,14 +87,38 @@ typedef struct {
 
 Receive_Package rxbuff;
 
+//*****************************************************************************
+//
+// The counters returned by a status read, indexed by the STAT_* values.
+//
+//*****************************************************************************
+extern uint32_t g_pui32Stats[NUM_STATS];
+
 //*****************************************************************************
 //
 // Packet Handling APIs
 //
 //*****************************************************************************
 extern int ReceivePacket(Receive_Package *packet);
+extern uint32_t CalculateCRC16(const uint8_t *pui8Data, uint32_t ui32Size,
+                               uint32_t ui32CRC);
 extern int SendPacket(uint8_t *pui8Data, uint32_t ui32Size);
+extern void ReplyPacket(const uint8_t *pui8Data, uint32_t ui32Size);
 extern void AckPacket(void);
+extern void RefusePacket(uint8_t ui8Status);
 extern void APP_PingACK(void);
+extern void ProgressPacket(uint8_t ui8Status, uint32_t ui32Block);
+extern void ResumePacket(uint8_t ui8Status, uint32_t ui32Block,
+                         uint32_t ui32CRC);
+extern void StatusPacket(uint8_t ui8Status);
+extern void DigestPacket(uint8_t ui8Register, uint8_t ui8Status,
+                         const uint8_t *pui8Digest);
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+extern void WearPacket(uint8_t ui8Status, uint32_t ui32Block);
+#endif
+#ifdef ENABLE_FLASH_DUMP
+extern void DumpPacket(uint8_t ui8Status, uint32_t ui32Address,
+                       uint32_t ui32Size, bool bLast);
+#endif
 
 #endif // __BL_PACKET_H__
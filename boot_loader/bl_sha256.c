@@ -0,0 +1,455 @@
+//*****************************************************************************
+//
+// bl_sha256.c - SHA-256 digest functions used in the boot loader.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_shamd5.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "bl_config.h"
+#include "driverlib/shamd5.h"
+#include "driverlib/udma.h"
+#include "boot_loader/bl_dma.h"
+#include "boot_loader/bl_sha256.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_sha256_api
+//! @{
+//
+//*****************************************************************************
+#if defined(IMAGE_DIGEST) || defined(CHECK_SIGNATURE) || defined(DOXYGEN)
+
+//*****************************************************************************
+//
+// The uDMA channel that feeds data to the SHA/MD5 module, and the number of
+// blocks that one uDMA transfer of at most 1024 words can move.
+//
+//*****************************************************************************
+#define SHA256_DMA_CHANNEL      UDMA_CH5_SHAMD50DIN
+#define SHA256_DMA_CHANNEL_NUM  5
+#define SHA256_DMA_BLOCKS       (1024 * 4 / SHA256_BLOCK_SIZE)
+
+//*****************************************************************************
+//
+// Set once the SHA/MD5 module has been enabled, when CRYPTO_ENABLE_HW is
+// defined and the module is used in place of the software hash.
+//
+//*****************************************************************************
+#ifdef CRYPTO_ENABLE_HW
+static bool g_bSHA256Enabled;
+#endif
+
+//*****************************************************************************
+//
+// The initial hash value and the round constants of SHA-256.
+//
+//*****************************************************************************
+static const uint32_t g_pui32SHA256Init[8] =
+{
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+#ifndef CRYPTO_ENABLE_HW
+static const uint32_t g_pui32SHA256K[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+#endif
+
+//*****************************************************************************
+//
+// The SHA-256 round functions.
+//
+//*****************************************************************************
+#define ROTR(x, n)              (((x) >> (n)) | ((x) << (32 - (n))))
+#define CH(x, y, z)             (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z)            (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define SIGMA0(x)               (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define SIGMA1(x)               (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+#define GAMMA0(x)               (ROTR(x, 7) ^ ROTR(x, 18) ^ ((x) >> 3))
+#define GAMMA1(x)               (ROTR(x, 17) ^ ROTR(x, 19) ^ ((x) >> 10))
+
+//*****************************************************************************
+//
+// Reverses the bytes of a word.  The SHA/MD5 module holds the digest as the
+// bytes of the hash in memory order, so each of its words is the reverse of
+// the corresponding state word.
+//
+//*****************************************************************************
+#ifdef CRYPTO_ENABLE_HW
+static uint32_t
+SHA256Swap(uint32_t ui32Value)
+{
+    return((ui32Value >> 24) | ((ui32Value >> 8) & 0x0000ff00) |
+           ((ui32Value << 8) & 0x00ff0000) | (ui32Value << 24));
+}
+#endif
+
+//*****************************************************************************
+//
+// Enables the SHA/MD5 module and the uDMA controller that feeds it.  The
+// devices without the module still report the CRC module that shares its
+// peripheral as present, so CRYPTO_ENABLE_HW, rather than a run-time check,
+// says that the module is there.
+//
+//*****************************************************************************
+#ifdef CRYPTO_ENABLE_HW
+static void
+SHA256HardwareInit(void)
+{
+    g_bSHA256Enabled = true;
+
+    //
+    // Enable the clock to the cryptographic modules.
+    //
+    HWREG(SYSCTL_RCGCCCM) |= SYSCTL_RCGCCCM_R0;
+    while(!(HWREG(SYSCTL_PRCCM) & SYSCTL_PRCCM_R0))
+    {
+    }
+
+    //
+    // Let the SHA/MD5 module request its input data from the uDMA controller.
+    //
+    SHAMD5Reset(SHAMD5_BASE);
+    SHAMD5DMAEnable(SHAMD5_BASE);
+    BLDMAInit();
+    uDMAChannelAssign(SHA256_DMA_CHANNEL);
+    uDMAChannelAttributeDisable(SHA256_DMA_CHANNEL_NUM, UDMA_ATTR_ALL);
+}
+#endif
+
+//*****************************************************************************
+//
+// Adds whole blocks to a digest.  The blocks may be in flash or SRAM, but
+// the software hash is only ever given blocks in SRAM.  psContext->ui32Count
+// is not changed; rounded down to a whole block it gives the number of bytes
+// hashed before these blocks.
+//
+//*****************************************************************************
+static void
+SHA256Blocks(tSHA256Context *psContext, const uint8_t *pui8Block,
+             uint32_t ui32Blocks)
+{
+#ifdef CRYPTO_ENABLE_HW
+    uint32_t ui32T1, ui32Idx, ui32Done;
+
+    //
+    // The SHA/MD5 module carries on from the state given to it, reading the
+    // blocks itself through the uDMA controller.  Neither the algorithm
+    // constant nor the close hash mode bit is set, so the module starts from
+    // the state written to it and leaves the padding to SHA256Final().
+    //
+    ui32Done = psContext->ui32Count & ~(SHA256_BLOCK_SIZE - 1);
+    while(ui32Blocks)
+    {
+        ui32Idx = ((ui32Blocks > SHA256_DMA_BLOCKS) ? SHA256_DMA_BLOCKS :
+                   ui32Blocks);
+
+        while(!(HWREG(SHAMD5_BASE + SHAMD5_O_IRQSTATUS) &
+                SHAMD5_INT_CONTEXT_READY))
+        {
+        }
+        for(ui32T1 = 0; ui32T1 < 8; ui32T1++)
+        {
+            HWREG(SHAMD5_BASE + SHAMD5_O_IDIGEST_A + (ui32T1 * 4)) =
+                SHA256Swap(psContext->pui32State[ui32T1]);
+        }
+        HWREG(SHAMD5_BASE + SHAMD5_O_DIGEST_COUNT) = ui32Done;
+        HWREG(SHAMD5_BASE + SHAMD5_O_MODE) = SHAMD5_MODE_ALGO_SHA256;
+
+        uDMAChannelControlSet(SHA256_DMA_CHANNEL_NUM | UDMA_PRI_SELECT,
+                              (UDMA_SIZE_32 | UDMA_SRC_INC_32 |
+                               UDMA_DST_INC_NONE | UDMA_ARB_16));
+        uDMAChannelTransferSet(SHA256_DMA_CHANNEL_NUM | UDMA_PRI_SELECT,
+                               UDMA_MODE_BASIC, (void *)pui8Block,
+                               (void *)(SHAMD5_BASE + SHAMD5_O_DATA_0_IN),
+                               ui32Idx * (SHA256_BLOCK_SIZE / 4));
+        uDMAChannelEnable(SHA256_DMA_CHANNEL_NUM);
+        SHAMD5HashLengthSet(SHAMD5_BASE, ui32Idx * SHA256_BLOCK_SIZE);
+
+        while(!(HWREG(SHAMD5_BASE + SHAMD5_O_IRQSTATUS) &
+                SHAMD5_INT_OUTPUT_READY))
+        {
+        }
+        for(ui32T1 = 0; ui32T1 < 8; ui32T1++)
+        {
+            psContext->pui32State[ui32T1] =
+                SHA256Swap(HWREG(SHAMD5_BASE + SHAMD5_O_IDIGEST_A +
+                                 (ui32T1 * 4)));
+        }
+
+        pui8Block += ui32Idx * SHA256_BLOCK_SIZE;
+        ui32Done += ui32Idx * SHA256_BLOCK_SIZE;
+        ui32Blocks -= ui32Idx;
+    }
+#else
+    uint32_t pui32W[16], pui32V[8], ui32T1, ui32T2, ui32Idx;
+
+    //
+    // Run the compression function in software, keeping only the last 16
+    // words of the message schedule.
+    //
+    while(ui32Blocks--)
+    {
+        for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+        {
+            pui32V[ui32Idx] = psContext->pui32State[ui32Idx];
+        }
+        for(ui32Idx = 0; ui32Idx < 64; ui32Idx++)
+        {
+            if(ui32Idx < 16)
+            {
+                pui32W[ui32Idx] = ((pui8Block[0] << 24) |
+                                   (pui8Block[1] << 16) |
+                                   (pui8Block[2] << 8) | pui8Block[3]);
+                pui8Block += 4;
+            }
+            else
+            {
+                pui32W[ui32Idx & 15] += (GAMMA1(pui32W[(ui32Idx - 2) & 15]) +
+                                         pui32W[(ui32Idx - 7) & 15] +
+                                         GAMMA0(pui32W[(ui32Idx - 15) & 15]));
+            }
+            ui32T1 = (pui32V[7] + SIGMA1(pui32V[4]) +
+                      CH(pui32V[4], pui32V[5], pui32V[6]) +
+                      g_pui32SHA256K[ui32Idx] + pui32W[ui32Idx & 15]);
+            ui32T2 = (SIGMA0(pui32V[0]) +
+                      MAJ(pui32V[0], pui32V[1], pui32V[2]));
+            pui32V[7] = pui32V[6];
+            pui32V[6] = pui32V[5];
+            pui32V[5] = pui32V[4];
+            pui32V[4] = pui32V[3] + ui32T1;
+            pui32V[3] = pui32V[2];
+            pui32V[2] = pui32V[1];
+            pui32V[1] = pui32V[0];
+            pui32V[0] = ui32T1 + ui32T2;
+        }
+        for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+        {
+            psContext->pui32State[ui32Idx] += pui32V[ui32Idx];
+        }
+    }
+#endif
+}
+
+//*****************************************************************************
+//
+//! Starts a SHA-256 digest.
+//!
+//! \param psContext is the digest to start.
+//!
+//! This function starts a new digest, to which data is then added by
+//! SHA256Update() and SHA256UpdateFlash().  If CRYPTO_ENABLE_HW is defined,
+//! the whole blocks of the data are hashed by the SHA/MD5 module, which the
+//! first call enables along with the uDMA controller; otherwise they are
+//! hashed in software.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SHA256Init(tSHA256Context *psContext)
+{
+    uint32_t ui32Idx;
+
+#ifdef CRYPTO_ENABLE_HW
+    if(!g_bSHA256Enabled)
+    {
+        SHA256HardwareInit();
+    }
+#endif
+
+    for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+    {
+        psContext->pui32State[ui32Idx] = g_pui32SHA256Init[ui32Idx];
+    }
+    psContext->ui32Count = 0;
+}
+
+//*****************************************************************************
+//
+//! Adds data in SRAM to a SHA-256 digest.
+//!
+//! \param psContext is the digest to add the data to.
+//! \param pui8Data points to the data.
+//! \param ui32Length is the number of bytes of data.
+//!
+//! This function adds the data to the digest a block at a time, keeping any
+//! bytes left over until the next call completes their block.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SHA256Update(tSHA256Context *psContext, const uint8_t *pui8Data,
+             uint32_t ui32Length)
+{
+    uint32_t ui32Used;
+
+    while(ui32Length--)
+    {
+        ui32Used = psContext->ui32Count % SHA256_BLOCK_SIZE;
+        psContext->pui8Block[ui32Used] = *pui8Data++;
+        if(ui32Used == (SHA256_BLOCK_SIZE - 1))
+        {
+            SHA256Blocks(psContext, psContext->pui8Block, 1);
+        }
+        psContext->ui32Count++;
+    }
+}
+
+//*****************************************************************************
+//
+//! Adds the contents of flash to a SHA-256 digest.
+//!
+//! \param psContext is the digest to add the data to.
+//! \param ui32Address is the address of the data in flash.
+//! \param ui32Length is the number of bytes of data.
+//!
+//! This function adds a range of flash to the digest.  With CRYPTO_ENABLE_HW,
+//! whole blocks that are word aligned and start a block of the digest are
+//! streamed from flash straight into the module by the uDMA controller;
+//! anything else is read a word at a time and added by SHA256Update().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SHA256UpdateFlash(tSHA256Context *psContext, uint32_t ui32Address,
+                  uint32_t ui32Length)
+{
+    uint8_t pui8Word[4];
+    uint32_t ui32Word, ui32Size;
+
+#ifdef CRYPTO_ENABLE_HW
+    if(!(ui32Address & 3) && !(psContext->ui32Count % SHA256_BLOCK_SIZE))
+    {
+        ui32Size = ui32Length & ~(SHA256_BLOCK_SIZE - 1);
+        SHA256Blocks(psContext, (const uint8_t *)ui32Address,
+                     ui32Size / SHA256_BLOCK_SIZE);
+        psContext->ui32Count += ui32Size;
+        ui32Address += ui32Size;
+        ui32Length -= ui32Size;
+    }
+#endif
+
+    while(ui32Length)
+    {
+        ui32Word = HWREG(ui32Address & ~3) >> (8 * (ui32Address & 3));
+        pui8Word[0] = (uint8_t)ui32Word;
+        pui8Word[1] = (uint8_t)(ui32Word >> 8);
+        pui8Word[2] = (uint8_t)(ui32Word >> 16);
+        pui8Word[3] = (uint8_t)(ui32Word >> 24);
+        ui32Size = 4 - (ui32Address & 3);
+        if(ui32Size > ui32Length)
+        {
+            ui32Size = ui32Length;
+        }
+        SHA256Update(psContext, pui8Word, ui32Size);
+        ui32Address += ui32Size;
+        ui32Length -= ui32Size;
+    }
+}
+
+//*****************************************************************************
+//
+//! Completes a SHA-256 digest.
+//!
+//! \param psContext is the digest to complete.
+//! \param pui8Digest is the buffer to return the SHA256_DIGEST_SIZE bytes of
+//! the digest in.
+//!
+//! This function pads the data added to the digest and returns the hash.
+//! The context must be started again by SHA256Init() before it is reused.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SHA256Final(tSHA256Context *psContext, uint8_t *pui8Digest)
+{
+    uint8_t pui8Length[8], ui8Pad;
+    uint32_t ui32Idx;
+
+    //
+    // The length is the number of bits in the data, most significant byte
+    // first.
+    //
+    pui8Length[0] = 0;
+    pui8Length[1] = 0;
+    pui8Length[2] = 0;
+    pui8Length[3] = (uint8_t)(psContext->ui32Count >> 29);
+    pui8Length[4] = (uint8_t)(psContext->ui32Count >> 21);
+    pui8Length[5] = (uint8_t)(psContext->ui32Count >> 13);
+    pui8Length[6] = (uint8_t)(psContext->ui32Count >> 5);
+    pui8Length[7] = (uint8_t)(psContext->ui32Count << 3);
+
+    //
+    // Pad with a one bit and as many zero bits as leave room for the length
+    // at the end of the last block.
+    //
+    ui8Pad = 0x80;
+    SHA256Update(psContext, &ui8Pad, 1);
+    ui8Pad = 0;
+    while((psContext->ui32Count % SHA256_BLOCK_SIZE) !=
+          (SHA256_BLOCK_SIZE - 8))
+    {
+        SHA256Update(psContext, &ui8Pad, 1);
+    }
+    SHA256Update(psContext, pui8Length, 8);
+
+    for(ui32Idx = 0; ui32Idx < SHA256_DIGEST_SIZE; ui32Idx++)
+    {
+        pui8Digest[ui32Idx] =
+            (uint8_t)(psContext->pui32State[ui32Idx / 4] >>
+                      (24 - (8 * (ui32Idx % 4))));
+    }
+}
+
+#endif
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
@@ -0,0 +1,64 @@
+//*****************************************************************************
+//
+// bl_sha256.h - Definitions for the boot loader SHA-256 functions.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_SHA256_H__
+#define __BL_SHA256_H__
+
+//*****************************************************************************
+//
+// The sizes of a SHA-256 digest and of the blocks that it is computed over,
+// in bytes.
+//
+//*****************************************************************************
+#define SHA256_DIGEST_SIZE      32
+#define SHA256_BLOCK_SIZE       64
+
+//*****************************************************************************
+//
+// The state of a SHA-256 digest that is being computed.  The state words are
+// those of the hash, the count is the number of bytes hashed so far and the
+// block holds the bytes of the last block that is not yet complete.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t pui32State[8];
+    uint32_t ui32Count;
+    uint8_t pui8Block[SHA256_BLOCK_SIZE];
+}
+tSHA256Context;
+
+//*****************************************************************************
+//
+// SHA-256 APIs
+//
+//*****************************************************************************
+extern void SHA256Init(tSHA256Context *psContext);
+extern void SHA256Update(tSHA256Context *psContext, const uint8_t *pui8Data,
+                         uint32_t ui32Length);
+extern void SHA256UpdateFlash(tSHA256Context *psContext, uint32_t ui32Address,
+                              uint32_t ui32Length);
+extern void SHA256Final(tSHA256Context *psContext, uint8_t *pui8Digest);
+
+#endif // __BL_SHA256_H__
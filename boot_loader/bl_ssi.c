@@ -0,0 +1,441 @@
+//*****************************************************************************
+//
+// bl_ssi.c - Functions used to transfer data via the SSI port.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_gpio.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_ssi.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "bl_config.h"
+#include "driverlib/ssi.h"
+#include "driverlib/udma.h"
+#include "boot_loader/bl_dma.h"
+#include "boot_loader/bl_ssi.h"
+#include "boot_loader/bl_timer.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_ssi_api
+//! @{
+//
+//*****************************************************************************
+#if defined(SSI_ENABLE_UPDATE) || defined(DOXYGEN)
+
+//*****************************************************************************
+//
+//! Drives the ready/busy handshake output.
+//!
+//! \param bReady is \b true to tell the host that it may clock the next
+//! packet or response and \b false to hold it off.
+//!
+//! This function does nothing unless \b SSI_READYPIN_BASE is defined.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+SSIReadySet(bool bReady)
+{
+#ifdef SSI_READYPIN_BASE
+    HWREG(SSI_READYPIN_BASE + GPIO_O_DATA + (SSI_READY << 2)) =
+        bReady ? SSI_READY : 0;
+#endif
+}
+
+//*****************************************************************************
+//
+//! Configures the SSI port as a slave for use by the boot loader.
+//!
+//! This function enables the SSI module and its pins and puts it in slave
+//! mode, using the Motorola frame format with the clock idling high and data
+//! captured on the rising edge.  In slave mode the SSI clock from the host
+//! can run at up to one twelfth of the system clock.  If \b SSI_ENABLE_DMA is
+//! defined the uDMA controller is also set up to move received data from the
+//! SSI receive FIFO.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ConfigureSSI(void)
+{
+    //
+    // Enable the clocks to the SSI and GPIO modules.
+    //
+    HWREG(SYSCTL_RCGCGPIO) |= (SSI_CLKPIN_CLOCK_ENABLE |
+                               SSI_FSSPIN_CLOCK_ENABLE |
+                               SSI_MISOPIN_CLOCK_ENABLE |
+                               SSI_MOSIPIN_CLOCK_ENABLE);
+    HWREG(SYSCTL_RCGCSSI) |= SSI_CLOCK_ENABLE;
+    while(!(HWREG(SYSCTL_PRSSI) & SSI_CLOCK_ENABLE))
+    {
+    }
+
+    //
+    // Make the pin be peripheral controlled.
+    //
+    HWREG(SSI_CLKPIN_BASE + GPIO_O_AFSEL) |= SSI_CLK;
+    HWREG(SSI_CLKPIN_BASE + GPIO_O_PCTL) |= SSI_CLK_PCTL;
+    HWREG(SSI_CLKPIN_BASE + GPIO_O_DEN) |= SSI_CLK;
+    HWREG(SSI_CLKPIN_BASE + GPIO_O_ODR) &= ~(SSI_CLK);
+
+    HWREG(SSI_FSSPIN_BASE + GPIO_O_AFSEL) |= SSI_CS;
+    HWREG(SSI_FSSPIN_BASE + GPIO_O_PCTL) |= SSI_CS_PCTL;
+    HWREG(SSI_FSSPIN_BASE + GPIO_O_DEN) |= SSI_CS;
+    HWREG(SSI_FSSPIN_BASE + GPIO_O_ODR) &= ~(SSI_CS);
+
+    HWREG(SSI_MISOPIN_BASE + GPIO_O_AFSEL) |= SSI_TX;
+    HWREG(SSI_MISOPIN_BASE + GPIO_O_PCTL) |= SSI_TX_PCTL;
+    HWREG(SSI_MISOPIN_BASE + GPIO_O_DEN) |= SSI_TX;
+    HWREG(SSI_MISOPIN_BASE + GPIO_O_ODR) &= ~(SSI_TX);
+
+    HWREG(SSI_MOSIPIN_BASE + GPIO_O_AFSEL) |= SSI_RX;
+    HWREG(SSI_MOSIPIN_BASE + GPIO_O_PCTL) |= SSI_RX_PCTL;
+    HWREG(SSI_MOSIPIN_BASE + GPIO_O_DEN) |= SSI_RX;
+    HWREG(SSI_MOSIPIN_BASE + GPIO_O_ODR) &= ~(SSI_RX);
+
+#ifdef SSI_READYPIN_BASE
+    //
+    // Make the ready/busy pin an output, starting out busy.
+    //
+    HWREG(SYSCTL_RCGCGPIO) |= SSI_READYPIN_CLOCK_ENABLE;
+    while(!(HWREG(SYSCTL_PRGPIO) & SSI_READYPIN_CLOCK_ENABLE))
+    {
+    }
+    SSIReadySet(false);
+    HWREG(SSI_READYPIN_BASE + GPIO_O_DIR) |= SSI_READY;
+    HWREG(SSI_READYPIN_BASE + GPIO_O_DEN) |= SSI_READY;
+#endif
+
+    //
+    // Set the SSI protocol to Motorola with default clock high and data
+    // valid on the rising edge.
+    //
+    HWREG(SSIx_BASE + SSI_O_CR0) = (SSI_CR0_SPH | SSI_CR0_SPO |
+                                    (DATA_BITS_SSI - 1));
+
+#ifdef SSI_ENABLE_DMA
+    //
+    // Enable the uDMA controller and set up the SSI receive channel to move
+    // bytes from the receive FIFO into memory, four at a time whenever the
+    // FIFO is half full and singly as the end of a transfer trickles in.
+    //
+    BLDMAInit();
+    uDMAChannelAssign(SSI_RX_DMA_CHANNEL);
+    uDMAChannelAttributeDisable(SSI_RX_DMA_CHANNEL_NUM, UDMA_ATTR_ALL);
+    uDMAChannelControlSet(SSI_RX_DMA_CHANNEL_NUM | UDMA_PRI_SELECT,
+                          (UDMA_SIZE_8 | UDMA_SRC_INC_NONE |
+                           UDMA_DST_INC_8 | UDMA_ARB_4));
+    SSIDMAEnable(SSIx_BASE, SSI_DMA_RX);
+#endif
+
+    //
+    // Enable the SSI interface in slave mode.
+    //
+    HWREG(SSIx_BASE + SSI_O_CR1) = SSI_CR1_MS | SSI_CR1_SSE;
+}
+
+//*****************************************************************************
+//
+//! Checks whether data has been received by the SSI port.
+//!
+//! This function is used to wait for the start of a packet while other
+//! transports are polled too, so it tells the host that the boot loader is
+//! ready for a packet just as SSIReceive() does.
+//!
+//! \return Returns non-zero if a received byte is waiting to be read and zero
+//! otherwise.
+//
+//*****************************************************************************
+uint32_t
+SSIPoll(void)
+{
+    SSIReadySet(true);
+
+    return(HWREG(SSIx_BASE + SSI_O_SR) & SSI_SR_RNE);
+}
+
+//*****************************************************************************
+//
+//! Sends data over the SSI port.
+//!
+//! \param pui8Data is the buffer containing the data to write out to the SSI
+//! port.
+//! \param ui32Size is the number of bytes provided in \e pui8Data buffer that
+//! will be written out to the SSI port.
+//!
+//! This function sends \e ui32Size bytes of data from the buffer pointed to by
+//! \e pui8Data via the SSI port.  Since the host provides the clock, the data
+//! only leaves once the host clocks it out.  The ready/busy output is raised
+//! as soon as the start of the data is waiting in the transmit FIFO and is
+//! dropped again once the host has clocked all of it out, which is the host's
+//! cue that the boot loader is going back to waiting for the next packet.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SSISend(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    SSIWrite(pui8Data, ui32Size);
+
+    //
+    // Wait until the host has clocked everything out, then hold it off while
+    // the boot loader goes back to waiting for the next packet.
+    //
+    SSIFlush();
+    SSIReadySet(false);
+
+    //
+    // Throw away whatever else the host clocked in while reading the data.
+    //
+    while(HWREG(SSIx_BASE + SSI_O_SR) & SSI_SR_RNE)
+    {
+        HWREG(SSIx_BASE + SSI_O_DR);
+    }
+}
+
+//*****************************************************************************
+//
+//! Queues data to be sent over the SSI port.
+//!
+//! \param pui8Data is the buffer containing the data to write out to the SSI
+//! port.
+//! \param ui32Size is the number of bytes provided in \e pui8Data buffer that
+//! will be written out to the SSI port.
+//!
+//! This function returns as soon as the last of the data is in the transmit
+//! FIFO, with the ready/busy output raised, so that the host can keep
+//! clocking through the next call without a break.  The last piece of a reply
+//! is sent with SSISend() instead, which waits for the host to clock it all
+//! out and then holds the host off.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SSIWrite(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    //
+    // Transmit the number of bytes requested on the SSI port.
+    //
+    while(ui32Size--)
+    {
+        //
+        // Make sure that the transmit FIFO is not full, telling the host to
+        // clock the data out if it is.
+        //
+        while(!(HWREG(SSIx_BASE + SSI_O_SR) & SSI_SR_TNF))
+        {
+            SSIReadySet(true);
+        }
+
+        //
+        // Send out the next byte.
+        //
+        HWREG(SSIx_BASE + SSI_O_DR) = *pui8Data++;
+
+        //
+        // Discard the byte that the host clocked in while this one was sent.
+        //
+        HWREG(SSIx_BASE + SSI_O_DR);
+    }
+    SSIReadySet(true);
+}
+
+//*****************************************************************************
+//
+//! Waits until all data has been transmitted by the SSI port.
+//!
+//! This function waits until all data written to the SSI port has been read
+//! out by the host.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SSIFlush(void)
+{
+    //
+    // Wait for the transmit FIFO to empty.
+    //
+    while(!(HWREG(SSIx_BASE + SSI_O_SR) & SSI_SR_TFE))
+    {
+    }
+
+    //
+    // Wait until the interface is not busy.
+    //
+    while(HWREG(SSIx_BASE + SSI_O_SR) & SSI_SR_BSY)
+    {
+    }
+}
+
+//*****************************************************************************
+//
+//! Receives data from the SSI port in slave mode.
+//!
+//! \param pui8Data is the location to store the data received from the SSI
+//! port.
+//! \param ui32Size is the number of bytes of data to receive.
+//!
+//! This function receives data from the SSI port in slave mode.  The function
+//! will not return until \e ui32Size number of bytes have been received.  It
+//! is used to wait for the start of each packet, so the ready/busy output is
+//! raised while waiting and dropped as soon as the first byte arrives.  The
+//! host waits for the output to be raised before clocking each packet, and
+//! then clocks the whole packet without waiting again.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SSIReceive(uint8_t *pui8Data, uint32_t ui32Size)
+{
+    //
+    // Tell the host that the boot loader is ready for a packet.
+    //
+    SSIReadySet(true);
+
+    //
+    // Ensure that we are waiting on all of the data.
+    //
+    while(ui32Size--)
+    {
+        //
+        // Wait until there is data in the FIFO.
+        //
+        while(!(HWREG(SSIx_BASE + SSI_O_SR) & SSI_SR_RNE))
+        {
+        }
+
+        //
+        // Read the next byte.
+        //
+        *pui8Data++ = HWREG(SSIx_BASE + SSI_O_DR);
+
+        //
+        // The host has started clocking in a packet, so it no longer needs
+        // to be told that the boot loader is ready.
+        //
+        SSIReadySet(false);
+    }
+}
+
+//*****************************************************************************
+//
+//! Receives data from the SSI port with an inter-byte timeout.
+//!
+//! \param pui8Data is the location to store the data received from the SSI
+//! port.
+//! \param ui32Size is the number of bytes of data to receive.
+//!
+//! This function behaves like SSIReceive() except that it gives up if the
+//! gap before any one of the requested bytes exceeds \b UART_RX_TIMEOUT
+//! milliseconds, and that it leaves the ready/busy output alone.  When
+//! \b SSI_ENABLE_DMA is defined, transfers of \b SSI_DMA_THRESHOLD bytes or
+//! more are made by the uDMA controller, so that the receive FIFO is emptied
+//! in bursts without the processor having to keep up with every byte of a
+//! fast SSI clock.
+//!
+//! \return Returns zero if all \e ui32Size bytes were received or a negative
+//! value if the host stopped clocking data first.
+//
+//*****************************************************************************
+int
+SSIReceiveTimeout(uint8_t *pui8Data, uint32_t ui32Size)
+{
+#ifdef SSI_ENABLE_DMA
+    uint32_t ui32Remaining, ui32Left;
+
+    if(ui32Size >= SSI_DMA_THRESHOLD)
+    {
+        //
+        // Start the transfer from the receive FIFO into the buffer.
+        //
+        uDMAChannelTransferSet(SSI_RX_DMA_CHANNEL_NUM | UDMA_PRI_SELECT,
+                               UDMA_MODE_BASIC,
+                               (void *)(SSIx_BASE + SSI_O_DR), pui8Data,
+                               ui32Size);
+        uDMAChannelEnable(SSI_RX_DMA_CHANNEL_NUM);
+
+        //
+        // Wait for the transfer to complete, restarting the timeout every
+        // time that it makes progress.
+        //
+        ui32Remaining = ui32Size;
+        BLTimerStart();
+        while(uDMAChannelIsEnabled(SSI_RX_DMA_CHANNEL_NUM))
+        {
+            ui32Left = uDMAChannelSizeGet(SSI_RX_DMA_CHANNEL_NUM |
+                                          UDMA_PRI_SELECT);
+            if(ui32Left != ui32Remaining)
+            {
+                ui32Remaining = ui32Left;
+                BLTimerStart();
+            }
+            else if(BLTimerExpired())
+            {
+                uDMAChannelDisable(SSI_RX_DMA_CHANNEL_NUM);
+                return(-1);
+            }
+        }
+
+        return(0);
+    }
+#endif
+
+    while(ui32Size--)
+    {
+        //
+        // Wait until there is data in the FIFO, giving up if the host stops
+        // clocking for a full timeout period.
+        //
+        BLTimerStart();
+        while(!(HWREG(SSIx_BASE + SSI_O_SR) & SSI_SR_RNE))
+        {
+            if(BLTimerExpired())
+            {
+                return(-1);
+            }
+        }
+
+        //
+        // Read the next byte.
+        //
+        *pui8Data++ = HWREG(SSIx_BASE + SSI_O_DR);
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+#endif
@@ -0,0 +1,188 @@
+//*****************************************************************************
+//
+// bl_ssi.h - Definitions for the SSI transport functions.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_SSI_H__
+#define __BL_SSI_H__
+
+//*****************************************************************************
+//
+// This section maps the defines to default for the SSI boot loader for
+// projects that do not specify them in bl_config.h.
+//
+//*****************************************************************************
+#ifndef SSI_CLOCK_ENABLE
+#define SSI_CLOCK_ENABLE        SYSCTL_RCGCSSI_R0
+#endif
+
+#ifndef SSIx_BASE
+#define SSIx_BASE               SSI0_BASE
+#endif
+
+#ifndef SSI_CLKPIN_CLOCK_ENABLE
+#define SSI_CLKPIN_CLOCK_ENABLE SYSCTL_RCGCGPIO_R0
+#endif
+
+#ifndef SSI_CLKPIN_BASE
+#define SSI_CLKPIN_BASE         GPIO_PORTA_BASE
+#endif
+
+#ifndef SSI_CLKPIN_PCTL
+#define SSI_CLKPIN_PCTL         0xf
+#endif
+
+#ifndef SSI_CLKPIN_POS
+#define SSI_CLKPIN_POS          2
+#endif
+
+#ifndef SSI_FSSPIN_CLOCK_ENABLE
+#define SSI_FSSPIN_CLOCK_ENABLE SYSCTL_RCGCGPIO_R0
+#endif
+
+#ifndef SSI_FSSPIN_BASE
+#define SSI_FSSPIN_BASE         GPIO_PORTA_BASE
+#endif
+
+#ifndef SSI_FSSPIN_PCTL
+#define SSI_FSSPIN_PCTL         0xf
+#endif
+
+#ifndef SSI_FSSPIN_POS
+#define SSI_FSSPIN_POS          3
+#endif
+
+#ifndef SSI_MISOPIN_CLOCK_ENABLE
+#define SSI_MISOPIN_CLOCK_ENABLE SYSCTL_RCGCGPIO_R0
+#endif
+
+#ifndef SSI_MISOPIN_BASE
+#define SSI_MISOPIN_BASE        GPIO_PORTA_BASE
+#endif
+
+#ifndef SSI_MISOPIN_PCTL
+#define SSI_MISOPIN_PCTL        0xf
+#endif
+
+#ifndef SSI_MISOPIN_POS
+#define SSI_MISOPIN_POS         5
+#endif
+
+#ifndef SSI_MOSIPIN_CLOCK_ENABLE
+#define SSI_MOSIPIN_CLOCK_ENABLE SYSCTL_RCGCGPIO_R0
+#endif
+
+#ifndef SSI_MOSIPIN_BASE
+#define SSI_MOSIPIN_BASE        GPIO_PORTA_BASE
+#endif
+
+#ifndef SSI_MOSIPIN_PCTL
+#define SSI_MOSIPIN_PCTL        0xf
+#endif
+
+#ifndef SSI_MOSIPIN_POS
+#define SSI_MOSIPIN_POS         4
+#endif
+
+#ifndef SSI_RX_DMA_CHANNEL
+#define SSI_RX_DMA_CHANNEL      UDMA_CH10_SSI0RX
+#endif
+
+//*****************************************************************************
+//
+// The number of data bits in each SSI frame.
+//
+//*****************************************************************************
+#define DATA_BITS_SSI           8
+
+//*****************************************************************************
+//
+// Transfers of at least this many bytes are received by uDMA when
+// SSI_ENABLE_DMA is defined.  Shorter ones, such as the packet header, are
+// not worth setting up a transfer for.
+//
+//*****************************************************************************
+#define SSI_DMA_THRESHOLD       16
+
+//*****************************************************************************
+//
+// The uDMA channel number, without the peripheral assignment, of the SSI
+// receive channel.
+//
+//*****************************************************************************
+#define SSI_RX_DMA_CHANNEL_NUM  (SSI_RX_DMA_CHANNEL & 0xff)
+
+//*****************************************************************************
+//
+// This defines the SSI chip select pin that is being used by the boot loader.
+//
+//*****************************************************************************
+#define SSI_CS                  (1 << SSI_FSSPIN_POS)
+#define SSI_CS_PCTL             (SSI_FSSPIN_PCTL << (4 * SSI_FSSPIN_POS))
+
+//*****************************************************************************
+//
+// This defines the SSI clock pin that is being used by the boot loader.
+//
+//*****************************************************************************
+#define SSI_CLK                 (1 << SSI_CLKPIN_POS)
+#define SSI_CLK_PCTL            (SSI_CLKPIN_PCTL << (4 * SSI_CLKPIN_POS))
+
+//*****************************************************************************
+//
+// This defines the SSI transmit pin that is being used by the boot loader.
+//
+//*****************************************************************************
+#define SSI_TX                  (1 << SSI_MISOPIN_POS)
+#define SSI_TX_PCTL             (SSI_MISOPIN_PCTL << (4 * SSI_MISOPIN_POS))
+
+//*****************************************************************************
+//
+// This defines the SSI receive pin that is being used by the boot loader.
+//
+//*****************************************************************************
+#define SSI_RX                  (1 << SSI_MOSIPIN_POS)
+#define SSI_RX_PCTL             (SSI_MOSIPIN_PCTL << (4 * SSI_MOSIPIN_POS))
+
+//*****************************************************************************
+//
+// This defines the ready/busy handshake output, if one is being used.
+//
+//*****************************************************************************
+#ifdef SSI_READYPIN_BASE
+#define SSI_READY               (1 << SSI_READYPIN_POS)
+#endif
+
+//*****************************************************************************
+//
+// SSI Transport APIs
+//
+//*****************************************************************************
+extern void ConfigureSSI(void);
+extern uint32_t SSIPoll(void);
+extern void SSISend(const uint8_t *pui8Data, uint32_t ui32Size);
+extern void SSIWrite(const uint8_t *pui8Data, uint32_t ui32Size);
+extern void SSIReceive(uint8_t *pui8Data, uint32_t ui32Size);
+extern int SSIReceiveTimeout(uint8_t *pui8Data, uint32_t ui32Size);
+extern void SSIFlush(void);
+
+#endif // __BL_SSI_H__
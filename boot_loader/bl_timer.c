@@ -0,0 +1,185 @@
+//*****************************************************************************
+//
+// bl_timer.c - Receive timeout timer used by the boot loader.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_timer.h"
+#include "inc/hw_types.h"
+#include "bl_config.h"
+#include "boot_loader/bl_timer.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_timer_api
+//! @{
+//
+//*****************************************************************************
+#if defined(UART_ENABLE_UPDATE) || defined(SSI_ENABLE_UPDATE) || \
+    defined(DOXYGEN)
+
+//*****************************************************************************
+//
+// The number of timer clocks in one receive timeout period.
+//
+//*****************************************************************************
+static uint32_t g_ui32TimerLoad;
+
+//*****************************************************************************
+//
+// The number of SysTick counts in one microsecond.
+//
+//*****************************************************************************
+static uint32_t g_ui32TimerMHz;
+
+//*****************************************************************************
+//
+//! Configures the timer used to detect receive timeouts.
+//!
+//! \param ui32SysClock is the frequency of the system clock in Hz, or 0 if it
+//! is not known.
+//!
+//! This function enables the timer peripheral selected by \b BL_TIMER_BASE
+//! and configures it as a 32-bit one-shot down counter whose period is
+//! \b UART_RX_TIMEOUT milliseconds.  The timer is only polled; no interrupt
+//! is ever enabled.  It also starts SysTick counting freely from the system
+//! clock, without its interrupt, for BLTimerStamp() and BLTimerElapsed().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BLTimerInit(uint32_t ui32SysClock)
+{
+    //
+    // Fall back to the fastest possible clock if the actual rate is unknown.
+    //
+    if(ui32SysClock == 0)
+    {
+        ui32SysClock = BL_TIMER_DEFAULT_CLOCK;
+    }
+    g_ui32TimerLoad = (ui32SysClock / 1000) * UART_RX_TIMEOUT;
+    g_ui32TimerMHz = ui32SysClock / 1000000;
+
+    //
+    // Let SysTick count down through its full 24-bit range.
+    //
+    HWREG(NVIC_ST_CTRL) = 0;
+    HWREG(NVIC_ST_RELOAD) = NVIC_ST_RELOAD_M;
+    HWREG(NVIC_ST_CURRENT) = 0;
+    HWREG(NVIC_ST_CTRL) = NVIC_ST_CTRL_CLK_SRC | NVIC_ST_CTRL_ENABLE;
+
+    //
+    // Enable the clock to the timer module and wait for it to be ready.
+    //
+    HWREG(SYSCTL_RCGCTIMER) |= BL_TIMER_CLOCK_ENABLE;
+    while(!(HWREG(SYSCTL_PRTIMER) & BL_TIMER_CLOCK_ENABLE))
+    {
+    }
+
+    //
+    // Stop the timer and make it a full width, one-shot down counter.
+    //
+    HWREG(BL_TIMER_BASE + TIMER_O_CTL) = 0;
+    HWREG(BL_TIMER_BASE + TIMER_O_CFG) = TIMER_CFG_32_BIT_TIMER;
+    HWREG(BL_TIMER_BASE + TIMER_O_TAMR) = TIMER_TAMR_TAMR_1_SHOT;
+    HWREG(BL_TIMER_BASE + TIMER_O_IMR) = 0;
+}
+
+//*****************************************************************************
+//
+//! Starts, or restarts, a receive timeout period.
+//!
+//! This function reloads the timer with a full timeout period and clears any
+//! previous expiry so that BLTimerExpired() reports only this period.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BLTimerStart(void)
+{
+    HWREG(BL_TIMER_BASE + TIMER_O_CTL) = 0;
+    HWREG(BL_TIMER_BASE + TIMER_O_ICR) = TIMER_ICR_TATOCINT;
+    HWREG(BL_TIMER_BASE + TIMER_O_TAILR) = g_ui32TimerLoad;
+    HWREG(BL_TIMER_BASE + TIMER_O_CTL) = TIMER_CTL_TAEN;
+}
+
+//*****************************************************************************
+//
+//! Checks whether the current receive timeout period has elapsed.
+//!
+//! \return Returns a non-zero value if the period started by the last call to
+//! BLTimerStart() has elapsed and zero otherwise.
+//
+//*****************************************************************************
+uint32_t
+BLTimerExpired(void)
+{
+    return(HWREG(BL_TIMER_BASE + TIMER_O_RIS) & TIMER_RIS_TATORIS);
+}
+
+//*****************************************************************************
+//
+//! Reads the current time, for timing an operation.
+//!
+//! \return Returns the current SysTick count, to be passed to
+//! BLTimerElapsed() once the operation is complete.
+//
+//*****************************************************************************
+uint32_t
+BLTimerStamp(void)
+{
+    return(HWREG(NVIC_ST_CURRENT));
+}
+
+//*****************************************************************************
+//
+//! Returns the time elapsed since a time read by BLTimerStamp().
+//!
+//! \param ui32Stamp is the value returned by BLTimerStamp().
+//!
+//! SysTick wraps every 2^24 system clocks, about 140 ms at 120 MHz, so this
+//! times single flash operations rather than whole transfers.  If the boot
+//! loader was entered from the application with the clock unknown, times
+//! are scaled for \b BL_TIMER_DEFAULT_CLOCK and so read short.
+//!
+//! \return Returns the elapsed time in microseconds.
+//
+//*****************************************************************************
+uint32_t
+BLTimerElapsed(uint32_t ui32Stamp)
+{
+    return(((ui32Stamp - HWREG(NVIC_ST_CURRENT)) & NVIC_ST_RELOAD_M) /
+           g_ui32TimerMHz);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+#endif
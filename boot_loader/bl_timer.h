@@ -0,0 +1,67 @@
+//*****************************************************************************
+//
+// bl_timer.h - Definitions for the receive timeout timer.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_TIMER_H__
+#define __BL_TIMER_H__
+
+//*****************************************************************************
+//
+// This section maps the defines to default for the receive timeout timer for
+// projects that do not specify them in bl_config.h.
+//
+//*****************************************************************************
+#ifndef BL_TIMER_BASE
+#define BL_TIMER_BASE           TIMER0_BASE
+#endif
+
+#ifndef BL_TIMER_CLOCK_ENABLE
+#define BL_TIMER_CLOCK_ENABLE   SYSCTL_RCGCTIMER_R0
+#endif
+
+#ifndef UART_RX_TIMEOUT
+#define UART_RX_TIMEOUT         20
+#endif
+
+//*****************************************************************************
+//
+// The clock rate that is assumed when the boot loader is entered from the
+// application and the actual system clock is therefore not known.  Using the
+// fastest clock the part supports means that a slower clock only lengthens
+// the timeout, never shortens it.
+//
+//*****************************************************************************
+#define BL_TIMER_DEFAULT_CLOCK  120000000
+
+//*****************************************************************************
+//
+// Timer APIs
+//
+//*****************************************************************************
+extern void BLTimerInit(uint32_t ui32SysClock);
+extern void BLTimerStart(void);
+extern uint32_t BLTimerExpired(void);
+extern uint32_t BLTimerStamp(void);
+extern uint32_t BLTimerElapsed(uint32_t ui32Stamp);
+
+#endif // __BL_TIMER_H__
@@ -0,0 +1,222 @@
+//*****************************************************************************
+//
+// bl_transport.c - Selects the port that packets are exchanged on.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include "bl_config.h"
+#include "boot_loader/bl_loopback.h"
+#include "boot_loader/bl_ssi.h"
+#include "boot_loader/bl_transport.h"
+#include "boot_loader/bl_uart.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_transport_api
+//! @{
+//
+//*****************************************************************************
+#if defined(SSI_ENABLE_UPDATE) || defined(UART_ENABLE_UPDATE) ||            \
+    defined(DOXYGEN)
+
+//*****************************************************************************
+//
+// The packet transports that are enabled, in the order that they are polled.
+//
+//*****************************************************************************
+static const tTransport g_psTransports[] =
+{
+#ifdef UART_ENABLE_UPDATE
+    {
+        ConfigureUART, UARTPoll, UARTReceive, UARTReceiveTimeout, UARTSend,
+        UARTWrite, UARTFlush
+    },
+#endif
+#ifdef SSI_ENABLE_UPDATE
+    {
+        ConfigureSSI, SSIPoll, SSIReceive, SSIReceiveTimeout, SSISend,
+        SSIWrite, SSIFlush
+    },
+#endif
+#ifdef LOOPBACK_ENABLE_UPDATE
+    {
+        ConfigureLoopback, LoopbackPoll, LoopbackReceive,
+        LoopbackReceiveTimeout, LoopbackSend, LoopbackWrite, LoopbackFlush
+    },
+#endif
+};
+
+#define NUM_TRANSPORTS          (sizeof(g_psTransports) /                     \
+                                 sizeof(g_psTransports[0]))
+
+//*****************************************************************************
+//
+// The transport that the packet being received arrived on, and whether the
+// boot loader has locked onto it.
+//
+//*****************************************************************************
+static const tTransport *g_psTransport = g_psTransports;
+static uint32_t g_ui32Locked;
+
+//*****************************************************************************
+//
+//! Configures all of the enabled transports.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TransportInit(void)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < NUM_TRANSPORTS; ui32Idx++)
+    {
+        g_psTransports[ui32Idx].pfnInit();
+    }
+}
+
+//*****************************************************************************
+//
+//! Locks onto the transport that the last packet arrived on.
+//!
+//! This function is called once a valid packet has been received.  From then
+//! on only that transport is used, so noise on the other ports can no longer
+//! interfere with the update.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TransportLock(void)
+{
+    g_ui32Locked = 1;
+}
+
+//*****************************************************************************
+//
+//! Receives data from the transport in use.
+//!
+//! \param pui8Data is the buffer to read data into.
+//! \param ui32Size is the number of bytes to receive.
+//!
+//! This function is used to wait for the start of a packet.  Until the boot
+//! loader has locked onto a transport, every enabled transport is polled in
+//! turn and the first one to receive a byte becomes the one in use for the
+//! rest of the packet.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TransportReceive(uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint32_t ui32Idx;
+
+    if(!g_ui32Locked)
+    {
+        for(ui32Idx = 0; !g_psTransports[ui32Idx].pfnPoll(); )
+        {
+            if(++ui32Idx == NUM_TRANSPORTS)
+            {
+                ui32Idx = 0;
+            }
+        }
+        g_psTransport = &g_psTransports[ui32Idx];
+    }
+
+    g_psTransport->pfnReceive(pui8Data, ui32Size);
+}
+
+//*****************************************************************************
+//
+//! Receives data from the transport in use with an inter-byte timeout.
+//!
+//! \param pui8Data is the buffer to read data into.
+//! \param ui32Size is the number of bytes to receive.
+//!
+//! \return Returns zero if all \e ui32Size bytes were received or a negative
+//! value if the port went idle first.
+//
+//*****************************************************************************
+int
+TransportReceiveTimeout(uint8_t *pui8Data, uint32_t ui32Size)
+{
+    return(g_psTransport->pfnReceiveTimeout(pui8Data, ui32Size));
+}
+
+//*****************************************************************************
+//
+//! Sends data over the transport in use.
+//!
+//! \param pui8Data is the buffer containing the data to send.
+//! \param ui32Size is the number of bytes to send.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TransportSend(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    g_psTransport->pfnSend(pui8Data, ui32Size);
+}
+
+//*****************************************************************************
+//
+//! Queues data to be sent over the transport in use.
+//!
+//! \param pui8Data is the buffer containing the data to send.
+//! \param ui32Size is the number of bytes to send.
+//!
+//! This function returns as soon as the data is queued, so that a long reply
+//! can be sent in pieces without a break between them.  The last piece must
+//! be sent with TransportSend().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TransportWrite(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    g_psTransport->pfnWrite(pui8Data, ui32Size);
+}
+
+//*****************************************************************************
+//
+//! Waits until all data sent has left the transport in use.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+TransportFlush(void)
+{
+    g_psTransport->pfnFlush();
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+#endif
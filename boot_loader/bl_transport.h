@@ -0,0 +1,103 @@
+//*****************************************************************************
+//
+// bl_transport.h - Definitions for the packet transport layer.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_TRANSPORT_H__
+#define __BL_TRANSPORT_H__
+
+//*****************************************************************************
+//
+// The functions that a packet transport provides to the boot loader.  Any
+// number of transports can be enabled together; until a valid packet has been
+// received all of them are polled, and from then on only the one that the
+// packet arrived on is used.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // Configures the port.  This is only called when the boot loader is
+    // entered from reset, not when the application calls into it.
+    //
+    void (*pfnInit)(void);
+
+    //
+    // Returns non-zero if a received byte is waiting to be read.
+    //
+    uint32_t (*pfnPoll)(void);
+
+    //
+    // Receives the given number of bytes, waiting as long as it takes.
+    //
+    void (*pfnReceive)(uint8_t *pui8Data, uint32_t ui32Size);
+
+    //
+    // Receives the given number of bytes, returning a negative value if the
+    // port goes idle for longer than the receive timeout first.
+    //
+    int (*pfnReceiveTimeout)(uint8_t *pui8Data, uint32_t ui32Size);
+
+    //
+    // Sends the given number of bytes.
+    //
+    void (*pfnSend)(const uint8_t *pui8Data, uint32_t ui32Size);
+
+    //
+    // Queues the given number of bytes to be sent, returning once the last
+    // of them is in the transmit FIFO so that the next write follows without
+    // a break.  A reply sent this way must end with a send.
+    //
+    void (*pfnWrite)(const uint8_t *pui8Data, uint32_t ui32Size);
+
+    //
+    // Waits until all of the data sent has left the port.
+    //
+    void (*pfnFlush)(void);
+}
+tTransport;
+
+//*****************************************************************************
+//
+// Transport APIs
+//
+//*****************************************************************************
+extern void TransportInit(void);
+extern void TransportLock(void);
+extern void TransportReceive(uint8_t *pui8Data, uint32_t ui32Size);
+extern int TransportReceiveTimeout(uint8_t *pui8Data, uint32_t ui32Size);
+extern void TransportSend(const uint8_t *pui8Data, uint32_t ui32Size);
+extern void TransportWrite(const uint8_t *pui8Data, uint32_t ui32Size);
+extern void TransportFlush(void);
+
+//*****************************************************************************
+//
+// The packet layer sends and receives through whichever transport is in use.
+//
+//*****************************************************************************
+#define SendData                TransportSend
+#define WriteData               TransportWrite
+#define FlushData               TransportFlush
+#define ReceiveData             TransportReceive
+#define ReceiveDataTimeout      TransportReceiveTimeout
+
+#endif // __BL_TRANSPORT_H__
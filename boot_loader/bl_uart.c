@@ -22,6 +22,7 @@
 //
 //*****************************************************************************
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "inc/hw_gpio.h"
 #include "inc/hw_memmap.h"
@@ -29,6 +30,13 @@
 #include "inc/hw_types.h"
 #include "inc/hw_uart.h"
 #include "bl_config.h"
+#include "driverlib/gpio.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/uart.h"
+#include "boot_loader/bl_commands.h"
+#include "boot_loader/bl_packet.h"
+#include "boot_loader/bl_timer.h"
 #include "boot_loader/bl_uart.h"
 
 //*****************************************************************************
@@ -39,6 +47,61 @@
 //*****************************************************************************
 #if defined(UART_ENABLE_UPDATE) || defined(DOXYGEN)
 
+//*****************************************************************************
+//
+// The system clock frequency set up by ConfigureDevice().
+//
+//*****************************************************************************
+extern uint32_t g_ui32SysClock;
+
+//*****************************************************************************
+//
+// The baud rate that ConfigureUART() sets up, which may be changed by a
+// handoff from the application.
+//
+//*****************************************************************************
+uint32_t g_ui32UARTBaudRate = 115200;
+
+//*****************************************************************************
+//
+//! Configures the UART port for use by the boot loader.
+//!
+//! This function enables UART0 on PA0 and PA1 at 115200 baud, or at the baud
+//! rate handed off by the application, along with PA2 as the output that
+//! enables the RS-485 driver while UARTSend() is sending.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ConfigureUART(void)
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+    GPIOPinConfigure(GPIO_PA0_U0RX);
+    GPIOPinConfigure(GPIO_PA1_U0TX);
+    GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+    UARTConfigSetExpClk(UART0_BASE, g_ui32SysClock, g_ui32UARTBaudRate,
+                        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE |
+                         UART_CONFIG_PAR_NONE));
+    UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
+    GPIOPinTypeGPIOOutput(GPIO_PORTA_BASE, GPIO_PIN_2);
+}
+
+//*****************************************************************************
+//
+//! Checks whether data has been received by the UART port.
+//!
+//! \return Returns non-zero if a received byte is waiting to be read and zero
+//! otherwise.
+//
+//*****************************************************************************
+uint32_t
+UARTPoll(void)
+{
+    return(!(HWREG(UARTx_BASE + UART_O_FR) & UART_FR_RXFE));
+}
+
 //*****************************************************************************
 //
 //! Sends data over the UART port.
@@ -56,6 +119,36 @@
 //*****************************************************************************
 void
 UARTSend(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    UARTWrite(pui8Data, ui32Size);
+
+    //
+    // Wait until the UART is done transmitting.
+    //
+    UARTFlush();
+    HWREG(0x40004000 + (0x00000000 + (0x00000004 << 2))) = 0x00000000;
+
+}
+
+//*****************************************************************************
+//
+//! Queues data to be sent over the UART port.
+//!
+//! \param pui8Data is the buffer containing the data to write out to the UART
+//! port.
+//! \param ui32Size is the number of bytes provided in \e pui8Data buffer that
+//! will be written out to the UART port.
+//!
+//! This function returns as soon as the last of the data is in the transmit
+//! FIFO, leaving the transmitter enabled, so that the next call carries on
+//! without a break on the line.  The last piece of a reply is sent with
+//! UARTSend() instead, which waits for it to leave and releases the line.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+UARTWrite(const uint8_t *pui8Data, uint32_t ui32Size)
 {
     HWREG(0x40004000 + (0x00000000 + (0x00000004 << 2))) = 0x00000004;
 
@@ -76,13 +169,6 @@ UARTSend(const uint8_t *pui8Data, uint32_t ui32Size)
         //
         HWREG(UARTx_BASE + UART_O_DR) = *pui8Data++;
     }
-
-    //
-    // Wait until the UART is done transmitting.
-    //
-    UARTFlush();
-    HWREG(0x40004000 + (0x00000000 + (0x00000004 << 2))) = 0x00000000;
-
 }
 
 //*****************************************************************************
@@ -132,6 +218,19 @@ UARTFlush(void)
 void
 UARTReceive(uint8_t *pui8Data, uint32_t ui32Size)
 {
+    //
+    // Count, and clear, any overrun of the receive FIFO since the last call,
+    // as UARTRxErrorGet() and UARTRxErrorClear() would.  The boot loader
+    // waits here at the start of every packet, so this catches the overruns
+    // while the last packet was handled, when the FIFO is most likely to
+    // fill.
+    //
+    if(HWREG(UARTx_BASE + UART_O_RSR) & UART_RSR_OE)
+    {
+        g_pui32Stats[STAT_OVERRUNS]++;
+        HWREG(UARTx_BASE + UART_O_ECR) = 0;
+    }
+
     //
     // Send out the number of bytes requested.
     //
@@ -151,6 +250,50 @@ UARTReceive(uint8_t *pui8Data, uint32_t ui32Size)
     }
 }
 
+//*****************************************************************************
+//
+//! Receives data over the UART port with an inter-byte timeout.
+//!
+//! \param pui8Data is the buffer to read data into from the UART port.
+//! \param ui32Size is the number of bytes provided in the \e pui8Data buffer
+//! that should be written with data from the UART port.
+//!
+//! This function behaves like UARTReceive() except that it gives up if the
+//! gap before any one of the requested bytes exceeds \b UART_RX_TIMEOUT
+//! milliseconds.  The timeout is restarted for every byte, so a long packet
+//! sent at a slow baud rate never times out as long as it keeps arriving.
+//!
+//! \return Returns zero if all \e ui32Size bytes were received or a negative
+//! value if the line went idle first.
+//
+//*****************************************************************************
+int
+UARTReceiveTimeout(uint8_t *pui8Data, uint32_t ui32Size)
+{
+    while(ui32Size--)
+    {
+        //
+        // Wait for the FIFO to not be empty, giving up if the line stays
+        // idle for a full timeout period.
+        //
+        BLTimerStart();
+        while((HWREG(UARTx_BASE + UART_O_FR) & UART_FR_RXFE))
+        {
+            if(BLTimerExpired())
+            {
+                return(-1);
+            }
+        }
+
+        //
+        // Receive a byte from the UART.
+        //
+        *pui8Data++ = HWREG(UARTx_BASE + UART_O_DR);
+    }
+
+    return(0);
+}
+
 //*****************************************************************************
 //
 // Close the Doxygen group.
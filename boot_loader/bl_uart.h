@@ -114,20 +114,15 @@
 // UART Transport APIs
 //
 //*****************************************************************************
+extern void ConfigureUART(void);
+extern uint32_t UARTPoll(void);
 extern void UARTSend(const uint8_t *pui8Data, uint32_t ui32Size);
+extern void UARTWrite(const uint8_t *pui8Data, uint32_t ui32Size);
 extern void UARTReceive(uint8_t *pui8Data, uint32_t ui32Size);
+extern int UARTReceiveTimeout(uint8_t *pui8Data, uint32_t ui32Size);
 extern void UARTFlush(void);
 extern int UARTAutoBaud(uint32_t *pui32Ratio);
 extern int32_t UARTCharGet(uint32_t ui32Base);
-//*****************************************************************************
-//
-// Define the transport functions if the UART is being used.
-//
-//*****************************************************************************
-#ifdef UART_ENABLE_UPDATE
-#define SendData                UARTSend
-#define FlushData               UARTFlush
-#define ReceiveData             UARTReceive
-#endif
+extern uint32_t g_ui32UARTBaudRate;
 
 #endif // __BL_UART_H__
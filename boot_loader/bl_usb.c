@@ -0,0 +1,1451 @@
+//*****************************************************************************
+//
+// bl_usb.c - Functions to update via USB using the DFU class.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_flash.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_types.h"
+#include "bl_config.h"
+#include "driverlib/cpu.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/usb.h"
+#include "boot_loader/bl_flash.h"
+#include "boot_loader/bl_hooks.h"
+#include "boot_loader/bl_usb.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_usb_api
+//! @{
+//
+//*****************************************************************************
+#if defined(USB_ENABLE_UPDATE) || defined(DOXYGEN)
+
+//*****************************************************************************
+//
+// The standard USB request and descriptor values used by the device.
+//
+//*****************************************************************************
+#define USB_RTYPE_DIR_IN        0x80
+#define USB_RTYPE_TYPE_M        0x60
+#define USB_RTYPE_STANDARD      0x00
+#define USB_RTYPE_CLASS         0x20
+#define USB_RTYPE_VENDOR        0x40
+#define USB_RTYPE_RECIPIENT_M   0x1f
+#define USB_RTYPE_DEVICE        0x00
+#define USB_RTYPE_INTERFACE     0x01
+
+#define USBREQ_GET_STATUS       0x00
+#define USBREQ_CLEAR_FEATURE    0x01
+#define USBREQ_SET_FEATURE      0x03
+#define USBREQ_SET_ADDRESS      0x05
+#define USBREQ_GET_DESCRIPTOR   0x06
+#define USBREQ_GET_CONFIG       0x08
+#define USBREQ_SET_CONFIG       0x09
+#define USBREQ_GET_INTERFACE    0x0a
+#define USBREQ_SET_INTERFACE    0x0b
+
+#define USB_DTYPE_DEVICE        1
+#define USB_DTYPE_CONFIGURATION 2
+#define USB_DTYPE_STRING        3
+#define USB_DTYPE_INTERFACE     4
+#define USB_DTYPE_ENDPOINT      5
+#define USB_DTYPE_DFU_FUNCTION  0x21
+
+//*****************************************************************************
+//
+// The DFU class requests, states and status codes (DFU 1.1).
+//
+//*****************************************************************************
+#define DFU_REQ_DETACH          0
+#define DFU_REQ_DNLOAD          1
+#define DFU_REQ_UPLOAD          2
+#define DFU_REQ_GETSTATUS       3
+#define DFU_REQ_CLRSTATUS       4
+#define DFU_REQ_GETSTATE        5
+#define DFU_REQ_ABORT           6
+
+#define DFU_STATE_IDLE          2
+#define DFU_STATE_DNLOAD_SYNC   3
+#define DFU_STATE_DNBUSY        4
+#define DFU_STATE_DNLOAD_IDLE   5
+#define DFU_STATE_MANIFEST_SYNC 6
+#define DFU_STATE_MANIFEST      7
+#define DFU_STATE_UPLOAD_IDLE   9
+#define DFU_STATE_ERROR         10
+
+#define DFU_STATUS_OK           0x00
+#define DFU_STATUS_ERR_WRITE    0x03
+#define DFU_STATUS_ERR_ERASE    0x04
+#define DFU_STATUS_ERR_PROG     0x06
+#define DFU_STATUS_ERR_ADDRESS  0x08
+#define DFU_STATUS_ERR_STALLED  0x0f
+
+//*****************************************************************************
+//
+// The DFU functional attributes.  Upload is not offered when the flash
+// contents are meant to be protected.
+//
+//*****************************************************************************
+#define DFU_ATTR_CAN_DNLOAD     0x01
+#define DFU_ATTR_CAN_UPLOAD     0x02
+#define DFU_ATTR_WILL_DETACH    0x08
+#ifdef FLASH_CODE_PROTECTION
+#define DFU_ATTRIBUTES          (DFU_ATTR_WILL_DETACH | DFU_ATTR_CAN_DNLOAD)
+#else
+#define DFU_ATTRIBUTES          (DFU_ATTR_WILL_DETACH | DFU_ATTR_CAN_UPLOAD | \
+                                 DFU_ATTR_CAN_DNLOAD)
+#endif
+
+//*****************************************************************************
+//
+// The states of the endpoint 0 control transfer state machine.
+//
+//*****************************************************************************
+#define EP0_STATE_IDLE          0
+#define EP0_STATE_TX            1
+#define EP0_STATE_RX            2
+#define EP0_STATE_STATUS        3
+#define EP0_STATE_STALL         4
+
+//*****************************************************************************
+//
+// The integrated USB DMA channel used by the bulk download endpoint.
+//
+//*****************************************************************************
+#define USB_BULK_DMA_CHANNEL    0
+
+//*****************************************************************************
+//
+// The device descriptor.
+//
+//*****************************************************************************
+static const uint8_t g_pui8DeviceDescriptor[] =
+{
+    18, USB_DTYPE_DEVICE,
+    0x00, 0x02,                         // USB 2.0
+    0x00, 0x00, 0x00,                   // Class defined by the interface
+    USB_EP0_MAX_PACKET,
+    (USB_VENDOR_ID & 0xff), (USB_VENDOR_ID >> 8),
+    (USB_PRODUCT_ID & 0xff), (USB_PRODUCT_ID >> 8),
+    (USB_DEVICE_ID & 0xff), (USB_DEVICE_ID >> 8),
+    1, 2, 0,                            // Manufacturer, product, serial
+    1                                   // One configuration
+};
+
+//*****************************************************************************
+//
+// The configuration descriptor, holding a single DFU mode interface.  When
+// bulk downloads are enabled, the interface also carries the bulk OUT
+// endpoint that feeds the flash through the integrated USB DMA controller.
+//
+//*****************************************************************************
+#ifdef USB_ENABLE_BULK_DMA
+#define USB_CONFIG_SIZE         (9 + 9 + 9 + 7)
+#else
+#define USB_CONFIG_SIZE         (9 + 9 + 9)
+#endif
+
+static const uint8_t g_pui8ConfigDescriptor[] =
+{
+    9, USB_DTYPE_CONFIGURATION,
+    USB_CONFIG_SIZE, 0,
+    1,                                  // One interface
+    1,                                  // Configuration value
+    0,                                  // No string
+#if USB_BUS_POWERED
+    0x80,
+#else
+    0xc0,
+#endif
+    (USB_MAX_POWER / 2),
+
+    9, USB_DTYPE_INTERFACE,
+    0,                                  // Interface number
+    0,                                  // Alternate setting
+#ifdef USB_ENABLE_BULK_DMA
+    1,                                  // One endpoint
+#else
+    0,                                  // No endpoints
+#endif
+    0xfe, 0x01, 0x02,                   // Application specific, DFU mode
+    0,                                  // No string
+
+    9, USB_DTYPE_DFU_FUNCTION,
+    DFU_ATTRIBUTES,
+    0xe8, 0x03,                         // 1000 ms detach timeout
+    (USB_DFU_TRANSFER_SIZE & 0xff), (USB_DFU_TRANSFER_SIZE >> 8),
+    0x10, 0x01,                         // DFU 1.1
+
+#ifdef USB_ENABLE_BULK_DMA
+    7, USB_DTYPE_ENDPOINT,
+    0x01,                               // Endpoint 1 OUT
+    0x02,                               // Bulk
+    USB_BULK_MAX_PACKET, 0,
+    0
+#endif
+};
+
+//*****************************************************************************
+//
+// The string descriptors.
+//
+//*****************************************************************************
+static const uint8_t g_pui8LangID[] =
+{
+    4, USB_DTYPE_STRING,
+    0x09, 0x04                          // US English
+};
+
+static const uint8_t g_pui8Manufacturer[] =
+{
+    62, USB_DTYPE_STRING,
+    'T', 0, 'e', 0, 'x', 0, 'a', 0, 's', 0, ' ', 0,
+    'I', 0, 'n', 0, 's', 0, 't', 0, 'r', 0, 'u', 0,
+    'm', 0, 'e', 0, 'n', 0, 't', 0, 's', 0, ' ', 0,
+    'I', 0, 'n', 0, 'c', 0, 'o', 0, 'r', 0, 'p', 0,
+    'o', 0, 'r', 0, 'a', 0, 't', 0, 'e', 0, 'd', 0,
+};
+
+static const uint8_t g_pui8Product[] =
+{
+    48, USB_DTYPE_STRING,
+    'D', 0, 'e', 0, 'v', 0, 'i', 0, 'c', 0, 'e', 0,
+    ' ', 0, 'F', 0, 'i', 0, 'r', 0, 'm', 0, 'w', 0,
+    'a', 0, 'r', 0, 'e', 0, ' ', 0, 'U', 0, 'p', 0,
+    'g', 0, 'r', 0, 'a', 0, 'd', 0, 'e', 0,
+};
+
+static const uint8_t * const g_ppui8Strings[] =
+{
+    g_pui8LangID,
+    g_pui8Manufacturer,
+    g_pui8Product
+};
+
+//*****************************************************************************
+//
+// The state of the endpoint 0 control transfer in progress.
+//
+//*****************************************************************************
+static volatile uint32_t g_ui32EP0State;
+static const uint8_t *g_pui8EP0TxData;
+static uint8_t *g_pui8EP0RxData;
+static uint32_t g_ui32EP0Remaining;
+static bool g_bEP0SendZLP;
+static uint32_t g_ui32EP0Request;
+static uint32_t g_ui32PendingAddress;
+static uint8_t g_ui8Configuration;
+static uint8_t g_pui8EP0Reply[6];
+
+//*****************************************************************************
+//
+// The last setup packet received.
+//
+//*****************************************************************************
+static uint32_t g_pui32Setup[2];
+
+//*****************************************************************************
+//
+// The DFU state and status reported to the host.
+//
+//*****************************************************************************
+static volatile uint8_t g_ui8DFUState;
+static volatile uint8_t g_ui8DFUStatus;
+
+//*****************************************************************************
+//
+// A word aligned buffer holding the DFU download block waiting to be
+// programmed, along with the state of the download.  The interrupt handler
+// fills the buffer and the main loop programs it, so that the control
+// endpoint keeps answering status requests while flash is busy.
+//
+//*****************************************************************************
+static uint32_t g_pui32DFUBuffer[USB_DFU_TRANSFER_SIZE / 4];
+static volatile uint32_t g_ui32DFUBlockSize;
+static volatile bool g_bDFUBlockPending;
+static volatile bool g_bDFUNewImage;
+static uint32_t g_ui32DFUAddress;
+static uint32_t g_ui32UploadOffset;
+
+//*****************************************************************************
+//
+// The start of the image being written and the end of the flash that has been
+// erased for it.
+//
+//*****************************************************************************
+static uint32_t g_ui32ImageStart;
+static uint32_t g_ui32EraseEnd;
+
+#ifdef USB_ENABLE_BULK_DMA
+//*****************************************************************************
+//
+// The state of a bulk download.  The DMA controller fills one buffer while
+// the main loop programs the other.  A non-zero count marks a buffer as full.
+//
+//*****************************************************************************
+static uint32_t g_ppui32BulkBuffer[2][USB_BULK_BUFFER_SIZE / 4];
+static volatile uint32_t g_pui32BulkCount[2];
+static uint32_t g_pui32BulkRequest[2];
+static volatile bool g_bBulkStart;
+static volatile bool g_bBulkActive;
+static volatile bool g_bBulkArmed;
+static uint32_t g_ui32BulkArmIndex;
+static uint32_t g_ui32BulkArmSize;
+static uint32_t g_ui32BulkProgIndex;
+static uint32_t g_ui32BulkRemaining;
+static uint32_t g_ui32BulkAddress;
+static uint32_t g_ui32BulkTotal;
+#endif
+
+//*****************************************************************************
+//
+// The system clock frequency.
+//
+//*****************************************************************************
+static uint32_t g_ui32USBSysClock;
+
+//*****************************************************************************
+//
+// Stalls endpoint 0, ending the current control transfer.
+//
+//*****************************************************************************
+static void
+EP0Stall(void)
+{
+    USBDevEndpointStall(USB0_BASE, USB_EP_0, USB_EP_DEV_OUT);
+    g_ui32EP0State = EP0_STATE_STALL;
+}
+
+//*****************************************************************************
+//
+// Loads the next packet of an IN data stage into the endpoint 0 FIFO.
+//
+//*****************************************************************************
+static void
+EP0SendPacket(void)
+{
+    uint32_t ui32Size;
+
+    ui32Size = g_ui32EP0Remaining;
+    if(ui32Size > USB_EP0_MAX_PACKET)
+    {
+        ui32Size = USB_EP0_MAX_PACKET;
+    }
+
+    USBEndpointDataPut(USB0_BASE, USB_EP_0, (uint8_t *)g_pui8EP0TxData,
+                       ui32Size);
+    g_pui8EP0TxData += ui32Size;
+    g_ui32EP0Remaining -= ui32Size;
+
+    //
+    // A full packet is followed by another one, which is zero length if the
+    // reply is shorter than the host asked for and ends on a packet boundary.
+    //
+    if((ui32Size == USB_EP0_MAX_PACKET) &&
+       (g_ui32EP0Remaining || g_bEP0SendZLP))
+    {
+        if(g_ui32EP0Remaining == 0)
+        {
+            g_bEP0SendZLP = false;
+        }
+        USBEndpointDataSend(USB0_BASE, USB_EP_0, USB_TRANS_IN);
+        g_ui32EP0State = EP0_STATE_TX;
+    }
+    else
+    {
+        USBEndpointDataSend(USB0_BASE, USB_EP_0, USB_TRANS_IN_LAST);
+        g_ui32EP0State = EP0_STATE_STATUS;
+    }
+}
+
+//*****************************************************************************
+//
+// Starts the IN data stage of a control transfer, truncating the reply to the
+// length requested by the host.
+//
+//*****************************************************************************
+static void
+EP0Send(const uint8_t *pui8Data, uint32_t ui32Size, uint32_t ui32Requested)
+{
+    if(ui32Size > ui32Requested)
+    {
+        ui32Size = ui32Requested;
+    }
+
+    USBDevEndpointDataAck(USB0_BASE, USB_EP_0, false);
+    g_pui8EP0TxData = pui8Data;
+    g_ui32EP0Remaining = ui32Size;
+    g_bEP0SendZLP = ((ui32Size < ui32Requested) &&
+                     ((ui32Size % USB_EP0_MAX_PACKET) == 0));
+    EP0SendPacket();
+}
+
+//*****************************************************************************
+//
+// Starts the OUT data stage of a control transfer.
+//
+//*****************************************************************************
+static void
+EP0Receive(uint8_t *pui8Data, uint32_t ui32Size, uint32_t ui32Request)
+{
+    USBDevEndpointDataAck(USB0_BASE, USB_EP_0, false);
+    g_pui8EP0RxData = pui8Data;
+    g_ui32EP0Remaining = ui32Size;
+    g_ui32EP0Request = ui32Request;
+    g_ui32EP0State = EP0_STATE_RX;
+}
+
+//*****************************************************************************
+//
+// Completes a control transfer that has no data stage.
+//
+//*****************************************************************************
+static void
+EP0Ack(void)
+{
+    USBDevEndpointDataAck(USB0_BASE, USB_EP_0, true);
+    g_ui32EP0State = EP0_STATE_STATUS;
+}
+
+//*****************************************************************************
+//
+// Moves the DFU interface to the error state.
+//
+//*****************************************************************************
+static void
+DFUError(uint8_t ui8Status)
+{
+    g_ui8DFUStatus = ui8Status;
+    g_ui8DFUState = DFU_STATE_ERROR;
+}
+
+#ifdef USB_ENABLE_BULK_DMA
+//*****************************************************************************
+//
+// Stops a bulk download, abandoning any data still in flight.
+//
+//*****************************************************************************
+static void
+BulkStop(void)
+{
+    USBDMAChannelDisable(USB0_BASE, USB_BULK_DMA_CHANNEL);
+    USBFIFOFlush(USB0_BASE, USB_EP_1, USB_EP_DEV_OUT);
+    g_bBulkStart = false;
+    g_bBulkActive = false;
+    g_bBulkArmed = false;
+    g_pui32BulkCount[0] = 0;
+    g_pui32BulkCount[1] = 0;
+}
+
+//*****************************************************************************
+//
+// Handles the data stage of a bulk download request, which gives the address
+// and the length of the data that follows on the bulk endpoint.  The length
+// must be a whole number of packets so that every DMA transfer ends on a
+// packet boundary.
+//
+//*****************************************************************************
+static void
+BulkRequest(void)
+{
+    uint32_t ui32Address, ui32Length;
+
+    ui32Address = g_pui32BulkRequest[0];
+    ui32Length = g_pui32BulkRequest[1];
+
+    if((ui32Length == 0) || (ui32Length % USB_BULK_MAX_PACKET) ||
+       (ui32Address % BL_FLASH_ERASE_SIZE) ||
+       !BL_FLASH_AD_CHECK_FN_HOOK(ui32Address, ui32Length))
+    {
+        DFUError(DFU_STATUS_ERR_ADDRESS);
+        return;
+    }
+
+    g_ui32BulkAddress = ui32Address;
+    g_ui32BulkRemaining = ui32Length;
+    g_ui32BulkTotal = ui32Length;
+    g_bBulkStart = true;
+    g_ui8DFUState = DFU_STATE_DNBUSY;
+}
+#endif
+
+//*****************************************************************************
+//
+// Handles the completion of the data stage of an OUT control transfer.
+//
+//*****************************************************************************
+static void
+EP0DataReceived(void)
+{
+    if(g_ui32EP0Request == DFU_REQ_DNLOAD)
+    {
+        g_bDFUBlockPending = true;
+        g_ui8DFUState = DFU_STATE_DNLOAD_SYNC;
+    }
+#ifdef USB_ENABLE_BULK_DMA
+    else if(g_ui32EP0Request == USB_REQ_BULK_DOWNLOAD)
+    {
+        BulkRequest();
+    }
+#endif
+}
+
+//*****************************************************************************
+//
+// Handles the standard device requests needed for enumeration.
+//
+//*****************************************************************************
+static void
+StandardRequest(uint8_t ui8Request, uint16_t ui16Value, uint16_t ui16Length)
+{
+    switch(ui8Request)
+    {
+        case USBREQ_GET_STATUS:
+        {
+            g_pui8EP0Reply[0] = USB_BUS_POWERED ? 0 : 1;
+            g_pui8EP0Reply[1] = 0;
+            EP0Send(g_pui8EP0Reply, 2, ui16Length);
+            break;
+        }
+
+        case USBREQ_CLEAR_FEATURE:
+        case USBREQ_SET_FEATURE:
+        {
+            EP0Ack();
+            break;
+        }
+
+        case USBREQ_SET_ADDRESS:
+        {
+            //
+            // The new address takes effect once the status stage is over.
+            //
+            g_ui32PendingAddress = 0x80000000 | (ui16Value & 0x7f);
+            EP0Ack();
+            break;
+        }
+
+        case USBREQ_GET_DESCRIPTOR:
+        {
+            if((ui16Value >> 8) == USB_DTYPE_DEVICE)
+            {
+                EP0Send(g_pui8DeviceDescriptor,
+                        sizeof(g_pui8DeviceDescriptor), ui16Length);
+            }
+            else if((ui16Value >> 8) == USB_DTYPE_CONFIGURATION)
+            {
+                EP0Send(g_pui8ConfigDescriptor,
+                        sizeof(g_pui8ConfigDescriptor), ui16Length);
+            }
+            else if(((ui16Value >> 8) == USB_DTYPE_STRING) &&
+                    ((ui16Value & 0xff) < 3))
+            {
+                EP0Send(g_ppui8Strings[ui16Value & 0xff],
+                        g_ppui8Strings[ui16Value & 0xff][0], ui16Length);
+            }
+            else
+            {
+                EP0Stall();
+            }
+            break;
+        }
+
+        case USBREQ_GET_CONFIG:
+        {
+            g_pui8EP0Reply[0] = g_ui8Configuration;
+            EP0Send(g_pui8EP0Reply, 1, ui16Length);
+            break;
+        }
+
+        case USBREQ_SET_CONFIG:
+        {
+            if(ui16Value > 1)
+            {
+                EP0Stall();
+                break;
+            }
+            g_ui8Configuration = ui16Value;
+            EP0Ack();
+            break;
+        }
+
+        case USBREQ_GET_INTERFACE:
+        {
+            g_pui8EP0Reply[0] = 0;
+            EP0Send(g_pui8EP0Reply, 1, ui16Length);
+            break;
+        }
+
+        case USBREQ_SET_INTERFACE:
+        {
+            if(ui16Value != 0)
+            {
+                EP0Stall();
+                break;
+            }
+            EP0Ack();
+            break;
+        }
+
+        default:
+        {
+            EP0Stall();
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Handles the DFU class requests.
+//
+//*****************************************************************************
+static void
+DFURequest(uint8_t ui8Request, uint16_t ui16Length)
+{
+    uint32_t ui32Timeout;
+
+    switch(ui8Request)
+    {
+        case DFU_REQ_DNLOAD:
+        {
+            if((g_ui8DFUState != DFU_STATE_IDLE) &&
+               (g_ui8DFUState != DFU_STATE_DNLOAD_IDLE))
+            {
+                break;
+            }
+
+            //
+            // A zero length download ends the transfer.
+            //
+            if(ui16Length == 0)
+            {
+                if(g_ui8DFUState != DFU_STATE_DNLOAD_IDLE)
+                {
+                    break;
+                }
+                g_ui8DFUState = DFU_STATE_MANIFEST_SYNC;
+                EP0Ack();
+                return;
+            }
+            if(ui16Length > USB_DFU_TRANSFER_SIZE)
+            {
+                break;
+            }
+
+            if(g_ui8DFUState == DFU_STATE_IDLE)
+            {
+                g_bDFUNewImage = true;
+            }
+            g_ui32DFUBlockSize = ui16Length;
+            EP0Receive((uint8_t *)g_pui32DFUBuffer, ui16Length,
+                       DFU_REQ_DNLOAD);
+            return;
+        }
+
+#ifndef FLASH_CODE_PROTECTION
+        case DFU_REQ_UPLOAD:
+        {
+            uint32_t ui32Start, ui32Size;
+
+            if(g_ui8DFUState == DFU_STATE_IDLE)
+            {
+                g_ui32UploadOffset = 0;
+            }
+            else if(g_ui8DFUState != DFU_STATE_UPLOAD_IDLE)
+            {
+                break;
+            }
+
+            //
+            // Send the application image straight from flash.  A short reply
+            // tells the host that the end of flash has been reached.
+            //
+            ui32Start = APP_START_ADDRESS + g_ui32UploadOffset;
+            ui32Size = BL_FLASH_SIZE_FN_HOOK() - ui32Start;
+            if(ui32Size < ui16Length)
+            {
+                g_ui8DFUState = DFU_STATE_IDLE;
+            }
+            else
+            {
+                ui32Size = ui16Length;
+                g_ui8DFUState = DFU_STATE_UPLOAD_IDLE;
+            }
+            g_ui32UploadOffset += ui32Size;
+            EP0Send((const uint8_t *)(uintptr_t)ui32Start, ui32Size,
+                    ui16Length);
+            return;
+        }
+#endif
+
+        case DFU_REQ_GETSTATUS:
+        {
+            ui32Timeout = 0;
+            if((g_ui8DFUState == DFU_STATE_DNLOAD_SYNC) ||
+               (g_ui8DFUState == DFU_STATE_DNBUSY))
+            {
+                //
+                // Keep the host polling until the main loop has finished
+                // with the block.
+                //
+#ifdef USB_ENABLE_BULK_DMA
+                if(g_bDFUBlockPending || g_bBulkStart || g_bBulkActive)
+#else
+                if(g_bDFUBlockPending)
+#endif
+                {
+                    g_ui8DFUState = DFU_STATE_DNBUSY;
+                    ui32Timeout = USB_POLL_TIMEOUT;
+                }
+                else
+                {
+                    g_ui8DFUState = DFU_STATE_DNLOAD_IDLE;
+                }
+            }
+            else if(g_ui8DFUState == DFU_STATE_MANIFEST_SYNC)
+            {
+                //
+                // The device resets itself once this reply has been sent.
+                //
+                g_ui8DFUState = DFU_STATE_MANIFEST;
+                ui32Timeout = USB_POLL_TIMEOUT;
+            }
+
+            g_pui8EP0Reply[0] = g_ui8DFUStatus;
+            g_pui8EP0Reply[1] = ui32Timeout;
+            g_pui8EP0Reply[2] = ui32Timeout >> 8;
+            g_pui8EP0Reply[3] = ui32Timeout >> 16;
+            g_pui8EP0Reply[4] = g_ui8DFUState;
+            g_pui8EP0Reply[5] = 0;
+            EP0Send(g_pui8EP0Reply, 6, ui16Length);
+            return;
+        }
+
+        case DFU_REQ_CLRSTATUS:
+        {
+            if(g_ui8DFUState != DFU_STATE_ERROR)
+            {
+                break;
+            }
+            g_ui8DFUStatus = DFU_STATUS_OK;
+            g_ui8DFUState = DFU_STATE_IDLE;
+            EP0Ack();
+            return;
+        }
+
+        case DFU_REQ_GETSTATE:
+        {
+            g_pui8EP0Reply[0] = g_ui8DFUState;
+            EP0Send(g_pui8EP0Reply, 1, ui16Length);
+            return;
+        }
+
+        case DFU_REQ_ABORT:
+        {
+            if((g_ui8DFUState == DFU_STATE_DNBUSY) ||
+               (g_ui8DFUState == DFU_STATE_MANIFEST) ||
+               (g_ui8DFUState == DFU_STATE_ERROR))
+            {
+                break;
+            }
+            g_ui8DFUState = DFU_STATE_IDLE;
+            EP0Ack();
+            return;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+
+    //
+    // The request is not valid in the current state.
+    //
+    EP0Stall();
+    DFUError(DFU_STATUS_ERR_STALLED);
+}
+
+//*****************************************************************************
+//
+// Reads a setup packet from endpoint 0 and dispatches it.
+//
+//*****************************************************************************
+static void
+EP0RequestHandler(void)
+{
+    uint8_t *pui8Setup;
+    uint32_t ui32Size;
+    uint16_t ui16Value, ui16Index, ui16Length;
+
+    pui8Setup = (uint8_t *)g_pui32Setup;
+    ui32Size = 8;
+    USBEndpointDataGet(USB0_BASE, USB_EP_0, pui8Setup, &ui32Size);
+    if(ui32Size != 8)
+    {
+        EP0Stall();
+        return;
+    }
+    ui16Value = pui8Setup[2] | (pui8Setup[3] << 8);
+    ui16Index = pui8Setup[4] | (pui8Setup[5] << 8);
+    ui16Length = pui8Setup[6] | (pui8Setup[7] << 8);
+
+    switch(pui8Setup[0] & USB_RTYPE_TYPE_M)
+    {
+        case USB_RTYPE_STANDARD:
+        {
+            StandardRequest(pui8Setup[1], ui16Value, ui16Length);
+            break;
+        }
+
+        case USB_RTYPE_CLASS:
+        {
+            if(((pui8Setup[0] & USB_RTYPE_RECIPIENT_M) !=
+                USB_RTYPE_INTERFACE) || (ui16Index != 0))
+            {
+                EP0Stall();
+                break;
+            }
+            DFURequest(pui8Setup[1], ui16Length);
+            break;
+        }
+
+#ifdef USB_ENABLE_BULK_DMA
+        case USB_RTYPE_VENDOR:
+        {
+            if((pui8Setup[1] != USB_REQ_BULK_DOWNLOAD) || (ui16Length != 8) ||
+               (pui8Setup[0] & USB_RTYPE_DIR_IN) ||
+               ((g_ui8DFUState != DFU_STATE_IDLE) &&
+                (g_ui8DFUState != DFU_STATE_DNLOAD_IDLE)))
+            {
+                EP0Stall();
+                break;
+            }
+            EP0Receive((uint8_t *)g_pui32BulkRequest, 8,
+                       USB_REQ_BULK_DOWNLOAD);
+            break;
+        }
+#endif
+
+        default:
+        {
+            EP0Stall();
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Handles an endpoint 0 interrupt, advancing the control transfer state
+// machine.
+//
+//*****************************************************************************
+static void
+EP0Handler(void)
+{
+    uint32_t ui32Status, ui32Size;
+
+    ui32Status = USBEndpointStatus(USB0_BASE, USB_EP_0);
+
+    //
+    // A stall has been sent, or the host has ended the transfer early.
+    //
+    if(ui32Status & USB_DEV_EP0_SENT_STALL)
+    {
+        USBDevEndpointStatusClear(USB0_BASE, USB_EP_0, USB_DEV_EP0_SENT_STALL);
+        g_ui32EP0State = EP0_STATE_IDLE;
+        return;
+    }
+    if(ui32Status & USB_DEV_EP0_SETUP_END)
+    {
+        USBDevEndpointStatusClear(USB0_BASE, USB_EP_0, USB_DEV_EP0_SETUP_END);
+        g_ui32EP0State = EP0_STATE_IDLE;
+    }
+
+    switch(g_ui32EP0State)
+    {
+        case EP0_STATE_STATUS:
+        {
+            //
+            // The status stage is over, so a new address can now be used.
+            //
+            if(g_ui32PendingAddress)
+            {
+                USBDevAddrSet(USB0_BASE, g_ui32PendingAddress & 0x7f);
+                g_ui32PendingAddress = 0;
+            }
+            g_ui32EP0State = EP0_STATE_IDLE;
+            if(ui32Status & USB_DEV_EP0_OUT_PKTRDY)
+            {
+                EP0RequestHandler();
+            }
+            break;
+        }
+
+        case EP0_STATE_TX:
+        {
+            EP0SendPacket();
+            break;
+        }
+
+        case EP0_STATE_RX:
+        {
+            if(!(ui32Status & USB_DEV_EP0_OUT_PKTRDY))
+            {
+                break;
+            }
+            ui32Size = g_ui32EP0Remaining;
+            USBEndpointDataGet(USB0_BASE, USB_EP_0, g_pui8EP0RxData,
+                               &ui32Size);
+            g_pui8EP0RxData += ui32Size;
+            g_ui32EP0Remaining -= ui32Size;
+            if(g_ui32EP0Remaining && (ui32Size == USB_EP0_MAX_PACKET))
+            {
+                USBDevEndpointDataAck(USB0_BASE, USB_EP_0, false);
+            }
+            else
+            {
+                EP0Ack();
+                if(g_ui32EP0Remaining == 0)
+                {
+                    EP0DataReceived();
+                }
+            }
+            break;
+        }
+
+        default:
+        {
+            if(ui32Status & USB_DEV_EP0_OUT_PKTRDY)
+            {
+                EP0RequestHandler();
+            }
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Handles the USB controller interrupt.
+//!
+//! This function services bus resets, the endpoint 0 control transfers and,
+//! when bulk downloads are enabled, the completion of each DMA transfer from
+//! the bulk endpoint.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+USB0DeviceIntHandler(void)
+{
+    uint32_t ui32Status;
+
+    ui32Status = USBIntStatusControl(USB0_BASE);
+    if(ui32Status & USB_INTCTRL_RESET)
+    {
+        g_ui32EP0State = EP0_STATE_IDLE;
+        g_ui32PendingAddress = 0;
+        g_ui8Configuration = 0;
+    }
+
+    ui32Status = USBIntStatusEndpoint(USB0_BASE);
+    if(ui32Status & USB_INTEP_0)
+    {
+        EP0Handler();
+    }
+
+#ifdef USB_ENABLE_BULK_DMA
+    //
+    // Hand the buffer that has just been filled to the main loop.
+    //
+    if(USBDMAChannelIntStatus(USB0_BASE) & USB_DMA_INT_CH1)
+    {
+        if(USBDMAChannelStatus(USB0_BASE, USB_BULK_DMA_CHANNEL) &
+           USB_DMA_STATUS_ERROR)
+        {
+            USBDMAChannelStatusClear(USB0_BASE, USB_BULK_DMA_CHANNEL,
+                                     USB_DMA_STATUS_ERROR);
+            BulkStop();
+            DFUError(DFU_STATUS_ERR_WRITE);
+        }
+        else
+        {
+            g_pui32BulkCount[g_ui32BulkArmIndex] = g_ui32BulkArmSize;
+            g_bBulkArmed = false;
+        }
+    }
+#endif
+}
+
+//*****************************************************************************
+//
+// Prepares to write a new image at the given address.  Flash is erased as the
+// image grows, unless the whole application area is to be cleared first.
+//
+//*****************************************************************************
+static uint32_t
+ImageStart(uint32_t ui32Address)
+{
+#ifdef FLASH_CODE_PROTECTION
+    uint32_t ui32End;
+#endif
+
+    g_ui32ImageStart = ui32Address;
+    g_ui32EraseEnd = ui32Address;
+
+#ifdef FLASH_CODE_PROTECTION
+    if(ui32Address == APP_START_ADDRESS)
+    {
+        ui32End = BL_FLASH_SIZE_FN_HOOK();
+#ifdef FLASH_RSVD_SPACE
+        ui32End -= FLASH_RSVD_SPACE;
+#endif
+        BL_FLASH_CL_ERR_FN_HOOK();
+        while(g_ui32EraseEnd < ui32End)
+        {
+            BL_FLASH_ERASE_FN_HOOK(g_ui32EraseEnd);
+            g_ui32EraseEnd += BL_FLASH_ERASE_SIZE;
+        }
+        if(BL_FLASH_ERROR_FN_HOOK())
+        {
+            return(DFU_STATUS_ERR_ERASE);
+        }
+    }
+#endif
+
+#ifdef BL_START_FN_HOOK
+    BL_START_FN_HOOK();
+#endif
+
+    return(DFU_STATUS_OK);
+}
+
+//*****************************************************************************
+//
+// Programs a word aligned block of the image into flash, erasing ahead of it
+// as required.
+//
+//*****************************************************************************
+static uint32_t
+ImageProgram(uint32_t ui32Address, uint8_t *pui8Data, uint32_t ui32Size)
+{
+    if(!BL_FLASH_AD_CHECK_FN_HOOK(g_ui32ImageStart,
+                                  ui32Address + ui32Size - g_ui32ImageStart))
+    {
+        return(DFU_STATUS_ERR_ADDRESS);
+    }
+
+    BL_FLASH_CL_ERR_FN_HOOK();
+    while(g_ui32EraseEnd < (ui32Address + ui32Size))
+    {
+        BL_FLASH_ERASE_FN_HOOK(g_ui32EraseEnd);
+        g_ui32EraseEnd += BL_FLASH_ERASE_SIZE;
+    }
+    if(BL_FLASH_ERROR_FN_HOOK())
+    {
+        return(DFU_STATUS_ERR_ERASE);
+    }
+
+#ifdef BL_DECRYPT_FN_HOOK
+    BL_DECRYPT_FN_HOOK(pui8Data, ui32Size);
+#endif
+
+    BL_FLASH_PROGRAM_FN_HOOK(ui32Address, pui8Data, ui32Size);
+    if(BL_FLASH_ERROR_FN_HOOK())
+    {
+        return(DFU_STATUS_ERR_PROG);
+    }
+
+    return(DFU_STATUS_OK);
+}
+
+//*****************************************************************************
+//
+// Programs the DFU download block received by the interrupt handler.
+//
+//*****************************************************************************
+static void
+DFUBlockProgram(void)
+{
+    uint32_t ui32Size, ui32Status;
+
+    ui32Status = DFU_STATUS_OK;
+    if(g_bDFUNewImage)
+    {
+        g_bDFUNewImage = false;
+        g_ui32DFUAddress = APP_START_ADDRESS;
+        ui32Status = ImageStart(APP_START_ADDRESS);
+    }
+
+    //
+    // Pad the last word of a short block with the erased value.
+    //
+    for(ui32Size = g_ui32DFUBlockSize; ui32Size & 3; ui32Size++)
+    {
+        ((uint8_t *)g_pui32DFUBuffer)[ui32Size] = 0xff;
+    }
+
+    if(ui32Status == DFU_STATUS_OK)
+    {
+        ui32Status = ImageProgram(g_ui32DFUAddress,
+                                  (uint8_t *)g_pui32DFUBuffer, ui32Size);
+    }
+    if(ui32Status != DFU_STATUS_OK)
+    {
+        DFUError(ui32Status);
+    }
+    else
+    {
+        g_ui32DFUAddress += g_ui32DFUBlockSize;
+
+#ifdef BL_PROGRESS_FN_HOOK
+        BL_PROGRESS_FN_HOOK(g_ui32DFUAddress - g_ui32ImageStart, 0);
+#endif
+    }
+
+    g_bDFUBlockPending = false;
+}
+
+#ifdef USB_ENABLE_BULK_DMA
+//*****************************************************************************
+//
+// Advances a bulk download.  The next DMA transfer is started before the
+// buffer that has just been filled is programmed, so USB reception and flash
+// programming overlap.
+//
+//*****************************************************************************
+static void
+BulkService(void)
+{
+    uint32_t ui32Status, ui32Index;
+
+    if(g_bBulkStart)
+    {
+        g_bBulkStart = false;
+        g_ui32BulkArmIndex = 1;
+        g_ui32BulkProgIndex = 0;
+        ui32Status = ImageStart(g_ui32BulkAddress);
+        if(ui32Status != DFU_STATUS_OK)
+        {
+            DFUError(ui32Status);
+            return;
+        }
+        g_bBulkActive = true;
+    }
+    if(!g_bBulkActive)
+    {
+        return;
+    }
+
+    //
+    // Point the DMA channel at the next free buffer.
+    //
+    ui32Index = g_ui32BulkArmIndex ^ 1;
+    if(!g_bBulkArmed && g_ui32BulkRemaining && !g_pui32BulkCount[ui32Index])
+    {
+        g_ui32BulkArmSize = g_ui32BulkRemaining;
+        if(g_ui32BulkArmSize > USB_BULK_BUFFER_SIZE)
+        {
+            g_ui32BulkArmSize = USB_BULK_BUFFER_SIZE;
+        }
+        g_ui32BulkRemaining -= g_ui32BulkArmSize;
+        g_ui32BulkArmIndex = ui32Index;
+        g_bBulkArmed = true;
+
+        USBDMAChannelAddressSet(USB0_BASE, USB_BULK_DMA_CHANNEL,
+                                g_ppui32BulkBuffer[ui32Index]);
+        USBDMAChannelCountSet(USB0_BASE, USB_BULK_DMA_CHANNEL,
+                              g_ui32BulkArmSize);
+        USBDMAChannelConfigSet(USB0_BASE, USB_BULK_DMA_CHANNEL, USB_EP_1,
+                               (USB_DMA_CFG_MODE_1 | USB_DMA_CFG_DIR_RX |
+                                USB_DMA_CFG_BURST_16 | USB_DMA_CFG_INT_EN |
+                                USB_DMA_CFG_EN));
+    }
+
+    //
+    // Program the oldest full buffer.
+    //
+    ui32Index = g_ui32BulkProgIndex;
+    if(g_pui32BulkCount[ui32Index])
+    {
+        ui32Status = ImageProgram(g_ui32BulkAddress,
+                                  (uint8_t *)g_ppui32BulkBuffer[ui32Index],
+                                  g_pui32BulkCount[ui32Index]);
+        if(ui32Status != DFU_STATUS_OK)
+        {
+            BulkStop();
+            DFUError(ui32Status);
+            return;
+        }
+        g_ui32BulkAddress += g_pui32BulkCount[ui32Index];
+        g_pui32BulkCount[ui32Index] = 0;
+        g_ui32BulkProgIndex ^= 1;
+
+#ifdef BL_PROGRESS_FN_HOOK
+        BL_PROGRESS_FN_HOOK(g_ui32BulkAddress - g_ui32ImageStart,
+                            g_ui32BulkTotal);
+#endif
+    }
+
+    //
+    // The download is complete once every buffer has been programmed.
+    //
+    if(!g_bBulkArmed && !g_ui32BulkRemaining && !g_pui32BulkCount[0] &&
+       !g_pui32BulkCount[1])
+    {
+        g_bBulkActive = false;
+    }
+}
+#endif
+
+//*****************************************************************************
+//
+// Returns true if the main loop has nothing to do until the next USB
+// interrupt.  During a bulk download, that is while the DMA controller fills
+// the one buffer that is armed and the other is empty.
+//
+//*****************************************************************************
+static bool
+USBIdle(void)
+{
+    if(g_bDFUBlockPending ||
+       ((g_ui8DFUState == DFU_STATE_MANIFEST) &&
+        (g_ui32EP0State == EP0_STATE_IDLE)))
+    {
+        return(false);
+    }
+#ifdef USB_ENABLE_BULK_DMA
+    if(g_bBulkStart ||
+       (g_bBulkActive &&
+        (!g_bBulkArmed || g_pui32BulkCount[g_ui32BulkProgIndex])))
+    {
+        return(false);
+    }
+#endif
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Sets a USB pin to its analog function.
+//
+//*****************************************************************************
+#if defined(USB_VBUS_CONFIG) || defined(USB_ID_CONFIG) ||                     \
+    defined(USB_DP_CONFIG) || defined(USB_DM_CONFIG)
+static void
+USBPinConfigure(uint32_t ui32Periph, uint32_t ui32Port, uint32_t ui32Pin)
+{
+    HWREG(SYSCTL_RCGCGPIO) |= ui32Periph;
+    while(!(HWREG(SYSCTL_PRGPIO) & ui32Periph))
+    {
+    }
+
+    HWREG(ui32Port + GPIO_O_DEN) &= ~(1 << ui32Pin);
+    HWREG(ui32Port + GPIO_O_AMSEL) |= (1 << ui32Pin);
+}
+#endif
+
+//*****************************************************************************
+//
+//! Configures the USB controller.
+//!
+//! This function sets the system clock to 120 MHz from the PLL, which also
+//! provides the 60 MHz USB clock, configures the USB pins and brings up the
+//! controller in device mode, connected to the bus.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ConfigureUSB(void)
+{
+    g_ui32USBSysClock = SysCtlClockFreqSet((SYSCTL_XTAL_16MHZ |
+                                            SYSCTL_OSC_MAIN |
+                                            SYSCTL_USE_PLL |
+                                            SYSCTL_CFG_VCO_480), 120000000);
+
+#ifdef USB_HAS_MUX
+    //
+    // Select device mode on the host/device multiplexer.  The legacy
+    // SYSCTL_RCGC2_GPIOx values match the SYSCTL_RCGCGPIO_Rx bits.
+    //
+    HWREG(SYSCTL_RCGCGPIO) |= USB_MUX_PERIPH;
+    while(!(HWREG(SYSCTL_PRGPIO) & USB_MUX_PERIPH))
+    {
+    }
+    HWREG(USB_MUX_PORT + GPIO_O_DIR) |= (1 << USB_MUX_PIN);
+    HWREG(USB_MUX_PORT + GPIO_O_DEN) |= (1 << USB_MUX_PIN);
+    HWREG(USB_MUX_PORT + (GPIO_O_DATA + (1 << (USB_MUX_PIN + 2)))) =
+        USB_MUX_DEVICE ? (1 << USB_MUX_PIN) : 0;
+#endif
+
+#ifdef USB_VBUS_CONFIG
+    USBPinConfigure(USB_VBUS_PERIPH, USB_VBUS_PORT, USB_VBUS_PIN);
+#endif
+#ifdef USB_ID_CONFIG
+    USBPinConfigure(USB_ID_PERIPH, USB_ID_PORT, USB_ID_PIN);
+#endif
+#ifdef USB_DP_CONFIG
+    USBPinConfigure(USB_DP_PERIPH, USB_DP_PORT, USB_DP_PIN);
+#endif
+#ifdef USB_DM_CONFIG
+    USBPinConfigure(USB_DM_PERIPH, USB_DM_PORT, USB_DM_PIN);
+#endif
+
+    //
+    // Reset the controller, which also drops any connection made by the
+    // application, and clock the PHY from the 480 MHz VCO.
+    //
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_USB0);
+    SysCtlPeripheralReset(SYSCTL_PERIPH_USB0);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_USB0))
+    {
+    }
+    USBClockEnable(USB0_BASE, 8, USB_CLOCK_INTERNAL);
+    USBDevMode(USB0_BASE);
+
+#ifdef USB_ENABLE_BULK_DMA
+    //
+    // Endpoint 1 OUT is unloaded by the integrated DMA controller, with the
+    // FIFO placed after the endpoint 0 FIFO.
+    //
+    USBFIFOConfigSet(USB0_BASE, USB_EP_1, USB_EP0_MAX_PACKET, USB_FIFO_SZ_64,
+                     USB_EP_DEV_OUT);
+    USBDevEndpointConfigSet(USB0_BASE, USB_EP_1, USB_BULK_MAX_PACKET,
+                            (USB_EP_MODE_BULK | USB_EP_DEV_OUT |
+                             USB_EP_DMA_MODE_1 | USB_EP_AUTO_CLEAR));
+#endif
+
+    g_ui8DFUState = DFU_STATE_IDLE;
+    g_ui8DFUStatus = DFU_STATUS_OK;
+
+    USBIntStatusControl(USB0_BASE);
+    USBIntStatusEndpoint(USB0_BASE);
+    USBIntEnableControl(USB0_BASE, USB_INTCTRL_RESET);
+    USBIntEnableEndpoint(USB0_BASE, USB_INTEP_0);
+    IntEnable(INT_USB0);
+    USBDevConnect(USB0_BASE);
+}
+
+//*****************************************************************************
+//
+//! Performs an update over USB.
+//!
+//! This function programs the blocks handed over by the USB interrupt handler
+//! until the host ends the download, sleeping whenever it waits for the host,
+//! then resets the device to run the new image.
+//!
+//! \return Never returns.
+//
+//*****************************************************************************
+void
+UpdaterUSB(void)
+{
+    IntMasterEnable();
+
+    while(1)
+    {
+        if(g_bDFUBlockPending)
+        {
+            DFUBlockProgram();
+        }
+
+#ifdef USB_ENABLE_BULK_DMA
+        BulkService();
+#endif
+
+        //
+        // Reset once the host has collected the manifestation status.
+        //
+        if((g_ui8DFUState == DFU_STATE_MANIFEST) &&
+           (g_ui32EP0State == EP0_STATE_IDLE))
+        {
+            break;
+        }
+
+        //
+        // Sleep until the next USB interrupt if there is nothing to do.
+        // Interrupts are held off while checking, so that one that comes
+        // just before the sleep still ends it.
+        //
+        IntMasterDisable();
+        if(USBIdle())
+        {
+            CPUwfi();
+        }
+        IntMasterEnable();
+    }
+
+#ifdef BL_END_FN_HOOK
+    BL_END_FN_HOOK();
+#endif
+
+    //
+    // Let the host see the device leave the bus before the reset.
+    //
+    SysCtlDelay(g_ui32USBSysClock / 30);
+    USBDevDisconnect(USB0_BASE);
+    SysCtlDelay(g_ui32USBSysClock / 30);
+
+    HWREG(NVIC_APINT) = (NVIC_APINT_VECTKEY | NVIC_APINT_SYSRESETREQ);
+    while(1)
+    {
+    }
+}
+
+//*****************************************************************************
+//
+//! Performs an update over USB when called from the application.
+//!
+//! This function takes the USB controller over from the application, making
+//! the device re-enumerate as a DFU device, and then performs the update.
+//!
+//! \return Never returns.
+//
+//*****************************************************************************
+void
+AppUpdaterUSB(void)
+{
+    ConfigureUSB();
+    UpdaterUSB();
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+#endif
@@ -0,0 +1,106 @@
+//*****************************************************************************
+//
+// bl_usb.h - Definitions for the USB DFU transport functions.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_USB_H__
+#define __BL_USB_H__
+
+//*****************************************************************************
+//
+// This section maps the defines to default for the USB boot loader for
+// projects that do not specify them in bl_config.h.
+//
+//*****************************************************************************
+#ifndef USB_VENDOR_ID
+#define USB_VENDOR_ID           0x1cbe
+#endif
+
+#ifndef USB_PRODUCT_ID
+#define USB_PRODUCT_ID          0x00ff
+#endif
+
+#ifndef USB_DEVICE_ID
+#define USB_DEVICE_ID           0x0001
+#endif
+
+#ifndef USB_MAX_POWER
+#define USB_MAX_POWER           150
+#endif
+
+#ifndef USB_BUS_POWERED
+#define USB_BUS_POWERED         1
+#endif
+
+#ifndef USB_DFU_TRANSFER_SIZE
+#define USB_DFU_TRANSFER_SIZE   1024
+#endif
+
+#ifndef USB_BULK_BUFFER_SIZE
+#define USB_BULK_BUFFER_SIZE    1024
+#endif
+
+#ifndef USB_POLL_TIMEOUT
+#define USB_POLL_TIMEOUT        10
+#endif
+
+//*****************************************************************************
+//
+// The maximum packet size of endpoint 0 and of the bulk download endpoint.
+//
+//*****************************************************************************
+#define USB_EP0_MAX_PACKET      64
+#define USB_BULK_MAX_PACKET     64
+
+//*****************************************************************************
+//
+// The vendor specific request, sent to the DFU interface, that starts a bulk
+// download.  The eight byte data stage holds the little endian flash address
+// and length of the data that follows on the bulk OUT endpoint.
+//
+//*****************************************************************************
+#define USB_REQ_BULK_DOWNLOAD   0x42
+
+//*****************************************************************************
+//
+// Make sure that the buffers can be programmed a word at a time and that a
+// bulk buffer always ends on a packet boundary.
+//
+//*****************************************************************************
+#if (USB_DFU_TRANSFER_SIZE & 3) || (USB_DFU_TRANSFER_SIZE > 0xffff)
+#error ERROR: USB_DFU_TRANSFER_SIZE must be a multiple of 4 bytes!
+#endif
+#if (USB_BULK_BUFFER_SIZE % USB_BULK_MAX_PACKET)
+#error ERROR: USB_BULK_BUFFER_SIZE must be a multiple of 64 bytes!
+#endif
+
+//*****************************************************************************
+//
+// USB Transport APIs
+//
+//*****************************************************************************
+extern void ConfigureUSB(void);
+extern void UpdaterUSB(void);
+extern void AppUpdaterUSB(void);
+extern void USB0DeviceIntHandler(void);
+
+#endif // __BL_USB_H__
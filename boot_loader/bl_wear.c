@@ -0,0 +1,156 @@
+//*****************************************************************************
+//
+// bl_wear.c - Flash erase counters kept in the EEPROM.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_types.h"
+#include "bl_config.h"
+#include "boot_loader/bl_flash.h"
+#include "boot_loader/bl_wear.h"
+#include "driverlib/eeprom.h"
+#include "driverlib/sysctl.h"
+
+//*****************************************************************************
+//
+//! \addtogroup bl_wear_api
+//! @{
+//
+//*****************************************************************************
+#if defined(FLASH_WEAR_EEPROM_ADDRESS) || defined(DOXYGEN)
+
+//*****************************************************************************
+//
+// Make sure that the counters start on a word of the EEPROM.
+//
+//*****************************************************************************
+#if (FLASH_WEAR_EEPROM_ADDRESS & 3)
+#error ERROR: FLASH_WEAR_EEPROM_ADDRESS must be a multiple of 4!
+#endif
+
+//*****************************************************************************
+//
+// The number of erases skipped because the block was already blank, since
+// the boot loader started.
+//
+//*****************************************************************************
+uint32_t g_ui32WearSkips;
+
+//*****************************************************************************
+//
+// Whether the EEPROM has been started, and whether that worked.  The counters
+// are left alone if it did not.
+//
+//*****************************************************************************
+static bool g_bWearReady;
+static bool g_bWearStarted;
+
+//*****************************************************************************
+//
+// Starts the EEPROM the first time that a counter is used.
+//
+//*****************************************************************************
+static bool
+WearStart(void)
+{
+    if(!g_bWearStarted)
+    {
+        g_bWearStarted = true;
+        SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
+        g_bWearReady = (EEPROMInit() == EEPROM_INIT_OK);
+    }
+
+    return(g_bWearReady);
+}
+
+//*****************************************************************************
+//
+//! Counts an erase of the flash.
+//!
+//! \param ui32Address is an address in the block about to be erased.
+//!
+//! This function adds one to the erase counter of the block holding
+//! \e ui32Address.  It is called before the erase is started, so that an
+//! erase cut short by a reset is still counted.  The counters are stored
+//! inverted, so that the EEPROM as it leaves the factory reads as zero
+//! erases, and stop at 65535.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+WearCount(uint32_t ui32Address)
+{
+    uint32_t ui32Block, ui32Word, ui32Shift;
+
+    ui32Block = ui32Address / BL_FLASH_ERASE_SIZE;
+    if((ui32Block >= WEAR_NUM_BLOCKS) || !WearStart())
+    {
+        return;
+    }
+
+    ui32Shift = (ui32Block & 1) * 16;
+    EEPROMRead(&ui32Word, FLASH_WEAR_EEPROM_ADDRESS + ((ui32Block / 2) * 4),
+               4);
+    if(ui32Word & (0xffff << ui32Shift))
+    {
+        ui32Word -= 1 << ui32Shift;
+        EEPROMProgram(&ui32Word,
+                      FLASH_WEAR_EEPROM_ADDRESS + ((ui32Block / 2) * 4), 4);
+    }
+}
+
+//*****************************************************************************
+//
+//! Reads the erase counter of a block of flash.
+//!
+//! \param ui32Block is the number of the block, which is its address divided
+//! by the erase size.
+//!
+//! \return Returns the number of times that the block has been erased, or 0
+//! if it is past the end of the counters or the EEPROM could not be started.
+//
+//*****************************************************************************
+uint32_t
+WearGet(uint32_t ui32Block)
+{
+    uint32_t ui32Word;
+
+    if((ui32Block >= WEAR_NUM_BLOCKS) || !WearStart())
+    {
+        return(0);
+    }
+
+    EEPROMRead(&ui32Word, FLASH_WEAR_EEPROM_ADDRESS + ((ui32Block / 2) * 4),
+               4);
+
+    return((~ui32Word >> ((ui32Block & 1) * 16)) & 0xffff);
+}
+
+//*****************************************************************************
+//
+// Close the Doxygen group.
+//! @}
+//
+//*****************************************************************************
+#endif
@@ -0,0 +1,60 @@
+//*****************************************************************************
+//
+// bl_wear.h - Definitions for the flash erase counters.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BL_WEAR_H__
+#define __BL_WEAR_H__
+
+//*****************************************************************************
+//
+// The number of erasable blocks that counters are kept for, which covers the
+// largest flash of the device family.  Each counter is 16 bits and two are
+// packed into each word of the EEPROM.
+//
+//*****************************************************************************
+#if defined(TARGET_IS_TM4C129_RA0) ||                                         \
+    defined(TARGET_IS_TM4C129_RA1) ||                                         \
+    defined(TARGET_IS_TM4C129_RA2)
+#define WEAR_NUM_BLOCKS         (0x100000 / BL_FLASH_ERASE_SIZE)
+#else
+#define WEAR_NUM_BLOCKS         (0x40000 / BL_FLASH_ERASE_SIZE)
+#endif
+#define WEAR_EEPROM_SIZE        (((WEAR_NUM_BLOCKS + 1) / 2) * 4)
+
+//*****************************************************************************
+//
+// The number of erases skipped because the block was already blank, since
+// the boot loader started.
+//
+//*****************************************************************************
+extern uint32_t g_ui32WearSkips;
+
+//*****************************************************************************
+//
+// Erase counter APIs
+//
+//*****************************************************************************
+extern void WearCount(uint32_t ui32Address);
+extern uint32_t WearGet(uint32_t ui32Block);
+
+#endif // __BL_WEAR_H__
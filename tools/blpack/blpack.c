@@ -0,0 +1,1229 @@
+//*****************************************************************************
+//
+// blpack.c - Image packer that fills in the image information header.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// This program takes the application as a binary, Intel HEX or ELF file and
+// produces the binary image that the boot loader downloads, with the length
+// and CRC32 words of the image information header filled in as
+// CheckImageCRC32() expects them.  It does the job of TI's binpack tool.
+//
+// The input is read once, straight into a flat image of the flash from the
+// application's start address.  A second pass over that image, while it is
+// still in the cache, computes the image CRC32 and, if asked for, a CRC32 of
+// every flash page so that an updater can tell which pages differ from those
+// already on a board, and an LZSS compressed copy of the image for storing
+// or distributing it.  The boot loader downloads the uncompressed image.
+//
+// The -r option lists the regions of the image that hold anything other than
+// erased (0xFF) bytes, as "<address> <length>" lines, for "blupdate -R" to
+// send; the gaps between the segments of a HEX or ELF file, and runs of 0xFF
+// within them, are left to the erase.
+//
+// The -s option signs the image for a boot loader built with
+// CHECK_SIGNATURE, appending the ECDSA P-256 signature of the SHA-256 digest
+// of the image, as r and s, to the image after the length in its header.
+// The signature is made by the openssl command, from a private key such as
+// one generated by:
+//
+//     openssl ecparam -name prime256v1 -genkey -noout -out key.pem
+//
+// and -K prints the SIGN_PUBLIC_KEY definition for bl_config.h that goes
+// with the key.
+//
+// The CRC32 uses carry-less multiply (PCLMULQDQ) folding on x86 processors
+// that have it and the CRC32 instructions on ARMv8, falling back to a
+// slicing-by-8 table otherwise; all three give the same result as
+// CalculateCRC32() in bl_crc32.c.
+//
+// Build it with:
+//
+//     gcc -O2 -o blpack tools/blpack/blpack.c
+//
+// and run it as:
+//
+//     blpack [-a <address>] [-P <page size>] [-p <pages.txt>]
+//            [-r <regions.txt>] [-z <image.lz>] [-s <key.pem>] [-v]
+//            <input> <output.bin>
+//
+// or, to print the public key definition:
+//
+//     blpack -K <key.pem>
+//
+//*****************************************************************************
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+//*****************************************************************************
+//
+// The marker words that start the image information header, and how far
+// into the image CheckImageCRC32() looks for them.
+//
+//*****************************************************************************
+#define HEADER_MARKER0          0xff01ff02
+#define HEADER_MARKER1          0xff03ff04
+#define HEADER_SEARCH_WORDS     257
+
+//*****************************************************************************
+//
+// The largest image that can be packed.
+//
+//*****************************************************************************
+#define MAX_IMAGE_SIZE          (16 * 1024 * 1024)
+
+//*****************************************************************************
+//
+// The LZSS format used for the compressed copy: a flag byte precedes each
+// group of eight items, with a set bit for a literal byte and a clear bit for
+// a two byte match of a 12 bit distance and a 4 bit length.
+//
+//*****************************************************************************
+#define LZ_WINDOW               4096
+#define LZ_MIN_MATCH            3
+#define LZ_MAX_MATCH            (15 + LZ_MIN_MATCH)
+#define LZ_HASH_SIZE            65536
+
+//*****************************************************************************
+//
+// The shortest run of erased bytes that separates two regions in the -r
+// list: one data block of the update protocol.
+//
+//*****************************************************************************
+#define REGION_GAP              128
+
+//*****************************************************************************
+//
+// The size of the ECDSA P-256 signature that -s appends to the image, which
+// is r and s, and of the public key that -K prints, which is x and y.
+//
+//*****************************************************************************
+#define SIGNATURE_SIZE          64
+#define PUBLIC_KEY_SIZE         64
+
+//*****************************************************************************
+//
+// The slicing-by-8 tables for the CRC32 used when no instructions help.
+//
+//*****************************************************************************
+static uint32_t g_ppui32CRCTable[8][256];
+
+//*****************************************************************************
+//
+// The CRC32 routine chosen for this processor.
+//
+//*****************************************************************************
+static uint32_t (*g_pfnCRC32)(const uint8_t *pui8Data, uint32_t ui32Length,
+                              uint32_t ui32CRC);
+
+//*****************************************************************************
+//
+// Builds the slicing-by-8 tables for the reflected 0x04C11DB7 polynomial.
+//
+//*****************************************************************************
+static void
+CRC32TableInit(void)
+{
+    uint32_t ui32Idx, ui32Bit, ui32CRC, ui32Slice;
+
+    for(ui32Idx = 0; ui32Idx < 256; ui32Idx++)
+    {
+        ui32CRC = ui32Idx;
+        for(ui32Bit = 0; ui32Bit < 8; ui32Bit++)
+        {
+            ui32CRC = (ui32CRC & 1) ? ((ui32CRC >> 1) ^ 0xedb88320) :
+                                      (ui32CRC >> 1);
+        }
+        g_ppui32CRCTable[0][ui32Idx] = ui32CRC;
+    }
+    for(ui32Idx = 0; ui32Idx < 256; ui32Idx++)
+    {
+        ui32CRC = g_ppui32CRCTable[0][ui32Idx];
+        for(ui32Slice = 1; ui32Slice < 8; ui32Slice++)
+        {
+            ui32CRC = ((ui32CRC >> 8) ^
+                       g_ppui32CRCTable[0][ui32CRC & 0xff]);
+            g_ppui32CRCTable[ui32Slice][ui32Idx] = ui32CRC;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Continues a CRC32 over a block of data, eight bytes at a time.  As with
+// CalculateCRC32(), the CRC is neither inverted on the way in nor out.
+//
+//*****************************************************************************
+static uint32_t
+CRC32Table(const uint8_t *pui8Data, uint32_t ui32Length, uint32_t ui32CRC)
+{
+    uint32_t ui32Low, ui32High;
+
+    while(ui32Length >= 8)
+    {
+        ui32Low = (pui8Data[0] | (pui8Data[1] << 8) | (pui8Data[2] << 16) |
+                   ((uint32_t)pui8Data[3] << 24)) ^ ui32CRC;
+        ui32High = (pui8Data[4] | (pui8Data[5] << 8) | (pui8Data[6] << 16) |
+                    ((uint32_t)pui8Data[7] << 24));
+        ui32CRC = (g_ppui32CRCTable[7][ui32Low & 0xff] ^
+                   g_ppui32CRCTable[6][(ui32Low >> 8) & 0xff] ^
+                   g_ppui32CRCTable[5][(ui32Low >> 16) & 0xff] ^
+                   g_ppui32CRCTable[4][ui32Low >> 24] ^
+                   g_ppui32CRCTable[3][ui32High & 0xff] ^
+                   g_ppui32CRCTable[2][(ui32High >> 8) & 0xff] ^
+                   g_ppui32CRCTable[1][(ui32High >> 16) & 0xff] ^
+                   g_ppui32CRCTable[0][ui32High >> 24]);
+        pui8Data += 8;
+        ui32Length -= 8;
+    }
+    while(ui32Length--)
+    {
+        ui32CRC = ((ui32CRC >> 8) ^
+                   g_ppui32CRCTable[0][(ui32CRC ^ *pui8Data++) & 0xff]);
+    }
+
+    return(ui32CRC);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+//*****************************************************************************
+//
+// Continues a CRC32 by folding 64 bytes at a time with carry-less multiplies
+// and reducing the result with a Barrett reduction, using the constants for
+// the reflected 0x04C11DB7 polynomial.  Data that does not fill a 16 byte
+// block at the end goes through the table.
+//
+//*****************************************************************************
+__attribute__((target("pclmul,sse4.1")))
+static uint32_t
+CRC32Clmul(const uint8_t *pui8Data, uint32_t ui32Length, uint32_t ui32CRC)
+{
+    static const uint64_t pui64K1K2[2] __attribute__((aligned(16))) =
+    {
+        0x0154442bd4, 0x01c6e41596
+    };
+    static const uint64_t pui64K3K4[2] __attribute__((aligned(16))) =
+    {
+        0x01751997d0, 0x00ccaa009e
+    };
+    static const uint64_t pui64K5K0[2] __attribute__((aligned(16))) =
+    {
+        0x0163cd6124, 0x0000000000
+    };
+    static const uint64_t pui64Poly[2] __attribute__((aligned(16))) =
+    {
+        0x01db710641, 0x01f7011641
+    };
+    __m128i x0, x1, x2, x3, x4, x5, x6, x7, x8;
+    uint32_t ui32Tail;
+
+    if(ui32Length < 64)
+    {
+        return(CRC32Table(pui8Data, ui32Length, ui32CRC));
+    }
+    ui32Tail = ui32Length & 15;
+    ui32Length -= ui32Tail;
+
+    //
+    // Fold 64 bytes at a time into four 128 bit accumulators.
+    //
+    x1 = _mm_loadu_si128((const __m128i *)(pui8Data + 0x00));
+    x2 = _mm_loadu_si128((const __m128i *)(pui8Data + 0x10));
+    x3 = _mm_loadu_si128((const __m128i *)(pui8Data + 0x20));
+    x4 = _mm_loadu_si128((const __m128i *)(pui8Data + 0x30));
+    x1 = _mm_xor_si128(x1, _mm_cvtsi32_si128(ui32CRC));
+    x0 = _mm_load_si128((const __m128i *)pui64K1K2);
+    pui8Data += 64;
+    ui32Length -= 64;
+    while(ui32Length >= 64)
+    {
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x6 = _mm_clmulepi64_si128(x2, x0, 0x00);
+        x7 = _mm_clmulepi64_si128(x3, x0, 0x00);
+        x8 = _mm_clmulepi64_si128(x4, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x2 = _mm_clmulepi64_si128(x2, x0, 0x11);
+        x3 = _mm_clmulepi64_si128(x3, x0, 0x11);
+        x4 = _mm_clmulepi64_si128(x4, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x5),
+                           _mm_loadu_si128((const __m128i *)
+                                           (pui8Data + 0x00)));
+        x2 = _mm_xor_si128(_mm_xor_si128(x2, x6),
+                           _mm_loadu_si128((const __m128i *)
+                                           (pui8Data + 0x10)));
+        x3 = _mm_xor_si128(_mm_xor_si128(x3, x7),
+                           _mm_loadu_si128((const __m128i *)
+                                           (pui8Data + 0x20)));
+        x4 = _mm_xor_si128(_mm_xor_si128(x4, x8),
+                           _mm_loadu_si128((const __m128i *)
+                                           (pui8Data + 0x30)));
+        pui8Data += 64;
+        ui32Length -= 64;
+    }
+
+    //
+    // Fold the four accumulators into one, then any remaining 16 byte
+    // blocks into that.
+    //
+    x0 = _mm_load_si128((const __m128i *)pui64K3K4);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x3), x5);
+    x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+    x1 = _mm_xor_si128(_mm_xor_si128(x1, x4), x5);
+    while(ui32Length >= 16)
+    {
+        x2 = _mm_loadu_si128((const __m128i *)pui8Data);
+        x5 = _mm_clmulepi64_si128(x1, x0, 0x00);
+        x1 = _mm_clmulepi64_si128(x1, x0, 0x11);
+        x1 = _mm_xor_si128(_mm_xor_si128(x1, x2), x5);
+        pui8Data += 16;
+        ui32Length -= 16;
+    }
+
+    //
+    // Fold 128 bits down to 64, then reduce to 32.
+    //
+    x2 = _mm_clmulepi64_si128(x1, x0, 0x10);
+    x3 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x1 = _mm_srli_si128(x1, 8);
+    x1 = _mm_xor_si128(x1, x2);
+    x0 = _mm_loadl_epi64((const __m128i *)pui64K5K0);
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_and_si128(x1, x3);
+    x1 = _mm_clmulepi64_si128(x1, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    x0 = _mm_load_si128((const __m128i *)pui64Poly);
+    x2 = _mm_and_si128(x1, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x10);
+    x2 = _mm_and_si128(x2, x3);
+    x2 = _mm_clmulepi64_si128(x2, x0, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+    ui32CRC = _mm_extract_epi32(x1, 1);
+
+    return(CRC32Table(pui8Data, ui32Tail, ui32CRC));
+}
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+//*****************************************************************************
+//
+// Continues a CRC32 with the ARMv8 CRC32 instructions, which implement the
+// same polynomial.
+//
+//*****************************************************************************
+static uint32_t
+CRC32Arm(const uint8_t *pui8Data, uint32_t ui32Length, uint32_t ui32CRC)
+{
+    uint64_t ui64Data;
+
+    while(ui32Length >= 8)
+    {
+        memcpy(&ui64Data, pui8Data, 8);
+        ui32CRC = __crc32d(ui32CRC, ui64Data);
+        pui8Data += 8;
+        ui32Length -= 8;
+    }
+    while(ui32Length--)
+    {
+        ui32CRC = __crc32b(ui32CRC, *pui8Data++);
+    }
+
+    return(ui32CRC);
+}
+#endif
+
+//*****************************************************************************
+//
+// Picks the fastest CRC32 routine that this processor can run.
+//
+//*****************************************************************************
+static const char *
+CRC32Init(void)
+{
+    CRC32TableInit();
+    g_pfnCRC32 = CRC32Table;
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("pclmul") && __builtin_cpu_supports("sse4.1"))
+    {
+        g_pfnCRC32 = CRC32Clmul;
+        return("pclmul");
+    }
+#endif
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+    g_pfnCRC32 = CRC32Arm;
+    return("armv8 crc32");
+#endif
+
+    return("table");
+}
+
+//*****************************************************************************
+//
+// Returns the monotonic time in microseconds.
+//
+//*****************************************************************************
+static uint64_t
+TimeNow(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return(((uint64_t)sTime.tv_sec * 1000000) + (sTime.tv_nsec / 1000));
+}
+
+//*****************************************************************************
+//
+// Copies a block of input to its address in the image, growing the image to
+// cover it.  Returns false if it falls outside the image.
+//
+//*****************************************************************************
+static bool
+ImagePlace(uint8_t *pui8Image, uint32_t *pui32Size, uint32_t ui32Base,
+           uint32_t ui32Address, const uint8_t *pui8Data, uint32_t ui32Length)
+{
+    if((ui32Address < ui32Base) ||
+       ((ui32Address - ui32Base) > (MAX_IMAGE_SIZE - ui32Length)))
+    {
+        fprintf(stderr, "blpack: data at 0x%08x is outside the image\n",
+                ui32Address);
+        return(false);
+    }
+    memcpy(pui8Image + (ui32Address - ui32Base), pui8Data, ui32Length);
+    if((ui32Address - ui32Base + ui32Length) > *pui32Size)
+    {
+        *pui32Size = ui32Address - ui32Base + ui32Length;
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Converts a pair of hexadecimal digits, returning -1 if they are not.
+//
+//*****************************************************************************
+static int
+HexByte(const uint8_t *pui8Text)
+{
+    static const char pcDigits[] = "0123456789abcdef0123456789ABCDEF";
+    const char *pcHigh, *pcLow;
+
+    pcHigh = pui8Text[0] ? strchr(pcDigits, pui8Text[0]) : 0;
+    pcLow = pui8Text[1] ? strchr(pcDigits, pui8Text[1]) : 0;
+    if(!pcHigh || !pcLow)
+    {
+        return(-1);
+    }
+
+    return((((pcHigh - pcDigits) & 15) << 4) | ((pcLow - pcDigits) & 15));
+}
+
+//*****************************************************************************
+//
+// Places the data records of an Intel HEX file.
+//
+//*****************************************************************************
+static bool
+ReadHex(const uint8_t *pui8In, size_t sInSize, uint8_t *pui8Image,
+        uint32_t *pui32Size, uint32_t ui32Base)
+{
+    uint8_t pui8Record[5 + 255];
+    uint32_t ui32Line, ui32Count, ui32Idx, ui32Upper, ui32Sum;
+    const uint8_t *pui8End;
+    int iByte;
+
+    pui8End = pui8In + sInSize;
+    ui32Upper = 0;
+    for(ui32Line = 1; pui8In < pui8End; ui32Line++)
+    {
+        //
+        // Skip to the start of the record.
+        //
+        while((pui8In < pui8End) && (*pui8In != ':'))
+        {
+            if(*pui8In++ == '\n')
+            {
+                ui32Line++;
+            }
+        }
+        if(pui8In++ == pui8End)
+        {
+            break;
+        }
+
+        //
+        // Decode the count, address, type, data and checksum.
+        //
+        ui32Count = 5;
+        ui32Sum = 0;
+        for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx++)
+        {
+            if((pui8In + 2) > pui8End || ((iByte = HexByte(pui8In)) < 0))
+            {
+                fprintf(stderr, "blpack: bad HEX record on line %u\n",
+                        ui32Line);
+                return(false);
+            }
+            pui8Record[ui32Idx] = iByte;
+            ui32Sum += iByte;
+            pui8In += 2;
+            if(ui32Idx == 0)
+            {
+                ui32Count += iByte;
+            }
+        }
+        if(ui32Sum & 0xff)
+        {
+            fprintf(stderr, "blpack: bad HEX checksum on line %u\n",
+                    ui32Line);
+            return(false);
+        }
+
+        switch(pui8Record[3])
+        {
+            case 0x00:
+            {
+                if(!ImagePlace(pui8Image, pui32Size, ui32Base,
+                               ui32Upper + ((pui8Record[1] << 8) |
+                                            pui8Record[2]),
+                               &pui8Record[4], pui8Record[0]))
+                {
+                    return(false);
+                }
+                break;
+            }
+
+            case 0x01:
+            {
+                return(true);
+            }
+
+            case 0x02:
+            {
+                ui32Upper = ((pui8Record[4] << 8) | pui8Record[5]) << 4;
+                break;
+            }
+
+            case 0x04:
+            {
+                ui32Upper = ((pui8Record[4] << 24) |
+                             (pui8Record[5] << 16));
+                break;
+            }
+
+            default:
+            {
+                //
+                // Start address records do not affect the image.
+                //
+                break;
+            }
+        }
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Places the loadable segments of a 32-bit little-endian ELF file at their
+// load addresses.
+//
+//*****************************************************************************
+static bool
+ReadElf(const uint8_t *pui8In, size_t sInSize, uint8_t *pui8Image,
+        uint32_t *pui32Size, uint32_t ui32Base)
+{
+    uint32_t ui32PHOff, ui32PHSize, ui32PHNum, ui32Idx;
+    uint32_t ui32Offset, ui32FileSize, ui32Address;
+    const uint8_t *pui8PH;
+
+#define ELF16(p)                ((p)[0] | ((p)[1] << 8))
+#define ELF32(p)                ((p)[0] | ((p)[1] << 8) | ((p)[2] << 16) |  \
+                                 ((uint32_t)(p)[3] << 24))
+
+    if((sInSize < 52) || (pui8In[4] != 1) || (pui8In[5] != 1))
+    {
+        fprintf(stderr, "blpack: only 32-bit little-endian ELF is "
+                "supported\n");
+        return(false);
+    }
+    ui32PHOff = ELF32(pui8In + 28);
+    ui32PHSize = ELF16(pui8In + 42);
+    ui32PHNum = ELF16(pui8In + 44);
+    if((ui32PHSize < 32) ||
+       (ui32PHOff > sInSize) ||
+       (((uint64_t)ui32PHSize * ui32PHNum) > (sInSize - ui32PHOff)))
+    {
+        fprintf(stderr, "blpack: bad ELF program headers\n");
+        return(false);
+    }
+
+    for(ui32Idx = 0; ui32Idx < ui32PHNum; ui32Idx++)
+    {
+        pui8PH = pui8In + ui32PHOff + (ui32Idx * ui32PHSize);
+        ui32Offset = ELF32(pui8PH + 4);
+        ui32Address = ELF32(pui8PH + 12);
+        ui32FileSize = ELF32(pui8PH + 16);
+
+        //
+        // Only PT_LOAD segments with file contents end up in flash, at
+        // their physical (load) address.
+        //
+        if((ELF32(pui8PH) != 1) || !ui32FileSize)
+        {
+            continue;
+        }
+        if((ui32Offset > sInSize) || (ui32FileSize > (sInSize - ui32Offset)))
+        {
+            fprintf(stderr, "blpack: ELF segment %u is truncated\n",
+                    ui32Idx);
+            return(false);
+        }
+        if(!ImagePlace(pui8Image, pui32Size, ui32Base, ui32Address,
+                       pui8In + ui32Offset, ui32FileSize))
+        {
+            return(false);
+        }
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Compresses the image with LZSS, returning the compressed size.  The output
+// buffer must hold at least nine bytes for every eight of input.
+//
+//*****************************************************************************
+static uint32_t
+Compress(const uint8_t *pui8In, uint32_t ui32Size, uint8_t *pui8Out)
+{
+    static uint32_t pui32Head[LZ_HASH_SIZE];
+    uint32_t ui32In, ui32Out, ui32Flags, ui32Item, ui32Hash, ui32Match;
+    uint32_t ui32Length, ui32Distance;
+
+    memset(pui32Head, 0xff, sizeof(pui32Head));
+    ui32In = 0;
+    ui32Out = 0;
+    ui32Flags = 0;
+    ui32Item = 8;
+    while(ui32In < ui32Size)
+    {
+        //
+        // Start a new group of items.
+        //
+        if(ui32Item == 8)
+        {
+            ui32Flags = ui32Out++;
+            pui8Out[ui32Flags] = 0;
+            ui32Item = 0;
+        }
+
+        //
+        // Look for the last place the next three bytes were seen.
+        //
+        ui32Length = 0;
+        ui32Distance = 0;
+        if((ui32In + LZ_MIN_MATCH) <= ui32Size)
+        {
+            ui32Hash = (((pui8In[ui32In] << 16) | (pui8In[ui32In + 1] << 8) |
+                         pui8In[ui32In + 2]) * 2654435761u) >> 16;
+            ui32Match = pui32Head[ui32Hash];
+            pui32Head[ui32Hash] = ui32In;
+            if((ui32Match != 0xffffffff) &&
+               ((ui32In - ui32Match) <= LZ_WINDOW))
+            {
+                while((ui32Length < LZ_MAX_MATCH) &&
+                      ((ui32In + ui32Length) < ui32Size) &&
+                      (pui8In[ui32Match + ui32Length] ==
+                       pui8In[ui32In + ui32Length]))
+                {
+                    ui32Length++;
+                }
+                ui32Distance = ui32In - ui32Match;
+            }
+        }
+
+        if(ui32Length >= LZ_MIN_MATCH)
+        {
+            pui8Out[ui32Out++] = (((ui32Distance - 1) >> 4) & 0xff);
+            pui8Out[ui32Out++] = ((((ui32Distance - 1) & 15) << 4) |
+                                  (ui32Length - LZ_MIN_MATCH));
+            ui32In += ui32Length;
+        }
+        else
+        {
+            pui8Out[ui32Flags] |= 1 << ui32Item;
+            pui8Out[ui32Out++] = pui8In[ui32In++];
+        }
+        ui32Item++;
+    }
+
+    return(ui32Out);
+}
+
+//*****************************************************************************
+//
+// Writes the list of regions of the image that are not erased.
+//
+//*****************************************************************************
+static bool
+WriteRegions(const char *pcPath, const uint8_t *pui8Image, uint32_t ui32Size,
+             uint32_t ui32Base)
+{
+    uint32_t ui32Idx, ui32Start, ui32End;
+    FILE *psFile;
+
+    psFile = fopen(pcPath, "w");
+    if(!psFile)
+    {
+        perror(pcPath);
+        return(false);
+    }
+
+    for(ui32Idx = 0; ui32Idx < ui32Size; )
+    {
+        //
+        // Find the start of the next region, then its end: the last byte
+        // that is not erased before a gap of at least REGION_GAP bytes.
+        //
+        while((ui32Idx < ui32Size) && (pui8Image[ui32Idx] == 0xff))
+        {
+            ui32Idx++;
+        }
+        if(ui32Idx == ui32Size)
+        {
+            break;
+        }
+        ui32Start = ui32Idx;
+        ui32End = ui32Idx;
+        while((ui32Idx < ui32Size) && ((ui32Idx - ui32End) < REGION_GAP))
+        {
+            if(pui8Image[ui32Idx++] != 0xff)
+            {
+                ui32End = ui32Idx;
+            }
+        }
+        fprintf(psFile, "0x%08x 0x%x\n", ui32Base + ui32Start,
+                ui32End - ui32Start);
+        ui32Idx = ui32End;
+    }
+
+    if(fclose(psFile))
+    {
+        perror(pcPath);
+        return(false);
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Writes a buffer to a file.
+//
+//*****************************************************************************
+static bool
+WriteFile(const char *pcPath, const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    FILE *psFile;
+
+    psFile = fopen(pcPath, "wb");
+    if(!psFile || (fwrite(pui8Data, 1, ui32Size, psFile) != ui32Size) ||
+       fclose(psFile))
+    {
+        perror(pcPath);
+        return(false);
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Runs an openssl command on a key file, and on a file if one is given,
+// reading up to the given number of bytes of its output.  Returns the number
+// read, or -1 if the command failed.
+//
+//*****************************************************************************
+static int
+OpenSSLRun(const char *pcCommand, const char *pcKey, const char *pcFile,
+           uint8_t *pui8Out, uint32_t ui32Size)
+{
+    char pcLine[4096];
+    FILE *psPipe;
+    size_t sRead;
+
+    if(strchr(pcKey, '\'') || (pcFile && strchr(pcFile, '\'')))
+    {
+        fprintf(stderr, "blpack: quotes are not allowed in file names\n");
+        return(-1);
+    }
+    snprintf(pcLine, sizeof(pcLine), "openssl %s '%s' %s%s%s", pcCommand,
+             pcKey, pcFile ? "'" : "", pcFile ? pcFile : "",
+             pcFile ? "'" : "");
+    psPipe = popen(pcLine, "r");
+    if(!psPipe)
+    {
+        perror("blpack: openssl");
+        return(-1);
+    }
+    sRead = fread(pui8Out, 1, ui32Size, psPipe);
+    if(pclose(psPipe) != 0)
+    {
+        fprintf(stderr, "blpack: \"%s\" failed\n", pcLine);
+        return(-1);
+    }
+    return((int)sRead);
+}
+
+//*****************************************************************************
+//
+// Reads a DER INTEGER of at most 32 bytes into a 32 byte big-endian value,
+// returning the number of bytes of DER used, or 0 if it is not one.
+//
+//*****************************************************************************
+static uint32_t
+DERInteger(const uint8_t *pui8DER, uint32_t ui32Size, uint8_t *pui8Value)
+{
+    uint32_t ui32Length, ui32Skip;
+
+    if((ui32Size < 2) || (pui8DER[0] != 0x02) ||
+       ((ui32Length = pui8DER[1]) > (ui32Size - 2)) || !ui32Length)
+    {
+        return(0);
+    }
+    for(ui32Skip = 0; (ui32Skip < (ui32Length - 1)) &&
+                      !pui8DER[2 + ui32Skip]; ui32Skip++)
+    {
+    }
+    if((ui32Length - ui32Skip) > 32)
+    {
+        return(0);
+    }
+    memset(pui8Value, 0, 32);
+    memcpy(pui8Value + 32 - (ui32Length - ui32Skip), pui8DER + 2 + ui32Skip,
+           ui32Length - ui32Skip);
+    return(2 + ui32Length);
+}
+
+//*****************************************************************************
+//
+// Signs the image with the private key in a file, returning the signature
+// as r and s.  openssl hashes the image with SHA-256 and returns the
+// signature as a DER SEQUENCE of the two INTEGERs.
+//
+//*****************************************************************************
+static bool
+Sign(const char *pcKey, const uint8_t *pui8Image, uint32_t ui32Size,
+     uint8_t *pui8Signature)
+{
+    char pcTemp[] = "/tmp/blpackXXXXXX";
+    uint8_t pui8DER[80];
+    uint32_t ui32Used;
+    int iFd, iSize;
+
+    iFd = mkstemp(pcTemp);
+    if((iFd < 0) || (write(iFd, pui8Image, ui32Size) != (ssize_t)ui32Size) ||
+       close(iFd))
+    {
+        perror("blpack: temporary file");
+        return(false);
+    }
+    iSize = OpenSSLRun("dgst -sha256 -binary -sign", pcKey, pcTemp, pui8DER,
+                       sizeof(pui8DER));
+    unlink(pcTemp);
+    if(iSize < 0)
+    {
+        return(false);
+    }
+    if((iSize < 8) || (pui8DER[0] != 0x30) || (pui8DER[1] != (iSize - 2)) ||
+       !(ui32Used = DERInteger(pui8DER + 2, iSize - 2, pui8Signature)) ||
+       !DERInteger(pui8DER + 2 + ui32Used, iSize - 2 - ui32Used,
+                   pui8Signature + 32))
+    {
+        fprintf(stderr, "blpack: %s is not a P-256 key\n", pcKey);
+        return(false);
+    }
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Prints the SIGN_PUBLIC_KEY definition for the key in a file.  openssl
+// returns the public key as a DER SubjectPublicKeyInfo, which for a P-256
+// key ends with the uncompressed point: 0x04, x and y.
+//
+//*****************************************************************************
+static bool
+PrintPublicKey(const char *pcKey)
+{
+    static const uint8_t pui8Curve[] =
+    {
+        0x06, 0x08, 0x2a, 0x86, 0x48, 0xce, 0x3d, 0x03, 0x01, 0x07
+    };
+    uint8_t pui8DER[128], *pui8Point;
+    uint32_t ui32Idx;
+    int iSize;
+
+    iSize = OpenSSLRun("pkey -pubout -outform DER -in", pcKey, 0, pui8DER,
+                       sizeof(pui8DER));
+    if(iSize < 0)
+    {
+        return(false);
+    }
+    pui8Point = pui8DER + iSize - PUBLIC_KEY_SIZE;
+    if((iSize != 91) || !memmem(pui8DER, iSize, pui8Curve, sizeof(pui8Curve)) ||
+       (pui8Point[-1] != 0x04))
+    {
+        fprintf(stderr, "blpack: %s is not a P-256 key\n", pcKey);
+        return(false);
+    }
+    printf("#define SIGN_PUBLIC_KEY         ");
+    for(ui32Idx = 0; ui32Idx < (PUBLIC_KEY_SIZE / 4); ui32Idx++)
+    {
+        printf("0x%02x%02x%02x%02x%s", pui8Point[ui32Idx * 4],
+               pui8Point[(ui32Idx * 4) + 1], pui8Point[(ui32Idx * 4) + 2],
+               pui8Point[(ui32Idx * 4) + 3],
+               (ui32Idx == ((PUBLIC_KEY_SIZE / 4) - 1)) ? "\n" :
+               ((ui32Idx % 3) == 2) ? (",          \\\n"
+                                       "                                ") :
+               ", ");
+    }
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Prints the options.
+//
+//*****************************************************************************
+static void
+Usage(void)
+{
+    fprintf(stderr,
+            "usage: blpack [options] <input> <output.bin>\n"
+            "  -a <addr>    address the image starts at (default 0x8000)\n"
+            "  -P <bytes>   flash page size for -p (default 1024)\n"
+            "  -p <file>    write the offset and CRC32 of every page\n"
+            "  -r <file>    write the regions that are not erased\n"
+            "  -z <file>    write an LZSS compressed copy of the image\n"
+            "  -s <key>     sign the image with an ECDSA P-256 key file\n"
+            "  -K <key>     print the SIGN_PUBLIC_KEY definition for a key\n"
+            "  -v           report the header, sizes and time taken\n");
+    exit(2);
+}
+
+//*****************************************************************************
+//
+// Reads the input, fills in the header and writes the outputs.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    uint32_t ui32Base, ui32PageSize, ui32Size, ui32Header, ui32Idx;
+    uint32_t ui32CRC, ui32Page, ui32Length, ui32Packed, *pui32PageCRC;
+    uint32_t ui32Total;
+    const char *pcPages, *pcRegions, *pcCompressed, *pcKernel, *pcKey;
+    uint8_t *pui8In, *pui8Image, *pui8Packed;
+    uint64_t ui64Start;
+    struct stat sStat;
+    FILE *psPages;
+    bool bVerbose, bOk;
+    int iOpt, iFd;
+
+    ui32Base = 0x8000;
+    ui32PageSize = 1024;
+    pcPages = 0;
+    pcRegions = 0;
+    pcCompressed = 0;
+    pcKey = 0;
+    bVerbose = false;
+    while((iOpt = getopt(argc, argv, "a:P:p:r:z:s:K:v")) != -1)
+    {
+        switch(iOpt)
+        {
+            case 'a': ui32Base = strtoul(optarg, 0, 0); break;
+            case 'P': ui32PageSize = strtoul(optarg, 0, 0); break;
+            case 'p': pcPages = optarg; break;
+            case 'r': pcRegions = optarg; break;
+            case 'z': pcCompressed = optarg; break;
+            case 's': pcKey = optarg; break;
+            case 'K': return(PrintPublicKey(optarg) ? 0 : 1);
+            case 'v': bVerbose = true; break;
+            default: Usage();
+        }
+    }
+    if((optind != (argc - 2)) || !ui32PageSize || (ui32PageSize & 3))
+    {
+        Usage();
+    }
+    ui64Start = TimeNow();
+    pcKernel = CRC32Init();
+
+    //
+    // Map the input and place it in an image of the flash that starts out
+    // erased.
+    //
+    iFd = open(argv[optind], O_RDONLY);
+    if((iFd < 0) || fstat(iFd, &sStat))
+    {
+        perror(argv[optind]);
+        return(1);
+    }
+    pui8In = 0;
+    if(sStat.st_size)
+    {
+        pui8In = mmap(0, sStat.st_size, PROT_READ, MAP_PRIVATE, iFd, 0);
+        if(pui8In == MAP_FAILED)
+        {
+            perror(argv[optind]);
+            return(1);
+        }
+    }
+    pui8Image = malloc(MAX_IMAGE_SIZE);
+    if(!pui8Image)
+    {
+        fprintf(stderr, "blpack: out of memory\n");
+        return(1);
+    }
+    memset(pui8Image, 0xff, MAX_IMAGE_SIZE);
+    ui32Size = 0;
+    if((sStat.st_size >= 4) && !memcmp(pui8In, "\177ELF", 4))
+    {
+        bOk = ReadElf(pui8In, sStat.st_size, pui8Image, &ui32Size, ui32Base);
+    }
+    else if(sStat.st_size && (pui8In[0] == ':'))
+    {
+        bOk = ReadHex(pui8In, sStat.st_size, pui8Image, &ui32Size, ui32Base);
+    }
+    else
+    {
+        bOk = ImagePlace(pui8Image, &ui32Size, ui32Base, ui32Base, pui8In,
+                         sStat.st_size);
+    }
+    if(!bOk)
+    {
+        return(1);
+    }
+    if(sStat.st_size)
+    {
+        munmap(pui8In, sStat.st_size);
+    }
+    close(iFd);
+
+    //
+    // The image is a whole number of words, as the boot loader checks it.
+    //
+    ui32Size = (ui32Size + 3) & ~3;
+
+    //
+    // Find the image information header.
+    //
+    for(ui32Header = 0; ui32Header < HEADER_SEARCH_WORDS; ui32Header++)
+    {
+        if(((ui32Header + 4) * 4) > ui32Size)
+        {
+            ui32Header = HEADER_SEARCH_WORDS;
+            break;
+        }
+        if((((uint32_t *)pui8Image)[ui32Header] == HEADER_MARKER0) &&
+           (((uint32_t *)pui8Image)[ui32Header + 1] == HEADER_MARKER1))
+        {
+            break;
+        }
+    }
+    if(ui32Header == HEADER_SEARCH_WORDS)
+    {
+        fprintf(stderr, "blpack: no image information header (0x%08x "
+                "0x%08x) in the first %u words\n", HEADER_MARKER0,
+                HEADER_MARKER1, HEADER_SEARCH_WORDS);
+        return(1);
+    }
+    ((uint32_t *)pui8Image)[ui32Header + 2] = ui32Size;
+
+    //
+    // Work through the image a page at a time, continuing the image CRC32
+    // (which skips the CRC word) and taking the CRC32 of each page.  The
+    // page holding the header is hashed once the CRC is in place.
+    //
+    pui32PageCRC = malloc((((ui32Size + SIGNATURE_SIZE) / ui32PageSize) + 1) *
+                          4);
+    if(!pui32PageCRC)
+    {
+        fprintf(stderr, "blpack: out of memory\n");
+        return(1);
+    }
+    ui32Idx = (ui32Header + 3) * 4;
+    ui32CRC = 0xffffffff;
+    for(ui32Page = 0; ui32Page < ui32Size; ui32Page += ui32PageSize)
+    {
+        ui32Length = ((ui32Size - ui32Page) < ui32PageSize) ?
+                     (ui32Size - ui32Page) : ui32PageSize;
+        if((ui32Idx >= ui32Page) && (ui32Idx < (ui32Page + ui32Length)))
+        {
+            ui32CRC = g_pfnCRC32(pui8Image + ui32Page, ui32Idx - ui32Page,
+                                 ui32CRC);
+            ui32CRC = g_pfnCRC32(pui8Image + ui32Idx + 4,
+                                 ui32Page + ui32Length - ui32Idx - 4,
+                                 ui32CRC);
+        }
+        else
+        {
+            ui32CRC = g_pfnCRC32(pui8Image + ui32Page, ui32Length, ui32CRC);
+            if(pcPages)
+            {
+                pui32PageCRC[ui32Page / ui32PageSize] =
+                    g_pfnCRC32(pui8Image + ui32Page, ui32Length,
+                               0xffffffff) ^ 0xffffffff;
+            }
+        }
+    }
+    ui32CRC ^= 0xffffffff;
+    ((uint32_t *)pui8Image)[ui32Header + 3] = ui32CRC;
+
+    //
+    // Sign the image, now that the header is complete, and append the
+    // signature.  The page that the image ends in is hashed again below.
+    //
+    ui32Total = ui32Size;
+    if(pcKey)
+    {
+        if(ui32Size > (MAX_IMAGE_SIZE - SIGNATURE_SIZE))
+        {
+            fprintf(stderr, "blpack: no room for the signature\n");
+            return(1);
+        }
+        if(!Sign(pcKey, pui8Image, ui32Size, pui8Image + ui32Size))
+        {
+            return(1);
+        }
+        ui32Total += SIGNATURE_SIZE;
+    }
+
+    //
+    // Write the page list, if asked for, now that every page is final.
+    //
+    if(pcPages)
+    {
+        ui32Page = (ui32Idx / ui32PageSize) * ui32PageSize;
+        ui32Length = ((ui32Size - ui32Page) < ui32PageSize) ?
+                     (ui32Size - ui32Page) : ui32PageSize;
+        pui32PageCRC[ui32Page / ui32PageSize] =
+            g_pfnCRC32(pui8Image + ui32Page, ui32Length, 0xffffffff) ^
+            0xffffffff;
+        for(ui32Page = (ui32Size / ui32PageSize) * ui32PageSize;
+            ui32Page < ui32Total; ui32Page += ui32PageSize)
+        {
+            ui32Length = ((ui32Total - ui32Page) < ui32PageSize) ?
+                         (ui32Total - ui32Page) : ui32PageSize;
+            pui32PageCRC[ui32Page / ui32PageSize] =
+                g_pfnCRC32(pui8Image + ui32Page, ui32Length, 0xffffffff) ^
+                0xffffffff;
+        }
+        psPages = fopen(pcPages, "w");
+        if(!psPages)
+        {
+            perror(pcPages);
+            return(1);
+        }
+        for(ui32Page = 0; ui32Page < ui32Total; ui32Page += ui32PageSize)
+        {
+            fprintf(psPages, "0x%08x 0x%08x\n", ui32Base + ui32Page,
+                    pui32PageCRC[ui32Page / ui32PageSize]);
+        }
+        if(fclose(psPages))
+        {
+            perror(pcPages);
+            return(1);
+        }
+    }
+
+    //
+    // Write the image and, if asked for, the compressed copy.
+    //
+    if(!WriteFile(argv[optind + 1], pui8Image, ui32Total) ||
+       (pcRegions && !WriteRegions(pcRegions, pui8Image, ui32Total, ui32Base)))
+    {
+        return(1);
+    }
+    ui32Packed = 0;
+    if(pcCompressed)
+    {
+        pui8Packed = malloc(ui32Total + (ui32Total / 8) + 16);
+        if(!pui8Packed)
+        {
+            fprintf(stderr, "blpack: out of memory\n");
+            return(1);
+        }
+        ui32Packed = Compress(pui8Image, ui32Total, pui8Packed);
+        if(!WriteFile(pcCompressed, pui8Packed, ui32Packed))
+        {
+            return(1);
+        }
+    }
+
+    if(bVerbose)
+    {
+        printf("header:    word %u, length %u, crc32 0x%08x (%s)\n",
+               ui32Header, ui32Size, ui32CRC, pcKernel);
+        if(pcKey)
+        {
+            printf("signature: ECDSA P-256, %u bytes at offset %u\n",
+                   SIGNATURE_SIZE, ui32Size);
+        }
+        if(pcCompressed)
+        {
+            printf("lzss:      %u bytes (%.1f%%)\n", ui32Packed,
+                   (ui32Packed * 100.0) / ui32Total);
+        }
+        printf("time:      %.3f ms\n", (TimeNow() - ui64Start) / 1000.0);
+    }
+
+    return(0);
+}
@@ -0,0 +1,755 @@
+//*****************************************************************************
+//
+// blsim.c - Host simulator for benchmarking the boot loader update path.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// This program runs the boot loader's own Updater(), packet, UART, timer and
+// flash code on a Linux host against an emulated register space, while a
+// model of the host updater drives a download through a model of the UART
+// link.  Time is simulated in system clock cycles, so the results report the
+// throughput that the protocol, the baud rate and the flash timing allow
+// rather than anything about the speed of the host running the simulation.
+//
+// Build it with the Makefile in this directory, which builds the simulator
+// once for each set of boot loader options that it checks.  TIVAWARE must
+// point at the TivaWare installation that the CCS project takes its inc/
+// headers from:
+//
+//     make -C tools/blsim TIVAWARE=<path>
+//     make -C tools/blsim TIVAWARE=<path> check
+//
+// The first builds blsim with the options in bl_config.h, adding any given
+// in BLFLAGS (for example BLFLAGS=-DIMAGE_DIGEST); the second builds and runs
+// every variant that the Makefile lists against test images that it makes,
+// and fails if any of them reports a failure.  Then run:
+//
+//     blsim [options] <image.bin>
+//
+// or, to serve a real host updater over a pseudo-terminal instead of the
+// host model:
+//
+//     blsim -P /tmp/ttyBL [-o flash.bin] [image.bin] &
+//     blupdate -p /tmp/ttyBL image.bin
+//
+// In that mode the UART model reads and writes the pty, the simulated time
+// follows the real time while the boot loader waits for the host, and the
+// simulator exits once the host sends the reset command, writing what was
+// programmed to the -o file and comparing it with the image if one is given.
+//
+// The peripheral models are in sim_periph.c, the host model is in
+// sim_host.c, the faults that -F injects on the link are in sim_fault.c, and
+// with -DSSI_ENABLE_UPDATE the host model runs the download over the SSI and
+// uDMA models in sim_ssi.c in place of the UART.  With -DUART_NODE_ID, -N
+// runs the update of several boot loaders at once over the RS-485 bus model
+// in sim_bus.c, and with -DCAN_ENABLE_UPDATE the update of the boot loader
+// and of -n nodes in all runs over the CAN controller and CAN bus models in
+// sim_can.c.  With -DENET_ENABLE_UPDATE the boot loader fetches the image
+// with BOOTP and TFTP over the Ethernet MAC and server models in sim_emac.c,
+// and with -DUSB_ENABLE_UPDATE a USB host downloads the image with DFU over
+// the USB controller model in sim_usb.c.
+// Each boot loader feature that has checks of its own keeps
+// them, and a description of what they check, in a sim_<feature>.c file.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "inc/hw_flash.h"
+#include "inc/hw_memmap.h"
+#include "blsim.h"
+
+//*****************************************************************************
+//
+// The options that only a boot loader built for an RS-485 bus, for CAN or
+// for Ethernet takes.  -Z is only given to the simulators that the bus
+// starts as its nodes.  A boot loader built for USB takes none.
+//
+//*****************************************************************************
+#if (defined(UART_NODE_ID) + defined(CAN_ENABLE_UPDATE) +                     \
+     defined(ENET_ENABLE_UPDATE) + defined(USB_ENABLE_UPDATE)) > 1
+#error ERROR: The simulator models one of RS-485, CAN, Ethernet or USB!
+#endif
+#ifdef UART_NODE_ID
+#define SIM_BUS_OPTIONS         "N:x:g:Z:"
+#elif defined(CAN_ENABLE_UPDATE)
+#define SIM_BUS_OPTIONS         "n:x:"
+#elif defined(ENET_ENABLE_UPDATE)
+#define SIM_BUS_OPTIONS         "x:"
+#else
+#define SIM_BUS_OPTIONS         ""
+#endif
+
+//*****************************************************************************
+//
+// The flash and host timing given by the options, and the baud rate that
+// overrides the one that the boot loader configures, if any.
+//
+//*****************************************************************************
+static double g_dProgramUs = 30.0;
+static double g_dBufferUs = 300.0;
+static double g_dEraseMs = 15.0;
+static double g_dTurnaroundUs = 0.0;
+static double g_dTimeoutMs = 1000.0;
+uint32_t g_ui32BaudOverride;
+
+//*****************************************************************************
+//
+// The baud rate of the UART that the application hands off when the boot
+// loader is entered warm, or zero to start it from reset.
+//
+//*****************************************************************************
+uint32_t g_ui32HandoffBaud;
+
+//*****************************************************************************
+//
+// Sets the flash and host timing in cycles of the system clock.
+//
+//*****************************************************************************
+void
+SimTimingSet(void)
+{
+    g_ui64ProgramCycles = MicrosecondsToCycles(g_dProgramUs);
+    g_ui64BufferCycles = MicrosecondsToCycles(g_dBufferUs);
+    g_ui64EraseCycles = MicrosecondsToCycles(g_dEraseMs * 1000.0);
+    g_ui64Turnaround = MicrosecondsToCycles(g_dTurnaroundUs);
+    g_ui64HostTimeout = MicrosecondsToCycles(g_dTimeoutMs * 1000.0);
+}
+
+//*****************************************************************************
+//
+// Runs the boot loader, configuring the device first as it does at reset if
+// asked to, until the models end the run.  The models jump back here once
+// the host has the response to the reset command, or the board is reset.
+// Nothing that changes between the setjmp() and the jump back is held in
+// this function, so none of it can be lost to the jump.
+//
+//*****************************************************************************
+void
+SimRun(bool bConfigure)
+{
+    if(setjmp(g_sDone))
+    {
+        return;
+    }
+
+#ifdef CAN_ENABLE_UPDATE
+    //
+    // The host starts on the CAN bus as soon as the controller is set up.
+    //
+    if(bConfigure)
+    {
+        ConfigureCAN();
+    }
+    SimTimingSet();
+    SimCANStart(g_ui64Now);
+    UpdaterCAN();
+#elif defined(ENET_ENABLE_UPDATE)
+    //
+    // The server answers as soon as the MAC is set up.
+    //
+    if(bConfigure)
+    {
+        ConfigureEnet();
+    }
+    SimTimingSet();
+    SimEMACStart(g_ui64Now);
+    UpdateBOOTP();
+#elif defined(USB_ENABLE_UPDATE)
+    //
+    // The host sees the device once the boot loader connects it to the bus.
+    //
+    if(bConfigure)
+    {
+        ConfigureUSB();
+    }
+    SimTimingSet();
+    SimUSBStart(g_ui64Now);
+    UpdaterUSB();
+#else
+    if(bConfigure)
+    {
+        ConfigureDevice();
+    }
+    if(g_ui32BaudOverride)
+    {
+        g_ui32BaudRate = g_ui32BaudOverride;
+    }
+    if(!g_ui32BaudRate)
+    {
+        fprintf(stderr, "blsim: the boot loader set no baud rate\n");
+        exit(1);
+    }
+    g_ui64ByteCycles = ((uint64_t)g_ui32SysClockHz * 10) / g_ui32BaudRate;
+#ifdef SSI_ENABLE_UPDATE
+    //
+    // The host clocks the SSI as fast as a slave allows, in place of the
+    // UART.
+    //
+    g_ui64ByteCycles = 8 * SIM_SSI_CLOCK_DIV;
+#endif
+    SimTimingSet();
+#ifdef UART_NODE_ID
+    if(g_iBusFd >= 0)
+    {
+        SimBusStart();
+    }
+    else if(g_iPtyFd < 0)
+#else
+    if(g_iPtyFd < 0)
+#endif
+    {
+        SimFrameSend(g_ui64Now);
+    }
+    Updater();
+#endif
+}
+
+//*****************************************************************************
+//
+// Prints the options.
+//
+//*****************************************************************************
+static void
+Usage(void)
+{
+    fprintf(stderr,
+            "usage: blsim [options] <image.bin>\n"
+            "       blsim -P <link> [-o <flash.bin>] [options] [image.bin]\n"
+            "  -b <baud>    UART baud rate (default: as configured by the "
+            "boot loader)\n"
+            "  -p <us>      flash word program time (default 30)\n"
+            "  -W <us>      flash 32 word write buffer program time "
+            "(default 300)\n"
+            "  -e <ms>      flash block erase time (default 15)\n"
+            "  -t <us>      host turnaround after each response "
+            "(default 0)\n"
+            "  -w <ms>      host response timeout (default 1000)\n"
+            "  -a <cycles>  cost of each register access (default 2)\n"
+            "  -P <link>    serve a host updater on a pty linked from <link>\n"
+            "  -o <file>    write the programmed flash to <file> on reset\n"
+            "  -d <n>       drop every <n>th byte received from the pty\n"
+            "  -l           send the image in plain 0x6006 frames, without "
+            "block numbers\n"
+            "  -F <n>       damage every <n>th data frame sent, dropping, "
+            "repeating or\n"
+            "               corrupting a byte or losing the reply in turn\n"
+            "  -f <block>   make the program of data block <block> fail "
+            "once\n"
+            "  -S           send the image as a new boot loader and install "
+            "it\n"
+            "  -H <baud>    enter warm, with a handoff from an application "
+            "whose\n"
+            "               UART runs at <baud>\n"
+            "  -M <file>    send <file> to the reserved parameter block "
+            "along with\n"
+            "               the image, in one manifest session\n"
+            "  -E <n>       start the blocks that the image is sent to at "
+            "<n> erases\n"
+            "  -L <n>       lose the link before frame <n>, with the image "
+            "already in\n"
+            "               flash, and recover once the watchdog resets "
+            "the board\n"
+#ifdef UART_NODE_ID
+            "  -N <sim>     add a node on the bus, run by <sim>, which is "
+            "built with\n"
+            "               another UART_NODE_ID (up to %u nodes in all)\n"
+            "  -x <block>   make the last node miss the broadcast of "
+            "<block>\n"
+            "  -g <n>       broadcast <n> blocks between polls of the nodes "
+            "(default %u)\n", SIM_BUS_NODES, SIM_BUS_GROUP
+#elif defined(CAN_ENABLE_UPDATE)
+            "  -n <n>       update <n> nodes on the CAN bus, the boot loader "
+            "among them\n"
+            "               (up to %u, default 1)\n"
+            "  -x <n>       make each node lose a different one of every "
+            "<n> data frames\n", SIM_CAN_NODES
+#elif defined(ENET_ENABLE_UPDATE)
+            "  -x <n>       make the server damage every <n>th frame that "
+            "it sends\n"
+#endif
+            );
+    exit(1);
+}
+
+//*****************************************************************************
+//
+// Runs the simulation and reports the results.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    double dSeconds;
+    uint32_t ui32Size, ui32Idx, ui32Frames, ui32Bytes, ui32Base;
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+    uint32_t ui32Worn;
+#endif
+    const char *pcPtyLink, *pcOutput;
+    uint8_t *pui8Image;
+    FILE *psFile;
+    int iOpt, iResult;
+
+    pcPtyLink = 0;
+    pcOutput = 0;
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+    ui32Worn = 0;
+#endif
+    while((iOpt = getopt(argc, argv, "b:p:W:e:t:w:a:P:o:d:lF:f:SH:M:E:L:"
+                         SIM_BUS_OPTIONS)) != -1)
+    {
+        switch(iOpt)
+        {
+            case 'b': g_ui32BaudOverride = strtoul(optarg, 0, 0); break;
+            case 'p': g_dProgramUs = strtod(optarg, 0); break;
+            case 'W': g_dBufferUs = strtod(optarg, 0); break;
+            case 'e': g_dEraseMs = strtod(optarg, 0); break;
+            case 't': g_dTurnaroundUs = strtod(optarg, 0); break;
+            case 'w': g_dTimeoutMs = strtod(optarg, 0); break;
+            case 'a': g_ui32AccessCycles = strtoul(optarg, 0, 0); break;
+            case 'P': pcPtyLink = optarg; break;
+            case 'o': pcOutput = optarg; break;
+            case 'd': g_ui32DropEvery = strtoul(optarg, 0, 0); break;
+            case 'l': g_bPlainData = true; break;
+            case 'F': g_ui32FaultEvery = strtoul(optarg, 0, 0); break;
+            case 'f':
+            {
+                g_ui32FlashFailAddress = (APP_START_ADDRESS +
+                                          (strtoul(optarg, 0, 0) * 128));
+                break;
+            }
+#ifdef BL_UPDATE_STAGED
+            case 'S': g_bStaged = true; break;
+#endif
+#ifdef BL_HANDOFF_ADDRESS
+            case 'H': g_ui32HandoffBaud = strtoul(optarg, 0, 0); break;
+#endif
+#ifdef SIM_MANIFEST
+            case 'M':
+            {
+                g_ui32ParamsSize = SimImageRead(optarg, &g_pui8Params);
+                if(!g_ui32ParamsSize || (g_ui32ParamsSize > FLASH_RSVD_SPACE))
+                {
+                    fprintf(stderr, "blsim: -M needs a parameter block of 1 "
+                            "to %u bytes\n", FLASH_RSVD_SPACE);
+                    return(1);
+                }
+                break;
+            }
+#endif
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+            case 'E': ui32Worn = strtoul(optarg, 0, 0); break;
+#endif
+#ifdef BL_WATCHDOG_TIMEOUT
+            case 'L': g_ui32LinkLost = strtoul(optarg, 0, 0); break;
+#endif
+#ifdef UART_NODE_ID
+            case 'N':
+            {
+                if(g_ui32BusNodes == (SIM_BUS_NODES - 1))
+                {
+                    Usage();
+                }
+                g_ppcBusNodes[g_ui32BusNodes++] = optarg;
+                break;
+            }
+            case 'x': g_ui32BusMiss = strtoul(optarg, 0, 0); break;
+            case 'g': g_ui32BusGroup = strtoul(optarg, 0, 0); break;
+            case 'Z': g_iBusFd = strtol(optarg, 0, 0); break;
+#elif defined(CAN_ENABLE_UPDATE)
+            case 'n': g_ui32CANNodes = strtoul(optarg, 0, 0); break;
+            case 'x': g_ui32CANLoseEvery = strtoul(optarg, 0, 0); break;
+#elif defined(ENET_ENABLE_UPDATE)
+            case 'x': g_ui32EMACDamageEvery = strtoul(optarg, 0, 0); break;
+#endif
+            default: Usage();
+        }
+    }
+    if((optind < (argc - 1)) || (!pcPtyLink && (optind != (argc - 1))))
+    {
+        Usage();
+    }
+#ifdef SSI_ENABLE_UPDATE
+    if(pcPtyLink)
+    {
+        fprintf(stderr, "blsim: -P cannot be used with SSI_ENABLE_UPDATE\n");
+        return(1);
+    }
+#endif
+#ifdef CAN_ENABLE_UPDATE
+    if(pcPtyLink || g_ui32FaultEvery || g_bPlainData || !g_ui32CANNodes ||
+       (g_ui32CANNodes > SIM_CAN_NODES) || (g_ui32CANLoseEvery == 1))
+    {
+        fprintf(stderr, "blsim: CAN needs 1 to %u nodes, -x of 2 or more and "
+                "no -P, -F or -l\n", SIM_CAN_NODES);
+        return(1);
+    }
+#endif
+#ifdef ENET_ENABLE_UPDATE
+    if(pcPtyLink || g_ui32FaultEvery || g_bPlainData ||
+       (g_ui32EMACDamageEvery == 1))
+    {
+        fprintf(stderr, "blsim: Ethernet needs -x of 2 or more and no -P, -F "
+                "or -l\n");
+        return(1);
+    }
+#endif
+#ifdef USB_ENABLE_UPDATE
+    if(pcPtyLink || g_ui32FaultEvery || g_bPlainData)
+    {
+        fprintf(stderr, "blsim: USB needs no -P, -F or -l\n");
+        return(1);
+    }
+#endif
+#ifdef UART_NODE_ID
+    if(g_ui32BusNodes && (pcPtyLink || g_ui32FaultEvery || g_bPlainData ||
+                          !g_ui32BusGroup))
+    {
+        fprintf(stderr, "blsim: -N needs a group of 1 or more blocks and "
+                "no -P, -F or -l\n");
+        return(1);
+    }
+#endif
+    if(g_ui32FaultEvery && (pcPtyLink || (g_ui32FaultEvery < 2)))
+    {
+        fprintf(stderr, "blsim: -F needs a frame count of 2 or more and no "
+                "-P\n");
+        return(1);
+    }
+#ifdef SIM_MANIFEST
+    if(g_pui8Params && pcPtyLink)
+    {
+        fprintf(stderr, "blsim: -M cannot be used with -P\n");
+        return(1);
+    }
+#endif
+#ifdef BL_WATCHDOG_TIMEOUT
+    if((g_ui32LinkLost != 0xffffffff) && (pcPtyLink || !g_ui32LinkLost))
+    {
+        fprintf(stderr, "blsim: -L needs a frame of 1 or more and no -P\n");
+        return(1);
+    }
+#ifdef BL_UPDATE_STAGED
+    if((g_ui32LinkLost != 0xffffffff) && g_bStaged)
+    {
+        fprintf(stderr, "blsim: -L cannot be used with -S\n");
+        return(1);
+    }
+#endif
+#endif
+
+    //
+    // Read the image, which the host model sends and which the result of a
+    // pty session is compared with.
+    //
+    pui8Image = 0;
+    ui32Size = 0;
+    iResult = 0;
+    if(optind < argc)
+    {
+        ui32Size = SimImageRead(argv[optind], &pui8Image);
+    }
+
+    //
+    // Set up the flash, which starts out erased, and either pre-frame the
+    // update for the host model or wait for a host on the pty.
+    //
+    g_pui8Flash = malloc(SIM_FLASH_SIZE);
+    if(!g_pui8Flash)
+    {
+        fprintf(stderr, "blsim: out of memory\n");
+        return(1);
+    }
+    memset(g_pui8Flash, 0xff, SIM_FLASH_SIZE);
+#ifdef SIM_EEPROM
+    memset(g_pui8EEPROM, 0xff, SIM_EEPROM_SIZE);
+#endif
+#ifdef ENABLE_FLASH_DUMP
+    SimDumpProtect();
+#endif
+#ifdef META_EEPROM_ADDRESS
+    iResult |= SimMetaCheck();
+#endif
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+    SimWearSet(APP_START_ADDRESS, ui32Size, ui32Worn);
+#endif
+#ifdef BL_WATCHDOG_TIMEOUT
+    //
+    // The link can only be lost from under an application that is already
+    // there, so put the image in flash as the last good one.
+    //
+    if((g_ui32LinkLost != 0xffffffff) &&
+       (ui32Size <= (SIM_FLASH_SIZE - APP_START_ADDRESS)))
+    {
+        memcpy(g_pui8Flash + APP_START_ADDRESS, pui8Image, ui32Size);
+    }
+#endif
+#ifdef BL_UPDATE_STAGED
+    if(g_bStaged)
+    {
+        if(pcPtyLink || (ui32Size > APP_START_ADDRESS))
+        {
+            fprintf(stderr, "blsim: -S needs an image of up to %u bytes and "
+                    "no -P\n", APP_START_ADDRESS);
+            return(1);
+        }
+        SimOldBootLoader();
+    }
+#endif
+#ifdef IMAGE_DIGEST
+    iResult |= SimSHA256Check();
+#endif
+#ifdef DECRYPT_AES_MODE
+    iResult |= SimAESCheck();
+#endif
+#ifdef CHECK_SIGNATURE
+    iResult |= SimECDSACheck();
+#endif
+#ifdef LOOPBACK_ENABLE_UPDATE
+    iResult |= SimLoopbackCheck();
+#endif
+#ifdef CAN_ENABLE_UPDATE
+    //
+    // The CAN bus runs the update of all the nodes and reports the results.
+    //
+    return(iResult | SimCANRun(pui8Image, ui32Size));
+#endif
+#ifdef ENET_ENABLE_UPDATE
+    //
+    // The server runs the update and reports the results.
+    //
+    return(iResult | SimEMACRun(pui8Image, ui32Size));
+#endif
+#ifdef USB_ENABLE_UPDATE
+    //
+    // The host runs the update and reports the results.
+    //
+    return(iResult | SimUSBRun(pui8Image, ui32Size));
+#endif
+#ifdef UART_NODE_ID
+    //
+    // A node on the bus runs until it is reset and reports back to the bus,
+    // which runs the update of all the nodes and reports the results.
+    //
+    if(g_iBusFd >= 0)
+    {
+        return(SimBusNode(pui8Image, ui32Size));
+    }
+    if(g_ui32BusNodes)
+    {
+        return(iResult | SimBusRun(argc, argv, pui8Image, ui32Size));
+    }
+#endif
+    if(pcPtyLink)
+    {
+        SimPtyOpen(pcPtyLink);
+    }
+    else
+    {
+        SimFramesBuild(pui8Image, ui32Size);
+    }
+
+    //
+    // Run the boot loader, from reset unless it is entered warm.
+    //
+#ifdef BL_HANDOFF_ADDRESS
+    if(g_ui32HandoffBaud)
+    {
+        iResult |= SimHandoffCheck(g_ui32HandoffBaud);
+    }
+#endif
+    SimRun(!g_ui32HandoffBaud);
+#ifdef BL_WATCHDOG_TIMEOUT
+    if(g_bWatchdogReset)
+    {
+        iOpt = SimWatchdogRestart(pui8Image, ui32Size);
+        if(iOpt <= 0)
+        {
+            return(iResult | (iOpt ? 1 : 0));
+        }
+    }
+#endif
+
+    //
+    // Closing the pty discards whatever the host has not yet read of it, so
+    // give the host time to read the reply to the reset command first.
+    //
+    if(pcPtyLink)
+    {
+        usleep(SIM_PTY_LINGER);
+    }
+
+    //
+    // Save what was programmed if asked to.
+    //
+    if(pcOutput && (g_ui32FlashEnd > APP_START_ADDRESS))
+    {
+        psFile = fopen(pcOutput, "wb");
+        if(!psFile ||
+           (fwrite(g_pui8Flash + APP_START_ADDRESS, 1,
+                   g_ui32FlashEnd - APP_START_ADDRESS, psFile) !=
+            (g_ui32FlashEnd - APP_START_ADDRESS)) || fclose(psFile))
+        {
+            perror(pcOutput);
+            return(1);
+        }
+    }
+
+    //
+    // Report the results.  Only the host model's timing is meaningful.
+    //
+    ui32Base = APP_START_ADDRESS;
+#ifdef BL_UPDATE_STAGED
+    if(g_bStaged)
+    {
+        ui32Base = 0;
+    }
+#endif
+    if(ui32Size)
+    {
+        printf("image:     %u bytes at 0x%08x\n", ui32Size, ui32Base);
+    }
+#ifdef SIM_MANIFEST
+    if(g_pui8Params)
+    {
+        printf("params:    %u bytes at 0x%08x\n", g_ui32ParamsSize,
+               SIM_PARAMS_ADDRESS);
+    }
+#endif
+#ifdef SSI_ENABLE_UPDATE
+    printf("link:      SSI at %u bit/s, %u Hz system clock\n",
+           g_ui32SysClockHz / SIM_SSI_CLOCK_DIV, g_ui32SysClockHz);
+#else
+    printf("link:      %u baud, %u Hz system clock\n", g_ui32BaudRate,
+           g_ui32SysClockHz);
+#endif
+    if(!pcPtyLink)
+    {
+        printf("\n%-9s %8s %10s %12s %12s %10s\n", "phase", "frames",
+               "bytes", "time (ms)", "bytes/s", "frames/s");
+        ui32Frames = 0;
+        ui32Bytes = 0;
+        for(ui32Idx = 0; ui32Idx < NUM_PHASES; ui32Idx++)
+        {
+            dSeconds = CyclesToSeconds(g_psPhases[ui32Idx].ui64End -
+                                       g_psPhases[ui32Idx].ui64Start);
+            printf("%-9s %8u %10u %12.3f %12.0f %10.1f\n",
+                   g_ppcPhaseNames[ui32Idx], g_psPhases[ui32Idx].ui32Frames,
+                   g_psPhases[ui32Idx].ui32Bytes, dSeconds * 1000.0,
+                   dSeconds ? (g_psPhases[ui32Idx].ui32Bytes / dSeconds) :
+                              0.0,
+                   dSeconds ? (g_psPhases[ui32Idx].ui32Frames / dSeconds) :
+                              0.0);
+            ui32Frames += g_psPhases[ui32Idx].ui32Frames;
+            ui32Bytes += g_psPhases[ui32Idx].ui32Bytes;
+        }
+        dSeconds = CyclesToSeconds(g_psPhases[PHASE_RESET].ui64End -
+                                   g_psPhases[PHASE_CONNECT].ui64Start);
+        printf("%-9s %8u %10u %12.3f %12.0f %10.1f\n", "total", ui32Frames,
+               ui32Bytes, dSeconds * 1000.0, ui32Size / dSeconds,
+               ui32Frames / dSeconds);
+        printf("\n");
+    }
+    printf("flash:     %u erase commands, %u words programmed",
+           g_ui32Erases, g_ui32Programs);
+    if(g_ui32BufferPrograms)
+    {
+        printf(", %u through the write buffer", g_ui32BufferPrograms);
+    }
+    printf("\n");
+#ifdef SSI_ENABLE_UPDATE
+    printf("host:      %u retries\n", g_ui32TotalRetries);
+    iResult |= SimSSICheck();
+#else
+    if(!pcPtyLink)
+    {
+        printf("uart:      %u receive overruns, %u host retries\n",
+               g_ui32Overruns, g_ui32TotalRetries);
+    }
+    else if(g_ui32DropEvery)
+    {
+        printf("uart:      %u bytes dropped\n", g_ui32Overruns);
+    }
+#endif
+    if(g_ui32FaultEvery)
+    {
+        iResult |= SimFaultReport();
+    }
+    iResult |= pcPtyLink ? 0 : SimStatsCheck();
+#ifdef IMAGE_DIGEST
+    iResult |= pcPtyLink ? 0 : SimDigestCheck(pui8Image, ui32Size);
+#endif
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+    iResult |= pcPtyLink ? 0 : SimWearCheck();
+#endif
+#ifdef META_EEPROM_ADDRESS
+    iResult |= pcPtyLink ? 0 : SimMetaCountCheck();
+#endif
+#ifdef BL_WATCHDOG_TIMEOUT
+    iResult |= pcPtyLink ? 0 : SimWatchdogReport();
+#endif
+#ifdef ENABLE_FLASH_DUMP
+    iResult |= pcPtyLink ? 0 : SimDumpCheck(pui8Image, ui32Size);
+#endif
+    if(!ui32Size)
+    {
+        return(iResult);
+    }
+    ui32Idx = (memcmp(g_pui8Flash + ui32Base, pui8Image, ui32Size) != 0);
+    if(ui32Idx && g_ui32FaultEvery && g_bPlainData)
+    {
+        //
+        // Plain frames sent again cannot always be told from the next, so
+        // the boot loader may refuse the image instead.
+        //
+        ui32Idx = SimFaultRefused(ui32Base);
+    }
+    else
+    {
+        printf("verify:    %s\n", ui32Idx ? "FAILED" : "ok");
+    }
+#ifdef SIM_MANIFEST
+    if(g_pui8Params)
+    {
+        iResult |= SimManifestCheck();
+    }
+#endif
+#ifdef CHECK_SIGNATURE
+    iResult |= SimSignatureCheck(ui32Size);
+#endif
+#ifdef BOOT_CYCLES_ADDRESS
+    iResult |= SimBootCheck();
+#endif
+#ifdef BL_UPDATE_STAGED
+    if(g_bStaged)
+    {
+        iResult |= SimStagedCheck(pui8Image, ui32Size);
+    }
+#endif
+
+    return((ui32Idx || iResult) ? 1 : 0);
+}
@@ -0,0 +1,522 @@
+//*****************************************************************************
+//
+// blsim.h - Definitions shared by the parts of the boot loader simulator.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __BLSIM_H__
+#define __BLSIM_H__
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "bl_config.h"
+#include "boot_loader/bl_commands.h"
+#if defined(IMAGE_DIGEST) || defined(CHECK_SIGNATURE)
+#include "boot_loader/bl_sha256.h"
+#endif
+#ifdef DECRYPT_AES_MODE
+#include "driverlib/aes.h"
+#include "boot_loader/bl_decrypt.h"
+#endif
+
+//*****************************************************************************
+//
+// The simulator is made up of the models of the peripherals that the boot
+// loader drives (sim_periph.c), the model of the host updater that drives a
+// download through them (sim_host.c), and a file of checks for each boot
+// loader feature that has its own (sim_<feature>.c), all run by blsim.c.
+// The checks of a feature are only built when the boot loader is built with
+// it.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The features that have more than one option to turn them on.
+//
+//*****************************************************************************
+#if defined(FLASH_WEAR_EEPROM_ADDRESS) || defined(META_EEPROM_ADDRESS)
+#define SIM_EEPROM
+#endif
+#if defined(ENABLE_MANIFEST_UPDATE) && defined(FLASH_RSVD_SPACE)
+#define SIM_MANIFEST
+#endif
+
+//*****************************************************************************
+//
+// The boot loader functions and variables that the simulator uses.
+//
+//*****************************************************************************
+extern void ConfigureDevice(void);
+extern void HandoffConfigure(void);
+extern uint32_t g_ui32SysClock;
+extern void Updater(void);
+#if defined(BL_UPDATE_STAGED) && defined(FLASH_WEAR_EEPROM_ADDRESS)
+extern uint32_t g_ui32StageAddress;
+extern uint32_t g_ui32StageSize;
+#endif
+#ifdef BL_WATCHDOG_TIMEOUT
+extern uint32_t g_pui32Stats[NUM_STATS];
+#endif
+#ifdef CAN_ENABLE_UPDATE
+extern void ConfigureCAN(void);
+extern void UpdaterCAN(void);
+#endif
+#ifdef ENET_ENABLE_UPDATE
+extern void ConfigureEnet(void);
+extern void UpdateBOOTP(void);
+extern void SysTickIntHandler(void);
+#endif
+#ifdef USB_ENABLE_UPDATE
+extern void ConfigureUSB(void);
+extern void UpdaterUSB(void);
+extern void USB0DeviceIntHandler(void);
+#endif
+
+//*****************************************************************************
+//
+// The size of the emulated register space and of the flash array.
+//
+//*****************************************************************************
+#define SIM_NUM_REGS            8192
+#define SIM_FLASH_SIZE          (1024 * 1024)
+#define SIM_FLASH_BLOCK         0x4000
+#define SIM_FLASH_BLOCKS        (SIM_FLASH_SIZE / SIM_FLASH_BLOCK)
+
+//*****************************************************************************
+//
+// How long to keep the pty open after the boot loader resets, in
+// microseconds.
+//
+//*****************************************************************************
+#define SIM_PTY_LINGER          200000
+
+//*****************************************************************************
+//
+// The UART receive FIFO depth, and the marker that is placed above the data
+// in the UART data register so that a read can be told from a write.
+//
+//*****************************************************************************
+#define SIM_UART_FIFO           16
+#define SIM_UART_READ_MARK      0x10000000
+
+//*****************************************************************************
+//
+// The number of reads of the UART flag register in a row, returning the same
+// value, that are taken to mean the boot loader is waiting on it.  A check
+// followed by a wait loop reads it twice without waiting.
+//
+//*****************************************************************************
+#define SIM_POLL_REPEATS        3
+
+//*****************************************************************************
+//
+// The most status registers that the boot loader polls in turn while it
+// waits, as it does when it polls every transport for the start of a packet.
+//
+//*****************************************************************************
+#define SIM_NUM_POLLS           4
+
+//*****************************************************************************
+//
+// The frame size limit, the room for a frame with a byte repeated by the
+// fault model or, on a bus, for a frame behind what is left of the one
+// before it, and the ID byte used by the host model, which is the node's
+// address when the boot loader is built for a bus.
+//
+//*****************************************************************************
+#define SIM_MAX_FRAME           (4 + 130 + 2)
+#define SIM_RX_SIZE             ((2 * SIM_MAX_FRAME) + 1)
+#define SIM_STATUS_SIZE         (6 + (4 * NUM_STATS) + 2)
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+#define SIM_REPLY_SIZE          WEAR_REPLY_SIZE
+#else
+#define SIM_REPLY_SIZE          SIM_STATUS_SIZE
+#endif
+#ifdef UART_NODE_ID
+#define SIM_HOST_ID             UART_NODE_ID
+#else
+#define SIM_HOST_ID             0x21
+#endif
+#define SIM_MAX_RETRIES         3
+
+//*****************************************************************************
+//
+// The phases of an update that timing is reported for.
+//
+//*****************************************************************************
+#define PHASE_CONNECT           0
+#define PHASE_ERASE             1
+#define PHASE_PROGRAM           2
+#define PHASE_STATUS            3
+#define PHASE_RESET             4
+#define NUM_PHASES              5
+
+//*****************************************************************************
+//
+// A frame sent by the host model and the length of the response expected.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t pui8Data[SIM_MAX_FRAME];
+    uint32_t ui32Size;
+    uint32_t ui32Payload;
+    uint32_t ui32ReplySize;
+    uint32_t ui32Phase;
+}
+tSimFrame;
+
+//*****************************************************************************
+//
+// Timing statistics for one phase of the update.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint64_t ui64Start;
+    uint64_t ui64End;
+    uint32_t ui32Frames;
+    uint32_t ui32Bytes;
+}
+tSimPhase;
+
+//*****************************************************************************
+//
+// A register in the emulated register space.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Address;
+    volatile uint32_t ui32Value;
+    bool bUsed;
+}
+tSimReg;
+
+//*****************************************************************************
+//
+// The peripheral models, in sim_periph.c.
+//
+//*****************************************************************************
+extern tSimReg *g_psLastReg;
+extern uint64_t g_ui64Now;
+extern uint32_t g_ui32SysClockHz;
+extern uint32_t g_ui32AccessCycles;
+extern uint32_t (*g_pfnBLSimCycleCost)(uint32_t ui32Address);
+extern uint8_t *g_pui8Flash;
+extern uint32_t g_ui32FlashBusyBits;
+extern uint64_t g_ui64FlashBusyUntil;
+extern uint64_t g_ui64ProgramCycles;
+extern uint64_t g_ui64EraseCycles;
+extern uint64_t g_ui64BufferCycles;
+extern uint32_t g_ui32Erases;
+extern uint32_t g_ui32Programs;
+extern uint32_t g_ui32JournalErases;
+extern uint32_t g_ui32JournalPrograms;
+extern uint32_t g_ui32FlashEnd;
+extern uint32_t g_ui32BufferPrograms;
+extern uint32_t g_ui32PowerCut;
+extern uint32_t g_ui32FlashOps;
+extern jmp_buf g_sPowerCut;
+extern uint32_t g_ui32FlashFailAddress;
+extern uint32_t g_ui32BaudRate;
+extern uint64_t g_ui64ByteCycles;
+extern uint8_t g_pui8RxData[SIM_RX_SIZE];
+extern uint64_t g_pui64RxTime[SIM_RX_SIZE];
+extern uint32_t g_ui32RxCount;
+extern uint32_t g_ui32RxHead;
+extern uint32_t g_ui32Overruns;
+extern int g_iPtyFd;
+extern uint32_t g_ui32DropEvery;
+extern uint32_t g_ui32ClockSets;
+extern uint32_t g_ui32UARTSets;
+#ifdef BL_WATCHDOG_TIMEOUT
+extern bool g_bWatchdogReset;
+extern uint64_t g_ui64WatchdogGap;
+extern uint32_t g_ui32WatchdogFeeds;
+#endif
+#ifdef SIM_EEPROM
+#define SIM_EEPROM_SIZE         6144
+extern uint8_t g_pui8EEPROM[SIM_EEPROM_SIZE];
+extern uint32_t g_ui32EEPROMWords;
+extern uint32_t g_ui32EEPROMCut;
+#endif
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+extern uint32_t g_pui32BlockErases[SIM_FLASH_BLOCKS];
+#endif
+extern uint32_t g_ui32RegByte;
+extern tSimReg *SimRegFind(uint32_t ui32Address);
+extern void SimRegResolve(void);
+extern uint32_t SimRxAvailable(uint32_t ui32Depth);
+extern void SimPoll(uint32_t ui32Address, uint32_t ui32Value);
+extern double CyclesToSeconds(uint64_t ui64Cycles);
+extern uint64_t MicrosecondsToCycles(double dMicroseconds);
+extern void SimPtyOpen(const char *pcLink);
+
+//*****************************************************************************
+//
+// The host model, in sim_host.c.
+//
+//*****************************************************************************
+extern tSimFrame *g_psFrames;
+extern uint32_t g_ui32NumFrames;
+extern uint32_t g_ui32Frame;
+extern uint32_t g_ui32ReplyBytes;
+extern uint8_t g_pui8Reply[SIM_REPLY_SIZE];
+extern uint64_t g_ui64ReplyDeadline;
+extern uint64_t g_ui64Turnaround;
+extern uint64_t g_ui64HostTimeout;
+extern uint32_t g_ui32Retries;
+extern uint32_t g_ui32TotalRetries;
+extern tSimPhase g_psPhases[NUM_PHASES];
+extern const char * const g_ppcPhaseNames[NUM_PHASES];
+extern jmp_buf g_sDone;
+extern bool g_bPlainData;
+extern bool g_bStatsRead;
+extern uint8_t g_ui8StatsStatus;
+extern uint32_t SimCRC16(const uint8_t *pui8Data, uint32_t ui32Size);
+extern bool SimReplyIntact(const uint8_t *pui8Reply, uint32_t ui32Size);
+extern void SimFrameBuild(tSimFrame *psFrame, uint8_t ui8Cmd,
+                          uint16_t ui16Address, const uint8_t *pui8Payload,
+                          uint32_t ui32Payload, uint32_t ui32ReplySize,
+                          uint32_t ui32Phase);
+extern void SimFramesBuild(const uint8_t *pui8Image, uint32_t ui32Size);
+extern void SimFrameSend(uint64_t ui64Start);
+extern void SimFrameClock(uint64_t ui64Start);
+extern void SimReplyByte(uint8_t ui8Data, uint64_t ui64Time);
+extern void SimReplyDone(uint64_t ui64Time);
+extern void SimReplyTimeout(void);
+extern uint32_t SimImageRead(const char *pcPath, uint8_t **ppui8Image);
+extern int SimStatsCheck(void);
+
+//*****************************************************************************
+//
+// The fault model, in sim_fault.c.
+//
+//*****************************************************************************
+extern uint32_t g_ui32FaultEvery;
+extern uint32_t SimFaultInject(uint8_t *pui8Data, uint32_t ui32Size,
+                               uint64_t ui64Start);
+extern bool SimFaultReplyLost(void);
+extern void SimFaultRecovered(uint64_t ui64Time);
+extern int SimFaultReport(void);
+extern int SimFaultRefused(uint32_t ui32Base);
+
+//*****************************************************************************
+//
+// The SSI and uDMA models, in sim_ssi.c, which the host model drives in place
+// of the UART when the boot loader is built with the SSI.  The host clocks
+// the SSI at the fastest rate that a slave allows, one twelfth of the system
+// clock, and the SSI FIFOs are eight bytes deep.
+//
+//*****************************************************************************
+#ifdef SSI_ENABLE_UPDATE
+#define SIM_SSI_CLOCK_DIV       12
+#define SIM_SSI_FIFO            8
+#define SIM_SSI_READ_MARK       0x10000000
+extern void SimSSIFrameQueue(uint64_t ui64Start);
+extern void SimSSIUpdate(void);
+extern uint64_t SimSSINextEvent(void);
+extern bool SimSSIPolled(uint32_t ui32Address);
+extern bool SimSSIRead(uint32_t ui32Address, uint32_t *pui32Value);
+extern bool SimSSIWrite(uint32_t ui32Address, uint32_t ui32Value);
+extern void SimSSIReadDone(uint32_t ui32Address);
+extern int SimSSICheck(void);
+#endif
+
+//*****************************************************************************
+//
+// The RS-485 bus model, in sim_bus.c, which runs several boot loaders built
+// with UART_NODE_ID, each in a process of its own, on one bus that the host
+// model updates them all over.  The bus has up to eight nodes, and by
+// default the host polls them after every sixteen blocks that it broadcasts.
+//
+//*****************************************************************************
+#ifdef UART_NODE_ID
+#define SIM_BUS_NODES           8
+#define SIM_BUS_GROUP           16
+extern const char *g_ppcBusNodes[SIM_BUS_NODES];
+extern uint32_t g_ui32BusNodes;
+extern uint32_t g_ui32BusMiss;
+extern uint32_t g_ui32BusGroup;
+extern int g_iBusFd;
+extern void SimBusStart(void);
+extern void SimBusUpdate(void);
+extern void SimBusWait(uint64_t ui64Next);
+extern void SimBusTx(uint8_t ui8Data, uint64_t ui64Done);
+extern void SimBusDrive(bool bOn);
+extern int SimBusNode(const uint8_t *pui8Image, uint32_t ui32Size);
+extern int SimBusRun(int iArgc, char *ppcArgv[], const uint8_t *pui8Image,
+                     uint32_t ui32Size);
+#endif
+
+//*****************************************************************************
+//
+// The CAN controller and CAN bus models, in sim_can.c, on which the host
+// model updates the boot loader and up to seven other nodes at once when the
+// boot loader is built with CAN.  The host resends the frames of a block
+// that any node is missing up to eight times.
+//
+//*****************************************************************************
+#ifdef CAN_ENABLE_UPDATE
+#define SIM_CAN_NODES           8
+#define SIM_CAN_ROUNDS          8
+#define SIM_CAN_CRQ_MARK        0x10000000
+extern uint32_t g_ui32CANNodes;
+extern uint32_t g_ui32CANLoseEvery;
+extern void SimCANStart(uint64_t ui64Start);
+extern void SimCANUpdate(void);
+extern uint64_t SimCANNextEvent(void);
+extern bool SimCANPolled(uint32_t ui32Address);
+extern bool SimCANRead(uint32_t ui32Address, uint32_t *pui32Value);
+extern bool SimCANWrite(uint32_t ui32Address, uint32_t ui32Value);
+extern int SimCANRun(const uint8_t *pui8Image, uint32_t ui32Size);
+#endif
+
+//*****************************************************************************
+//
+// The Ethernet MAC and BOOTP and TFTP server models, in sim_emac.c, over
+// which the boot loader fetches the image when it is built with Ethernet.
+// The server damages every -x'th frame that it sends.
+//
+//*****************************************************************************
+#ifdef ENET_ENABLE_UPDATE
+#define SIM_EMAC_POLL_MARK      0x10000000
+#define SIM_EMAC_TIME_LIMIT     60
+extern uint32_t g_ui32EMACDamageEvery;
+extern void SimEMACStart(uint64_t ui64Start);
+extern void SimEMACUpdate(void);
+extern uint64_t SimEMACNextEvent(void);
+extern bool SimEMACPolled(uint32_t ui32Address);
+extern bool SimEMACRead(uint32_t ui32Address, uint32_t *pui32Value);
+extern bool SimEMACWrite(uint32_t ui32Address, uint32_t ui32Value);
+extern int SimEMACRun(const uint8_t *pui8Image, uint32_t ui32Size);
+#endif
+
+//*****************************************************************************
+//
+// The USB controller and USB host models, in sim_usb.c, over which the host
+// downloads the image with DFU when the boot loader is built with USB, or
+// to the bulk endpoint when it is built with USB_ENABLE_BULK_DMA as well.
+//
+//*****************************************************************************
+#ifdef USB_ENABLE_UPDATE
+extern void SimUSBStart(uint64_t ui64Start);
+extern void SimUSBUpdate(void);
+extern uint64_t SimUSBNextEvent(void);
+extern bool SimUSBRead(uint32_t ui32Address, uint32_t *pui32Value);
+extern bool SimUSBWrite(uint32_t ui32Address, uint32_t ui32Value);
+extern bool SimUSBWriteOnly(uint32_t ui32Address);
+extern int SimUSBRun(const uint8_t *pui8Image, uint32_t ui32Size);
+#endif
+
+//*****************************************************************************
+//
+// The run of the boot loader, in blsim.c.
+//
+//*****************************************************************************
+extern uint32_t g_ui32BaudOverride;
+extern uint32_t g_ui32HandoffBaud;
+extern void SimTimingSet(void);
+extern void SimRun(bool bConfigure);
+
+//*****************************************************************************
+//
+// The checks of each feature, in sim_<feature>.c.
+//
+//*****************************************************************************
+#ifdef IMAGE_DIGEST
+extern void SimDigestReply(void);
+extern int SimSHA256Check(void);
+extern int SimDigestCheck(const uint8_t *pui8Image, uint32_t ui32Size);
+#endif
+#ifdef DECRYPT_AES_MODE
+extern const uint8_t g_pui8SimIV[AES_BLOCK_SIZE];
+extern uint8_t *SimImageEncrypt(const uint8_t *pui8Image, uint32_t ui32Size);
+extern int SimAESCheck(void);
+#endif
+#ifdef CHECK_SIGNATURE
+extern int SimECDSACheck(void);
+extern int SimSignatureCheck(uint32_t ui32Size);
+#endif
+#ifdef BL_UPDATE_STAGED
+extern bool g_bStaged;
+extern uint8_t g_ui8InstallStatus;
+extern bool SimInstallReply(void);
+extern void SimFlashCopyTime(uint32_t ui32Idx);
+extern void SimOldBootLoader(void);
+extern int SimStagedCheck(const uint8_t *pui8Image, uint32_t ui32Size);
+#endif
+#ifdef BL_HANDOFF_ADDRESS
+extern int SimHandoffCheck(uint32_t ui32Baud);
+#endif
+#ifdef BOOT_CYCLES_ADDRESS
+extern int SimBootCheck(void);
+#endif
+#ifdef LOOPBACK_ENABLE_UPDATE
+extern int SimLoopbackCheck(void);
+#endif
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+extern uint32_t g_ui32SimWearSkips;
+extern void SimWearReply(void);
+extern void SimWearSet(uint32_t ui32Address, uint32_t ui32Size,
+                       uint32_t ui32Erases);
+extern int SimWearCheck(void);
+#endif
+#ifdef META_EEPROM_ADDRESS
+extern int SimMetaCheck(void);
+extern int SimMetaCountCheck(void);
+#endif
+#ifdef SIM_MANIFEST
+#define SIM_PARAMS_ADDRESS      (SIM_FLASH_SIZE - FLASH_RSVD_SPACE)
+extern uint8_t *g_pui8Params;
+extern uint32_t g_ui32ParamsSize;
+extern void SimManifestRegion(uint8_t *pui8Region, uint32_t ui32Address,
+                              const uint8_t *pui8Data, uint32_t ui32Size);
+extern int SimManifestCheck(void);
+#endif
+#ifdef BL_WATCHDOG_TIMEOUT
+extern uint32_t g_ui32LinkLost;
+extern uint64_t g_ui64LinkLost;
+extern uint32_t g_ui32SimResume;
+extern void SimResumeReply(void);
+extern int SimWatchdogRestart(uint8_t *pui8Image, uint32_t ui32Size);
+extern int SimWatchdogReport(void);
+#endif
+#ifdef ENABLE_FLASH_DUMP
+#define SIM_DUMP_ADDRESS        0x00000000
+#define SIM_DUMP_BLOCK          0x800
+extern uint32_t g_ui32SimDumpFrame;
+extern uint32_t g_ui32SimDumpSize;
+extern uint32_t g_ui32SimDumpReply;
+extern uint8_t *g_pui8SimDump;
+extern uint64_t g_ui64SimDumpStart;
+extern void SimDumpPayload(uint8_t *pui8Payload, uint32_t ui32Address,
+                           uint32_t ui32Size);
+extern void SimDumpReply(uint64_t ui64Time);
+extern void SimDumpProtect(void);
+extern int SimDumpCheck(const uint8_t *pui8Image, uint32_t ui32Size);
+#endif
+
+#endif // __BLSIM_H__
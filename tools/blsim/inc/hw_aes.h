@@ -0,0 +1,86 @@
+//*****************************************************************************
+//
+// hw_aes.h - Macros used when accessing the AES hardware.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_AES_H__
+#define __HW_AES_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_aes.h when the boot loader is
+// built for the host simulator.  It holds only the AES module definitions that
+// the boot loader, the driverlib files that it uses and the simulator's models
+// refer to.
+//
+//*****************************************************************************
+
+#define AES_O_KEY2_6            0x00000000
+#define AES_O_KEY2_7            0x00000004
+#define AES_O_KEY2_4            0x00000008
+#define AES_O_KEY2_5            0x0000000C
+#define AES_O_KEY2_2            0x00000010
+#define AES_O_KEY2_3            0x00000014
+#define AES_O_KEY2_0            0x00000018
+#define AES_O_KEY2_1            0x0000001C
+#define AES_O_KEY1_6            0x00000020
+#define AES_O_KEY1_7            0x00000024
+#define AES_O_KEY1_4            0x00000028
+#define AES_O_KEY1_5            0x0000002C
+#define AES_O_KEY1_2            0x00000030
+#define AES_O_KEY1_3            0x00000034
+#define AES_O_KEY1_0            0x00000038
+#define AES_O_KEY1_1            0x0000003C
+#define AES_O_IV_IN_0           0x00000040
+#define AES_O_IV_IN_1           0x00000044
+#define AES_O_IV_IN_2           0x00000048
+#define AES_O_IV_IN_3           0x0000004C
+#define AES_O_CTRL              0x00000050
+#define AES_O_C_LENGTH_0        0x00000054
+#define AES_O_C_LENGTH_1        0x00000058
+#define AES_O_AUTH_LENGTH       0x0000005C
+#define AES_O_DATA_IN_0         0x00000060
+#define AES_O_DATA_IN_1         0x00000064
+#define AES_O_DATA_IN_2         0x00000068
+#define AES_O_DATA_IN_3         0x0000006C
+#define AES_O_TAG_OUT_0         0x00000070
+#define AES_O_TAG_OUT_1         0x00000074
+#define AES_O_TAG_OUT_2         0x00000078
+#define AES_O_TAG_OUT_3         0x0000007C
+#define AES_O_REVISION          0x00000080
+#define AES_O_SYSCONFIG         0x00000084
+#define AES_O_SYSSTATUS         0x00000088
+#define AES_O_IRQSTATUS         0x0000008C
+#define AES_O_IRQENABLE         0x00000090
+#define AES_O_DIRTYBITS         0x00000094
+#define AES_O_DMAIM             0xFFFFA020
+#define AES_O_DMARIS            0xFFFFA024
+#define AES_O_DMAMIS            0xFFFFA028
+#define AES_O_DMAIC             0xFFFFA02C
+#define AES_CTRL_OUTPUT_READY   0x00000001
+#define AES_CTRL_INPUT_READY    0x00000002
+#define AES_CTRL_SAVE_CONTEXT   0x20000000
+#define AES_CTRL_SVCTXTRDY      0x80000000
+#define AES_SYSCONFIG_SOFTRESET 0x00000002
+#define AES_SYSSTATUS_RESETDONE 0x00000001
+
+#endif // __HW_AES_H__
@@ -0,0 +1,178 @@
+//*****************************************************************************
+//
+// hw_can.h - Defines and macros used when accessing the CAN controllers.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_CAN_H__
+#define __HW_CAN_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_can.h when the boot loader is
+// built for the host simulator.  It holds only the CAN controller definitions
+// that the boot loader, the driverlib files that it uses and the simulator's
+// models refer to.
+//
+//*****************************************************************************
+
+#define CAN_O_CTL               0x00000000
+#define CAN_O_STS               0x00000004
+#define CAN_O_ERR               0x00000008
+#define CAN_O_BIT               0x0000000C
+#define CAN_O_INT               0x00000010
+#define CAN_O_TST               0x00000014
+#define CAN_O_BRPE              0x00000018
+#define CAN_O_IF1CRQ            0x00000020
+#define CAN_O_IF1CMSK           0x00000024
+#define CAN_O_IF1MSK1           0x00000028
+#define CAN_O_IF1MSK2           0x0000002C
+#define CAN_O_IF1ARB1           0x00000030
+#define CAN_O_IF1ARB2           0x00000034
+#define CAN_O_IF1MCTL           0x00000038
+#define CAN_O_IF1DA1            0x0000003C
+#define CAN_O_IF1DA2            0x00000040
+#define CAN_O_IF1DB1            0x00000044
+#define CAN_O_IF1DB2            0x00000048
+#define CAN_O_IF2CRQ            0x00000080
+#define CAN_O_IF2CMSK           0x00000084
+#define CAN_O_IF2MSK1           0x00000088
+#define CAN_O_IF2MSK2           0x0000008C
+#define CAN_O_IF2ARB1           0x00000090
+#define CAN_O_IF2ARB2           0x00000094
+#define CAN_O_IF2MCTL           0x00000098
+#define CAN_O_IF2DA1            0x0000009C
+#define CAN_O_IF2DA2            0x000000A0
+#define CAN_O_IF2DB1            0x000000A4
+#define CAN_O_IF2DB2            0x000000A8
+#define CAN_O_TXRQ1             0x00000100
+#define CAN_O_TXRQ2             0x00000104
+#define CAN_O_NWDA1             0x00000120
+#define CAN_O_NWDA2             0x00000124
+#define CAN_O_MSG1INT           0x00000140
+#define CAN_O_MSG2INT           0x00000144
+#define CAN_O_MSG1VAL           0x00000160
+#define CAN_O_MSG2VAL           0x00000164
+#define CAN_CTL_TEST            0x00000080
+#define CAN_CTL_CCE             0x00000040
+#define CAN_CTL_DAR             0x00000020
+#define CAN_CTL_EIE             0x00000008
+#define CAN_CTL_SIE             0x00000004
+#define CAN_CTL_IE              0x00000002
+#define CAN_CTL_INIT            0x00000001
+#define CAN_STS_BOFF            0x00000080
+#define CAN_STS_EWARN           0x00000040
+#define CAN_STS_EPASS           0x00000020
+#define CAN_STS_RXOK            0x00000010
+#define CAN_STS_TXOK            0x00000008
+#define CAN_STS_LEC_M           0x00000007
+#define CAN_STS_LEC_NONE        0x00000000
+#define CAN_STS_LEC_STUFF       0x00000001
+#define CAN_STS_LEC_FORM        0x00000002
+#define CAN_STS_LEC_ACK         0x00000003
+#define CAN_STS_LEC_BIT1        0x00000004
+#define CAN_STS_LEC_BIT0        0x00000005
+#define CAN_STS_LEC_CRC         0x00000006
+#define CAN_STS_LEC_NOEVENT     0x00000007
+#define CAN_ERR_RP              0x00008000
+#define CAN_ERR_REC_M           0x00007F00
+#define CAN_ERR_TEC_M           0x000000FF
+#define CAN_ERR_REC_S           8
+#define CAN_ERR_TEC_S           0
+#define CAN_BIT_TSEG2_M         0x00007000
+#define CAN_BIT_TSEG1_M         0x00000F00
+#define CAN_BIT_SJW_M           0x000000C0
+#define CAN_BIT_BRP_M           0x0000003F
+#define CAN_BIT_TSEG2_S         12
+#define CAN_BIT_TSEG1_S         8
+#define CAN_BIT_SJW_S           6
+#define CAN_BIT_BRP_S           0
+#define CAN_INT_INTID_M         0x0000FFFF
+#define CAN_INT_INTID_NONE      0x00000000
+#define CAN_INT_INTID_STATUS    0x00008000
+#define CAN_TST_RX              0x00000080
+#define CAN_TST_TX_M            0x00000060
+#define CAN_TST_LBACK           0x00000010
+#define CAN_TST_SILENT          0x00000008
+#define CAN_TST_BASIC           0x00000004
+#define CAN_BRPE_BRPE_M         0x0000000F
+#define CAN_BRPE_BRPE_S         0
+#define CAN_IF1CRQ_BUSY         0x00008000
+#define CAN_IF1CRQ_MNUM_M       0x0000003F
+#define CAN_IF1CMSK_WRNRD       0x00000080
+#define CAN_IF1CMSK_MASK        0x00000040
+#define CAN_IF1CMSK_ARB         0x00000020
+#define CAN_IF1CMSK_CONTROL     0x00000010
+#define CAN_IF1CMSK_CLRINTPND   0x00000008
+#define CAN_IF1CMSK_NEWDAT      0x00000004
+#define CAN_IF1CMSK_TXRQST      0x00000004
+#define CAN_IF1CMSK_DATAA       0x00000002
+#define CAN_IF1CMSK_DATAB       0x00000001
+#define CAN_IF1MSK1_IDMSK_M     0x0000FFFF
+#define CAN_IF1MSK2_MXTD        0x00008000
+#define CAN_IF1MSK2_MDIR        0x00004000
+#define CAN_IF1MSK2_IDMSK_M     0x00001FFF
+#define CAN_IF1ARB1_ID_M        0x0000FFFF
+#define CAN_IF1ARB2_MSGVAL      0x00008000
+#define CAN_IF1ARB2_XTD         0x00004000
+#define CAN_IF1ARB2_DIR         0x00002000
+#define CAN_IF1ARB2_ID_M        0x00001FFF
+#define CAN_IF1MCTL_NEWDAT      0x00008000
+#define CAN_IF1MCTL_MSGLST      0x00004000
+#define CAN_IF1MCTL_INTPND      0x00002000
+#define CAN_IF1MCTL_UMASK       0x00001000
+#define CAN_IF1MCTL_TXIE        0x00000800
+#define CAN_IF1MCTL_RXIE        0x00000400
+#define CAN_IF1MCTL_RMTEN       0x00000200
+#define CAN_IF1MCTL_TXRQST      0x00000100
+#define CAN_IF1MCTL_EOB         0x00000080
+#define CAN_IF1MCTL_DLC_M       0x0000000F
+#define CAN_IF2CRQ_BUSY         0x00008000
+#define CAN_IF2CRQ_MNUM_M       0x0000003F
+#define CAN_IF2CMSK_WRNRD       0x00000080
+#define CAN_IF2CMSK_MASK        0x00000040
+#define CAN_IF2CMSK_ARB         0x00000020
+#define CAN_IF2CMSK_CONTROL     0x00000010
+#define CAN_IF2CMSK_CLRINTPND   0x00000008
+#define CAN_IF2CMSK_NEWDAT      0x00000004
+#define CAN_IF2CMSK_TXRQST      0x00000004
+#define CAN_IF2CMSK_DATAA       0x00000002
+#define CAN_IF2CMSK_DATAB       0x00000001
+#define CAN_IF2ARB2_MSGVAL      0x00008000
+#define CAN_IF2ARB2_XTD         0x00004000
+#define CAN_IF2ARB2_DIR         0x00002000
+#define CAN_IF2ARB2_ID_M        0x00001FFF
+#define CAN_IF2MCTL_NEWDAT      0x00008000
+#define CAN_IF2MCTL_MSGLST      0x00004000
+#define CAN_IF2MCTL_UMASK       0x00001000
+#define CAN_IF2MCTL_TXRQST      0x00000100
+#define CAN_IF2MCTL_EOB         0x00000080
+#define CAN_IF2MCTL_DLC_M       0x0000000F
+#define CAN_MSG1INT_INTPND_M    0x0000FFFF
+#define CAN_MSG2INT_INTPND_M    0x0000FFFF
+#define CAN_TXRQ1_TXRQST_M      0x0000FFFF
+#define CAN_TXRQ2_TXRQST_M      0x0000FFFF
+#define CAN_NWDA1_NEWDAT_M      0x0000FFFF
+#define CAN_NWDA2_NEWDAT_M      0x0000FFFF
+#define CAN_MSG1VAL_MSGVAL_M    0x0000FFFF
+#define CAN_MSG2VAL_MSGVAL_M    0x0000FFFF
+
+#endif // __HW_CAN_H__
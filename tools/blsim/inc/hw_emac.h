@@ -0,0 +1,224 @@
+//*****************************************************************************
+//
+// hw_emac.h - Macros used when accessing the EMAC hardware.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_EMAC_H__
+#define __HW_EMAC_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_emac.h when the boot loader is
+// built for the host simulator.  It holds only the Ethernet MAC and PHY
+// definitions that the boot loader, the driverlib files that it uses and the
+// simulator's models refer to.
+//
+//*****************************************************************************
+
+#define EMAC_O_CFG              0x00000000
+#define EMAC_O_FRAMEFLTR        0x00000004
+#define EMAC_O_HASHTBLH         0x00000008
+#define EMAC_O_HASHTBLL         0x0000000C
+#define EMAC_O_MIIADDR          0x00000010
+#define EMAC_O_MIIDATA          0x00000014
+#define EMAC_O_FLOWCTL          0x00000018
+#define EMAC_O_VLANTG           0x0000001C
+#define EMAC_O_STATUS           0x00000024
+#define EMAC_O_RWUFF            0x00000028
+#define EMAC_O_PMTCTLSTAT       0x0000002C
+#define EMAC_O_LPICTLSTAT       0x00000030
+#define EMAC_O_LPITIMERCTL      0x00000034
+#define EMAC_O_RIS              0x00000038
+#define EMAC_O_IM               0x0000003C
+#define EMAC_O_ADDR0H           0x00000040
+#define EMAC_O_ADDR0L           0x00000044
+#define EMAC_O_ADDR1H           0x00000048
+#define EMAC_O_ADDR1L           0x0000004C
+#define EMAC_O_WDOGTO           0x000000DC
+#define EMAC_O_MMCCTRL          0x00000100
+#define EMAC_O_MMCRXRIS         0x00000104
+#define EMAC_O_MMCTXRIS         0x00000108
+#define EMAC_O_MMCRXIM          0x0000010C
+#define EMAC_O_MMCTXIM          0x00000110
+#define EMAC_O_VLNINCREP        0x00000584
+#define EMAC_O_VLANHASH         0x00000588
+#define EMAC_O_TIMSTCTRL        0x00000700
+#define EMAC_O_SUBSECINC        0x00000704
+#define EMAC_O_TIMSEC           0x00000708
+#define EMAC_O_TIMNANO          0x0000070C
+#define EMAC_O_TIMSECU          0x00000710
+#define EMAC_O_TIMNANOU         0x00000714
+#define EMAC_O_TIMADD           0x00000718
+#define EMAC_O_TARGSEC          0x0000071C
+#define EMAC_O_TARGNANO         0x00000720
+#define EMAC_O_HWORDSEC         0x00000724
+#define EMAC_O_TIMSTAT          0x00000728
+#define EMAC_O_PPSCTRL          0x0000072C
+#define EMAC_O_PPS0INTVL        0x00000760
+#define EMAC_O_PPS0WIDTH        0x00000764
+#define EMAC_O_DMABUSMOD        0x00000C00
+#define EMAC_O_TXPOLLD          0x00000C04
+#define EMAC_O_RXPOLLD          0x00000C08
+#define EMAC_O_RXDLADDR         0x00000C0C
+#define EMAC_O_TXDLADDR         0x00000C10
+#define EMAC_O_DMARIS           0x00000C14
+#define EMAC_O_DMAOPMODE        0x00000C18
+#define EMAC_O_DMAIM            0x00000C1C
+#define EMAC_O_MFBOC            0x00000C20
+#define EMAC_O_RXINTWDT         0x00000C24
+#define EMAC_O_HOSTXDESC        0x00000C48
+#define EMAC_O_HOSRXDESC        0x00000C4C
+#define EMAC_O_HOSTXBA          0x00000C50
+#define EMAC_O_HOSRXBA          0x00000C54
+#define EMAC_O_PP               0x00000FC0
+#define EMAC_O_PC               0x00000FC4
+#define EMAC_O_CC               0x00000FC8
+#define EMAC_O_EPHYRIS          0x00000FD0
+#define EMAC_O_EPHYIM           0x00000FD4
+#define EMAC_O_EPHYMISC         0x00000FD8
+#define EMAC_CFG_TWOKPEN        0x08000000
+#define EMAC_CFG_CST            0x02000000
+#define EMAC_CFG_WDDIS          0x00800000
+#define EMAC_CFG_JD             0x00400000
+#define EMAC_CFG_JFEN           0x00100000
+#define EMAC_CFG_DISCRS         0x00010000
+#define EMAC_CFG_PS             0x00008000
+#define EMAC_CFG_FES            0x00004000
+#define EMAC_CFG_DRO            0x00002000
+#define EMAC_CFG_LOOPBM         0x00001000
+#define EMAC_CFG_DUPM           0x00000800
+#define EMAC_CFG_IPC            0x00000400
+#define EMAC_CFG_DR             0x00000200
+#define EMAC_CFG_ACS            0x00000080
+#define EMAC_CFG_DC             0x00000010
+#define EMAC_CFG_TE             0x00000008
+#define EMAC_CFG_RE             0x00000004
+#define EMAC_MIIADDR_PLA_M      0x0000F800
+#define EMAC_MIIADDR_MII_M      0x000007C0
+#define EMAC_MIIADDR_CR_M       0x0000003C
+#define EMAC_MIIADDR_CR_60_100  0x00000000
+#define EMAC_MIIADDR_CR_100_150 0x00000004
+#define EMAC_MIIADDR_CR_20_35   0x00000008
+#define EMAC_MIIADDR_CR_35_60   0x0000000C
+#define EMAC_MIIADDR_MIIW       0x00000002
+#define EMAC_MIIADDR_MIIB       0x00000001
+#define EMAC_MIIADDR_PLA_S      11
+#define EMAC_MIIADDR_MII_S      6
+#define EMAC_MIIDATA_DATA_M     0x0000FFFF
+#define EMAC_VLANTG_VL_M        0x0000FFFF
+#define EMAC_VLANTG_VL_S        0
+#define EMAC_STATUS_TXFE        0x02000000
+#define EMAC_PMTCTLSTAT_WUPFRRST 0x80000000
+#define EMAC_PMTCTLSTAT_GLBLUCAST 0x00000200
+#define EMAC_PMTCTLSTAT_WUPRX   0x00000040
+#define EMAC_PMTCTLSTAT_MGKPRX  0x00000020
+#define EMAC_PMTCTLSTAT_WUPFREN 0x00000004
+#define EMAC_PMTCTLSTAT_MGKPKTEN 0x00000002
+#define EMAC_PMTCTLSTAT_PWRDWN  0x00000001
+#define EMAC_LPICTLSTAT_LPITXA  0x00080000
+#define EMAC_LPICTLSTAT_PLS     0x00020000
+#define EMAC_LPICTLSTAT_LPIEN   0x00010000
+#define EMAC_LPITIMERCTL_LST_M  0x03FF0000
+#define EMAC_LPITIMERCTL_TWT_M  0x0000FFFF
+#define EMAC_LPITIMERCTL_LST_S  16
+#define EMAC_WDOGTO_PWE         0x00010000
+#define EMAC_WDOGTO_WTO_M       0x00003FFF
+#define EMAC_VLNINCREP_VLT_M    0x0000FFFF
+#define EMAC_VLNINCREP_VLT_S    0
+#define EMAC_TIMSTCTRL_ADDREGUP 0x00000020
+#define EMAC_TIMSTCTRL_INTTRIG  0x00000010
+#define EMAC_TIMSTCTRL_TSUPDT   0x00000008
+#define EMAC_TIMSTCTRL_TSINIT   0x00000004
+#define EMAC_TIMSTCTRL_TSEN     0x00000001
+#define EMAC_SUBSECINC_SSINC_M  0x000000FF
+#define EMAC_SUBSECINC_SSINC_S  0
+#define EMAC_TIMNANOU_ADDSUB    0x80000000
+#define EMAC_TARGNANO_TRGTBUSY  0x80000000
+#define EMAC_PPSCTRL_PPSEN0     0x00000010
+#define EMAC_PPSCTRL_PPSCTRL_M  0x0000000F
+#define EMAC_DMABUSMOD_RIB      0x80000000
+#define EMAC_DMABUSMOD_TXPR     0x08000000
+#define EMAC_DMABUSMOD_MB       0x04000000
+#define EMAC_DMABUSMOD_AAL      0x02000000
+#define EMAC_DMABUSMOD_8XPBL    0x01000000
+#define EMAC_DMABUSMOD_USP      0x00800000
+#define EMAC_DMABUSMOD_FB       0x00010000
+#define EMAC_DMABUSMOD_ATDS     0x00000080
+#define EMAC_DMABUSMOD_DA       0x00000002
+#define EMAC_DMABUSMOD_SWR      0x00000001
+#define EMAC_DMABUSMOD_RPBL_S   17
+#define EMAC_DMABUSMOD_PBL_S    8
+#define EMAC_DMABUSMOD_DSL_S    2
+#define EMAC_DMARIS_LPI         0x40000000
+#define EMAC_DMARIS_TT          0x20000000
+#define EMAC_DMARIS_PMT         0x10000000
+#define EMAC_DMARIS_MMC         0x08000000
+#define EMAC_DMARIS_AE_M        0x03800000
+#define EMAC_DMARIS_TS_M        0x00700000
+#define EMAC_DMARIS_TS_SUSPEND  0x00600000
+#define EMAC_DMARIS_RS_M        0x000E0000
+#define EMAC_DMARIS_RS_SUSPEND  0x00080000
+#define EMAC_DMARIS_RS_RUNRXD   0x00060000
+#define EMAC_DMARIS_NIS         0x00010000
+#define EMAC_DMARIS_AIS         0x00008000
+#define EMAC_DMARIS_ERI         0x00004000
+#define EMAC_DMARIS_FBI         0x00002000
+#define EMAC_DMARIS_ETI         0x00000400
+#define EMAC_DMARIS_RWT         0x00000200
+#define EMAC_DMARIS_RPS         0x00000100
+#define EMAC_DMARIS_RU          0x00000080
+#define EMAC_DMARIS_RI          0x00000040
+#define EMAC_DMARIS_UNF         0x00000020
+#define EMAC_DMARIS_OVF         0x00000010
+#define EMAC_DMARIS_TJT         0x00000008
+#define EMAC_DMARIS_TU          0x00000004
+#define EMAC_DMARIS_TPS         0x00000002
+#define EMAC_DMARIS_TI          0x00000001
+#define EMAC_DMAOPMODE_DT       0x04000000
+#define EMAC_DMAOPMODE_RSF      0x02000000
+#define EMAC_DMAOPMODE_DFF      0x01000000
+#define EMAC_DMAOPMODE_TSF      0x00200000
+#define EMAC_DMAOPMODE_FTF      0x00100000
+#define EMAC_DMAOPMODE_ST       0x00002000
+#define EMAC_DMAOPMODE_FEF      0x00000080
+#define EMAC_DMAOPMODE_FUF      0x00000040
+#define EMAC_DMAOPMODE_OSF      0x00000004
+#define EMAC_DMAOPMODE_SR       0x00000002
+#define EMAC_DMAIM_NIE          0x00010000
+#define EMAC_DMAIM_AIE          0x00008000
+#define EMAC_DMAIM_RIE          0x00000040
+#define EMAC_DMAIM_TIE          0x00000001
+#define EMAC_CC_PTPCEN          0x00040000
+#define EMAC_CC_POL             0x00020000
+#define EMAC_CC_CLKEN           0x00010000
+#define EMAC_EPHYRIS_INT        0x00000001
+#define EMAC_EPHYIM_INT         0x00000001
+#define EMAC_EPHYMISC_INT       0x00000001
+#define EPHY_BMCR               0x00000000
+#define EPHY_BMSR               0x00000001
+#define EPHY_REGCTL             0x0000000D
+#define EPHY_ADDAR              0x0000000E
+#define EPHY_BMCR_MIIRESET      0x00008000
+#define EPHY_BMCR_ANEN          0x00001000
+#define EPHY_BMCR_PWRDWN        0x00000800
+
+#endif // __HW_EMAC_H__
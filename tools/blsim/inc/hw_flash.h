@@ -0,0 +1,66 @@
+//*****************************************************************************
+//
+// hw_flash.h - Macros and defines used when accessing the flash controller.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_FLASH_H__
+#define __HW_FLASH_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_flash.h when the boot loader is
+// built for the host simulator.  It holds only the flash controller
+// definitions that the boot loader, the driverlib files that it uses and the
+// simulator's models refer to.
+//
+//*****************************************************************************
+
+#define FLASH_FMA               0x400FD000
+#define FLASH_FMD               0x400FD004
+#define FLASH_FMC               0x400FD008
+#define FLASH_FCRIS             0x400FD00C
+#define FLASH_FCIM              0x400FD010
+#define FLASH_FCMISC            0x400FD014
+#define FLASH_FMC2              0x400FD020
+#define FLASH_FWBVAL            0x400FD030
+#define FLASH_FWBN              0x400FD100
+#define FLASH_FSIZE             0x400FDFC0
+#define FLASH_PP                0x400FDFC0
+#define FLASH_FMPRE0            0x400FE200
+#define FLASH_FMPPE0            0x400FE400
+#define FLASH_FMC_WRKEY         0xA4420000
+#define FLASH_FMC_COMT          0x8
+#define FLASH_FMC_MERASE        0x4
+#define FLASH_FMC_ERASE         0x2
+#define FLASH_FMC_WRITE         0x1
+#define FLASH_FMC2_WRBUF        0x1
+#define FLASH_FCRIS_ARIS        0x1
+#define FLASH_FCRIS_PROGRIS     0x2
+#define FLASH_FCRIS_ERRIS       0x800
+#define FLASH_FCMISC_AMISC      0x1
+#define FLASH_PP_SIZE_M         0xFFFF
+#define FLASH_FSIZE_SIZE_M      0xFFFF
+#define FLASH_ERASE_SIZE        0x4000
+#define FLASH_FMC2_WRKEY        0xA4420000
+#define FLASH_PROTECT_SIZE      0x00000800
+
+#endif // __HW_FLASH_H__
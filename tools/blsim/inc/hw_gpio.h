@@ -0,0 +1,51 @@
+//*****************************************************************************
+//
+// hw_gpio.h - Defines and Macros for GPIO hardware.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_GPIO_H__
+#define __HW_GPIO_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_gpio.h when the boot loader is
+// built for the host simulator.  It holds only the GPIO ports definitions that
+// the boot loader, the driverlib files that it uses and the simulator's models
+// refer to.
+//
+//*****************************************************************************
+
+#define GPIO_O_DATA             0x0
+#define GPIO_O_DIR              0x400
+#define GPIO_O_AFSEL            0x420
+#define GPIO_O_DR2R             0x500
+#define GPIO_O_ODR              0x50C
+#define GPIO_O_PUR              0x510
+#define GPIO_O_PDR              0x514
+#define GPIO_O_DEN              0x51C
+#define GPIO_O_LOCK             0x520
+#define GPIO_O_CR               0x524
+#define GPIO_O_AMSEL            0x528
+#define GPIO_O_PCTL             0x52C
+#define GPIO_LOCK_KEY           0x4C4F434B
+
+#endif // __HW_GPIO_H__
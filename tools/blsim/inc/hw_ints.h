@@ -0,0 +1,58 @@
+//*****************************************************************************
+//
+// hw_ints.h - Macros that define the interrupt assignment.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_INTS_H__
+#define __HW_INTS_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_ints.h when the boot loader is
+// built for the host simulator.  It holds only the interrupt assignments
+// definitions that the boot loader, the driverlib files that it uses and the
+// simulator's models refer to.
+//
+//*****************************************************************************
+
+#define INT_USB0                60
+#define INT_SHA0_TM4C129        149
+#define INT_AES0_TM4C129        137
+#define INT_WATCHDOG_TM4C123    34
+#define INT_WATCHDOG_TM4C129    34
+#define INT_SSI0_TM4C123        23
+#define INT_SSI1_TM4C123        50
+#define INT_SSI2_TM4C123        73
+#define INT_SSI3_TM4C123        74
+#define INT_SSI0_TM4C129        23
+#define INT_SSI1_TM4C129        50
+#define INT_SSI2_TM4C129        73
+#define INT_SSI3_TM4C129        74
+#define INT_CAN0_TM4C123        55
+#define INT_CAN1_TM4C123        56
+#define INT_CAN0_TM4C129        54
+#define INT_CAN1_TM4C129        55
+#define INT_EMAC0_TM4C129       56
+#define INT_USB0_TM4C123        60
+#define INT_USB0_TM4C129        60
+
+#endif // __HW_INTS_H__
@@ -0,0 +1,68 @@
+//*****************************************************************************
+//
+// hw_memmap.h - Macros defining the memory map of the device.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_MEMMAP_H__
+#define __HW_MEMMAP_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_memmap.h when the boot loader is
+// built for the host simulator.  It holds only the memory map definitions that
+// the boot loader, the driverlib files that it uses and the simulator's models
+// refer to.
+//
+//*****************************************************************************
+
+#define FLASH_BASE              0x00000000
+#define SRAM_BASE               0x20000000
+#define WATCHDOG0_BASE          0x40000000
+#define WATCHDOG1_BASE          0x40001000
+#define GPIO_PORTA_BASE         0x40004000
+#define GPIO_PORTB_BASE         0x40005000
+#define GPIO_PORTC_BASE         0x40006000
+#define GPIO_PORTD_BASE         0x40007000
+#define SSI0_BASE               0x40008000
+#define SSI1_BASE               0x40009000
+#define UART0_BASE              0x4000C000
+#define UART1_BASE              0x4000D000
+#define I2C0_BASE               0x40020000
+#define GPIO_PORTE_BASE         0x40024000
+#define GPIO_PORTF_BASE         0x40025000
+#define TIMER0_BASE             0x40030000
+#define TIMER1_BASE             0x40031000
+#define CAN0_BASE               0x40040000
+#define CAN1_BASE               0x40041000
+#define USB0_BASE               0x40050000
+#define GPIO_PORTL_BASE         0x40062000
+#define EEPROM_BASE             0x400AF000
+#define EMAC0_BASE              0x400EC000
+#define UDMA_BASE               0x400FF000
+#define AES_BASE                0x44036000
+#define SHAMD5_BASE             0x44034000
+#define FLASH_CTRL_BASE         0x400FD000
+#define SYSCTL_BASE             0x400FE000
+#define SSI2_BASE               0x4000A000
+#define SSI3_BASE               0x4000B000
+
+#endif // __HW_MEMMAP_H__
@@ -0,0 +1,54 @@
+//*****************************************************************************
+//
+// hw_nvic.h - Macros used when accessing the NVIC hardware.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_NVIC_H__
+#define __HW_NVIC_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_nvic.h when the boot loader is
+// built for the host simulator.  It holds only the NVIC and SysTick
+// definitions that the boot loader, the driverlib files that it uses and the
+// simulator's models refer to.
+//
+//*****************************************************************************
+
+#define NVIC_VTABLE             0xE000ED08
+#define NVIC_APINT              0xE000ED0C
+#define NVIC_APINT_VECTKEY      0x05FA0000
+#define NVIC_APINT_SYSRESETREQ  0x4
+#define NVIC_ST_CTRL            0xE000E010
+#define NVIC_ST_RELOAD          0xE000E014
+#define NVIC_ST_CURRENT         0xE000E018
+#define NVIC_ST_CTRL_CLK_SRC    0x4
+#define NVIC_ST_CTRL_INTEN      0x2
+#define NVIC_ST_CTRL_ENABLE     0x1
+#define NVIC_ST_CTRL_COUNT      0x10000
+#define NVIC_EN0                0xE000E100
+#define NVIC_EN1                0xE000E104
+#define NVIC_DBG_INT            0xE000EDFC
+#define NVIC_DBG_INT_TRCENA     0x01000000
+#define NVIC_ST_RELOAD_M        0x00FFFFFF
+
+#endif // __HW_NVIC_H__
@@ -0,0 +1,71 @@
+//*****************************************************************************
+//
+// hw_shamd5.h - Macros used when accessing the SHA/MD5 hardware.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_SHAMD5_H__
+#define __HW_SHAMD5_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_shamd5.h when the boot loader is
+// built for the host simulator.  It holds only the SHA/MD5 module definitions
+// that the boot loader, the driverlib files that it uses and the simulator's
+// models refer to.
+//
+//*****************************************************************************
+
+#define SHAMD5_O_ODIGEST_A      0x00000000
+#define SHAMD5_O_IDIGEST_A      0x00000020
+#define SHAMD5_O_DIGEST_COUNT   0x00000040
+#define SHAMD5_O_MODE           0x00000044
+#define SHAMD5_O_LENGTH         0x00000048
+#define SHAMD5_O_DATA_0_IN      0x00000080
+#define SHAMD5_O_SYSCONFIG      0x00000110
+#define SHAMD5_O_SYSSTATUS      0x00000114
+#define SHAMD5_O_IRQSTATUS      0x00000118
+#define SHAMD5_O_IRQENABLE      0x0000011C
+#define SHAMD5_O_DMAIM          0xFFFFC010
+#define SHAMD5_O_DMARIS         0xFFFFC014
+#define SHAMD5_O_DMAMIS         0xFFFFC018
+#define SHAMD5_O_DMAIC          0xFFFFC01C
+#define SHAMD5_MODE_ALGO_M      0x00000007
+#define SHAMD5_MODE_ALGO_MD5    0x00000000
+#define SHAMD5_MODE_ALGO_SHA1   0x00000002
+#define SHAMD5_MODE_ALGO_SHA224 0x00000004
+#define SHAMD5_MODE_ALGO_SHA256 0x00000006
+#define SHAMD5_MODE_ALGO_CONSTANT 0x00000008
+#define SHAMD5_MODE_CLOSE_HASH  0x00000010
+#define SHAMD5_MODE_HMAC_KEY_PROC 0x00000020
+#define SHAMD5_MODE_HMAC_OUTER_HASH 0x00000080
+#define SHAMD5_SYSCONFIG_SADVANCED 0x00000080
+#define SHAMD5_SYSCONFIG_SIDLE_M 0x00000030
+#define SHAMD5_SYSCONFIG_SIDLE_FORCE 0x00000000
+#define SHAMD5_SYSCONFIG_DMA_EN 0x00000008
+#define SHAMD5_SYSCONFIG_IT_EN  0x00000004
+#define SHAMD5_SYSCONFIG_SOFTRESET 0x00000002
+#define SHAMD5_SYSSTATUS_RESETDONE 0x00000001
+#define SHAMD5_IRQSTATUS_OUTPUT_READY 0x00000001
+#define SHAMD5_IRQSTATUS_INPUT_READY 0x00000002
+#define SHAMD5_IRQSTATUS_CONTEXT_READY 0x00000008
+
+#endif // __HW_SHAMD5_H__
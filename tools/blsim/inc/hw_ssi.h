@@ -0,0 +1,70 @@
+//*****************************************************************************
+//
+// hw_ssi.h - Macros used when accessing the SSI hardware.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_SSI_H__
+#define __HW_SSI_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_ssi.h when the boot loader is
+// built for the host simulator.  It holds only the SSI module definitions that
+// the boot loader, the driverlib files that it uses and the simulator's models
+// refer to.
+//
+//*****************************************************************************
+
+#define SSI_O_CR0               0x0
+#define SSI_O_CR1               0x4
+#define SSI_O_DR                0x8
+#define SSI_O_SR                0xC
+#define SSI_CR0_SPH             0x80
+#define SSI_CR0_SPO             0x40
+#define SSI_CR1_MS              0x4
+#define SSI_CR1_SSE             0x2
+#define SSI_SR_BSY              0x10
+#define SSI_SR_RNE              0x4
+#define SSI_SR_TNF              0x2
+#define SSI_SR_TFE              0x1
+#define SSI_O_CPSR              0x10
+#define SSI_O_IM                0x14
+#define SSI_O_RIS               0x18
+#define SSI_O_MIS               0x1C
+#define SSI_O_ICR               0x20
+#define SSI_O_DMACTL            0x24
+#define SSI_O_PP                0xFC0
+#define SSI_O_CC                0xFC8
+#define SSI_CR0_FRF_M           0x30
+#define SSI_CR0_DSS_M           0xF
+#define SSI_CR1_EOM             0x800
+#define SSI_CR1_FSSHLDFRM       0x400
+#define SSI_CR1_HSCLKEN         0x200
+#define SSI_CR1_DIR             0x100
+#define SSI_CR1_MODE_M          0xC0
+#define SSI_CR1_EOT             0x10
+#define SSI_CR1_LBM             0x1
+#define SSI_SR_RFF              0x8
+#define SSI_DMACTL_TXDMAE       0x2
+#define SSI_DMACTL_RXDMAE       0x1
+
+#endif // __HW_SSI_H__
@@ -0,0 +1,106 @@
+//*****************************************************************************
+//
+// hw_sysctl.h - Macros used when accessing the system control hardware.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_SYSCTL_H__
+#define __HW_SYSCTL_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_sysctl.h when the boot loader is
+// built for the host simulator.  It holds only the system control module
+// definitions that the boot loader, the driverlib files that it uses and the
+// simulator's models refer to.
+//
+//*****************************************************************************
+
+#define SYSCTL_RESC             0x400FE05C
+#define SYSCTL_RESC_MOSCFAIL    0x10000
+#define SYSCTL_RESC_WDT0        0x8
+#define SYSCTL_RESC_WDT1        0x20
+#define SYSCTL_RESC_SW          0x10
+#define SYSCTL_RESC_POR         0x2
+#define SYSCTL_RESC_EXT         0x1
+#define SYSCTL_RCC              0x400FE060
+#define SYSCTL_MOSCCTL          0x400FE07C
+#define SYSCTL_RSCLKCFG         0x400FE0B0
+#define SYSCTL_MEMTIM0          0x400FE0C0
+#define SYSCTL_SRWD             0x400FE500
+#define SYSCTL_SRTIMER          0x400FE504
+#define SYSCTL_SRUART           0x400FE518
+#define SYSCTL_SRSSI            0x400FE51C
+#define SYSCTL_SRI2C            0x400FE520
+#define SYSCTL_SRUSB            0x400FE528
+#define SYSCTL_SRCAN            0x400FE534
+#define SYSCTL_SRUDMA           0x400FE50C
+#define SYSCTL_SREEPROM         0x400FE558
+#define SYSCTL_SRCCM            0x400FE574
+#define SYSCTL_SREMAC           0x400FE59C
+#define SYSCTL_RCGCWD           0x400FE600
+#define SYSCTL_RCGCTIMER        0x400FE604
+#define SYSCTL_RCGCGPIO         0x400FE608
+#define SYSCTL_RCGCDMA          0x400FE60C
+#define SYSCTL_RCGCUART         0x400FE618
+#define SYSCTL_RCGCSSI          0x400FE61C
+#define SYSCTL_RCGCI2C          0x400FE620
+#define SYSCTL_RCGCUSB          0x400FE628
+#define SYSCTL_RCGCCAN          0x400FE634
+#define SYSCTL_RCGCEEPROM       0x400FE658
+#define SYSCTL_RCGCCCM          0x400FE674
+#define SYSCTL_RCGCEMAC         0x400FE69C
+#define SYSCTL_RCGCEPHY         0x400FE630
+#define SYSCTL_PRWD             0x400FEA00
+#define SYSCTL_PRTIMER          0x400FEA04
+#define SYSCTL_PREEPROM         0x400FEA58
+#define SYSCTL_PRCCM            0x400FEA74
+#define SYSCTL_PREMAC           0x400FEA9C
+#define SYSCTL_RCGCWD_R0        0x1
+#define SYSCTL_RCGCTIMER_R0     0x1
+#define SYSCTL_RCGCTIMER_R1     0x2
+#define SYSCTL_RCGCGPIO_R0      0x1
+#define SYSCTL_RCGCGPIO_R1      0x2
+#define SYSCTL_RCGCGPIO_R10     0x400
+#define SYSCTL_RCGCUART_R0      0x1
+#define SYSCTL_RCGCSSI_R0       0x1
+#define SYSCTL_RCGCI2C_R0       0x1
+#define SYSCTL_RCGCUSB_R0       0x1
+#define SYSCTL_RCGCCAN_R0       0x1
+#define SYSCTL_RCGCDMA_R0       0x1
+#define SYSCTL_RCGCEEPROM_R0    0x1
+#define SYSCTL_RCGCCCM_R0       0x1
+#define SYSCTL_RCGCEMAC_R0      0x1
+#define SYSCTL_RCGC2_GPIOB      0x2
+#define SYSCTL_MOSCCTL_PWRDN    0x8
+#define SYSCTL_MOSCCTL_NOXTAL   0x4
+#define SYSCTL_PRGPIO           0x400FEA08
+#define SYSCTL_RCGC2            0x400FE108
+#define SYSCTL_PRSSI            0x400FEA1C
+#define SYSCTL_PRDMA            0x400FEA0C
+#define SYSCTL_PRDMA_R0         0x1
+#define SYSCTL_PPCCM            0x400FE374
+#define SYSCTL_PPCCM_P0         0x1
+#define SYSCTL_PRCCM_R0         0x1
+#define SYSCTL_SRWD_R0          0x1
+#define SYSCTL_PRWD_R0          0x1
+
+#endif // __HW_SYSCTL_H__
@@ -0,0 +1,56 @@
+//*****************************************************************************
+//
+// hw_timer.h - Defines and macros used when accessing the timer.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_TIMER_H__
+#define __HW_TIMER_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_timer.h when the boot loader is
+// built for the host simulator.  It holds only the general purpose timers
+// definitions that the boot loader, the driverlib files that it uses and the
+// simulator's models refer to.
+//
+//*****************************************************************************
+
+#define TIMER_O_CFG             0x0
+#define TIMER_O_TAMR            0x4
+#define TIMER_O_TBMR            0x8
+#define TIMER_O_CTL             0xC
+#define TIMER_O_IMR             0x18
+#define TIMER_O_RIS             0x1C
+#define TIMER_O_MIS             0x20
+#define TIMER_O_ICR             0x24
+#define TIMER_O_TAILR           0x28
+#define TIMER_O_TBILR           0x2C
+#define TIMER_O_TAR             0x48
+#define TIMER_O_TAV             0x50
+#define TIMER_CFG_32_BIT_TIMER  0x0
+#define TIMER_TAMR_TAMR_1_SHOT  0x1
+#define TIMER_TAMR_TAMR_PERIOD  0x2
+#define TIMER_CTL_TAEN          0x1
+#define TIMER_RIS_TATORIS       0x1
+#define TIMER_ICR_TATOCINT      0x1
+
+#endif // __HW_TIMER_H__
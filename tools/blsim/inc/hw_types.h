@@ -0,0 +1,67 @@
+//*****************************************************************************
+//
+// hw_types.h - Register access macros redirected to the host simulator.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+#include <stdint.h>
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_types.h when the boot loader is
+// built for the host simulator.  Rather than dereferencing a fixed address,
+// every register access is handed to BLSimReg(), which returns the location
+// of the register in the simulator's emulated register space.  Byte and
+// halfword accesses hand over their own address, so that the models can
+// tell which part of a register they reach.
+//
+//*****************************************************************************
+extern volatile uint32_t *BLSimReg(uint32_t ui32Address);
+
+//*****************************************************************************
+//
+// Macros for hardware access, both direct and via the bit-band region.
+//
+//*****************************************************************************
+#define HWREG(x)                (*BLSimReg((uint32_t)(x)))
+#define HWREGH(x)                                                             \
+        (*((volatile uint16_t *)((volatile uint8_t *)                         \
+                                 BLSimReg((uint32_t)(x)) +                    \
+                                 ((uint32_t)(x) & 3))))
+#define HWREGB(x)                                                             \
+        (*((volatile uint8_t *)BLSimReg((uint32_t)(x)) +                      \
+         ((uint32_t)(x) & 3)))
+
+//*****************************************************************************
+//
+// The simulator models a TM4C129 class device.
+//
+//*****************************************************************************
+#define CLASS_IS_TM4C123        0
+#define CLASS_IS_TM4C129        1
+#define REVISION_IS_A0          0
+#define REVISION_IS_A1          0
+#define REVISION_IS_A2          1
+
+#endif // __HW_TYPES_H__
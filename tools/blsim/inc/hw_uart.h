@@ -0,0 +1,73 @@
+//*****************************************************************************
+//
+// hw_uart.h - Macros and defines used when accessing the UART hardware.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_UART_H__
+#define __HW_UART_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_uart.h when the boot loader is
+// built for the host simulator.  It holds only the UART definitions that the
+// boot loader, the driverlib files that it uses and the simulator's models
+// refer to.
+//
+//*****************************************************************************
+
+#define UART_O_DR               0x0
+#define UART_O_RSR              0x4
+#define UART_O_ECR              0x4
+#define UART_O_FR               0x18
+#define UART_O_IBRD             0x24
+#define UART_O_FBRD             0x28
+#define UART_O_LCRH             0x2C
+#define UART_O_CTL              0x30
+#define UART_O_IFLS             0x34
+#define UART_O_IM               0x38
+#define UART_O_RIS              0x3C
+#define UART_O_MIS              0x40
+#define UART_O_ICR              0x44
+#define UART_O_DMACTL           0x48
+#define UART_O_CC               0xFC8
+#define UART_FR_TXFE            0x80
+#define UART_FR_RXFF            0x40
+#define UART_FR_TXFF            0x20
+#define UART_FR_RXFE            0x10
+#define UART_FR_BUSY            0x8
+#define UART_DR_OE              0x800
+#define UART_DR_BE              0x400
+#define UART_DR_PE              0x200
+#define UART_DR_FE              0x100
+#define UART_DR_DATA_M          0xFF
+#define UART_RSR_OE             0x8
+#define UART_RSR_BE             0x4
+#define UART_RSR_PE             0x2
+#define UART_RSR_FE             0x1
+#define UART_LCRH_WLEN_8        0x60
+#define UART_LCRH_FEN           0x10
+#define UART_CTL_UARTEN         0x1
+#define UART_CTL_TXE            0x100
+#define UART_CTL_RXE            0x200
+#define UART_FBRD_DIVFRAC_M     0x3F
+
+#endif // __HW_UART_H__
@@ -0,0 +1,83 @@
+//*****************************************************************************
+//
+// hw_udma.h - Macros for use in accessing the UDMA registers.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_UDMA_H__
+#define __HW_UDMA_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_udma.h when the boot loader is
+// built for the host simulator.  It holds only the uDMA controller definitions
+// that the boot loader, the driverlib files that it uses and the simulator's
+// models refer to.
+//
+//*****************************************************************************
+
+#define UDMA_CFG                0x400FF004
+#define UDMA_CTLBASE            0x400FF008
+#define UDMA_ALTBASE            0x400FF00C
+#define UDMA_SWREQ              0x400FF014
+#define UDMA_USEBURSTSET        0x400FF018
+#define UDMA_USEBURSTCLR        0x400FF01C
+#define UDMA_REQMASKSET         0x400FF020
+#define UDMA_REQMASKCLR         0x400FF024
+#define UDMA_ENASET             0x400FF028
+#define UDMA_ENACLR             0x400FF02C
+#define UDMA_ALTSET             0x400FF030
+#define UDMA_ALTCLR             0x400FF034
+#define UDMA_PRIOSET            0x400FF038
+#define UDMA_PRIOCLR            0x400FF03C
+#define UDMA_ERRCLR             0x400FF04C
+#define UDMA_CHASGN             0x400FF500
+#define UDMA_CHIS               0x400FF504
+#define UDMA_CHMAP0             0x400FF510
+#define UDMA_CFG_MASTEN         0x00000001
+#define UDMA_CHCTL_DSTINC_M     0xC0000000
+#define UDMA_CHCTL_DSTINC_32    0x80000000
+#define UDMA_CHCTL_DSTINC_NONE  0xC0000000
+#define UDMA_CHCTL_DSTSIZE_M    0x30000000
+#define UDMA_CHCTL_DSTSIZE_32   0x20000000
+#define UDMA_CHCTL_SRCINC_M     0x0C000000
+#define UDMA_CHCTL_SRCINC_32    0x08000000
+#define UDMA_CHCTL_SRCSIZE_M    0x03000000
+#define UDMA_CHCTL_SRCSIZE_32   0x02000000
+#define UDMA_CHCTL_ARBSIZE_M    0x0003C000
+#define UDMA_CHCTL_ARBSIZE_4    0x00008000
+#define UDMA_CHCTL_ARBSIZE_16   0x00010000
+#define UDMA_CHCTL_XFERSIZE_M   0x00003FF0
+#define UDMA_CHCTL_XFERSIZE_S   4
+#define UDMA_CHCTL_NXTUSEBURST  0x00000008
+#define UDMA_CHCTL_XFERMODE_M   0x00000007
+#define UDMA_CHCTL_XFERMODE_BASIC 0x00000001
+#define UDMA_CHCTL_XFERMODE_MEM_SG 0x00000004
+#define UDMA_CHCTL_XFERMODE_PER_SG 0x00000006
+#define UDMA_CHMAP1             0x400FF514
+#define UDMA_CHMAP2             0x400FF518
+#define UDMA_CHMAP3             0x400FF51C
+#define UDMA_CHCTL_DSTINC_8     0x00000000
+#define UDMA_CHCTL_SRCINC_NONE  0x0C000000
+#define UDMA_CHCTL_ARBSIZE_S    14
+#define UDMA_CHCTL_XFERMODE_STOP 0x00000000
+
+#endif // __HW_UDMA_H__
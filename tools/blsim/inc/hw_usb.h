@@ -0,0 +1,259 @@
+//*****************************************************************************
+//
+// hw_usb.h - Macros for use in accessing the USB registers.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_USB_H__
+#define __HW_USB_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_usb.h when the boot loader is
+// built for the host simulator.  It holds only the USB controller definitions
+// that the boot loader, the driverlib files that it uses and the simulator's
+// models refer to.
+//
+//*****************************************************************************
+
+#define USB_O_FADDR             0x0
+#define USB_O_POWER             0x1
+#define USB_O_TXIS              0x2
+#define USB_O_RXIS              0x4
+#define USB_O_TXIE              0x6
+#define USB_O_RXIE              0x8
+#define USB_O_IS                0xa
+#define USB_O_IE                0xb
+#define USB_O_FRAME             0xc
+#define USB_O_EPIDX             0xe
+#define USB_O_TEST              0xf
+#define USB_O_FIFO0             0x20
+#define USB_O_FIFO1             0x24
+#define USB_O_DEVCTL            0x60
+#define USB_O_CCONF             0x61
+#define USB_O_TXFIFOSZ          0x62
+#define USB_O_RXFIFOSZ          0x63
+#define USB_O_TXFIFOADD         0x64
+#define USB_O_RXFIFOADD         0x66
+#define USB_O_ULPIVBUSCTL       0x70
+#define USB_O_ULPIREGDATA       0x74
+#define USB_O_ULPIREGADDR       0x75
+#define USB_O_ULPIREGCTL        0x76
+#define USB_O_EPINFO            0x78
+#define USB_O_RAMINFO           0x79
+#define USB_O_TXFUNCADDR0       0x80
+#define USB_O_TXHUBADDR0        0x82
+#define USB_O_CSRL0             0x102
+#define USB_O_CSRH0             0x103
+#define USB_O_COUNT0            0x108
+#define USB_O_TYPE0             0x10a
+#define USB_O_NAKLMT            0x10b
+#define USB_O_TXMAXP1           0x110
+#define USB_O_TXCSRL1           0x112
+#define USB_O_TXCSRH1           0x113
+#define USB_O_RXMAXP1           0x114
+#define USB_O_RXCSRL1           0x116
+#define USB_O_RXCSRH1           0x117
+#define USB_O_RXCOUNT1          0x118
+#define USB_O_TXTYPE1           0x11a
+#define USB_O_TXINTERVAL1       0x11b
+#define USB_O_RXTYPE1           0x11c
+#define USB_O_RXINTERVAL1       0x11d
+#define USB_O_DMAINTR           0x200
+#define USB_O_DMACTL0           0x204
+#define USB_O_DMAADDR0          0x208
+#define USB_O_DMACOUNT0         0x20c
+#define USB_O_RQPKTCOUNT1       0x304
+#define USB_O_LPMATTR           0x360
+#define USB_O_LPMCNTRL          0x362
+#define USB_O_LPMIM             0x363
+#define USB_O_LPMRIS            0x364
+#define USB_O_LPMFADDR          0x365
+#define USB_O_EPC               0x400
+#define USB_O_EPCRIS            0x404
+#define USB_O_EPCIM             0x408
+#define USB_O_EPCISC            0x40c
+#define USB_O_GPCS              0x41c
+#define USB_O_VDC               0x430
+#define USB_O_IDVRIS            0x444
+#define USB_O_IDVIM             0x448
+#define USB_O_IDVISC            0x44c
+#define USB_O_DMASEL            0x450
+#define USB_O_PP                0xfc0
+#define USB_O_PC                0xfc4
+#define USB_O_CC                0xfc8
+#define USB_POWER_ISOUP         0x80
+#define USB_POWER_SOFTCONN      0x40
+#define USB_POWER_HSENAB        0x20
+#define USB_POWER_HSMODE        0x10
+#define USB_POWER_RESET         0x8
+#define USB_POWER_RESUME        0x4
+#define USB_POWER_SUSPEND       0x2
+#define USB_POWER_PWRDNPHY      0x1
+#define USB_IS_VBUSERR          0x80
+#define USB_IS_SESREQ           0x40
+#define USB_IS_DISCON           0x20
+#define USB_IS_CONN             0x10
+#define USB_IS_SOF              0x8
+#define USB_IS_BABBLE           0x4
+#define USB_IS_RESET            0x4
+#define USB_IS_RESUME           0x2
+#define USB_IS_SUSPEND          0x1
+#define USB_IE_VBUSERR          0x80
+#define USB_IE_SESREQ           0x40
+#define USB_IE_DISCON           0x20
+#define USB_IE_CONN             0x10
+#define USB_IE_SOF              0x8
+#define USB_IE_BABBLE           0x4
+#define USB_IE_RESET            0x4
+#define USB_IE_RESUME           0x2
+#define USB_IE_SUSPND           0x1
+#define USB_CSRL0_NAKTO         0x80
+#define USB_CSRL0_SETENDC       0x80
+#define USB_CSRL0_STATUS        0x40
+#define USB_CSRL0_RXRDYC        0x40
+#define USB_CSRL0_REQPKT        0x20
+#define USB_CSRL0_STALL         0x20
+#define USB_CSRL0_SETEND        0x10
+#define USB_CSRL0_ERROR         0x10
+#define USB_CSRL0_DATAEND       0x8
+#define USB_CSRL0_SETUP         0x8
+#define USB_CSRL0_STALLED       0x4
+#define USB_CSRL0_TXRDY         0x2
+#define USB_CSRL0_RXRDY         0x1
+#define USB_CSRH0_DISPING       0x8
+#define USB_CSRH0_DTWE          0x4
+#define USB_CSRH0_DT            0x2
+#define USB_CSRH0_FLUSH         0x1
+#define USB_TXCSRL1_NAKTO       0x80
+#define USB_TXCSRL1_CLRDT       0x40
+#define USB_TXCSRL1_STALLED     0x20
+#define USB_TXCSRL1_STALL       0x10
+#define USB_TXCSRL1_SETUP       0x10
+#define USB_TXCSRL1_FLUSH       0x8
+#define USB_TXCSRL1_ERROR       0x4
+#define USB_TXCSRL1_UNDRN       0x4
+#define USB_TXCSRL1_FIFONE      0x2
+#define USB_TXCSRL1_TXRDY       0x1
+#define USB_TXCSRH1_AUTOSET     0x80
+#define USB_TXCSRH1_ISO         0x40
+#define USB_TXCSRH1_MODE        0x20
+#define USB_TXCSRH1_DMAEN       0x10
+#define USB_TXCSRH1_FDT         0x8
+#define USB_TXCSRH1_DMAMOD      0x4
+#define USB_TXCSRH1_DTWE        0x2
+#define USB_TXCSRH1_DT          0x1
+#define USB_RXCSRL1_CLRDT       0x80
+#define USB_RXCSRL1_STALLED     0x40
+#define USB_RXCSRL1_STALL       0x20
+#define USB_RXCSRL1_REQPKT      0x20
+#define USB_RXCSRL1_FLUSH       0x10
+#define USB_RXCSRL1_DATAERR     0x8
+#define USB_RXCSRL1_NAKTO       0x8
+#define USB_RXCSRL1_OVER        0x4
+#define USB_RXCSRL1_ERROR       0x4
+#define USB_RXCSRL1_FULL        0x2
+#define USB_RXCSRL1_RXRDY       0x1
+#define USB_RXCSRH1_AUTOCL      0x80
+#define USB_RXCSRH1_AUTORQ      0x40
+#define USB_RXCSRH1_ISO         0x40
+#define USB_RXCSRH1_DMAEN       0x20
+#define USB_RXCSRH1_DISNYET     0x10
+#define USB_RXCSRH1_PIDERR      0x10
+#define USB_RXCSRH1_DMAMOD      0x8
+#define USB_RXCSRH1_DTWE        0x4
+#define USB_RXCSRH1_DT          0x2
+#define USB_RXCSRH1_INCOMPRX    0x1
+#define USB_DMACTL0_BRSTM_M     0x600
+#define USB_DMACTL0_ERR         0x100
+#define USB_DMACTL0_EP_M        0xf0
+#define USB_DMACTL0_EP_S        0x4
+#define USB_DMACTL0_IE          0x8
+#define USB_DMACTL0_MODE        0x4
+#define USB_DMACTL0_DIR         0x2
+#define USB_DMACTL0_ENABLE      0x1
+#define USB_DMAINTR_CH0         0x1
+#define USB_DEVCTL_DEV          0x80
+#define USB_DEVCTL_FSDEV        0x40
+#define USB_DEVCTL_LSDEV        0x20
+#define USB_DEVCTL_VBUS_M       0x18
+#define USB_DEVCTL_HOST         0x4
+#define USB_DEVCTL_HOSTREQ      0x2
+#define USB_DEVCTL_SESSION      0x1
+#define USB_GPCS_DEVMODOTG      0x2
+#define USB_GPCS_DEVMOD         0x1
+#define USB_EPCIM_PF            0x1
+#define USB_EPCISC_PF           0x1
+#define USB_IDVIM_ID            0x1
+#define USB_IDVRIS_ID           0x1
+#define USB_FADDR_M             0x7f
+#define USB_COUNT0_COUNT_M      0x7f
+#define USB_RXCOUNT1_COUNT_M    0x1fff
+#define USB_DEV_IN_FIFO_NE      0x0
+#define USB_DEV_IN_NOT_COMP     0x0
+#define USB_DEV_IN_PKTPEND      0x0
+#define USB_DEV_IN_SENT_STALL   0x0
+#define USB_DEV_IN_UNDERRUN     0x0
+#define USB_DEV_OUT_DATA_ERROR  0x0
+#define USB_DEV_OUT_FIFO_FULL   0x0
+#define USB_DEV_OUT_OVERRUN     0x0
+#define USB_DEV_OUT_PKTRDY      0x0
+#define USB_DEV_OUT_SENT_STALL  0x0
+#define USB_DMA_CFG_MODE0       0x0
+#define USB_EPC_EPENDE          0x0
+#define USB_EPC_EPEN_M          0x0
+#define USB_EPC_PFLTACT_M       0x0
+#define USB_EPC_PFLTAEN         0x0
+#define USB_EPC_PFLTEN          0x0
+#define USB_EPC_PFLTSEN_HIGH    0x0
+#define USB_EPINFO_TXEP_M       0x0
+#define USB_HOST_EP0_IN_PKTRDY  0x0
+#define USB_HOST_EP0_IN_STALL   0x0
+#define USB_LPMATTR_ENDPT_M     0x0
+#define USB_LPMATTR_ENDPT_S     0x0
+#define USB_LPMATTR_HIRD_S      0x0
+#define USB_LPMATTR_LS_M        0x0
+#define USB_LPMATTR_RMTWAK      0x0
+#define USB_LPMCNTRL_EN_LPMEXT  0x0
+#define USB_LPMCNTRL_RES        0x0
+#define USB_LPMCNTRL_TXLPM      0x0
+#define USB_MODE_DEVICE         0x0
+#define USB_MODE_DEVICE_VBUS    0x0
+#define USB_PC_ULPIEN           0x0
+#define USB_PP_TYPE_M           0x0
+#define USB_RAMINFO_DMACHAN_S   0x0
+#define USB_RXTYPE1_SPEED_M     0x0
+#define USB_TXTYPE1_PROTO_BULK  0x0
+#define USB_TXTYPE1_PROTO_CTRL  0x0
+#define USB_TXTYPE1_PROTO_INT   0x0
+#define USB_TXTYPE1_PROTO_ISOC  0x0
+#define USB_TXTYPE1_SPEED_FULL  0x0
+#define USB_TXTYPE1_SPEED_HIGH  0x0
+#define USB_TXTYPE1_SPEED_LOW   0x0
+#define USB_TXTYPE1_SPEED_M     0x0
+#define USB_TYPE0_SPEED_FULL    0x0
+#define USB_TYPE0_SPEED_HIGH    0x0
+#define USB_TYPE0_SPEED_LOW     0x0
+#define USB_ULPIREGCTL_RDWR     0x0
+#define USB_ULPIREGCTL_REGACC   0x0
+#define USB_ULPIREGCTL_REGCMPLT 0x0
+
+#endif // __HW_USB_H__
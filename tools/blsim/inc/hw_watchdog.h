@@ -0,0 +1,56 @@
+//*****************************************************************************
+//
+// hw_watchdog.h - Macros used when accessing the Watchdog Timer hardware.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+#ifndef __HW_WATCHDOG_H__
+#define __HW_WATCHDOG_H__
+
+//*****************************************************************************
+//
+// This file stands in for TivaWare's inc/hw_watchdog.h when the boot loader is
+// built for the host simulator.  It holds only the watchdog timers definitions
+// that the boot loader, the driverlib files that it uses and the simulator's
+// models refer to.
+//
+//*****************************************************************************
+
+#define WDT_O_LOAD              0x00000000
+#define WDT_O_VALUE             0x00000004
+#define WDT_O_CTL               0x00000008
+#define WDT_O_ICR               0x0000000C
+#define WDT_O_RIS               0x00000010
+#define WDT_O_MIS               0x00000014
+#define WDT_O_TEST              0x00000418
+#define WDT_O_LOCK              0x00000C00
+#define WDT_CTL_WRC             0x80000000
+#define WDT_CTL_INTTYPE         0x00000004
+#define WDT_CTL_RESEN           0x00000002
+#define WDT_CTL_INTEN           0x00000001
+#define WDT_RIS_WDTRIS          0x00000001
+#define WDT_TEST_STALL          0x00000100
+#define WDT_LOCK_M              0xFFFFFFFF
+#define WDT_LOCK_UNLOCKED       0x00000000
+#define WDT_LOCK_LOCKED         0x00000001
+#define WDT_LOCK_UNLOCK         0x1ACCE551
+
+#endif // __HW_WATCHDOG_H__
@@ -0,0 +1,229 @@
+//*****************************************************************************
+//
+// sim_aes.c - Checks of the image decryption.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DENABLE_DECRYPTION and -DDECRYPT_AES_MODE, the boot loader's AES is
+// checked against the examples of NIST SP 800-38A, if the key is theirs, and
+// the host model sends the image encrypted, so that what is programmed shows
+// that it was decrypted correctly.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "blsim.h"
+
+#ifdef DECRYPT_AES_MODE
+//*****************************************************************************
+//
+// The initial counter block or IV that the host model encrypts the image
+// from, when the boot loader is built to decrypt it.
+//
+//*****************************************************************************
+const uint8_t g_pui8SimIV[AES_BLOCK_SIZE] =
+{
+    0xb1, 0x0a, 0xde, 0xd0, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0xf0
+};
+
+//*****************************************************************************
+//
+// Encrypts a copy of the image, padded to a whole number of blocks with
+// erased bytes, as the boot loader is built to decrypt it.  CTR mode is its
+// own inverse, so the boot loader's own decryption does the encryption.
+//
+//*****************************************************************************
+uint8_t *
+SimImageEncrypt(const uint8_t *pui8Image, uint32_t ui32Size)
+{
+    uint8_t *pui8Copy;
+    uint32_t ui32Padded;
+#if DECRYPT_AES_MODE != AES_CFG_MODE_CTR
+    uint8_t pui8Chain[AES_BLOCK_SIZE];
+    uint32_t ui32Offset, ui32Idx;
+#endif
+
+    ui32Padded = ((ui32Size + 127) / 128) * 128;
+    pui8Copy = malloc(ui32Padded ? ui32Padded : 1);
+    if(!pui8Copy)
+    {
+        fprintf(stderr, "blsim: out of memory\n");
+        exit(1);
+    }
+    memset(pui8Copy, 0xff, ui32Padded);
+    memcpy(pui8Copy, pui8Image, ui32Size);
+
+#if DECRYPT_AES_MODE == AES_CFG_MODE_CTR
+    DecryptStart(g_pui8SimIV);
+    DecryptData(pui8Copy, ui32Padded);
+#else
+    memcpy(pui8Chain, g_pui8SimIV, AES_BLOCK_SIZE);
+    for(ui32Offset = 0; ui32Offset < ui32Padded; ui32Offset += AES_BLOCK_SIZE)
+    {
+        for(ui32Idx = 0; ui32Idx < AES_BLOCK_SIZE; ui32Idx++)
+        {
+            pui8Copy[ui32Offset + ui32Idx] ^= pui8Chain[ui32Idx];
+        }
+        AES128Encrypt(pui8Copy + ui32Offset);
+        memcpy(pui8Chain, pui8Copy + ui32Offset, AES_BLOCK_SIZE);
+    }
+#endif
+
+    return(pui8Copy);
+}
+
+//*****************************************************************************
+//
+// Converts a string of hex digits to bytes.
+//
+//*****************************************************************************
+static void
+SimHexBytes(const char *pcHex, uint8_t *pui8Bytes)
+{
+    unsigned int uByte;
+
+    while(*pcHex && (sscanf(pcHex, "%2x", &uByte) == 1))
+    {
+        *pui8Bytes++ = uByte;
+        pcHex += 2;
+    }
+}
+
+//*****************************************************************************
+//
+// Checks the boot loader's AES against the AES-128 examples of NIST SP
+// 800-38A, which need the key in bl_config.h to be the one they use.  The
+// cipher is checked in both directions on the ECB example, then the
+// decryption of the configured mode on its example, fed in pieces of varying
+// sizes.  In CTR mode the key stream is also checked across skipped data.
+// Returns non-zero if any result is wrong.
+//
+//*****************************************************************************
+int
+SimAESCheck(void)
+{
+    static const uint32_t pui32Key[4] = { DECRYPT_AES_KEY };
+    static const uint32_t pui32NISTKey[4] =
+    {
+        0x2b7e1516, 0x28aed2a6, 0xabf71588, 0x09cf4f3c
+    };
+    static const char pcPlain[] =
+        "6bc1bee22e409f96e93d7e117393172aae2d8a571e03ac9c9eb76fac45af8e51"
+        "30c81c46a35ce411e5fbc1191a0a52eff69f2445df4f9b17ad2b417be66c3710";
+    static const char pcECB[] =
+        "3ad77bb40d7a3660a89ecaf32466ef97f5d3d58503b9699de785895a96fdbaaf"
+        "43b1cd7f598ece23881b00e3ed0306887b0c785e27e8ad3f8223207104725dd4";
+#if DECRYPT_AES_MODE == AES_CFG_MODE_CTR
+    static const char pcIV[] = "f0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+    static const char pcCipher[] =
+        "874d6191b620e3261bef6864990db6ce9806f66b7970fdff8617187bb9fffdff"
+        "5ae4df3edbd5d35e5b4f09020db03eab1e031dda2fbe03d1792170a0f3009cee";
+    static const uint32_t pui32Pieces[] = { 1, 15, 17, 31 };
+    uint8_t pui8Stream[300], pui8Skipped[300];
+#else
+    static const char pcIV[] = "000102030405060708090a0b0c0d0e0f";
+    static const char pcCipher[] =
+        "7649abac8119b246cee98e9b12e9197d5086cb9b507219ee95db113a917678b2"
+        "73bed6b8e3c1743b7116e69e222295163ff1caa1681fac09120eca307586e1a7";
+    static const uint32_t pui32Pieces[] = { 16, 32, 16 };
+#endif
+    uint8_t pui8Plain[64], pui8Expect[64], pui8Data[64], pui8IV[16];
+    uint32_t ui32Idx, ui32Offset, ui32Piece;
+    int iFailed;
+
+    if(memcmp(pui32Key, pui32NISTKey, sizeof(pui32Key)))
+    {
+        printf("aes:       not checked, the key is not the SP 800-38A key\n");
+        return(0);
+    }
+
+    SimHexBytes(pcPlain, pui8Plain);
+    SimHexBytes(pcECB, pui8Expect);
+    SimHexBytes(pcIV, pui8IV);
+    iFailed = 0;
+
+    //
+    // The cipher, both ways.
+    //
+    memcpy(pui8Data, pui8Plain, sizeof(pui8Data));
+    for(ui32Offset = 0; ui32Offset < sizeof(pui8Data); ui32Offset += 16)
+    {
+        AES128Encrypt(pui8Data + ui32Offset);
+    }
+    iFailed |= (memcmp(pui8Data, pui8Expect, sizeof(pui8Data)) != 0);
+    for(ui32Offset = 0; ui32Offset < sizeof(pui8Data); ui32Offset += 16)
+    {
+        AES128Decrypt(pui8Data + ui32Offset);
+    }
+    iFailed |= (memcmp(pui8Data, pui8Plain, sizeof(pui8Data)) != 0);
+
+    //
+    // The decryption of the configured mode.
+    //
+    SimHexBytes(pcCipher, pui8Data);
+    DecryptStart(pui8IV);
+    for(ui32Idx = 0, ui32Offset = 0; ui32Offset < sizeof(pui8Data);
+        ui32Idx++)
+    {
+        ui32Piece = pui32Pieces[ui32Idx % (sizeof(pui32Pieces) / 4)];
+        if(ui32Piece > (sizeof(pui8Data) - ui32Offset))
+        {
+            ui32Piece = sizeof(pui8Data) - ui32Offset;
+        }
+        DecryptData(pui8Data + ui32Offset, ui32Piece);
+        ui32Offset += ui32Piece;
+    }
+    iFailed |= (memcmp(pui8Data, pui8Plain, sizeof(pui8Data)) != 0);
+
+#if DECRYPT_AES_MODE == AES_CFG_MODE_CTR
+    //
+    // Skipping data must leave the key stream where decrypting it would.
+    //
+    memset(pui8Stream, 0, sizeof(pui8Stream));
+    DecryptStart(pui8IV);
+    DecryptData(pui8Stream, sizeof(pui8Stream));
+    memset(pui8Skipped, 0, sizeof(pui8Skipped));
+    DecryptStart(pui8IV);
+    DecryptData(pui8Skipped, 5);
+    DecryptSkip(200);
+    DecryptData(pui8Skipped + 205, 3);
+    DecryptSkip(13);
+    DecryptData(pui8Skipped + 221, sizeof(pui8Skipped) - 221);
+    iFailed |= (memcmp(pui8Skipped, pui8Stream, 5) ||
+                memcmp(pui8Skipped + 205, pui8Stream + 205, 3) ||
+                memcmp(pui8Skipped + 221, pui8Stream + 221,
+                       sizeof(pui8Stream) - 221));
+#endif
+
+    printf("aes:       SP 800-38A %s examples %s\n",
+           (DECRYPT_AES_MODE == AES_CFG_MODE_CTR) ? "ECB and CTR" :
+           "ECB and CBC", iFailed ? "FAILED" : "ok");
+
+    return(iFailed);
+}
+#endif
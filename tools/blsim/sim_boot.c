@@ -0,0 +1,374 @@
+//*****************************************************************************
+//
+// sim_boot.c - Checks of the time from reset to the application.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DBOOT_CYCLES_ADDRESS, once the image has been programmed, the cycles
+// from reset to the branch to the application are counted, at the 16 MHz of
+// the precision internal oscillator, for both ways that the ResetISR of
+// bl_startup_ccs.s can get there: the full check, which copies the boot
+// loader to SRAM, zeros its .bss and calls CheckForceUpdate(), and the fast
+// path, which checks the vector table in place.  The assembly is followed
+// instruction by instruction, each taking one cycle, a taken branch three,
+// and each load or store the cost of a register access; CheckForceUpdate()
+// itself is run, and only its register accesses are counted.  The sizes
+// copied and zeroed are those of the Debug build in Debug/boot_serial_ccs.map.
+// The fast path is then checked to leave reset vectors outside the
+// application or the flash, stack pointers outside SRAM and vectors without
+// the Thumb bit to the full check.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "inc/hw_flash.h"
+#include "inc/hw_nvic.h"
+#include "blsim.h"
+
+#ifdef BOOT_CYCLES_ADDRESS
+#include "boot_loader/bl_check.h"
+
+//*****************************************************************************
+//
+// Whether the build has the fast path, under the same condition as the
+// ResetISR.
+//
+//*****************************************************************************
+#if !defined(BL_CHECK_UPDATE_FN_HOOK) && !defined(BL_HW_INIT_FN_HOOK) &&     \
+    !defined(CHECK_CRC) && !defined(CHECK_SIGNATURE) &&                       \
+    !defined(ENABLE_UPDATE_CHECK) &&                                          \
+    !(defined(BL_WATCHDOG_TIMEOUT) && defined(FLASH_JOURNAL_ADDRESS))
+#define SIM_BOOT_FAST
+#endif
+
+//*****************************************************************************
+//
+// The clock that the device resets to, and the end of the boot loader's code
+// and data and of its .bss and stack in SRAM, from the Debug map.
+//
+//*****************************************************************************
+#define SIM_BOOT_CLOCK          16000000
+#define SIM_BOOT_BSS_RUN        0x20000d30
+#define SIM_BOOT_STACK_TOP      0x20000ee0
+
+//*****************************************************************************
+//
+// Counts instructions that do not touch memory, a load or store whose value
+// is not needed, and a conditional branch, which is returned so that it can
+// be followed.  Loads whose value is needed are made through HWREG(), which
+// counts them itself.
+//
+//*****************************************************************************
+static void
+SimBootInsns(uint32_t ui32Count)
+{
+    g_ui64Now += ui32Count;
+}
+
+static void
+SimBootAccess(uint32_t ui32Address)
+{
+    g_ui64Now += g_pfnBLSimCycleCost(ui32Address);
+}
+
+static bool
+SimBootBranch(bool bTaken)
+{
+    g_ui64Now += bTaken ? 3 : 1;
+    return(bTaken);
+}
+
+//*****************************************************************************
+//
+// The start of ResetISR, which starts the cycle counter and enables the
+// floating-point unit.
+//
+//*****************************************************************************
+static void
+SimBootStart(void)
+{
+    SimBootInsns(2);
+    SimBootAccess(NVIC_DBG_INT);
+    SimBootInsns(1);
+    SimBootAccess(NVIC_DBG_INT);
+    SimBootInsns(3);
+    SimBootAccess(0xe0001004);
+    SimBootAccess(0xe0001000);
+    SimBootInsns(1);
+    SimBootAccess(0xe0001000);
+
+    SimBootInsns(2);
+    SimBootAccess(0xe000ed88);
+    SimBootInsns(1);
+    SimBootAccess(0xe000ed88);
+}
+
+//*****************************************************************************
+//
+// The fast path, which returns true if it branches to the application.
+//
+//*****************************************************************************
+#ifdef SIM_BOOT_FAST
+static bool
+SimBootFast(void)
+{
+    uint32_t ui32Value, ui32End;
+
+    SimBootInsns((APP_START_ADDRESS > 0xffff) ? 2 : 1);
+    ui32Value = HWREG(APP_START_ADDRESS);
+    SimBootInsns(2);
+    if(SimBootBranch((ui32Value >> 20) != 0x200))
+    {
+        return(false);
+    }
+
+    ui32Value = HWREG(APP_START_ADDRESS + 4);
+    SimBootInsns(1);
+    if(SimBootBranch(!(ui32Value & 1)))
+    {
+        return(false);
+    }
+    SimBootInsns(1);
+    if(SimBootBranch(ui32Value <= APP_START_ADDRESS))
+    {
+        return(false);
+    }
+    SimBootInsns(2);
+    ui32End = ((HWREG(FLASH_PP) & FLASH_PP_SIZE_M) + 1) << 11;
+    SimBootInsns(4);
+    if(SimBootBranch(ui32Value >= ui32End))
+    {
+        return(false);
+    }
+
+    SimBootBranch(true);
+    return(true);
+}
+#endif
+
+//*****************************************************************************
+//
+// The full check, from the call to ProcessorInit, which returns true if the
+// boot loader branches to the application.
+//
+//*****************************************************************************
+static bool
+SimBootFull(void)
+{
+    uint32_t ui32Address;
+
+    //
+    // ProcessorInit copies the boot loader to SRAM and zeros the .bss and the
+    // stack.
+    //
+    SimBootBranch(true);
+    SimBootInsns(3);
+    SimBootAccess(0);
+    for(ui32Address = 0x20000000; ui32Address < SIM_BOOT_BSS_RUN;
+        ui32Address += 4)
+    {
+        SimBootAccess(ui32Address - 0x20000000);
+        SimBootAccess(ui32Address);
+        SimBootInsns(1);
+        SimBootBranch((ui32Address + 4) < SIM_BOOT_BSS_RUN);
+    }
+    SimBootInsns(1);
+    SimBootAccess(0);
+    for(; ui32Address < SIM_BOOT_STACK_TOP; ui32Address += 4)
+    {
+        SimBootAccess(ui32Address);
+        SimBootInsns(1);
+        SimBootBranch((ui32Address + 4) < SIM_BOOT_STACK_TOP);
+    }
+    SimBootInsns(4);
+    SimBootAccess(NVIC_VTABLE);
+    SimBootInsns(1);
+    SimBootBranch(true);
+
+    //
+    // Then ResetISR calls CheckForceUpdate() and branches to the application
+    // if it returns zero.
+    //
+    SimBootBranch(true);
+    if(CheckForceUpdate() != 0)
+    {
+        SimBootBranch(false);
+        return(false);
+    }
+    SimBootBranch(true);
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// CallApplication, which moves the vector table, records the count and
+// branches to the application.
+//
+//*****************************************************************************
+static void
+SimBootCall(void)
+{
+#if APP_START_ADDRESS != VTABLE_START_ADDRESS
+    uint32_t ui32Idx;
+
+    SimBootInsns(6);
+    for(ui32Idx = 0; ui32Idx < 70; ui32Idx++)
+    {
+        SimBootAccess(APP_START_ADDRESS + (ui32Idx * 4));
+        SimBootAccess(VTABLE_START_ADDRESS + (ui32Idx * 4));
+        SimBootInsns(1);
+        SimBootBranch(ui32Idx < 69);
+    }
+#endif
+    SimBootInsns(4);
+    SimBootAccess(NVIC_VTABLE);
+    SimBootAccess(APP_START_ADDRESS);
+    SimBootInsns(2);
+    SimBootAccess(0xe0001004);
+    SimBootInsns(2);
+    SimBootAccess(BOOT_CYCLES_ADDRESS);
+    SimBootAccess(APP_START_ADDRESS + 4);
+    SimBootBranch(true);
+}
+
+//*****************************************************************************
+//
+// Runs the reset handler on the flash as it is, by the fast path if bFast is
+// set, and returns the number of cycles to the application, or zero if the
+// boot loader keeps control.
+//
+//*****************************************************************************
+static uint32_t
+SimBootRun(bool bFast)
+{
+    uint64_t ui64Start;
+    bool bApp;
+
+    ui64Start = g_ui64Now;
+    SimBootStart();
+    bApp = false;
+#ifdef SIM_BOOT_FAST
+    if(bFast)
+    {
+        bApp = SimBootFast();
+    }
+#else
+    (void)bFast;
+#endif
+    if(!bApp)
+    {
+        bApp = SimBootFull();
+    }
+    if(!bApp)
+    {
+        return(0);
+    }
+    SimBootCall();
+
+    return((uint32_t)(g_ui64Now - ui64Start));
+}
+
+//*****************************************************************************
+//
+// Writes the stack pointer and reset vector at the start of the
+// application, returning whether the fast path takes them.  The full check
+// is not run, so that the counts stay small.
+//
+//*****************************************************************************
+#ifdef SIM_BOOT_FAST
+static bool
+SimBootVectors(uint32_t ui32SP, uint32_t ui32PC)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+    {
+        g_pui8Flash[APP_START_ADDRESS + ui32Idx] = ui32SP >> (8 * ui32Idx);
+        g_pui8Flash[APP_START_ADDRESS + 4 + ui32Idx] =
+            ui32PC >> (8 * ui32Idx);
+    }
+
+    return(SimBootFast());
+}
+#endif
+
+//*****************************************************************************
+//
+// Counts the cycles from reset to the programmed application by the full
+// check and by the fast path, then checks the bounds of the fast path.
+// Returns non-zero if any result is wrong.
+//
+//*****************************************************************************
+int
+SimBootCheck(void)
+{
+    uint32_t ui32Full, ui32Fast, ui32SysClockHz;
+    uint8_t pui8Saved[8];
+    uint32_t ui32Idx;
+    int iFailed;
+
+    ui32SysClockHz = g_ui32SysClockHz;
+    g_ui32SysClockHz = SIM_BOOT_CLOCK;
+
+    ui32Full = SimBootRun(false);
+    ui32Fast = SimBootRun(true);
+    iFailed = !ui32Full || !ui32Fast;
+    printf("boot:      %u cycles (%.1f us) by the full check, %u cycles "
+           "(%.1f us) by the\n           fast path, at %u MHz%s\n", ui32Full,
+           ui32Full * 1e6 / SIM_BOOT_CLOCK, ui32Fast,
+           ui32Fast * 1e6 / SIM_BOOT_CLOCK, SIM_BOOT_CLOCK / 1000000,
+           iFailed ? ", FAILED to reach the application" : "");
+
+#ifdef SIM_BOOT_FAST
+    for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+    {
+        pui8Saved[ui32Idx] = g_pui8Flash[APP_START_ADDRESS + ui32Idx];
+    }
+    ui32Idx = (SimBootVectors(0x20008000, APP_START_ADDRESS + 1) &&
+               SimBootVectors(0x20008000, SIM_FLASH_SIZE - 1) &&
+               !SimBootVectors(0x20008000, APP_START_ADDRESS - 1) &&
+               !SimBootVectors(0x20008000, 0x00000101) &&
+               !SimBootVectors(0x20008000, SIM_FLASH_SIZE + 1) &&
+               !SimBootVectors(0x20008000, APP_START_ADDRESS + 0x100) &&
+               !SimBootVectors(0x10008000, APP_START_ADDRESS + 1) &&
+               !SimBootVectors(0xffffffff, 0xffffffff));
+    printf("boot:      fast path vector bounds %s\n",
+           ui32Idx ? "ok" : "FAILED");
+    iFailed |= !ui32Idx;
+    for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+    {
+        g_pui8Flash[APP_START_ADDRESS + ui32Idx] = pui8Saved[ui32Idx];
+    }
+#else
+    (void)pui8Saved;
+    printf("boot:      this build has no fast path\n");
+#endif
+
+    g_ui32SysClockHz = ui32SysClockHz;
+
+    return(iFailed);
+}
+#endif
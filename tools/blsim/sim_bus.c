@@ -0,0 +1,1368 @@
+//*****************************************************************************
+//
+// sim_bus.c - The model of an RS-485 bus shared by several boot loaders.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DUART_NODE_ID, -N puts the boot loader on a half-duplex RS-485 bus
+// along with the boot loaders of the simulators that it names, each built
+// with a UART_NODE_ID of its own, and the host model updates all of them at
+// once.  Each node runs in a process of its own, started with the internal
+// -Z option, and this process, as the bus, connects their UART models and
+// the host model as the line would: each byte that one of them sends
+// reaches all of the others once it has been sent, and the times at which
+// each node drives the line, by its RS-485 driver enable output on PA2, are
+// recorded.  The nodes are run in lockstep, none of them more than a
+// character time ahead of the earliest time at which another could send, so
+// that every byte reaches each node at the time that it ends on the line.
+//
+// The host model pings each node, broadcasts the download command, and then
+// broadcasts the image in 0x6007 frames, which carry their block numbers,
+// in groups of the size given by -g, leaving each node the time to program
+// one block before the next.  After each group it polls the progress of
+// each node in turn (a read of 0x6005), and resends to any node that is
+// behind, addressed to that node alone, the blocks from the one that it
+// reports it expects next.  -x makes the last node miss the given block, as
+// though noise on its part of the line had corrupted it, so that it ignores
+// the rest of that group until it is polled.  Finally the host broadcasts
+// the reset, to which no node replies.
+//
+// The check fails unless every node ends up with the image, no two of the
+// host and the nodes drive the line at once, every byte that a node sends
+// is sent while its driver is enabled, no byte reaches the host unasked for,
+// and only the node that was made to miss a block needs any resent, having
+// reported that block as the next it expects when it was polled.
+//
+//*****************************************************************************
+
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "blsim.h"
+
+#ifdef UART_NODE_ID
+#include "boot_loader/bl_packet.h"
+
+//*****************************************************************************
+//
+// The messages between a node and the bus.  A node says hello once it has
+// configured its UART, then reports whatever it sent each time it reaches
+// the time up to which it was allowed to run, or has nothing to do before
+// then, and the bus answers with the new time limit and whatever reached
+// the node's UART in the meantime.  A node that has been reset reports that
+// it is done, followed by its result.
+//
+//*****************************************************************************
+#define SIM_BUS_BYTE            0
+#define SIM_BUS_DRIVE_ON        1
+#define SIM_BUS_DRIVE_OFF       2
+
+#define SIM_BUS_BUSY            0
+#define SIM_BUS_IDLE            1
+#define SIM_BUS_DONE            2
+
+typedef struct
+{
+    uint64_t ui64Time;
+    uint32_t ui32Kind;
+    uint32_t ui32Data;
+}
+tSimBusEvent;
+
+typedef struct
+{
+    uint32_t ui32ID;
+    uint32_t ui32SysClockHz;
+    uint32_t ui32BaudRate;
+    uint32_t ui32Reserved;
+    uint64_t ui64ByteCycles;
+}
+tSimBusHello;
+
+typedef struct
+{
+    uint64_t ui64Now;
+    uint64_t ui64Next;
+    uint32_t ui32State;
+    uint32_t ui32Events;
+}
+tSimBusReport;
+
+typedef struct
+{
+    uint64_t ui64Until;
+    uint32_t ui32Events;
+    uint32_t ui32Reserved;
+}
+tSimBusGrant;
+
+typedef struct
+{
+    uint32_t ui32Verify;
+    uint32_t ui32Programs;
+    uint32_t ui32Overruns;
+    uint32_t ui32CRCErrors;
+    uint32_t ui32Ignored;
+}
+tSimBusResult;
+
+//*****************************************************************************
+//
+// The most events in one message, and the time that stands for never.
+//
+//*****************************************************************************
+#define SIM_BUS_EVENTS          1024
+#define SIM_BUS_NEVER           UINT64_MAX
+
+//*****************************************************************************
+//
+// The options that set up the bus: the simulators of the other nodes, the
+// block that the last node misses, and the number of blocks broadcast
+// between polls.
+//
+//*****************************************************************************
+const char *g_ppcBusNodes[SIM_BUS_NODES];
+uint32_t g_ui32BusNodes;
+uint32_t g_ui32BusMiss = 0xffffffff;
+uint32_t g_ui32BusGroup = SIM_BUS_GROUP;
+
+//*****************************************************************************
+//
+// The connection of a node to the bus, if this simulator is one, the time up
+// to which it may run, and what it has sent since it last reported.
+//
+//*****************************************************************************
+int g_iBusFd = -1;
+static uint64_t g_ui64BusUntil;
+static tSimBusEvent g_psBusOut[SIM_BUS_EVENTS];
+static uint32_t g_ui32BusOut;
+
+//*****************************************************************************
+//
+// The bus's view of each node: its connection, where it has got to, the
+// bytes waiting to reach it, whether it is driving the line and since when,
+// when the last byte that it sent ended, and what the host model has seen of
+// it.
+//
+//*****************************************************************************
+typedef struct
+{
+    int iFd;
+    pid_t iPid;
+    uint32_t ui32ID;
+    uint32_t ui32State;
+    uint64_t ui64Now;
+    uint64_t ui64Next;
+    tSimBusEvent psIn[SIM_BUS_EVENTS];
+    uint32_t ui32In;
+    bool bDriving;
+    uint64_t ui64DriveStart;
+    uint64_t ui64LastByte;
+    uint32_t ui32Resent;
+    uint32_t ui32Polled;
+    tSimBusResult sResult;
+}
+tSimBusNode;
+
+static tSimBusNode g_psBusNode[SIM_BUS_NODES];
+static uint32_t g_ui32BusNumNodes;
+
+//*****************************************************************************
+//
+// The times that the line was driven, by the host (source SIM_BUS_NODES) or
+// by a node, and the number of bytes that a node sent without driving it.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint64_t ui64Start;
+    uint64_t ui64End;
+    uint32_t ui32Source;
+}
+tSimBusSpan;
+
+static tSimBusSpan *g_psBusSpans;
+static uint32_t g_ui32BusSpans;
+static uint32_t g_ui32BusUndriven;
+
+//*****************************************************************************
+//
+// The steps of the host model's update of the nodes.
+//
+//*****************************************************************************
+#define SIM_BUS_PING            0
+#define SIM_BUS_DOWNLOAD        1
+#define SIM_BUS_POLL            2
+#define SIM_BUS_BLOCK           3
+#define SIM_BUS_RESEND          4
+#define SIM_BUS_RESET           5
+#define SIM_BUS_END             6
+
+//*****************************************************************************
+//
+// The host model: the step that it is on, the frame for it and when to send
+// it, the reply being received and until when to wait for it, the bytes that
+// have reached it, and what went wrong.  The frames that it sends are those
+// that SimFramesBuild() made, readdressed.
+//
+//*****************************************************************************
+static uint32_t g_ui32BusStep;
+static uint32_t g_ui32BusNode;
+static uint32_t g_ui32BusBlock;
+static uint32_t g_ui32BusGroupEnd;
+static uint32_t g_ui32BusBlocks;
+static uint32_t g_ui32BusTries;
+static tSimFrame g_sBusFrame;
+static bool g_bBusBroadcast;
+static uint64_t g_ui64BusSendAt;
+static uint64_t g_ui64BusListen;
+static uint64_t g_ui64BusDeadline;
+static uint64_t g_ui64BusGap;
+static uint8_t g_pui8BusReply[9];
+static uint32_t g_ui32BusReplyBytes;
+static tSimBusEvent g_psBusRx[SIM_BUS_EVENTS];
+static uint32_t g_ui32BusRxHead;
+static uint32_t g_ui32BusRxCount;
+static uint32_t g_ui32BusPing;
+static uint32_t g_ui32BusDownload;
+static uint32_t g_ui32BusData;
+static uint32_t g_ui32BusFrames;
+static uint32_t g_ui32BusBroadcasts;
+static uint32_t g_ui32BusStray;
+static uint32_t g_ui32BusRetries;
+static const char *g_pcBusError;
+
+//*****************************************************************************
+//
+// Sends and receives the whole of a message, giving up if the other end has
+// gone.
+//
+//*****************************************************************************
+static void
+SimBusSend(int iFd, const void *pvData, size_t sSize)
+{
+    const uint8_t *pui8Data;
+    ssize_t iDone;
+
+    pui8Data = pvData;
+    while(sSize)
+    {
+        iDone = write(iFd, pui8Data, sSize);
+        if(iDone <= 0)
+        {
+            perror("blsim: bus");
+            exit(1);
+        }
+        pui8Data += iDone;
+        sSize -= iDone;
+    }
+}
+
+static void
+SimBusRecv(int iFd, void *pvData, size_t sSize)
+{
+    uint8_t *pui8Data;
+    ssize_t iDone;
+
+    pui8Data = pvData;
+    while(sSize)
+    {
+        iDone = read(iFd, pui8Data, sSize);
+        if(iDone <= 0)
+        {
+            fprintf(stderr, "blsim: bus connection lost\n");
+            exit(1);
+        }
+        pui8Data += iDone;
+        sSize -= iDone;
+    }
+}
+
+//*****************************************************************************
+//
+// Adds an event to a list of them, which must have room for it.
+//
+//*****************************************************************************
+static void
+SimBusEventAdd(tSimBusEvent *psEvents, uint32_t *pui32Count,
+               uint64_t ui64Time, uint32_t ui32Kind, uint32_t ui32Data)
+{
+    if(*pui32Count == SIM_BUS_EVENTS)
+    {
+        fprintf(stderr, "blsim: too many bus events at once\n");
+        exit(1);
+    }
+    psEvents[*pui32Count].ui64Time = ui64Time;
+    psEvents[*pui32Count].ui32Kind = ui32Kind;
+    psEvents[*pui32Count].ui32Data = ui32Data;
+    (*pui32Count)++;
+}
+
+//*****************************************************************************
+//
+// Adds a byte that has reached this node to the data received by the UART
+// model, in order of the time that it arrives.  The room that bytes already
+// read leave at the start is reused, after dropping any that the receive
+// FIFO has had to overrun.
+//
+//*****************************************************************************
+static void
+SimBusReceive(const tSimBusEvent *psEvent)
+{
+    uint32_t ui32Idx;
+
+    if(g_ui32RxCount == SIM_RX_SIZE)
+    {
+        SimRxAvailable(SIM_UART_FIFO);
+        memmove(g_pui8RxData, g_pui8RxData + g_ui32RxHead,
+                g_ui32RxCount - g_ui32RxHead);
+        memmove(g_pui64RxTime, g_pui64RxTime + g_ui32RxHead,
+                (g_ui32RxCount - g_ui32RxHead) * sizeof(uint64_t));
+        g_ui32RxCount -= g_ui32RxHead;
+        g_ui32RxHead = 0;
+        if(g_ui32RxCount == SIM_RX_SIZE)
+        {
+            fprintf(stderr, "blsim: node 0x%02x receive data overflow\n",
+                    UART_NODE_ID);
+            exit(1);
+        }
+    }
+
+    for(ui32Idx = g_ui32RxCount;
+        (ui32Idx > g_ui32RxHead) &&
+        (g_pui64RxTime[ui32Idx - 1] > psEvent->ui64Time); ui32Idx--)
+    {
+        g_pui8RxData[ui32Idx] = g_pui8RxData[ui32Idx - 1];
+        g_pui64RxTime[ui32Idx] = g_pui64RxTime[ui32Idx - 1];
+    }
+    g_pui8RxData[ui32Idx] = psEvent->ui32Data;
+    g_pui64RxTime[ui32Idx] = psEvent->ui64Time;
+    g_ui32RxCount++;
+}
+
+//*****************************************************************************
+//
+// Reports to the bus what this node has sent and where it has got to, and,
+// unless it is done, waits to be allowed to run on, taking in whatever has
+// reached it.
+//
+//*****************************************************************************
+static void
+SimBusSync(uint32_t ui32State, uint64_t ui64Next)
+{
+    tSimBusReport sReport;
+    tSimBusGrant sGrant;
+    tSimBusEvent sEvent;
+
+    sReport.ui64Now = g_ui64Now;
+    sReport.ui64Next = ui64Next;
+    sReport.ui32State = ui32State;
+    sReport.ui32Events = g_ui32BusOut;
+    SimBusSend(g_iBusFd, &sReport, sizeof(sReport));
+    SimBusSend(g_iBusFd, g_psBusOut, g_ui32BusOut * sizeof(tSimBusEvent));
+    g_ui32BusOut = 0;
+    if(ui32State == SIM_BUS_DONE)
+    {
+        return;
+    }
+
+    SimBusRecv(g_iBusFd, &sGrant, sizeof(sGrant));
+    while(sGrant.ui32Events--)
+    {
+        SimBusRecv(g_iBusFd, &sEvent, sizeof(sEvent));
+        SimBusReceive(&sEvent);
+    }
+    g_ui64BusUntil = sGrant.ui64Until;
+}
+
+//*****************************************************************************
+//
+// Joins the bus, once the boot loader has configured its UART.
+//
+//*****************************************************************************
+void
+SimBusStart(void)
+{
+    tSimBusHello sHello;
+
+    sHello.ui32ID = UART_NODE_ID;
+    sHello.ui32SysClockHz = g_ui32SysClockHz;
+    sHello.ui32BaudRate = g_ui32BaudRate;
+    sHello.ui32Reserved = 0;
+    sHello.ui64ByteCycles = g_ui64ByteCycles;
+    SimBusSend(g_iBusFd, &sHello, sizeof(sHello));
+    SimBusSync(SIM_BUS_BUSY, 0);
+}
+
+//*****************************************************************************
+//
+// Called on each register access, to wait for the rest of the bus once this
+// node reaches the time up to which it may run.
+//
+//*****************************************************************************
+void
+SimBusUpdate(void)
+{
+    if(g_ui64Now >= g_ui64BusUntil)
+    {
+        SimBusSync(SIM_BUS_BUSY, 0);
+    }
+}
+
+//*****************************************************************************
+//
+// Called in place of advancing to the next event while the boot loader
+// waits.  The node runs on to the event if it may, or else waits for the
+// rest of the bus to catch up, with nothing to do until the event, if any.
+//
+//*****************************************************************************
+void
+SimBusWait(uint64_t ui64Next)
+{
+    if(ui64Next && (ui64Next < g_ui64BusUntil))
+    {
+        g_ui64Now = ui64Next;
+        return;
+    }
+    if(g_ui64Now < g_ui64BusUntil)
+    {
+        g_ui64Now = g_ui64BusUntil;
+    }
+    SimBusSync(SIM_BUS_IDLE, ui64Next);
+}
+
+//*****************************************************************************
+//
+// Records a byte sent by the UART model, which is on the line until the
+// given time, and a change of the RS-485 driver enable.
+//
+//*****************************************************************************
+void
+SimBusTx(uint8_t ui8Data, uint64_t ui64Done)
+{
+    SimBusEventAdd(g_psBusOut, &g_ui32BusOut, ui64Done, SIM_BUS_BYTE,
+                   ui8Data);
+}
+
+void
+SimBusDrive(bool bOn)
+{
+    SimBusEventAdd(g_psBusOut, &g_ui32BusOut, g_ui64Now,
+                   bOn ? SIM_BUS_DRIVE_ON : SIM_BUS_DRIVE_OFF, 0);
+}
+
+//*****************************************************************************
+//
+// Runs the boot loader as a node on the bus until the broadcast reset, then
+// reports whether it has the image.
+//
+//*****************************************************************************
+int
+SimBusNode(const uint8_t *pui8Image, uint32_t ui32Size)
+{
+    tSimBusResult sResult;
+
+    SimRun(true);
+
+    sResult.ui32Verify = (memcmp(g_pui8Flash + APP_START_ADDRESS, pui8Image,
+                                 ui32Size) != 0);
+    sResult.ui32Programs = g_ui32Programs;
+    sResult.ui32Overruns = g_ui32Overruns;
+    sResult.ui32CRCErrors = g_pui32Stats[STAT_CRC_ERRORS];
+    sResult.ui32Ignored = g_pui32Stats[STAT_RETRANSMITS];
+    SimBusSync(SIM_BUS_DONE, 0);
+    SimBusSend(g_iBusFd, &sResult, sizeof(sResult));
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Records a span of time for which the line was driven.
+//
+//*****************************************************************************
+static void
+SimBusSpan(uint64_t ui64Start, uint64_t ui64End, uint32_t ui32Source)
+{
+    if(!(g_ui32BusSpans % 1024))
+    {
+        g_psBusSpans = realloc(g_psBusSpans, (g_ui32BusSpans + 1024) *
+                               sizeof(tSimBusSpan));
+        if(!g_psBusSpans)
+        {
+            fprintf(stderr, "blsim: out of memory\n");
+            exit(1);
+        }
+    }
+    g_psBusSpans[g_ui32BusSpans].ui64Start = ui64Start;
+    g_psBusSpans[g_ui32BusSpans].ui64End = ui64End;
+    g_psBusSpans[g_ui32BusSpans].ui32Source = ui32Source;
+    g_ui32BusSpans++;
+}
+
+//*****************************************************************************
+//
+// Puts a byte on the line, from the host or from one of the nodes, for all
+// the others to receive.
+//
+//*****************************************************************************
+static void
+SimBusDeliver(uint32_t ui32Source, uint64_t ui64Time, uint8_t ui8Data)
+{
+    tSimBusEvent *psRx, sSwap;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < g_ui32BusNumNodes; ui32Idx++)
+    {
+        if((ui32Idx != ui32Source) &&
+           (g_psBusNode[ui32Idx].ui32State != SIM_BUS_DONE))
+        {
+            SimBusEventAdd(g_psBusNode[ui32Idx].psIn,
+                           &g_psBusNode[ui32Idx].ui32In, ui64Time,
+                           SIM_BUS_BYTE, ui8Data);
+        }
+    }
+    if(ui32Source == SIM_BUS_NODES)
+    {
+        return;
+    }
+
+    //
+    // The host receives the bytes of the nodes in the order that they end.
+    //
+    if(g_ui32BusRxHead == g_ui32BusRxCount)
+    {
+        g_ui32BusRxHead = g_ui32BusRxCount = 0;
+    }
+    SimBusEventAdd(g_psBusRx, &g_ui32BusRxCount, ui64Time, SIM_BUS_BYTE,
+                   ui8Data);
+    for(psRx = &g_psBusRx[g_ui32BusRxCount - 1];
+        (psRx > &g_psBusRx[g_ui32BusRxHead]) &&
+        (psRx[-1].ui64Time > psRx->ui64Time); psRx--)
+    {
+        sSwap = psRx[-1];
+        psRx[-1] = *psRx;
+        *psRx = sSwap;
+    }
+}
+
+//*****************************************************************************
+//
+// Takes in the reports of every node still running, checking that each byte
+// that a node sent was sent, start to end, while its driver was enabled.
+//
+//*****************************************************************************
+static void
+SimBusCollect(void)
+{
+    tSimBusReport sReport;
+    tSimBusEvent sEvent;
+    tSimBusNode *psNode;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < g_ui32BusNumNodes; ui32Idx++)
+    {
+        psNode = &g_psBusNode[ui32Idx];
+        if(psNode->ui32State == SIM_BUS_DONE)
+        {
+            continue;
+        }
+        SimBusRecv(psNode->iFd, &sReport, sizeof(sReport));
+        psNode->ui64Now = sReport.ui64Now;
+        psNode->ui64Next = sReport.ui64Next ? sReport.ui64Next :
+                                              SIM_BUS_NEVER;
+        while(sReport.ui32Events--)
+        {
+            SimBusRecv(psNode->iFd, &sEvent, sizeof(sEvent));
+            if(sEvent.ui32Kind == SIM_BUS_BYTE)
+            {
+                SimBusDeliver(ui32Idx, sEvent.ui64Time, sEvent.ui32Data);
+                g_ui32BusUndriven += (!psNode->bDriving ||
+                                      ((sEvent.ui64Time - g_ui64ByteCycles) <
+                                       psNode->ui64DriveStart));
+                psNode->ui64LastByte = sEvent.ui64Time;
+            }
+            else if(sEvent.ui32Kind == SIM_BUS_DRIVE_ON)
+            {
+                psNode->bDriving = true;
+                psNode->ui64DriveStart = sEvent.ui64Time;
+            }
+            else if(psNode->bDriving)
+            {
+                psNode->bDriving = false;
+                g_ui32BusUndriven += (psNode->ui64LastByte > sEvent.ui64Time);
+                SimBusSpan(psNode->ui64DriveStart, sEvent.ui64Time, ui32Idx);
+            }
+        }
+        psNode->ui32State = sReport.ui32State;
+        if(psNode->ui32State == SIM_BUS_DONE)
+        {
+            SimBusRecv(psNode->iFd, &psNode->sResult,
+                       sizeof(psNode->sResult));
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the earliest time at which anything on the bus could next send,
+// or SIM_BUS_NEVER if nothing is waiting to happen.
+//
+//*****************************************************************************
+static uint64_t
+SimBusEarliest(void)
+{
+    tSimBusNode *psNode;
+    uint32_t ui32Idx, ui32Event;
+    uint64_t ui64Earliest;
+
+    ui64Earliest = g_ui64BusSendAt;
+    if(g_ui64BusDeadline < ui64Earliest)
+    {
+        ui64Earliest = g_ui64BusDeadline;
+    }
+    if((g_ui32BusRxHead < g_ui32BusRxCount) &&
+       (g_psBusRx[g_ui32BusRxHead].ui64Time < ui64Earliest))
+    {
+        ui64Earliest = g_psBusRx[g_ui32BusRxHead].ui64Time;
+    }
+    for(ui32Idx = 0; ui32Idx < g_ui32BusNumNodes; ui32Idx++)
+    {
+        psNode = &g_psBusNode[ui32Idx];
+        if(psNode->ui32State == SIM_BUS_DONE)
+        {
+            continue;
+        }
+        if(psNode->ui32State == SIM_BUS_BUSY)
+        {
+            if(psNode->ui64Now < ui64Earliest)
+            {
+                ui64Earliest = psNode->ui64Now;
+            }
+            continue;
+        }
+        if(psNode->ui64Next < ui64Earliest)
+        {
+            ui64Earliest = psNode->ui64Next;
+        }
+        for(ui32Event = 0; ui32Event < psNode->ui32In; ui32Event++)
+        {
+            if(psNode->psIn[ui32Event].ui64Time < ui64Earliest)
+            {
+                ui64Earliest = psNode->psIn[ui32Event].ui64Time;
+            }
+        }
+    }
+
+    return(ui64Earliest);
+}
+
+//*****************************************************************************
+//
+// Lets every node still running run up to the given time, handing it the
+// bytes that have reached it.
+//
+//*****************************************************************************
+static void
+SimBusGrant(uint64_t ui64Until)
+{
+    tSimBusGrant sGrant;
+    tSimBusNode *psNode;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < g_ui32BusNumNodes; ui32Idx++)
+    {
+        psNode = &g_psBusNode[ui32Idx];
+        if(psNode->ui32State == SIM_BUS_DONE)
+        {
+            continue;
+        }
+        sGrant.ui64Until = ui64Until;
+        sGrant.ui32Events = psNode->ui32In;
+        sGrant.ui32Reserved = 0;
+        SimBusSend(psNode->iFd, &sGrant, sizeof(sGrant));
+        SimBusSend(psNode->iFd, psNode->psIn,
+                   psNode->ui32In * sizeof(tSimBusEvent));
+        psNode->ui32In = 0;
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the index of the first frame of the update that writes the given
+// register.
+//
+//*****************************************************************************
+static uint32_t
+SimBusFrameFind(uint16_t ui16Address)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < g_ui32NumFrames; ui32Idx++)
+    {
+        if((((g_psFrames[ui32Idx].pui8Data[2] << 8) |
+             g_psFrames[ui32Idx].pui8Data[3]) == ui16Address))
+        {
+            return(ui32Idx);
+        }
+    }
+
+    fprintf(stderr, "blsim: the update has no 0x%04x frame for the bus\n",
+            ui16Address);
+    exit(1);
+}
+
+//*****************************************************************************
+//
+// Makes a frame of the update the next one that the host sends, addressed to
+// the given node or broadcast.
+//
+//*****************************************************************************
+static void
+SimBusFrame(const tSimFrame *psFrame, uint32_t ui32Node)
+{
+    uint32_t ui32CRC;
+
+    g_sBusFrame = *psFrame;
+    g_bBusBroadcast = (ui32Node == SIM_BUS_NODES);
+    g_sBusFrame.pui8Data[0] = g_bBusBroadcast ?
+                              UART_BROADCAST_ID : g_psBusNode[ui32Node].ui32ID;
+    ui32CRC = SimCRC16(g_sBusFrame.pui8Data, 4 + g_sBusFrame.ui32Payload);
+    g_sBusFrame.pui8Data[4 + g_sBusFrame.ui32Payload] = ui32CRC >> 8;
+    g_sBusFrame.pui8Data[5 + g_sBusFrame.ui32Payload] = ui32CRC & 0xff;
+}
+
+//*****************************************************************************
+//
+// Moves the host model on to the given step of the update.
+//
+//*****************************************************************************
+static void
+SimBusStep(uint32_t ui32Step, uint32_t ui32Node, uint32_t ui32Block)
+{
+    tSimFrame sPoll;
+    uint8_t pui8Payload[2];
+
+    g_ui32BusStep = ui32Step;
+    g_ui32BusNode = ui32Node;
+    g_ui32BusBlock = ui32Block;
+    g_ui32BusTries = 0;
+    switch(ui32Step)
+    {
+        case SIM_BUS_PING:
+        {
+            SimBusFrame(&g_psFrames[g_ui32BusPing], ui32Node);
+            break;
+        }
+
+        case SIM_BUS_DOWNLOAD:
+        {
+            SimBusFrame(&g_psFrames[g_ui32BusDownload], SIM_BUS_NODES);
+            break;
+        }
+
+        case SIM_BUS_POLL:
+        {
+            pui8Payload[0] = 0x00;
+            pui8Payload[1] = 0x01;
+            SimFrameBuild(&sPoll, 0x03, 0x6005, pui8Payload, 2, 9,
+                          PHASE_PROGRAM);
+            SimBusFrame(&sPoll, ui32Node);
+            break;
+        }
+
+        case SIM_BUS_BLOCK:
+        {
+            SimBusFrame(&g_psFrames[g_ui32BusData + ui32Block],
+                        SIM_BUS_NODES);
+            break;
+        }
+
+        case SIM_BUS_RESEND:
+        {
+            SimBusFrame(&g_psFrames[g_ui32BusData + ui32Block], ui32Node);
+            g_psBusNode[ui32Node].ui32Resent++;
+            break;
+        }
+
+        case SIM_BUS_RESET:
+        {
+            SimBusFrame(&g_psFrames[g_ui32NumFrames - 1], SIM_BUS_NODES);
+            break;
+        }
+
+        default:
+        {
+            g_ui64BusSendAt = SIM_BUS_NEVER;
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Ends the update with an error.
+//
+//*****************************************************************************
+static void
+SimBusFail(const char *pcError)
+{
+    g_pcBusError = pcError;
+    SimBusStep(SIM_BUS_END, 0, 0);
+}
+
+//*****************************************************************************
+//
+// Moves on from the poll of a node, or from a block resent to it, once all
+// of the blocks sent so far have reached it: to the next node, the next
+// group of blocks or, after the last, to the reset.
+//
+//*****************************************************************************
+static void
+SimBusPollNext(void)
+{
+    if((g_ui32BusNode + 1) < g_ui32BusNumNodes)
+    {
+        SimBusStep(SIM_BUS_POLL, g_ui32BusNode + 1, 0);
+    }
+    else if(g_ui32BusGroupEnd < g_ui32BusBlocks)
+    {
+        SimBusStep(SIM_BUS_BLOCK, SIM_BUS_NODES, g_ui32BusGroupEnd);
+        g_ui32BusGroupEnd += g_ui32BusGroup;
+        if(g_ui32BusGroupEnd > g_ui32BusBlocks)
+        {
+            g_ui32BusGroupEnd = g_ui32BusBlocks;
+        }
+    }
+    else
+    {
+        SimBusStep(SIM_BUS_RESET, SIM_BUS_NODES, 0);
+    }
+}
+
+//*****************************************************************************
+//
+// Sends the host model's frame, to every node if it is broadcast, and either
+// moves on to the next step or waits for the reply.  The first broadcast of
+// the block that -x names is corrupted on its way to the last node.
+//
+//*****************************************************************************
+static void
+SimBusHostSend(uint64_t ui64Start)
+{
+    uint32_t ui32Idx, ui32Node;
+    uint64_t ui64End;
+    uint8_t ui8Data;
+
+    for(ui32Idx = 0; ui32Idx < g_sBusFrame.ui32Size; ui32Idx++)
+    {
+        SimBusDeliver(SIM_BUS_NODES, ui64Start + ((ui32Idx + 1) *
+                                                  g_ui64ByteCycles),
+                      g_sBusFrame.pui8Data[ui32Idx]);
+    }
+    ui64End = ui64Start + (g_sBusFrame.ui32Size * g_ui64ByteCycles);
+    ui32Node = g_ui32BusNumNodes - 1;
+    if((g_ui32BusStep == SIM_BUS_BLOCK) && (g_ui32BusBlock == g_ui32BusMiss) &&
+       (g_psBusNode[ui32Node].ui32In >= g_sBusFrame.ui32Size))
+    {
+        ui8Data = g_sBusFrame.pui8Data[14] ^ 0x5a;
+        g_psBusNode[ui32Node].psIn[g_psBusNode[ui32Node].ui32In -
+                                   g_sBusFrame.ui32Size + 14].ui32Data =
+            ui8Data;
+        g_psBusNode[ui32Node].ui32Polled = 0xfffffffe;
+    }
+    SimBusSpan(ui64Start, ui64End, SIM_BUS_NODES);
+    g_ui32BusFrames++;
+
+    if(!g_bBusBroadcast)
+    {
+        g_ui64BusSendAt = SIM_BUS_NEVER;
+        g_ui64BusListen = ui64End;
+        g_ui64BusDeadline = (ui64End + g_ui64HostTimeout +
+                             (g_sBusFrame.ui32ReplySize * g_ui64ByteCycles));
+        g_ui32BusReplyBytes = 0;
+        return;
+    }
+
+    //
+    // Nothing replies to a broadcast.  Each block is given the time to be
+    // programmed before the next is sent.
+    //
+    g_ui32BusBroadcasts++;
+    g_ui64BusSendAt = ui64End + g_ui64Turnaround + g_ui64ByteCycles;
+    switch(g_ui32BusStep)
+    {
+        case SIM_BUS_DOWNLOAD:
+        {
+            g_ui32BusGroupEnd = 0;
+            SimBusStep(SIM_BUS_POLL, 0, 0);
+            break;
+        }
+
+        case SIM_BUS_BLOCK:
+        {
+            g_ui64BusSendAt += g_ui64BusGap;
+            if((g_ui32BusBlock + 1) < g_ui32BusGroupEnd)
+            {
+                SimBusStep(SIM_BUS_BLOCK, SIM_BUS_NODES, g_ui32BusBlock + 1);
+            }
+            else
+            {
+                SimBusStep(SIM_BUS_POLL, 0, 0);
+            }
+            break;
+        }
+
+        default:
+        {
+            SimBusStep(SIM_BUS_END, 0, 0);
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Acts on a complete reply from the node that the host model addressed.
+//
+//*****************************************************************************
+static void
+SimBusHostReply(uint64_t ui64Time)
+{
+    tSimBusNode *psNode;
+    uint32_t ui32Next;
+
+    psNode = &g_psBusNode[g_ui32BusNode];
+    g_ui64BusDeadline = SIM_BUS_NEVER;
+    g_ui64BusSendAt = ui64Time + g_ui64Turnaround + g_ui64ByteCycles;
+    if(g_pui8BusReply[0] != psNode->ui32ID)
+    {
+        SimBusFail("a reply came from the wrong node");
+        return;
+    }
+    if(!SimReplyIntact(g_pui8BusReply, g_sBusFrame.ui32ReplySize))
+    {
+        SimBusFail("a reply had a bad CRC16");
+        return;
+    }
+
+    if(g_ui32BusStep == SIM_BUS_PING)
+    {
+        if((g_ui32BusNode + 1) < g_ui32BusNumNodes)
+        {
+            SimBusStep(SIM_BUS_PING, g_ui32BusNode + 1, 0);
+        }
+        else
+        {
+            SimBusStep(SIM_BUS_DOWNLOAD, SIM_BUS_NODES, 0);
+        }
+        return;
+    }
+
+    //
+    // The reply to a poll, or to a resent block, is the node's progress.
+    //
+    if((g_pui8BusReply[1] != 0x03) || (g_pui8BusReply[2] != 0x04) ||
+       (g_pui8BusReply[4] != COMMAND_RET_SUCCESS))
+    {
+        SimBusFail("a node reported a failure");
+        return;
+    }
+    ui32Next = (g_pui8BusReply[5] << 8) | g_pui8BusReply[6];
+    if((g_ui32BusStep == SIM_BUS_POLL) && (psNode->ui32Polled == 0xfffffffe))
+    {
+        psNode->ui32Polled = ui32Next;
+    }
+    if(ui32Next >= g_ui32BusGroupEnd)
+    {
+        SimBusPollNext();
+    }
+    else if((g_ui32BusStep == SIM_BUS_RESEND) &&
+            (ui32Next <= g_ui32BusBlock))
+    {
+        SimBusFail("a node did not take a resent block");
+    }
+    else
+    {
+        SimBusStep(SIM_BUS_RESEND, g_ui32BusNode, ui32Next);
+    }
+}
+
+//*****************************************************************************
+//
+// Runs the host model up to the given time.
+//
+//*****************************************************************************
+static void
+SimBusHost(uint64_t ui64Until)
+{
+    uint64_t ui64Rx;
+
+    while(1)
+    {
+        ui64Rx = SIM_BUS_NEVER;
+        if(g_ui32BusRxHead < g_ui32BusRxCount)
+        {
+            ui64Rx = g_psBusRx[g_ui32BusRxHead].ui64Time;
+        }
+
+        if((ui64Rx < ui64Until) && (ui64Rx <= g_ui64BusSendAt) &&
+           (ui64Rx <= g_ui64BusDeadline))
+        {
+            //
+            // A byte from a node, which is only expected as part of a reply
+            // to the frame just sent.
+            //
+            if((g_ui64BusDeadline != SIM_BUS_NEVER) &&
+               (ui64Rx > g_ui64BusListen))
+            {
+                g_pui8BusReply[g_ui32BusReplyBytes++] =
+                    g_psBusRx[g_ui32BusRxHead].ui32Data;
+                if(g_ui32BusReplyBytes == g_sBusFrame.ui32ReplySize)
+                {
+                    SimBusHostReply(ui64Rx);
+                }
+            }
+            else
+            {
+                g_ui32BusStray++;
+            }
+            g_ui32BusRxHead++;
+        }
+        else if((g_ui64BusSendAt < ui64Until) &&
+                (g_ui64BusSendAt <= g_ui64BusDeadline))
+        {
+            SimBusHostSend(g_ui64BusSendAt);
+        }
+        else if(g_ui64BusDeadline < ui64Until)
+        {
+            //
+            // No reply came, so send the frame again.
+            //
+            g_ui32BusRetries++;
+            g_ui64BusSendAt = g_ui64BusDeadline;
+            g_ui64BusDeadline = SIM_BUS_NEVER;
+            if(++g_ui32BusTries > SIM_MAX_RETRIES)
+            {
+                SimBusFail("a node stopped replying");
+            }
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Starts a node on the bus: this simulator, forked, for the first, and each
+// -N simulator, run with -Z and the same options, for the rest.
+//
+//*****************************************************************************
+static void
+SimBusStartNode(uint32_t ui32Node, int iArgc, char *ppcArgv[],
+                const uint8_t *pui8Image, uint32_t ui32Size)
+{
+    char pcFd[16], **ppcArgs;
+    int piFds[2], iArg;
+    uint32_t ui32Idx;
+
+    if(socketpair(AF_UNIX, SOCK_STREAM, 0, piFds) != 0)
+    {
+        perror("blsim: socketpair");
+        exit(1);
+    }
+    fflush(stdout);
+    g_psBusNode[ui32Node].iPid = fork();
+    if(g_psBusNode[ui32Node].iPid < 0)
+    {
+        perror("blsim: fork");
+        exit(1);
+    }
+    if(g_psBusNode[ui32Node].iPid)
+    {
+        close(piFds[1]);
+        g_psBusNode[ui32Node].iFd = piFds[0];
+        return;
+    }
+
+    //
+    // The node keeps only its own end of its own connection.
+    //
+    close(piFds[0]);
+    for(ui32Idx = 0; ui32Idx < ui32Node; ui32Idx++)
+    {
+        close(g_psBusNode[ui32Idx].iFd);
+    }
+    if(!ui32Node)
+    {
+        g_iBusFd = piFds[1];
+        exit(SimBusNode(pui8Image, ui32Size));
+    }
+
+    ppcArgs = malloc((iArgc + 3) * sizeof(char *));
+    if(!ppcArgs)
+    {
+        fprintf(stderr, "blsim: out of memory\n");
+        exit(1);
+    }
+    snprintf(pcFd, sizeof(pcFd), "%d", piFds[1]);
+    ppcArgs[0] = (char *)g_ppcBusNodes[ui32Node - 1];
+    ppcArgs[1] = "-Z";
+    ppcArgs[2] = pcFd;
+    for(iArg = 1; iArg <= iArgc; iArg++)
+    {
+        ppcArgs[iArg + 2] = ppcArgv[iArg];
+    }
+    execv(ppcArgs[0], ppcArgs);
+    perror(ppcArgs[0]);
+    exit(1);
+}
+
+//*****************************************************************************
+//
+// Returns the number of times that two of the host and the nodes drove the
+// line at once.
+//
+//*****************************************************************************
+static uint32_t
+SimBusCollisions(void)
+{
+    tSimBusSpan *psA, *psB;
+    uint32_t ui32Collisions;
+
+    ui32Collisions = 0;
+    for(psA = g_psBusSpans; psA < &g_psBusSpans[g_ui32BusSpans]; psA++)
+    {
+        for(psB = psA + 1; psB < &g_psBusSpans[g_ui32BusSpans]; psB++)
+        {
+            if((psA->ui32Source != psB->ui32Source) &&
+               (psA->ui64Start < psB->ui64End) &&
+               (psB->ui64Start < psA->ui64End))
+            {
+                ui32Collisions++;
+            }
+        }
+    }
+
+    return(ui32Collisions);
+}
+
+//*****************************************************************************
+//
+// Runs the update of every node on the bus and reports the results.
+// Returns non-zero if any of the checks fails.
+//
+//*****************************************************************************
+int
+SimBusRun(int iArgc, char *ppcArgv[], const uint8_t *pui8Image,
+          uint32_t ui32Size)
+{
+    tSimBusHello sHello;
+    tSimBusNode *psNode;
+    uint32_t ui32Idx, ui32Node, ui32Collisions, ui32Fails;
+    uint64_t ui64Until, ui64Earliest;
+    int iStatus;
+
+    //
+    // Start the nodes and take the timing of the line from the first.
+    //
+    g_ui32BusNumNodes = g_ui32BusNodes + 1;
+    for(ui32Idx = 0; ui32Idx < g_ui32BusNumNodes; ui32Idx++)
+    {
+        SimBusStartNode(ui32Idx, iArgc, ppcArgv, pui8Image, ui32Size);
+    }
+    for(ui32Idx = 0; ui32Idx < g_ui32BusNumNodes; ui32Idx++)
+    {
+        psNode = &g_psBusNode[ui32Idx];
+        SimBusRecv(psNode->iFd, &sHello, sizeof(sHello));
+        psNode->ui32ID = sHello.ui32ID;
+        psNode->ui32Polled = 0xffffffff;
+        if(!ui32Idx)
+        {
+            g_ui32SysClockHz = sHello.ui32SysClockHz;
+            g_ui32BaudRate = sHello.ui32BaudRate;
+            g_ui64ByteCycles = sHello.ui64ByteCycles;
+        }
+        for(ui32Node = 0; ui32Node < ui32Idx; ui32Node++)
+        {
+            if(g_psBusNode[ui32Node].ui32ID == psNode->ui32ID)
+            {
+                break;
+            }
+        }
+        if((sHello.ui32SysClockHz != g_ui32SysClockHz) ||
+           (sHello.ui64ByteCycles != g_ui64ByteCycles) ||
+           (ui32Node != ui32Idx))
+        {
+            fprintf(stderr, "blsim: node %u needs its own ID and the same "
+                    "clock and baud rate as the first\n", ui32Idx + 1);
+            exit(1);
+        }
+    }
+    SimTimingSet();
+
+    //
+    // Frame the update, find the frames that the host model sends, and start
+    // with the ping of the first node.
+    //
+    SimFramesBuild(pui8Image, ui32Size);
+    g_ui32BusPing = SimBusFrameFind(0x6001);
+    g_ui32BusDownload = SimBusFrameFind(0x6003);
+    g_ui32BusData = SimBusFrameFind(0x6007);
+    g_ui32BusBlocks = (ui32Size + 127) / 128;
+    if((g_ui32BusMiss != 0xffffffff) && (g_ui32BusMiss >= g_ui32BusBlocks))
+    {
+        fprintf(stderr, "blsim: -x needs a block of the image\n");
+        exit(1);
+    }
+    g_ui64BusGap = 32 * g_ui64ProgramCycles;
+    g_ui64BusDeadline = SIM_BUS_NEVER;
+    g_ui64BusSendAt = 0;
+    SimBusStep(SIM_BUS_PING, 0, 0);
+
+    //
+    // Run the nodes in lockstep.  Nothing that any of them sends can reach
+    // another before a character time after the earliest time at which any
+    // of them, or the host, could next send, so each may run until then.
+    //
+    ui64Until = 0;
+    SimBusCollect();
+    while(g_ui32BusStep != SIM_BUS_END)
+    {
+        ui64Earliest = SimBusEarliest();
+        if(ui64Earliest == SIM_BUS_NEVER)
+        {
+            SimBusFail("the bus stalled");
+            break;
+        }
+        ui64Until = ((ui64Earliest > ui64Until) ? ui64Earliest : ui64Until) +
+                    g_ui64ByteCycles;
+        SimBusHost(ui64Until);
+        SimBusGrant(ui64Until);
+        SimBusCollect();
+    }
+
+    //
+    // Once the reset has been broadcast, let the nodes run until they have
+    // all reset.
+    //
+    while(!g_pcBusError)
+    {
+        for(ui32Idx = 0; ui32Idx < g_ui32BusNumNodes; ui32Idx++)
+        {
+            if(g_psBusNode[ui32Idx].ui32State != SIM_BUS_DONE)
+            {
+                break;
+            }
+        }
+        if(ui32Idx == g_ui32BusNumNodes)
+        {
+            break;
+        }
+        ui64Earliest = SimBusEarliest();
+        if(ui64Earliest == SIM_BUS_NEVER)
+        {
+            g_pcBusError = "a node did not reset";
+            break;
+        }
+        ui64Until = ((ui64Earliest > ui64Until) ? ui64Earliest : ui64Until) +
+                    g_ui64ByteCycles;
+        SimBusGrant(ui64Until);
+        SimBusCollect();
+    }
+    for(ui32Idx = 0; ui32Idx < g_ui32BusNumNodes; ui32Idx++)
+    {
+        if(g_psBusNode[ui32Idx].ui32State != SIM_BUS_DONE)
+        {
+            kill(g_psBusNode[ui32Idx].iPid, SIGKILL);
+        }
+        waitpid(g_psBusNode[ui32Idx].iPid, &iStatus, 0);
+        close(g_psBusNode[ui32Idx].iFd);
+    }
+
+    //
+    // Report the results.
+    //
+    ui32Collisions = SimBusCollisions();
+    ui32Fails = (g_pcBusError || g_ui32BusUndriven || ui32Collisions ||
+                 g_ui32BusStray || g_ui32BusRetries);
+    printf("image:     %u bytes at 0x%08x\n", ui32Size, APP_START_ADDRESS);
+    printf("link:      %u baud, %u Hz system clock, %u nodes\n",
+           g_ui32BaudRate, g_ui32SysClockHz, g_ui32BusNumNodes);
+    printf("bus:       %u frames from the host, %u of them broadcast, in "
+           "%.3f ms\n", g_ui32BusFrames, g_ui32BusBroadcasts,
+           CyclesToSeconds(ui64Until) * 1000.0);
+    printf("bus:       %u collisions, %u bytes sent undriven, %u stray "
+           "bytes, %u retries\n", ui32Collisions, g_ui32BusUndriven,
+           g_ui32BusStray, g_ui32BusRetries);
+    if(g_pcBusError)
+    {
+        printf("bus:       %s\n", g_pcBusError);
+    }
+    for(ui32Idx = 0; ui32Idx < g_ui32BusNumNodes; ui32Idx++)
+    {
+        psNode = &g_psBusNode[ui32Idx];
+        printf("node 0x%02x: %u words programmed, %u overruns, %u CRC "
+               "errors, %u blocks ignored, %u resent", psNode->ui32ID,
+               psNode->sResult.ui32Programs, psNode->sResult.ui32Overruns,
+               psNode->sResult.ui32CRCErrors, psNode->sResult.ui32Ignored,
+               psNode->ui32Resent);
+        if(psNode->ui32Polled < 0xfffffffe)
+        {
+            printf(" from block %u", psNode->ui32Polled);
+        }
+        printf(", verify %s\n",
+               ((psNode->ui32State != SIM_BUS_DONE) ||
+                psNode->sResult.ui32Verify) ? "FAILED" : "ok");
+        ui32Fails |= ((psNode->ui32State != SIM_BUS_DONE) ||
+                      psNode->sResult.ui32Verify ||
+                      psNode->sResult.ui32Overruns);
+
+        //
+        // Only the node that missed a block, if any, needs any resent, and
+        // then from that block.
+        //
+        if(psNode->ui32Polled == 0xffffffff)
+        {
+            ui32Fails |= (psNode->ui32Resent || psNode->sResult.ui32CRCErrors);
+        }
+        else
+        {
+            ui32Fails |= (!psNode->ui32Resent ||
+                          (psNode->ui32Polled != g_ui32BusMiss) ||
+                          (psNode->sResult.ui32CRCErrors != 1));
+        }
+    }
+    printf("check:     %s\n", ui32Fails ? "FAILED" : "ok");
+
+    return(ui32Fails ? 1 : 0);
+}
+#endif
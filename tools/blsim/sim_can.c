@@ -0,0 +1,1606 @@
+//*****************************************************************************
+//
+// sim_can.c - Models of the CAN controller and of a CAN bus.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DCAN_ENABLE_UPDATE the simulator runs the boot loader's ConfigureCAN()
+// and UpdaterCAN() on a model of a CAN bus, in place of Updater() and the
+// UART.  The CAN controller model keeps the 32 message objects and the two
+// interface register sets through which the driverlib functions write and
+// read them.  It stores each frame on the bus in the first receive object
+// whose identifier and mask the frame matches, moving on through a FIFO of
+// objects past those that still hold unread data and overwriting the last of
+// them once all are full, and it sends the frame of the lowest numbered
+// object with a transmit request.  Its bit time is the one that the boot
+// loader programs into the bit timing registers, and each frame takes as
+// many bits as its identifier, data, CRC and stuff bits add up to.
+//
+// The bus carries one frame at a time.  When several senders have a frame
+// ready as the bus goes idle, the one with the lowest identifier goes first,
+// as arbitration does.  The boot loader is the first node on the bus, and -n
+// gives the number of nodes in all.  The others have the addresses after
+// CAN_NODE_ID and are modelled here as far as the protocol in bl_can.h goes,
+// taking the time that the flash model would to erase and to program each
+// block.  -x makes each node lose every <n>th data frame on the bus, each
+// node a different one of them, as a node whose receive FIFO overflows
+// would.
+//
+// The host model updates all of the nodes at once.  It pings them, starts
+// the download on all of them, and broadcasts each block once, followed by
+// a poll of each node for the bitmap of the frames that it holds.  Until no
+// node is missing any, it rebroadcasts the frames that any node is missing
+// and polls those nodes again.  It then tells all of them to run the image.
+//
+// The update is run twice, first with the boot loader alone on the bus and
+// then with all of the nodes.  The check fails if the boot loader's flash
+// does not hold the image after either run, if any node failed, if the boot
+// loader reported a bitmap other than that of the frames that reached it, if
+// a reply came that the host had not asked for, if the receive FIFO
+// overflowed, if more frames were rebroadcast than were lost, or if the
+// update of all of the nodes took more than one and a half times as long as
+// the update of one.
+//
+//*****************************************************************************
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "inc/hw_can.h"
+#include "inc/hw_memmap.h"
+#include "blsim.h"
+
+#ifdef CAN_ENABLE_UPDATE
+#include "boot_loader/bl_can.h"
+#include "boot_loader/bl_flash.h"
+
+//*****************************************************************************
+//
+// The register of an interface register set, given the offset of the set
+// from the first one.
+//
+//*****************************************************************************
+#define SIM_CAN_IF2             (CAN_O_IF2CRQ - CAN_O_IF1CRQ)
+#define SIM_CAN_IF(ui32IF, ui32Reg)                                           \
+                                SimRegFind(CAN0_BASE + (ui32IF) +             \
+                                           (ui32Reg))->ui32Value
+
+//*****************************************************************************
+//
+// The sender of a frame that is not one of the nodes, the most frames that
+// the host model queues at once, and the bits of a frame that follow its
+// CRC: the CRC delimiter, the acknowledge slot and delimiter, the end of
+// frame and the intermission.
+//
+//*****************************************************************************
+#define SIM_CAN_HOST            SIM_CAN_NODES
+#define SIM_CAN_QUEUE           (1 + CAN_BLOCK_FRAMES + SIM_CAN_NODES)
+#define SIM_CAN_TAIL_BITS       13
+
+//*****************************************************************************
+//
+// What the host model is waiting for: the replies to the ping, to the start
+// of the download, to the polls of the current block and to the command to
+// run the image, or nothing once the update is over.
+//
+//*****************************************************************************
+#define SIM_CAN_PING            0
+#define SIM_CAN_DOWNLOAD        1
+#define SIM_CAN_BLOCK           2
+#define SIM_CAN_RUN             3
+#define SIM_CAN_DONE            4
+
+//*****************************************************************************
+//
+// A frame on the bus, and the earliest time that its sender could start it.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32ID;
+    uint32_t ui32Size;
+    uint8_t pui8Data[8];
+    uint64_t ui64Ready;
+}
+tSimCANFrame;
+
+//*****************************************************************************
+//
+// A message object of the CAN controller, as the interface registers write
+// and read it, and the time that its transmit request was set.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Mask1;
+    uint32_t ui32Mask2;
+    uint32_t ui32Arb1;
+    uint32_t ui32Arb2;
+    uint32_t ui32Ctl;
+    uint32_t pui32Data[4];
+    uint64_t ui64TxTime;
+}
+tSimCANObj;
+
+//*****************************************************************************
+//
+// A node on the bus.  Node 0 is the boot loader, and the others are modelled
+// here: the state of the download, the block being received, the time until
+// which the node is erasing or programming, and the reply that it has yet to
+// send.  The rest is what the host model knows of each node: whether it is
+// waiting for a reply from it, the frames of the block that it last reported
+// missing, and the number of data frames that the node lost.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32ID;
+    uint32_t ui32Status;
+    bool bDownloading;
+    bool bActive;
+    bool bRun;
+    uint32_t ui32Size;
+    uint32_t ui32NextBlock;
+    uint32_t ui32Programmed;
+    uint64_t ui64Bitmap;
+    uint64_t ui64Complete;
+    uint64_t ui64BusyUntil;
+    bool bReply;
+    tSimCANFrame sReply;
+    bool bAwait;
+    uint64_t ui64Missing;
+    uint32_t ui32Lost;
+}
+tSimCANNode;
+
+//*****************************************************************************
+//
+// The results of one run of the update.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Nodes;
+    uint64_t ui64Cycles;
+    uint64_t ui64Busy;
+    uint32_t ui32Frames;
+    uint32_t ui32Data;
+    uint32_t ui32Resent;
+    uint32_t ui32Polls;
+    uint32_t ui32Lost;
+    bool bVerify;
+}
+tSimCANPass;
+
+//*****************************************************************************
+//
+// The number of nodes on the bus and the data frame loss given by -n and -x.
+//
+//*****************************************************************************
+uint32_t g_ui32CANNodes = 1;
+uint32_t g_ui32CANLoseEvery;
+
+//*****************************************************************************
+//
+// The CAN controller model: the message objects, whether the controller is
+// held in its init state (as it is until the boot loader enables it and once
+// the boot loader has reset), the time of one bit, and the frames that
+// overwrote unread ones.
+//
+//*****************************************************************************
+static tSimCANObj g_psCANObjs[32];
+static bool g_bCANInit = true;
+static uint64_t g_ui64CANBitCycles;
+static uint32_t g_ui32CANOverflows;
+
+//*****************************************************************************
+//
+// The bus model: the frame on the bus, its sender, the time that the bus
+// goes idle, the boot loader's frame while it is a candidate for the bus,
+// and the counts of the frames and of the time that the bus was busy.
+//
+//*****************************************************************************
+static bool g_bCANOnBus;
+static tSimCANFrame g_sCANFrame;
+static uint32_t g_ui32CANSender;
+static uint32_t g_ui32CANTxObj;
+static uint64_t g_ui64CANBusFree;
+static tSimCANFrame g_sCANTx;
+static uint64_t g_ui64CANBusy;
+static uint32_t g_ui32CANFrames;
+static uint32_t g_ui32CANDataFrames;
+
+//*****************************************************************************
+//
+// The nodes on the bus, and the frames of the current block that have
+// reached the boot loader's controller, which its bitmap must match.
+//
+//*****************************************************************************
+static tSimCANNode g_psCANNodes[SIM_CAN_NODES];
+static uint32_t g_ui32CANActive;
+static uint64_t g_ui64CANDelivered;
+
+//*****************************************************************************
+//
+// The host model: the image, what it is waiting for, the block that it is
+// sending, its frames still to be sent, the time by which the replies that
+// it waits for must come, and the counts of what it sent and of what came
+// back wrong.
+//
+//*****************************************************************************
+static const uint8_t *g_pui8CANImage;
+static uint32_t g_ui32CANImageSize;
+static uint32_t g_ui32CANHost = SIM_CAN_DONE;
+static uint32_t g_ui32CANBlock;
+static uint32_t g_ui32CANBlocks;
+static uint32_t g_ui32CANBlockFrames;
+static uint32_t g_ui32CANRound;
+static tSimCANFrame g_psCANQueue[SIM_CAN_QUEUE];
+static uint32_t g_ui32CANQueueHead;
+static uint32_t g_ui32CANQueueCount;
+static uint64_t g_ui64CANDeadline;
+static uint64_t g_ui64CANStart;
+static uint64_t g_ui64CANEnd;
+static uint32_t g_ui32CANResent;
+static uint32_t g_ui32CANPolls;
+static uint32_t g_ui32CANBadBitmaps;
+static uint32_t g_ui32CANUnexpected;
+static const char *g_pcCANError;
+static bool g_bCANInRun;
+
+//*****************************************************************************
+//
+// Ends the update with an error.  If the boot loader is running, the run is
+// ended too, as it can only be waiting for a host that has given up.
+//
+//*****************************************************************************
+static void
+SimCANFail(const char *pcError)
+{
+    if(!g_pcCANError)
+    {
+        g_pcCANError = pcError;
+    }
+    g_ui32CANHost = SIM_CAN_DONE;
+    g_ui64CANDeadline = 0;
+    g_ui64CANEnd = g_ui64Now;
+    if(g_bCANInRun)
+    {
+        longjmp(g_sDone, 1);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the number of bits that a standard data frame takes on the bus,
+// stuff bits included, which depends on the bits of the frame itself.
+//
+//*****************************************************************************
+static uint32_t
+SimCANFrameBits(const tSimCANFrame *psFrame)
+{
+    uint8_t pui8Bits[19 + 64 + 15];
+    uint32_t ui32Bits, ui32Idx, ui32CRC, ui32Run, ui32Stuff, ui32Last;
+
+    //
+    // The start of frame, the identifier, the RTR, IDE and reserved bits, the
+    // data length code and the data, most significant bit first.
+    //
+    ui32Bits = 0;
+    pui8Bits[ui32Bits++] = 0;
+    for(ui32Idx = 11; ui32Idx--; )
+    {
+        pui8Bits[ui32Bits++] = (psFrame->ui32ID >> ui32Idx) & 1;
+    }
+    pui8Bits[ui32Bits++] = 0;
+    pui8Bits[ui32Bits++] = 0;
+    pui8Bits[ui32Bits++] = 0;
+    for(ui32Idx = 4; ui32Idx--; )
+    {
+        pui8Bits[ui32Bits++] = (psFrame->ui32Size >> ui32Idx) & 1;
+    }
+    for(ui32Idx = 0; ui32Idx < (psFrame->ui32Size * 8); ui32Idx++)
+    {
+        pui8Bits[ui32Bits++] =
+            (psFrame->pui8Data[ui32Idx / 8] >> (7 - (ui32Idx % 8))) & 1;
+    }
+
+    //
+    // The 15-bit CRC of all of that.
+    //
+    ui32CRC = 0;
+    for(ui32Idx = 0; ui32Idx < ui32Bits; ui32Idx++)
+    {
+        ui32Run = pui8Bits[ui32Idx] ^ ((ui32CRC >> 14) & 1);
+        ui32CRC = (ui32CRC << 1) & 0x7fff;
+        if(ui32Run)
+        {
+            ui32CRC ^= 0x4599;
+        }
+    }
+    for(ui32Idx = 15; ui32Idx--; )
+    {
+        pui8Bits[ui32Bits++] = (ui32CRC >> ui32Idx) & 1;
+    }
+
+    //
+    // A stuff bit of the other level follows every five bits of one level,
+    // up to the end of the CRC, and starts the next run itself.
+    //
+    ui32Stuff = 0;
+    ui32Run = 0;
+    ui32Last = 2;
+    for(ui32Idx = 0; ui32Idx < ui32Bits; ui32Idx++)
+    {
+        if(pui8Bits[ui32Idx] == ui32Last)
+        {
+            ui32Run++;
+        }
+        else
+        {
+            ui32Last = pui8Bits[ui32Idx];
+            ui32Run = 1;
+        }
+        if(ui32Run == 5)
+        {
+            ui32Stuff++;
+            ui32Last ^= 1;
+            ui32Run = 1;
+        }
+    }
+
+    return(ui32Bits + ui32Stuff + SIM_CAN_TAIL_BITS);
+}
+
+//*****************************************************************************
+//
+// Returns true if the node loses the data frame that is on the bus, counting
+// the loss.
+//
+//*****************************************************************************
+static bool
+SimCANLost(uint32_t ui32Node)
+{
+    if(!(g_sCANFrame.ui32ID & CAN_ID_DATA) || !g_ui32CANLoseEvery ||
+       ((g_ui32CANDataFrames + ui32Node) % g_ui32CANLoseEvery))
+    {
+        return(false);
+    }
+    g_psCANNodes[ui32Node].ui32Lost++;
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Returns the bitmap of a block of the given number of frames once all of
+// them have arrived.
+//
+//*****************************************************************************
+static uint64_t
+SimCANComplete(uint32_t ui32Frames)
+{
+    return((ui32Frames >= 64) ? ~(uint64_t)0 :
+                                (((uint64_t)1 << ui32Frames) - 1));
+}
+
+//*****************************************************************************
+//
+// Stores the frame on the bus in the boot loader's CAN controller, in the
+// first receive object that accepts it.  An object of a FIFO that still
+// holds unread data passes the frame on to the next, and the last object of
+// the FIFO is overwritten once all of them are full.
+//
+//*****************************************************************************
+static void
+SimCANReceive(void)
+{
+    tSimCANObj *psObj;
+    uint32_t ui32Obj, ui32Mask, ui32ID;
+
+    for(ui32Obj = 0; ui32Obj < 32; ui32Obj++)
+    {
+        psObj = &g_psCANObjs[ui32Obj];
+        if(((psObj->ui32Arb2 & (CAN_IF1ARB2_MSGVAL | CAN_IF1ARB2_XTD |
+                                CAN_IF1ARB2_DIR)) != CAN_IF1ARB2_MSGVAL))
+        {
+            continue;
+        }
+        ui32Mask = 0x7ff;
+        if(psObj->ui32Ctl & CAN_IF1MCTL_UMASK)
+        {
+            ui32Mask = (psObj->ui32Mask2 & CAN_IF1MSK2_IDMSK_M) >> 2;
+        }
+        ui32ID = (psObj->ui32Arb2 & CAN_IF1ARB2_ID_M) >> 2;
+        if((ui32ID ^ g_sCANFrame.ui32ID) & ui32Mask)
+        {
+            continue;
+        }
+        if(psObj->ui32Ctl & CAN_IF1MCTL_NEWDAT)
+        {
+            if(!(psObj->ui32Ctl & CAN_IF1MCTL_EOB))
+            {
+                continue;
+            }
+            psObj->ui32Ctl |= CAN_IF1MCTL_MSGLST;
+            g_ui32CANOverflows++;
+        }
+
+        psObj->ui32Arb2 = ((psObj->ui32Arb2 & ~CAN_IF1ARB2_ID_M) |
+                           (g_sCANFrame.ui32ID << 2));
+        psObj->ui32Ctl = ((psObj->ui32Ctl & ~CAN_IF1MCTL_DLC_M) |
+                          CAN_IF1MCTL_NEWDAT | g_sCANFrame.ui32Size);
+        psObj->pui32Data[0] = (g_sCANFrame.pui8Data[0] |
+                               (g_sCANFrame.pui8Data[1] << 8));
+        psObj->pui32Data[1] = (g_sCANFrame.pui8Data[2] |
+                               (g_sCANFrame.pui8Data[3] << 8));
+        psObj->pui32Data[2] = (g_sCANFrame.pui8Data[4] |
+                               (g_sCANFrame.pui8Data[5] << 8));
+        psObj->pui32Data[3] = (g_sCANFrame.pui8Data[6] |
+                               (g_sCANFrame.pui8Data[7] << 8));
+        if(g_sCANFrame.ui32ID & CAN_ID_DATA)
+        {
+            g_ui64CANDelivered |=
+                (uint64_t)1 << CAN_ID_NODE(g_sCANFrame.ui32ID);
+        }
+        return;
+    }
+}
+
+//*****************************************************************************
+//
+// Sets up a reply from a modelled node, which it sends once it has finished
+// erasing or programming.
+//
+//*****************************************************************************
+static void
+SimCANNodeReply(tSimCANNode *psNode, uint32_t ui32Cmd,
+                const uint8_t *pui8Data, uint32_t ui32Size, uint64_t ui64Time)
+{
+    psNode->sReply.ui32ID = CAN_ID(ui32Cmd, psNode->ui32ID);
+    psNode->sReply.ui32Size = ui32Size;
+    memcpy(psNode->sReply.pui8Data, pui8Data, ui32Size);
+    psNode->sReply.ui64Ready = ((psNode->ui64BusyUntil > ui64Time) ?
+                                psNode->ui64BusyUntil : ui64Time);
+    psNode->bReply = true;
+}
+
+//*****************************************************************************
+//
+// Sets up the status reply of a modelled node.
+//
+//*****************************************************************************
+static void
+SimCANNodeStatus(tSimCANNode *psNode, uint64_t ui64Time)
+{
+    uint8_t pui8Data[3];
+
+    pui8Data[0] = psNode->ui32Status;
+    pui8Data[1] = psNode->ui32NextBlock;
+    pui8Data[2] = psNode->ui32NextBlock >> 8;
+    SimCANNodeReply(psNode, CAN_CMD_STATUS, pui8Data, 3, ui64Time);
+}
+
+//*****************************************************************************
+//
+// Passes the frame on the bus to a modelled node, which handles it as the
+// boot loader does.
+//
+//*****************************************************************************
+static void
+SimCANNodeReceive(uint32_t ui32Node, uint64_t ui64Time)
+{
+    tSimCANNode *psNode;
+    uint8_t *pui8Data;
+    uint32_t ui32Value, ui32Size;
+    uint64_t ui64Bitmap;
+
+    psNode = &g_psCANNodes[ui32Node];
+    pui8Data = g_sCANFrame.pui8Data;
+
+    //
+    // A data frame is stored if it belongs to the block being received, and
+    // the block is programmed once it is complete.
+    //
+    if(g_sCANFrame.ui32ID & CAN_ID_DATA)
+    {
+        ui64Bitmap = (uint64_t)1 << CAN_ID_NODE(g_sCANFrame.ui32ID);
+        if(SimCANLost(ui32Node) || !psNode->bActive ||
+           !(psNode->ui64Complete & ui64Bitmap))
+        {
+            return;
+        }
+        psNode->ui64Bitmap |= ui64Bitmap;
+        if(psNode->ui64Bitmap == psNode->ui64Complete)
+        {
+            ui32Size = psNode->ui32Size - (psNode->ui32NextBlock *
+                                           CAN_BLOCK_SIZE);
+            if(ui32Size > CAN_BLOCK_SIZE)
+            {
+                ui32Size = CAN_BLOCK_SIZE;
+            }
+            psNode->ui64BusyUntil = ui64Time + (((ui32Size + 3) / 4) *
+                                                g_ui64ProgramCycles);
+            psNode->ui32Programmed += ui32Size;
+            psNode->ui32NextBlock++;
+            psNode->bActive = false;
+        }
+        return;
+    }
+
+    if((CAN_ID_NODE(g_sCANFrame.ui32ID) != psNode->ui32ID) &&
+       (CAN_ID_NODE(g_sCANFrame.ui32ID) != CAN_NODE_ALL))
+    {
+        return;
+    }
+    switch(CAN_ID_CMD(g_sCANFrame.ui32ID))
+    {
+        case CAN_CMD_PING:
+        {
+            SimCANNodeStatus(psNode, ui64Time);
+            break;
+        }
+
+        case CAN_CMD_DOWNLOAD:
+        {
+            ui32Value = (pui8Data[0] | (pui8Data[1] << 8) |
+                         (pui8Data[2] << 16) | (pui8Data[3] << 24));
+            ui32Size = (pui8Data[4] | (pui8Data[5] << 8) |
+                        (pui8Data[6] << 16) | (pui8Data[7] << 24));
+            psNode->bActive = false;
+            psNode->bDownloading = ((g_sCANFrame.ui32Size == 8) && ui32Size &&
+                                    (ui32Value == APP_START_ADDRESS) &&
+                                    (ui32Size <= (SIM_FLASH_SIZE -
+                                                  APP_START_ADDRESS)));
+            psNode->ui32Status = (psNode->bDownloading ? COMMAND_RET_SUCCESS :
+                                  COMMAND_RET_INVALID_ADR);
+            psNode->ui32Size = ui32Size;
+            psNode->ui32NextBlock = 0;
+            psNode->ui32Programmed = 0;
+            if(psNode->bDownloading)
+            {
+                psNode->ui64BusyUntil =
+                    ui64Time + (((ui32Size + BL_FLASH_ERASE_SIZE - 1) /
+                                 BL_FLASH_ERASE_SIZE) * g_ui64EraseCycles);
+            }
+            SimCANNodeStatus(psNode, ui64Time);
+            break;
+        }
+
+        case CAN_CMD_BLOCK:
+        {
+            ui32Value = pui8Data[0] | (pui8Data[1] << 8);
+            if((g_sCANFrame.ui32Size != 3) || !psNode->bDownloading ||
+               (psNode->ui32Status != COMMAND_RET_SUCCESS) ||
+               (ui32Value != psNode->ui32NextBlock) || psNode->bActive ||
+               !pui8Data[2] || (pui8Data[2] > CAN_BLOCK_FRAMES) ||
+               ((ui32Value * CAN_BLOCK_SIZE) >= psNode->ui32Size))
+            {
+                break;
+            }
+            psNode->ui64Bitmap = 0;
+            psNode->ui64Complete = SimCANComplete(pui8Data[2]);
+            psNode->bActive = true;
+            break;
+        }
+
+        case CAN_CMD_POLL:
+        {
+            if((CAN_ID_NODE(g_sCANFrame.ui32ID) == CAN_NODE_ALL) ||
+               (g_sCANFrame.ui32Size != 2))
+            {
+                break;
+            }
+            if(psNode->ui32Status != COMMAND_RET_SUCCESS)
+            {
+                SimCANNodeStatus(psNode, ui64Time);
+                break;
+            }
+            ui32Value = pui8Data[0] | (pui8Data[1] << 8);
+            ui64Bitmap = 0;
+            if(ui32Value < psNode->ui32NextBlock)
+            {
+                ui64Bitmap = ~(uint64_t)0;
+            }
+            else if(psNode->bActive && (ui32Value == psNode->ui32NextBlock))
+            {
+                ui64Bitmap = psNode->ui64Bitmap;
+            }
+            for(ui32Size = 0; ui32Size < 8; ui32Size++)
+            {
+                pui8Data[ui32Size] = ui64Bitmap >> (ui32Size * 8);
+            }
+            SimCANNodeReply(psNode, CAN_CMD_BITMAP, pui8Data, 8, ui64Time);
+            break;
+        }
+
+        case CAN_CMD_RUN:
+        {
+            if(!psNode->bDownloading ||
+               (psNode->ui32Programmed < psNode->ui32Size))
+            {
+                psNode->ui32Status = COMMAND_RET_INVALID_CMD;
+            }
+            psNode->bRun = (psNode->ui32Status == COMMAND_RET_SUCCESS);
+            SimCANNodeStatus(psNode, ui64Time);
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Queues a frame for the host model to send.
+//
+//*****************************************************************************
+static void
+SimCANHostQueue(uint32_t ui32ID, const uint8_t *pui8Data, uint32_t ui32Size,
+                uint64_t ui64Ready)
+{
+    tSimCANFrame *psFrame;
+
+    psFrame = &g_psCANQueue[(g_ui32CANQueueHead + g_ui32CANQueueCount++) %
+                            SIM_CAN_QUEUE];
+    psFrame->ui32ID = ui32ID;
+    psFrame->ui32Size = ui32Size;
+    memset(psFrame->pui8Data, 0, 8);
+    memcpy(psFrame->pui8Data, pui8Data, ui32Size);
+    psFrame->ui64Ready = ui64Ready;
+}
+
+//*****************************************************************************
+//
+// Queues a command to every node, and waits for all of them to reply.
+//
+//*****************************************************************************
+static void
+SimCANHostBroadcast(uint32_t ui32Cmd, const uint8_t *pui8Data,
+                    uint32_t ui32Size, uint64_t ui64Ready)
+{
+    uint32_t ui32Node;
+
+    SimCANHostQueue(CAN_ID(ui32Cmd, CAN_NODE_ALL), pui8Data, ui32Size,
+                    ui64Ready);
+    for(ui32Node = 0; ui32Node < g_ui32CANActive; ui32Node++)
+    {
+        g_psCANNodes[ui32Node].bAwait = true;
+    }
+}
+
+//*****************************************************************************
+//
+// Queues a poll of each node that is missing frames of the current block,
+// which is every node before the block has been sent.
+//
+//*****************************************************************************
+static void
+SimCANHostPoll(uint64_t ui64Ready)
+{
+    uint8_t pui8Data[2];
+    uint32_t ui32Node;
+
+    pui8Data[0] = g_ui32CANBlock;
+    pui8Data[1] = g_ui32CANBlock >> 8;
+    for(ui32Node = 0; ui32Node < g_ui32CANActive; ui32Node++)
+    {
+        if(g_psCANNodes[ui32Node].ui64Missing)
+        {
+            SimCANHostQueue(CAN_ID(CAN_CMD_POLL,
+                                   g_psCANNodes[ui32Node].ui32ID),
+                            pui8Data, 2, ui64Ready);
+            g_psCANNodes[ui32Node].bAwait = true;
+            g_ui32CANPolls++;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Queues the given data frame of the current block.
+//
+//*****************************************************************************
+static void
+SimCANHostData(uint32_t ui32Frame, uint64_t ui64Ready)
+{
+    uint32_t ui32Offset, ui32Size;
+
+    ui32Offset = (g_ui32CANBlock * CAN_BLOCK_SIZE) + (ui32Frame * 8);
+    ui32Size = g_ui32CANImageSize - ui32Offset;
+    if(ui32Size > 8)
+    {
+        ui32Size = 8;
+    }
+    SimCANHostQueue(CAN_ID_DATA | ui32Frame, g_pui8CANImage + ui32Offset,
+                    ui32Size, ui64Ready);
+}
+
+//*****************************************************************************
+//
+// Queues the broadcast of the current block, followed by a poll of each
+// node.
+//
+//*****************************************************************************
+static void
+SimCANHostBlock(uint64_t ui64Ready)
+{
+    uint8_t pui8Data[3];
+    uint32_t ui32Frame, ui32Size;
+
+    ui32Size = g_ui32CANImageSize - (g_ui32CANBlock * CAN_BLOCK_SIZE);
+    if(ui32Size > CAN_BLOCK_SIZE)
+    {
+        ui32Size = CAN_BLOCK_SIZE;
+    }
+    g_ui32CANBlockFrames = (ui32Size + 7) / 8;
+    g_ui32CANRound = 0;
+    g_ui64CANDelivered = 0;
+
+    pui8Data[0] = g_ui32CANBlock;
+    pui8Data[1] = g_ui32CANBlock >> 8;
+    pui8Data[2] = g_ui32CANBlockFrames;
+    SimCANHostQueue(CAN_ID(CAN_CMD_BLOCK, CAN_NODE_ALL), pui8Data, 3,
+                    ui64Ready);
+    for(ui32Frame = 0; ui32Frame < g_ui32CANBlockFrames; ui32Frame++)
+    {
+        SimCANHostData(ui32Frame, ui64Ready);
+    }
+    for(ui32Frame = 0; ui32Frame < g_ui32CANActive; ui32Frame++)
+    {
+        g_psCANNodes[ui32Frame].ui64Missing =
+            SimCANComplete(g_ui32CANBlockFrames);
+    }
+    SimCANHostPoll(ui64Ready);
+}
+
+//*****************************************************************************
+//
+// Takes the next step of the update once every reply that the host model
+// was waiting for has come, at the given time.
+//
+//*****************************************************************************
+static void
+SimCANHostStep(uint64_t ui64Time)
+{
+    uint8_t pui8Data[8];
+    uint64_t ui64Missing;
+    uint32_t ui32Idx;
+
+    g_ui64CANDeadline = 0;
+    switch(g_ui32CANHost)
+    {
+        case SIM_CAN_PING:
+        {
+            for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+            {
+                pui8Data[ui32Idx] = APP_START_ADDRESS >> (ui32Idx * 8);
+                pui8Data[ui32Idx + 4] = g_ui32CANImageSize >> (ui32Idx * 8);
+            }
+            SimCANHostBroadcast(CAN_CMD_DOWNLOAD, pui8Data, 8,
+                                ui64Time + g_ui64Turnaround);
+            g_ui32CANHost = SIM_CAN_DOWNLOAD;
+            break;
+        }
+
+        case SIM_CAN_DOWNLOAD:
+        {
+            g_ui32CANBlock = 0;
+            SimCANHostBlock(ui64Time + g_ui64Turnaround);
+            g_ui32CANHost = SIM_CAN_BLOCK;
+            break;
+        }
+
+        case SIM_CAN_BLOCK:
+        {
+            //
+            // Rebroadcast the frames that any node is missing, if there are
+            // any, and poll those nodes again.
+            //
+            ui64Missing = 0;
+            for(ui32Idx = 0; ui32Idx < g_ui32CANActive; ui32Idx++)
+            {
+                ui64Missing |= g_psCANNodes[ui32Idx].ui64Missing;
+            }
+            if(ui64Missing)
+            {
+                if(++g_ui32CANRound > SIM_CAN_ROUNDS)
+                {
+                    SimCANFail("a block was still missing frames after the "
+                               "last rebroadcast");
+                    return;
+                }
+                for(ui32Idx = 0; ui32Idx < 64; ui32Idx++)
+                {
+                    if(ui64Missing & ((uint64_t)1 << ui32Idx))
+                    {
+                        SimCANHostData(ui32Idx, ui64Time + g_ui64Turnaround);
+                        g_ui32CANResent++;
+                    }
+                }
+                SimCANHostPoll(ui64Time + g_ui64Turnaround);
+                break;
+            }
+
+            //
+            // Otherwise move on to the next block, or run the image once
+            // every block is in.
+            //
+            if(++g_ui32CANBlock < g_ui32CANBlocks)
+            {
+                SimCANHostBlock(ui64Time + g_ui64Turnaround);
+                break;
+            }
+            SimCANHostBroadcast(CAN_CMD_RUN, pui8Data, 0,
+                                ui64Time + g_ui64Turnaround);
+            g_ui32CANHost = SIM_CAN_RUN;
+            break;
+        }
+
+        case SIM_CAN_RUN:
+        {
+            g_ui32CANHost = SIM_CAN_DONE;
+            g_ui64CANEnd = ui64Time;
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Passes the frame on the bus, a reply from a node, to the host model.
+//
+//*****************************************************************************
+static void
+SimCANHostReceive(uint64_t ui64Time)
+{
+    tSimCANNode *psNode;
+    uint64_t ui64Bitmap, ui64Expected;
+    uint32_t ui32Node, ui32Idx;
+
+    ui32Node = ((CAN_ID_NODE(g_sCANFrame.ui32ID) + CAN_NODE_ALL -
+                 CAN_NODE_ID) % CAN_NODE_ALL);
+    psNode = &g_psCANNodes[ui32Node];
+    if((ui32Node >= g_ui32CANActive) || !psNode->bAwait ||
+       (g_sCANFrame.ui32ID & CAN_ID_DATA))
+    {
+        g_ui32CANUnexpected++;
+        return;
+    }
+    psNode->bAwait = false;
+
+    switch(CAN_ID_CMD(g_sCANFrame.ui32ID))
+    {
+        case CAN_CMD_STATUS:
+        {
+            //
+            // A poll is only answered with the status once the node has
+            // failed.
+            //
+            if((g_sCANFrame.ui32Size != 3) ||
+               (g_sCANFrame.pui8Data[0] != COMMAND_RET_SUCCESS) ||
+               (g_ui32CANHost == SIM_CAN_BLOCK))
+            {
+                SimCANFail("a node replied with a failure status");
+                return;
+            }
+            break;
+        }
+
+        case CAN_CMD_BITMAP:
+        {
+            if((g_sCANFrame.ui32Size != 8) ||
+               (g_ui32CANHost != SIM_CAN_BLOCK))
+            {
+                g_ui32CANUnexpected++;
+                break;
+            }
+            ui64Bitmap = 0;
+            for(ui32Idx = 0; ui32Idx < 8; ui32Idx++)
+            {
+                ui64Bitmap |= ((uint64_t)g_sCANFrame.pui8Data[ui32Idx] <<
+                               (ui32Idx * 8));
+            }
+            psNode->ui64Missing = (SimCANComplete(g_ui32CANBlockFrames) &
+                                   ~ui64Bitmap);
+
+            //
+            // The boot loader must report exactly the frames that reached
+            // it, or all of them once it has programmed the block.
+            //
+            if(!ui32Node)
+            {
+                ui64Expected = (g_ui64CANDelivered &
+                                SimCANComplete(g_ui32CANBlockFrames));
+                if(ui64Expected == SimCANComplete(g_ui32CANBlockFrames))
+                {
+                    ui64Expected = ~(uint64_t)0;
+                }
+                if(ui64Bitmap != ui64Expected)
+                {
+                    g_ui32CANBadBitmaps++;
+                }
+            }
+            break;
+        }
+
+        default:
+        {
+            g_ui32CANUnexpected++;
+            break;
+        }
+    }
+
+    for(ui32Idx = 0; ui32Idx < g_ui32CANActive; ui32Idx++)
+    {
+        if(g_psCANNodes[ui32Idx].bAwait)
+        {
+            return;
+        }
+    }
+    SimCANHostStep(ui64Time);
+}
+
+//*****************************************************************************
+//
+// Finds the frame that goes on the bus next, and the time that it starts:
+// of the frames whose senders have them ready by the time the bus is free
+// for the first of them, the one with the lowest identifier.  The boot
+// loader's controller offers the frame of its lowest numbered object with a
+// transmit request.  Returns 0 if no sender has a frame.
+//
+//*****************************************************************************
+static tSimCANFrame *
+SimCANArbitrate(uint32_t *pui32Sender, uint64_t *pui64Start)
+{
+    tSimCANFrame *ppsFrames[SIM_CAN_NODES + 1], *psBest;
+    tSimCANObj *psObj;
+    uint32_t ui32Idx, ui32Best;
+    uint64_t ui64Start;
+
+    for(ui32Idx = 0; ui32Idx <= SIM_CAN_NODES; ui32Idx++)
+    {
+        ppsFrames[ui32Idx] = 0;
+    }
+    if(g_ui32CANQueueCount)
+    {
+        ppsFrames[SIM_CAN_HOST] = &g_psCANQueue[g_ui32CANQueueHead];
+    }
+    for(ui32Idx = 1; ui32Idx < g_ui32CANActive; ui32Idx++)
+    {
+        if(g_psCANNodes[ui32Idx].bReply)
+        {
+            ppsFrames[ui32Idx] = &g_psCANNodes[ui32Idx].sReply;
+        }
+    }
+    for(ui32Idx = 0; !g_bCANInit && (ui32Idx < 32); ui32Idx++)
+    {
+        psObj = &g_psCANObjs[ui32Idx];
+        if(((psObj->ui32Arb2 & (CAN_IF1ARB2_MSGVAL | CAN_IF1ARB2_DIR)) ==
+            (CAN_IF1ARB2_MSGVAL | CAN_IF1ARB2_DIR)) &&
+           (psObj->ui32Ctl & CAN_IF1MCTL_TXRQST))
+        {
+            g_ui32CANTxObj = ui32Idx;
+            g_sCANTx.ui32ID = (psObj->ui32Arb2 & CAN_IF1ARB2_ID_M) >> 2;
+            g_sCANTx.ui32Size = psObj->ui32Ctl & CAN_IF1MCTL_DLC_M;
+            if(g_sCANTx.ui32Size > 8)
+            {
+                g_sCANTx.ui32Size = 8;
+            }
+            g_sCANTx.pui8Data[0] = psObj->pui32Data[0];
+            g_sCANTx.pui8Data[1] = psObj->pui32Data[0] >> 8;
+            g_sCANTx.pui8Data[2] = psObj->pui32Data[1];
+            g_sCANTx.pui8Data[3] = psObj->pui32Data[1] >> 8;
+            g_sCANTx.pui8Data[4] = psObj->pui32Data[2];
+            g_sCANTx.pui8Data[5] = psObj->pui32Data[2] >> 8;
+            g_sCANTx.pui8Data[6] = psObj->pui32Data[3];
+            g_sCANTx.pui8Data[7] = psObj->pui32Data[3] >> 8;
+            g_sCANTx.ui64Ready = psObj->ui64TxTime;
+            ppsFrames[0] = &g_sCANTx;
+            break;
+        }
+    }
+
+    //
+    // The bus is free for the first frame when it is ready or when the frame
+    // before it ends, whichever is later, and every frame ready by then takes
+    // part in the arbitration.
+    //
+    *pui64Start = 0;
+    for(ui32Idx = 0; ui32Idx <= SIM_CAN_NODES; ui32Idx++)
+    {
+        if(ppsFrames[ui32Idx])
+        {
+            ui64Start = ((ppsFrames[ui32Idx]->ui64Ready > g_ui64CANBusFree) ?
+                         ppsFrames[ui32Idx]->ui64Ready : g_ui64CANBusFree);
+            if(!*pui64Start || (ui64Start < *pui64Start))
+            {
+                *pui64Start = ui64Start;
+            }
+        }
+    }
+    psBest = 0;
+    ui32Best = 0;
+    for(ui32Idx = 0; ui32Idx <= SIM_CAN_NODES; ui32Idx++)
+    {
+        if(ppsFrames[ui32Idx] &&
+           (ppsFrames[ui32Idx]->ui64Ready <= *pui64Start) &&
+           (!psBest || (ppsFrames[ui32Idx]->ui32ID < psBest->ui32ID)))
+        {
+            psBest = ppsFrames[ui32Idx];
+            ui32Best = ui32Idx;
+        }
+    }
+    *pui32Sender = ui32Best;
+
+    return(psBest);
+}
+
+//*****************************************************************************
+//
+// Ends the frame on the bus at the given time, passing it to everything on
+// the bus other than its sender.
+//
+//*****************************************************************************
+static void
+SimCANDeliver(uint64_t ui64Time)
+{
+    uint32_t ui32Node;
+
+    g_bCANOnBus = false;
+    if(g_sCANFrame.ui32ID & CAN_ID_DATA)
+    {
+        g_ui32CANDataFrames++;
+    }
+
+    //
+    // The sender's transmit request is done with.
+    //
+    if(g_ui32CANSender == SIM_CAN_HOST)
+    {
+        g_ui32CANQueueHead = (g_ui32CANQueueHead + 1) % SIM_CAN_QUEUE;
+        g_ui32CANQueueCount--;
+    }
+    else if(g_ui32CANSender)
+    {
+        g_psCANNodes[g_ui32CANSender].bReply = false;
+    }
+    else
+    {
+        g_psCANObjs[g_ui32CANTxObj].ui32Ctl &= ~CAN_IF1MCTL_TXRQST;
+        SimRegFind(CAN0_BASE + CAN_O_STS)->ui32Value |= CAN_STS_TXOK;
+    }
+
+    //
+    // Pass it on.  The boot loader's controller hears nothing while it is
+    // held in its init state.
+    //
+    if(g_ui32CANSender && !g_bCANInit && !SimCANLost(0))
+    {
+        SimCANReceive();
+        SimRegFind(CAN0_BASE + CAN_O_STS)->ui32Value |= CAN_STS_RXOK;
+    }
+    for(ui32Node = 1; ui32Node < g_ui32CANActive; ui32Node++)
+    {
+        if(ui32Node != g_ui32CANSender)
+        {
+            SimCANNodeReceive(ui32Node, ui64Time);
+        }
+    }
+    if(g_ui32CANSender != SIM_CAN_HOST)
+    {
+        SimCANHostReceive(ui64Time);
+    }
+    else if(!g_ui32CANQueueCount && (g_ui32CANHost != SIM_CAN_DONE))
+    {
+        g_ui64CANDeadline = ui64Time + g_ui64HostTimeout;
+    }
+}
+
+//*****************************************************************************
+//
+// Starts the host model at the given time with the given number of nodes on
+// the bus, the boot loader among them, which it begins to update with a
+// ping of all of them.
+//
+//*****************************************************************************
+void
+SimCANStart(uint64_t ui64Start)
+{
+    tSimCANNode *psNode;
+    uint32_t ui32Node;
+
+    for(ui32Node = 0; ui32Node < SIM_CAN_NODES; ui32Node++)
+    {
+        psNode = &g_psCANNodes[ui32Node];
+        memset(psNode, 0, sizeof(*psNode));
+        psNode->ui32ID = (CAN_NODE_ID + ui32Node) % CAN_NODE_ALL;
+        psNode->ui32Status = COMMAND_RET_SUCCESS;
+    }
+    g_ui32CANQueueHead = 0;
+    g_ui32CANQueueCount = 0;
+    g_ui64CANBusFree = ui64Start;
+    g_ui64CANBusy = 0;
+    g_ui32CANFrames = 0;
+    g_ui32CANDataFrames = 0;
+    g_ui32CANResent = 0;
+    g_ui32CANPolls = 0;
+    g_ui64CANStart = ui64Start;
+    g_ui32CANBlocks = ((g_ui32CANImageSize + CAN_BLOCK_SIZE - 1) /
+                       CAN_BLOCK_SIZE);
+    g_bCANInRun = true;
+
+    g_ui32CANHost = SIM_CAN_PING;
+    SimCANHostBroadcast(CAN_CMD_PING, 0, 0, ui64Start);
+}
+
+//*****************************************************************************
+//
+// Brings the bus up to the current time: ends the frame on it once its last
+// bit has gone, and starts the next one once its sender has it ready and the
+// bus is free.  The host model gives up if the replies it is waiting for
+// have not come by its timeout.
+//
+//*****************************************************************************
+void
+SimCANUpdate(void)
+{
+    tSimCANFrame *psFrame;
+    uint64_t ui64Start;
+    uint32_t ui32Sender;
+
+    while(1)
+    {
+        if(g_bCANOnBus)
+        {
+            if(g_ui64CANBusFree > g_ui64Now)
+            {
+                break;
+            }
+            SimCANDeliver(g_ui64CANBusFree);
+            continue;
+        }
+
+        psFrame = SimCANArbitrate(&ui32Sender, &ui64Start);
+        if(!psFrame || (ui64Start > g_ui64Now))
+        {
+            break;
+        }
+        g_sCANFrame = *psFrame;
+        g_ui32CANSender = ui32Sender;
+        g_ui64CANBusFree = (ui64Start + (SimCANFrameBits(psFrame) *
+                                         g_ui64CANBitCycles));
+        g_ui64CANBusy += g_ui64CANBusFree - ui64Start;
+        g_ui32CANFrames++;
+        g_bCANOnBus = true;
+    }
+
+    if(g_ui64CANDeadline && (g_ui64Now >= g_ui64CANDeadline))
+    {
+        SimCANFail("a node did not reply in time");
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the time of the next event on the bus after the current time, or
+// zero if nothing is pending.
+//
+//*****************************************************************************
+uint64_t
+SimCANNextEvent(void)
+{
+    uint64_t ui64Next;
+    uint32_t ui32Sender;
+
+    if(g_bCANOnBus)
+    {
+        return(g_ui64CANBusFree);
+    }
+    if(!SimCANArbitrate(&ui32Sender, &ui64Next))
+    {
+        ui64Next = 0;
+    }
+    if(g_ui64CANDeadline && (!ui64Next || (g_ui64CANDeadline < ui64Next)))
+    {
+        ui64Next = g_ui64CANDeadline;
+    }
+
+    return(ui64Next);
+}
+
+//*****************************************************************************
+//
+// Returns true if the register is one that the boot loader polls while it
+// waits for a frame to arrive or to be sent.
+//
+//*****************************************************************************
+bool
+SimCANPolled(uint32_t ui32Address)
+{
+    switch(ui32Address)
+    {
+        case CAN0_BASE + CAN_O_TXRQ1:
+        case CAN0_BASE + CAN_O_TXRQ2:
+        case CAN0_BASE + CAN_O_NWDA1:
+        case CAN0_BASE + CAN_O_NWDA2:
+        {
+            return(true);
+        }
+
+        default:
+        {
+            return(false);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Gives the value that a read of a CAN controller register returns now,
+// returning false if the register is not one that this model keeps.  The
+// transmit request, new data and message valid registers each gather one bit
+// from each of sixteen message objects.
+//
+//*****************************************************************************
+bool
+SimCANRead(uint32_t ui32Address, uint32_t *pui32Value)
+{
+    uint32_t ui32Obj, ui32Field, ui32Bits;
+
+    switch(ui32Address)
+    {
+        case CAN0_BASE + CAN_O_TXRQ1:
+        case CAN0_BASE + CAN_O_TXRQ2:
+        {
+            ui32Field = CAN_IF1MCTL_TXRQST;
+            break;
+        }
+
+        case CAN0_BASE + CAN_O_NWDA1:
+        case CAN0_BASE + CAN_O_NWDA2:
+        {
+            ui32Field = CAN_IF1MCTL_NEWDAT;
+            break;
+        }
+
+        case CAN0_BASE + CAN_O_MSG1VAL:
+        case CAN0_BASE + CAN_O_MSG2VAL:
+        {
+            ui32Field = 0;
+            break;
+        }
+
+        default:
+        {
+            return(false);
+        }
+    }
+
+    ui32Bits = 0;
+    for(ui32Obj = 0; ui32Obj < 32; ui32Obj++)
+    {
+        if(ui32Field ? (g_psCANObjs[ui32Obj].ui32Ctl & ui32Field) :
+                       (g_psCANObjs[ui32Obj].ui32Arb2 & CAN_IF1ARB2_MSGVAL))
+        {
+            ui32Bits |= 1 << ui32Obj;
+        }
+    }
+    *pui32Value = (ui32Address & 4) ? (ui32Bits >> 16) : (ui32Bits & 0xffff);
+
+    //
+    // The boot loader reads both halves of a register each time it polls, so
+    // the pair counts as one polled register, whose value is all 32 bits.
+    //
+    if(ui32Field && !(ui32Address & 4))
+    {
+        SimPoll(ui32Address, ui32Bits);
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Moves a message object to or from an interface register set, as a write
+// of the message number to the set's command request register does, and
+// leaves the command request register no longer busy.
+//
+//*****************************************************************************
+static void
+SimCANTransfer(uint32_t ui32IF, uint32_t ui32Obj)
+{
+    tSimCANObj *psObj;
+    uint32_t ui32Cmd, ui32Idx;
+
+    if((ui32Obj == 0) || (ui32Obj > 32))
+    {
+        return;
+    }
+    psObj = &g_psCANObjs[ui32Obj - 1];
+    ui32Cmd = SIM_CAN_IF(ui32IF, CAN_O_IF1CMSK);
+
+    if(ui32Cmd & CAN_IF1CMSK_WRNRD)
+    {
+        if(ui32Cmd & CAN_IF1CMSK_MASK)
+        {
+            psObj->ui32Mask1 = SIM_CAN_IF(ui32IF, CAN_O_IF1MSK1) & 0xffff;
+            psObj->ui32Mask2 = SIM_CAN_IF(ui32IF, CAN_O_IF1MSK2) & 0xffff;
+        }
+        if(ui32Cmd & CAN_IF1CMSK_ARB)
+        {
+            psObj->ui32Arb1 = SIM_CAN_IF(ui32IF, CAN_O_IF1ARB1) & 0xffff;
+            psObj->ui32Arb2 = SIM_CAN_IF(ui32IF, CAN_O_IF1ARB2) & 0xffff;
+        }
+        if(ui32Cmd & CAN_IF1CMSK_CONTROL)
+        {
+            psObj->ui32Ctl = SIM_CAN_IF(ui32IF, CAN_O_IF1MCTL) & 0xffff;
+        }
+        if(ui32Cmd & CAN_IF1CMSK_CLRINTPND)
+        {
+            psObj->ui32Ctl &= ~CAN_IF1MCTL_INTPND;
+        }
+        if(ui32Cmd & CAN_IF1CMSK_TXRQST)
+        {
+            psObj->ui32Ctl |= CAN_IF1MCTL_TXRQST;
+        }
+        for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+        {
+            if(ui32Cmd & ((ui32Idx < 2) ? CAN_IF1CMSK_DATAA :
+                                          CAN_IF1CMSK_DATAB))
+            {
+                psObj->pui32Data[ui32Idx] =
+                    SIM_CAN_IF(ui32IF, CAN_O_IF1DA1 + (ui32Idx * 4)) & 0xffff;
+            }
+        }
+        if(psObj->ui32Ctl & CAN_IF1MCTL_TXRQST)
+        {
+            psObj->ui64TxTime = g_ui64Now;
+        }
+    }
+    else
+    {
+        if(ui32Cmd & CAN_IF1CMSK_MASK)
+        {
+            SIM_CAN_IF(ui32IF, CAN_O_IF1MSK1) = psObj->ui32Mask1;
+            SIM_CAN_IF(ui32IF, CAN_O_IF1MSK2) = psObj->ui32Mask2;
+        }
+        if(ui32Cmd & CAN_IF1CMSK_ARB)
+        {
+            SIM_CAN_IF(ui32IF, CAN_O_IF1ARB1) = psObj->ui32Arb1;
+            SIM_CAN_IF(ui32IF, CAN_O_IF1ARB2) = psObj->ui32Arb2;
+        }
+        if(ui32Cmd & CAN_IF1CMSK_CONTROL)
+        {
+            SIM_CAN_IF(ui32IF, CAN_O_IF1MCTL) = psObj->ui32Ctl;
+        }
+        for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+        {
+            if(ui32Cmd & ((ui32Idx < 2) ? CAN_IF1CMSK_DATAA :
+                                          CAN_IF1CMSK_DATAB))
+            {
+                SIM_CAN_IF(ui32IF, CAN_O_IF1DA1 + (ui32Idx * 4)) =
+                    psObj->pui32Data[ui32Idx];
+            }
+        }
+        if(ui32Cmd & CAN_IF1CMSK_CLRINTPND)
+        {
+            psObj->ui32Ctl &= ~CAN_IF1MCTL_INTPND;
+        }
+        if(ui32Cmd & CAN_IF1CMSK_NEWDAT)
+        {
+            psObj->ui32Ctl &= ~CAN_IF1MCTL_NEWDAT;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Applies the side effects of a write to a CAN controller register,
+// returning false if the register is not one that this model keeps.  The
+// message number written to a command request register is replaced with one
+// marked as done, so that the next request for the same object is seen as a
+// write.
+//
+//*****************************************************************************
+bool
+SimCANWrite(uint32_t ui32Address, uint32_t ui32Value)
+{
+    uint32_t ui32Bit, ui32BRP;
+
+    switch(ui32Address)
+    {
+        case CAN0_BASE + CAN_O_CTL:
+        {
+            //
+            // The bit time is fixed when the controller leaves its init
+            // state.
+            //
+            g_bCANInit = (ui32Value & CAN_CTL_INIT) ? true : false;
+            if(!g_bCANInit)
+            {
+                ui32Bit = SimRegFind(CAN0_BASE + CAN_O_BIT)->ui32Value;
+                ui32BRP = (((ui32Bit & CAN_BIT_BRP_M) |
+                            ((SimRegFind(CAN0_BASE + CAN_O_BRPE)->ui32Value &
+                              CAN_BRPE_BRPE_M) << 6)) + 1);
+                g_ui64CANBitCycles =
+                    ui32BRP * ((((ui32Bit & CAN_BIT_TSEG1_M) >>
+                                 CAN_BIT_TSEG1_S) + 1) +
+                               (((ui32Bit & CAN_BIT_TSEG2_M) >>
+                                 CAN_BIT_TSEG2_S) + 1) + 1);
+            }
+            return(true);
+        }
+
+        case CAN0_BASE + CAN_O_IF1CRQ:
+        case CAN0_BASE + CAN_O_IF2CRQ:
+        {
+            SimCANTransfer(ui32Address - (CAN0_BASE + CAN_O_IF1CRQ),
+                           ui32Value & CAN_IF1CRQ_MNUM_M);
+            SimRegFind(ui32Address)->ui32Value =
+                SIM_CAN_CRQ_MARK | (ui32Value & CAN_IF1CRQ_MNUM_M);
+            return(true);
+        }
+
+        default:
+        {
+            return(false);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Runs the update twice, with the boot loader alone on the bus and then with
+// all of the nodes, and reports the results.  Returns non-zero if the check
+// fails.
+//
+//*****************************************************************************
+int
+SimCANRun(const uint8_t *pui8Image, uint32_t ui32Size)
+{
+    tSimCANPass psPasses[2], *psPass;
+    uint64_t ui64Next;
+    uint32_t ui32Pass, ui32Node;
+    bool bFail;
+
+    g_pui8CANImage = pui8Image;
+    g_ui32CANImageSize = ui32Size;
+    bFail = false;
+    for(ui32Pass = 0; ui32Pass < 2; ui32Pass++)
+    {
+        //
+        // Start from erased flash, and run the boot loader until it resets
+        // to run the image.  The other nodes' replies to the command to run
+        // it may still be to come.
+        //
+        memset(g_pui8Flash, 0xff, SIM_FLASH_SIZE);
+        g_ui32CANActive = ui32Pass ? g_ui32CANNodes : 1;
+        SimRun(true);
+        g_bCANInRun = false;
+        g_bCANInit = true;
+        while(g_ui32CANHost != SIM_CAN_DONE)
+        {
+            ui64Next = SimCANNextEvent();
+            if(!ui64Next)
+            {
+                SimCANFail("the bus stalled");
+                break;
+            }
+            if(ui64Next > g_ui64Now)
+            {
+                g_ui64Now = ui64Next;
+            }
+            SimCANUpdate();
+        }
+
+        psPass = &psPasses[ui32Pass];
+        psPass->ui32Nodes = g_ui32CANActive;
+        psPass->ui64Cycles = g_ui64CANEnd - g_ui64CANStart;
+        psPass->ui64Busy = g_ui64CANBusy;
+        psPass->ui32Frames = g_ui32CANFrames;
+        psPass->ui32Data = g_ui32CANDataFrames;
+        psPass->ui32Resent = g_ui32CANResent;
+        psPass->ui32Polls = g_ui32CANPolls;
+        psPass->ui32Lost = 0;
+        for(ui32Node = 0; ui32Node < g_ui32CANActive; ui32Node++)
+        {
+            psPass->ui32Lost += g_psCANNodes[ui32Node].ui32Lost;
+            if(ui32Node && !g_psCANNodes[ui32Node].bRun)
+            {
+                SimCANFail("a node did not finish");
+            }
+        }
+        psPass->bVerify = !memcmp(g_pui8Flash + APP_START_ADDRESS, pui8Image,
+                                  ui32Size);
+        bFail |= (!psPass->bVerify ||
+                  (psPass->ui32Resent > psPass->ui32Lost) ||
+                  (psPass->ui32Lost && !psPass->ui32Resent));
+        if(g_pcCANError)
+        {
+            ui32Pass++;
+            break;
+        }
+    }
+
+    //
+    // Report the results.
+    //
+    printf("image:     %u bytes at 0x%08x\n", ui32Size, APP_START_ADDRESS);
+    printf("link:      CAN at %u bit/s, %u Hz system clock\n",
+           g_ui64CANBitCycles ? (uint32_t)(g_ui32SysClockHz /
+                                           g_ui64CANBitCycles) : 0,
+           g_ui32SysClockHz);
+    printf("\n%-5s %12s %8s %8s %8s %8s %8s %8s %7s\n", "nodes", "time (ms)",
+           "bytes/s", "frames", "data", "resent", "lost", "polls",
+           "verify");
+    for(ui32Node = 0; ui32Node < ui32Pass; ui32Node++)
+    {
+        psPass = &psPasses[ui32Node];
+        printf("%-5u %12.3f %8.0f %8u %8u %8u %8u %8u %7s\n",
+               psPass->ui32Nodes,
+               CyclesToSeconds(psPass->ui64Cycles) * 1000.0,
+               ui32Size / CyclesToSeconds(psPass->ui64Cycles),
+               psPass->ui32Frames, psPass->ui32Data, psPass->ui32Resent,
+               psPass->ui32Lost, psPass->ui32Polls,
+               psPass->bVerify ? "ok" : "FAILED");
+    }
+    printf("\n");
+    if(g_pcCANError)
+    {
+        printf("can:       %s\n", g_pcCANError);
+        return(1);
+    }
+    printf("bus:       busy %.1f%% of the time with one node, %.1f%% with "
+           "%u\n", (psPasses[0].ui64Busy * 100.0) / psPasses[0].ui64Cycles,
+           (psPasses[1].ui64Busy * 100.0) / psPasses[1].ui64Cycles,
+           psPasses[1].ui32Nodes);
+    printf("can:       %u FIFO overflows, %u wrong bitmaps, %u unexpected "
+           "replies\n", g_ui32CANOverflows, g_ui32CANBadBitmaps,
+           g_ui32CANUnexpected);
+    bFail |= (g_ui32CANOverflows || g_ui32CANBadBitmaps ||
+              g_ui32CANUnexpected);
+
+    //
+    // Broadcasting the image to every node at once should take little longer
+    // than sending it to one.
+    //
+    printf("nodes:     %u updated in %.2f times the time of one, against %u "
+           "times one after\n           another\n", psPasses[1].ui32Nodes,
+           (double)psPasses[1].ui64Cycles / psPasses[0].ui64Cycles,
+           psPasses[1].ui32Nodes);
+    bFail |= ((psPasses[1].ui64Cycles * 2) > (psPasses[0].ui64Cycles * 3));
+    printf("check:     %s\n", bFail ? "FAILED" : "ok");
+
+    return(bFail ? 1 : 0);
+}
+#endif
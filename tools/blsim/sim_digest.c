@@ -0,0 +1,173 @@
+//*****************************************************************************
+//
+// sim_digest.c - Checks of the image digest.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DIMAGE_DIGEST, the boot loader's SHA-256 is checked against the FIPS
+// 180-2 test vectors before the run, and the digest of the image that the
+// boot loader returns is read back and checked too.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "blsim.h"
+
+#ifdef IMAGE_DIGEST
+//*****************************************************************************
+//
+// The digest returned by the digest read frame.
+//
+//*****************************************************************************
+static bool g_bDigestRead;
+static uint8_t g_pui8SimDigest[SHA256_DIGEST_SIZE];
+
+//*****************************************************************************
+//
+// Keeps the digest from the reply to the digest read frame.
+//
+//*****************************************************************************
+void
+SimDigestReply(void)
+{
+    if((g_psFrames[g_ui32Frame].ui32Phase == PHASE_STATUS) &&
+       (g_pui8Reply[2] == 0x60) && (g_pui8Reply[3] == 0x04))
+    {
+        memcpy(g_pui8SimDigest, g_pui8Reply + 5, SHA256_DIGEST_SIZE);
+        g_bDigestRead = (g_pui8Reply[4] == COMMAND_RET_SUCCESS);
+    }
+}
+
+//*****************************************************************************
+//
+// Checks the boot loader's SHA-256 against the test vectors of FIPS 180-2,
+// adding the data in pieces of varying sizes so that blocks are completed
+// from both the partial block buffer and the data.  Returns non-zero if any
+// digest is wrong.
+//
+//*****************************************************************************
+int
+SimSHA256Check(void)
+{
+    static const struct
+    {
+        const char *pcData;
+        uint32_t ui32Repeat;
+        const char *pcDigest;
+    }
+    psVectors[] =
+    {
+        { "", 1,
+          "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+        { "abc", 1,
+          "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+        { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+          "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+        { "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmno"
+          "ijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu", 1,
+          "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1" },
+        { "aaaaaaaaaaaaaaaaaaaaaaaaa", 40000,
+          "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+    };
+    tSHA256Context sContext;
+    uint8_t pui8Digest[SHA256_DIGEST_SIZE];
+    char pcHex[(2 * SHA256_DIGEST_SIZE) + 1];
+    uint32_t ui32Idx, ui32Repeat, ui32Offset, ui32Length, ui32Piece;
+    int iFailed;
+
+    iFailed = 0;
+    for(ui32Idx = 0; ui32Idx < (sizeof(psVectors) / sizeof(psVectors[0]));
+        ui32Idx++)
+    {
+        SHA256Init(&sContext);
+        ui32Length = strlen(psVectors[ui32Idx].pcData);
+        ui32Piece = 1;
+        for(ui32Repeat = 0; ui32Repeat < psVectors[ui32Idx].ui32Repeat;
+            ui32Repeat++)
+        {
+            for(ui32Offset = 0; ui32Offset < ui32Length;
+                ui32Offset += ui32Piece)
+            {
+                ui32Piece = (ui32Piece % 71) + 1;
+                if(ui32Piece > (ui32Length - ui32Offset))
+                {
+                    ui32Piece = ui32Length - ui32Offset;
+                }
+                SHA256Update(&sContext,
+                             (const uint8_t *)psVectors[ui32Idx].pcData +
+                             ui32Offset, ui32Piece);
+            }
+        }
+        SHA256Final(&sContext, pui8Digest);
+        for(ui32Offset = 0; ui32Offset < SHA256_DIGEST_SIZE; ui32Offset++)
+        {
+            sprintf(pcHex + (2 * ui32Offset), "%02x", pui8Digest[ui32Offset]);
+        }
+        if(strcmp(pcHex, psVectors[ui32Idx].pcDigest) != 0)
+        {
+            printf("sha256:    vector %u FAILED\n", ui32Idx);
+            iFailed = 1;
+        }
+    }
+    printf("sha256:    %u test vectors %s\n", ui32Idx,
+           iFailed ? "FAILED" : "ok");
+
+    return(iFailed);
+}
+
+//*****************************************************************************
+//
+// Checks the digest that the boot loader returned, computed from its flash
+// as the image was programmed, against a digest of the image computed in one
+// go.  Returns non-zero if they differ.
+//
+//*****************************************************************************
+int
+SimDigestCheck(const uint8_t *pui8Image, uint32_t ui32Size)
+{
+    tSHA256Context sContext;
+    uint8_t pui8Digest[SHA256_DIGEST_SIZE];
+    bool bOk;
+
+    SHA256Init(&sContext);
+    SHA256Update(&sContext, pui8Image, ui32Size);
+#ifdef SIM_MANIFEST
+    //
+    // A manifest session carries on the digest into the parameter block.
+    //
+    if(g_pui8Params)
+    {
+        SHA256Update(&sContext, g_pui8Params, g_ui32ParamsSize);
+    }
+#endif
+    SHA256Final(&sContext, pui8Digest);
+    bOk = (g_bDigestRead &&
+           !memcmp(pui8Digest, g_pui8SimDigest, SHA256_DIGEST_SIZE));
+    printf("digest:    %s\n", bOk ? "ok" : "FAILED");
+
+    return(bOk ? 0 : 1);
+}
+#endif
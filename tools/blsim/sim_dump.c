@@ -0,0 +1,215 @@
+//*****************************************************************************
+//
+// sim_dump.c - Checks of the flash read back.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DENABLE_FLASH_DUMP, the host model reads the image back through
+// 0x600E once it has been programmed, checking the CRC16 of every frame and
+// the data against the image, and reports how close the read back came to
+// the line rate.  It then tries to read the first block of flash, which the
+// flash model marks execute-only, and checks that the read is refused.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "inc/hw_flash.h"
+#include "blsim.h"
+
+#ifdef ENABLE_FLASH_DUMP
+//*****************************************************************************
+//
+// The read back.  The host model reads the image back in frame
+// g_ui32SimDumpFrame, keeping the g_ui32SimDumpReply bytes of the reply in
+// g_pui8SimDump along with the times that the read was sent and that the
+// last of the reply arrived, and then tries to read the execute-only block,
+// keeping the status that the refusal gave.
+//
+//*****************************************************************************
+uint32_t g_ui32SimDumpFrame = 0xffffffff;
+uint32_t g_ui32SimDumpSize;
+uint32_t g_ui32SimDumpReply;
+uint8_t *g_pui8SimDump;
+uint64_t g_ui64SimDumpStart;
+static uint64_t g_ui64SimDumpEnd;
+static uint8_t g_ui8SimDumpRefused = 0xff;
+
+//*****************************************************************************
+//
+// Fills in the payload of a read back of the given region.
+//
+//*****************************************************************************
+void
+SimDumpPayload(uint8_t *pui8Payload, uint32_t ui32Address, uint32_t ui32Size)
+{
+    pui8Payload[0] = (ui32Address >> 24) & 0xff;
+    pui8Payload[1] = (ui32Address >> 16) & 0xff;
+    pui8Payload[2] = (ui32Address >> 8) & 0xff;
+    pui8Payload[3] = ui32Address & 0xff;
+    pui8Payload[4] = (ui32Size >> 24) & 0xff;
+    pui8Payload[5] = (ui32Size >> 16) & 0xff;
+    pui8Payload[6] = (ui32Size >> 8) & 0xff;
+    pui8Payload[7] = ui32Size & 0xff;
+}
+
+//*****************************************************************************
+//
+// Notes when the read back ended, or the status that the read of the
+// execute-only block was refused with.
+//
+//*****************************************************************************
+void
+SimDumpReply(uint64_t ui64Time)
+{
+    if(g_ui32Frame == g_ui32SimDumpFrame)
+    {
+        g_ui64SimDumpEnd = ui64Time;
+    }
+    else if((g_ui32Frame == (g_ui32SimDumpFrame + 1)) &&
+            (g_pui8Reply[3] == 0x0E))
+    {
+        g_ui8SimDumpRefused = g_pui8Reply[4];
+    }
+}
+
+//*****************************************************************************
+//
+// Marks every block of flash readable, other than the first, which holds the
+// boot loader's vector table and is marked execute-only.
+//
+//*****************************************************************************
+void
+SimDumpProtect(void)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < (SIM_FLASH_SIZE / (SIM_DUMP_BLOCK * 32));
+        ui32Idx++)
+    {
+        SimRegFind(FLASH_FMPRE0 + (ui32Idx * 4))->ui32Value = 0xffffffff;
+    }
+    SimRegFind(FLASH_FMPRE0 + ((SIM_DUMP_ADDRESS / (SIM_DUMP_BLOCK * 32)) *
+                               4))->ui32Value &=
+        ~(1 << ((SIM_DUMP_ADDRESS / SIM_DUMP_BLOCK) % 32));
+}
+
+//*****************************************************************************
+//
+// Checks the read back of the image: that every frame carries the next part
+// of it with a good CRC16, and that the data matches the image, padded with
+// erased bytes to a whole number of words.  Then checks that the read of the
+// execute-only block was refused.  Without FLASH_CODE_PROTECTION the time
+// that the read back took is reported against the line rate; with it, both
+// reads must have been refused.  Returns non-zero on a failure.
+//
+//*****************************************************************************
+int
+SimDumpCheck(const uint8_t *pui8Image, uint32_t ui32Size)
+{
+    uint32_t ui32Offset, ui32Address, ui32Length, ui32Frames, ui32Idx;
+    uint8_t *pui8Frame;
+    double dSeconds;
+    bool bCRC, bData, bRefused;
+
+    if(g_ui32SimDumpFrame == 0xffffffff)
+    {
+        return(0);
+    }
+
+#ifdef FLASH_CODE_PROTECTION
+    bRefused = ((g_pui8SimDump[4] == COMMAND_RET_INVALID_CMD) &&
+                (g_ui8SimDumpRefused == COMMAND_RET_INVALID_CMD));
+    printf("dump:      refused with FLASH_CODE_PROTECTION, %s\n",
+           bRefused ? "ok" : "FAILED");
+    (void)pui8Image;
+    (void)ui32Size;
+    (void)ui32Offset;
+    (void)ui32Address;
+    (void)ui32Length;
+    (void)ui32Frames;
+    (void)ui32Idx;
+    (void)pui8Frame;
+    (void)dSeconds;
+    (void)bCRC;
+    (void)bData;
+
+    return(bRefused ? 0 : 1);
+#else
+    ui32Offset = 0;
+    ui32Address = APP_START_ADDRESS;
+    ui32Frames = 0;
+    bCRC = true;
+    bData = true;
+    while(ui32Address < (APP_START_ADDRESS + g_ui32SimDumpSize))
+    {
+        pui8Frame = g_pui8SimDump + ui32Offset;
+        ui32Length = (pui8Frame[9] << 8) | pui8Frame[10];
+        if(((ui32Offset + DUMP_HEADER_SIZE + 2) > g_ui32SimDumpReply) ||
+           ((ui32Offset + DUMP_HEADER_SIZE + ui32Length + 2) >
+            g_ui32SimDumpReply) || (pui8Frame[3] != 0x0E) ||
+           (pui8Frame[4] != COMMAND_RET_SUCCESS) ||
+           ((uint32_t)((pui8Frame[5] << 24) | (pui8Frame[6] << 16) |
+                       (pui8Frame[7] << 8) | pui8Frame[8]) != ui32Address) ||
+           !ui32Length || (ui32Length > DUMP_FRAME_SIZE))
+        {
+            bData = false;
+            break;
+        }
+        if(SimCRC16(pui8Frame, DUMP_HEADER_SIZE + ui32Length) !=
+           (uint32_t)((pui8Frame[DUMP_HEADER_SIZE + ui32Length] << 8) |
+                      pui8Frame[DUMP_HEADER_SIZE + ui32Length + 1]))
+        {
+            bCRC = false;
+        }
+        for(ui32Idx = 0; ui32Idx < ui32Length; ui32Idx++)
+        {
+            if(pui8Frame[DUMP_HEADER_SIZE + ui32Idx] !=
+               (((ui32Address - APP_START_ADDRESS + ui32Idx) < ui32Size) ?
+                pui8Image[ui32Address - APP_START_ADDRESS + ui32Idx] : 0xff))
+            {
+                bData = false;
+            }
+        }
+        ui32Address += ui32Length;
+        ui32Offset += DUMP_HEADER_SIZE + ui32Length + 2;
+        ui32Frames++;
+    }
+    bData = bData && (ui32Offset == g_ui32SimDumpReply);
+
+    dSeconds = CyclesToSeconds(g_ui64SimDumpEnd - g_ui64SimDumpStart);
+    printf("dump:      %u bytes in %u frames, %.3f ms, %.0f bytes/s, "
+           "%.1f%% of the line\n", g_ui32SimDumpSize, ui32Frames,
+           dSeconds * 1000.0, dSeconds ? (g_ui32SimDumpSize / dSeconds) : 0.0,
+           dSeconds ? ((g_ui32SimDumpSize * 1000.0) /
+                       (dSeconds * g_ui32BaudRate)) : 0.0);
+    bRefused = (g_ui8SimDumpRefused == COMMAND_RET_INVALID_ADR);
+    printf("dump:      CRC %s, data %s, execute-only block %s\n",
+           bCRC ? "ok" : "FAILED", bData ? "ok" : "FAILED",
+           bRefused ? "refused, ok" : "FAILED");
+
+    return((bCRC && bData && bRefused) ? 0 : 1);
+#endif
+}
+#endif
@@ -0,0 +1,1825 @@
+//*****************************************************************************
+//
+// sim_emac.c - Models of the Ethernet MAC and of a BOOTP and TFTP server.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DENET_ENABLE_UPDATE the simulator runs the boot loader's
+// ConfigureEnet() and UpdateBOOTP() against a model of the Ethernet MAC and
+// its DMA engine, connected by a 100 Mbit/s full duplex link to a model of a
+// BOOTP and TFTP server, in place of Updater() and the UART.
+//
+// The DMA engine model walks the boot loader's own descriptor rings from the
+// addresses written to the descriptor list registers, following the chain
+// links.  A frame from the link passes the MAC's address filter, is dropped
+// if its FCS is wrong, and waits in the 2 KB receive FIFO until the DMA
+// engine has descriptors to write it to; if the FIFO has no room it is lost.
+// With the MAC's checksum offload on, the extended status of each IPv4 frame
+// reports whether its IP header and UDP checksums are right.  A transmit poll
+// demand sends the frames of the descriptors owned by the DMA engine,
+// inserting the IP and UDP checksums that their descriptors ask for, padding
+// them and appending the FCS.  The DMA engine hands each transmit descriptor
+// back once it has read the frame into the transmit FIFO, rather than once
+// the frame has left it as the real one does, since the boot loader waits
+// for that in memory, where the simulator cannot see time pass.  Each frame
+// takes its preamble, its bytes and the interframe gap on the link.
+//
+// The SysTick interrupt runs the boot loader's SysTickIntHandler() once each
+// period that it is enabled for, which drives the boot loader's retries.
+//
+// The server answers the BOOTP request with the address of the boot loader
+// and the name of the image, resolves the boot loader's address with ARP
+// before the first TFTP transfer, and sends the image with the block size
+// and transfer size options that the boot loader asks for, from a new port
+// for each read request.  It sends each data block once the previous one is
+// acknowledged, ignores repeated acknowledgements, as RFC 1123 requires, and
+// sends a block again if its acknowledgement has not come by the -w timeout.
+// -x damages every <n>th frame that the server sends, in turn with a wrong
+// FCS, which the MAC drops, and with a wrong UDP checksum, which the MAC
+// passes to the boot loader flagged in the extended status for it to drop.
+// The server checks the IP header and UDP checksums of every frame from the
+// boot loader.
+//
+// The check fails if the boot loader's flash does not hold the image, if the
+// server did not see the last block acknowledged, if a frame was lost to a
+// full receive FIFO, if a frame from the boot loader had a wrong checksum or
+// length, or if the server sent more blocks again than it damaged frames.
+//
+//*****************************************************************************
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "inc/hw_emac.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "driverlib/emac.h"
+#include "blsim.h"
+
+#ifdef ENET_ENABLE_UPDATE
+#include "boot_loader/bl_emac.h"
+
+//*****************************************************************************
+//
+// A register of the MAC.
+//
+//*****************************************************************************
+#define SIM_EMAC_REG(ui32Reg)   SimRegFind(EMAC0_BASE + (ui32Reg))->ui32Value
+
+//*****************************************************************************
+//
+// The link rate, the bytes of the preamble and start of frame delimiter, of
+// the interframe gap and of the FCS, the smallest frame without its FCS, the
+// largest with it, and the depth of the MAC's receive FIFO.
+//
+//*****************************************************************************
+#define SIM_EMAC_BIT_RATE       100000000
+#define SIM_EMAC_PREAMBLE       8
+#define SIM_EMAC_GAP            12
+#define SIM_EMAC_FCS            4
+#define SIM_EMAC_MIN_FRAME      60
+#define SIM_EMAC_MAX_FRAME      1518
+#define SIM_EMAC_RX_FIFO        2048
+
+//*****************************************************************************
+//
+// The frames that each direction of the link and the receive FIFO hold at
+// once, and the most receive descriptors that a ring is followed through.
+//
+//*****************************************************************************
+#define SIM_EMAC_QUEUE          8
+#define SIM_EMAC_RING_MAX       64
+
+//*****************************************************************************
+//
+// The fields of the frames that the server reads and writes.  Neither side
+// sends IP options.
+//
+//*****************************************************************************
+#define SIM_ETH_O_DEST          0
+#define SIM_ETH_O_SRC           6
+#define SIM_ETH_O_TYPE          12
+#define SIM_ETH_HDR_LEN         14
+#define SIM_ETH_TYPE_IP         0x0800
+#define SIM_ETH_TYPE_ARP        0x0806
+#define SIM_IP_O_VERLEN         (SIM_ETH_HDR_LEN + 0)
+#define SIM_IP_O_LEN            (SIM_ETH_HDR_LEN + 2)
+#define SIM_IP_O_FRAG           (SIM_ETH_HDR_LEN + 6)
+#define SIM_IP_O_PROTO          (SIM_ETH_HDR_LEN + 9)
+#define SIM_IP_O_CHKSUM         (SIM_ETH_HDR_LEN + 10)
+#define SIM_IP_O_SRC            (SIM_ETH_HDR_LEN + 12)
+#define SIM_IP_O_DEST           (SIM_ETH_HDR_LEN + 16)
+#define SIM_IP_HDR_LEN          20
+#define SIM_IP_PROTO_UDP        17
+#define SIM_UDP_O_SRC           (SIM_ETH_HDR_LEN + SIM_IP_HDR_LEN + 0)
+#define SIM_UDP_O_DEST          (SIM_ETH_HDR_LEN + SIM_IP_HDR_LEN + 2)
+#define SIM_UDP_O_LEN           (SIM_ETH_HDR_LEN + SIM_IP_HDR_LEN + 4)
+#define SIM_UDP_O_CHKSUM        (SIM_ETH_HDR_LEN + SIM_IP_HDR_LEN + 6)
+#define SIM_UDP_HDR_LEN         8
+#define SIM_UDP_O_DATA          (SIM_UDP_O_SRC + SIM_UDP_HDR_LEN)
+#define SIM_ARP_O_OPER          (SIM_ETH_HDR_LEN + 6)
+#define SIM_ARP_O_SHA           (SIM_ETH_HDR_LEN + 8)
+#define SIM_ARP_O_SPA           (SIM_ETH_HDR_LEN + 14)
+#define SIM_ARP_O_THA           (SIM_ETH_HDR_LEN + 18)
+#define SIM_ARP_O_TPA           (SIM_ETH_HDR_LEN + 24)
+#define SIM_ARP_LEN             28
+#define SIM_ARP_REQUEST         1
+#define SIM_ARP_REPLY           2
+#define SIM_BOOTP_O_OP          0
+#define SIM_BOOTP_O_HTYPE       1
+#define SIM_BOOTP_O_HLEN        2
+#define SIM_BOOTP_O_XID         4
+#define SIM_BOOTP_O_FLAGS       10
+#define SIM_BOOTP_O_YIADDR      16
+#define SIM_BOOTP_O_SIADDR      20
+#define SIM_BOOTP_O_CHADDR      28
+#define SIM_BOOTP_O_SNAME       44
+#define SIM_BOOTP_O_FILE        108
+#define SIM_BOOTP_O_VEND        236
+#define SIM_BOOTP_LEN           300
+#define SIM_BOOTP_COOKIE        0x63825363
+#define SIM_BOOTP_SERVER_PORT   67
+#define SIM_BOOTP_CLIENT_PORT   68
+#define SIM_TFTP_PORT           69
+#define SIM_TFTP_RRQ            1
+#define SIM_TFTP_DATA           3
+#define SIM_TFTP_ACK            4
+#define SIM_TFTP_ERROR          5
+#define SIM_TFTP_OACK           6
+
+//*****************************************************************************
+//
+// The server's addresses, the address that it gives the boot loader, the
+// name of the image, the largest block that fits in a frame, and the first
+// port that the server sends a transfer from.
+//
+//*****************************************************************************
+#define SIM_EMAC_SERVER_IP      0xc0a80101
+#define SIM_EMAC_CLIENT_IP      0xc0a80164
+#define SIM_EMAC_FILE           "app.bin"
+#define SIM_EMAC_MAX_BLOCK      (1500 - SIM_IP_HDR_LEN - SIM_UDP_HDR_LEN - 4)
+#define SIM_EMAC_FIRST_TID      49152
+static const uint8_t g_pui8EMACServerMAC[6] =
+{
+    0x02, 0x00, 0x00, 0x00, 0x00, 0x01
+};
+
+//*****************************************************************************
+//
+// The MAC address that the factory programs into the user registers, which
+// the boot loader reads with FlashUserGet().
+//
+//*****************************************************************************
+static const uint8_t g_pui8EMACFactoryMAC[6] =
+{
+    0x00, 0x1a, 0xb6, 0x00, 0x00, 0x01
+};
+
+//*****************************************************************************
+//
+// What the server is waiting for before it sends again: nothing, the boot
+// loader's reply to its ARP request, or the acknowledgement of the block it
+// last sent.
+//
+//*****************************************************************************
+#define SIM_EMAC_IDLE           0
+#define SIM_EMAC_ARP            1
+#define SIM_EMAC_ACK            2
+
+//*****************************************************************************
+//
+// A frame on the link, its FCS included, and the time that its last bit
+// arrives.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t pui8Data[SIM_EMAC_MAX_FRAME];
+    uint32_t ui32Size;
+    uint64_t ui64Arrive;
+}
+tSimEMACFrame;
+
+//*****************************************************************************
+//
+// The frames on their way along one direction of the link, in the order that
+// they arrive, and the time that the link is next free to start one.
+//
+//*****************************************************************************
+typedef struct
+{
+    tSimEMACFrame psFrames[SIM_EMAC_QUEUE];
+    uint32_t ui32Head;
+    uint32_t ui32Count;
+    uint64_t ui64Free;
+}
+tSimEMACLink;
+
+//*****************************************************************************
+//
+// The damage given by -x.
+//
+//*****************************************************************************
+uint32_t g_ui32EMACDamageEvery;
+
+//*****************************************************************************
+//
+// The MAC and DMA engine model: the interrupt status bits that are set, the
+// descriptors that the DMA engine reads next, whether reception is suspended
+// for want of a descriptor, the frames in the receive FIFO and the bytes
+// they take, and the time of one byte on the link.
+//
+//*****************************************************************************
+static uint32_t g_ui32EMACStatus;
+static tEMACDMADescriptor *g_psEMACRxDesc;
+static tEMACDMADescriptor *g_psEMACTxDesc;
+static bool g_bEMACRxSuspended;
+static tSimEMACFrame g_psEMACFIFO[SIM_EMAC_QUEUE];
+static uint32_t g_ui32EMACFIFOHead;
+static uint32_t g_ui32EMACFIFOCount;
+static uint32_t g_ui32EMACFIFOBytes;
+static double g_dEMACByteCycles;
+
+//*****************************************************************************
+//
+// The counts of the frames that the MAC dropped for a wrong FCS or for want
+// of room in the receive FIFO, of those that it flagged with a wrong
+// checksum, and the most receive descriptors that the boot loader held at
+// once out of those in its ring.
+//
+//*****************************************************************************
+static uint32_t g_ui32EMACFCSDrops;
+static uint32_t g_ui32EMACOverflows;
+static uint32_t g_ui32EMACFlagged;
+static uint32_t g_ui32EMACRingUse;
+static uint32_t g_ui32EMACRingSize;
+
+//*****************************************************************************
+//
+// The SysTick interrupt model: the time of the next interrupt, or zero if it
+// is not enabled.
+//
+//*****************************************************************************
+static uint64_t g_ui64EMACTick;
+
+//*****************************************************************************
+//
+// The link: the frames from the boot loader to the server and from the
+// server to the boot loader.
+//
+//*****************************************************************************
+static tSimEMACLink g_sEMACToServer;
+static tSimEMACLink g_sEMACToLoader;
+
+//*****************************************************************************
+//
+// The server model: the image, whether the boot loader is running, the
+// boot loader's address as the server learns it, what the server waits for
+// and until when, the frame that it sends again if nothing comes, the
+// transfer in progress, and the times that the update started, that the
+// first read request came and that the last block was acknowledged.
+//
+//*****************************************************************************
+static const uint8_t *g_pui8EMACImage;
+static uint32_t g_ui32EMACImageSize;
+static bool g_bEMACInRun;
+static uint8_t g_pui8EMACClientMAC[6];
+static bool g_bEMACClientKnown;
+static bool g_bEMACBOOTPSeen;
+static uint32_t g_ui32EMACXID;
+static uint32_t g_ui32EMACAwait;
+static uint64_t g_ui64EMACDeadline;
+static tSimEMACFrame g_sEMACLast;
+static uint32_t g_ui32EMACSessions;
+static uint32_t g_ui32EMACTID;
+static uint32_t g_ui32EMACClientPort;
+static uint32_t g_ui32EMACBlockSize;
+static bool g_bEMACTSize;
+static uint32_t g_ui32EMACBlock;
+static uint32_t g_ui32EMACBlocks;
+static bool g_bEMACDone;
+static uint64_t g_ui64EMACStart;
+static uint64_t g_ui64EMACRequest;
+static uint64_t g_ui64EMACEnd;
+static const char *g_pcEMACError;
+
+//*****************************************************************************
+//
+// The counts of what the server sent, damaged and sent again, of the
+// requests that the boot loader repeated, and of the frames from the boot
+// loader with a wrong checksum or length.
+//
+//*****************************************************************************
+static uint32_t g_ui32EMACSent;
+static uint32_t g_ui32EMACDamaged;
+static uint32_t g_ui32EMACResent;
+static uint32_t g_ui32EMACRepeats;
+static uint32_t g_ui32EMACBadFrames;
+
+//*****************************************************************************
+//
+// Ends the update with an error.  If the boot loader is running, the run is
+// ended too, as it can only be waiting for a server that has given up.
+//
+//*****************************************************************************
+static void
+SimEMACFail(const char *pcError)
+{
+    if(!g_pcEMACError)
+    {
+        g_pcEMACError = pcError;
+    }
+    g_ui32EMACAwait = SIM_EMAC_IDLE;
+    g_ui64EMACDeadline = 0;
+    if(g_bEMACInRun)
+    {
+        g_bEMACInRun = false;
+        longjmp(g_sDone, 1);
+    }
+}
+
+//*****************************************************************************
+//
+// Reads and writes big endian fields of a frame.
+//
+//*****************************************************************************
+static uint32_t
+SimEMACGet16(const uint8_t *pui8Data)
+{
+    return((pui8Data[0] << 8) | pui8Data[1]);
+}
+
+static uint32_t
+SimEMACGet32(const uint8_t *pui8Data)
+{
+    return(((uint32_t)pui8Data[0] << 24) | (pui8Data[1] << 16) |
+           (pui8Data[2] << 8) | pui8Data[3]);
+}
+
+static void
+SimEMACPut16(uint8_t *pui8Data, uint32_t ui32Value)
+{
+    pui8Data[0] = ui32Value >> 8;
+    pui8Data[1] = ui32Value;
+}
+
+static void
+SimEMACPut32(uint8_t *pui8Data, uint32_t ui32Value)
+{
+    pui8Data[0] = ui32Value >> 24;
+    pui8Data[1] = ui32Value >> 16;
+    pui8Data[2] = ui32Value >> 8;
+    pui8Data[3] = ui32Value;
+}
+
+//*****************************************************************************
+//
+// Returns the Ethernet FCS of a frame, the CRC-32 of IEEE 802.3.
+//
+//*****************************************************************************
+static uint32_t
+SimEMACCRC32(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint32_t ui32CRC, ui32Bit;
+
+    ui32CRC = 0xffffffff;
+    while(ui32Size--)
+    {
+        ui32CRC ^= *pui8Data++;
+        for(ui32Bit = 0; ui32Bit < 8; ui32Bit++)
+        {
+            ui32CRC = (ui32CRC >> 1) ^ ((ui32CRC & 1) ? 0xedb88320 : 0);
+        }
+    }
+
+    return(~ui32CRC);
+}
+
+//*****************************************************************************
+//
+// Pads a frame to the smallest frame, and appends the FCS to it.
+//
+//*****************************************************************************
+static void
+SimEMACPad(tSimEMACFrame *psFrame)
+{
+    while(psFrame->ui32Size < SIM_EMAC_MIN_FRAME)
+    {
+        psFrame->pui8Data[psFrame->ui32Size++] = 0;
+    }
+}
+
+static void
+SimEMACFCSAppend(tSimEMACFrame *psFrame)
+{
+    uint32_t ui32CRC;
+
+    ui32CRC = SimEMACCRC32(psFrame->pui8Data, psFrame->ui32Size);
+    psFrame->pui8Data[psFrame->ui32Size++] = ui32CRC;
+    psFrame->pui8Data[psFrame->ui32Size++] = ui32CRC >> 8;
+    psFrame->pui8Data[psFrame->ui32Size++] = ui32CRC >> 16;
+    psFrame->pui8Data[psFrame->ui32Size++] = ui32CRC >> 24;
+}
+
+//*****************************************************************************
+//
+// Returns true if the FCS at the end of a frame is right.
+//
+//*****************************************************************************
+static bool
+SimEMACFCSCheck(const tSimEMACFrame *psFrame)
+{
+    uint32_t ui32CRC, ui32Size;
+
+    ui32Size = psFrame->ui32Size - SIM_EMAC_FCS;
+    ui32CRC = SimEMACCRC32(psFrame->pui8Data, ui32Size);
+
+    return((psFrame->pui8Data[ui32Size] == (ui32CRC & 0xff)) &&
+           (psFrame->pui8Data[ui32Size + 1] == ((ui32CRC >> 8) & 0xff)) &&
+           (psFrame->pui8Data[ui32Size + 2] == ((ui32CRC >> 16) & 0xff)) &&
+           (psFrame->pui8Data[ui32Size + 3] == (ui32CRC >> 24)));
+}
+
+//*****************************************************************************
+//
+// Adds bytes to a ones' complement sum, and folds the sum into the 16-bit
+// checksum that goes in a header.
+//
+//*****************************************************************************
+static uint32_t
+SimEMACSum(const uint8_t *pui8Data, uint32_t ui32Size, uint32_t ui32Sum)
+{
+    while(ui32Size > 1)
+    {
+        ui32Sum += SimEMACGet16(pui8Data);
+        pui8Data += 2;
+        ui32Size -= 2;
+    }
+    if(ui32Size)
+    {
+        ui32Sum += pui8Data[0] << 8;
+    }
+
+    return(ui32Sum);
+}
+
+static uint32_t
+SimEMACFold(uint32_t ui32Sum)
+{
+    while(ui32Sum >> 16)
+    {
+        ui32Sum = (ui32Sum & 0xffff) + (ui32Sum >> 16);
+    }
+
+    return(~ui32Sum & 0xffff);
+}
+
+//*****************************************************************************
+//
+// Returns the UDP checksum of the datagram in an IPv4 frame, computed with
+// the checksum field as it is, over the pseudo header if asked to.  A right
+// checksum gives zero.
+//
+//*****************************************************************************
+static uint32_t
+SimEMACUDPSum(const uint8_t *pui8Frame, bool bPseudo)
+{
+    uint32_t ui32Sum, ui32Len;
+
+    ui32Len = SimEMACGet16(pui8Frame + SIM_UDP_O_LEN);
+    ui32Sum = 0;
+    if(bPseudo)
+    {
+        ui32Sum = SimEMACSum(pui8Frame + SIM_IP_O_SRC, 8, 0);
+        ui32Sum += SIM_IP_PROTO_UDP + ui32Len;
+    }
+
+    return(SimEMACFold(SimEMACSum(pui8Frame + SIM_UDP_O_SRC, ui32Len,
+                                  ui32Sum)));
+}
+
+//*****************************************************************************
+//
+// Returns true if a frame of the given size, its FCS not included, holds a
+// whole IPv4 UDP datagram without options or fragments.
+//
+//*****************************************************************************
+static bool
+SimEMACIsUDP(const uint8_t *pui8Frame, uint32_t ui32Size)
+{
+    uint32_t ui32IPLen;
+
+    if((ui32Size < SIM_UDP_O_DATA) ||
+       (SimEMACGet16(pui8Frame + SIM_ETH_O_TYPE) != SIM_ETH_TYPE_IP) ||
+       (pui8Frame[SIM_IP_O_VERLEN] != 0x45) ||
+       (pui8Frame[SIM_IP_O_PROTO] != SIM_IP_PROTO_UDP) ||
+       (SimEMACGet16(pui8Frame + SIM_IP_O_FRAG) & 0x3fff))
+    {
+        return(false);
+    }
+    ui32IPLen = SimEMACGet16(pui8Frame + SIM_IP_O_LEN);
+
+    return((ui32IPLen <= (ui32Size - SIM_ETH_HDR_LEN)) &&
+           (ui32IPLen >= (SIM_IP_HDR_LEN + SIM_UDP_HDR_LEN)) &&
+           (SimEMACGet16(pui8Frame + SIM_UDP_O_LEN) ==
+            (ui32IPLen - SIM_IP_HDR_LEN)));
+}
+
+//*****************************************************************************
+//
+// Queues a frame on one direction of the link, to start once it is ready and
+// the link is free.  Returns the time that its last bit arrives.
+//
+//*****************************************************************************
+static uint64_t
+SimEMACLinkSend(tSimEMACLink *psLink, const tSimEMACFrame *psFrame,
+                uint64_t ui64Ready)
+{
+    tSimEMACFrame *psQueued;
+    uint64_t ui64Start;
+
+    if(psLink->ui32Count == SIM_EMAC_QUEUE)
+    {
+        SimEMACFail("too many frames queued on the link");
+        return(ui64Ready);
+    }
+    psQueued = &psLink->psFrames[(psLink->ui32Head + psLink->ui32Count) %
+                                 SIM_EMAC_QUEUE];
+    psLink->ui32Count++;
+    *psQueued = *psFrame;
+
+    ui64Start = (ui64Ready > psLink->ui64Free) ? ui64Ready : psLink->ui64Free;
+    psQueued->ui64Arrive = ui64Start +
+                           (uint64_t)((SIM_EMAC_PREAMBLE + psFrame->ui32Size) *
+                                      g_dEMACByteCycles);
+    psLink->ui64Free = psQueued->ui64Arrive +
+                       (uint64_t)(SIM_EMAC_GAP * g_dEMACByteCycles);
+
+    return(psQueued->ui64Arrive);
+}
+
+//*****************************************************************************
+//
+// Returns the frame at the head of one direction of the link, or zero if
+// there is none.
+//
+//*****************************************************************************
+static tSimEMACFrame *
+SimEMACLinkHead(tSimEMACLink *psLink)
+{
+    return(psLink->ui32Count ? &psLink->psFrames[psLink->ui32Head] : 0);
+}
+
+static void
+SimEMACLinkPop(tSimEMACLink *psLink)
+{
+    psLink->ui32Head = (psLink->ui32Head + 1) % SIM_EMAC_QUEUE;
+    psLink->ui32Count--;
+}
+
+//*****************************************************************************
+//
+// Returns the descriptor that the DMA engine reads after the given one in a
+// ring that starts at the given address.
+//
+//*****************************************************************************
+static tEMACDMADescriptor *
+SimEMACDescNext(tEMACDMADescriptor *psDesc, bool bChained, bool bEnd,
+                uint32_t ui32List)
+{
+    if(bChained)
+    {
+        return(psDesc->DES3.pLink);
+    }
+    if(bEnd)
+    {
+        return((tEMACDMADescriptor *)(uintptr_t)ui32List);
+    }
+
+    return(psDesc + 1);
+}
+
+static tEMACDMADescriptor *
+SimEMACRxNext(tEMACDMADescriptor *psDesc)
+{
+    return(SimEMACDescNext(psDesc,
+                           (psDesc->ui32Count & DES1_RX_CTRL_CHAINED) != 0,
+                           (psDesc->ui32Count & DES1_RX_CTRL_END_OF_RING) != 0,
+                           SIM_EMAC_REG(EMAC_O_RXDLADDR)));
+}
+
+//*****************************************************************************
+//
+// Notes how many receive descriptors the boot loader holds now that the DMA
+// engine has handed one more to it.
+//
+//*****************************************************************************
+static void
+SimEMACRingUse(void)
+{
+    tEMACDMADescriptor *psFirst, *psDesc;
+    uint32_t ui32Size, ui32Held;
+
+    psFirst = (tEMACDMADescriptor *)(uintptr_t)SIM_EMAC_REG(EMAC_O_RXDLADDR);
+    psDesc = psFirst;
+    ui32Size = 0;
+    ui32Held = 0;
+    do
+    {
+        if(!(psDesc->ui32CtrlStatus & DES0_RX_CTRL_OWN))
+        {
+            ui32Held++;
+        }
+        ui32Size++;
+        psDesc = SimEMACRxNext(psDesc);
+    }
+    while(psDesc && (psDesc != psFirst) && (ui32Size < SIM_EMAC_RING_MAX));
+
+    g_ui32EMACRingSize = ui32Size;
+    if(ui32Held > g_ui32EMACRingUse)
+    {
+        g_ui32EMACRingUse = ui32Held;
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the extended status that the MAC's checksum offload gives a frame,
+// its FCS not included.
+//
+//*****************************************************************************
+static uint32_t
+SimEMACRxChecksum(const uint8_t *pui8Frame, uint32_t ui32Size)
+{
+    uint32_t ui32Ext;
+
+    if(SimEMACGet16(pui8Frame + SIM_ETH_O_TYPE) != SIM_ETH_TYPE_IP)
+    {
+        return(0);
+    }
+    ui32Ext = DES4_RX_STAT_IPV4;
+    if(SimEMACFold(SimEMACSum(pui8Frame + SIM_IP_O_VERLEN, SIM_IP_HDR_LEN,
+                              0)))
+    {
+        ui32Ext |= DES4_RX_STAT_IP_HEADER_ERR;
+    }
+    if(SimEMACIsUDP(pui8Frame, ui32Size))
+    {
+        ui32Ext |= DES4_RX_STAT_PAYLOAD_UDP;
+        if(SimEMACGet16(pui8Frame + SIM_UDP_O_CHKSUM) &&
+           SimEMACUDPSum(pui8Frame, true))
+        {
+            ui32Ext |= DES4_RX_STAT_IP_PAYLOAD_ERR;
+        }
+    }
+    if(ui32Ext & (DES4_RX_STAT_IP_HEADER_ERR | DES4_RX_STAT_IP_PAYLOAD_ERR))
+    {
+        g_ui32EMACFlagged++;
+    }
+
+    return(ui32Ext);
+}
+
+//*****************************************************************************
+//
+// Moves the frames in the receive FIFO to the receive descriptors, for as
+// long as there are descriptors owned by the DMA engine to hold them.
+// Reception is suspended, and the receive buffer unavailable status set,
+// once there are not.
+//
+//*****************************************************************************
+static void
+SimEMACRxDMA(void)
+{
+    tEMACDMADescriptor *psDesc;
+    tSimEMACFrame *psFrame;
+    uint32_t ui32Done, ui32Part, ui32Size, ui32Status, ui32Ext, ui32Descs;
+    bool bExt;
+
+    if(!(SIM_EMAC_REG(EMAC_O_DMAOPMODE) & EMAC_DMAOPMODE_SR) ||
+       !g_psEMACRxDesc)
+    {
+        return;
+    }
+
+    g_bEMACRxSuspended = false;
+    bExt = ((SIM_EMAC_REG(EMAC_O_CFG) & EMAC_CFG_IPC) &&
+            (SIM_EMAC_REG(EMAC_O_DMABUSMOD) & EMAC_DMABUSMOD_ATDS));
+    while(g_ui32EMACFIFOCount)
+    {
+        psFrame = &g_psEMACFIFO[g_ui32EMACFIFOHead];
+
+        //
+        // Only start the frame if there are enough descriptors for all of
+        // it.
+        //
+        psDesc = g_psEMACRxDesc;
+        ui32Done = 0;
+        ui32Descs = 0;
+        while(ui32Done < psFrame->ui32Size)
+        {
+            if(!psDesc || !(psDesc->ui32CtrlStatus & DES0_RX_CTRL_OWN) ||
+               !(psDesc->ui32Count & DES1_RX_CTRL_BUFF1_SIZE_M) ||
+               (++ui32Descs > SIM_EMAC_RING_MAX))
+            {
+                break;
+            }
+            ui32Done += psDesc->ui32Count & DES1_RX_CTRL_BUFF1_SIZE_M;
+            psDesc = SimEMACRxNext(psDesc);
+        }
+        if(ui32Done < psFrame->ui32Size)
+        {
+            g_bEMACRxSuspended = true;
+            g_ui32EMACStatus |= EMAC_DMARIS_RU | EMAC_DMARIS_AIS;
+            return;
+        }
+
+        //
+        // Write it, closing each descriptor with its status.
+        //
+        ui32Size = psFrame->ui32Size;
+        ui32Ext = bExt ? SimEMACRxChecksum(psFrame->pui8Data,
+                                           ui32Size - SIM_EMAC_FCS) : 0;
+        for(ui32Done = 0; ui32Done < ui32Size; ui32Done += ui32Part)
+        {
+            psDesc = g_psEMACRxDesc;
+            ui32Part = psDesc->ui32Count & DES1_RX_CTRL_BUFF1_SIZE_M;
+            if(ui32Part > (ui32Size - ui32Done))
+            {
+                ui32Part = ui32Size - ui32Done;
+            }
+            memcpy(psDesc->pvBuffer1, psFrame->pui8Data + ui32Done, ui32Part);
+            ui32Status = 0;
+            if(!ui32Done)
+            {
+                ui32Status |= DES0_RX_STAT_FIRST_DESC;
+            }
+            if((ui32Done + ui32Part) == ui32Size)
+            {
+                ui32Status |= (DES0_RX_STAT_LAST_DESC |
+                               DES0_RX_STAT_FRAME_TYPE |
+                               (ui32Size << DES0_RX_STAT_FRAME_LENGTH_S));
+                if(ui32Ext)
+                {
+                    psDesc->ui32ExtRxStatus = ui32Ext;
+                    ui32Status |= DES0_RX_STAT_EXT_AVAILABLE;
+                }
+            }
+            psDesc->ui32CtrlStatus = ui32Status;
+            g_psEMACRxDesc = SimEMACRxNext(psDesc);
+        }
+        SimEMACRingUse();
+
+        g_ui32EMACFIFOBytes -= ui32Size;
+        g_ui32EMACFIFOHead = (g_ui32EMACFIFOHead + 1) % SIM_EMAC_QUEUE;
+        g_ui32EMACFIFOCount--;
+        g_ui32EMACStatus |= EMAC_DMARIS_RI | EMAC_DMARIS_NIS;
+    }
+}
+
+//*****************************************************************************
+//
+// Takes a frame from the link into the MAC, which drops it unless it is for
+// the MAC's address or is a broadcast, if its FCS is wrong, or if the
+// receive FIFO has no room for it.
+//
+//*****************************************************************************
+static void
+SimEMACRxFrame(const tSimEMACFrame *psFrame)
+{
+    uint32_t ui32High, ui32Low;
+    uint8_t pui8MAC[6];
+
+    if(!g_bEMACInRun || !(SIM_EMAC_REG(EMAC_O_CFG) & EMAC_CFG_RE))
+    {
+        return;
+    }
+
+    ui32Low = SIM_EMAC_REG(EMAC_O_ADDR0L);
+    ui32High = SIM_EMAC_REG(EMAC_O_ADDR0H);
+    pui8MAC[0] = ui32Low;
+    pui8MAC[1] = ui32Low >> 8;
+    pui8MAC[2] = ui32Low >> 16;
+    pui8MAC[3] = ui32Low >> 24;
+    pui8MAC[4] = ui32High;
+    pui8MAC[5] = ui32High >> 8;
+    if(memcmp(psFrame->pui8Data + SIM_ETH_O_DEST, pui8MAC, 6) &&
+       memcmp(psFrame->pui8Data + SIM_ETH_O_DEST, "\377\377\377\377\377\377",
+              6))
+    {
+        return;
+    }
+
+    if(!SimEMACFCSCheck(psFrame))
+    {
+        g_ui32EMACFCSDrops++;
+        return;
+    }
+
+    if((g_ui32EMACFIFOCount == SIM_EMAC_QUEUE) ||
+       ((g_ui32EMACFIFOBytes + psFrame->ui32Size) > SIM_EMAC_RX_FIFO))
+    {
+        g_ui32EMACOverflows++;
+        return;
+    }
+    g_psEMACFIFO[(g_ui32EMACFIFOHead + g_ui32EMACFIFOCount) %
+                 SIM_EMAC_QUEUE] = *psFrame;
+    g_ui32EMACFIFOCount++;
+    g_ui32EMACFIFOBytes += psFrame->ui32Size;
+
+    SimEMACRxDMA();
+}
+
+//*****************************************************************************
+//
+// Sends the frames of the transmit descriptors owned by the DMA engine, as a
+// transmit poll demand does, handing each descriptor back once its frame is
+// in the transmit FIFO.
+//
+//*****************************************************************************
+static void
+SimEMACTxDMA(void)
+{
+    tEMACDMADescriptor *psDesc;
+    tSimEMACFrame sFrame;
+    uint32_t ui32Ctrl, ui32Part, ui32CIC, ui32Sum;
+
+    if(!(SIM_EMAC_REG(EMAC_O_DMAOPMODE) & EMAC_DMAOPMODE_ST) ||
+       !(SIM_EMAC_REG(EMAC_O_CFG) & EMAC_CFG_TE))
+    {
+        return;
+    }
+
+    sFrame.ui32Size = 0;
+    while(g_psEMACTxDesc &&
+          (g_psEMACTxDesc->ui32CtrlStatus & DES0_TX_CTRL_OWN))
+    {
+        psDesc = g_psEMACTxDesc;
+        ui32Ctrl = psDesc->ui32CtrlStatus;
+        if(ui32Ctrl & DES0_TX_CTRL_FIRST_SEG)
+        {
+            sFrame.ui32Size = 0;
+        }
+        ui32Part = ((psDesc->ui32Count & DES1_TX_CTRL_BUFF1_SIZE_M) >>
+                    DES1_TX_CTRL_BUFF1_SIZE_S);
+        if((sFrame.ui32Size + ui32Part) > (SIM_EMAC_MAX_FRAME - SIM_EMAC_FCS))
+        {
+            SimEMACFail("the boot loader sent a frame that is too long");
+            return;
+        }
+        memcpy(sFrame.pui8Data + sFrame.ui32Size, psDesc->pvBuffer1,
+               ui32Part);
+        sFrame.ui32Size += ui32Part;
+
+        psDesc->ui32CtrlStatus = ui32Ctrl & ~DES0_TX_CTRL_OWN;
+        g_psEMACTxDesc = SimEMACDescNext(psDesc,
+                                         (ui32Ctrl &
+                                          DES0_TX_CTRL_CHAINED) != 0,
+                                         (ui32Ctrl &
+                                          DES0_TX_CTRL_END_OF_RING) != 0,
+                                         SIM_EMAC_REG(EMAC_O_TXDLADDR));
+        if(!(ui32Ctrl & DES0_TX_CTRL_LAST_SEG))
+        {
+            continue;
+        }
+
+        //
+        // Insert the checksums that the descriptor asks for.
+        //
+        ui32CIC = ui32Ctrl & DES0_TX_CTRL_CHKSUM_M;
+        if((ui32CIC != DES0_TX_CTRL_NO_CHKSUM) &&
+           (SimEMACGet16(sFrame.pui8Data + SIM_ETH_O_TYPE) ==
+            SIM_ETH_TYPE_IP) &&
+           (sFrame.ui32Size >= (SIM_ETH_HDR_LEN + SIM_IP_HDR_LEN)))
+        {
+            SimEMACPut16(sFrame.pui8Data + SIM_IP_O_CHKSUM, 0);
+            SimEMACPut16(sFrame.pui8Data + SIM_IP_O_CHKSUM,
+                         SimEMACFold(SimEMACSum(sFrame.pui8Data +
+                                                SIM_IP_O_VERLEN,
+                                                SIM_IP_HDR_LEN, 0)));
+            if((ui32CIC != DES0_TX_CTRL_IP_HDR_CHKSUM) &&
+               SimEMACIsUDP(sFrame.pui8Data, sFrame.ui32Size))
+            {
+                if(ui32CIC == DES0_TX_CTRL_IP_ALL_CKHSUMS)
+                {
+                    SimEMACPut16(sFrame.pui8Data + SIM_UDP_O_CHKSUM, 0);
+                }
+                ui32Sum = SimEMACUDPSum(sFrame.pui8Data,
+                                        ui32CIC ==
+                                        DES0_TX_CTRL_IP_ALL_CKHSUMS);
+                SimEMACPut16(sFrame.pui8Data + SIM_UDP_O_CHKSUM,
+                             ui32Sum ? ui32Sum : 0xffff);
+            }
+        }
+        if(!(ui32Ctrl & DES0_TX_CTRL_DISABLE_PADDING))
+        {
+            SimEMACPad(&sFrame);
+        }
+        if(!(ui32Ctrl & DES0_TX_CTRL_DISABLE_CRC))
+        {
+            SimEMACFCSAppend(&sFrame);
+        }
+        if(ui32Ctrl & DES0_TX_CTRL_INTERRUPT)
+        {
+            g_ui32EMACStatus |= EMAC_DMARIS_TI | EMAC_DMARIS_NIS;
+        }
+        SimEMACLinkSend(&g_sEMACToServer, &sFrame, g_ui64Now);
+        sFrame.ui32Size = 0;
+    }
+}
+
+//*****************************************************************************
+//
+// Resets the MAC and its DMA engine, as setting the DMA software reset bit
+// does.
+//
+//*****************************************************************************
+static void
+SimEMACReset(void)
+{
+    g_ui32EMACStatus = 0;
+    g_psEMACRxDesc = 0;
+    g_psEMACTxDesc = 0;
+    g_bEMACRxSuspended = false;
+    g_ui32EMACFIFOCount = 0;
+    g_ui32EMACFIFOBytes = 0;
+    SIM_EMAC_REG(EMAC_O_CFG) = 0;
+    SIM_EMAC_REG(EMAC_O_DMAOPMODE) = 0;
+    SIM_EMAC_REG(EMAC_O_RXDLADDR) = 0;
+    SIM_EMAC_REG(EMAC_O_TXDLADDR) = 0;
+}
+
+//*****************************************************************************
+//
+// Sends a frame from the server, built without its FCS, once the server has
+// turned around from the frame it is answering.  Every -x'th frame is
+// damaged, in turn with a wrong FCS and with a wrong UDP checksum.  If the
+// server waits for an answer, the frame is kept to send again.
+//
+//*****************************************************************************
+static void
+SimEMACServerSend(tSimEMACFrame *psFrame, uint64_t ui64Time, bool bAwait)
+{
+    tSimEMACFrame sSent;
+    uint32_t ui32Last;
+
+    if(bAwait)
+    {
+        g_sEMACLast = *psFrame;
+        g_ui64EMACDeadline = ui64Time + g_ui64Turnaround + g_ui64HostTimeout;
+    }
+
+    sSent = *psFrame;
+    SimEMACPad(&sSent);
+    g_ui32EMACSent++;
+    if(g_ui32EMACDamageEvery && !(g_ui32EMACSent % g_ui32EMACDamageEvery))
+    {
+        g_ui32EMACDamaged++;
+        if((g_ui32EMACDamaged & 1) ||
+           !SimEMACIsUDP(sSent.pui8Data, sSent.ui32Size))
+        {
+            SimEMACFCSAppend(&sSent);
+            sSent.pui8Data[SIM_ETH_HDR_LEN] ^= 0x01;
+        }
+        else
+        {
+            ui32Last = SIM_ETH_HDR_LEN +
+                       SimEMACGet16(sSent.pui8Data + SIM_IP_O_LEN) - 1;
+            sSent.pui8Data[ui32Last] ^= 0x01;
+            SimEMACFCSAppend(&sSent);
+        }
+    }
+    else
+    {
+        SimEMACFCSAppend(&sSent);
+    }
+
+    SimEMACLinkSend(&g_sEMACToLoader, &sSent, ui64Time + g_ui64Turnaround);
+}
+
+//*****************************************************************************
+//
+// Builds the Ethernet, IP and UDP headers of a frame from the server whose
+// UDP payload has been written, with its checksums.
+//
+//*****************************************************************************
+static void
+SimEMACUDPBuild(tSimEMACFrame *psFrame, const uint8_t *pui8DestMAC,
+                uint32_t ui32DestIP, uint32_t ui32SrcPort,
+                uint32_t ui32DestPort, uint32_t ui32Len)
+{
+    uint8_t *pui8Frame;
+
+    pui8Frame = psFrame->pui8Data;
+    memcpy(pui8Frame + SIM_ETH_O_DEST, pui8DestMAC, 6);
+    memcpy(pui8Frame + SIM_ETH_O_SRC, g_pui8EMACServerMAC, 6);
+    SimEMACPut16(pui8Frame + SIM_ETH_O_TYPE, SIM_ETH_TYPE_IP);
+    memset(pui8Frame + SIM_IP_O_VERLEN, 0, SIM_IP_HDR_LEN);
+    pui8Frame[SIM_IP_O_VERLEN] = 0x45;
+    SimEMACPut16(pui8Frame + SIM_IP_O_LEN,
+                 SIM_IP_HDR_LEN + SIM_UDP_HDR_LEN + ui32Len);
+    pui8Frame[SIM_IP_O_VERLEN + 8] = 64;
+    pui8Frame[SIM_IP_O_PROTO] = SIM_IP_PROTO_UDP;
+    SimEMACPut32(pui8Frame + SIM_IP_O_SRC, SIM_EMAC_SERVER_IP);
+    SimEMACPut32(pui8Frame + SIM_IP_O_DEST, ui32DestIP);
+    SimEMACPut16(pui8Frame + SIM_IP_O_CHKSUM,
+                 SimEMACFold(SimEMACSum(pui8Frame + SIM_IP_O_VERLEN,
+                                        SIM_IP_HDR_LEN, 0)));
+    SimEMACPut16(pui8Frame + SIM_UDP_O_SRC, ui32SrcPort);
+    SimEMACPut16(pui8Frame + SIM_UDP_O_DEST, ui32DestPort);
+    SimEMACPut16(pui8Frame + SIM_UDP_O_LEN, SIM_UDP_HDR_LEN + ui32Len);
+    SimEMACPut16(pui8Frame + SIM_UDP_O_CHKSUM, 0);
+    SimEMACPut16(pui8Frame + SIM_UDP_O_CHKSUM,
+                 SimEMACUDPSum(pui8Frame, true) ?
+                 SimEMACUDPSum(pui8Frame, true) : 0xffff);
+    psFrame->ui32Size = SIM_UDP_O_DATA + ui32Len;
+}
+
+//*****************************************************************************
+//
+// Sends an ARP packet from the server.
+//
+//*****************************************************************************
+static void
+SimEMACARPSend(uint32_t ui32Oper, const uint8_t *pui8DestMAC,
+               uint32_t ui32DestIP, uint64_t ui64Time)
+{
+    static const uint8_t pui8Header[6] =
+    {
+        0x00, 0x01, 0x08, 0x00, 0x06, 0x04
+    };
+    tSimEMACFrame sFrame;
+    uint8_t *pui8Frame;
+
+    pui8Frame = sFrame.pui8Data;
+    if(ui32Oper == SIM_ARP_REQUEST)
+    {
+        memset(pui8Frame + SIM_ETH_O_DEST, 0xff, 6);
+        memset(pui8Frame + SIM_ARP_O_THA, 0, 6);
+    }
+    else
+    {
+        memcpy(pui8Frame + SIM_ETH_O_DEST, pui8DestMAC, 6);
+        memcpy(pui8Frame + SIM_ARP_O_THA, pui8DestMAC, 6);
+    }
+    memcpy(pui8Frame + SIM_ETH_O_SRC, g_pui8EMACServerMAC, 6);
+    SimEMACPut16(pui8Frame + SIM_ETH_O_TYPE, SIM_ETH_TYPE_ARP);
+    memcpy(pui8Frame + SIM_ETH_HDR_LEN, pui8Header, 6);
+    SimEMACPut16(pui8Frame + SIM_ARP_O_OPER, ui32Oper);
+    memcpy(pui8Frame + SIM_ARP_O_SHA, g_pui8EMACServerMAC, 6);
+    SimEMACPut32(pui8Frame + SIM_ARP_O_SPA, SIM_EMAC_SERVER_IP);
+    SimEMACPut32(pui8Frame + SIM_ARP_O_TPA, ui32DestIP);
+    sFrame.ui32Size = SIM_ETH_HDR_LEN + SIM_ARP_LEN;
+
+    SimEMACServerSend(&sFrame, ui64Time, ui32Oper == SIM_ARP_REQUEST);
+}
+
+//*****************************************************************************
+//
+// Sends the option acknowledgement of a read request, or the first block if
+// the boot loader asked for no options.
+//
+//*****************************************************************************
+static void SimEMACDataSend(uint64_t ui64Time);
+
+static void
+SimEMACOptionsSend(uint64_t ui64Time)
+{
+    tSimEMACFrame sFrame;
+    uint8_t *pui8Data;
+    uint32_t ui32Len;
+
+    g_ui32EMACBlock = 0;
+    g_ui32EMACBlocks = (g_ui32EMACImageSize / g_ui32EMACBlockSize) + 1;
+    g_ui32EMACAwait = SIM_EMAC_ACK;
+    if((g_ui32EMACBlockSize == 512) && !g_bEMACTSize)
+    {
+        SimEMACDataSend(ui64Time);
+        return;
+    }
+
+    pui8Data = sFrame.pui8Data + SIM_UDP_O_DATA;
+    SimEMACPut16(pui8Data, SIM_TFTP_OACK);
+    ui32Len = 2;
+    ui32Len += sprintf((char *)pui8Data + ui32Len, "blksize") + 1;
+    ui32Len += sprintf((char *)pui8Data + ui32Len, "%u",
+                       g_ui32EMACBlockSize) + 1;
+    if(g_bEMACTSize)
+    {
+        ui32Len += sprintf((char *)pui8Data + ui32Len, "tsize") + 1;
+        ui32Len += sprintf((char *)pui8Data + ui32Len, "%u",
+                           g_ui32EMACImageSize) + 1;
+    }
+    SimEMACUDPBuild(&sFrame, g_pui8EMACClientMAC, SIM_EMAC_CLIENT_IP,
+                    g_ui32EMACTID, g_ui32EMACClientPort, ui32Len);
+    SimEMACServerSend(&sFrame, ui64Time, true);
+}
+
+//*****************************************************************************
+//
+// Sends the block after the one last acknowledged.
+//
+//*****************************************************************************
+static void
+SimEMACDataSend(uint64_t ui64Time)
+{
+    tSimEMACFrame sFrame;
+    uint32_t ui32Offset, ui32Len;
+
+    g_ui32EMACBlock++;
+    ui32Offset = (g_ui32EMACBlock - 1) * g_ui32EMACBlockSize;
+    ui32Len = g_ui32EMACImageSize - ui32Offset;
+    if(ui32Len > g_ui32EMACBlockSize)
+    {
+        ui32Len = g_ui32EMACBlockSize;
+    }
+    SimEMACPut16(sFrame.pui8Data + SIM_UDP_O_DATA, SIM_TFTP_DATA);
+    SimEMACPut16(sFrame.pui8Data + SIM_UDP_O_DATA + 2, g_ui32EMACBlock);
+    memcpy(sFrame.pui8Data + SIM_UDP_O_DATA + 4,
+           g_pui8EMACImage + ui32Offset, ui32Len);
+    SimEMACUDPBuild(&sFrame, g_pui8EMACClientMAC, SIM_EMAC_CLIENT_IP,
+                    g_ui32EMACTID, g_ui32EMACClientPort, 4 + ui32Len);
+    SimEMACServerSend(&sFrame, ui64Time, true);
+}
+
+//*****************************************************************************
+//
+// Answers a BOOTP request with the boot loader's address and the name of the
+// image.
+//
+//*****************************************************************************
+static void
+SimEMACBOOTPReceive(const uint8_t *pui8Frame, uint32_t ui32Len,
+                    uint64_t ui64Time)
+{
+    const uint8_t *pui8Request;
+    tSimEMACFrame sFrame;
+    uint8_t *pui8Reply;
+
+    pui8Request = pui8Frame + SIM_UDP_O_DATA;
+    if((ui32Len < (SIM_BOOTP_O_VEND + 4)) ||
+       (pui8Request[SIM_BOOTP_O_OP] != 1) ||
+       (pui8Request[SIM_BOOTP_O_HTYPE] != 1) ||
+       (pui8Request[SIM_BOOTP_O_HLEN] != 6) ||
+       memcmp(pui8Request + SIM_BOOTP_O_CHADDR, pui8Frame + SIM_ETH_O_SRC,
+              6) ||
+       (SimEMACGet32(pui8Request + SIM_BOOTP_O_VEND) != SIM_BOOTP_COOKIE))
+    {
+        g_ui32EMACBadFrames++;
+        return;
+    }
+    if(g_bEMACBOOTPSeen)
+    {
+        g_ui32EMACRepeats++;
+    }
+    g_bEMACBOOTPSeen = true;
+    g_ui32EMACXID = SimEMACGet32(pui8Request + SIM_BOOTP_O_XID);
+    memcpy(g_pui8EMACClientMAC, pui8Frame + SIM_ETH_O_SRC, 6);
+
+    //
+    // The boot loader gets a new lease, so the server looks up its address
+    // again before the next transfer, and stops waiting for the last one.
+    //
+    g_bEMACClientKnown = false;
+    g_ui32EMACAwait = SIM_EMAC_IDLE;
+    g_ui64EMACDeadline = 0;
+
+    pui8Reply = sFrame.pui8Data + SIM_UDP_O_DATA;
+    memset(pui8Reply, 0, SIM_BOOTP_LEN);
+    pui8Reply[SIM_BOOTP_O_OP] = 2;
+    pui8Reply[SIM_BOOTP_O_HTYPE] = 1;
+    pui8Reply[SIM_BOOTP_O_HLEN] = 6;
+    memcpy(pui8Reply + SIM_BOOTP_O_XID, pui8Request + SIM_BOOTP_O_XID, 4);
+    memcpy(pui8Reply + SIM_BOOTP_O_FLAGS, pui8Request + SIM_BOOTP_O_FLAGS, 2);
+    SimEMACPut32(pui8Reply + SIM_BOOTP_O_YIADDR, SIM_EMAC_CLIENT_IP);
+    SimEMACPut32(pui8Reply + SIM_BOOTP_O_SIADDR, SIM_EMAC_SERVER_IP);
+    memcpy(pui8Reply + SIM_BOOTP_O_CHADDR, g_pui8EMACClientMAC, 6);
+    strcpy((char *)pui8Reply + SIM_BOOTP_O_SNAME, "blsim");
+    strcpy((char *)pui8Reply + SIM_BOOTP_O_FILE, SIM_EMAC_FILE);
+    SimEMACPut32(pui8Reply + SIM_BOOTP_O_VEND, SIM_BOOTP_COOKIE);
+    pui8Reply[SIM_BOOTP_O_VEND + 4] = 0xff;
+
+    //
+    // The boot loader asks for a broadcast reply, since it cannot answer an
+    // ARP request until it has its address.
+    //
+    if(SimEMACGet16(pui8Request + SIM_BOOTP_O_FLAGS) & 0x8000)
+    {
+        SimEMACUDPBuild(&sFrame, (const uint8_t *)"\377\377\377\377\377\377",
+                        0xffffffff, SIM_BOOTP_SERVER_PORT,
+                        SIM_BOOTP_CLIENT_PORT, SIM_BOOTP_LEN);
+    }
+    else
+    {
+        SimEMACUDPBuild(&sFrame, g_pui8EMACClientMAC, SIM_EMAC_CLIENT_IP,
+                        SIM_BOOTP_SERVER_PORT, SIM_BOOTP_CLIENT_PORT,
+                        SIM_BOOTP_LEN);
+    }
+    SimEMACServerSend(&sFrame, ui64Time, false);
+}
+
+//*****************************************************************************
+//
+// Starts a transfer for a read request, from a new port.  The server first
+// resolves the boot loader's address with ARP if it does not know it.
+//
+//*****************************************************************************
+static void
+SimEMACRequestReceive(const uint8_t *pui8Frame, uint32_t ui32Len,
+                      uint64_t ui64Time)
+{
+    const char *pcData, *pcEnd, *pcName, *pcValue;
+    uint32_t ui32Value;
+
+    pcData = (const char *)pui8Frame + SIM_UDP_O_DATA + 2;
+    pcEnd = (const char *)pui8Frame + SIM_UDP_O_DATA + ui32Len;
+    if((ui32Len < 4) || (pcEnd[-1] != 0))
+    {
+        g_ui32EMACBadFrames++;
+        return;
+    }
+    if(strcmp(pcData, SIM_EMAC_FILE))
+    {
+        SimEMACFail("the boot loader asked for the wrong file");
+        return;
+    }
+    pcData += strlen(pcData) + 1;
+    if((pcData >= pcEnd) || strcmp(pcData, "octet"))
+    {
+        SimEMACFail("the boot loader asked for a mode other than octet");
+        return;
+    }
+    pcData += strlen(pcData) + 1;
+
+    if(g_ui32EMACSessions)
+    {
+        g_ui32EMACRepeats++;
+    }
+    else
+    {
+        g_ui64EMACRequest = ui64Time;
+    }
+    g_ui32EMACSessions++;
+    g_ui32EMACTID = SIM_EMAC_FIRST_TID + g_ui32EMACSessions;
+    g_ui32EMACClientPort = SimEMACGet16(pui8Frame + SIM_UDP_O_SRC);
+
+    //
+    // Take the options that the server knows.
+    //
+    g_ui32EMACBlockSize = 512;
+    g_bEMACTSize = false;
+    while(pcData < pcEnd)
+    {
+        pcName = pcData;
+        pcData += strlen(pcData) + 1;
+        if(pcData >= pcEnd)
+        {
+            break;
+        }
+        pcValue = pcData;
+        pcData += strlen(pcData) + 1;
+        ui32Value = strtoul(pcValue, 0, 10);
+        if(!strcasecmp(pcName, "blksize") && (ui32Value >= 8))
+        {
+            g_ui32EMACBlockSize = ((ui32Value < SIM_EMAC_MAX_BLOCK) ?
+                                   ui32Value : SIM_EMAC_MAX_BLOCK);
+        }
+        else if(!strcasecmp(pcName, "tsize") && (ui32Value == 0))
+        {
+            g_bEMACTSize = true;
+        }
+    }
+
+    if(!g_bEMACClientKnown)
+    {
+        g_ui32EMACAwait = SIM_EMAC_ARP;
+        SimEMACARPSend(SIM_ARP_REQUEST, 0, SIM_EMAC_CLIENT_IP, ui64Time);
+        return;
+    }
+    SimEMACOptionsSend(ui64Time);
+}
+
+//*****************************************************************************
+//
+// Handles a packet for the transfer in progress.  The next block goes once
+// the last one is acknowledged; a repeated acknowledgement of an earlier one
+// is ignored.
+//
+//*****************************************************************************
+static void
+SimEMACTransferReceive(const uint8_t *pui8Frame, uint32_t ui32Len,
+                       uint64_t ui64Time)
+{
+    const uint8_t *pui8Data;
+    uint32_t ui32Block;
+
+    pui8Data = pui8Frame + SIM_UDP_O_DATA;
+    if((ui32Len < 4) ||
+       (SimEMACGet16(pui8Frame + SIM_UDP_O_SRC) != g_ui32EMACClientPort))
+    {
+        g_ui32EMACBadFrames++;
+        return;
+    }
+    if(SimEMACGet16(pui8Data) == SIM_TFTP_ERROR)
+    {
+        SimEMACFail("the boot loader abandoned the transfer");
+        return;
+    }
+    if(SimEMACGet16(pui8Data) != SIM_TFTP_ACK)
+    {
+        g_ui32EMACBadFrames++;
+        return;
+    }
+
+    ui32Block = SimEMACGet16(pui8Data + 2);
+    if((g_ui32EMACAwait != SIM_EMAC_ACK) ||
+       (ui32Block != (g_ui32EMACBlock & 0xffff)))
+    {
+        g_ui32EMACRepeats++;
+        return;
+    }
+    if(g_ui32EMACBlock == g_ui32EMACBlocks)
+    {
+        g_ui32EMACAwait = SIM_EMAC_IDLE;
+        g_ui64EMACDeadline = 0;
+        g_bEMACDone = true;
+        g_ui64EMACEnd = ui64Time;
+        return;
+    }
+    SimEMACDataSend(ui64Time);
+}
+
+//*****************************************************************************
+//
+// Handles a frame from the boot loader that has reached the server.
+//
+//*****************************************************************************
+static void
+SimEMACServerReceive(const tSimEMACFrame *psFrame)
+{
+    const uint8_t *pui8Frame;
+    uint32_t ui32Size, ui32Len, ui32Port;
+    uint64_t ui64Time;
+
+    pui8Frame = psFrame->pui8Data;
+    ui32Size = psFrame->ui32Size - SIM_EMAC_FCS;
+    ui64Time = psFrame->ui64Arrive;
+    if(g_bEMACDone || !SimEMACFCSCheck(psFrame) ||
+       (memcmp(pui8Frame + SIM_ETH_O_DEST, g_pui8EMACServerMAC, 6) &&
+        memcmp(pui8Frame + SIM_ETH_O_DEST, "\377\377\377\377\377\377", 6)))
+    {
+        return;
+    }
+
+    //
+    // Answer the boot loader's request for the server's address, and take
+    // its answer to the server's.
+    //
+    if(SimEMACGet16(pui8Frame + SIM_ETH_O_TYPE) == SIM_ETH_TYPE_ARP)
+    {
+        if(SimEMACGet16(pui8Frame + SIM_ARP_O_OPER) == SIM_ARP_REQUEST)
+        {
+            if(SimEMACGet32(pui8Frame + SIM_ARP_O_TPA) == SIM_EMAC_SERVER_IP)
+            {
+                SimEMACARPSend(SIM_ARP_REPLY, pui8Frame + SIM_ARP_O_SHA,
+                               SimEMACGet32(pui8Frame + SIM_ARP_O_SPA),
+                               ui64Time);
+            }
+        }
+        else if((SimEMACGet16(pui8Frame + SIM_ARP_O_OPER) == SIM_ARP_REPLY) &&
+                (SimEMACGet32(pui8Frame + SIM_ARP_O_SPA) ==
+                 SIM_EMAC_CLIENT_IP) &&
+                !memcmp(pui8Frame + SIM_ARP_O_SHA, g_pui8EMACClientMAC, 6) &&
+                (g_ui32EMACAwait == SIM_EMAC_ARP))
+        {
+            g_bEMACClientKnown = true;
+            SimEMACOptionsSend(ui64Time);
+        }
+        return;
+    }
+
+    //
+    // Everything else must be a UDP datagram with its checksums filled in.
+    //
+    if(!SimEMACIsUDP(pui8Frame, ui32Size) ||
+       SimEMACFold(SimEMACSum(pui8Frame + SIM_IP_O_VERLEN, SIM_IP_HDR_LEN,
+                              0)) ||
+       !SimEMACGet16(pui8Frame + SIM_UDP_O_CHKSUM) ||
+       SimEMACUDPSum(pui8Frame, true))
+    {
+        g_ui32EMACBadFrames++;
+        return;
+    }
+    ui32Len = SimEMACGet16(pui8Frame + SIM_UDP_O_LEN) - SIM_UDP_HDR_LEN;
+    ui32Port = SimEMACGet16(pui8Frame + SIM_UDP_O_DEST);
+    if(ui32Port == SIM_BOOTP_SERVER_PORT)
+    {
+        SimEMACBOOTPReceive(pui8Frame, ui32Len, ui64Time);
+    }
+    else if(SimEMACGet32(pui8Frame + SIM_IP_O_SRC) != SIM_EMAC_CLIENT_IP)
+    {
+        g_ui32EMACBadFrames++;
+    }
+    else if((ui32Port == SIM_TFTP_PORT) && (ui32Len >= 2) &&
+            (SimEMACGet16(pui8Frame + SIM_UDP_O_DATA) == SIM_TFTP_RRQ))
+    {
+        SimEMACRequestReceive(pui8Frame, ui32Len, ui64Time);
+    }
+    else if(g_ui32EMACSessions && (ui32Port == g_ui32EMACTID))
+    {
+        SimEMACTransferReceive(pui8Frame, ui32Len, ui64Time);
+    }
+    else
+    {
+        g_ui32EMACBadFrames++;
+    }
+}
+
+//*****************************************************************************
+//
+// Starts the server model at the given time.  The boot loader has
+// configured the MAC, and starts the update by asking for its address.
+//
+//*****************************************************************************
+void
+SimEMACStart(uint64_t ui64Start)
+{
+    g_dEMACByteCycles = (g_ui32SysClockHz * 8.0) / SIM_EMAC_BIT_RATE;
+    g_sEMACToServer.ui64Free = ui64Start;
+    g_sEMACToLoader.ui64Free = ui64Start;
+    g_ui64EMACStart = ui64Start;
+    g_bEMACInRun = true;
+}
+
+//*****************************************************************************
+//
+// Makes the given time the next event if it is after the current time and
+// before the next event so far.
+//
+//*****************************************************************************
+static void
+SimEMACEvent(uint64_t *pui64Next, uint64_t ui64Time)
+{
+    if((ui64Time > g_ui64Now) && (!*pui64Next || (ui64Time < *pui64Next)))
+    {
+        *pui64Next = ui64Time;
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the time of the next event in the MAC, on the link or at the
+// server after the current time, or zero if nothing is pending.
+//
+//*****************************************************************************
+uint64_t
+SimEMACNextEvent(void)
+{
+    tSimEMACFrame *psFrame;
+    uint64_t ui64Next;
+
+    ui64Next = 0;
+    SimEMACEvent(&ui64Next, g_ui64EMACDeadline);
+    psFrame = SimEMACLinkHead(&g_sEMACToServer);
+    if(psFrame)
+    {
+        SimEMACEvent(&ui64Next, psFrame->ui64Arrive);
+    }
+    psFrame = SimEMACLinkHead(&g_sEMACToLoader);
+    if(psFrame)
+    {
+        SimEMACEvent(&ui64Next, psFrame->ui64Arrive);
+    }
+    if(g_bEMACInRun)
+    {
+        SimEMACEvent(&ui64Next, g_ui64EMACTick);
+    }
+
+    return(ui64Next);
+}
+
+//*****************************************************************************
+//
+// Brings the MAC, the link, the server and SysTick up to the current time,
+// taking each event in the order that they happened.
+//
+//*****************************************************************************
+void
+SimEMACUpdate(void)
+{
+    tSimEMACFrame *psToServer, *psToLoader;
+    uint64_t ui64Period;
+
+    //
+    // SysTick starts counting when it is enabled with its interrupt.
+    //
+    if((SimRegFind(NVIC_ST_CTRL)->ui32Value &
+        (NVIC_ST_CTRL_ENABLE | NVIC_ST_CTRL_INTEN)) !=
+       (NVIC_ST_CTRL_ENABLE | NVIC_ST_CTRL_INTEN))
+    {
+        g_ui64EMACTick = 0;
+    }
+    else if(!g_ui64EMACTick)
+    {
+        g_ui64EMACTick = (g_ui64Now +
+                          (SimRegFind(NVIC_ST_RELOAD)->ui32Value &
+                           NVIC_ST_RELOAD_M) + 1);
+    }
+
+    while(1)
+    {
+        psToServer = SimEMACLinkHead(&g_sEMACToServer);
+        psToLoader = SimEMACLinkHead(&g_sEMACToLoader);
+        if(psToServer && (psToServer->ui64Arrive <= g_ui64Now) &&
+           (!psToLoader || (psToServer->ui64Arrive <= psToLoader->ui64Arrive)))
+        {
+            SimEMACServerReceive(psToServer);
+            SimEMACLinkPop(&g_sEMACToServer);
+        }
+        else if(psToLoader && (psToLoader->ui64Arrive <= g_ui64Now))
+        {
+            SimEMACRxFrame(psToLoader);
+            SimEMACLinkPop(&g_sEMACToLoader);
+        }
+        else if(g_ui64EMACDeadline && (g_ui64EMACDeadline <= g_ui64Now))
+        {
+            //
+            // Nothing came back in time, so send the last frame again.
+            //
+            g_ui32EMACResent++;
+            SimEMACServerSend(&g_sEMACLast, g_ui64EMACDeadline, true);
+        }
+        else if(g_bEMACInRun && g_ui64EMACTick &&
+                (g_ui64EMACTick <= g_ui64Now))
+        {
+            ui64Period = ((SimRegFind(NVIC_ST_RELOAD)->ui32Value &
+                           NVIC_ST_RELOAD_M) + 1);
+            g_ui64EMACTick += ui64Period;
+            SysTickIntHandler();
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if(g_ui64EMACStart && !g_bEMACDone &&
+       (g_ui64Now > (g_ui64EMACStart +
+                     ((uint64_t)SIM_EMAC_TIME_LIMIT * g_ui32SysClockHz))))
+    {
+        SimEMACFail("the update did not finish in time");
+    }
+}
+
+//*****************************************************************************
+//
+// Returns true if the register is one that the boot loader polls while it
+// waits for a frame.
+//
+//*****************************************************************************
+bool
+SimEMACPolled(uint32_t ui32Address)
+{
+    return((ui32Address == (EMAC0_BASE + EMAC_O_DMARIS)) ||
+           (ui32Address == (EMAC0_BASE + EMAC_O_EPHYRIS)));
+}
+
+//*****************************************************************************
+//
+// Gives the value that a read of a MAC register returns now, returning false
+// if the register is not one that this model keeps.  The interrupt status
+// register also holds the states of the DMA engine, so that a write of the
+// bits to clear is always seen as one, and the poll demand registers read
+// as a mark, so that each write of zero to them is.
+//
+//*****************************************************************************
+bool
+SimEMACRead(uint32_t ui32Address, uint32_t *pui32Value)
+{
+    uint32_t ui32Mode;
+
+    switch(ui32Address)
+    {
+        case EMAC0_BASE + EMAC_O_DMARIS:
+        {
+            ui32Mode = SIM_EMAC_REG(EMAC_O_DMAOPMODE);
+            *pui32Value = g_ui32EMACStatus;
+            if(ui32Mode & EMAC_DMAOPMODE_SR)
+            {
+                *pui32Value |= (g_bEMACRxSuspended ? EMAC_DMARIS_RS_SUSPEND :
+                                                     EMAC_DMARIS_RS_RUNRXD);
+            }
+            if(ui32Mode & EMAC_DMAOPMODE_ST)
+            {
+                *pui32Value |= EMAC_DMARIS_TS_SUSPEND;
+            }
+            SimPoll(ui32Address, *pui32Value);
+            return(true);
+        }
+
+        case EMAC0_BASE + EMAC_O_EPHYRIS:
+        {
+            *pui32Value = 0;
+            return(true);
+        }
+
+        case EMAC0_BASE + EMAC_O_TXPOLLD:
+        case EMAC0_BASE + EMAC_O_RXPOLLD:
+        {
+            *pui32Value = SIM_EMAC_POLL_MARK;
+            return(true);
+        }
+
+        default:
+        {
+            return(false);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Applies the side effects of a write to a MAC register, returning false if
+// the register is not one that this model keeps.
+//
+//*****************************************************************************
+bool
+SimEMACWrite(uint32_t ui32Address, uint32_t ui32Value)
+{
+    switch(ui32Address)
+    {
+        case EMAC0_BASE + EMAC_O_DMABUSMOD:
+        {
+            //
+            // The reset is over by the time the boot loader looks.
+            //
+            if(ui32Value & EMAC_DMABUSMOD_SWR)
+            {
+                SimEMACReset();
+                SIM_EMAC_REG(EMAC_O_DMABUSMOD) =
+                    ui32Value & ~EMAC_DMABUSMOD_SWR;
+            }
+            return(true);
+        }
+
+        case EMAC0_BASE + EMAC_O_DMARIS:
+        {
+            g_ui32EMACStatus &= ~(ui32Value & 0x1ffff);
+            return(true);
+        }
+
+        case EMAC0_BASE + EMAC_O_RXDLADDR:
+        {
+            g_psEMACRxDesc = (tEMACDMADescriptor *)(uintptr_t)ui32Value;
+            return(true);
+        }
+
+        case EMAC0_BASE + EMAC_O_TXDLADDR:
+        {
+            g_psEMACTxDesc = (tEMACDMADescriptor *)(uintptr_t)ui32Value;
+            return(true);
+        }
+
+        case EMAC0_BASE + EMAC_O_TXPOLLD:
+        {
+            SimEMACTxDMA();
+            return(true);
+        }
+
+        case EMAC0_BASE + EMAC_O_RXPOLLD:
+        case EMAC0_BASE + EMAC_O_DMAOPMODE:
+        {
+            SimEMACRxDMA();
+            return(true);
+        }
+
+        default:
+        {
+            return(false);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Stands in for the driverlib function that reads the user registers, which
+// hold the MAC address that the factory programs.
+//
+//*****************************************************************************
+int32_t
+FlashUserGet(uint32_t *pui32User0, uint32_t *pui32User1)
+{
+    *pui32User0 = (g_pui8EMACFactoryMAC[0] | (g_pui8EMACFactoryMAC[1] << 8) |
+                   (g_pui8EMACFactoryMAC[2] << 16));
+    *pui32User1 = (g_pui8EMACFactoryMAC[3] | (g_pui8EMACFactoryMAC[4] << 8) |
+                   (g_pui8EMACFactoryMAC[5] << 16));
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Runs the update and reports the results.  Returns non-zero if the check
+// fails.
+//
+//*****************************************************************************
+int
+SimEMACRun(const uint8_t *pui8Image, uint32_t ui32Size)
+{
+    uint64_t ui64Next;
+    double dSeconds, dTransfer;
+    bool bVerify, bFail;
+
+    g_pui8EMACImage = pui8Image;
+    g_ui32EMACImageSize = ui32Size;
+
+    //
+    // Run the boot loader until it resets to run the image, then let the
+    // last acknowledgement reach the server.
+    //
+    SimRun(true);
+    g_bEMACInRun = false;
+    while(!g_bEMACDone && !g_pcEMACError)
+    {
+        ui64Next = SimEMACNextEvent();
+        if(!ui64Next)
+        {
+            SimEMACFail("the server did not see the last block acknowledged");
+            break;
+        }
+        g_ui64Now = ui64Next;
+        SimEMACUpdate();
+    }
+    if(!g_ui64EMACEnd)
+    {
+        g_ui64EMACEnd = g_ui64Now;
+    }
+
+    //
+    // Report the results.
+    //
+    dSeconds = CyclesToSeconds(g_ui64EMACEnd - g_ui64EMACStart);
+    dTransfer = (g_ui64EMACRequest ?
+                 CyclesToSeconds(g_ui64EMACEnd - g_ui64EMACRequest) : 0.0);
+    bVerify = !memcmp(g_pui8Flash + APP_START_ADDRESS, pui8Image, ui32Size);
+    printf("image:     %u bytes at 0x%08x\n", ui32Size, APP_START_ADDRESS);
+    printf("link:      Ethernet at %u Mbit/s, %u Hz system clock\n",
+           SIM_EMAC_BIT_RATE / 1000000, g_ui32SysClockHz);
+    printf("\n%-9s %12s %12s %8s %8s\n", "phase", "time (ms)", "bytes/s",
+           "blocks", "size");
+    printf("%-9s %12.3f %12s %8s %8s\n", "bootp",
+           (dSeconds - dTransfer) * 1000.0, "", "", "");
+    printf("%-9s %12.3f %12.0f %8u %8u\n", "tftp", dTransfer * 1000.0,
+           dTransfer ? (ui32Size / dTransfer) : 0.0, g_ui32EMACBlocks,
+           g_ui32EMACBlockSize);
+    printf("%-9s %12.3f %12.0f\n\n", "total", dSeconds * 1000.0,
+           dSeconds ? (ui32Size / dSeconds) : 0.0);
+    printf("flash:     %u erase commands, %u words programmed\n",
+           g_ui32Erases, g_ui32Programs);
+    printf("server:    %u frames sent, %u damaged, %u sent again, %u "
+           "repeated requests\n", g_ui32EMACSent, g_ui32EMACDamaged,
+           g_ui32EMACResent, g_ui32EMACRepeats);
+    printf("mac:       %u dropped for their FCS, %u flagged for their "
+           "checksums, %u\n           receive FIFO overflows, at most %u of "
+           "%u receive descriptors held\n", g_ui32EMACFCSDrops,
+           g_ui32EMACFlagged, g_ui32EMACOverflows, g_ui32EMACRingUse,
+           g_ui32EMACRingSize);
+    printf("frames:    %u from the boot loader with a wrong checksum or "
+           "length\n", g_ui32EMACBadFrames);
+    printf("verify:    %s\n", bVerify ? "ok" : "FAILED");
+    if(g_pcEMACError)
+    {
+        printf("enet:      %s\n", g_pcEMACError);
+    }
+    bFail = (!bVerify || !g_bEMACDone || g_pcEMACError ||
+             g_ui32EMACOverflows || g_ui32EMACBadFrames ||
+             (g_ui32EMACResent > g_ui32EMACDamaged));
+    printf("check:     %s\n", bFail ? "FAILED" : "ok");
+
+    return(bFail ? 1 : 0);
+}
+#endif
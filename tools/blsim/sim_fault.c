@@ -0,0 +1,253 @@
+//*****************************************************************************
+//
+// sim_fault.c - Fault injection on the link between the host and the boot
+//               loader.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -F <n>, every n-th data frame that the host model sends is damaged on
+// the way to the boot loader, in turn by dropping one of its bytes, by
+// repeating one, by corrupting one, and by losing the boot loader's reply to
+// it so that the host sends the whole frame again.  The first three should
+// be discarded by the boot loader's packet CRC check and the last should be
+// recognised from the block number of the frame sent again, so the update
+// should still program the image exactly; the verify line shows whether it
+// did.  With -l the frames carry no block number, so the boot loader must
+// instead refuse an image that a frame sent again has moved up, leaving the
+// start of it erased.  The time from each damaged frame to its block being
+// accepted is reported as the recovery latency, most of which is the host
+// timeout set with -w.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "blsim.h"
+
+//*****************************************************************************
+//
+// The kinds of fault, applied in turn.
+//
+//*****************************************************************************
+#define FAULT_DROP              0
+#define FAULT_REPEAT            1
+#define FAULT_CORRUPT           2
+#define FAULT_REPLY_LOST        3
+#define NUM_FAULTS              4
+
+//*****************************************************************************
+//
+// The offset into a frame of the byte that is dropped, repeated or
+// corrupted, which is in the middle of the data of a data frame.
+//
+//*****************************************************************************
+#define FAULT_OFFSET            68
+
+//*****************************************************************************
+//
+// Every this many data frames sent, one is damaged.  Zero damages none.
+//
+//*****************************************************************************
+uint32_t g_ui32FaultEvery;
+
+//*****************************************************************************
+//
+// The data frames sent, the faults injected of each kind, whether the reply
+// to the current frame is to be lost, and the time taken to recover from the
+// faults so far.
+//
+//*****************************************************************************
+static uint32_t g_ui32FaultSends;
+static uint32_t g_pui32Faults[NUM_FAULTS];
+static bool g_bReplyLost;
+static bool g_bRecovering;
+static uint64_t g_ui64FaultStart;
+static uint64_t g_ui64RecoveryTotal;
+static uint64_t g_ui64RecoveryMax;
+static uint32_t g_ui32Recoveries;
+
+//*****************************************************************************
+//
+// Damages a data frame that the host model is about to send, if it is the
+// one due a fault, starting at the given time.  Returns the number of bytes
+// of the frame that are sent.
+//
+//*****************************************************************************
+uint32_t
+SimFaultInject(uint8_t *pui8Data, uint32_t ui32Size, uint64_t ui64Start)
+{
+    uint32_t ui32Fault;
+
+    if(!g_ui32FaultEvery || (++g_ui32FaultSends % g_ui32FaultEvery) ||
+       (ui32Size <= FAULT_OFFSET))
+    {
+        return(ui32Size);
+    }
+
+    //
+    // Time the recovery from the first fault until the block is accepted.
+    //
+    if(!g_bRecovering)
+    {
+        g_bRecovering = true;
+        g_ui64FaultStart = ui64Start;
+    }
+
+    ui32Fault = (g_ui32FaultSends / g_ui32FaultEvery - 1) % NUM_FAULTS;
+    g_pui32Faults[ui32Fault]++;
+    switch(ui32Fault)
+    {
+        case FAULT_DROP:
+        {
+            memmove(pui8Data + FAULT_OFFSET, pui8Data + FAULT_OFFSET + 1,
+                    ui32Size - FAULT_OFFSET - 1);
+            return(ui32Size - 1);
+        }
+
+        case FAULT_REPEAT:
+        {
+            memmove(pui8Data + FAULT_OFFSET + 1, pui8Data + FAULT_OFFSET,
+                    ui32Size - FAULT_OFFSET);
+            return(ui32Size + 1);
+        }
+
+        case FAULT_CORRUPT:
+        {
+            pui8Data[FAULT_OFFSET] ^= 0x10;
+            return(ui32Size);
+        }
+
+        default:
+        {
+            g_bReplyLost = true;
+            return(ui32Size);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Called when the whole reply to the current frame has been sent.  Returns
+// true if the reply was lost on the way back, in which case the host model
+// waits for it until its timeout and then sends the frame again.
+//
+//*****************************************************************************
+bool
+SimFaultReplyLost(void)
+{
+    if(g_bReplyLost)
+    {
+        g_bReplyLost = false;
+        return(true);
+    }
+
+    return(false);
+}
+
+//*****************************************************************************
+//
+// Called when the boot loader has accepted a data block, at the given time,
+// to end the timing of the recovery from any fault before it.
+//
+//*****************************************************************************
+void
+SimFaultRecovered(uint64_t ui64Time)
+{
+    uint64_t ui64Recovery;
+
+    if(g_bRecovering)
+    {
+        g_bRecovering = false;
+        ui64Recovery = ui64Time - g_ui64FaultStart;
+        g_ui64RecoveryTotal += ui64Recovery;
+        g_ui32Recoveries++;
+        if(ui64Recovery > g_ui64RecoveryMax)
+        {
+            g_ui64RecoveryMax = ui64Recovery;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Prints the faults injected and the time taken to recover from them.
+// Returns non-zero if a fault was never recovered from.
+//
+//*****************************************************************************
+int
+SimFaultReport(void)
+{
+    printf("faults:    %u bytes dropped, %u repeated, %u corrupted, "
+           "%u replies lost\n", g_pui32Faults[FAULT_DROP],
+           g_pui32Faults[FAULT_REPEAT], g_pui32Faults[FAULT_CORRUPT],
+           g_pui32Faults[FAULT_REPLY_LOST]);
+    printf("           recovery %.3f ms mean, %.3f ms max\n",
+           g_ui32Recoveries ?
+           (CyclesToSeconds(g_ui64RecoveryTotal) * 1000.0 /
+            g_ui32Recoveries) : 0.0,
+           CyclesToSeconds(g_ui64RecoveryMax) * 1000.0);
+    if(g_bRecovering)
+    {
+        printf("faults:    FAILED (the last fault was never recovered "
+               "from)\n");
+        return(1);
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Checks that the boot loader refused an image that was not programmed
+// exactly, as it must when plain frames sent again have moved part of it up
+// by a block.  The status read must report the refusal and the start of the
+// image must be erased, so that it cannot be run.  Returns non-zero if the
+// boot loader did not refuse the image.
+//
+//*****************************************************************************
+int
+SimFaultRefused(uint32_t ui32Base)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < 4; ui32Idx++)
+    {
+        if(g_pui8Flash[ui32Base + ui32Idx] != 0xff)
+        {
+            break;
+        }
+    }
+    if(!g_bStatsRead || (g_ui8StatsStatus != COMMAND_RET_INVALID_ADR) ||
+       (ui32Idx != 4))
+    {
+        printf("verify:    FAILED (the image was neither programmed nor "
+               "refused)\n");
+        return(1);
+    }
+    printf("verify:    refused (status 0x%02x, start of image erased)\n",
+           g_ui8StatsStatus);
+
+    return(0);
+}
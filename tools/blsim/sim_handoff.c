@@ -0,0 +1,128 @@
+//*****************************************************************************
+//
+// sim_handoff.c - Checks of the warm entry from an application.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DBL_HANDOFF_ADDRESS, the -H option enters the boot loader as an
+// application would through the SVCall vector, leaving a handoff for a UART
+// at the given baud rate instead of starting from reset.  It first checks
+// that a spoiled handoff makes the boot loader configure the clock and UART
+// itself, and that a UART the application left disabled is set up at the
+// handed-off baud rate, then reports how long the warm entry takes and
+// checks that it configured neither.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_uart.h"
+#include "blsim.h"
+
+#ifdef BL_HANDOFF_ADDRESS
+#include "boot_loader/bl_handoff.h"
+
+//*****************************************************************************
+//
+// Leaves a handoff for the boot loader as an application would, for a UART
+// at the given baud rate that is left enabled or not, with the check word
+// spoiled by the given bits, and enters the boot loader through it.  The
+// clock that the application runs at is the one that the simulator starts
+// with.  Returns the number of cycles that the entry took.
+//
+//*****************************************************************************
+#define SIM_APP_CLOCK           120000000
+
+static uint64_t
+SimHandoffEnter(uint32_t ui32Baud, bool bEnabled, uint32_t ui32Spoil)
+{
+    tBLHandoff sHandoff;
+    uint64_t ui64Start;
+
+    sHandoff.ui32Marker = BL_HANDOFF_MARKER;
+    sHandoff.ui32SysClock = SIM_APP_CLOCK;
+    sHandoff.ui32UARTBase = UART0_BASE;
+    sHandoff.ui32BaudRate = ui32Baud;
+    sHandoff.ui32Check = BL_HANDOFF_CHECK(&sHandoff) ^ ui32Spoil;
+    SimRegFind(BL_HANDOFF_ADDRESS + BL_HANDOFF_O_MARKER)->ui32Value =
+        sHandoff.ui32Marker;
+    SimRegFind(BL_HANDOFF_ADDRESS + BL_HANDOFF_O_CLOCK)->ui32Value =
+        sHandoff.ui32SysClock;
+    SimRegFind(BL_HANDOFF_ADDRESS + BL_HANDOFF_O_UART)->ui32Value =
+        sHandoff.ui32UARTBase;
+    SimRegFind(BL_HANDOFF_ADDRESS + BL_HANDOFF_O_BAUD)->ui32Value =
+        sHandoff.ui32BaudRate;
+    SimRegFind(BL_HANDOFF_ADDRESS + BL_HANDOFF_O_CHECK)->ui32Value =
+        sHandoff.ui32Check;
+    SimRegFind(UART0_BASE + UART_O_CTL)->ui32Value =
+        bEnabled ? UART_CTL_UARTEN : 0;
+
+    g_ui32SysClockHz = SIM_APP_CLOCK;
+    g_ui32BaudRate = bEnabled ? ui32Baud : 0;
+    g_ui32ClockSets = 0;
+    g_ui32UARTSets = 0;
+    ui64Start = g_ui64Now;
+    HandoffConfigure();
+
+    return(g_ui64Now - ui64Start);
+}
+
+//*****************************************************************************
+//
+// Enters the boot loader from the application, first with a spoiled
+// handoff, which must leave the clock and UART to be configured as they are
+// after a reset, then with a UART that the application has not enabled,
+// which must be set up at the handed-off baud rate, and then warm, with the
+// clock and the UART taken over as they are.  Reports how long the warm
+// entry took and returns non-zero on a failure.
+//
+//*****************************************************************************
+int
+SimHandoffCheck(uint32_t ui32Baud)
+{
+    uint64_t ui64Cycles;
+    bool bCold, bUART, bWarm;
+
+    SimHandoffEnter(ui32Baud, true, 1);
+    bCold = (g_ui32ClockSets == 1) && (g_ui32UARTSets == 1);
+
+    SimHandoffEnter(ui32Baud, false, 0);
+    bUART = ((g_ui32ClockSets == 0) && (g_ui32UARTSets == 1) &&
+             (g_ui32BaudRate == ui32Baud) &&
+             (g_ui32SysClock == SIM_APP_CLOCK));
+
+    ui64Cycles = SimHandoffEnter(ui32Baud, true, 0);
+    bWarm = ((g_ui32ClockSets == 0) && (g_ui32UARTSets == 0) &&
+             (g_ui32SysClock == SIM_APP_CLOCK) &&
+             !SimRegFind(BL_HANDOFF_ADDRESS + BL_HANDOFF_O_MARKER)->ui32Value);
+
+    printf("handoff:   warm entry in %u cycles (%.3f us), %s; spoiled "
+           "handoff %s; UART left off %s\n", (uint32_t)ui64Cycles,
+           CyclesToSeconds(ui64Cycles) * 1000000.0, bWarm ? "ok" : "FAILED",
+           bCold ? "ok" : "FAILED", bUART ? "ok" : "FAILED");
+
+    return((bCold && bUART && bWarm) ? 0 : 1);
+}
+#endif
@@ -0,0 +1,805 @@
+//*****************************************************************************
+//
+// sim_host.c - Model of the host updater that drives the simulated download.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The model of the host updater.  The whole update is framed in memory
+// before the boot loader starts, and each frame is fed to the UART model once
+// the reply to the one before it has been sent, after the turnaround given by
+// -t.  A frame that gets no complete reply within the timeout given by -w is
+// sent again, as the host tool would.
+//
+// Before resetting the board, the host model reads the boot loader's status
+// and telemetry counters and checks them against what the flash and UART
+// models recorded, so a run that reports "telemetry: FAILED" has found a
+// counter that is not being kept.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "blsim.h"
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+#include "boot_loader/bl_flash.h"
+#endif
+
+//*****************************************************************************
+//
+// The names of the phases of an update.
+//
+//*****************************************************************************
+const char * const g_ppcPhaseNames[NUM_PHASES] =
+{
+    "connect", "erase", "program", "status", "reset"
+};
+
+//*****************************************************************************
+//
+// The host model.
+//
+//*****************************************************************************
+tSimFrame *g_psFrames;
+uint32_t g_ui32NumFrames;
+uint32_t g_ui32Frame;
+uint32_t g_ui32ReplyBytes;
+uint8_t g_pui8Reply[SIM_REPLY_SIZE];
+uint64_t g_ui64ReplyDeadline;
+uint64_t g_ui64Turnaround;
+uint64_t g_ui64HostTimeout;
+uint32_t g_ui32Retries;
+uint32_t g_ui32TotalRetries;
+tSimPhase g_psPhases[NUM_PHASES];
+jmp_buf g_sDone;
+
+//*****************************************************************************
+//
+// Whether the image is sent in plain 0x6006 frames, as by hosts that predate
+// the sequenced 0x6007 frames, and where the data frames are among the
+// frames of the update.
+//
+//*****************************************************************************
+bool g_bPlainData;
+static uint32_t g_ui32DataFrame;
+static uint32_t g_ui32DataFrames;
+static uint32_t g_ui32FirstBlock;
+
+//*****************************************************************************
+//
+// The counters returned by the status frame, and what the simulator had seen
+// when the boot loader answered it.
+//
+//*****************************************************************************
+bool g_bStatsRead;
+static uint32_t g_pui32SimStats[NUM_STATS];
+static uint32_t g_ui32StatsFrame;
+static uint32_t g_ui32StatsPrograms;
+static uint32_t g_ui32StatsErases;
+static uint32_t g_ui32StatsOverruns;
+uint8_t g_ui8StatsStatus;
+
+//*****************************************************************************
+//
+// Calculates the CRC16 that terminates a frame, as ReceivePacket() checks it.
+//
+//*****************************************************************************
+uint32_t
+SimCRC16(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint32_t ui32CRC, ui32Bit;
+
+    ui32CRC = 0xffff;
+    while(ui32Size--)
+    {
+        ui32CRC ^= *pui8Data++;
+        for(ui32Bit = 0; ui32Bit < 8; ui32Bit++)
+        {
+            ui32CRC = (ui32CRC & 1) ? ((ui32CRC >> 1) ^ 0xa001) :
+                                      (ui32CRC >> 1);
+        }
+    }
+
+    return(ui32CRC);
+}
+
+//*****************************************************************************
+//
+// Returns true if a reply of the given size ends with the CRC16 of the rest
+// of it, or is one of the replies that end with a fixed 0x11, 0x22 instead.
+// The progress (0x0400), resume (0x0800), status (0x0006), digest (0x6004),
+// install (0x600B) and erase counter (0x600D) replies carry a CRC16.
+//
+//*****************************************************************************
+bool
+SimReplyIntact(const uint8_t *pui8Reply, uint32_t ui32Size)
+{
+    if(pui8Reply[1] != 0x03)
+    {
+        return(true);
+    }
+    switch((pui8Reply[2] << 8) | pui8Reply[3])
+    {
+        case 0x0400:
+        case 0x0800:
+        case 0x0006:
+        case 0x6004:
+        case 0x600B:
+        case 0x600D:
+        {
+            break;
+        }
+
+        default:
+        {
+            return(true);
+        }
+    }
+
+    return(SimCRC16(pui8Reply, ui32Size - 2) ==
+           (((uint32_t)pui8Reply[ui32Size - 2] << 8) |
+            pui8Reply[ui32Size - 1]));
+}
+
+//*****************************************************************************
+//
+// Builds a frame for the host model to send.
+//
+//*****************************************************************************
+void
+SimFrameBuild(tSimFrame *psFrame, uint8_t ui8Cmd, uint16_t ui16Address,
+              const uint8_t *pui8Payload, uint32_t ui32Payload,
+              uint32_t ui32ReplySize, uint32_t ui32Phase)
+{
+    uint32_t ui32CRC;
+
+    psFrame->pui8Data[0] = SIM_HOST_ID;
+    psFrame->pui8Data[1] = ui8Cmd;
+    psFrame->pui8Data[2] = ui16Address >> 8;
+    psFrame->pui8Data[3] = ui16Address & 0xff;
+    memcpy(&psFrame->pui8Data[4], pui8Payload, ui32Payload);
+    ui32CRC = SimCRC16(psFrame->pui8Data, 4 + ui32Payload);
+    psFrame->pui8Data[4 + ui32Payload] = ui32CRC >> 8;
+    psFrame->pui8Data[5 + ui32Payload] = ui32CRC & 0xff;
+    psFrame->ui32Size = 6 + ui32Payload;
+    psFrame->ui32Payload = ui32Payload;
+    psFrame->ui32ReplySize = ui32ReplySize;
+    psFrame->ui32Phase = ui32Phase;
+}
+
+//*****************************************************************************
+//
+// Frames the whole update in memory: a ping, the download command, one data
+// frame per 128 bytes of the image, a status read and finally a reset.  Each
+// data frame carries its block number, so that the boot loader can tell one
+// sent again from the next, unless plain data frames were asked for.  If
+// the boot loader decrypts the image, the download command is followed by
+// the initial counter block or IV and the image is sent encrypted.  If the
+// image is a new boot loader, it is downloaded to address 0 and the reset is
+// replaced by the command that installs it.  If there is a parameter block,
+// a manifest of the image and the parameter block takes the place of the
+// download command and the parameter block is sent after the image.
+//
+//*****************************************************************************
+void
+SimFramesBuild(const uint8_t *pui8Image, uint32_t ui32Size)
+{
+    uint8_t pui8Payload[130];
+    uint32_t ui32Idx, ui32Offset, ui32Blocks, ui32Address, ui32First;
+#ifdef SIM_MANIFEST
+    uint8_t *pui8Stream;
+    const uint8_t *pui8App;
+    uint32_t ui32AppSize;
+#endif
+#ifdef BL_UPDATE_STAGED
+    tSHA256Context sContext;
+
+    //
+    // The digest that a new boot loader is installed with.
+    //
+    SHA256Init(&sContext);
+    SHA256Update(&sContext, pui8Image, ui32Size);
+#endif
+
+#ifdef SIM_MANIFEST
+    //
+    // The data of a manifest session is the image, padded to a whole number
+    // of blocks, followed by the parameter block.
+    //
+    pui8App = pui8Image;
+    ui32AppSize = ui32Size;
+    pui8Stream = 0;
+    if(g_pui8Params)
+    {
+        ui32Offset = ((ui32Size + 127) / 128) * 128;
+        pui8Stream = malloc(ui32Offset + g_ui32ParamsSize);
+        if(!pui8Stream)
+        {
+            fprintf(stderr, "blsim: out of memory\n");
+            exit(1);
+        }
+        memset(pui8Stream, 0xff, ui32Offset);
+        memcpy(pui8Stream, pui8Image, ui32Size);
+        memcpy(pui8Stream + ui32Offset, g_pui8Params, g_ui32ParamsSize);
+        pui8Image = pui8Stream;
+        ui32Size = ui32Offset + g_ui32ParamsSize;
+    }
+#endif
+
+#ifdef ENABLE_FLASH_DUMP
+    //
+    // The image is read back as it stands in flash, a whole number of words
+    // of it.
+    //
+    g_ui32SimDumpSize = (ui32Size + 3) & ~3;
+#ifdef SIM_MANIFEST
+    g_ui32SimDumpSize = (ui32AppSize + 3) & ~3;
+#endif
+#endif
+
+    ui32First = 0;
+#ifdef BL_WATCHDOG_TIMEOUT
+    if(g_ui32SimResume != 0xffffffff)
+    {
+        ui32First = g_ui32SimResume;
+    }
+#endif
+    ui32Blocks = (ui32Size + 127) / 128;
+    g_ui32NumFrames = ui32Blocks - ui32First + 4;
+#ifdef ENABLE_FLASH_DUMP
+    g_ui32NumFrames += 2;
+#ifdef BL_UPDATE_STAGED
+    if(g_bStaged)
+    {
+        g_ui32NumFrames -= 2;
+    }
+#endif
+#endif
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+    g_ui32NumFrames += SIM_FLASH_BLOCKS / WEAR_REPLY_BLOCKS;
+#endif
+#ifdef IMAGE_DIGEST
+    g_ui32NumFrames++;
+#endif
+#ifdef DECRYPT_AES_MODE
+    g_ui32NumFrames++;
+    pui8Image = SimImageEncrypt(pui8Image, ui32Size);
+#endif
+    g_psFrames = calloc(g_ui32NumFrames, sizeof(tSimFrame));
+    if(!g_psFrames)
+    {
+        fprintf(stderr, "blsim: out of memory\n");
+        exit(1);
+    }
+    ui32Idx = 0;
+
+    //
+    // Ping.
+    //
+    pui8Payload[0] = 0x00;
+    pui8Payload[1] = 0x01;
+    SimFrameBuild(&g_psFrames[ui32Idx++], 0x03, 0x6001, pui8Payload, 2, 9,
+                  PHASE_CONNECT);
+
+    //
+    // Start the download, placing the address and size where Updater()
+    // unpacks them from.
+    //
+    ui32Address = APP_START_ADDRESS;
+#ifdef BL_UPDATE_STAGED
+    if(g_bStaged)
+    {
+        ui32Address = 0;
+    }
+#endif
+    memset(pui8Payload, 0, 11);
+    pui8Payload[1] = 0x04;
+    pui8Payload[4] = ui32Address & 0xff;
+    pui8Payload[5] = (ui32Address >> 8) & 0xff;
+    pui8Payload[6] = 0x04;
+    pui8Payload[7] = (ui32Size >> 16) & 0xff;
+    pui8Payload[8] = (ui32Size >> 24) & 0xff;
+    pui8Payload[9] = ui32Size & 0xff;
+    pui8Payload[10] = (ui32Size >> 8) & 0xff;
+    SimFrameBuild(&g_psFrames[ui32Idx++], 0x10, 0x6003, pui8Payload, 11, 9,
+                  PHASE_ERASE);
+#ifdef BL_WATCHDOG_TIMEOUT
+    if(g_ui32SimResume != 0xffffffff)
+    {
+        SimFrameBuild(&g_psFrames[ui32Idx - 1], 0x10, 0x6009, pui8Payload, 11,
+                      13, PHASE_ERASE);
+    }
+#endif
+#ifdef SIM_MANIFEST
+    if(g_pui8Params)
+    {
+        memset(pui8Payload, 0, MANIFEST_SIZE);
+        pui8Payload[0] = 2;
+        SimManifestRegion(pui8Payload + 1, APP_START_ADDRESS, pui8App,
+                          ui32AppSize);
+        SimManifestRegion(pui8Payload + 41, SIM_PARAMS_ADDRESS, g_pui8Params,
+                          g_ui32ParamsSize);
+        SimFrameBuild(&g_psFrames[ui32Idx - 1], 0x10, 0x600C, pui8Payload,
+                      MANIFEST_SIZE, 9, PHASE_ERASE);
+    }
+#endif
+#ifdef DECRYPT_AES_MODE
+    SimFrameBuild(&g_psFrames[ui32Idx++], 0x10, 0x600A, g_pui8SimIV,
+                  DECRYPT_IV_SIZE, 8, PHASE_ERASE);
+
+    //
+    // The padding was encrypted along with the image, so send all of it.
+    //
+    ui32Size = ui32Blocks * 128;
+#endif
+
+    //
+    // The image, with the last block padded out with erased bytes.
+    //
+    g_ui32DataFrame = ui32Idx;
+    g_ui32FirstBlock = ui32First;
+    for(ui32Offset = ui32First * 128; ui32Offset < ui32Size;
+        ui32Offset += 128)
+    {
+        memset(pui8Payload, 0xff, 128);
+        memcpy(pui8Payload, pui8Image + ui32Offset,
+               ((ui32Size - ui32Offset) < 128) ? (ui32Size - ui32Offset) :
+                                                 128);
+        if(g_bPlainData)
+        {
+            SimFrameBuild(&g_psFrames[ui32Idx++], 0x10, 0x6006, pui8Payload,
+                          128, 8, PHASE_PROGRAM);
+        }
+        else
+        {
+            pui8Payload[128] = ((ui32Offset / 128) >> 8) & 0xff;
+            pui8Payload[129] = (ui32Offset / 128) & 0xff;
+            SimFrameBuild(&g_psFrames[ui32Idx++], 0x10, 0x6007, pui8Payload,
+                          130, 9, PHASE_PROGRAM);
+        }
+    }
+    g_ui32DataFrames = ui32Idx - g_ui32DataFrame;
+
+#ifdef DECRYPT_AES_MODE
+    free((void *)pui8Image);
+#endif
+#ifdef SIM_MANIFEST
+    free(pui8Stream);
+#endif
+
+#ifdef IMAGE_DIGEST
+    //
+    // Read the digest of what was programmed.
+    //
+    SimFrameBuild(&g_psFrames[ui32Idx++], 0x03, 0x6004, pui8Payload, 0,
+                  DIGEST_REPLY_SIZE, PHASE_STATUS);
+#endif
+
+    //
+    // Read the status and counters.
+    //
+    pui8Payload[0] = 0x00;
+    pui8Payload[1] = 0x01;
+    SimFrameBuild(&g_psFrames[ui32Idx++], 0x03, 0x6003, pui8Payload, 2,
+                  SIM_STATUS_SIZE, PHASE_STATUS);
+
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+    //
+    // Read the erase counters of every block.
+    //
+    for(ui32Offset = 0; ui32Offset < SIM_FLASH_BLOCKS;
+        ui32Offset += WEAR_REPLY_BLOCKS)
+    {
+        pui8Payload[0] = (ui32Offset >> 8) & 0xff;
+        pui8Payload[1] = ui32Offset & 0xff;
+        SimFrameBuild(&g_psFrames[ui32Idx++], 0x03, 0x600D, pui8Payload, 2,
+                      WEAR_REPLY_SIZE, PHASE_STATUS);
+    }
+#endif
+
+#ifdef ENABLE_FLASH_DUMP
+    //
+    // Read the image back, then try to read the execute-only block.  A new
+    // boot loader is not read back, since it is only staged until the
+    // install.
+    //
+#ifdef BL_UPDATE_STAGED
+    if(!g_bStaged)
+#endif
+    {
+        g_ui32SimDumpFrame = ui32Idx;
+#ifdef FLASH_CODE_PROTECTION
+        g_ui32SimDumpReply = DUMP_HEADER_SIZE + 2;
+#else
+        g_ui32SimDumpReply = (g_ui32SimDumpSize +
+                              (((g_ui32SimDumpSize + DUMP_FRAME_SIZE - 1) /
+                                DUMP_FRAME_SIZE) * (DUMP_HEADER_SIZE + 2)));
+#endif
+        free(g_pui8SimDump);
+        g_pui8SimDump = malloc(g_ui32SimDumpReply);
+        if(!g_pui8SimDump)
+        {
+            fprintf(stderr, "blsim: out of memory\n");
+            exit(1);
+        }
+        SimDumpPayload(pui8Payload, APP_START_ADDRESS, g_ui32SimDumpSize);
+        SimFrameBuild(&g_psFrames[ui32Idx++], 0x03, 0x600E, pui8Payload, 8,
+                      g_ui32SimDumpReply, PHASE_STATUS);
+        SimDumpPayload(pui8Payload, SIM_DUMP_ADDRESS, SIM_DUMP_BLOCK);
+        SimFrameBuild(&g_psFrames[ui32Idx++], 0x03, 0x600E, pui8Payload, 8,
+                      DUMP_HEADER_SIZE + 2, PHASE_STATUS);
+    }
+#endif
+
+#ifdef BL_UPDATE_STAGED
+    //
+    // Install the new boot loader, which resets the board.
+    //
+    if(g_bStaged)
+    {
+        SHA256Final(&sContext, pui8Payload);
+        SimFrameBuild(&g_psFrames[ui32Idx++], 0x10, 0x600B, pui8Payload,
+                      INSTALL_DIGEST_SIZE, DIGEST_REPLY_SIZE, PHASE_RESET);
+        return;
+    }
+#endif
+
+    //
+    // Reset.
+    //
+    pui8Payload[0] = 0x01;
+    SimFrameBuild(&g_psFrames[ui32Idx++], 0x06, 0x6000, pui8Payload, 1, 8,
+                  PHASE_RESET);
+}
+
+//*****************************************************************************
+//
+// Has the host model send the current frame, starting at the given time.
+// Over the SSI the host instead waits from then until the boot loader is
+// ready for it, and the SSI model starts the frame.
+//
+//*****************************************************************************
+void
+SimFrameSend(uint64_t ui64Start)
+{
+#ifdef SSI_ENABLE_UPDATE
+    SimSSIFrameQueue(ui64Start);
+#else
+    SimFrameClock(ui64Start);
+#endif
+}
+
+//*****************************************************************************
+//
+// Starts the bytes of the current frame on their way to the boot loader at
+// the given time, one every byte time of the link.
+//
+//*****************************************************************************
+void
+SimFrameClock(uint64_t ui64Start)
+{
+    tSimFrame *psFrame;
+    tSimPhase *psPhase;
+    uint32_t ui32Idx, ui32Size;
+
+    psFrame = &g_psFrames[g_ui32Frame];
+    psPhase = &g_psPhases[psFrame->ui32Phase];
+    if(!psPhase->ui32Frames && !g_ui32Retries)
+    {
+        psPhase->ui64Start = ui64Start;
+    }
+
+    //
+    // Data frames may be damaged on the way.
+    //
+    ui32Size = psFrame->ui32Size;
+    memcpy(g_pui8RxData, psFrame->pui8Data, ui32Size);
+    if(psFrame->ui32Phase == PHASE_PROGRAM)
+    {
+        ui32Size = SimFaultInject(g_pui8RxData, ui32Size, ui64Start);
+    }
+    for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+    {
+        g_pui64RxTime[ui32Idx] = ui64Start + ((ui32Idx + 1) *
+                                              g_ui64ByteCycles);
+    }
+    g_ui32RxCount = ui32Size;
+    g_ui32RxHead = 0;
+    g_ui32ReplyBytes = 0;
+    g_ui64ReplyDeadline = (g_pui64RxTime[g_ui32RxCount - 1] +
+                           g_ui64HostTimeout +
+                           (psFrame->ui32ReplySize * g_ui64ByteCycles));
+#ifdef ENABLE_FLASH_DUMP
+    if((g_ui32Frame == g_ui32SimDumpFrame) && !g_ui32Retries)
+    {
+        g_ui64SimDumpStart = ui64Start;
+    }
+#endif
+}
+
+//*****************************************************************************
+//
+// Called by the link model with each byte of the response that the host
+// model receives and the time that it finished arriving.
+//
+//*****************************************************************************
+void
+SimReplyByte(uint8_t ui8Data, uint64_t ui64Time)
+{
+    if(g_ui32ReplyBytes < SIM_REPLY_SIZE)
+    {
+        g_pui8Reply[g_ui32ReplyBytes] = ui8Data;
+    }
+#ifdef ENABLE_FLASH_DUMP
+    if((g_ui32Frame == g_ui32SimDumpFrame) &&
+       (g_ui32ReplyBytes < g_ui32SimDumpReply))
+    {
+        g_pui8SimDump[g_ui32ReplyBytes] = ui8Data;
+    }
+#endif
+    if((g_ui32Frame < g_ui32NumFrames) &&
+       (++g_ui32ReplyBytes == g_psFrames[g_ui32Frame].ui32ReplySize))
+    {
+        SimReplyDone(ui64Time);
+    }
+}
+
+//*****************************************************************************
+//
+// Called once the host model has the whole response to the current frame.
+//
+//*****************************************************************************
+void
+SimReplyDone(uint64_t ui64Time)
+{
+    tSimFrame *psFrame;
+    tSimPhase *psPhase;
+    uint32_t ui32Idx;
+
+    //
+    // If the reply was lost, wait for it until the host timeout.
+    //
+    if(SimFaultReplyLost())
+    {
+        return;
+    }
+
+    psFrame = &g_psFrames[g_ui32Frame];
+    psPhase = &g_psPhases[psFrame->ui32Phase];
+
+    //
+    // The link model does not damage replies, so one with a bad CRC16 was
+    // sent that way.
+    //
+    if(!SimReplyIntact(g_pui8Reply, psFrame->ui32ReplySize))
+    {
+        fprintf(stderr, "blsim: bad CRC16 in the reply to frame %u\n",
+                g_ui32Frame);
+        exit(1);
+    }
+
+    psPhase->ui32Frames++;
+    psPhase->ui32Bytes += psFrame->ui32Payload;
+    psPhase->ui64End = ui64Time;
+    g_ui32Retries = 0;
+
+    //
+    // Keep the counters from the status reply to check them against what the
+    // flash and UART models saw.
+    //
+    if((psFrame->ui32Phase == PHASE_STATUS) && (g_pui8Reply[2] == 0x00))
+    {
+        for(ui32Idx = 0; ui32Idx < NUM_STATS; ui32Idx++)
+        {
+            g_pui32SimStats[ui32Idx] =
+                ((g_pui8Reply[6 + (ui32Idx * 4)] << 24) |
+                 (g_pui8Reply[7 + (ui32Idx * 4)] << 16) |
+                 (g_pui8Reply[8 + (ui32Idx * 4)] << 8) |
+                 g_pui8Reply[9 + (ui32Idx * 4)]);
+        }
+        g_bStatsRead = (g_pui8Reply[5] == NUM_STATS);
+        g_ui8StatsStatus = g_pui8Reply[4];
+        g_ui32StatsFrame = g_ui32Frame;
+        g_ui32StatsPrograms = g_ui32Programs - g_ui32JournalPrograms;
+        g_ui32StatsErases = g_ui32Erases - g_ui32JournalErases;
+        g_ui32StatsOverruns = g_ui32Overruns;
+    }
+
+    //
+    // The reply to a sequenced data frame gives the block that the boot
+    // loader expects next, which is the one after this frame's unless the
+    // boot loader had already had this one or is waiting for an earlier one.
+    // Carry on from the frame holding it.
+    //
+    if(psFrame->ui32Phase == PHASE_PROGRAM)
+    {
+        SimFaultRecovered(ui64Time);
+        ui32Idx = (((g_pui8Reply[5] << 8) | g_pui8Reply[6]) -
+                   g_ui32FirstBlock) & 0xffff;
+        if((psFrame->pui8Data[3] == 0x07) && (ui32Idx <= g_ui32DataFrames))
+        {
+            g_ui32Frame = g_ui32DataFrame + ui32Idx - 1;
+        }
+    }
+
+    //
+    // Let each feature pick what it checks out of the reply.
+    //
+#ifdef IMAGE_DIGEST
+    SimDigestReply();
+#endif
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+    SimWearReply();
+#endif
+#ifdef ENABLE_FLASH_DUMP
+    SimDumpReply(ui64Time);
+#endif
+#ifdef BL_WATCHDOG_TIMEOUT
+    SimResumeReply();
+#endif
+#ifdef BL_UPDATE_STAGED
+    //
+    // Once it has replied to the install command, the boot loader copies the
+    // new boot loader over itself and then resets, which ends the run.
+    //
+    if(SimInstallReply())
+    {
+        g_ui32Frame++;
+        return;
+    }
+#endif
+
+    if(++g_ui32Frame == g_ui32NumFrames)
+    {
+        longjmp(g_sDone, 1);
+    }
+#ifdef BL_WATCHDOG_TIMEOUT
+    if(g_ui32Frame == g_ui32LinkLost)
+    {
+        g_ui64LinkLost = ui64Time;
+        g_ui32NumFrames = g_ui32Frame;
+        return;
+    }
+#endif
+
+    SimFrameSend(ui64Time + g_ui64Turnaround);
+}
+
+//*****************************************************************************
+//
+// Called when the host model has waited too long for a response.  The frame
+// is sent again, as the host tool would.
+//
+//*****************************************************************************
+void
+SimReplyTimeout(void)
+{
+    if(++g_ui32Retries > SIM_MAX_RETRIES)
+    {
+        fprintf(stderr, "blsim: no response to frame %u after %u retries\n",
+                g_ui32Frame, SIM_MAX_RETRIES);
+        exit(1);
+    }
+    g_ui32TotalRetries++;
+    SimFrameSend(g_ui64Now);
+}
+
+//*****************************************************************************
+//
+// Reads an image file, returning its size or exiting if it cannot be read or
+// will not fit in the flash after the boot loader.
+//
+//*****************************************************************************
+uint32_t
+SimImageRead(const char *pcPath, uint8_t **ppui8Image)
+{
+    uint32_t ui32Size;
+    FILE *psFile;
+
+    psFile = fopen(pcPath, "rb");
+    if(!psFile)
+    {
+        perror(pcPath);
+        exit(1);
+    }
+    fseek(psFile, 0, SEEK_END);
+    ui32Size = ftell(psFile);
+    fseek(psFile, 0, SEEK_SET);
+    *ppui8Image = malloc(ui32Size ? ui32Size : 1);
+    if(!*ppui8Image ||
+       (fread(*ppui8Image, 1, ui32Size, psFile) != ui32Size))
+    {
+        fprintf(stderr, "blsim: unable to read %s\n", pcPath);
+        exit(1);
+    }
+    fclose(psFile);
+    if(!ui32Size || ((APP_START_ADDRESS + ui32Size) > SIM_FLASH_SIZE))
+    {
+        fprintf(stderr, "blsim: image must be 1 to %u bytes\n",
+                SIM_FLASH_SIZE - APP_START_ADDRESS);
+        exit(1);
+    }
+
+    return(ui32Size);
+}
+
+//*****************************************************************************
+//
+// Prints the counters that the boot loader returned for the status frame and
+// checks them against the simulator's own accounting.  Every frame before the
+// status frame was received at least once, each programmed word is four
+// bytes, and the flash times are the modelled busy times plus the polling
+// around them.  Returns non-zero if any counter is wrong.
+//
+//*****************************************************************************
+int
+SimStatsCheck(void)
+{
+    double dEraseUs, dProgramUs, dScanUs;
+    bool bOk;
+
+    if(!g_bStatsRead)
+    {
+        printf("telemetry: FAILED (no status reply)\n");
+        return(1);
+    }
+    printf("telemetry: %u frames, %u CRC errors, %u timeouts, "
+           "%u retransmits, %u overruns\n",
+           g_pui32SimStats[STAT_FRAMES], g_pui32SimStats[STAT_CRC_ERRORS],
+           g_pui32SimStats[STAT_TIMEOUTS], g_pui32SimStats[STAT_RETRANSMITS],
+           g_pui32SimStats[STAT_OVERRUNS]);
+    printf("           %u bytes in %u us programming, %u us erasing\n",
+           g_pui32SimStats[STAT_PROGRAMMED],
+           g_pui32SimStats[STAT_PROGRAM_TIME],
+           g_pui32SimStats[STAT_ERASE_TIME]);
+
+    dEraseUs = CyclesToSeconds(g_ui64EraseCycles * g_ui32StatsErases) * 1e6;
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+    //
+    // Each erase skipped took a read of every word of the block to find that
+    // it was blank.
+    //
+    dScanUs = CyclesToSeconds((uint64_t)g_ui32SimWearSkips *
+                              (BL_FLASH_ERASE_SIZE / 4) *
+                              g_ui32AccessCycles) * 1e6;
+#else
+    dScanUs = 0.0;
+#endif
+    dProgramUs = (CyclesToSeconds(g_ui64ProgramCycles * g_ui32StatsPrograms) *
+                  1e6);
+    bOk = ((g_pui32SimStats[STAT_FRAMES] >= (g_ui32StatsFrame + 1)) &&
+           (g_pui32SimStats[STAT_PROGRAMMED] == (g_ui32StatsPrograms * 4)) &&
+           (g_pui32SimStats[STAT_ERASE_TIME] >= (dEraseUs * 0.99)) &&
+           (g_pui32SimStats[STAT_ERASE_TIME] <=
+            (((dEraseUs + dScanUs) * 1.05) + 10)) &&
+           (g_pui32SimStats[STAT_PROGRAM_TIME] >= (dProgramUs * 0.9)) &&
+           (g_pui32SimStats[STAT_PROGRAM_TIME] <=
+            ((dProgramUs * 1.5) + 10)) &&
+           ((g_pui32SimStats[STAT_OVERRUNS] != 0) ==
+            (g_ui32StatsOverruns != 0)));
+    printf("telemetry: %s\n", bOk ? "ok" : "FAILED");
+
+    return(bOk ? 0 : 1);
+}
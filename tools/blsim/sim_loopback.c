@@ -0,0 +1,212 @@
+//*****************************************************************************
+//
+// sim_loopback.c - Checks of the SRAM loopback transport.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DLOOPBACK_ENABLE_UPDATE, before the run, the simulator acts as the
+// other end of the mailbox and checks the loopback transport through the
+// transport table: that the boot loader takes the first byte from the
+// mailbox while the UART is idle, receives more than a ring's worth of data
+// across the wrap of the ring, times out once the other end stops writing,
+// and sends its acknowledgement and longer writes back through the mailbox,
+// with a flush that returns once they have all been read.  The download
+// that follows then runs over the UART with the loopback transport still
+// polled alongside it.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "blsim.h"
+
+#ifdef LOOPBACK_ENABLE_UPDATE
+#include "boot_loader/bl_loopback.h"
+#include "boot_loader/bl_packet.h"
+#include "boot_loader/bl_timer.h"
+#include "boot_loader/bl_transport.h"
+
+//*****************************************************************************
+//
+// The number of bytes sent each way, more than one ring's worth, and the
+// acknowledgement that AckPacket() sends.
+//
+//*****************************************************************************
+#define SIM_LOOPBACK_BYTES      (LOOPBACK_RING_SIZE + 44)
+
+static const uint8_t g_pui8SimAck[8] =
+{
+    PACKET_REPLY_ID, 0x10, 0x60, 0x06, 0x00, 0x40, 0x11, 0x22
+};
+
+//*****************************************************************************
+//
+// Accesses a word or byte of the mailbox as the other end does, without
+// taking any simulated time.
+//
+//*****************************************************************************
+static volatile uint32_t *
+SimLoopbackWord(uint32_t ui32Offset)
+{
+    return(&SimRegFind(LOOPBACK_ADDRESS + ui32Offset)->ui32Value);
+}
+
+static uint32_t
+SimLoopbackByte(uint32_t ui32Ring, uint32_t ui32Count)
+{
+    uint32_t ui32Offset;
+
+    ui32Offset = ui32Ring + (ui32Count & (LOOPBACK_RING_SIZE - 1));
+    return((*SimLoopbackWord(ui32Offset & ~3) >> (8 * (ui32Offset & 3))) &
+           0xff);
+}
+
+//*****************************************************************************
+//
+// Writes data to the receive ring, as much as fits, and returns the number
+// of bytes written.
+//
+//*****************************************************************************
+static uint32_t
+SimLoopbackPut(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint32_t ui32Head, ui32Offset, ui32Shift, ui32Done;
+
+    ui32Head = *SimLoopbackWord(LOOPBACK_O_RX_HEAD);
+    for(ui32Done = 0; ui32Done < ui32Size; ui32Done++, ui32Head++)
+    {
+        if((ui32Head - *SimLoopbackWord(LOOPBACK_O_RX_TAIL)) >=
+           LOOPBACK_RING_SIZE)
+        {
+            break;
+        }
+        ui32Offset = LOOPBACK_O_RX + (ui32Head & (LOOPBACK_RING_SIZE - 1));
+        ui32Shift = 8 * (ui32Offset & 3);
+        *SimLoopbackWord(ui32Offset & ~3) =
+            ((*SimLoopbackWord(ui32Offset & ~3) & ~(0xff << ui32Shift)) |
+             (pui8Data[ui32Done] << ui32Shift));
+    }
+    *SimLoopbackWord(LOOPBACK_O_RX_HEAD) = ui32Head;
+
+    return(ui32Done);
+}
+
+//*****************************************************************************
+//
+// Reads up to the given number of bytes from the transmit ring and returns
+// the number read.
+//
+//*****************************************************************************
+static uint32_t
+SimLoopbackGet(uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint32_t ui32Tail, ui32Done;
+
+    ui32Tail = *SimLoopbackWord(LOOPBACK_O_TX_TAIL);
+    for(ui32Done = 0;
+        (ui32Done < ui32Size) &&
+        (ui32Tail != *SimLoopbackWord(LOOPBACK_O_TX_HEAD));
+        ui32Done++, ui32Tail++)
+    {
+        pui8Data[ui32Done] = SimLoopbackByte(LOOPBACK_O_TX, ui32Tail);
+    }
+    *SimLoopbackWord(LOOPBACK_O_TX_TAIL) = ui32Tail;
+
+    return(ui32Done);
+}
+
+//*****************************************************************************
+//
+// Runs the checks of the loopback transport.  Returns non-zero if any of
+// them fails.
+//
+//*****************************************************************************
+int
+SimLoopbackCheck(void)
+{
+    uint8_t pui8Sent[SIM_LOOPBACK_BYTES], pui8Got[SIM_LOOPBACK_BYTES];
+    uint32_t ui32Idx, ui32Put, ui32Fails;
+    uint64_t ui64Start;
+    double dTimeoutMs;
+
+    for(ui32Idx = 0; ui32Idx < SIM_LOOPBACK_BYTES; ui32Idx++)
+    {
+        pui8Sent[ui32Idx] = (uint8_t)((ui32Idx * 13) + 7);
+    }
+    memset(pui8Got, 0, sizeof(pui8Got));
+    ui32Fails = 0;
+    BLTimerInit(g_ui32SysClockHz);
+    ConfigureLoopback();
+
+    //
+    // The first byte in the mailbox is found by polling every transport,
+    // and the rest follow, the second part of them after the first part has
+    // been read and made room for it across the wrap of the ring.
+    //
+    ui32Put = SimLoopbackPut(pui8Sent, SIM_LOOPBACK_BYTES);
+    ReceiveData(pui8Got, 1);
+    ui32Fails |= (ReceiveDataTimeout(pui8Got + 1, ui32Put - 1) != 0);
+    ui32Fails |= (SimLoopbackPut(pui8Sent + ui32Put,
+                                 SIM_LOOPBACK_BYTES - ui32Put) !=
+                  (SIM_LOOPBACK_BYTES - ui32Put)) << 1;
+    ui32Fails |= (ReceiveDataTimeout(pui8Got + ui32Put,
+                                     SIM_LOOPBACK_BYTES - ui32Put) != 0) << 2;
+    ui32Fails |= (memcmp(pui8Got, pui8Sent, SIM_LOOPBACK_BYTES) != 0) << 3;
+
+    //
+    // With nothing more written, the receive gives up after the timeout.
+    //
+    ui64Start = g_ui64Now;
+    ui32Fails |= (ReceiveDataTimeout(pui8Got, 1) >= 0) << 4;
+    dTimeoutMs = CyclesToSeconds(g_ui64Now - ui64Start) * 1000.0;
+    ui32Fails |= ((dTimeoutMs < UART_RX_TIMEOUT) ||
+                  (dTimeoutMs > (UART_RX_TIMEOUT * 2))) << 5;
+
+    //
+    // The acknowledgement goes back through the mailbox, as do longer
+    // writes that wrap the transmit ring, which the flush waits for.
+    //
+    AckPacket();
+    ui32Fails |= ((SimLoopbackGet(pui8Got, sizeof(pui8Got)) != 8) ||
+                  memcmp(pui8Got, g_pui8SimAck, 8)) << 6;
+    WriteData(pui8Sent, LOOPBACK_RING_SIZE - 8);
+    ui32Put = SimLoopbackGet(pui8Got, sizeof(pui8Got));
+    SendData(pui8Sent + ui32Put, SIM_LOOPBACK_BYTES - ui32Put);
+    ui32Put += SimLoopbackGet(pui8Got + ui32Put, sizeof(pui8Got) - ui32Put);
+    ui32Fails |= ((ui32Put != SIM_LOOPBACK_BYTES) ||
+                  memcmp(pui8Got, pui8Sent, SIM_LOOPBACK_BYTES)) << 7;
+    FlushData();
+
+    printf("loopback:  %u bytes each way through a %u byte ring, timeout "
+           "%.1f ms, %s\n", SIM_LOOPBACK_BYTES, LOOPBACK_RING_SIZE,
+           dTimeoutMs, ui32Fails ? "FAILED" : "ok");
+    if(ui32Fails)
+    {
+        printf("           (failed checks 0x%02x)\n", ui32Fails);
+    }
+
+    return(ui32Fails ? 1 : 0);
+}
+#endif
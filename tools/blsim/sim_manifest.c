@@ -0,0 +1,95 @@
+//*****************************************************************************
+//
+// sim_manifest.c - Checks of the manifest session.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DENABLE_MANIFEST_UPDATE -DIMAGE_DIGEST -DFLASH_RSVD_SPACE=<size>,
+// the -M option sends a parameter block to the reserved block at the top of
+// flash along with the image, in one manifest session.  The status read at
+// the end shows whether the boot loader found both regions' digests right.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "blsim.h"
+
+#ifdef SIM_MANIFEST
+//*****************************************************************************
+//
+// The parameter block that a manifest session sends to the block reserved by
+// FLASH_RSVD_SPACE after the image, if any.
+//
+//*****************************************************************************
+uint8_t *g_pui8Params;
+uint32_t g_ui32ParamsSize;
+
+//*****************************************************************************
+//
+// Adds a region to a manifest.
+//
+//*****************************************************************************
+void
+SimManifestRegion(uint8_t *pui8Region, uint32_t ui32Address,
+                  const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    tSHA256Context sContext;
+
+    pui8Region[0] = ui32Address >> 24;
+    pui8Region[1] = (ui32Address >> 16) & 0xff;
+    pui8Region[2] = (ui32Address >> 8) & 0xff;
+    pui8Region[3] = ui32Address & 0xff;
+    pui8Region[4] = ui32Size >> 24;
+    pui8Region[5] = (ui32Size >> 16) & 0xff;
+    pui8Region[6] = (ui32Size >> 8) & 0xff;
+    pui8Region[7] = ui32Size & 0xff;
+    SHA256Init(&sContext);
+    SHA256Update(&sContext, pui8Data, ui32Size);
+    SHA256Final(&sContext, pui8Region + 8);
+}
+
+//*****************************************************************************
+//
+// Checks the end of a manifest session: that the boot loader found the
+// digests of both regions correct and that the parameter block is in place.
+// Returns non-zero on a failure.
+//
+//*****************************************************************************
+int
+SimManifestCheck(void)
+{
+    bool bVerified, bOk;
+
+    bVerified = (g_bStatsRead && (g_ui8StatsStatus == COMMAND_RET_SUCCESS));
+    bOk = !memcmp(g_pui8Flash + SIM_PARAMS_ADDRESS, g_pui8Params,
+                  g_ui32ParamsSize);
+    printf("manifest:  2 regions, checked by the boot loader %s, "
+           "parameter block %s\n", bVerified ? "ok" : "FAILED",
+           bOk ? "ok" : "FAILED");
+
+    return((bVerified && bOk) ? 0 : 1);
+}
+#endif
@@ -0,0 +1,267 @@
+//*****************************************************************************
+//
+// sim_meta.c - Checks of the key/value store.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DMETA_EEPROM_ADDRESS=<offset> -DMETA_EEPROM_SIZE=<size>, the boot
+// loader's key/value store is tested against the EEPROM model before the
+// run: a few hundred values are written and read back, and then the writes
+// are repeated with the power cut before each EEPROM word in turn, checking
+// that nothing written before the interrupted write is lost.  The download
+// should then be counted in the store.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "blsim.h"
+
+#ifdef META_EEPROM_ADDRESS
+#include "boot_loader/bl_meta.h"
+
+//*****************************************************************************
+//
+// The number of values that the key/value store test writes, what it
+// expects each key to hold, and the step of the test that a power cut
+// interrupted.
+//
+//*****************************************************************************
+#define SIM_META_STEPS          400
+
+static uint32_t g_ppui32MetaModel[META_NUM_KEYS][META_MAX_WORDS];
+static uint32_t g_pui32MetaModelWords[META_NUM_KEYS];
+static uint32_t g_ui32MetaStep;
+
+//*****************************************************************************
+//
+// Works out the key and value that a step of the test writes.  Most steps
+// write one of a few keys, as counters and flags would, and every fifth
+// writes a key's value again unchanged.  Returns the key.
+//
+//*****************************************************************************
+static uint32_t
+SimMetaStep(uint32_t ui32Step, uint32_t *pui32Value, uint32_t *pui32Words)
+{
+    uint32_t ui32Seed, ui32Key, ui32Idx;
+
+    ui32Seed = (ui32Step + 1) * 2654435761u;
+    ui32Seed ^= ui32Seed >> 15;
+    ui32Key = ((ui32Seed >> 20) & 3) ? ((ui32Seed >> 8) % 3) :
+                                       ((ui32Seed >> 8) % META_NUM_KEYS);
+    if(((ui32Step % 5) == 4) && g_pui32MetaModelWords[ui32Key])
+    {
+        *pui32Words = g_pui32MetaModelWords[ui32Key];
+        memcpy(pui32Value, g_ppui32MetaModel[ui32Key], *pui32Words * 4);
+        return(ui32Key);
+    }
+
+    *pui32Words = 1 + ((ui32Seed >> 4) % META_MAX_WORDS);
+    for(ui32Idx = 0; ui32Idx < *pui32Words; ui32Idx++)
+    {
+        pui32Value[ui32Idx] = ui32Seed * (ui32Idx + 7);
+    }
+
+    return(ui32Key);
+}
+
+//*****************************************************************************
+//
+// Checks that every key reads back what the test expects, allowing the
+// given key (if it is one) to hold the given value instead.
+//
+//*****************************************************************************
+static bool
+SimMetaVerify(uint32_t ui32Key, const uint32_t *pui32Value,
+              uint32_t ui32Words)
+{
+    uint32_t pui32Read[META_MAX_WORDS], ui32Idx, ui32Read;
+
+    for(ui32Idx = 0; ui32Idx < META_NUM_KEYS; ui32Idx++)
+    {
+        ui32Read = MetaGet(ui32Idx, pui32Read, META_MAX_WORDS);
+        if((ui32Read == g_pui32MetaModelWords[ui32Idx]) &&
+           !memcmp(pui32Read, g_ppui32MetaModel[ui32Idx], ui32Read * 4))
+        {
+            continue;
+        }
+        if((ui32Idx == ui32Key) && (ui32Read == ui32Words) &&
+           !memcmp(pui32Read, pui32Value, ui32Read * 4))
+        {
+            continue;
+        }
+        return(false);
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Notes that the given key now holds the given value.
+//
+//*****************************************************************************
+static void
+SimMetaModelSet(uint32_t ui32Key, const uint32_t *pui32Value,
+                uint32_t ui32Words)
+{
+    memcpy(g_ppui32MetaModel[ui32Key], pui32Value, ui32Words * 4);
+    g_pui32MetaModelWords[ui32Key] = ui32Words;
+}
+
+//*****************************************************************************
+//
+// Blanks the EEPROM and starts the store and the test's model of it afresh.
+//
+//*****************************************************************************
+static void
+SimMetaReset(void)
+{
+    memset(g_pui8EEPROM, 0xff, SIM_EEPROM_SIZE);
+    memset(g_pui32MetaModelWords, 0, sizeof(g_pui32MetaModelWords));
+    g_ui32EEPROMWords = 0;
+    MetaInit();
+}
+
+//*****************************************************************************
+//
+// Tests the boot loader's key/value store against the EEPROM model.  A run of
+// writes is made and every key checked after each, rebuilding the index from
+// the EEPROM now and then, while the words that each write takes are
+// counted.  The run is then repeated with the power cut before each word
+// write in turn, and each time the store is started again as at reset and
+// checked to hold every value written before the write that was cut short,
+// with that key holding either its old or its new value, and to carry on
+// working.  Returns non-zero on a failure.
+//
+//*****************************************************************************
+int
+SimMetaCheck(void)
+{
+    uint32_t pui32Value[META_MAX_WORDS], ui32Words, ui32Key, ui32Step;
+    uint32_t ui32Updates, ui32UpdateWords, ui32Compactions, ui32Before;
+    uint32_t ui32Total, ui32Cut, ui32Lost;
+    bool bOk, bSame;
+
+    SimMetaReset();
+    bOk = true;
+    ui32Updates = 0;
+    ui32UpdateWords = 0;
+    ui32Compactions = 0;
+    for(ui32Step = 0; ui32Step < SIM_META_STEPS; ui32Step++)
+    {
+        ui32Key = SimMetaStep(ui32Step, pui32Value, &ui32Words);
+        bSame = ((g_pui32MetaModelWords[ui32Key] == ui32Words) &&
+                 !memcmp(g_ppui32MetaModel[ui32Key], pui32Value,
+                         ui32Words * 4));
+        ui32Before = g_ui32EEPROMWords;
+        bOk = bOk && MetaSet(ui32Key, pui32Value, ui32Words);
+        SimMetaModelSet(ui32Key, pui32Value, ui32Words);
+        if(bSame)
+        {
+            bOk = bOk && (g_ui32EEPROMWords == ui32Before);
+        }
+        else if((g_ui32EEPROMWords - ui32Before) > (ui32Words + 1))
+        {
+            ui32Compactions++;
+        }
+        else
+        {
+            ui32Updates++;
+            ui32UpdateWords += g_ui32EEPROMWords - ui32Before;
+        }
+        if((ui32Step % 37) == 0)
+        {
+            MetaInit();
+        }
+        bOk = bOk && SimMetaVerify(META_NUM_KEYS, 0, 0);
+    }
+    ui32Total = g_ui32EEPROMWords;
+    printf("meta:      %u writes, %u words in all, %.2f words per update, "
+           "%u compactions, %s\n", SIM_META_STEPS, ui32Total,
+           (double)ui32UpdateWords / ui32Updates, ui32Compactions,
+           bOk ? "ok" : "FAILED");
+
+    ui32Lost = 0;
+    for(ui32Cut = 1; ui32Cut <= ui32Total; ui32Cut++)
+    {
+        SimMetaReset();
+        g_ui32EEPROMCut = ui32Cut;
+        if(!setjmp(g_sPowerCut))
+        {
+            for(g_ui32MetaStep = 0; g_ui32MetaStep < SIM_META_STEPS;
+                g_ui32MetaStep++)
+            {
+                ui32Key = SimMetaStep(g_ui32MetaStep, pui32Value, &ui32Words);
+                MetaSet(ui32Key, pui32Value, ui32Words);
+                SimMetaModelSet(ui32Key, pui32Value, ui32Words);
+            }
+        }
+        g_ui32EEPROMCut = 0;
+
+        //
+        // Power up again and check the store, then write to it once more.
+        //
+        ui32Key = SimMetaStep(g_ui32MetaStep, pui32Value, &ui32Words);
+        MetaInit();
+        bSame = SimMetaVerify(ui32Key, pui32Value, ui32Words);
+        pui32Value[0] ^= 0xa5a5a5a5;
+        bSame = bSame && MetaSet(ui32Key, pui32Value, ui32Words);
+        SimMetaModelSet(ui32Key, pui32Value, ui32Words);
+        bSame = bSame && SimMetaVerify(META_NUM_KEYS, 0, 0);
+        MetaInit();
+        bSame = bSame && SimMetaVerify(META_NUM_KEYS, 0, 0);
+        if(!bSame)
+        {
+            ui32Lost++;
+        }
+    }
+    printf("powercut:  %u points in the key/value store, %u lost, %s\n",
+           ui32Total, ui32Lost, ui32Lost ? "FAILED" : "ok");
+
+    SimMetaReset();
+
+    return((bOk && !ui32Lost) ? 0 : 1);
+}
+
+//*****************************************************************************
+//
+// Checks that the download was counted in the key/value store.  Returns
+// non-zero on a failure.
+//
+//*****************************************************************************
+int
+SimMetaCountCheck(void)
+{
+    uint32_t ui32Count;
+
+    ui32Count = 0;
+    MetaGet(META_KEY_DOWNLOADS, &ui32Count, 1);
+    printf("meta:      %u download(s) counted, %s\n", ui32Count,
+           (ui32Count == 1) ? "ok" : "FAILED");
+
+    return((ui32Count == 1) ? 0 : 1);
+}
+#endif
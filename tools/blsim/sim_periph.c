@@ -0,0 +1,1480 @@
+//*****************************************************************************
+//
+// sim_periph.c - Models of the peripherals that the boot loader drives.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The models of the peripherals that the boot loader's code drives, behind
+// the emulated register space that HWREG() is redirected to: the flash
+// controller, the UART, the receive timeout timer, SysTick, the watchdog and
+// the EEPROM, along with the driverlib functions that the boot loader calls
+// in place of touching their registers.
+//
+// The flash controller model applies the erase and word program times given
+// by -e and -p, erasing a whole 16 KB block for every erase command as a
+// TM4C129 does, and the time given by -W for each program of up to 32 words
+// through the write buffer.  The UART model moves one byte every ten bit
+// times at the baud rate given by -b, with a 16 byte receive FIFO that
+// overruns if the boot loader falls behind.  Every register access costs the
+// number of cycles returned by the g_pfnBLSimCycleCost hook; code that does
+// not touch a register is treated as taking no time.
+//
+// With -P, the UART model reads and writes a pseudo-terminal in place of the
+// host model, and the simulated time follows the real time while the boot
+// loader waits for the host.  The SSI, CAN, Ethernet and USB models, in
+// sim_ssi.c, sim_can.c, sim_emac.c and sim_usb.c, are hooked in here when the
+// boot loader is built with them.
+//
+//*****************************************************************************
+
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <poll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "inc/hw_flash.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "inc/hw_timer.h"
+#include "inc/hw_uart.h"
+#include "inc/hw_sysctl.h"
+#include "inc/hw_watchdog.h"
+#include "boot_loader/bl_timer.h"
+#include "blsim.h"
+#ifdef SIM_EEPROM
+#include "driverlib/eeprom.h"
+#endif
+#ifdef UART_NODE_ID
+#include "driverlib/gpio.h"
+#endif
+
+//*****************************************************************************
+//
+// The emulated register space, with flash reads all sharing one entry.
+//
+//*****************************************************************************
+static tSimReg g_psRegs[SIM_NUM_REGS];
+static tSimReg g_sFlashReg;
+
+//*****************************************************************************
+//
+// The last register accessed and its value as it was handed out.  If the
+// value has changed by the time of the next access, the last access was a
+// write and its side effects are applied then.
+//
+//*****************************************************************************
+tSimReg *g_psLastReg;
+static uint32_t g_ui32LastValue;
+
+//*****************************************************************************
+//
+// The byte offset within its register of the access being made, for the
+// models of registers that are reached a byte or a halfword at a time.
+//
+//*****************************************************************************
+uint32_t g_ui32RegByte;
+
+//*****************************************************************************
+//
+// The simulated time in system clock cycles, and the clock rate.
+//
+//*****************************************************************************
+uint64_t g_ui64Now;
+uint32_t g_ui32SysClockHz = 120000000;
+
+//*****************************************************************************
+//
+// The cost, in cycles, of each register access.  Point g_pfnBLSimCycleCost at
+// a different function for a finer grained model of the bus.
+//
+//*****************************************************************************
+uint32_t g_ui32AccessCycles = 2;
+
+static uint32_t
+BLSimDefaultCycleCost(uint32_t ui32Address)
+{
+    (void)ui32Address;
+
+    return(g_ui32AccessCycles);
+}
+
+uint32_t (*g_pfnBLSimCycleCost)(uint32_t ui32Address) = BLSimDefaultCycleCost;
+
+//*****************************************************************************
+//
+// The flash controller model.
+//
+//*****************************************************************************
+uint8_t *g_pui8Flash;
+uint64_t g_ui64FlashBusyUntil;
+uint32_t g_ui32FlashBusyBits;
+static uint32_t g_ui32FlashAccessError;
+uint64_t g_ui64ProgramCycles;
+uint64_t g_ui64EraseCycles;
+uint32_t g_ui32Erases;
+uint32_t g_ui32Programs;
+uint32_t g_ui32JournalErases;
+uint32_t g_ui32JournalPrograms;
+uint32_t g_ui32FlashEnd;
+uint64_t g_ui64BufferCycles;
+uint32_t g_ui32BufferPrograms;
+
+//*****************************************************************************
+//
+// Power cuts.  When g_ui32PowerCut is non-zero, power is lost just before
+// that many flash operations have been counted in g_ui32FlashOps, and the
+// run jumps back to g_sPowerCut with the operation not carried out.
+//
+//*****************************************************************************
+uint32_t g_ui32PowerCut;
+uint32_t g_ui32FlashOps;
+jmp_buf g_sPowerCut;
+
+//*****************************************************************************
+//
+// The address of a 128 byte block of flash whose program fails once, with
+// an access error for each of its words and none of them written, or
+// 0xFFFFFFFF for none.
+//
+//*****************************************************************************
+uint32_t g_ui32FlashFailAddress = 0xffffffff;
+
+//*****************************************************************************
+//
+// The receive timeout timer model.
+//
+//*****************************************************************************
+static bool g_bTimerRunning;
+static bool g_bTimerExpired;
+static uint64_t g_ui64TimerExpiry;
+
+//*****************************************************************************
+//
+// The UART model.  The bytes of the frame being sent by the host model each
+// have the time at which they finish arriving.  g_bOverrun is the overrun
+// flag of the receive status register.
+//
+//*****************************************************************************
+uint32_t g_ui32BaudRate;
+uint64_t g_ui64ByteCycles;
+uint8_t g_pui8RxData[SIM_RX_SIZE];
+uint64_t g_pui64RxTime[SIM_RX_SIZE];
+uint32_t g_ui32RxCount;
+uint32_t g_ui32RxHead;
+uint32_t g_ui32Overruns;
+static bool g_bOverrun;
+static uint64_t g_ui64TxFreeAt;
+
+//*****************************************************************************
+//
+// The status registers that the boot loader has polled since it last did
+// anything else, with the value that each last read and how many times in a
+// row it has read that value.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Address;
+    uint32_t ui32Value;
+    uint32_t ui32Repeats;
+}
+tSimPoll;
+
+static tSimPoll g_psPolls[SIM_NUM_POLLS];
+static uint32_t g_ui32NumPolls;
+
+//*****************************************************************************
+//
+// The pseudo-terminal that the UART model is connected to in place of the
+// host model, and the link to it that is given to the host updater.
+//
+//*****************************************************************************
+int g_iPtyFd = -1;
+static const char *g_pcPtyLink;
+
+//*****************************************************************************
+//
+// Every this many bytes received from the pty, one is dropped, to exercise
+// the host updater's recovery.  Zero drops none.
+//
+//*****************************************************************************
+uint32_t g_ui32DropEvery;
+static uint32_t g_ui32Received;
+
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// The watchdog model.  The watchdog runs once the boot loader sets its
+// interrupt enable and, with its reset enable set, resets the board at the
+// end of its second time-out since it was last reloaded.  The time of each
+// reload, the number of them and the longest gap between two are recorded.
+//
+//*****************************************************************************
+#ifdef BL_WATCHDOG_TIMEOUT
+static bool g_bWatchdogRunning;
+bool g_bWatchdogReset;
+static uint64_t g_ui64WatchdogFed;
+static uint64_t g_ui64WatchdogExpiry;
+uint64_t g_ui64WatchdogGap;
+uint32_t g_ui32WatchdogFeeds;
+#endif
+
+//*****************************************************************************
+//
+// The EEPROM, the number of words written to it and, when non-zero, the word
+// before whose write the power is cut by a jump back to g_sPowerCut.  Words
+// are written whole or not at all, as the EEPROM's own copy buffer ensures.
+//
+//*****************************************************************************
+#ifdef SIM_EEPROM
+uint8_t g_pui8EEPROM[SIM_EEPROM_SIZE];
+uint32_t g_ui32EEPROMWords;
+uint32_t g_ui32EEPROMCut;
+#endif
+
+//*****************************************************************************
+//
+// The erases of each block that the flash model has seen.
+//
+//*****************************************************************************
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+uint32_t g_pui32BlockErases[SIM_FLASH_BLOCKS];
+#endif
+
+//*****************************************************************************
+//
+// The number of times that the clock and the UART have been configured.
+//
+//*****************************************************************************
+uint32_t g_ui32ClockSets;
+uint32_t g_ui32UARTSets;
+
+//*****************************************************************************
+//
+// Finds a register in the emulated register space, adding it if this is the
+// first time it has been accessed.  Reads of flash all share one entry, since
+// a digest of the image would otherwise fill the table.
+//
+//*****************************************************************************
+tSimReg *
+SimRegFind(uint32_t ui32Address)
+{
+    uint32_t ui32Idx;
+
+    if(ui32Address < SIM_FLASH_SIZE)
+    {
+        g_sFlashReg.ui32Address = ui32Address;
+        return(&g_sFlashReg);
+    }
+
+    ui32Idx = (ui32Address >> 2) % SIM_NUM_REGS;
+    while(g_psRegs[ui32Idx].bUsed &&
+          (g_psRegs[ui32Idx].ui32Address != ui32Address))
+    {
+        ui32Idx = (ui32Idx + 1) % SIM_NUM_REGS;
+    }
+    if(!g_psRegs[ui32Idx].bUsed)
+    {
+        g_psRegs[ui32Idx].bUsed = true;
+        g_psRegs[ui32Idx].ui32Address = ui32Address;
+        g_psRegs[ui32Idx].ui32Value = 0;
+    }
+
+    return(&g_psRegs[ui32Idx]);
+}
+
+//*****************************************************************************
+//
+// Converts between simulated cycles and seconds.
+//
+//*****************************************************************************
+double
+CyclesToSeconds(uint64_t ui64Cycles)
+{
+    return((double)ui64Cycles / (double)g_ui32SysClockHz);
+}
+
+uint64_t
+MicrosecondsToCycles(double dMicroseconds)
+{
+    return((uint64_t)(dMicroseconds * (g_ui32SysClockHz / 1000000.0)));
+}
+
+//*****************************************************************************
+//
+// Returns the number of received bytes waiting in a receive FIFO of the given
+// depth, discarding any that arrived while it was full.
+//
+//*****************************************************************************
+uint32_t
+SimRxAvailable(uint32_t ui32Depth)
+{
+    struct pollfd sPoll;
+    uint32_t ui32Count;
+    ssize_t iRead;
+
+    //
+    // A pty refills the FIFO from whatever the host has written so far.
+    //
+    if(g_iPtyFd >= 0)
+    {
+        sPoll.fd = g_iPtyFd;
+        sPoll.events = POLLIN;
+        if((g_ui32RxHead == g_ui32RxCount) && (poll(&sPoll, 1, 0) > 0))
+        {
+            iRead = read(g_iPtyFd, g_pui8RxData, SIM_UART_FIFO);
+            g_ui32RxHead = 0;
+            g_ui32RxCount = (iRead > 0) ? iRead : 0;
+            for(ui32Count = 0; g_ui32DropEvery && (ui32Count < g_ui32RxCount);
+                ui32Count++)
+            {
+                if((++g_ui32Received % g_ui32DropEvery) == 0)
+                {
+                    memmove(&g_pui8RxData[ui32Count],
+                            &g_pui8RxData[ui32Count + 1],
+                            --g_ui32RxCount - ui32Count);
+                    g_ui32Overruns++;
+                    g_bOverrun = true;
+                }
+            }
+        }
+        return(g_ui32RxCount - g_ui32RxHead);
+    }
+
+    ui32Count = 0;
+    while(((g_ui32RxHead + ui32Count) < g_ui32RxCount) &&
+          (g_pui64RxTime[g_ui32RxHead + ui32Count] <= g_ui64Now))
+    {
+        if(ui32Count == ui32Depth)
+        {
+            //
+            // The FIFO was full when this byte arrived, so it was lost.
+            //
+            memmove(&g_pui8RxData[g_ui32RxHead + ui32Count],
+                    &g_pui8RxData[g_ui32RxHead + ui32Count + 1],
+                    g_ui32RxCount - (g_ui32RxHead + ui32Count + 1));
+            memmove(&g_pui64RxTime[g_ui32RxHead + ui32Count],
+                    &g_pui64RxTime[g_ui32RxHead + ui32Count + 1],
+                    (g_ui32RxCount - (g_ui32RxHead + ui32Count + 1)) *
+                    sizeof(uint64_t));
+            g_ui32RxCount--;
+            g_ui32Overruns++;
+            g_bOverrun = true;
+            continue;
+        }
+        ui32Count++;
+    }
+
+    return(ui32Count);
+}
+
+//*****************************************************************************
+//
+// Returns the number of received bytes waiting in the UART receive FIFO.
+// When the boot loader is built with the SSI, the host model drives that
+// instead and nothing reaches the UART.
+//
+//*****************************************************************************
+static uint32_t
+SimUARTRxAvailable(void)
+{
+#ifdef SSI_ENABLE_UPDATE
+    return(0);
+#else
+    return(SimRxAvailable(SIM_UART_FIFO));
+#endif
+}
+
+//*****************************************************************************
+//
+// Returns the time of the next event in the models after the current time,
+// or zero if nothing is pending.
+//
+//*****************************************************************************
+static uint64_t
+SimNextEvent(void)
+{
+    uint64_t ui64Next;
+
+#define SIM_EVENT(t)                                                          \
+        if(((t) > g_ui64Now) && (!ui64Next || ((t) < ui64Next)))              \
+        {                                                                     \
+            ui64Next = (t);                                                   \
+        }
+
+    ui64Next = 0;
+    if(g_ui32RxHead < g_ui32RxCount)
+    {
+        SIM_EVENT(g_pui64RxTime[g_ui32RxHead]);
+    }
+    else if(g_ui32Frame < g_ui32NumFrames)
+    {
+        SIM_EVENT(g_ui64ReplyDeadline);
+    }
+    if(g_bTimerRunning)
+    {
+        SIM_EVENT(g_ui64TimerExpiry);
+    }
+    SIM_EVENT(g_ui64FlashBusyUntil);
+#ifdef BL_WATCHDOG_TIMEOUT
+    if(g_bWatchdogRunning)
+    {
+        SIM_EVENT(g_ui64WatchdogExpiry);
+    }
+#endif
+    if(g_ui64TxFreeAt > g_ui64Now)
+    {
+        SIM_EVENT(g_ui64Now + (((g_ui64TxFreeAt - g_ui64Now - 1) %
+                                g_ui64ByteCycles) + 1));
+    }
+#ifdef SSI_ENABLE_UPDATE
+    SIM_EVENT(SimSSINextEvent());
+#endif
+#ifdef CAN_ENABLE_UPDATE
+    SIM_EVENT(SimCANNextEvent());
+#endif
+#ifdef ENET_ENABLE_UPDATE
+    SIM_EVENT(SimEMACNextEvent());
+#endif
+#ifdef USB_ENABLE_UPDATE
+    SIM_EVENT(SimUSBNextEvent());
+#endif
+
+    return(ui64Next);
+}
+
+//*****************************************************************************
+//
+// Waits in real time for the host to write to the pty or for the next event
+// in the models, whichever comes first, and advances the simulated time by
+// the time that passed.
+//
+//*****************************************************************************
+static void
+SimPtyWait(uint64_t ui64Next)
+{
+    struct timespec sStart, sEnd;
+    struct pollfd sPoll;
+    uint64_t ui64Elapsed;
+    int iTimeout;
+
+    iTimeout = -1;
+    if(ui64Next)
+    {
+        iTimeout = (int)(((ui64Next - g_ui64Now) * 1000 + g_ui32SysClockHz -
+                          1) / g_ui32SysClockHz);
+    }
+
+    sPoll.fd = g_iPtyFd;
+    sPoll.events = POLLIN;
+    clock_gettime(CLOCK_MONOTONIC, &sStart);
+    poll(&sPoll, 1, iTimeout);
+    clock_gettime(CLOCK_MONOTONIC, &sEnd);
+
+    ui64Elapsed = (((uint64_t)(sEnd.tv_sec - sStart.tv_sec) * 1000000000) +
+                   sEnd.tv_nsec - sStart.tv_nsec);
+    g_ui64Now += (ui64Elapsed * (g_ui32SysClockHz / 1000000)) / 1000;
+    if(ui64Next && !(sPoll.revents & POLLIN) && (g_ui64Now < ui64Next))
+    {
+        g_ui64Now = ui64Next;
+    }
+}
+
+//*****************************************************************************
+//
+// Advances time to the next event, called when the boot loader is polling a
+// status register whose value has not changed since it was last read.
+//
+//*****************************************************************************
+static void
+SimIdle(uint32_t ui32Address)
+{
+    uint64_t ui64Next;
+
+    ui64Next = SimNextEvent();
+    if(g_iPtyFd >= 0)
+    {
+        SimPtyWait(ui64Next);
+        return;
+    }
+#ifdef UART_NODE_ID
+    if(g_iBusFd >= 0)
+    {
+        SimBusWait(ui64Next);
+        return;
+    }
+#endif
+    if(!ui64Next)
+    {
+        fprintf(stderr, "blsim: boot loader stalled at frame %u polling "
+                "0x%08x\n", g_ui32Frame, ui32Address);
+        exit(1);
+    }
+    g_ui64Now = ui64Next;
+}
+
+//*****************************************************************************
+//
+// Returns true if the register is one of the status registers that the boot
+// loader polls while it waits, which on their own do not show that it is
+// doing anything else.
+//
+//*****************************************************************************
+static bool
+SimPolled(uint32_t ui32Address)
+{
+    if((ui32Address == (UART0_BASE + UART_O_FR)) ||
+       (ui32Address == (BL_TIMER_BASE + TIMER_O_RIS)))
+    {
+        return(true);
+    }
+#ifdef SSI_ENABLE_UPDATE
+    return(SimSSIPolled(ui32Address));
+#elif defined(CAN_ENABLE_UPDATE)
+    return(SimCANPolled(ui32Address));
+#elif defined(ENET_ENABLE_UPDATE)
+    return(SimEMACPolled(ui32Address));
+#else
+    return(false);
+#endif
+}
+
+//*****************************************************************************
+//
+// Notes a read of a polled status register.  Once the boot loader has read
+// the same value from it enough times in a row, without doing anything else
+// in between, it is waiting for the next event and time is advanced to it.
+//
+//*****************************************************************************
+void
+SimPoll(uint32_t ui32Address, uint32_t ui32Value)
+{
+    tSimPoll *psPoll;
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < g_ui32NumPolls; ui32Idx++)
+    {
+        if(g_psPolls[ui32Idx].ui32Address == ui32Address)
+        {
+            break;
+        }
+    }
+    if(ui32Idx == SIM_NUM_POLLS)
+    {
+        return;
+    }
+    psPoll = &g_psPolls[ui32Idx];
+    if(ui32Idx == g_ui32NumPolls)
+    {
+        g_ui32NumPolls++;
+        psPoll->ui32Address = ui32Address;
+        psPoll->ui32Value = ~ui32Value;
+    }
+
+    if(psPoll->ui32Value != ui32Value)
+    {
+        psPoll->ui32Value = ui32Value;
+        psPoll->ui32Repeats = 0;
+    }
+    else if(++psPoll->ui32Repeats >= SIM_POLL_REPEATS)
+    {
+        SimIdle(ui32Address);
+        psPoll->ui32Repeats = 0;
+    }
+}
+
+#ifdef BL_WATCHDOG_TIMEOUT
+//*****************************************************************************
+//
+// Reloads the watchdog model, noting the gap since it was last reloaded.
+//
+//*****************************************************************************
+static void
+SimWatchdogReload(void)
+{
+    if(g_ui32WatchdogFeeds && ((g_ui64Now - g_ui64WatchdogFed) >
+                               g_ui64WatchdogGap))
+    {
+        g_ui64WatchdogGap = g_ui64Now - g_ui64WatchdogFed;
+    }
+    g_ui64WatchdogFed = g_ui64Now;
+    g_ui64WatchdogExpiry =
+        g_ui64Now +
+        (2 * ((uint64_t)SimRegFind(WATCHDOG0_BASE + WDT_O_LOAD)->ui32Value +
+              1));
+    g_ui32WatchdogFeeds++;
+}
+
+//*****************************************************************************
+//
+// Stops the watchdog model, as a reset of the board or of the watchdog does,
+// clearing the control register so that it reads as not running.
+//
+//*****************************************************************************
+static void
+SimWatchdogStop(void)
+{
+    g_bWatchdogRunning = false;
+    SimRegFind(WATCHDOG0_BASE + WDT_O_CTL)->ui32Value = 0;
+    g_psLastReg = 0;
+}
+#endif
+
+//*****************************************************************************
+//
+// Returns the value that a read of a register would return now.
+//
+//*****************************************************************************
+static uint32_t
+SimRead(uint32_t ui32Address, uint32_t ui32Value)
+{
+    uint32_t ui32FR;
+
+    //
+    // Every peripheral reports itself ready as soon as it is enabled.
+    //
+    if((ui32Address >= 0x400fea00) && (ui32Address < 0x400feb00))
+    {
+        return(0xffffffff);
+    }
+
+    switch(ui32Address)
+    {
+        case UART0_BASE + UART_O_FR:
+        {
+            if((g_ui32RxHead >= g_ui32RxCount) &&
+               (g_ui64Now >= g_ui64ReplyDeadline) &&
+               (g_ui32Frame < g_ui32NumFrames))
+            {
+                SimReplyTimeout();
+            }
+            ui32FR = 0;
+            if(!SimUARTRxAvailable())
+            {
+                ui32FR |= UART_FR_RXFE;
+            }
+            if(g_ui64TxFreeAt <= g_ui64Now)
+            {
+                ui32FR |= UART_FR_TXFE;
+            }
+            else
+            {
+                ui32FR |= UART_FR_BUSY;
+                if((g_ui64TxFreeAt - g_ui64Now) >
+                   (SIM_UART_FIFO * g_ui64ByteCycles))
+                {
+                    ui32FR |= UART_FR_TXFF;
+                }
+            }
+            SimPoll(ui32Address, ui32FR);
+            return(ui32FR);
+        }
+
+        case UART0_BASE + UART_O_DR:
+        {
+            if(SimUARTRxAvailable())
+            {
+                return(SIM_UART_READ_MARK | g_pui8RxData[g_ui32RxHead]);
+            }
+            return(SIM_UART_READ_MARK);
+        }
+
+        case UART0_BASE + UART_O_RSR:
+        {
+            return(g_bOverrun ? UART_RSR_OE : 0);
+        }
+
+        case NVIC_ST_CURRENT:
+        {
+            return(NVIC_ST_RELOAD_M - (g_ui64Now & NVIC_ST_RELOAD_M));
+        }
+
+        case BL_TIMER_BASE + TIMER_O_RIS:
+        {
+            if(g_bTimerRunning && (g_ui64Now >= g_ui64TimerExpiry))
+            {
+                g_bTimerRunning = false;
+                g_bTimerExpired = true;
+            }
+            return(g_bTimerExpired ? TIMER_RIS_TATORIS : 0);
+        }
+
+        case NVIC_APINT:
+        {
+            //
+            // The boot loader only writes this register, to reset, and then
+            // spins without making the further access that would show the
+            // write, so any access ends the run.  The reset stops the
+            // watchdog.
+            //
+#ifdef BL_WATCHDOG_TIMEOUT
+            SimWatchdogStop();
+#endif
+            longjmp(g_sDone, 1);
+        }
+
+        case BL_TIMER_BASE + TIMER_O_ICR:
+        case FLASH_FCMISC:
+        {
+            return(0);
+        }
+
+        case FLASH_FMC:
+        case FLASH_FMC2:
+        {
+            if(g_ui32FlashBusyBits && (g_ui64Now >= g_ui64FlashBusyUntil))
+            {
+                g_ui32FlashBusyBits = 0;
+            }
+            else if(g_ui32FlashBusyBits)
+            {
+                //
+                // The boot loader can only be polling for completion.
+                //
+                g_ui64Now = g_ui64FlashBusyUntil;
+                g_ui32FlashBusyBits = 0;
+            }
+            return(g_ui32FlashBusyBits);
+        }
+
+        case FLASH_FCRIS:
+        {
+            return(g_ui32FlashAccessError ? FLASH_FCRIS_ARIS : 0);
+        }
+
+        case FLASH_PP:
+        {
+            return((SIM_FLASH_SIZE >> 11) - 1);
+        }
+
+        default:
+        {
+#ifdef SSI_ENABLE_UPDATE
+            if(SimSSIRead(ui32Address, &ui32Value))
+            {
+                return(ui32Value);
+            }
+#endif
+#ifdef CAN_ENABLE_UPDATE
+            if(SimCANRead(ui32Address, &ui32Value))
+            {
+                return(ui32Value);
+            }
+#endif
+#ifdef ENET_ENABLE_UPDATE
+            if(SimEMACRead(ui32Address, &ui32Value))
+            {
+                return(ui32Value);
+            }
+#endif
+#ifdef USB_ENABLE_UPDATE
+            if(SimUSBRead(ui32Address, &ui32Value))
+            {
+                return(ui32Value);
+            }
+#endif
+
+            //
+            // The boot loader reads flash through HWREG() as well, for
+            // example to scan the progress journal.
+            //
+            if(ui32Address < SIM_FLASH_SIZE)
+            {
+                return(g_pui8Flash[ui32Address] |
+                       (g_pui8Flash[ui32Address + 1] << 8) |
+                       (g_pui8Flash[ui32Address + 2] << 16) |
+                       ((uint32_t)g_pui8Flash[ui32Address + 3] << 24));
+            }
+            return(ui32Value);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Counts a flash operation that is about to start, losing power instead if
+// this is the operation that a power cut was set for.
+//
+//*****************************************************************************
+static void
+SimFlashOperation(void)
+{
+    if(g_ui32PowerCut && (++g_ui32FlashOps == g_ui32PowerCut))
+    {
+        longjmp(g_sPowerCut, 1);
+    }
+}
+
+//*****************************************************************************
+//
+// Programs a word of the flash array.  Programming can only clear bits.
+//
+//*****************************************************************************
+static void
+SimFlashWord(uint32_t ui32Idx, uint32_t ui32Data)
+{
+    ui32Idx &= ~3;
+    g_pui8Flash[ui32Idx + 0] &= ui32Data;
+    g_pui8Flash[ui32Idx + 1] &= ui32Data >> 8;
+    g_pui8Flash[ui32Idx + 2] &= ui32Data >> 16;
+    g_pui8Flash[ui32Idx + 3] &= ui32Data >> 24;
+    g_ui32Programs++;
+    if((ui32Idx + 4) > g_ui32FlashEnd)
+    {
+        g_ui32FlashEnd = ui32Idx + 4;
+    }
+}
+
+//*****************************************************************************
+//
+// Applies the side effects of a write to a register.
+//
+//*****************************************************************************
+static void
+SimWrite(tSimReg *psReg, uint32_t ui32Value)
+{
+    uint32_t ui32Address, ui32Idx, ui32Data, ui32Word;
+    uint64_t ui64Start;
+    uint8_t ui8Data;
+
+    ui32Address = psReg->ui32Address;
+    switch(ui32Address)
+    {
+        case UART0_BASE + UART_O_DR:
+        {
+            if(g_iPtyFd >= 0)
+            {
+                ui8Data = ui32Value;
+                if(write(g_iPtyFd, &ui8Data, 1) != 1)
+                {
+                    perror("blsim: pty");
+                    exit(1);
+                }
+                break;
+            }
+            ui64Start = (g_ui64TxFreeAt > g_ui64Now) ? g_ui64TxFreeAt :
+                                                       g_ui64Now;
+            g_ui64TxFreeAt = ui64Start + g_ui64ByteCycles;
+#ifdef UART_NODE_ID
+            if(g_iBusFd >= 0)
+            {
+                SimBusTx(ui32Value, g_ui64TxFreeAt);
+                break;
+            }
+#endif
+            SimReplyByte(ui32Value, g_ui64TxFreeAt);
+            break;
+        }
+
+#ifdef UART_NODE_ID
+        //
+        // PA2, the RS-485 driver enable, which the boot loader raises while
+        // it sends.
+        //
+        case GPIO_PORTA_BASE + GPIO_O_DATA + (GPIO_PIN_2 << 2):
+        {
+            if(g_iBusFd >= 0)
+            {
+                SimBusDrive(ui32Value != 0);
+            }
+            break;
+        }
+#endif
+
+        case UART0_BASE + UART_O_ECR:
+        {
+            g_bOverrun = false;
+            break;
+        }
+
+        case BL_TIMER_BASE + TIMER_O_CTL:
+        {
+            g_bTimerRunning = (ui32Value & TIMER_CTL_TAEN) ? true : false;
+            if(g_bTimerRunning)
+            {
+                g_ui64TimerExpiry =
+                    g_ui64Now +
+                    SimRegFind(BL_TIMER_BASE + TIMER_O_TAILR)->ui32Value;
+            }
+            break;
+        }
+
+        case BL_TIMER_BASE + TIMER_O_ICR:
+        {
+            if(ui32Value & TIMER_ICR_TATOCINT)
+            {
+                g_bTimerExpired = false;
+            }
+            psReg->ui32Value = 0;
+            break;
+        }
+
+        case FLASH_FMC:
+        {
+            ui32Idx = SimRegFind(FLASH_FMA)->ui32Value;
+            if((ui32Value & 0xffff0000) != FLASH_FMC_WRKEY)
+            {
+                break;
+            }
+            if(ui32Idx >= SIM_FLASH_SIZE)
+            {
+                g_ui32FlashAccessError = 1;
+            }
+            else if((ui32Value & FLASH_FMC_WRITE) &&
+                    ((ui32Idx & ~0x7f) == g_ui32FlashFailAddress))
+            {
+                g_ui32FlashAccessError = 1;
+                if((ui32Idx & 0x7f) == 0x7c)
+                {
+                    g_ui32FlashFailAddress = 0xffffffff;
+                }
+            }
+            else if(ui32Value & FLASH_FMC_ERASE)
+            {
+                SimFlashOperation();
+                memset(g_pui8Flash + (ui32Idx & ~(SIM_FLASH_BLOCK - 1)), 0xff,
+                       SIM_FLASH_BLOCK);
+                g_ui32FlashBusyBits = FLASH_FMC_ERASE;
+                g_ui64FlashBusyUntil = g_ui64Now + g_ui64EraseCycles;
+                g_ui32Erases++;
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+                g_pui32BlockErases[ui32Idx / SIM_FLASH_BLOCK]++;
+#endif
+#ifdef FLASH_JOURNAL_ADDRESS
+                if((ui32Idx & ~(SIM_FLASH_BLOCK - 1)) == FLASH_JOURNAL_ADDRESS)
+                {
+                    g_ui32JournalErases++;
+                }
+#endif
+#ifdef BL_UPDATE_STAGED
+                SimFlashCopyTime(ui32Idx);
+#endif
+            }
+            else if(ui32Value & FLASH_FMC_WRITE)
+            {
+                SimFlashOperation();
+                ui32Data = SimRegFind(FLASH_FMD)->ui32Value;
+                SimFlashWord(ui32Idx, ui32Data);
+                g_ui32FlashBusyBits = FLASH_FMC_WRITE;
+                g_ui64FlashBusyUntil = g_ui64Now + g_ui64ProgramCycles;
+#ifdef FLASH_JOURNAL_ADDRESS
+                if((ui32Idx & ~(SIM_FLASH_BLOCK - 1)) == FLASH_JOURNAL_ADDRESS)
+                {
+                    g_ui32JournalPrograms++;
+                }
+#endif
+#ifdef BL_UPDATE_STAGED
+                SimFlashCopyTime(ui32Idx);
+#endif
+            }
+            psReg->ui32Value = g_ui32FlashBusyBits;
+            break;
+        }
+
+        //
+        // A write buffer program writes each word of the 32 word aligned
+        // block at the address that has been loaded into the buffer since
+        // the last one.
+        //
+        case FLASH_FMC2:
+        {
+            ui32Idx = SimRegFind(FLASH_FMA)->ui32Value & ~0x7f;
+            if(((ui32Value & 0xffff0000) != FLASH_FMC2_WRKEY) ||
+               !(ui32Value & FLASH_FMC2_WRBUF))
+            {
+                break;
+            }
+            if(ui32Idx >= SIM_FLASH_SIZE)
+            {
+                g_ui32FlashAccessError = 1;
+            }
+            else
+            {
+                SimFlashOperation();
+                ui32Data = SimRegFind(FLASH_FWBVAL)->ui32Value;
+                for(ui32Word = 0; ui32Word < 32; ui32Word++)
+                {
+                    if(ui32Data & (1 << ui32Word))
+                    {
+                        SimFlashWord(ui32Idx + (ui32Word * 4),
+                                     SimRegFind(FLASH_FWBN +
+                                                (ui32Word * 4))->ui32Value);
+                    }
+                }
+                SimRegFind(FLASH_FWBVAL)->ui32Value = 0;
+                g_ui32FlashBusyBits = FLASH_FMC2_WRBUF;
+                g_ui64FlashBusyUntil = g_ui64Now + g_ui64BufferCycles;
+                g_ui32BufferPrograms++;
+#ifdef BL_UPDATE_STAGED
+                SimFlashCopyTime(ui32Idx);
+#endif
+            }
+            psReg->ui32Value = g_ui32FlashBusyBits;
+            break;
+        }
+
+        case FLASH_FCMISC:
+        {
+            if(ui32Value & FLASH_FCMISC_AMISC)
+            {
+                g_ui32FlashAccessError = 0;
+            }
+            psReg->ui32Value = 0;
+            break;
+        }
+
+#ifdef BL_WATCHDOG_TIMEOUT
+        //
+        // Setting the interrupt enable starts the watchdog, and a write of
+        // the load or interrupt clear register reloads it.  Only a reset,
+        // of the board or of the watchdog alone, stops it.
+        //
+        case WATCHDOG0_BASE + WDT_O_CTL:
+        {
+            if((ui32Value & WDT_CTL_INTEN) && !g_bWatchdogRunning)
+            {
+                g_bWatchdogRunning = true;
+                SimWatchdogReload();
+            }
+            break;
+        }
+
+        case WATCHDOG0_BASE + WDT_O_LOAD:
+        case WATCHDOG0_BASE + WDT_O_ICR:
+        {
+            if(g_bWatchdogRunning)
+            {
+                SimWatchdogReload();
+            }
+            if(ui32Address == (WATCHDOG0_BASE + WDT_O_ICR))
+            {
+                psReg->ui32Value = 0;
+            }
+            break;
+        }
+
+        case SYSCTL_SRWD:
+        {
+            if(ui32Value & SYSCTL_SRWD_R0)
+            {
+                SimWatchdogStop();
+            }
+            break;
+        }
+#endif
+
+        default:
+        {
+#ifdef SSI_ENABLE_UPDATE
+            if(SimSSIWrite(ui32Address, ui32Value))
+            {
+                break;
+            }
+#endif
+#ifdef CAN_ENABLE_UPDATE
+            if(SimCANWrite(ui32Address, ui32Value))
+            {
+                break;
+            }
+#endif
+#ifdef ENET_ENABLE_UPDATE
+            if(SimEMACWrite(ui32Address, ui32Value))
+            {
+                break;
+            }
+#endif
+#ifdef USB_ENABLE_UPDATE
+            if(SimUSBWrite(ui32Address, ui32Value))
+            {
+                break;
+            }
+#endif
+
+            //
+            // Loading a word into the write buffer marks it to be programmed.
+            //
+            if((ui32Address >= FLASH_FWBN) &&
+               (ui32Address < (FLASH_FWBN + 128)))
+            {
+                SimRegFind(FLASH_FWBVAL)->ui32Value |=
+                    1 << ((ui32Address - FLASH_FWBN) / 4);
+            }
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Resolves the last register access, applying the side effects of a write or
+// of a read that removes data.  This is done on the next access, or when a
+// model runs an interrupt handler of the boot loader's, as the handler's last
+// access would otherwise be lost.
+//
+// The access cannot tell whether the caller is going to read or write the
+// register, so the value that a read would see is placed in the register and
+// the caller is handed its location.  When the access is resolved the
+// register is checked again: if the value was changed, the access was a
+// write and its side effects are applied; if it was not, it was a read, and
+// a read of the UART or SSI data register removes the byte from its receive
+// FIFO.  The boot loader only ever writes the flash write buffer, so any
+// access to it is taken as a write, even of the value it held, as is any
+// access to a USB endpoint FIFO that holds no packet to be read.
+//
+//*****************************************************************************
+void
+SimRegResolve(void)
+{
+    tSimReg *psReg;
+
+    if(!g_psLastReg)
+    {
+        return;
+    }
+
+    psReg = g_psLastReg;
+    g_psLastReg = 0;
+    if((psReg->ui32Value != g_ui32LastValue) ||
+       ((psReg->ui32Address >= FLASH_FWBN) &&
+        (psReg->ui32Address < (FLASH_FWBN + 128))))
+    {
+        SimWrite(psReg, psReg->ui32Value);
+    }
+#ifdef USB_ENABLE_UPDATE
+    else if(SimUSBWriteOnly(psReg->ui32Address))
+    {
+        SimWrite(psReg, psReg->ui32Value);
+    }
+#endif
+    else if((psReg->ui32Address == (UART0_BASE + UART_O_DR)) &&
+            SimUARTRxAvailable())
+    {
+        g_ui32RxHead++;
+    }
+#ifdef SSI_ENABLE_UPDATE
+    else
+    {
+        SimSSIReadDone(psReg->ui32Address);
+    }
+#endif
+}
+
+//*****************************************************************************
+//
+// Returns the location of a register in the emulated register space.
+//
+// This is what HWREG() expands to.  Byte and halfword accesses are given the
+// location of the word that holds them, with their offset in it noted for
+// the models.
+//
+//*****************************************************************************
+volatile uint32_t *
+BLSimReg(uint32_t ui32Address)
+{
+    tSimReg *psReg;
+    uint32_t ui32Byte;
+
+    SimRegResolve();
+    ui32Byte = ui32Address & 3;
+    ui32Address &= ~3;
+
+    g_ui64Now += g_pfnBLSimCycleCost(ui32Address);
+#ifdef SSI_ENABLE_UPDATE
+    SimSSIUpdate();
+#endif
+#ifdef CAN_ENABLE_UPDATE
+    SimCANUpdate();
+#endif
+#ifdef ENET_ENABLE_UPDATE
+    SimEMACUpdate();
+#endif
+#ifdef USB_ENABLE_UPDATE
+    SimUSBUpdate();
+#endif
+#ifdef UART_NODE_ID
+    if(g_iBusFd >= 0)
+    {
+        SimBusUpdate();
+    }
+#endif
+
+#ifdef BL_WATCHDOG_TIMEOUT
+    //
+    // The watchdog resets the board once its time runs out.
+    //
+    if(g_bWatchdogRunning && (g_ui64Now >= g_ui64WatchdogExpiry) &&
+       (SimRegFind(WATCHDOG0_BASE + WDT_O_CTL)->ui32Value & WDT_CTL_RESEN))
+    {
+        g_ui64Now = g_ui64WatchdogExpiry;
+        g_bWatchdogReset = true;
+        SimWatchdogStop();
+        longjmp(g_sDone, 1);
+    }
+#endif
+
+    psReg = SimRegFind(ui32Address);
+
+    //
+    // Any access other than to a polled status register means that the boot
+    // loader is doing something other than waiting.
+    //
+    if(!SimPolled(ui32Address))
+    {
+        g_ui32NumPolls = 0;
+    }
+
+    g_ui32RegByte = ui32Byte;
+    psReg->ui32Value = SimRead(ui32Address, psReg->ui32Value);
+    g_psLastReg = psReg;
+    g_ui32LastValue = psReg->ui32Value;
+
+    return(&psReg->ui32Value);
+}
+
+//*****************************************************************************
+//
+// Replaces ROM_FlashProgram(), which is not available on the host, with a
+// word at a time program through the flash controller registers.
+//
+//*****************************************************************************
+uint32_t
+BLSimFlashProgram(uint32_t ui32DstAddr, uint8_t *pui8SrcData,
+                  uint32_t ui32Length)
+{
+    uint32_t ui32Loop;
+
+    for(ui32Loop = 0; ui32Loop < ui32Length; ui32Loop += 4)
+    {
+        HWREG(FLASH_FMA) = ui32DstAddr + ui32Loop;
+        HWREG(FLASH_FMD) = (pui8SrcData[ui32Loop] |
+                            (pui8SrcData[ui32Loop + 1] << 8) |
+                            (pui8SrcData[ui32Loop + 2] << 16) |
+                            ((uint32_t)pui8SrcData[ui32Loop + 3] << 24));
+        HWREG(FLASH_FMC) = FLASH_FMC_WRKEY | FLASH_FMC_WRITE;
+        while(HWREG(FLASH_FMC) & FLASH_FMC_WRITE)
+        {
+        }
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Stand-ins for the driverlib functions that the boot loader calls while
+// configuring the device.  Only the clock rate and baud rate matter here.
+//
+//*****************************************************************************
+uint32_t
+SysCtlClockFreqSet(uint32_t ui32Config, uint32_t ui32SysClock)
+{
+    (void)ui32Config;
+
+    g_ui32SysClockHz = ui32SysClock;
+    g_ui32ClockSets++;
+
+    return(ui32SysClock);
+}
+
+void
+SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+    (void)ui32Peripheral;
+}
+
+void
+SysCtlPeripheralReset(uint32_t ui32Peripheral)
+{
+    (void)ui32Peripheral;
+}
+
+bool
+SysCtlPeripheralReady(uint32_t ui32Peripheral)
+{
+    (void)ui32Peripheral;
+
+    return(true);
+}
+
+void
+SysCtlDelay(uint32_t ui32Count)
+{
+    //
+    // Each count of the delay loop takes three cycles.  The last register
+    // access was made before the delay, so takes effect before it.
+    //
+    SimRegResolve();
+    g_ui64Now += 3 * (uint64_t)ui32Count;
+}
+
+void
+GPIOPinConfigure(uint32_t ui32PinConfig)
+{
+    (void)ui32PinConfig;
+}
+
+void
+GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+void
+GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+void
+UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk,
+                    uint32_t ui32Baud, uint32_t ui32Config)
+{
+    (void)ui32Base;
+    (void)ui32UARTClk;
+    (void)ui32Config;
+
+    g_ui32BaudRate = ui32Baud;
+    g_ui32UARTSets++;
+}
+
+void
+UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    (void)ui32Base;
+    (void)ui32IntFlags;
+}
+
+#ifdef SIM_EEPROM
+//*****************************************************************************
+//
+// Stand-ins for the driverlib EEPROM functions, which keep the EEPROM in an
+// array.  Like code that does not touch a register, they take no time.
+//
+//*****************************************************************************
+static void
+SimEEPROMCheck(uint32_t ui32Address, uint32_t ui32Count)
+{
+    if((ui32Address & 3) || (ui32Count & 3) ||
+       ((ui32Address + ui32Count) > SIM_EEPROM_SIZE))
+    {
+        fprintf(stderr, "blsim: bad EEPROM access of %u bytes at 0x%04x\n",
+                ui32Count, ui32Address);
+        exit(1);
+    }
+}
+
+uint32_t
+EEPROMInit(void)
+{
+    return(EEPROM_INIT_OK);
+}
+
+void
+EEPROMRead(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    SimEEPROMCheck(ui32Address, ui32Count);
+    memcpy(pui32Data, g_pui8EEPROM + ui32Address, ui32Count);
+}
+
+uint32_t
+EEPROMProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    uint32_t ui32Idx;
+
+    SimEEPROMCheck(ui32Address, ui32Count);
+    for(ui32Idx = 0; ui32Idx < ui32Count; ui32Idx += 4)
+    {
+        if(g_ui32EEPROMCut && ((g_ui32EEPROMWords + 1) == g_ui32EEPROMCut))
+        {
+            longjmp(g_sPowerCut, 1);
+        }
+        memcpy(g_pui8EEPROM + ui32Address + ui32Idx, pui32Data++, 4);
+        g_ui32EEPROMWords++;
+    }
+
+    return(0);
+}
+#endif
+
+//*****************************************************************************
+//
+// Creates the pseudo-terminal that a host updater connects to, in raw mode,
+// and links it from the given path.
+//
+//*****************************************************************************
+static void
+SimPtyRemoveLink(void)
+{
+    unlink(g_pcPtyLink);
+}
+
+void
+SimPtyOpen(const char *pcLink)
+{
+    struct termios sTermios;
+    const char *pcName;
+    int iSlave;
+
+    g_iPtyFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if((g_iPtyFd < 0) || grantpt(g_iPtyFd) || unlockpt(g_iPtyFd) ||
+       !(pcName = ptsname(g_iPtyFd)))
+    {
+        perror("blsim: pty");
+        exit(1);
+    }
+
+    //
+    // Hold the slave side open so that the line settings stick and the pty
+    // survives the host updater closing and reopening it.
+    //
+    iSlave = open(pcName, O_RDWR | O_NOCTTY);
+    if((iSlave < 0) || tcgetattr(iSlave, &sTermios))
+    {
+        perror(pcName);
+        exit(1);
+    }
+    cfmakeraw(&sTermios);
+    tcsetattr(iSlave, TCSANOW, &sTermios);
+
+    unlink(pcLink);
+    if(symlink(pcName, pcLink))
+    {
+        perror(pcLink);
+        exit(1);
+    }
+    g_pcPtyLink = pcLink;
+    atexit(SimPtyRemoveLink);
+
+    printf("blsim: serving %s on %s\n", pcLink, pcName);
+    fflush(stdout);
+}
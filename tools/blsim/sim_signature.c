@@ -0,0 +1,260 @@
+//*****************************************************************************
+//
+// sim_signature.c - Checks of the image signature.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DCHECK_SIGNATURE, the boot loader's ECDSA is checked against the
+// P-256 example of RFC 6979 before the run and, once the image has been
+// programmed, its signature is checked as the boot loader would at reset,
+// then again after changing a byte of it and after erasing its end,
+// reporting the time that each check takes on the host.  With
+// SIGN_CACHE_ADDRESS, the cache is checked to skip the verification of the
+// image recorded and to refuse the image once it has been changed while the
+// record stays in place.  Sign the image with the key that SIGN_PUBLIC_KEY
+// gives, using "blpack -s".
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "blsim.h"
+
+#ifdef CHECK_SIGNATURE
+#include "boot_loader/bl_check.h"
+#include "boot_loader/bl_ecdsa.h"
+
+//*****************************************************************************
+//
+// Returns the time taken since the given time, in microseconds.
+//
+//*****************************************************************************
+static double
+SimElapsedUs(const struct timespec *psStart)
+{
+    struct timespec sEnd;
+
+    clock_gettime(CLOCK_MONOTONIC, &sEnd);
+    return(((sEnd.tv_sec - psStart->tv_sec) * 1e6) +
+           ((sEnd.tv_nsec - psStart->tv_nsec) / 1e3));
+}
+
+//*****************************************************************************
+//
+// Checks the boot loader's ECDSA against the P-256 and SHA-256 example of
+// RFC 6979, section A.2.5, for the message "sample", then checks that it
+// rejects the signature once the digest or r has been changed, or r is zero
+// or s is n.  Returns non-zero if any result is wrong.
+//
+//*****************************************************************************
+int
+SimECDSACheck(void)
+{
+    static const uint32_t pui32Key[ECDSA_KEY_SIZE / 4] =
+    {
+        0x60fed4ba, 0x255a9d31, 0xc961eb74, 0xc6356d68,
+        0xc049b892, 0x3b61fa6c, 0xe669622e, 0x60f29fb6,
+        0x7903fe10, 0x08b8bc99, 0xa41ae9e9, 0x5628bc64,
+        0xf2f1b20c, 0x2d7e9f51, 0x77a3c294, 0xd4462299
+    };
+    static const uint8_t pui8Signature[ECDSA_SIGNATURE_SIZE] =
+    {
+        0xef, 0xd4, 0x8b, 0x2a, 0xac, 0xb6, 0xa8, 0xfd,
+        0x11, 0x40, 0xdd, 0x9c, 0xd4, 0x5e, 0x81, 0xd6,
+        0x9d, 0x2c, 0x87, 0x7b, 0x56, 0xaa, 0xf9, 0x91,
+        0xc3, 0x4d, 0x0e, 0xa8, 0x4e, 0xaf, 0x37, 0x16,
+        0xf7, 0xcb, 0x1c, 0x94, 0x2d, 0x65, 0x7c, 0x41,
+        0xd4, 0x36, 0xc7, 0xa1, 0xb6, 0xe2, 0x9f, 0x65,
+        0xf3, 0xe9, 0x00, 0xdb, 0xb9, 0xaf, 0xf4, 0x06,
+        0x4d, 0xc4, 0xab, 0x2f, 0x84, 0x3a, 0xcd, 0xa8
+    };
+    static const uint8_t pui8N[32] =
+    {
+        0xff, 0xff, 0xff, 0xff, 0x00, 0x00, 0x00, 0x00,
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+        0xbc, 0xe6, 0xfa, 0xad, 0xa7, 0x17, 0x9e, 0x84,
+        0xf3, 0xb9, 0xca, 0xc2, 0xfc, 0x63, 0x25, 0x51
+    };
+    uint8_t pui8Digest[SHA256_DIGEST_SIZE], pui8Bad[ECDSA_SIGNATURE_SIZE];
+    tSHA256Context sContext;
+    struct timespec sStart;
+    double dUs;
+    int iFailed;
+
+    SHA256Init(&sContext);
+    SHA256Update(&sContext, (const uint8_t *)"sample", 6);
+    SHA256Final(&sContext, pui8Digest);
+
+    clock_gettime(CLOCK_MONOTONIC, &sStart);
+    iFailed = !ECDSAVerify(pui32Key, pui8Digest, pui8Signature);
+    dUs = SimElapsedUs(&sStart);
+
+    memcpy(pui8Bad, pui8Signature, sizeof(pui8Bad));
+    pui8Bad[31] ^= 1;
+    iFailed |= ECDSAVerify(pui32Key, pui8Digest, pui8Bad);
+    memset(pui8Bad, 0, 32);
+    iFailed |= ECDSAVerify(pui32Key, pui8Digest, pui8Bad);
+    memcpy(pui8Bad, pui8Signature, 32);
+    memcpy(pui8Bad + 32, pui8N, 32);
+    iFailed |= ECDSAVerify(pui32Key, pui8Digest, pui8Bad);
+    pui8Digest[0] ^= 0x80;
+    iFailed |= ECDSAVerify(pui32Key, pui8Digest, pui8Signature);
+
+    printf("ecdsa:     RFC 6979 P-256 example %s, %.0f us on this host\n",
+           iFailed ? "FAILED" : "ok", dUs);
+
+    return(iFailed);
+}
+
+//*****************************************************************************
+//
+// Checks the signature of the image programmed, as the boot loader does at
+// reset, then checks that the image is refused once a byte of it has been
+// changed and once its end, with the signature, has been erased as if the
+// download had been cut short.  With SIGN_CACHE_ADDRESS, also checks that
+// the cache remembers the image until it is cleared, including once the
+// cache has filled and been erased, and that a changed image is refused
+// even though its record is still in place.  The flash is restored after
+// each change.  Returns non-zero if any result is wrong.
+//
+//*****************************************************************************
+int
+SimSignatureCheck(uint32_t ui32Size)
+{
+    uint32_t ui32Retcode, ui32Offset, ui32Length;
+#ifdef SIGN_CACHE_ADDRESS
+    uint8_t pui8Digest[SHA256_DIGEST_SIZE];
+    double dFullUs;
+#endif
+    struct timespec sStart;
+    uint8_t *pui8Saved;
+    double dUs;
+    int iFailed;
+
+    iFailed = 0;
+    pui8Saved = malloc(ui32Size);
+    if(!pui8Saved)
+    {
+        fprintf(stderr, "blsim: out of memory\n");
+        exit(1);
+    }
+    memcpy(pui8Saved, g_pui8Flash + APP_START_ADDRESS, ui32Size);
+
+    //
+    // The image as programmed.
+    //
+    clock_gettime(CLOCK_MONOTONIC, &sStart);
+    ui32Retcode = CheckImageSignature(APP_START_ADDRESS);
+    dUs = SimElapsedUs(&sStart);
+    printf("signature: valid image %s, %.0f us on this host\n",
+           (ui32Retcode == CHECK_SIGN_OK) ? "accepted" : "FAILED", dUs);
+    iFailed |= (ui32Retcode != CHECK_SIGN_OK);
+    if(iFailed)
+    {
+        printf("           (is the image signed with the key that "
+               "SIGN_PUBLIC_KEY gives?)\n");
+    }
+
+    //
+    // One bit changed in the middle of the image.
+    //
+    ui32Offset = APP_START_ADDRESS + (ui32Size / 2);
+    g_pui8Flash[ui32Offset] ^= 0x10;
+    clock_gettime(CLOCK_MONOTONIC, &sStart);
+    ui32Retcode = CheckImageSignature(APP_START_ADDRESS);
+    dUs = SimElapsedUs(&sStart);
+    printf("signature: tampered image %s, %.0f us\n",
+           (ui32Retcode == CHECK_SIGN_BAD_SIGN) ? "refused" : "FAILED", dUs);
+    iFailed |= (ui32Retcode != CHECK_SIGN_BAD_SIGN);
+    g_pui8Flash[ui32Offset] ^= 0x10;
+
+    //
+    // The last quarter of the image erased, as if only the start of it had
+    // been downloaded.
+    //
+    ui32Length = ui32Size / 4;
+    memset(g_pui8Flash + APP_START_ADDRESS + ui32Size - ui32Length, 0xff,
+           ui32Length);
+    clock_gettime(CLOCK_MONOTONIC, &sStart);
+    ui32Retcode = CheckImageSignature(APP_START_ADDRESS);
+    dUs = SimElapsedUs(&sStart);
+    printf("signature: truncated image %s, %.0f us\n",
+           (ui32Retcode != CHECK_SIGN_OK) ? "refused" : "FAILED", dUs);
+    iFailed |= (ui32Retcode == CHECK_SIGN_OK);
+    memcpy(g_pui8Flash + APP_START_ADDRESS, pui8Saved, ui32Size);
+
+#ifdef SIGN_CACHE_ADDRESS
+    //
+    // The cache misses until the image is recorded, then hits until it is
+    // cleared, and survives filling up.
+    //
+    ImageSignatureDigest(APP_START_ADDRESS, pui8Digest);
+    ui32Retcode = SignCacheCheck(pui8Digest);
+    SignCacheRecord(pui8Digest);
+    ui32Retcode |= !SignCacheCheck(pui8Digest) << 1;
+    SignCacheClear();
+    ui32Retcode |= SignCacheCheck(pui8Digest) << 2;
+    for(ui32Length = 0; ui32Length < (SIM_FLASH_BLOCK / 40); ui32Length++)
+    {
+        SignCacheRecord(pui8Digest);
+        SignCacheClear();
+    }
+
+    //
+    // The full check that records the image, then the check at the next
+    // reset, which only hashes it.
+    //
+    clock_gettime(CLOCK_MONOTONIC, &sStart);
+    ui32Retcode |= (SignCheckImage(APP_START_ADDRESS) != CHECK_SIGN_OK) << 3;
+    dFullUs = SimElapsedUs(&sStart);
+    ui32Retcode |= !SignCacheCheck(pui8Digest) << 4;
+    clock_gettime(CLOCK_MONOTONIC, &sStart);
+    ui32Retcode |= (SignCheckImage(APP_START_ADDRESS) != CHECK_SIGN_OK) << 5;
+    dUs = SimElapsedUs(&sStart);
+    printf("signature: cache %s, %.0f us for a recorded image against "
+           "%.0f us\n", ui32Retcode ? "FAILED" : "ok", dUs, dFullUs);
+    iFailed |= (ui32Retcode != 0);
+
+    //
+    // The image changed with its record still in place, which must be
+    // verified again and refused, leaving the record as it was.
+    //
+    ui32Offset = APP_START_ADDRESS + (ui32Size / 2);
+    g_pui8Flash[ui32Offset] ^= 0x10;
+    ui32Retcode = SignCheckImage(APP_START_ADDRESS);
+    g_pui8Flash[ui32Offset] ^= 0x10;
+    printf("signature: tampered image with cache %s\n",
+           (ui32Retcode == CHECK_SIGN_BAD_SIGN) ? "refused" : "FAILED");
+    iFailed |= (ui32Retcode != CHECK_SIGN_BAD_SIGN);
+    iFailed |= !SignCacheCheck(pui8Digest);
+#endif
+
+    free(pui8Saved);
+
+    return(iFailed);
+}
+#endif
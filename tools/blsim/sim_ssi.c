@@ -0,0 +1,600 @@
+//*****************************************************************************
+//
+// sim_ssi.c - Models of the SSI and of the uDMA controller.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DSSI_ENABLE_UPDATE the host model drives the download through the
+// SSI in place of the UART, as the master of the link.  It waits for the boot
+// loader to raise its ready output before it clocks each frame in, and clocks
+// the whole frame in without waiting again.  It then waits for the output to
+// fall and rise again before it clocks the response out, as many bytes as it
+// expects, and for the same again before the next frame.  The SSI model keeps
+// the eight byte receive and transmit FIFOs, so a boot loader that falls
+// behind the host loses received bytes or hands the host the empty transmit
+// FIFO, and both are counted.  The bytes that the host clocks in while it
+// reads a response are only ever discarded, so only their number is kept.
+//
+// With -DSSI_ENABLE_DMA as well, the uDMA model plays the part of the uDMA
+// controller for the SSI receive channel.  It reads the channel control
+// structure that the driverlib functions set up, in the table whose address
+// the boot loader gives it, and moves bytes from the receive FIFO into the
+// buffer that the structure describes: four at a time while the FIFO is at
+// least half full and singly otherwise.  It counts the transfer size down as
+// the controller does and disables the channel once the transfer is done.
+// The driverlib functions keep addresses in 32 bits, so the simulator is
+// linked below 4 GB for them to be those of the boot loader's buffers.
+//
+// After the run the check fails if a byte was lost either way or, with
+// SSI_ENABLE_DMA, if no data went through the uDMA model or a transfer was
+// set up that it does not model.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "inc/hw_gpio.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_ssi.h"
+#include "inc/hw_udma.h"
+#include "blsim.h"
+
+#ifdef SSI_ENABLE_UPDATE
+#include "driverlib/udma.h"
+#include "boot_loader/bl_ssi.h"
+
+#ifndef SSI_READYPIN_BASE
+#error ERROR: The SSI host model needs the ready output, SSI_READYPIN_BASE.
+#endif
+
+//*****************************************************************************
+//
+// The registers of the SSI and the ready output that the models watch.
+//
+//*****************************************************************************
+#define SIM_SSI_DR              (SSIx_BASE + SSI_O_DR)
+#define SIM_SSI_SR              (SSIx_BASE + SSI_O_SR)
+#define SIM_SSI_READY           (SSI_READYPIN_BASE + GPIO_O_DATA +            \
+                                 (SSI_READY << 2))
+
+//*****************************************************************************
+//
+// What the host model is doing on the SSI: waiting for the boot loader to be
+// ready for a frame, clocking the frame in, waiting for the boot loader to be
+// ready with the response, clocking the response out, or none of these.
+//
+//*****************************************************************************
+#define SIM_SSI_IDLE            0
+#define SIM_SSI_SEND_WAIT       1
+#define SIM_SSI_SEND            2
+#define SIM_SSI_REPLY_WAIT      3
+#define SIM_SSI_REPLY           4
+
+//*****************************************************************************
+//
+// The host model's state on the SSI.  g_ui64SSIStart is the earliest that it
+// may start what it is waiting to do, and g_ui64SSIClock the time that the
+// next byte of a response finishes.  g_bSSIReadyLow is set once the ready
+// output has been seen low since the host last started waiting on it.
+//
+//*****************************************************************************
+static uint32_t g_ui32SSIHost;
+static uint64_t g_ui64SSIStart;
+static uint64_t g_ui64SSIClock;
+static bool g_bSSIReady;
+static bool g_bSSIReadyLow;
+static uint64_t g_ui64SSIReadyAt;
+
+//*****************************************************************************
+//
+// The SSI model: the transmit FIFO, the number of discarded bytes in the
+// receive FIFO, and the counts of the bytes lost either way.
+//
+//*****************************************************************************
+static uint8_t g_pui8SSITx[SIM_SSI_FIFO];
+static uint32_t g_ui32SSITxHead;
+static uint32_t g_ui32SSITxCount;
+static uint32_t g_ui32SSIFill;
+static uint32_t g_ui32SSIUnderruns;
+static uint32_t g_ui32SSITxLost;
+
+#ifdef SSI_ENABLE_DMA
+//*****************************************************************************
+//
+// The uDMA model: the enabled channels and the counts of what it moved.
+//
+//*****************************************************************************
+static uint32_t g_ui32DMAEnabled;
+static uint32_t g_ui32DMABytes;
+static uint32_t g_ui32DMABursts;
+static uint32_t g_ui32DMASingles;
+static uint32_t g_ui32DMAErrors;
+#endif
+
+//*****************************************************************************
+//
+// Returns the number of bytes in the SSI receive FIFO.
+//
+//*****************************************************************************
+static uint32_t
+SimSSIRxCount(void)
+{
+    return(SimRxAvailable(SIM_SSI_FIFO) + g_ui32SSIFill);
+}
+
+//*****************************************************************************
+//
+// Removes the next byte from the SSI receive FIFO and returns it.
+//
+//*****************************************************************************
+static uint8_t
+SimSSIRxPop(void)
+{
+    if(SimRxAvailable(SIM_SSI_FIFO))
+    {
+        return(g_pui8RxData[g_ui32RxHead++]);
+    }
+    if(g_ui32SSIFill)
+    {
+        g_ui32SSIFill--;
+    }
+
+    return(0xff);
+}
+
+#ifdef SSI_ENABLE_DMA
+//*****************************************************************************
+//
+// Moves what the SSI receive FIFO holds into the buffer of the SSI receive
+// channel while the channel is enabled.
+//
+//*****************************************************************************
+static void
+SimDMAService(void)
+{
+    tDMAControlTable *psControl;
+    uint32_t ui32Control, ui32Items, ui32Arb, ui32Count;
+    uint8_t *pui8Dst;
+
+    if(!(g_ui32DMAEnabled & (1 << SSI_RX_DMA_CHANNEL_NUM)) ||
+       !(SimRegFind(SSIx_BASE + SSI_O_DMACTL)->ui32Value &
+         SSI_DMACTL_RXDMAE) ||
+       !SimSSIRxCount())
+    {
+        return;
+    }
+
+    //
+    // Only basic transfers of bytes from the data register into a buffer are
+    // modelled.  Anything else is an error that stops the channel.
+    //
+    psControl = ((tDMAControlTable *)(uintptr_t)
+                 SimRegFind(UDMA_CTLBASE)->ui32Value +
+                 SSI_RX_DMA_CHANNEL_NUM);
+    ui32Control = psControl->ui32Control;
+    if(((ui32Control & UDMA_CHCTL_XFERMODE_M) != UDMA_CHCTL_XFERMODE_BASIC) ||
+       ((ui32Control & (UDMA_CHCTL_DSTINC_M | UDMA_CHCTL_DSTSIZE_M |
+                        UDMA_CHCTL_SRCINC_M | UDMA_CHCTL_SRCSIZE_M)) !=
+        (UDMA_CHCTL_DSTINC_8 | UDMA_CHCTL_SRCINC_NONE)) ||
+       ((uintptr_t)psControl->pvSrcEndAddr != SIM_SSI_DR))
+    {
+        g_ui32DMAErrors++;
+        g_ui32DMAEnabled &= ~(1 << SSI_RX_DMA_CHANNEL_NUM);
+        return;
+    }
+    ui32Arb = 1 << ((ui32Control & UDMA_CHCTL_ARBSIZE_M) >>
+                    UDMA_CHCTL_ARBSIZE_S);
+    ui32Items = ((ui32Control & UDMA_CHCTL_XFERSIZE_M) >>
+                 UDMA_CHCTL_XFERSIZE_S) + 1;
+    pui8Dst = (uint8_t *)psControl->pvDstEndAddr - (ui32Items - 1);
+
+    //
+    // The SSI asks for a burst once its receive FIFO is half full and for a
+    // single transfer otherwise.  The controller moves up to its arbitration
+    // size for a burst.
+    //
+    while(ui32Items && ((ui32Count = SimSSIRxCount()) != 0))
+    {
+        if(ui32Count >= (SIM_SSI_FIFO / 2))
+        {
+            ui32Count = (ui32Count < ui32Arb) ? ui32Count : ui32Arb;
+            g_ui32DMABursts++;
+        }
+        else
+        {
+            ui32Count = 1;
+            g_ui32DMASingles++;
+        }
+        for(; ui32Count && ui32Items; ui32Count--, ui32Items--)
+        {
+            *pui8Dst++ = SimSSIRxPop();
+            g_ui32DMABytes++;
+        }
+    }
+
+    //
+    // Count the transfer size down, and stop the channel once it is done.
+    //
+    if(ui32Items)
+    {
+        psControl->ui32Control = ((ui32Control & ~UDMA_CHCTL_XFERSIZE_M) |
+                                  ((ui32Items - 1) <<
+                                   UDMA_CHCTL_XFERSIZE_S));
+    }
+    else
+    {
+        psControl->ui32Control = (ui32Control &
+                                  ~(UDMA_CHCTL_XFERSIZE_M |
+                                    UDMA_CHCTL_XFERMODE_M));
+        g_ui32DMAEnabled &= ~(1 << SSI_RX_DMA_CHANNEL_NUM);
+    }
+}
+#endif
+
+//*****************************************************************************
+//
+// Has the host model wait to send the current frame until the boot loader is
+// ready for it, from the given time.  After a response the ready output is
+// still up from it, so the host waits for it to fall and rise again; when it
+// sends again after a timeout, it takes the output as it finds it.
+//
+//*****************************************************************************
+void
+SimSSIFrameQueue(uint64_t ui64Start)
+{
+    g_ui32SSIHost = SIM_SSI_SEND_WAIT;
+    g_ui64SSIStart = ui64Start;
+    g_bSSIReadyLow = (g_ui32Retries || !g_bSSIReady);
+    g_ui64ReplyDeadline = ui64Start + g_ui64HostTimeout;
+}
+
+//*****************************************************************************
+//
+// Brings the SSI, the uDMA controller and the host model up to the current
+// time.  Called on every register access.
+//
+//*****************************************************************************
+void
+SimSSIUpdate(void)
+{
+    uint64_t ui64Time;
+    uint8_t ui8Data;
+
+#ifdef SSI_ENABLE_DMA
+    SimDMAService();
+#endif
+
+    //
+    // Start the frame once the boot loader is ready for it.
+    //
+    if((g_ui32SSIHost == SIM_SSI_SEND_WAIT) && g_bSSIReady && g_bSSIReadyLow)
+    {
+        ui64Time = ((g_ui64SSIReadyAt > g_ui64SSIStart) ? g_ui64SSIReadyAt :
+                                                          g_ui64SSIStart);
+        if(ui64Time <= g_ui64Now)
+        {
+            g_ui32SSIHost = SIM_SSI_SEND;
+            g_bSSIReadyLow = false;
+            SimFrameClock(ui64Time);
+        }
+    }
+
+    //
+    // Once the whole frame is in, wait for the response.
+    //
+    if((g_ui32SSIHost == SIM_SSI_SEND) &&
+       (g_pui64RxTime[g_ui32RxCount - 1] <= g_ui64Now))
+    {
+        g_ui32SSIHost = SIM_SSI_REPLY_WAIT;
+        g_ui64SSIStart = g_pui64RxTime[g_ui32RxCount - 1];
+    }
+
+    //
+    // Start clocking the response out once the boot loader has it ready.
+    //
+    if((g_ui32SSIHost == SIM_SSI_REPLY_WAIT) && g_bSSIReady &&
+       g_bSSIReadyLow)
+    {
+        g_ui32SSIHost = SIM_SSI_REPLY;
+        g_bSSIReadyLow = false;
+        g_ui64SSIClock = (((g_ui64SSIReadyAt > g_ui64SSIStart) ?
+                           g_ui64SSIReadyAt : g_ui64SSIStart) +
+                          g_ui64ByteCycles);
+    }
+
+    //
+    // Clock out each byte of the response that is due, taking it from the
+    // transmit FIFO and clocking a byte into the receive FIFO in its place.
+    //
+    while((g_ui32SSIHost == SIM_SSI_REPLY) && (g_ui64SSIClock <= g_ui64Now))
+    {
+        ui64Time = g_ui64SSIClock;
+        g_ui64SSIClock += g_ui64ByteCycles;
+        if(g_ui32SSITxCount)
+        {
+            ui8Data = g_pui8SSITx[g_ui32SSITxHead];
+            g_ui32SSITxHead = (g_ui32SSITxHead + 1) % SIM_SSI_FIFO;
+            g_ui32SSITxCount--;
+        }
+        else
+        {
+            ui8Data = 0;
+            g_ui32SSIUnderruns++;
+        }
+        if(SimSSIRxCount() < SIM_SSI_FIFO)
+        {
+            g_ui32SSIFill++;
+        }
+        if((g_ui32ReplyBytes + 1) >= g_psFrames[g_ui32Frame].ui32ReplySize)
+        {
+            g_ui32SSIHost = SIM_SSI_IDLE;
+        }
+        SimReplyByte(ui8Data, ui64Time);
+    }
+
+    //
+    // Send the frame again if the response has not come in time.
+    //
+    if((g_ui32SSIHost != SIM_SSI_IDLE) && (g_ui32RxHead >= g_ui32RxCount) &&
+       (g_ui64Now >= g_ui64ReplyDeadline) &&
+       (g_ui32Frame < g_ui32NumFrames))
+    {
+        SimReplyTimeout();
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the time of the next event in the SSI model, or zero if there is
+// none.
+//
+//*****************************************************************************
+uint64_t
+SimSSINextEvent(void)
+{
+    if((g_ui32SSIHost == SIM_SSI_SEND_WAIT) && g_bSSIReady && g_bSSIReadyLow)
+    {
+        return((g_ui64SSIReadyAt > g_ui64SSIStart) ? g_ui64SSIReadyAt :
+                                                     g_ui64SSIStart);
+    }
+    if(g_ui32SSIHost == SIM_SSI_REPLY)
+    {
+        return(g_ui64SSIClock);
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Returns true if the register is one that the boot loader polls while it
+// waits on the SSI.  The ready output is among them, since the boot loader
+// keeps raising it while it polls for the start of a packet.
+//
+//*****************************************************************************
+bool
+SimSSIPolled(uint32_t ui32Address)
+{
+    switch(ui32Address)
+    {
+        case SIM_SSI_SR:
+        case SIM_SSI_READY:
+#ifdef SSI_ENABLE_DMA
+        case UDMA_ENASET:
+        case UDMA_CTLBASE:
+#endif
+        {
+            return(true);
+        }
+
+        default:
+        {
+            return(false);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Gives the value that a read of an SSI or uDMA register returns now,
+// returning false if the register is not one that these models keep.
+//
+//*****************************************************************************
+bool
+SimSSIRead(uint32_t ui32Address, uint32_t *pui32Value)
+{
+    uint32_t ui32Count;
+
+    switch(ui32Address)
+    {
+        case SIM_SSI_SR:
+        {
+            ui32Count = SimSSIRxCount();
+            *pui32Value = 0;
+            if(ui32Count)
+            {
+                *pui32Value |= SSI_SR_RNE;
+            }
+            if(ui32Count >= SIM_SSI_FIFO)
+            {
+                *pui32Value |= SSI_SR_RFF;
+            }
+            if(g_ui32SSITxCount < SIM_SSI_FIFO)
+            {
+                *pui32Value |= SSI_SR_TNF;
+            }
+            if(!g_ui32SSITxCount)
+            {
+                *pui32Value |= SSI_SR_TFE;
+            }
+            if(g_ui32SSIHost == SIM_SSI_REPLY)
+            {
+                *pui32Value |= SSI_SR_BSY;
+            }
+            SimPoll(ui32Address, *pui32Value);
+            return(true);
+        }
+
+        case SIM_SSI_DR:
+        {
+            *pui32Value = SIM_SSI_READ_MARK;
+            if(SimRxAvailable(SIM_SSI_FIFO))
+            {
+                *pui32Value |= g_pui8RxData[g_ui32RxHead];
+            }
+            else if(g_ui32SSIFill)
+            {
+                *pui32Value |= 0xff;
+            }
+            return(true);
+        }
+
+#ifdef SSI_ENABLE_DMA
+        case UDMA_ENASET:
+        {
+            *pui32Value = g_ui32DMAEnabled;
+            SimPoll(ui32Address, *pui32Value);
+            return(true);
+        }
+
+        case UDMA_ENACLR:
+        {
+            *pui32Value = 0;
+            return(true);
+        }
+#endif
+
+        default:
+        {
+            return(false);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Applies the side effects of a write to an SSI or uDMA register, returning
+// false if the register is not one that these models keep.
+//
+//*****************************************************************************
+bool
+SimSSIWrite(uint32_t ui32Address, uint32_t ui32Value)
+{
+    bool bReady;
+
+    switch(ui32Address)
+    {
+        case SIM_SSI_DR:
+        {
+            if(g_ui32SSITxCount == SIM_SSI_FIFO)
+            {
+                g_ui32SSITxLost++;
+            }
+            else
+            {
+                g_pui8SSITx[(g_ui32SSITxHead + g_ui32SSITxCount++) %
+                            SIM_SSI_FIFO] = ui32Value;
+            }
+            return(true);
+        }
+
+        case SIM_SSI_READY:
+        {
+            bReady = (ui32Value & SSI_READY) ? true : false;
+            if(bReady && !g_bSSIReady)
+            {
+                g_ui64SSIReadyAt = g_ui64Now;
+            }
+            if(!bReady)
+            {
+                g_bSSIReadyLow = true;
+            }
+            g_bSSIReady = bReady;
+            return(true);
+        }
+
+#ifdef SSI_ENABLE_DMA
+        case UDMA_ENASET:
+        {
+            g_ui32DMAEnabled |= ui32Value;
+            return(true);
+        }
+
+        case UDMA_ENACLR:
+        {
+            g_ui32DMAEnabled &= ~ui32Value;
+            return(true);
+        }
+#endif
+
+        default:
+        {
+            return(false);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Called when the last access to a register turned out to be a read.  A read
+// of the SSI data register removes the byte from the receive FIFO.
+//
+//*****************************************************************************
+void
+SimSSIReadDone(uint32_t ui32Address)
+{
+    if(ui32Address == SIM_SSI_DR)
+    {
+        SimSSIRxPop();
+    }
+}
+
+//*****************************************************************************
+//
+// Reports what the SSI and uDMA models saw during the run.  Returns non-zero
+// if a byte was lost or, with SSI_ENABLE_DMA, the uDMA model moved nothing or
+// was given a transfer that it does not model.
+//
+//*****************************************************************************
+int
+SimSSICheck(void)
+{
+    bool bFail;
+
+    bFail = (g_ui32Overruns || g_ui32SSIUnderruns || g_ui32SSITxLost);
+    printf("ssi:       %u receive overruns, %u transmit underruns, %u bytes "
+           "written to a full\n           transmit FIFO, %s\n",
+           g_ui32Overruns, g_ui32SSIUnderruns, g_ui32SSITxLost,
+           bFail ? "FAILED" : "ok");
+#ifdef SSI_ENABLE_DMA
+    printf("udma:      %u bytes received in %u bursts and %u single "
+           "transfers, %u bad\n           transfers, %s\n", g_ui32DMABytes,
+           g_ui32DMABursts, g_ui32DMASingles, g_ui32DMAErrors,
+           (!g_ui32DMABytes || g_ui32DMAErrors) ? "FAILED" : "ok");
+    bFail |= (!g_ui32DMABytes || g_ui32DMAErrors);
+#endif
+
+    return(bFail ? 1 : 0);
+}
+#endif
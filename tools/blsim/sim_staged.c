@@ -0,0 +1,227 @@
+//*****************************************************************************
+//
+// sim_staged.c - Checks of the staged boot loader update.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DENABLE_BL_UPDATE -DBL_UPDATE_STAGED -DIMAGE_DIGEST, the -S option
+// sends the image as a new boot loader instead: it is downloaded to address
+// 0, over a made up old boot loader, and installed with its digest in place
+// of the reset.  Once the boot loader has copied it over itself and reset,
+// the simulator reports how long the copy took.  It then repeats the copy
+// from where the install command started it, cutting the power before each
+// flash operation in turn, and checks that each cut leaves the old boot
+// loader, an erased reset vector (so that the ROM boot loader runs) or the
+// complete new boot loader.  The image must begin with a vector table whose
+// stack pointer is in SRAM and whose reset vector lies within the image.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "inc/hw_flash.h"
+#include "blsim.h"
+
+#ifdef BL_UPDATE_STAGED
+#include "boot_loader/bl_flash.h"
+
+//*****************************************************************************
+//
+// Whether the image is sent as a new boot loader, to be staged and then
+// installed, the status that the install command returned, and the times at
+// which the copy over the old boot loader started and ended.
+//
+//*****************************************************************************
+bool g_bStaged;
+uint8_t g_ui8InstallStatus = 0xff;
+static uint64_t g_ui64CopyStart;
+static uint64_t g_ui64CopyEnd;
+
+//*****************************************************************************
+//
+// Notes the time taken by a flash operation once the boot loader has accepted
+// the install command, which can only be part of the copy.
+//
+//*****************************************************************************
+void
+SimFlashCopyTime(uint32_t ui32Idx)
+{
+    if((g_ui8InstallStatus == COMMAND_RET_SUCCESS) &&
+       (ui32Idx <= APP_START_ADDRESS))
+    {
+        if(!g_ui64CopyStart)
+        {
+            g_ui64CopyStart = g_ui64Now;
+        }
+        g_ui64CopyEnd = g_ui64FlashBusyUntil;
+    }
+}
+
+//*****************************************************************************
+//
+// Keeps the status from the reply to the install command.  Returns true if
+// the boot loader accepted it and is going on to copy the new boot loader
+// over itself and reset.
+//
+//*****************************************************************************
+bool
+SimInstallReply(void)
+{
+    if((g_psFrames[g_ui32Frame].ui32Phase == PHASE_RESET) &&
+       (g_pui8Reply[3] == 0x0B))
+    {
+        g_ui8InstallStatus = g_pui8Reply[4];
+        return(g_ui8InstallStatus == COMMAND_RET_SUCCESS);
+    }
+
+    return(false);
+}
+
+//*****************************************************************************
+//
+// The contents of the boot loader that a new boot loader replaces, and the
+// states that the flash below the application can be left in by a power cut
+// during the copy: the old boot loader intact, an erased reset vector that
+// makes the ROM boot loader run, the new boot loader complete, or anything
+// else, which would leave the board without a boot loader.
+//
+//*****************************************************************************
+#define SIM_OLD_BYTE(n)         ((((n) * 7) + 3) & 0xff)
+#define SIM_BOOT_OLD            0
+#define SIM_BOOT_ROM            1
+#define SIM_BOOT_NEW            2
+#define SIM_BOOT_BROKEN         3
+
+//*****************************************************************************
+//
+// Fills the flash below the application with the old boot loader.
+//
+//*****************************************************************************
+void
+SimOldBootLoader(void)
+{
+    uint32_t ui32Idx;
+
+    for(ui32Idx = 0; ui32Idx < APP_START_ADDRESS; ui32Idx++)
+    {
+        g_pui8Flash[ui32Idx] = SIM_OLD_BYTE(ui32Idx);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the state of the flash below the application, as one of the
+// SIM_BOOT_* values.  The new boot loader is only complete once the copy of
+// it staged in the application region can no longer be run.
+//
+//*****************************************************************************
+static uint32_t
+SimBootState(const uint8_t *pui8Image, uint32_t ui32Size)
+{
+    uint32_t ui32Idx;
+    bool bOld, bNew;
+
+    bOld = true;
+    bNew = (HWREG(APP_START_ADDRESS + 4) == 0xffffffff);
+    for(ui32Idx = 0; ui32Idx < APP_START_ADDRESS; ui32Idx++)
+    {
+        bOld &= (g_pui8Flash[ui32Idx] == SIM_OLD_BYTE(ui32Idx));
+        bNew &= (g_pui8Flash[ui32Idx] ==
+                 ((ui32Idx < ui32Size) ? pui8Image[ui32Idx] : 0xff));
+    }
+    if(bOld)
+    {
+        return(SIM_BOOT_OLD);
+    }
+    if(bNew)
+    {
+        return(SIM_BOOT_NEW);
+    }
+    return((HWREG(4) == 0xffffffff) ? SIM_BOOT_ROM : SIM_BOOT_BROKEN);
+}
+
+//*****************************************************************************
+//
+// Checks that the install command was accepted and left the new boot loader
+// in place, reporting how long the copy took.  Then runs the copy again from
+// the state the install command found, losing power before each of its flash
+// operations in turn, and checks that every one of those power cuts leaves
+// a boot loader that can run.  Returns non-zero if any check fails.
+//
+//*****************************************************************************
+int
+SimStagedCheck(const uint8_t *pui8Image, uint32_t ui32Size)
+{
+    uint32_t pui32States[4], ui32Cut;
+    bool bOk, bDone;
+
+    if(g_ui8InstallStatus != COMMAND_RET_SUCCESS)
+    {
+        printf("install:   FAILED (status 0x%02x)\n", g_ui8InstallStatus);
+        return(1);
+    }
+    bOk = (SimBootState(pui8Image, ui32Size) == SIM_BOOT_NEW);
+    printf("install:   boot loader copied in %.3f ms, %s\n",
+           CyclesToSeconds(g_ui64CopyEnd - g_ui64CopyStart) * 1000.0,
+           bOk ? "ok" : "FAILED");
+    if(!bOk)
+    {
+        return(1);
+    }
+
+    memset(pui32States, 0, sizeof(pui32States));
+    bDone = false;
+    for(ui32Cut = 1; !bDone; ui32Cut++)
+    {
+        memset(g_pui8Flash, 0xff, SIM_FLASH_SIZE);
+        SimOldBootLoader();
+        memcpy(g_pui8Flash + APP_START_ADDRESS, pui8Image, ui32Size);
+        g_ui32FlashOps = 0;
+        g_ui32PowerCut = ui32Cut;
+        if(!setjmp(g_sPowerCut))
+        {
+            BLInternalFlashStagedCopy(APP_START_ADDRESS, ui32Size);
+            bDone = true;
+        }
+
+        //
+        // Power up again with the flash controller idle.
+        //
+        g_psLastReg = 0;
+        g_ui32FlashBusyBits = 0;
+        SimRegFind(FLASH_FWBVAL)->ui32Value = 0;
+        pui32States[SimBootState(pui8Image, ui32Size)]++;
+    }
+    g_ui32PowerCut = 0;
+
+    bOk = (pui32States[SIM_BOOT_BROKEN] == 0);
+    printf("powercut:  %u points: %u old, %u ROM, %u new boot loader, "
+           "%u broken, %s\n", ui32Cut - 1, pui32States[SIM_BOOT_OLD],
+           pui32States[SIM_BOOT_ROM], pui32States[SIM_BOOT_NEW],
+           pui32States[SIM_BOOT_BROKEN], bOk ? "ok" : "FAILED");
+
+    return(bOk ? 0 : 1);
+}
+#endif
@@ -0,0 +1,1837 @@
+//*****************************************************************************
+//
+// sim_usb.c - Models of the USB controller and of a USB host.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+//
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+//
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+//
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DUSB_ENABLE_UPDATE the simulator runs the boot loader's
+// ConfigureUSB() and UpdaterUSB() against a model of the USB controller,
+// attached at full speed to a model of a USB host that enumerates the device
+// and downloads the image with DFU, in place of Updater() and the UART.
+//
+// The controller model keeps the endpoint 0 FIFO, the endpoint 1 OUT FIFO
+// and DMA channel 0, along with the interrupt status and enable registers,
+// which it reads and writes a byte or a halfword at a time as the driverlib
+// functions do.  Reading a status register clears it as it does on the
+// device.  A setup packet is always taken; an OUT data packet is NAKed until
+// the boot loader has read the last one, an IN data packet until it has
+// loaded one and set TXRDY, and the status stage until it has set DATAEND.
+// Each packet that the controller takes or sends raises the endpoint 0
+// interrupt, except the last packet of an IN data stage, whose interrupt
+// comes once the status stage is over.  A stalled request fails the check,
+// as the host never sends one that the boot loader should refuse.
+//
+// With -DUSB_ENABLE_BULK_DMA as well, each packet that the host sends to
+// endpoint 1 waits in its FIFO, and the host is NAKed, until DMA channel 0 is
+// enabled for the endpoint in mode 1 and the endpoint for DMA.  The DMA
+// engine then copies the packet to the boot loader's buffer, clearing RXRDY
+// if the endpoint is set to do so, and raises its interrupt once the count
+// it was given runs out.  The DMA engine takes no time.
+//
+// The controller's interrupt runs the boot loader's USB0DeviceIntHandler()
+// whenever one of its enabled sources is pending, the interrupt is enabled
+// and the processor's interrupts are not masked, taking the cycles of the
+// exception entry and return.  A wait for interrupt sleeps until one of them
+// is pending, masked or not, as on the device.
+//
+// The host waits for the device to connect, debounces the connection and
+// resets the bus, then reads the device descriptor, sets the address, reads
+// the device, configuration and string descriptors and sets the
+// configuration, checking each descriptor.  It starts each control transfer
+// at the start of a frame, as hosts do, and retries a NAKed packet once the
+// last has left the bus.  It then sends the image in DFU download requests
+// of the transfer size that the DFU functional descriptor gives, asking for
+// the status after each one and again after each poll timeout while the
+// device is busy, or, if the configuration descriptor has a bulk endpoint,
+// asks for a bulk download and sends the image, padded to a whole number of
+// packets, to the endpoint before asking for the status.  A zero length
+// download request ends the download, and the device must report that it is
+// manifesting and then leave the bus.
+//
+// The check fails if the boot loader's flash does not hold the image, if a
+// descriptor is wrong, if a request is stalled or reported with a DFU error,
+// if the device does not answer a transfer within the -w timeout or does not
+// leave the bus once the download is over.
+//
+//*****************************************************************************
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_usb.h"
+#include "driverlib/cpu.h"
+#include "driverlib/interrupt.h"
+#include "blsim.h"
+
+#ifdef USB_ENABLE_UPDATE
+#include "boot_loader/bl_usb.h"
+
+//*****************************************************************************
+//
+// The bit rate of a full speed bus, the bytes that a transaction takes on it
+// besides its data, from the token to the handshake, those that a
+// transaction with no data packet takes, and the cycles that the processor
+// takes to enter and to return from an exception.
+//
+//*****************************************************************************
+#define SIM_USB_BIT_RATE        12000000
+#define SIM_USB_OVERHEAD        13
+#define SIM_USB_NO_DATA         8
+#define SIM_USB_INT_CYCLES      12
+
+//*****************************************************************************
+//
+// The host's timing in milliseconds: the frame, the debounce of a new
+// connection, the bus reset, the recovery after it and after a new address.
+//
+//*****************************************************************************
+#define SIM_USB_FRAME_MS        1
+#define SIM_USB_ATTACH_MS       100
+#define SIM_USB_RESET_MS        10
+#define SIM_USB_RECOVERY_MS     10
+#define SIM_USB_ADDRESS_MS      2
+
+//*****************************************************************************
+//
+// The address that the host gives the device, and the longest descriptor
+// that it reads.
+//
+//*****************************************************************************
+#define SIM_USB_ADDRESS         5
+#define SIM_USB_MAX_DESC        255
+
+//*****************************************************************************
+//
+// The requests that the host makes, and the DFU states and attributes that
+// it checks.
+//
+//*****************************************************************************
+#define SIM_USB_GET_DESCRIPTOR  0x06
+#define SIM_USB_SET_ADDRESS     0x05
+#define SIM_USB_SET_CONFIG      0x09
+#define SIM_USB_DFU_DNLOAD      0x01
+#define SIM_USB_DFU_GETSTATUS   0x03
+#define SIM_USB_DFU_IDLE        2
+#define SIM_USB_DFU_DNBUSY      4
+#define SIM_USB_DFU_DNLOAD_IDLE 5
+#define SIM_USB_DFU_MANIFEST    7
+#define SIM_USB_DFU_CAN_DNLOAD  0x01
+
+//*****************************************************************************
+//
+// What the host does next: nothing, reset the bus, the next transaction of
+// a control transfer or the next bulk packet, or give up waiting for the
+// device to leave the bus.
+//
+//*****************************************************************************
+#define SIM_USB_ACT_NONE        0
+#define SIM_USB_ACT_RESET       1
+#define SIM_USB_ACT_CONTROL     2
+#define SIM_USB_ACT_BULK        3
+#define SIM_USB_ACT_DETACH      4
+
+//*****************************************************************************
+//
+// The steps of the host's script, each named for what it is waiting on.
+//
+//*****************************************************************************
+#define SIM_USB_STEP_ATTACH     0
+#define SIM_USB_STEP_DEV_FIRST  1
+#define SIM_USB_STEP_ADDRESS    2
+#define SIM_USB_STEP_DEVICE     3
+#define SIM_USB_STEP_CONF_HEAD  4
+#define SIM_USB_STEP_CONFIG     5
+#define SIM_USB_STEP_LANGID     6
+#define SIM_USB_STEP_PRODUCT    7
+#define SIM_USB_STEP_SET_CONFIG 8
+#define SIM_USB_STEP_IDLE       9
+#define SIM_USB_STEP_BULK_REQ   10
+#define SIM_USB_STEP_BULK_DATA  11
+#define SIM_USB_STEP_DNLOAD     12
+#define SIM_USB_STEP_DN_STATUS  13
+#define SIM_USB_STEP_DN_END     14
+#define SIM_USB_STEP_MANIFEST   15
+#define SIM_USB_STEP_DETACH     16
+#define SIM_USB_STEP_DONE       17
+
+//*****************************************************************************
+//
+// The stages of a control transfer, and the handshakes of a transaction.
+//
+//*****************************************************************************
+#define SIM_USB_STAGE_SETUP     0
+#define SIM_USB_STAGE_DATA      1
+#define SIM_USB_STAGE_STATUS    2
+#define SIM_USB_ACK             0
+#define SIM_USB_NAK             1
+#define SIM_USB_STALL           2
+
+//*****************************************************************************
+//
+// A control transfer of the host's, with the data that it sends or the
+// buffer that it reads into.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint8_t pui8Setup[8];
+    const uint8_t *pui8Send;
+    uint8_t *pui8Receive;
+    uint32_t ui32Length;
+    uint32_t ui32Done;
+    uint32_t ui32Stage;
+}
+tSimUSBControl;
+
+//*****************************************************************************
+//
+// The controller's address, power and interrupt registers.
+//
+//*****************************************************************************
+static uint8_t g_ui8USBAddress;
+static uint8_t g_ui8USBPower;
+static uint16_t g_ui16USBTxIS;
+static uint16_t g_ui16USBRxIS;
+static uint16_t g_ui16USBTxIE;
+static uint16_t g_ui16USBRxIE;
+static uint8_t g_ui8USBIS;
+static uint8_t g_ui8USBIE;
+
+//*****************************************************************************
+//
+// Endpoint 0: the packet that the host sent and how much of it has been
+// read, the packet that the boot loader is loading, and the bits of its
+// control and status register that the model keeps.  g_bUSBFIFOWrite notes
+// that the last access to the FIFO found nothing to read, so was a write.
+//
+//*****************************************************************************
+static uint8_t g_pui8USBEP0Rx[USB_EP0_MAX_PACKET];
+static uint32_t g_ui32USBEP0RxSize;
+static uint32_t g_ui32USBEP0RxRead;
+static bool g_bUSBEP0RxReady;
+static uint8_t g_pui8USBEP0Tx[USB_EP0_MAX_PACKET];
+static uint32_t g_ui32USBEP0TxSize;
+static uint8_t g_ui8USBCSRL0;
+static bool g_bUSBFIFOWrite;
+
+//*****************************************************************************
+//
+// Endpoint 1 OUT: the packet in its FIFO, its maximum packet size and its
+// high control and status register, and DMA channel 0.
+//
+//*****************************************************************************
+static uint8_t g_pui8USBEP1[USB_BULK_MAX_PACKET];
+static uint32_t g_ui32USBEP1Size;
+static bool g_bUSBEP1Ready;
+static uint16_t g_ui16USBRxMaxP1;
+static uint8_t g_ui8USBRxCSRH1;
+static uint32_t g_ui32USBDMACtl;
+static uint32_t g_ui32USBDMAAddr;
+static uint32_t g_ui32USBDMACount;
+static uint32_t g_ui32USBDMAIntr;
+
+//*****************************************************************************
+//
+// The interrupt of the controller and the processor's interrupt mask.
+//
+//*****************************************************************************
+static bool g_bUSBIntEnabled;
+static bool g_bUSBMaster;
+static bool g_bUSBInHandler;
+
+//*****************************************************************************
+//
+// The image that the host sends, and how far it has got.
+//
+//*****************************************************************************
+static const uint8_t *g_pui8USBImage;
+static uint32_t g_ui32USBImageSize;
+static uint32_t g_ui32USBOffset;
+static uint32_t g_ui32USBBlock;
+
+//*****************************************************************************
+//
+// The host's state: the step of its script, what it does next and when, the
+// time by which the device must answer, the address that it sends to, the
+// start of the first frame and the control transfer under way.
+//
+//*****************************************************************************
+static uint32_t g_ui32USBStep;
+static uint32_t g_ui32USBAction;
+static uint64_t g_ui64USBNext;
+static uint64_t g_ui64USBDeadline;
+static uint8_t g_ui8USBHostAddress;
+static uint64_t g_ui64USBFrameStart;
+static tSimUSBControl g_sUSBControl;
+static uint8_t g_pui8USBReply[SIM_USB_MAX_DESC];
+static uint8_t g_pui8USBRequest[8];
+static uint8_t g_pui8USBPacket[USB_EP0_MAX_PACKET];
+
+//*****************************************************************************
+//
+// What the host learned from the descriptors: the DFU transfer size, and
+// whether the device has a bulk endpoint for the image.
+//
+//*****************************************************************************
+static uint32_t g_ui32USBTransferSize;
+static bool g_bUSBBulk;
+
+//*****************************************************************************
+//
+// The cycles that a byte takes on the bus, and the cycles of a frame.
+//
+//*****************************************************************************
+static double g_dUSBByteCycles;
+static uint64_t g_ui64USBFrameCycles;
+
+//*****************************************************************************
+//
+// When the run started, the device connected, the configuration was set,
+// the download started and ended, and the device left the bus.
+//
+//*****************************************************************************
+static uint64_t g_ui64USBStart;
+static uint64_t g_ui64USBAttach;
+static uint64_t g_ui64USBConfigured;
+static uint64_t g_ui64USBDownload;
+static uint64_t g_ui64USBDownloaded;
+static uint64_t g_ui64USBDetach;
+
+//*****************************************************************************
+//
+// The counts of control transfers, bulk packets, transactions, NAKs,
+// interrupts and of status requests answered while busy, and the cycles that
+// the boot loader spent asleep.
+//
+//*****************************************************************************
+static uint32_t g_ui32USBTransfers;
+static uint32_t g_ui32USBPackets;
+static uint32_t g_ui32USBTransactions;
+static uint32_t g_ui32USBNaks;
+static uint32_t g_ui32USBInterrupts;
+static uint32_t g_ui32USBBusy;
+static uint64_t g_ui64USBSleep;
+
+//*****************************************************************************
+//
+// Whether the boot loader is running, and the error that ended the update,
+// if any, with room for the details of one.
+//
+//*****************************************************************************
+static bool g_bUSBInRun;
+static const char *g_pcUSBError;
+static char g_pcUSBMessage[80];
+
+//*****************************************************************************
+//
+// Ends the update with an error.  If the boot loader is running, the run is
+// ended too, as it can only be waiting for a host that has given up.
+//
+//*****************************************************************************
+static void
+SimUSBFail(const char *pcError)
+{
+    if(!g_pcUSBError)
+    {
+        g_pcUSBError = pcError;
+    }
+    g_ui32USBAction = SIM_USB_ACT_NONE;
+    g_ui64USBNext = 0;
+    if(g_bUSBInRun)
+    {
+        g_bUSBInRun = false;
+        g_bUSBInHandler = false;
+        longjmp(g_sDone, 1);
+    }
+}
+
+//*****************************************************************************
+//
+// Reads a little endian field of a descriptor or a request.
+//
+//*****************************************************************************
+static uint32_t
+SimUSBGet16(const uint8_t *pui8Data)
+{
+    return(pui8Data[0] | (pui8Data[1] << 8));
+}
+
+//*****************************************************************************
+//
+// Returns the cycles that the given bytes take on the bus.
+//
+//*****************************************************************************
+static uint64_t
+SimUSBCycles(uint32_t ui32Bytes)
+{
+    return((uint64_t)(ui32Bytes * g_dUSBByteCycles));
+}
+
+//*****************************************************************************
+//
+// Returns the start of the first frame at or after the given time.
+//
+//*****************************************************************************
+static uint64_t
+SimUSBFrame(uint64_t ui64Time)
+{
+    uint64_t ui64Frames;
+
+    if(ui64Time <= g_ui64USBFrameStart)
+    {
+        return(g_ui64USBFrameStart);
+    }
+    ui64Frames = ((ui64Time - g_ui64USBFrameStart + g_ui64USBFrameCycles - 1) /
+                  g_ui64USBFrameCycles);
+
+    return(g_ui64USBFrameStart + (ui64Frames * g_ui64USBFrameCycles));
+}
+
+//*****************************************************************************
+//
+// Returns true if one of the controller's enabled interrupt sources is
+// pending and its interrupt is enabled.
+//
+//*****************************************************************************
+static bool
+SimUSBPending(void)
+{
+    return(g_bUSBIntEnabled &&
+           ((g_ui16USBTxIS & g_ui16USBTxIE) ||
+            (g_ui16USBRxIS & g_ui16USBRxIE) || (g_ui8USBIS & g_ui8USBIE) ||
+            g_ui32USBDMAIntr));
+}
+
+//*****************************************************************************
+//
+// Runs the boot loader's interrupt handler for as long as the controller's
+// interrupt is pending and the processor takes it.  The handler's last
+// register access is resolved before it returns, as the next access is the
+// interrupted code's.
+//
+//*****************************************************************************
+static void
+SimUSBInterrupt(void)
+{
+    while(g_bUSBMaster && !g_bUSBInHandler && g_bUSBInRun && SimUSBPending())
+    {
+        g_bUSBInHandler = true;
+        g_ui32USBInterrupts++;
+        g_ui64Now += SIM_USB_INT_CYCLES;
+        USB0DeviceIntHandler();
+        SimRegResolve();
+        g_ui64Now += SIM_USB_INT_CYCLES;
+        g_bUSBInHandler = false;
+    }
+}
+
+//*****************************************************************************
+//
+// Moves the packet waiting in the endpoint 1 FIFO to memory if DMA channel 0
+// is enabled for it, raising the channel's interrupt once its count runs
+// out.
+//
+//*****************************************************************************
+static void
+SimUSBDMA(void)
+{
+    uint32_t ui32Size;
+
+    if(!(g_ui32USBDMACtl & USB_DMACTL0_ENABLE) || !g_bUSBEP1Ready ||
+       !g_ui32USBEP1Size ||
+       (((g_ui32USBDMACtl & USB_DMACTL0_EP_M) >> USB_DMACTL0_EP_S) != 1) ||
+       (g_ui32USBDMACtl & USB_DMACTL0_DIR) ||
+       !(g_ui32USBDMACtl & USB_DMACTL0_MODE) ||
+       ((g_ui8USBRxCSRH1 & (USB_RXCSRH1_DMAEN | USB_RXCSRH1_DMAMOD)) !=
+        (USB_RXCSRH1_DMAEN | USB_RXCSRH1_DMAMOD)))
+    {
+        return;
+    }
+
+    ui32Size = g_ui32USBEP1Size;
+    if(ui32Size > g_ui32USBDMACount)
+    {
+        ui32Size = g_ui32USBDMACount;
+    }
+    memcpy((void *)(uintptr_t)g_ui32USBDMAAddr, g_pui8USBEP1, ui32Size);
+    g_ui32USBDMAAddr += ui32Size;
+    g_ui32USBDMACount -= ui32Size;
+
+    //
+    // The packet has been read.  Unless the endpoint clears RXRDY itself,
+    // the FIFO stays full until the boot loader does.
+    //
+    g_ui32USBEP1Size = 0;
+    if(g_ui8USBRxCSRH1 & USB_RXCSRH1_AUTOCL)
+    {
+        g_bUSBEP1Ready = false;
+    }
+
+    if(!g_ui32USBDMACount)
+    {
+        g_ui32USBDMACtl &= ~USB_DMACTL0_ENABLE;
+        if(g_ui32USBDMACtl & USB_DMACTL0_IE)
+        {
+            g_ui32USBDMAIntr |= USB_DMAINTR_CH0;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Resets the controller's endpoints and address, as a reset of the bus does,
+// and raises the reset interrupt.
+//
+//*****************************************************************************
+static void
+SimUSBBusReset(void)
+{
+    g_ui8USBAddress = 0;
+    g_bUSBEP0RxReady = false;
+    g_ui32USBEP0TxSize = 0;
+    g_ui8USBCSRL0 = 0;
+    g_bUSBEP1Ready = false;
+    g_ui32USBEP1Size = 0;
+    g_ui8USBIS |= USB_IS_RESET;
+}
+
+//*****************************************************************************
+//
+// Takes a setup packet on endpoint 0, which the controller always does.  A
+// new request ends whatever the last one left behind.
+//
+//*****************************************************************************
+static void
+SimUSBEP0Setup(const uint8_t *pui8Setup)
+{
+    if(g_bUSBEP0RxReady)
+    {
+        SimUSBFail("a setup packet came before the last packet was read");
+    }
+    memcpy(g_pui8USBEP0Rx, pui8Setup, 8);
+    g_ui32USBEP0RxSize = 8;
+    g_ui32USBEP0RxRead = 0;
+    g_bUSBEP0RxReady = true;
+    g_ui32USBEP0TxSize = 0;
+    g_ui8USBCSRL0 &= ~(USB_CSRL0_TXRDY | USB_CSRL0_DATAEND | USB_CSRL0_STALL);
+    g_ui16USBTxIS |= 1;
+}
+
+//*****************************************************************************
+//
+// Answers an IN token on endpoint 0, in the data stage or the status stage
+// of a control transfer, giving the handshake and the packet sent, if any.
+//
+//*****************************************************************************
+static uint32_t
+SimUSBEP0In(uint8_t *pui8Data, uint32_t *pui32Size, bool bStatus)
+{
+    *pui32Size = 0;
+    if(g_ui8USBCSRL0 & USB_CSRL0_STALL)
+    {
+        g_ui8USBCSRL0 = (g_ui8USBCSRL0 & ~USB_CSRL0_STALL) | USB_CSRL0_STALLED;
+        g_ui16USBTxIS |= 1;
+        return(SIM_USB_STALL);
+    }
+
+    if(bStatus)
+    {
+        if(!(g_ui8USBCSRL0 & USB_CSRL0_DATAEND))
+        {
+            return(SIM_USB_NAK);
+        }
+        g_ui8USBCSRL0 &= ~USB_CSRL0_DATAEND;
+        g_ui16USBTxIS |= 1;
+        return(SIM_USB_ACK);
+    }
+
+    if(!(g_ui8USBCSRL0 & USB_CSRL0_TXRDY))
+    {
+        return(SIM_USB_NAK);
+    }
+    memcpy(pui8Data, g_pui8USBEP0Tx, g_ui32USBEP0TxSize);
+    *pui32Size = g_ui32USBEP0TxSize;
+    g_ui32USBEP0TxSize = 0;
+    g_ui8USBCSRL0 &= ~USB_CSRL0_TXRDY;
+    if(!(g_ui8USBCSRL0 & USB_CSRL0_DATAEND))
+    {
+        g_ui16USBTxIS |= 1;
+    }
+
+    return(SIM_USB_ACK);
+}
+
+//*****************************************************************************
+//
+// Answers an OUT packet on endpoint 0, in the data stage or the zero length
+// one of the status stage of a control transfer, giving the handshake.
+//
+//*****************************************************************************
+static uint32_t
+SimUSBEP0Out(const uint8_t *pui8Data, uint32_t ui32Size, bool bStatus)
+{
+    if(g_ui8USBCSRL0 & USB_CSRL0_STALL)
+    {
+        g_ui8USBCSRL0 = (g_ui8USBCSRL0 & ~USB_CSRL0_STALL) | USB_CSRL0_STALLED;
+        g_ui16USBTxIS |= 1;
+        return(SIM_USB_STALL);
+    }
+
+    if(bStatus)
+    {
+        if(!(g_ui8USBCSRL0 & USB_CSRL0_DATAEND))
+        {
+            return(SIM_USB_NAK);
+        }
+        g_ui8USBCSRL0 &= ~USB_CSRL0_DATAEND;
+        g_ui16USBTxIS |= 1;
+        return(SIM_USB_ACK);
+    }
+
+    if(g_bUSBEP0RxReady)
+    {
+        return(SIM_USB_NAK);
+    }
+    memcpy(g_pui8USBEP0Rx, pui8Data, ui32Size);
+    g_ui32USBEP0RxSize = ui32Size;
+    g_ui32USBEP0RxRead = 0;
+    g_bUSBEP0RxReady = true;
+    g_ui16USBTxIS |= 1;
+
+    return(SIM_USB_ACK);
+}
+
+//*****************************************************************************
+//
+// Fails the update unless the device is on the bus at the address that the
+// host sends to.
+//
+//*****************************************************************************
+static void
+SimUSBAnswerCheck(void)
+{
+    if(!(g_ui8USBPower & USB_POWER_SOFTCONN))
+    {
+        SimUSBFail("the device left the bus before the download was over");
+    }
+    if(g_ui8USBAddress != g_ui8USBHostAddress)
+    {
+        SimUSBFail("the device did not answer at the address it was given");
+    }
+}
+
+//*****************************************************************************
+//
+// Accounts for a transaction that started at the given time, failing the
+// update on a stall or on a NAK after the deadline, and schedules the next
+// one for when it has left the bus.  Returns the time that it ended.
+//
+//*****************************************************************************
+static uint64_t
+SimUSBTransaction(uint64_t ui64Time, uint32_t ui32Bytes, uint32_t ui32Result)
+{
+    uint8_t *pui8Setup;
+
+    g_ui32USBTransactions++;
+    if(ui32Result == SIM_USB_STALL)
+    {
+        pui8Setup = g_sUSBControl.pui8Setup;
+        snprintf(g_pcUSBMessage, sizeof(g_pcUSBMessage), "the device "
+                 "stalled request 0x%02x of type 0x%02x", pui8Setup[1],
+                 pui8Setup[0]);
+        SimUSBFail(g_pcUSBMessage);
+    }
+    if(ui32Result == SIM_USB_NAK)
+    {
+        g_ui32USBNaks++;
+        if(ui64Time > g_ui64USBDeadline)
+        {
+            SimUSBFail("the device did not answer in time");
+        }
+    }
+
+    g_ui64USBNext = ui64Time + SimUSBCycles(ui32Bytes);
+
+    return(g_ui64USBNext);
+}
+
+//*****************************************************************************
+//
+// Starts a control transfer at the start of the first frame after the given
+// time, with the step of the script that waits for it.
+//
+//*****************************************************************************
+static void
+SimUSBRequest(uint64_t ui64Time, uint32_t ui32Step, uint8_t ui8Type,
+              uint8_t ui8Request, uint16_t ui16Value, uint16_t ui16Index,
+              uint16_t ui16Length, const uint8_t *pui8Send)
+{
+    tSimUSBControl *psXfer;
+
+    psXfer = &g_sUSBControl;
+    psXfer->pui8Setup[0] = ui8Type;
+    psXfer->pui8Setup[1] = ui8Request;
+    psXfer->pui8Setup[2] = ui16Value & 0xff;
+    psXfer->pui8Setup[3] = ui16Value >> 8;
+    psXfer->pui8Setup[4] = ui16Index & 0xff;
+    psXfer->pui8Setup[5] = ui16Index >> 8;
+    psXfer->pui8Setup[6] = ui16Length & 0xff;
+    psXfer->pui8Setup[7] = ui16Length >> 8;
+    psXfer->pui8Send = pui8Send;
+    psXfer->pui8Receive = g_pui8USBReply;
+    psXfer->ui32Length = ui16Length;
+    psXfer->ui32Done = 0;
+    psXfer->ui32Stage = SIM_USB_STAGE_SETUP;
+
+    g_ui32USBStep = ui32Step;
+    g_ui32USBAction = SIM_USB_ACT_CONTROL;
+    g_ui64USBNext = SimUSBFrame(ui64Time);
+    g_ui64USBDeadline = g_ui64USBNext + g_ui64HostTimeout;
+    g_ui32USBTransfers++;
+}
+
+//*****************************************************************************
+//
+// Asks for the DFU status.
+//
+//*****************************************************************************
+static void
+SimUSBStatusRequest(uint64_t ui64Time, uint32_t ui32Step)
+{
+    SimUSBRequest(ui64Time, ui32Step, 0xa1, SIM_USB_DFU_GETSTATUS, 0, 0, 6,
+                  0);
+}
+
+//*****************************************************************************
+//
+// Sends the next block of the image in a DFU download request.
+//
+//*****************************************************************************
+static void
+SimUSBBlockSend(uint64_t ui64Time)
+{
+    uint32_t ui32Size;
+
+    ui32Size = g_ui32USBImageSize - g_ui32USBOffset;
+    if(ui32Size > g_ui32USBTransferSize)
+    {
+        ui32Size = g_ui32USBTransferSize;
+    }
+    SimUSBRequest(ui64Time, SIM_USB_STEP_DNLOAD, 0x21, SIM_USB_DFU_DNLOAD,
+                  g_ui32USBBlock++, 0, ui32Size,
+                  g_pui8USBImage + g_ui32USBOffset);
+    g_ui32USBOffset += ui32Size;
+}
+
+//*****************************************************************************
+//
+// Checks the device descriptor that the host has read.
+//
+//*****************************************************************************
+static void
+SimUSBDeviceCheck(void)
+{
+    if((g_sUSBControl.ui32Done != 18) || (g_pui8USBReply[0] != 18) ||
+       (g_pui8USBReply[1] != 1) ||
+       (g_pui8USBReply[7] != USB_EP0_MAX_PACKET) ||
+       (SimUSBGet16(g_pui8USBReply + 8) != USB_VENDOR_ID) ||
+       (SimUSBGet16(g_pui8USBReply + 10) != USB_PRODUCT_ID))
+    {
+        SimUSBFail("the device descriptor is wrong");
+    }
+}
+
+//*****************************************************************************
+//
+// Checks the configuration descriptor that the host has read, taking the
+// DFU transfer size from its DFU functional descriptor and noting whether
+// it has a bulk OUT endpoint.
+//
+//*****************************************************************************
+static void
+SimUSBConfigCheck(void)
+{
+    const uint8_t *pui8Desc;
+    uint32_t ui32Idx, ui32Total;
+    bool bInterface;
+
+    ui32Total = SimUSBGet16(g_pui8USBReply + 2);
+    if(g_sUSBControl.ui32Done != ui32Total)
+    {
+        SimUSBFail("the configuration descriptor is not the length it gives");
+    }
+
+    bInterface = false;
+    for(ui32Idx = 0; ui32Idx < ui32Total; ui32Idx += pui8Desc[0])
+    {
+        pui8Desc = g_pui8USBReply + ui32Idx;
+        if((pui8Desc[0] < 2) || ((ui32Idx + pui8Desc[0]) > ui32Total))
+        {
+            SimUSBFail("the configuration descriptor is malformed");
+        }
+        if(pui8Desc[1] == 4)
+        {
+            //
+            // The interface must be DFU in DFU mode.
+            //
+            if((pui8Desc[0] != 9) || (pui8Desc[5] != 0xfe) ||
+               (pui8Desc[6] != 1) || (pui8Desc[7] != 2))
+            {
+                SimUSBFail("the interface is not a DFU interface");
+            }
+            bInterface = true;
+        }
+        else if((pui8Desc[1] == 0x21) && (pui8Desc[0] == 9) &&
+                (pui8Desc[2] & SIM_USB_DFU_CAN_DNLOAD))
+        {
+            g_ui32USBTransferSize = SimUSBGet16(pui8Desc + 5);
+        }
+        else if((pui8Desc[1] == 5) && (pui8Desc[0] == 7) &&
+                (pui8Desc[2] == 0x01) && ((pui8Desc[3] & 3) == 2))
+        {
+            if(SimUSBGet16(pui8Desc + 4) != USB_BULK_MAX_PACKET)
+            {
+                SimUSBFail("the bulk endpoint has the wrong packet size");
+            }
+            g_bUSBBulk = true;
+        }
+    }
+    if(!bInterface || !g_ui32USBTransferSize)
+    {
+        SimUSBFail("the configuration has no DFU download interface");
+    }
+#ifdef USB_ENABLE_BULK_DMA
+    if(!g_bUSBBulk)
+    {
+        SimUSBFail("the configuration has no bulk endpoint");
+    }
+#endif
+}
+
+//*****************************************************************************
+//
+// Checks a string descriptor that the host has read.
+//
+//*****************************************************************************
+static void
+SimUSBStringCheck(void)
+{
+    if((g_sUSBControl.ui32Done < 2) ||
+       (g_pui8USBReply[0] != g_sUSBControl.ui32Done) ||
+       (g_pui8USBReply[0] & 1) || (g_pui8USBReply[1] != 3))
+    {
+        SimUSBFail("a string descriptor is wrong");
+    }
+}
+
+//*****************************************************************************
+//
+// Checks a DFU status reply, returning the state that it gives and the poll
+// timeout in cycles.
+//
+//*****************************************************************************
+static uint32_t
+SimUSBStatusCheck(uint64_t *pui64Poll)
+{
+    if(g_sUSBControl.ui32Done != 6)
+    {
+        SimUSBFail("a DFU status reply is the wrong length");
+    }
+    if(g_pui8USBReply[0])
+    {
+        snprintf(g_pcUSBMessage, sizeof(g_pcUSBMessage), "the device reported "
+                 "DFU status 0x%02x in state %u", g_pui8USBReply[0],
+                 g_pui8USBReply[4]);
+        SimUSBFail(g_pcUSBMessage);
+    }
+    *pui64Poll = MicrosecondsToCycles((g_pui8USBReply[1] |
+                                       (g_pui8USBReply[2] << 8) |
+                                       (g_pui8USBReply[3] << 16)) * 1000.0);
+
+    return(g_pui8USBReply[4]);
+}
+
+//*****************************************************************************
+//
+// Moves the host on once the step that it was waiting on is over, at the
+// given time, checking what it has read and starting the next transfer.
+//
+//*****************************************************************************
+static void
+SimUSBHostNext(uint64_t ui64Time)
+{
+    uint64_t ui64Poll;
+    uint32_t ui32State, ui32Size;
+
+    switch(g_ui32USBStep)
+    {
+        case SIM_USB_STEP_ATTACH:
+        {
+            //
+            // The bus reset is over.  Ask for as much of the device
+            // descriptor as the largest packet holds, as hosts do.
+            //
+            SimUSBRequest(ui64Time + MicrosecondsToCycles(
+                                         SIM_USB_RECOVERY_MS * 1000.0),
+                          SIM_USB_STEP_DEV_FIRST, 0x80,
+                          SIM_USB_GET_DESCRIPTOR, 0x0100, 0, 64, 0);
+            break;
+        }
+
+        case SIM_USB_STEP_DEV_FIRST:
+        {
+            SimUSBDeviceCheck();
+            SimUSBRequest(ui64Time, SIM_USB_STEP_ADDRESS, 0x00,
+                          SIM_USB_SET_ADDRESS, SIM_USB_ADDRESS, 0, 0, 0);
+            break;
+        }
+
+        case SIM_USB_STEP_ADDRESS:
+        {
+            g_ui8USBHostAddress = SIM_USB_ADDRESS;
+            SimUSBRequest(ui64Time + MicrosecondsToCycles(
+                                         SIM_USB_ADDRESS_MS * 1000.0),
+                          SIM_USB_STEP_DEVICE, 0x80, SIM_USB_GET_DESCRIPTOR,
+                          0x0100, 0, 18, 0);
+            break;
+        }
+
+        case SIM_USB_STEP_DEVICE:
+        {
+            SimUSBDeviceCheck();
+            SimUSBRequest(ui64Time, SIM_USB_STEP_CONF_HEAD, 0x80,
+                          SIM_USB_GET_DESCRIPTOR, 0x0200, 0, 9, 0);
+            break;
+        }
+
+        case SIM_USB_STEP_CONF_HEAD:
+        {
+            ui32Size = SimUSBGet16(g_pui8USBReply + 2);
+            if((g_sUSBControl.ui32Done != 9) || (g_pui8USBReply[1] != 2) ||
+               (ui32Size < 9) || (ui32Size > SIM_USB_MAX_DESC))
+            {
+                SimUSBFail("the configuration descriptor is wrong");
+            }
+            SimUSBRequest(ui64Time, SIM_USB_STEP_CONFIG, 0x80,
+                          SIM_USB_GET_DESCRIPTOR, 0x0200, 0, ui32Size, 0);
+            break;
+        }
+
+        case SIM_USB_STEP_CONFIG:
+        {
+            SimUSBConfigCheck();
+            SimUSBRequest(ui64Time, SIM_USB_STEP_LANGID, 0x80,
+                          SIM_USB_GET_DESCRIPTOR, 0x0300, 0, SIM_USB_MAX_DESC,
+                          0);
+            break;
+        }
+
+        case SIM_USB_STEP_LANGID:
+        {
+            SimUSBStringCheck();
+            SimUSBRequest(ui64Time, SIM_USB_STEP_PRODUCT, 0x80,
+                          SIM_USB_GET_DESCRIPTOR, 0x0302,
+                          SimUSBGet16(g_pui8USBReply + 2), SIM_USB_MAX_DESC,
+                          0);
+            break;
+        }
+
+        case SIM_USB_STEP_PRODUCT:
+        {
+            SimUSBStringCheck();
+            SimUSBRequest(ui64Time, SIM_USB_STEP_SET_CONFIG, 0x00,
+                          SIM_USB_SET_CONFIG, 1, 0, 0, 0);
+            break;
+        }
+
+        case SIM_USB_STEP_SET_CONFIG:
+        {
+            g_ui64USBConfigured = ui64Time;
+            SimUSBStatusRequest(ui64Time, SIM_USB_STEP_IDLE);
+            break;
+        }
+
+        case SIM_USB_STEP_IDLE:
+        {
+            if(SimUSBStatusCheck(&ui64Poll) != SIM_USB_DFU_IDLE)
+            {
+                SimUSBFail("the device is not idle once configured");
+            }
+            g_ui64USBDownload = ui64Time;
+            if(!g_bUSBBulk)
+            {
+                SimUSBBlockSend(ui64Time);
+                break;
+            }
+
+            //
+            // Ask for a bulk download of the image, padded to a whole
+            // number of packets.
+            //
+            ui32Size = ((g_ui32USBImageSize + USB_BULK_MAX_PACKET - 1) &
+                        ~(USB_BULK_MAX_PACKET - 1));
+            g_pui8USBRequest[0] = APP_START_ADDRESS & 0xff;
+            g_pui8USBRequest[1] = (APP_START_ADDRESS >> 8) & 0xff;
+            g_pui8USBRequest[2] = (APP_START_ADDRESS >> 16) & 0xff;
+            g_pui8USBRequest[3] = (APP_START_ADDRESS >> 24) & 0xff;
+            g_pui8USBRequest[4] = ui32Size & 0xff;
+            g_pui8USBRequest[5] = (ui32Size >> 8) & 0xff;
+            g_pui8USBRequest[6] = (ui32Size >> 16) & 0xff;
+            g_pui8USBRequest[7] = (ui32Size >> 24) & 0xff;
+            SimUSBRequest(ui64Time, SIM_USB_STEP_BULK_REQ, 0x41,
+                          USB_REQ_BULK_DOWNLOAD, 0, 0, 8, g_pui8USBRequest);
+            break;
+        }
+
+        case SIM_USB_STEP_BULK_REQ:
+        {
+            g_ui32USBStep = SIM_USB_STEP_BULK_DATA;
+            g_ui32USBAction = SIM_USB_ACT_BULK;
+            g_ui64USBNext = ui64Time;
+            g_ui64USBDeadline = ui64Time + g_ui64HostTimeout;
+            break;
+        }
+
+        case SIM_USB_STEP_BULK_DATA:
+        case SIM_USB_STEP_DNLOAD:
+        {
+            SimUSBStatusRequest(ui64Time, SIM_USB_STEP_DN_STATUS);
+            break;
+        }
+
+        case SIM_USB_STEP_DN_STATUS:
+        {
+            ui32State = SimUSBStatusCheck(&ui64Poll);
+            if(ui32State == SIM_USB_DFU_DNBUSY)
+            {
+                g_ui32USBBusy++;
+                SimUSBStatusRequest(ui64Time + ui64Poll,
+                                    SIM_USB_STEP_DN_STATUS);
+            }
+            else if(ui32State != SIM_USB_DFU_DNLOAD_IDLE)
+            {
+                SimUSBFail("the device is not idle after a download");
+            }
+            else if(g_ui32USBOffset < g_ui32USBImageSize)
+            {
+                SimUSBBlockSend(ui64Time);
+            }
+            else
+            {
+                g_ui64USBDownloaded = ui64Time;
+                SimUSBRequest(ui64Time, SIM_USB_STEP_DN_END, 0x21,
+                              SIM_USB_DFU_DNLOAD, g_ui32USBBlock, 0, 0, 0);
+            }
+            break;
+        }
+
+        case SIM_USB_STEP_DN_END:
+        {
+            SimUSBStatusRequest(ui64Time, SIM_USB_STEP_MANIFEST);
+            break;
+        }
+
+        case SIM_USB_STEP_MANIFEST:
+        {
+            if(SimUSBStatusCheck(&ui64Poll) != SIM_USB_DFU_MANIFEST)
+            {
+                SimUSBFail("the device is not manifesting after the "
+                           "download");
+            }
+
+            //
+            // The device must now leave the bus.
+            //
+            g_ui32USBStep = SIM_USB_STEP_DETACH;
+            g_ui32USBAction = SIM_USB_ACT_DETACH;
+            g_ui64USBNext = ui64Time + g_ui64HostTimeout;
+            break;
+        }
+
+        default:
+        {
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Makes the next transaction of the control transfer under way, at the
+// given time.
+//
+//*****************************************************************************
+static void
+SimUSBControl(uint64_t ui64Time)
+{
+    tSimUSBControl *psXfer;
+    uint32_t ui32Size, ui32Bytes, ui32Result, ui32Stage;
+    uint64_t ui64End;
+    bool bIn;
+
+    SimUSBAnswerCheck();
+    psXfer = &g_sUSBControl;
+    bIn = (psXfer->pui8Setup[0] & 0x80) ? true : false;
+    ui32Stage = psXfer->ui32Stage;
+    switch(ui32Stage)
+    {
+        case SIM_USB_STAGE_SETUP:
+        {
+            SimUSBEP0Setup(psXfer->pui8Setup);
+            ui32Result = SIM_USB_ACK;
+            ui32Bytes = SIM_USB_OVERHEAD + 8;
+            psXfer->ui32Stage = (psXfer->ui32Length ? SIM_USB_STAGE_DATA :
+                                 SIM_USB_STAGE_STATUS);
+            break;
+        }
+
+        case SIM_USB_STAGE_DATA:
+        {
+            if(bIn)
+            {
+                ui32Result = SimUSBEP0In(g_pui8USBPacket, &ui32Size, false);
+                ui32Bytes = ((ui32Result == SIM_USB_ACK) ?
+                             (SIM_USB_OVERHEAD + ui32Size) : SIM_USB_NO_DATA);
+                if(ui32Result != SIM_USB_ACK)
+                {
+                    break;
+                }
+                if(ui32Size > (psXfer->ui32Length - psXfer->ui32Done))
+                {
+                    SimUSBFail("the device sent more than was asked for");
+                }
+                memcpy(psXfer->pui8Receive + psXfer->ui32Done,
+                       g_pui8USBPacket, ui32Size);
+                psXfer->ui32Done += ui32Size;
+                if((ui32Size < USB_EP0_MAX_PACKET) ||
+                   (psXfer->ui32Done == psXfer->ui32Length))
+                {
+                    psXfer->ui32Stage = SIM_USB_STAGE_STATUS;
+                }
+            }
+            else
+            {
+                ui32Size = psXfer->ui32Length - psXfer->ui32Done;
+                if(ui32Size > USB_EP0_MAX_PACKET)
+                {
+                    ui32Size = USB_EP0_MAX_PACKET;
+                }
+                ui32Result = SimUSBEP0Out(psXfer->pui8Send + psXfer->ui32Done,
+                                          ui32Size, false);
+                ui32Bytes = SIM_USB_OVERHEAD + ui32Size;
+                if(ui32Result != SIM_USB_ACK)
+                {
+                    break;
+                }
+                psXfer->ui32Done += ui32Size;
+                if(psXfer->ui32Done == psXfer->ui32Length)
+                {
+                    psXfer->ui32Stage = SIM_USB_STAGE_STATUS;
+                }
+            }
+            break;
+        }
+
+        default:
+        {
+            //
+            // The status stage goes the other way to the data.
+            //
+            if(bIn)
+            {
+                ui32Result = SimUSBEP0Out(0, 0, true);
+                ui32Bytes = SIM_USB_OVERHEAD;
+            }
+            else
+            {
+                ui32Result = SimUSBEP0In(g_pui8USBPacket, &ui32Size, true);
+                ui32Bytes = ((ui32Result == SIM_USB_ACK) ? SIM_USB_OVERHEAD :
+                             SIM_USB_NO_DATA);
+            }
+            break;
+        }
+    }
+
+    ui64End = SimUSBTransaction(ui64Time, ui32Bytes, ui32Result);
+    if((ui32Stage == SIM_USB_STAGE_STATUS) && (ui32Result == SIM_USB_ACK))
+    {
+        g_ui32USBAction = SIM_USB_ACT_NONE;
+        g_ui64USBNext = 0;
+        SimUSBHostNext(ui64End);
+    }
+}
+
+//*****************************************************************************
+//
+// Sends the next packet of a bulk download to endpoint 1, at the given time.
+//
+//*****************************************************************************
+static void
+SimUSBBulk(uint64_t ui64Time)
+{
+    uint32_t ui32Result, ui32Size;
+    uint64_t ui64End;
+
+    SimUSBAnswerCheck();
+    if(g_ui16USBRxMaxP1 < USB_BULK_MAX_PACKET)
+    {
+        SimUSBFail("the bulk endpoint is not set up for its packet size");
+    }
+
+    ui32Result = SIM_USB_NAK;
+    if(!g_bUSBEP1Ready)
+    {
+        ui32Size = g_ui32USBImageSize - g_ui32USBOffset;
+        if(ui32Size > USB_BULK_MAX_PACKET)
+        {
+            ui32Size = USB_BULK_MAX_PACKET;
+        }
+        memcpy(g_pui8USBEP1, g_pui8USBImage + g_ui32USBOffset, ui32Size);
+        memset(g_pui8USBEP1 + ui32Size, 0xff, USB_BULK_MAX_PACKET - ui32Size);
+        g_ui32USBEP1Size = USB_BULK_MAX_PACKET;
+        g_bUSBEP1Ready = true;
+        SimUSBDMA();
+        ui32Result = SIM_USB_ACK;
+    }
+
+    ui64End = SimUSBTransaction(ui64Time,
+                                SIM_USB_OVERHEAD + USB_BULK_MAX_PACKET,
+                                ui32Result);
+    if(ui32Result == SIM_USB_ACK)
+    {
+        g_ui32USBPackets++;
+        g_ui32USBOffset += USB_BULK_MAX_PACKET;
+        g_ui64USBDeadline = ui64End + g_ui64HostTimeout;
+        if(g_ui32USBOffset >= g_ui32USBImageSize)
+        {
+            g_ui32USBAction = SIM_USB_ACT_NONE;
+            g_ui64USBNext = 0;
+            SimUSBHostNext(ui64End);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Takes the host's next action, which is due now.
+//
+//*****************************************************************************
+static void
+SimUSBHostEvent(void)
+{
+    uint64_t ui64Time;
+
+    ui64Time = g_ui64USBNext;
+    switch(g_ui32USBAction)
+    {
+        case SIM_USB_ACT_RESET:
+        {
+            //
+            // Reset the bus, which starts the frames once it is over.
+            //
+            SimUSBBusReset();
+            g_ui8USBHostAddress = 0;
+            g_ui64USBFrameStart = (ui64Time +
+                                   MicrosecondsToCycles(SIM_USB_RESET_MS *
+                                                        1000.0));
+            g_ui32USBAction = SIM_USB_ACT_NONE;
+            g_ui64USBNext = 0;
+            SimUSBHostNext(g_ui64USBFrameStart);
+            break;
+        }
+
+        case SIM_USB_ACT_CONTROL:
+        {
+            SimUSBControl(ui64Time);
+            break;
+        }
+
+        case SIM_USB_ACT_BULK:
+        {
+            SimUSBBulk(ui64Time);
+            break;
+        }
+
+        case SIM_USB_ACT_DETACH:
+        {
+            SimUSBFail("the device did not leave the bus after the download");
+            break;
+        }
+
+        default:
+        {
+            g_ui64USBNext = 0;
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Has the host see the device connect at the given time.
+//
+//*****************************************************************************
+static void
+SimUSBAttach(uint64_t ui64Time)
+{
+    g_ui64USBAttach = ui64Time;
+    g_ui32USBAction = SIM_USB_ACT_RESET;
+    g_ui64USBNext = ui64Time + MicrosecondsToCycles(SIM_USB_ATTACH_MS *
+                                                    1000.0);
+}
+
+//*****************************************************************************
+//
+// Applies a write of the power register, in which the boot loader connects
+// the device to the bus and takes it off again.
+//
+//*****************************************************************************
+static void
+SimUSBPowerSet(uint8_t ui8Value)
+{
+    bool bWas;
+
+    bWas = (g_ui8USBPower & USB_POWER_SOFTCONN) ? true : false;
+    g_ui8USBPower = ui8Value;
+    if(!bWas && (ui8Value & USB_POWER_SOFTCONN))
+    {
+        if(g_bUSBInRun && !g_ui64USBAttach)
+        {
+            SimUSBAttach(g_ui64Now);
+        }
+    }
+    else if(bWas && !(ui8Value & USB_POWER_SOFTCONN))
+    {
+        if(g_ui32USBStep == SIM_USB_STEP_DETACH)
+        {
+            g_ui64USBDetach = g_ui64Now;
+            g_ui32USBStep = SIM_USB_STEP_DONE;
+            g_ui32USBAction = SIM_USB_ACT_NONE;
+            g_ui64USBNext = 0;
+        }
+        else if(g_ui64USBAttach)
+        {
+            SimUSBFail("the device left the bus before the download was "
+                       "over");
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Applies a write of endpoint 0's control and status register.  Writing a
+// one to RXRDYC frees the FIFO for the next packet, TXRDY sends the packet
+// that has been loaded, DATAEND lets the status stage complete and STALL
+// stalls the request.  STALLED is cleared by writing a zero to it.
+//
+//*****************************************************************************
+static void
+SimUSBCSRL0Set(uint8_t ui8Value)
+{
+    if(ui8Value & USB_CSRL0_RXRDYC)
+    {
+        g_bUSBEP0RxReady = false;
+    }
+    g_ui8USBCSRL0 |= ui8Value & (USB_CSRL0_TXRDY | USB_CSRL0_DATAEND |
+                                 USB_CSRL0_STALL);
+    if(!(ui8Value & USB_CSRL0_STALLED))
+    {
+        g_ui8USBCSRL0 &= ~USB_CSRL0_STALLED;
+    }
+}
+
+//*****************************************************************************
+//
+// Starts the host model at the given time.  The boot loader has configured
+// the controller, and the host sees the device connect once the boot loader
+// has connected it, which its last register access may have done.
+//
+//*****************************************************************************
+void
+SimUSBStart(uint64_t ui64Start)
+{
+    SimRegResolve();
+    g_dUSBByteCycles = (g_ui32SysClockHz * 8.0) / SIM_USB_BIT_RATE;
+    g_ui64USBFrameCycles = MicrosecondsToCycles(SIM_USB_FRAME_MS * 1000.0);
+    g_ui64USBStart = ui64Start;
+    g_bUSBInRun = true;
+    if(g_ui8USBPower & USB_POWER_SOFTCONN)
+    {
+        SimUSBAttach(ui64Start);
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the time of the host's next action, or zero if it has none.
+//
+//*****************************************************************************
+uint64_t
+SimUSBNextEvent(void)
+{
+    return(g_ui64USBNext);
+}
+
+//*****************************************************************************
+//
+// Brings the host and the controller up to the current time, taking the
+// controller's interrupt after each action of the host's if it is pending.
+// The interrupt handler's own register accesses bring the host along with
+// it.
+//
+//*****************************************************************************
+void
+SimUSBUpdate(void)
+{
+    while(g_ui64USBNext && (g_ui64USBNext <= g_ui64Now))
+    {
+        SimUSBHostEvent();
+        SimUSBInterrupt();
+    }
+    SimUSBInterrupt();
+}
+
+//*****************************************************************************
+//
+// Gives the value that a read of a controller register returns now,
+// returning false if the register is not one that this model keeps.  The
+// registers are read a byte or a halfword at a time, so the interrupt status
+// registers are cleared by a read of their own part of the word that holds
+// them, and a read of the endpoint 0 FIFO takes the next byte of the packet
+// in it.  With no packet to read, the access is a write of the packet to be
+// sent.
+//
+//*****************************************************************************
+bool
+SimUSBRead(uint32_t ui32Address, uint32_t *pui32Value)
+{
+    switch(ui32Address)
+    {
+        case USB0_BASE + USB_O_FADDR:
+        {
+            *pui32Value = (g_ui8USBAddress | (g_ui8USBPower << 8) |
+                           (g_ui16USBTxIS << 16));
+            if(g_ui32RegByte == (USB_O_TXIS & 3))
+            {
+                g_ui16USBTxIS = 0;
+            }
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_RXIS:
+        {
+            *pui32Value = g_ui16USBRxIS | (g_ui16USBTxIE << 16);
+            if(g_ui32RegByte == (USB_O_RXIS & 3))
+            {
+                g_ui16USBRxIS = 0;
+            }
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_RXIE:
+        {
+            *pui32Value = (g_ui16USBRxIE | (g_ui8USBIS << 16) |
+                           (g_ui8USBIE << 24));
+            if(g_ui32RegByte == (USB_O_IS & 3))
+            {
+                g_ui8USBIS = 0;
+            }
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_FIFO0:
+        {
+            g_bUSBFIFOWrite = !(g_bUSBEP0RxReady &&
+                                (g_ui32USBEP0RxRead < g_ui32USBEP0RxSize));
+            *pui32Value = (g_bUSBFIFOWrite ? 0 :
+                           g_pui8USBEP0Rx[g_ui32USBEP0RxRead++]);
+            return(true);
+        }
+
+        case USB0_BASE + (USB_O_CSRL0 & ~3):
+        {
+            *pui32Value = ((g_bUSBEP0RxReady ? USB_CSRL0_RXRDY : 0) |
+                           (g_ui8USBCSRL0 &
+                            (USB_CSRL0_TXRDY | USB_CSRL0_STALLED))) << 16;
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_COUNT0:
+        {
+            *pui32Value = (g_bUSBEP0RxReady ?
+                           (g_ui32USBEP0RxSize - g_ui32USBEP0RxRead) : 0);
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_RXMAXP1:
+        {
+            *pui32Value = (g_ui16USBRxMaxP1 |
+                           ((g_bUSBEP1Ready ? USB_RXCSRL1_RXRDY : 0) << 16) |
+                           (g_ui8USBRxCSRH1 << 24));
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_RXCOUNT1:
+        {
+            *pui32Value = g_bUSBEP1Ready ? g_ui32USBEP1Size : 0;
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_DMAINTR:
+        {
+            *pui32Value = g_ui32USBDMAIntr;
+            g_ui32USBDMAIntr = 0;
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_DMACTL0:
+        {
+            *pui32Value = g_ui32USBDMACtl;
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_DMAADDR0:
+        {
+            *pui32Value = g_ui32USBDMAAddr;
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_DMACOUNT0:
+        {
+            *pui32Value = g_ui32USBDMACount;
+            return(true);
+        }
+
+        default:
+        {
+            return(false);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Returns true if an access to the register that leaves its value as it was
+// read is still a write, which is so of the endpoint 0 FIFO when it had no
+// packet to be read.
+//
+//*****************************************************************************
+bool
+SimUSBWriteOnly(uint32_t ui32Address)
+{
+    return((ui32Address == (USB0_BASE + USB_O_FIFO0)) && g_bUSBFIFOWrite);
+}
+
+//*****************************************************************************
+//
+// Applies the side effects of a write to a controller register, returning
+// false if the register is not one that this model keeps.  The part of the
+// word written is the one at the offset of the access.
+//
+//*****************************************************************************
+bool
+SimUSBWrite(uint32_t ui32Address, uint32_t ui32Value)
+{
+    uint32_t ui32Byte;
+
+    ui32Byte = (ui32Value >> (8 * g_ui32RegByte)) & 0xff;
+    switch(ui32Address)
+    {
+        case USB0_BASE + USB_O_FADDR:
+        {
+            if(g_ui32RegByte == USB_O_FADDR)
+            {
+                g_ui8USBAddress = ui32Byte & 0x7f;
+            }
+            else if(g_ui32RegByte == USB_O_POWER)
+            {
+                SimUSBPowerSet(ui32Byte);
+            }
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_RXIS:
+        {
+            if(g_ui32RegByte == (USB_O_TXIE & 3))
+            {
+                g_ui16USBTxIE = ui32Value >> 16;
+            }
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_RXIE:
+        {
+            if(g_ui32RegByte == (USB_O_RXIE & 3))
+            {
+                g_ui16USBRxIE = ui32Value & 0xffff;
+            }
+            else if(g_ui32RegByte == (USB_O_IE & 3))
+            {
+                g_ui8USBIE = ui32Byte;
+            }
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_FIFO0:
+        {
+            if(g_ui32USBEP0TxSize == USB_EP0_MAX_PACKET)
+            {
+                SimUSBFail("the boot loader overfilled the endpoint 0 FIFO");
+            }
+            g_pui8USBEP0Tx[g_ui32USBEP0TxSize++] = ui32Value & 0xff;
+            return(true);
+        }
+
+        case USB0_BASE + (USB_O_CSRL0 & ~3):
+        {
+            if(g_ui32RegByte == (USB_O_CSRL0 & 3))
+            {
+                SimUSBCSRL0Set(ui32Byte);
+            }
+            else if((g_ui32RegByte == (USB_O_CSRH0 & 3)) &&
+                    (ui32Byte & USB_CSRH0_FLUSH))
+            {
+                g_bUSBEP0RxReady = false;
+                g_ui32USBEP0TxSize = 0;
+                g_ui8USBCSRL0 &= ~USB_CSRL0_TXRDY;
+            }
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_RXMAXP1:
+        {
+            if(g_ui32RegByte == (USB_O_RXMAXP1 & 3))
+            {
+                g_ui16USBRxMaxP1 = ui32Value & 0xffff;
+            }
+            else if(g_ui32RegByte == (USB_O_RXCSRL1 & 3))
+            {
+                //
+                // Flushing the FIFO or clearing RXRDY frees it for the next
+                // packet.
+                //
+                if((ui32Byte & USB_RXCSRL1_FLUSH) ||
+                   !(ui32Byte & USB_RXCSRL1_RXRDY))
+                {
+                    g_bUSBEP1Ready = false;
+                    g_ui32USBEP1Size = 0;
+                }
+            }
+            else
+            {
+                g_ui8USBRxCSRH1 = ui32Byte;
+            }
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_DMAINTR:
+        case USB0_BASE + USB_O_RXCOUNT1:
+        case USB0_BASE + USB_O_COUNT0:
+        {
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_DMACTL0:
+        {
+            g_ui32USBDMACtl = ui32Value;
+            SimUSBDMA();
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_DMAADDR0:
+        {
+            g_ui32USBDMAAddr = ui32Value;
+            return(true);
+        }
+
+        case USB0_BASE + USB_O_DMACOUNT0:
+        {
+            g_ui32USBDMACount = ui32Value;
+            return(true);
+        }
+
+        default:
+        {
+            return(false);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Stand-ins for the driverlib functions that enable the controller's
+// interrupt and mask the processor's interrupts.  Unmasking them takes the
+// controller's interrupt at once if it is pending.  Each of the masking
+// functions returns true if interrupts were masked before.
+//
+//*****************************************************************************
+void
+IntEnable(uint32_t ui32Interrupt)
+{
+    if(ui32Interrupt == INT_USB0)
+    {
+        g_bUSBIntEnabled = true;
+    }
+}
+
+bool
+IntMasterEnable(void)
+{
+    bool bWas;
+
+    bWas = !g_bUSBMaster;
+    g_bUSBMaster = true;
+    SimUSBInterrupt();
+
+    return(bWas);
+}
+
+bool
+IntMasterDisable(void)
+{
+    bool bWas;
+
+    bWas = !g_bUSBMaster;
+    g_bUSBMaster = false;
+
+    return(bWas);
+}
+
+//*****************************************************************************
+//
+// Stands in for the driverlib function that waits for an interrupt, moving
+// time on to the host's next action until the controller's interrupt is
+// pending.  It need not be taken, as the boot loader waits with interrupts
+// masked and takes it once it unmasks them.
+//
+//*****************************************************************************
+void
+CPUwfi(void)
+{
+    uint64_t ui64Start;
+
+    ui64Start = g_ui64Now;
+    while(!SimUSBPending())
+    {
+        if(!g_ui64USBNext)
+        {
+            SimUSBFail("the boot loader waited for an interrupt that could "
+                       "not come");
+        }
+        if(g_ui64USBNext > g_ui64Now)
+        {
+            g_ui64Now = g_ui64USBNext;
+        }
+        SimUSBUpdate();
+    }
+    g_ui64USBSleep += g_ui64Now - ui64Start;
+}
+
+//*****************************************************************************
+//
+// Runs the update and reports the results.  Returns non-zero if the check
+// fails.
+//
+//*****************************************************************************
+int
+SimUSBRun(const uint8_t *pui8Image, uint32_t ui32Size)
+{
+    double dSeconds, dEnumerate, dDownload, dManifest;
+    bool bVerify, bFail;
+
+    g_pui8USBImage = pui8Image;
+    g_ui32USBImageSize = ui32Size;
+
+    //
+    // Run the boot loader until it resets to run the image, which it must
+    // only do once it has left the bus.
+    //
+    SimRun(true);
+    g_bUSBInRun = false;
+    if(g_ui32USBStep != SIM_USB_STEP_DONE)
+    {
+        SimUSBFail("the device reset before the host was done with it");
+    }
+
+    //
+    // Report the results.
+    //
+    dSeconds = (g_ui64USBDetach ?
+                CyclesToSeconds(g_ui64USBDetach - g_ui64USBAttach) : 0.0);
+    dEnumerate = (g_ui64USBConfigured ?
+                  CyclesToSeconds(g_ui64USBConfigured - g_ui64USBAttach) :
+                  0.0);
+    dDownload = (g_ui64USBDownloaded ?
+                 CyclesToSeconds(g_ui64USBDownloaded - g_ui64USBDownload) :
+                 0.0);
+    dManifest = (g_ui64USBDetach ?
+                 CyclesToSeconds(g_ui64USBDetach - g_ui64USBDownloaded) :
+                 0.0);
+    bVerify = !memcmp(g_pui8Flash + APP_START_ADDRESS, pui8Image, ui32Size);
+    printf("image:     %u bytes at 0x%08x\n", ui32Size, APP_START_ADDRESS);
+    printf("link:      USB full speed at %u Mbit/s, %u Hz system clock\n",
+           SIM_USB_BIT_RATE / 1000000, g_ui32SysClockHz);
+    if(g_bUSBBulk)
+    {
+        printf("transfer:  bulk download in %u byte packets, by DMA\n",
+               USB_BULK_MAX_PACKET);
+    }
+    else
+    {
+        printf("transfer:  DFU download requests of %u bytes\n",
+               g_ui32USBTransferSize);
+    }
+    printf("\n%-9s %12s %12s\n", "phase", "time (ms)", "bytes/s");
+    printf("%-9s %12.3f\n", "enumerate", dEnumerate * 1000.0);
+    printf("%-9s %12.3f %12.0f\n", "download", dDownload * 1000.0,
+           dDownload ? (ui32Size / dDownload) : 0.0);
+    printf("%-9s %12.3f\n", "manifest", dManifest * 1000.0);
+    printf("%-9s %12.3f %12.0f\n\n", "total", dSeconds * 1000.0,
+           dSeconds ? (ui32Size / dSeconds) : 0.0);
+    printf("flash:     %u erase commands, %u words programmed\n",
+           g_ui32Erases, g_ui32Programs);
+    printf("host:      %u control transfers, %u bulk packets, %u "
+           "transactions, %u NAKed,\n           %u status requests "
+           "answered busy\n", g_ui32USBTransfers, g_ui32USBPackets,
+           g_ui32USBTransactions, g_ui32USBNaks, g_ui32USBBusy);
+    printf("device:    %u interrupts, asleep for %.1f%% of the update\n",
+           g_ui32USBInterrupts,
+           dSeconds ? ((CyclesToSeconds(g_ui64USBSleep) * 100.0) / dSeconds) :
+           0.0);
+    printf("verify:    %s\n", bVerify ? "ok" : "FAILED");
+    if(g_pcUSBError)
+    {
+        printf("usb:       %s\n", g_pcUSBError);
+    }
+    bFail = (!bVerify || g_pcUSBError ||
+             (g_ui32USBStep != SIM_USB_STEP_DONE));
+    printf("check:     %s\n", bFail ? "FAILED" : "ok");
+
+    return(bFail ? 1 : 0);
+}
+#endif
@@ -0,0 +1,232 @@
+//*****************************************************************************
+//
+// sim_watchdog.c - Checks of the watchdog and of recovery from a lost link.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DBL_WATCHDOG_TIMEOUT=<ms>, the watchdog is modelled and the longest
+// time that the boot loader went without feeding it is reported.  The -L
+// option loses the link before the given frame, with the image already in
+// flash as the last good application, and reports how long the watchdog
+// took to reset the board.  It then decides, as bl_check.c would at reset,
+// whether the application runs; if the boot loader keeps control, the host
+// model starts again, resuming the download where the journal says that it
+// stopped if the build has -DFLASH_JOURNAL_ADDRESS.  Without the journal, a
+// link lost once the first block has been programmed leaves a part image
+// that looks valid and runs, which is reported as a failure.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "blsim.h"
+
+#ifdef BL_WATCHDOG_TIMEOUT
+#ifdef FLASH_JOURNAL_ADDRESS
+#include "boot_loader/bl_crc32.h"
+#include "boot_loader/bl_journal.h"
+#endif
+
+//*****************************************************************************
+//
+// The host model loses the link before frame g_ui32LinkLost, stopping as if
+// the cable were pulled, and notes when; after the reset it starts again,
+// resuming from block g_ui32SimResume unless that is 0xFFFFFFFF, and keeps
+// the status and next block that the resume command returned.
+//
+//*****************************************************************************
+uint32_t g_ui32LinkLost = 0xffffffff;
+uint64_t g_ui64LinkLost;
+uint32_t g_ui32SimResume = 0xffffffff;
+static uint8_t g_ui8ResumeStatus = 0xff;
+static uint32_t g_ui32ResumeBlock;
+
+//*****************************************************************************
+//
+// Keeps the status and next block from the reply to the resume command.
+//
+//*****************************************************************************
+void
+SimResumeReply(void)
+{
+    if((g_ui32SimResume != 0xffffffff) &&
+       (g_psFrames[g_ui32Frame].ui32Phase == PHASE_ERASE) &&
+       (g_pui8Reply[2] == 0x08))
+    {
+        g_ui8ResumeStatus = g_pui8Reply[4];
+        g_ui32ResumeBlock = (g_pui8Reply[5] << 8) | g_pui8Reply[6];
+    }
+}
+
+//*****************************************************************************
+//
+// Picks up after the watchdog has reset the board part way through a
+// download.  The reset is checked to have come within BL_WATCHDOG_TIMEOUT of
+// the link being lost, and then the check that the boot loader makes at
+// reset is made: an application whose vector table is sane runs, unless the
+// journal shows that a download of it did not finish.  If the application
+// runs it must be the one that was in flash before.  Otherwise the boot
+// loader is run again, from reset, with the host model resuming the download
+// from the block that the journal gives or, without one, starting it again.
+// Returns 1 if the boot loader kept control and the download was run again,
+// 0 if the application runs and -1 on a failure.
+//
+//*****************************************************************************
+int
+SimWatchdogRestart(uint8_t *pui8Image, uint32_t ui32Size)
+{
+    uint32_t *pui32Vectors, ui32Offset, ui32CRC;
+    double dLimit, dMs;
+    bool bRuns, bOk;
+
+    if(g_ui32LinkLost == 0xffffffff)
+    {
+        printf("watchdog:  FAILED (reset the board at frame %u with the link "
+               "up)\n", g_ui32Frame);
+        return(-1);
+    }
+    dMs = CyclesToSeconds(g_ui64Now - g_ui64LinkLost) * 1000.0;
+    dLimit = (double)BL_WATCHDOG_TIMEOUT;
+    bOk = (dMs <= (dLimit * 1.01));
+    printf("watchdog:  reset %.3f ms after the link was lost at frame %u, "
+           "limit %.0f ms, %s\n", dMs, g_ui32LinkLost, dLimit,
+           bOk ? "ok" : "FAILED");
+
+    //
+    // Decide, as the boot loader would at reset, whether the application
+    // runs.
+    //
+    pui32Vectors = (uint32_t *)(g_pui8Flash + APP_START_ADDRESS);
+    bRuns = (((pui32Vectors[0] & 0xfff00000) == 0x20000000) &&
+             ((pui32Vectors[1] & 0xfff00001) == 0x00000001));
+#ifdef FLASH_JOURNAL_ADDRESS
+    bRuns = bRuns && !JournalUnfinished(APP_START_ADDRESS);
+#endif
+    g_psLastReg = 0;
+    if(bRuns)
+    {
+        bRuns = !memcmp(g_pui8Flash + APP_START_ADDRESS, pui8Image, ui32Size);
+        printf("recovery:  the application runs, %s\n",
+               bRuns ? "intact, ok" : "FAILED (not the last good image)");
+        return((bOk && bRuns) ? 0 : -1);
+    }
+
+    //
+    // The boot loader keeps control, so start again, resuming if the journal
+    // has a download of this image that can be picked up.
+    //
+    g_ui32SimResume = 0xffffffff;
+#if defined(FLASH_JOURNAL_ADDRESS) && !defined(DECRYPT_AES_MODE)
+    bRuns = true;
+#ifdef SIM_MANIFEST
+    bRuns = !g_pui8Params;
+#endif
+    InitCRC32Table();
+    if(bRuns &&
+       JournalResume(APP_START_ADDRESS, ui32Size, &ui32Offset, &ui32CRC) &&
+       (ui32CRC == ~CalculateCRC32(pui8Image, ui32Offset, 0xffffffff)))
+    {
+        g_ui32SimResume = ui32Offset / 128;
+    }
+    g_psLastReg = 0;
+#else
+    (void)ui32Offset;
+    (void)ui32CRC;
+#endif
+    if(g_ui32SimResume != 0xffffffff)
+    {
+        printf("recovery:  the boot loader keeps control, resuming from "
+               "block %u\n", g_ui32SimResume);
+    }
+    else
+    {
+        printf("recovery:  the boot loader keeps control, starting again\n");
+    }
+
+    //
+    // A reset clears the boot loader's counters and leaves the host model
+    // with nothing outstanding.
+    //
+    memset(g_pui32Stats, 0, sizeof(g_pui32Stats));
+    memset(g_psPhases, 0, sizeof(g_psPhases));
+    g_ui32Erases = 0;
+    g_ui32Programs = 0;
+    g_ui32JournalErases = 0;
+    g_ui32JournalPrograms = 0;
+    g_ui32BufferPrograms = 0;
+    g_ui32Overruns = 0;
+    g_ui32Retries = 0;
+    g_ui32TotalRetries = 0;
+    g_ui32RxCount = 0;
+    g_ui32RxHead = 0;
+    g_ui32Frame = 0;
+    g_ui32LinkLost = 0xffffffff;
+    g_bStatsRead = false;
+    g_bWatchdogReset = false;
+    g_ui32WatchdogFeeds = 0;
+    g_ui64WatchdogGap = 0;
+    SimFramesBuild(pui8Image, ui32Size);
+
+    SimRun(true);
+    if(g_bWatchdogReset)
+    {
+        printf("recovery:  FAILED (the watchdog reset the board again)\n");
+        return(-1);
+    }
+
+    return(bOk ? 1 : -1);
+}
+
+//*****************************************************************************
+//
+// Reports how often the boot loader fed the watchdog and the longest time
+// that it went without doing so, and, if the download was resumed, checks
+// the boot loader's reply to the resume command.  Returns non-zero on a
+// failure.
+//
+//*****************************************************************************
+int
+SimWatchdogReport(void)
+{
+    double dGap;
+    bool bOk;
+
+    dGap = CyclesToSeconds(g_ui64WatchdogGap) * 1000.0;
+    bOk = (g_ui32WatchdogFeeds != 0) && (dGap < BL_WATCHDOG_TIMEOUT);
+    printf("watchdog:  %u feeds, longest gap %.3f ms of %u ms, %s\n",
+           g_ui32WatchdogFeeds, dGap, BL_WATCHDOG_TIMEOUT,
+           bOk ? "ok" : "FAILED");
+    if(g_ui32SimResume != 0xffffffff)
+    {
+        bOk = bOk && (g_ui8ResumeStatus == COMMAND_RET_SUCCESS) &&
+              (g_ui32ResumeBlock == g_ui32SimResume);
+        printf("resume:    %u blocks skipped, %s\n", g_ui32ResumeBlock,
+               ((g_ui8ResumeStatus == COMMAND_RET_SUCCESS) &&
+                (g_ui32ResumeBlock == g_ui32SimResume)) ? "ok" : "FAILED");
+    }
+
+    return(bOk ? 0 : 1);
+}
+#endif
@@ -0,0 +1,175 @@
+//*****************************************************************************
+//
+// sim_wear.c - Checks of the flash erase counters.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// With -DFLASH_WEAR_EEPROM_ADDRESS=<offset>, the EEPROM is modelled as an
+// array and the host model reads back every erase counter, checking it
+// against the erases that the flash model saw.  The -E option starts the
+// blocks that the image is sent to with that many erases already, holding an
+// old image, so that a new boot loader sent with -S should be staged clear
+// of them.
+//
+//*****************************************************************************
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "blsim.h"
+
+#ifdef FLASH_WEAR_EEPROM_ADDRESS
+#include "boot_loader/bl_flash.h"
+
+//*****************************************************************************
+//
+// The erases of each block that the boot loader's counters start out with,
+// the counters that the host model read back and the erases that the flash
+// model had seen when it did, and the erases that the boot loader said that
+// it skipped.
+//
+//*****************************************************************************
+static uint32_t g_pui32WearStart[SIM_FLASH_BLOCKS];
+static uint32_t g_pui32WearRead[SIM_FLASH_BLOCKS];
+static uint32_t g_pui32WearSeen[SIM_FLASH_BLOCKS];
+static uint32_t g_ui32WearReads;
+uint32_t g_ui32SimWearSkips;
+
+//*****************************************************************************
+//
+// Keeps the erase counters from a reply to the wear read frame.
+//
+//*****************************************************************************
+void
+SimWearReply(void)
+{
+    uint32_t ui32Block, ui32Idx;
+
+    if((g_psFrames[g_ui32Frame].ui32Phase != PHASE_STATUS) ||
+       (g_pui8Reply[3] != 0x0D))
+    {
+        return;
+    }
+
+    ui32Block = (g_pui8Reply[5] << 8) | g_pui8Reply[6];
+    for(ui32Idx = 0; (ui32Idx < g_pui8Reply[7]) &&
+                     (ui32Idx < WEAR_REPLY_BLOCKS) &&
+                     ((ui32Block + ui32Idx) < SIM_FLASH_BLOCKS);
+        ui32Idx++)
+    {
+        g_pui32WearRead[ui32Block + ui32Idx] =
+            ((g_pui8Reply[12 + (2 * ui32Idx)] << 8) |
+             g_pui8Reply[13 + (2 * ui32Idx)]);
+        g_pui32WearSeen[ui32Block + ui32Idx] =
+            g_pui32BlockErases[ui32Block + ui32Idx];
+        g_ui32WearReads++;
+    }
+    g_ui32SimWearSkips = ((g_pui8Reply[8] << 24) | (g_pui8Reply[9] << 16) |
+                          (g_pui8Reply[10] << 8) | g_pui8Reply[11]);
+}
+
+//*****************************************************************************
+//
+// Starts the given blocks out with the given number of erases, both in the
+// boot loader's counters and in what the flash model expects them to read.
+// Blocks with any erases are filled with an old image of zeros, so that they
+// have to be erased again.
+//
+//*****************************************************************************
+void
+SimWearSet(uint32_t ui32Address, uint32_t ui32Size, uint32_t ui32Erases)
+{
+    uint32_t ui32Block, ui32Word, ui32Shift;
+
+    for(ui32Block = ui32Address / SIM_FLASH_BLOCK;
+        (ui32Block < SIM_FLASH_BLOCKS) &&
+        ((ui32Block * SIM_FLASH_BLOCK) < (ui32Address + ui32Size));
+        ui32Block++)
+    {
+        ui32Shift = (ui32Block & 1) * 16;
+        memcpy(&ui32Word, g_pui8EEPROM + FLASH_WEAR_EEPROM_ADDRESS +
+               ((ui32Block / 2) * 4), 4);
+        ui32Word &= ~(0xffff << ui32Shift);
+        ui32Word |= (~ui32Erases & 0xffff) << ui32Shift;
+        memcpy(g_pui8EEPROM + FLASH_WEAR_EEPROM_ADDRESS +
+               ((ui32Block / 2) * 4), &ui32Word, 4);
+        g_pui32WearStart[ui32Block] = ui32Erases;
+        g_pui32BlockErases[ui32Block] = ui32Erases;
+        if(ui32Erases)
+        {
+            memset(g_pui8Flash + (ui32Block * SIM_FLASH_BLOCK), 0,
+                   SIM_FLASH_BLOCK);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Checks the erase counters read back against the erases that the flash
+// model saw, and that a new boot loader was staged clear of the blocks that
+// were worn to start with, if there was room.  Returns non-zero on a failure.
+//
+//*****************************************************************************
+int
+SimWearCheck(void)
+{
+    uint32_t ui32Block, ui32Erases;
+    bool bOk;
+
+    bOk = (g_ui32WearReads == SIM_FLASH_BLOCKS);
+    ui32Erases = 0;
+    for(ui32Block = 0; ui32Block < SIM_FLASH_BLOCKS; ui32Block++)
+    {
+        if(g_pui32WearRead[ui32Block] != g_pui32WearSeen[ui32Block])
+        {
+            bOk = false;
+        }
+        ui32Erases += g_pui32WearSeen[ui32Block] - g_pui32WearStart[ui32Block];
+    }
+    printf("wear:      %u erases counted, %u skipped as blank, counters %s\n",
+           ui32Erases, g_ui32SimWearSkips, bOk ? "ok" : "FAILED");
+#ifdef BL_UPDATE_STAGED
+    if(g_bStaged)
+    {
+        ui32Erases = 0;
+        for(ui32Block = g_ui32StageAddress / SIM_FLASH_BLOCK;
+            (ui32Block * SIM_FLASH_BLOCK) <
+            (g_ui32StageAddress + g_ui32StageSize);
+            ui32Block++)
+        {
+            if((ui32Block * SIM_FLASH_BLOCK) != APP_START_ADDRESS)
+            {
+                ui32Erases += g_pui32WearStart[ui32Block];
+            }
+        }
+        printf("           boot loader staged at 0x%08x, %s\n",
+               g_ui32StageAddress, ui32Erases ? "on worn blocks FAILED" :
+                                                "clear of worn blocks ok");
+        bOk = bOk && !ui32Erases;
+    }
+#endif
+
+    return(bOk ? 0 : 1);
+}
+#endif
@@ -0,0 +1,2002 @@
+//*****************************************************************************
+//
+// blupdate.c - Linux host updater for the serial boot loader.
+//
+// Copyright (c) 2006-2020 Texas Instruments Incorporated.  All rights reserved.
+// Software License Agreement
+// 
+// Texas Instruments (TI) is supplying this software for use solely and
+// exclusively on TI's microcontroller products. The software is owned by
+// TI and/or its suppliers, and is protected under applicable copyright
+// laws. You may not combine this software with "viral" open-source
+// software in order to form a larger program.
+// 
+// THIS SOFTWARE IS PROVIDED "AS IS" AND WITH ALL FAULTS.
+// NO WARRANTIES, WHETHER EXPRESS, IMPLIED OR STATUTORY, INCLUDING, BUT
+// NOT LIMITED TO, IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+// A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. TI SHALL NOT, UNDER ANY
+// CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL, OR CONSEQUENTIAL
+// DAMAGES, FOR ANY REASON WHATSOEVER.
+// 
+// This is part of revision 2.2.0.295 of the Tiva Firmware Development Package.
+//
+//*****************************************************************************
+
+//*****************************************************************************
+//
+// This program downloads an image to the boot loader over a serial port,
+// speaking the same 0x6001 (ping), 0x6003 (download), 0x6006/0x6007 (data)
+// and 0x6000 (reset) frames that Updater() handles.
+//
+// The whole update is framed in memory before the port is opened, so that
+// the data phase is nothing more than writes from one contiguous buffer.  By
+// default each data frame carries its block number (0x6007) and the boot
+// loader's progress reply to it says which block it expects next.  With a
+// window of more than one frame, -w, the next frames are sent while the
+// replies to the earlier ones are still on their way back; a frame that the
+// boot loader drops is detected from the replies and everything from it
+// onward is sent again.  A window only helps on a full-duplex link, since
+// on an RS-485 bus the replies would collide with the frames being sent,
+// and the boot loader has to be able to program a block before its UART
+// receive FIFO fills with the next one.  The -l option falls back to
+// stop-and-wait with plain 0x6006 frames for boot loaders that predate
+// 0x6007.  Those carry no block number, so a frame sent again because its
+// ACK was lost is programmed a second time, over the next block.
+//
+// With -s, runs of blocks that are entirely erased (0xFF) are not sent at
+// all: a 0x6008 skip frame tells the boot loader to move past them, since
+// the download command has already erased them.  -R sends only the blocks
+// covered by a list of "<address> <length>" regions instead, such as the
+// one "blpack -r" writes from the segments of a HEX or ELF file.
+//
+// With -c, a download that was cut short by a lost link or a reset is
+// resumed rather than started again, if the boot loader keeps a progress
+// journal (FLASH_JOURNAL_ADDRESS).  In place of the download command a
+// 0x6009 resume frame asks the boot loader where the journal left off; if
+// the CRC32 it returns matches the start of this image, nothing is erased
+// and the data frames carry on from there.  Otherwise, or if the boot
+// loader does not support resuming, the image is erased and sent in full.
+//
+// With -k, the image is taken to be encrypted for a boot loader built with
+// DECRYPT_AES_MODE, and the initial counter block or IV given is written to
+// register 0x600A once the download command has been acknowledged.  An
+// image for CTR mode can be made with "openssl enc -aes-128-ctr -K <key>
+// -iv <iv>", and one for CBC mode with -aes-128-cbc -nopad after padding it
+// to a multiple of 16 bytes.  The journal of a boot loader that decrypts
+// holds the CRC32 of the decrypted image, so -c always starts again.
+//
+// With -D <address>:<size>, nothing is updated: the region of flash is read
+// back through 0x600E and written to the file named on the command line, or
+// with -x compared with it, the bytes past the end of a shorter file being
+// taken as erased.  The boot loader streams the region in frames of up to
+// DUMP_FRAME_SIZE bytes, each with its own CRC16; if one is damaged or
+// missing, the rest are let through and the region is read again from the
+// first byte not yet received.
+//
+// Build it with:
+//
+//     gcc -O2 -I. -o blupdate tools/blupdate/blupdate.c
+//
+// and run it as:
+//
+//     blupdate -p /dev/ttyUSB0 [options] <image.bin>
+//     blupdate -p /dev/ttyUSB0 -D 0x8000:0x10000 [-x] [options] <file.bin>
+//
+// Giving -p more than once updates every port at the same time, as on a
+// production line with a fixture per board.  One epoll loop drives them
+// all, each port running the update independently from the one shared set
+// of frames, so the station is limited by the slowest board rather than the
+// sum of them.  A progress line is kept up to date on a terminal, and with
+// -L each port's report is also written to <dir>/<port name>.log.
+//
+// tools/blsim can stand in for a board: "blsim -P /tmp/ttyBL" serves the
+// boot loader's own packet handling on a pty, backed by simulated flash.
+//
+//*****************************************************************************
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <limits.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+#include "boot_loader/bl_commands.h"
+
+//*****************************************************************************
+//
+// The frame layout: an ID, a command and a register address, the payload and
+// a CRC16 that is sent most significant byte first.
+//
+//*****************************************************************************
+#define FRAME_HEADER_SIZE       4
+#define FRAME_CRC_SIZE          2
+#define BLOCK_SIZE              128
+#define CONTROL_FRAME_SIZE      (FRAME_HEADER_SIZE + DECRYPT_IV_SIZE + \
+                                 FRAME_CRC_SIZE)
+#define SKIP_FRAME_SIZE         (FRAME_HEADER_SIZE + 4 + FRAME_CRC_SIZE)
+
+//*****************************************************************************
+//
+// The replies that the boot loader sends.
+//
+//*****************************************************************************
+#define REPLY_NONE              0
+#define REPLY_PING              1
+#define REPLY_PROGRESS          2
+#define REPLY_ACK               3
+#define REPLY_RESUME            4
+#define REPLY_MAX_SIZE          13
+
+//*****************************************************************************
+//
+// The most ports that can be updated at once, and the interval between
+// updates of the progress line, in microseconds.
+//
+//*****************************************************************************
+#define MAX_DEVICES             64
+#define PROGRESS_INTERVAL       250000
+
+//*****************************************************************************
+//
+// The phases of an update.
+//
+//*****************************************************************************
+#define PHASE_CONNECT           0
+#define PHASE_ERASE             1
+#define PHASE_PROGRAM           2
+#define PHASE_RESET             3
+#define NUM_PHASES              4
+#define PHASE_DONE              4
+#define PHASE_FAILED            5
+
+static const char * const g_ppcPhaseNames[NUM_PHASES] =
+{
+    "connect", "erase", "program", "reset"
+};
+
+//*****************************************************************************
+//
+// The options, as set on the command line.
+//
+//*****************************************************************************
+typedef struct
+{
+    uint32_t ui32Baud;
+    uint32_t ui32Address;
+    uint32_t ui32ID;
+    uint32_t ui32Window;
+    uint32_t ui32Timeout;
+    uint32_t ui32EraseTimeout;
+    uint32_t ui32Retries;
+    bool bLegacy;
+    bool bSparse;
+    bool bResume;
+    bool bIV;
+    uint8_t pui8IV[DECRYPT_IV_SIZE];
+}
+tOptions;
+
+//*****************************************************************************
+//
+// The frames that carry the image, one after the other in one buffer.  Frame
+// n starts at pui8Data[pui32Offset[n]] and takes the transfer from block
+// pui32Block[n]; the last entry of each array is the end of the frames and
+// the number of blocks.  Every port shares the one set of frames.
+//
+//*****************************************************************************
+typedef struct
+{
+    const uint8_t *pui8Image;
+    uint32_t ui32Size;
+    uint8_t *pui8Data;
+    uint32_t *pui32Offset;
+    uint32_t *pui32Block;
+    uint32_t ui32Frames;
+    uint32_t ui32Blocks;
+}
+tFrames;
+
+//*****************************************************************************
+//
+// The state of the update of one device.
+//
+//*****************************************************************************
+typedef struct
+{
+    //
+    // The serial port.
+    //
+    const char *pcPort;
+    int iFd;
+    uint32_t ui32Events;
+
+    //
+    // The pre-built data frames and the frame for the control command of
+    // the current phase.
+    //
+    const tFrames *psFrames;
+    uint8_t pui8Control[CONTROL_FRAME_SIZE];
+
+    //
+    // The bytes being sent: pui8Tx[ui32TxOffset] up to pui8Tx[ui32TxEnd].
+    //
+    const uint8_t *pui8Tx;
+    uint32_t ui32TxOffset;
+    uint32_t ui32TxEnd;
+
+    //
+    // Received bytes that do not yet make up a whole reply.
+    //
+    uint8_t pui8Rx[REPLY_MAX_SIZE];
+    uint32_t ui32RxCount;
+
+    //
+    // The update progress.  ui32Base is the first block not yet accepted by
+    // the boot loader and ui32Rewind is one more than the block that frames
+    // were last sent again from, or zero.  bRewind is set while sending
+    // again is held off until a partly sent frame is finished.  bResume is
+    // set while a resume is being tried, and ui32Start is the block that the
+    // data frames start from.  bIV is set while the write of the initial
+    // counter block or IV is waiting for its reply.
+    //
+    uint32_t ui32Phase;
+    bool bResume;
+    bool bIV;
+    uint32_t ui32Start;
+    uint32_t ui32Base;
+    uint32_t ui32Rewind;
+    bool bRewind;
+    uint32_t ui32Tries;
+    uint32_t ui32TotalRetries;
+    uint64_t ui64Deadline;
+    const char *pcError;
+
+    //
+    // The time spent in, and the frames and payload bytes accepted in, each
+    // phase.
+    //
+    uint64_t pui64PhaseStart[NUM_PHASES];
+    uint64_t pui64PhaseEnd[NUM_PHASES];
+    uint32_t pui32PhaseFrames[NUM_PHASES];
+    uint32_t pui32PhaseBytes[NUM_PHASES];
+}
+tDevice;
+
+static tOptions g_sOptions;
+
+//*****************************************************************************
+//
+// Returns the monotonic time in microseconds.
+//
+//*****************************************************************************
+static uint64_t
+TimeNow(void)
+{
+    struct timespec sTime;
+
+    clock_gettime(CLOCK_MONOTONIC, &sTime);
+
+    return(((uint64_t)sTime.tv_sec * 1000000) + (sTime.tv_nsec / 1000));
+}
+
+//*****************************************************************************
+//
+// Calculates the CRC16 that terminates a frame.
+//
+//*****************************************************************************
+static uint32_t
+CRC16(const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint32_t ui32CRC, ui32Bit;
+
+    ui32CRC = 0xffff;
+    while(ui32Size--)
+    {
+        ui32CRC ^= *pui8Data++;
+        for(ui32Bit = 0; ui32Bit < 8; ui32Bit++)
+        {
+            ui32CRC = (ui32CRC & 1) ? ((ui32CRC >> 1) ^ 0xa001) :
+                                      (ui32CRC >> 1);
+        }
+    }
+
+    return(ui32CRC);
+}
+
+//*****************************************************************************
+//
+// Calculates the CRC32 of the given number of blocks from the start of the
+// image, as padded to a whole number of blocks with erased bytes.  This is
+// the CRC32 that the boot loader's progress journal keeps.
+//
+//*****************************************************************************
+static uint32_t
+ImageCRC32(const tFrames *psFrames, uint32_t ui32Blocks)
+{
+    uint32_t ui32CRC, ui32Idx, ui32Bit;
+
+    ui32CRC = 0xffffffff;
+    for(ui32Idx = 0; ui32Idx < (ui32Blocks * BLOCK_SIZE); ui32Idx++)
+    {
+        ui32CRC ^= ((ui32Idx < psFrames->ui32Size) ?
+                    psFrames->pui8Image[ui32Idx] : 0xff);
+        for(ui32Bit = 0; ui32Bit < 8; ui32Bit++)
+        {
+            ui32CRC = (ui32CRC & 1) ? ((ui32CRC >> 1) ^ 0xedb88320) :
+                                      (ui32CRC >> 1);
+        }
+    }
+
+    return(~ui32CRC);
+}
+
+//*****************************************************************************
+//
+// Builds a frame from its command, register address and payload, returning
+// its size.
+//
+//*****************************************************************************
+static uint32_t
+FrameBuild(uint8_t *pui8Frame, uint8_t ui8Cmd, uint16_t ui16Address,
+           const uint8_t *pui8Payload, uint32_t ui32Payload)
+{
+    uint32_t ui32CRC;
+
+    pui8Frame[0] = g_sOptions.ui32ID;
+    pui8Frame[1] = ui8Cmd;
+    pui8Frame[2] = ui16Address >> 8;
+    pui8Frame[3] = ui16Address & 0xff;
+    memcpy(&pui8Frame[FRAME_HEADER_SIZE], pui8Payload, ui32Payload);
+    ui32CRC = CRC16(pui8Frame, FRAME_HEADER_SIZE + ui32Payload);
+    pui8Frame[FRAME_HEADER_SIZE + ui32Payload] = ui32CRC >> 8;
+    pui8Frame[FRAME_HEADER_SIZE + ui32Payload + 1] = ui32CRC & 0xff;
+
+    return(FRAME_HEADER_SIZE + ui32Payload + FRAME_CRC_SIZE);
+}
+
+//*****************************************************************************
+//
+// Frames the image into one buffer, padding the last block with erased
+// bytes.  Each block is sent in a data frame unless pui8Send is given and
+// says it need not be, in which case each run of such blocks is covered by a
+// skip frame.
+//
+//*****************************************************************************
+static bool
+FramesBuild(const uint8_t *pui8Image, uint32_t ui32Size,
+            const uint8_t *pui8Send, tFrames *psFrames)
+{
+    uint8_t pui8Payload[BLOCK_SIZE + 2];
+    uint32_t ui32Block, ui32Blocks, ui32Offset, ui32Frame, ui32End;
+
+    ui32Blocks = (ui32Size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    psFrames->pui8Data = malloc(ui32Blocks * (FRAME_HEADER_SIZE + BLOCK_SIZE +
+                                              2 + FRAME_CRC_SIZE));
+    psFrames->pui32Offset = malloc((ui32Blocks + 1) * sizeof(uint32_t));
+    psFrames->pui32Block = malloc((ui32Blocks + 1) * sizeof(uint32_t));
+    if(!psFrames->pui8Data || !psFrames->pui32Offset ||
+       !psFrames->pui32Block)
+    {
+        return(false);
+    }
+
+    psFrames->pui8Image = pui8Image;
+    psFrames->ui32Size = ui32Size;
+    ui32Offset = 0;
+    ui32Frame = 0;
+    for(ui32Block = 0; ui32Block < ui32Blocks; ui32Block = ui32End)
+    {
+        psFrames->pui32Offset[ui32Frame] = ui32Offset;
+        psFrames->pui32Block[ui32Frame++] = ui32Block;
+        ui32End = ui32Block + 1;
+
+        if(pui8Send && !pui8Send[ui32Block])
+        {
+            //
+            // Skip this block and any that follow it that need not be sent.
+            //
+            while((ui32End < ui32Blocks) && !pui8Send[ui32End])
+            {
+                ui32End++;
+            }
+            pui8Payload[0] = (ui32Block >> 8) & 0xff;
+            pui8Payload[1] = ui32Block & 0xff;
+            pui8Payload[2] = (ui32End >> 8) & 0xff;
+            pui8Payload[3] = ui32End & 0xff;
+            ui32Offset += FrameBuild(psFrames->pui8Data + ui32Offset, 0x10,
+                                     0x6008, pui8Payload, 4);
+            continue;
+        }
+
+        memset(pui8Payload, 0xff, BLOCK_SIZE);
+        memcpy(pui8Payload, pui8Image + (ui32Block * BLOCK_SIZE),
+               ((ui32Size - (ui32Block * BLOCK_SIZE)) < BLOCK_SIZE) ?
+               (ui32Size - (ui32Block * BLOCK_SIZE)) : BLOCK_SIZE);
+        if(g_sOptions.bLegacy)
+        {
+            ui32Offset += FrameBuild(psFrames->pui8Data + ui32Offset, 0x10,
+                                     0x6006, pui8Payload, BLOCK_SIZE);
+        }
+        else
+        {
+            pui8Payload[BLOCK_SIZE] = (ui32Block >> 8) & 0xff;
+            pui8Payload[BLOCK_SIZE + 1] = ui32Block & 0xff;
+            ui32Offset += FrameBuild(psFrames->pui8Data + ui32Offset, 0x10,
+                                     0x6007, pui8Payload, BLOCK_SIZE + 2);
+        }
+    }
+    psFrames->pui32Offset[ui32Frame] = ui32Offset;
+    psFrames->pui32Block[ui32Frame] = ui32Blocks;
+    psFrames->ui32Frames = ui32Frame;
+    psFrames->ui32Blocks = ui32Blocks;
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Returns the frame that starts with the given block, or that contains the
+// given byte of the frame buffer.
+//
+//*****************************************************************************
+static uint32_t
+FrameFind(const uint32_t *pui32Starts, uint32_t ui32Frames, uint32_t ui32Value)
+{
+    uint32_t ui32Low, ui32High, ui32Mid;
+
+    ui32Low = 0;
+    ui32High = ui32Frames;
+    while(ui32Low < ui32High)
+    {
+        ui32Mid = (ui32Low + ui32High + 1) / 2;
+        if(pui32Starts[ui32Mid] <= ui32Value)
+        {
+            ui32Low = ui32Mid;
+        }
+        else
+        {
+            ui32High = ui32Mid - 1;
+        }
+    }
+
+    return(ui32Low);
+}
+
+//*****************************************************************************
+//
+// Marks the blocks that have to be sent: those covered by the regions listed
+// in a file, or, with no file, those that are not entirely erased.
+//
+//*****************************************************************************
+static uint8_t *
+SparseMap(const char *pcRegions, const uint8_t *pui8Image, uint32_t ui32Size)
+{
+    uint32_t ui32Blocks, ui32Block, ui32Idx, ui32Start, ui32Length, ui32Line;
+    char pcLine[256], *pcEnd;
+    uint8_t *pui8Send;
+    FILE *psFile;
+
+    ui32Blocks = (ui32Size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    pui8Send = calloc(ui32Blocks, 1);
+    if(!pui8Send)
+    {
+        return(0);
+    }
+
+    if(!pcRegions)
+    {
+        for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+        {
+            if(pui8Image[ui32Idx] != 0xff)
+            {
+                pui8Send[ui32Idx / BLOCK_SIZE] = 1;
+                ui32Idx |= BLOCK_SIZE - 1;
+            }
+        }
+        return(pui8Send);
+    }
+
+    psFile = fopen(pcRegions, "r");
+    if(!psFile)
+    {
+        perror(pcRegions);
+        return(0);
+    }
+    for(ui32Line = 1; fgets(pcLine, sizeof(pcLine), psFile); ui32Line++)
+    {
+        ui32Start = strtoul(pcLine, &pcEnd, 0);
+        ui32Length = strtoul(pcEnd, &pcEnd, 0);
+        if(ui32Start < g_sOptions.ui32Address)
+        {
+            fprintf(stderr, "%s:%u: region is below the image\n",
+                    pcRegions, ui32Line);
+            fclose(psFile);
+            return(0);
+        }
+        ui32Start -= g_sOptions.ui32Address;
+        for(ui32Block = ui32Start / BLOCK_SIZE;
+            (ui32Block < ui32Blocks) &&
+            ((ui32Block * BLOCK_SIZE) < (ui32Start + ui32Length));
+            ui32Block++)
+        {
+            pui8Send[ui32Block] = 1;
+        }
+    }
+    fclose(psFile);
+
+    return(pui8Send);
+}
+
+//*****************************************************************************
+//
+// Opens a serial port in raw, non-blocking mode at the given baud rate.
+//
+//*****************************************************************************
+static int
+PortOpen(const char *pcPort, uint32_t ui32Baud)
+{
+    static const struct
+    {
+        uint32_t ui32Baud;
+        speed_t sSpeed;
+    }
+    psBauds[] =
+    {
+        { 9600, B9600 }, { 19200, B19200 }, { 38400, B38400 },
+        { 57600, B57600 }, { 115200, B115200 }, { 230400, B230400 },
+        { 460800, B460800 }, { 921600, B921600 }, { 1000000, B1000000 },
+        { 2000000, B2000000 }, { 3000000, B3000000 }
+    };
+    struct termios sTermios;
+    uint32_t ui32Idx;
+    int iFd;
+
+    for(ui32Idx = 0; ui32Idx < (sizeof(psBauds) / sizeof(psBauds[0]));
+        ui32Idx++)
+    {
+        if(psBauds[ui32Idx].ui32Baud == ui32Baud)
+        {
+            break;
+        }
+    }
+    if(ui32Idx == (sizeof(psBauds) / sizeof(psBauds[0])))
+    {
+        fprintf(stderr, "blupdate: unsupported baud rate %u\n", ui32Baud);
+        return(-1);
+    }
+
+    iFd = open(pcPort, O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if(iFd < 0)
+    {
+        perror(pcPort);
+        return(-1);
+    }
+    if(tcgetattr(iFd, &sTermios) == 0)
+    {
+        cfmakeraw(&sTermios);
+        sTermios.c_cflag |= CLOCAL | CREAD;
+        sTermios.c_cflag &= ~(CSTOPB | CRTSCTS);
+        cfsetispeed(&sTermios, psBauds[ui32Idx].sSpeed);
+        cfsetospeed(&sTermios, psBauds[ui32Idx].sSpeed);
+        if(tcsetattr(iFd, TCSANOW, &sTermios))
+        {
+            perror(pcPort);
+            close(iFd);
+            return(-1);
+        }
+    }
+    tcflush(iFd, TCIOFLUSH);
+
+    return(iFd);
+}
+
+//*****************************************************************************
+//
+// Starts sending a control frame and waiting for the reply to it.
+//
+//*****************************************************************************
+static void
+DeviceSendControl(tDevice *psDevice, uint32_t ui32Size, uint32_t ui32Timeout)
+{
+    psDevice->pui8Tx = psDevice->pui8Control;
+    psDevice->ui32TxOffset = 0;
+    psDevice->ui32TxEnd = ui32Size;
+    psDevice->ui64Deadline = TimeNow() + (ui32Timeout * 1000);
+}
+
+//*****************************************************************************
+//
+// Lets as many data frames be sent as the window allows, counting from the
+// first block that the boot loader has not accepted.
+//
+//*****************************************************************************
+static void
+DeviceWindow(tDevice *psDevice)
+{
+    const tFrames *psFrames;
+    uint32_t ui32End;
+
+    psFrames = psDevice->psFrames;
+    ui32End = (FrameFind(psFrames->pui32Block, psFrames->ui32Frames,
+                         psDevice->ui32Base) + g_sOptions.ui32Window);
+    if(ui32End > psFrames->ui32Frames)
+    {
+        ui32End = psFrames->ui32Frames;
+    }
+    psDevice->ui32TxEnd = psFrames->pui32Offset[ui32End];
+    psDevice->ui64Deadline = TimeNow() + (g_sOptions.ui32Timeout * 1000);
+}
+
+//*****************************************************************************
+//
+// Starts sending the data frames again from the first block that the boot
+// loader has not accepted.  A frame that is partly sent is finished first,
+// so that the boot loader never sees a frame cut short.
+//
+//*****************************************************************************
+static void
+DeviceRewind(tDevice *psDevice)
+{
+    const tFrames *psFrames;
+
+    psFrames = psDevice->psFrames;
+    if(psFrames->pui32Offset[FrameFind(psFrames->pui32Offset,
+                                       psFrames->ui32Frames,
+                                       psDevice->ui32TxOffset)] !=
+       psDevice->ui32TxOffset)
+    {
+        psDevice->bRewind = true;
+        return;
+    }
+
+    psDevice->bRewind = false;
+    psDevice->ui32TxOffset =
+        psFrames->pui32Offset[FrameFind(psFrames->pui32Block,
+                                        psFrames->ui32Frames,
+                                        psDevice->ui32Base)];
+    psDevice->ui32Rewind = psDevice->ui32Base + 1;
+    DeviceWindow(psDevice);
+}
+
+//*****************************************************************************
+//
+// Moves a device on to the given phase and sends the frames that start it.
+//
+//*****************************************************************************
+static void
+DevicePhase(tDevice *psDevice, uint32_t ui32Phase)
+{
+    const tFrames *psFrames;
+    uint8_t pui8Payload[11];
+    uint64_t ui64Now;
+    uint32_t ui32Size;
+
+    ui64Now = TimeNow();
+    if(psDevice->ui32Phase < NUM_PHASES)
+    {
+        psDevice->pui64PhaseEnd[psDevice->ui32Phase] = ui64Now;
+    }
+    psDevice->ui32Phase = ui32Phase;
+    psDevice->ui32Tries = 0;
+    if(ui32Phase >= NUM_PHASES)
+    {
+        return;
+    }
+    psDevice->pui64PhaseStart[ui32Phase] = ui64Now;
+
+    switch(ui32Phase)
+    {
+        case PHASE_CONNECT:
+        {
+            pui8Payload[0] = 0x00;
+            pui8Payload[1] = 0x01;
+            ui32Size = FrameBuild(psDevice->pui8Control, 0x03, 0x6001,
+                                  pui8Payload, 2);
+            DeviceSendControl(psDevice, ui32Size, g_sOptions.ui32Timeout);
+            break;
+        }
+
+        case PHASE_ERASE:
+        {
+            //
+            // Place the address and size where Updater() unpacks them from.
+            //
+            memset(pui8Payload, 0, sizeof(pui8Payload));
+            ui32Size = psDevice->psFrames->ui32Blocks * BLOCK_SIZE;
+            pui8Payload[1] = 0x04;
+            pui8Payload[4] = g_sOptions.ui32Address & 0xff;
+            pui8Payload[5] = (g_sOptions.ui32Address >> 8) & 0xff;
+            pui8Payload[6] = 0x04;
+            pui8Payload[7] = (ui32Size >> 16) & 0xff;
+            pui8Payload[8] = (ui32Size >> 24) & 0xff;
+            pui8Payload[9] = ui32Size & 0xff;
+            pui8Payload[10] = (ui32Size >> 8) & 0xff;
+            //
+            // A resume frame carries the same parameters but erases nothing.
+            //
+            ui32Size = FrameBuild(psDevice->pui8Control, 0x10,
+                                  psDevice->bResume ? 0x6009 : 0x6003,
+                                  pui8Payload, 11);
+            DeviceSendControl(psDevice, ui32Size,
+                              psDevice->bResume ? g_sOptions.ui32Timeout :
+                              g_sOptions.ui32EraseTimeout);
+            break;
+        }
+
+        case PHASE_PROGRAM:
+        {
+            psFrames = psDevice->psFrames;
+            psDevice->pui8Tx = psFrames->pui8Data;
+            psDevice->ui32TxOffset =
+                psFrames->pui32Offset[FrameFind(psFrames->pui32Block,
+                                                psFrames->ui32Frames,
+                                                psDevice->ui32Start)];
+            psDevice->ui32Base = psDevice->ui32Start;
+            psDevice->ui32Rewind = 0;
+            psDevice->bRewind = false;
+            DeviceWindow(psDevice);
+            break;
+        }
+
+        case PHASE_RESET:
+        {
+            pui8Payload[0] = 0x01;
+            ui32Size = FrameBuild(psDevice->pui8Control, 0x06, 0x6000,
+                                  pui8Payload, 1);
+            DeviceSendControl(psDevice, ui32Size, g_sOptions.ui32Timeout);
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Marks an update as failed.
+//
+//*****************************************************************************
+static void
+DeviceFail(tDevice *psDevice, const char *pcError)
+{
+    psDevice->pcError = pcError;
+    DevicePhase(psDevice, PHASE_FAILED);
+}
+
+//*****************************************************************************
+//
+// Handles the reply to a resume frame, or 0 if the boot loader answered it
+// as an unknown command.  The download carries on from the block that the
+// boot loader expects if the CRC32 of the blocks before it matches this
+// image and a data frame starts there; otherwise it starts again with the
+// download command.
+//
+//*****************************************************************************
+static void
+DeviceResume(tDevice *psDevice, const uint8_t *pui8Reply)
+{
+    const tFrames *psFrames;
+    uint32_t ui32Next;
+
+    psFrames = psDevice->psFrames;
+    psDevice->bResume = false;
+    if(pui8Reply && (pui8Reply[4] == COMMAND_RET_SUCCESS))
+    {
+        ui32Next = (pui8Reply[5] << 8) | pui8Reply[6];
+        if((ui32Next <= psFrames->ui32Blocks) &&
+           (psFrames->pui32Block[FrameFind(psFrames->pui32Block,
+                                           psFrames->ui32Frames,
+                                           ui32Next)] == ui32Next) &&
+           (ImageCRC32(psFrames, ui32Next) ==
+            (((uint32_t)pui8Reply[7] << 24) | (pui8Reply[8] << 16) |
+             (pui8Reply[9] << 8) | pui8Reply[10])))
+        {
+            psDevice->pui32PhaseFrames[PHASE_ERASE]++;
+            psDevice->pui32PhaseBytes[PHASE_ERASE] += 11;
+            psDevice->ui32Start = ui32Next;
+            fprintf(stderr, "%s: resuming at block %u of %u\n",
+                    psDevice->pcPort, ui32Next, psFrames->ui32Blocks);
+            DevicePhase(psDevice, (ui32Next == psFrames->ui32Blocks) ?
+                        PHASE_RESET : PHASE_PROGRAM);
+            return;
+        }
+    }
+
+    DevicePhase(psDevice, PHASE_ERASE);
+}
+
+//*****************************************************************************
+//
+// Handles a reply from the boot loader.
+//
+//*****************************************************************************
+static void
+DeviceReply(tDevice *psDevice, uint32_t ui32Reply, const uint8_t *pui8Reply)
+{
+    uint32_t ui32Phase, ui32Next;
+    const tFrames *psFrames;
+
+    ui32Phase = psDevice->ui32Phase;
+    if((ui32Phase == PHASE_ERASE) && psDevice->bResume)
+    {
+        if(ui32Reply == REPLY_RESUME)
+        {
+            DeviceResume(psDevice, pui8Reply);
+        }
+        else if(ui32Reply == REPLY_ACK)
+        {
+            DeviceResume(psDevice, 0);
+        }
+        return;
+    }
+
+    switch(ui32Phase)
+    {
+        case PHASE_CONNECT:
+        case PHASE_ERASE:
+        {
+            //
+            // The download command is acknowledged with the ping reply once
+            // the erase is done, and is then followed by the initial counter
+            // block or IV if the image is encrypted.
+            //
+            if((ui32Reply == REPLY_PING) && !psDevice->bIV)
+            {
+                psDevice->pui32PhaseFrames[ui32Phase]++;
+                psDevice->pui32PhaseBytes[ui32Phase] +=
+                    (ui32Phase == PHASE_CONNECT) ? 2 : 11;
+                if((ui32Phase == PHASE_ERASE) && g_sOptions.bIV)
+                {
+                    psDevice->bIV = true;
+                    psDevice->ui32Tries = 0;
+                    DeviceSendControl(psDevice,
+                                      FrameBuild(psDevice->pui8Control, 0x10,
+                                                 0x600A, g_sOptions.pui8IV,
+                                                 DECRYPT_IV_SIZE),
+                                      g_sOptions.ui32Timeout);
+                    break;
+                }
+                DevicePhase(psDevice, ui32Phase + 1);
+            }
+            else if((ui32Reply == REPLY_ACK) && psDevice->bIV)
+            {
+                psDevice->bIV = false;
+                psDevice->pui32PhaseFrames[ui32Phase]++;
+                psDevice->pui32PhaseBytes[ui32Phase] += DECRYPT_IV_SIZE;
+                DevicePhase(psDevice, ui32Phase + 1);
+            }
+            break;
+        }
+
+        case PHASE_PROGRAM:
+        {
+            if((ui32Reply == REPLY_ACK) && g_sOptions.bLegacy)
+            {
+                ui32Next = psDevice->ui32Base + 1;
+            }
+            else if((ui32Reply == REPLY_PROGRESS) && !g_sOptions.bLegacy)
+            {
+                if(pui8Reply[4] != COMMAND_RET_SUCCESS)
+                {
+                    DeviceFail(psDevice, "flash programming failed");
+                    break;
+                }
+                ui32Next = (pui8Reply[5] << 8) | pui8Reply[6];
+            }
+            else
+            {
+                break;
+            }
+
+            psFrames = psDevice->psFrames;
+            if((ui32Next > psDevice->ui32Base) &&
+               (ui32Next <= psFrames->ui32Blocks))
+            {
+                //
+                // Every block before this one has been programmed or
+                // skipped.
+                //
+                psDevice->pui32PhaseFrames[ui32Phase] +=
+                    (FrameFind(psFrames->pui32Block, psFrames->ui32Frames,
+                               ui32Next) -
+                     FrameFind(psFrames->pui32Block, psFrames->ui32Frames,
+                               psDevice->ui32Base));
+                psDevice->pui32PhaseBytes[ui32Phase] +=
+                    (ui32Next - psDevice->ui32Base) * BLOCK_SIZE;
+                psDevice->ui32Base = ui32Next;
+                psDevice->ui32Tries = 0;
+                if(ui32Next == psFrames->ui32Blocks)
+                {
+                    DevicePhase(psDevice, PHASE_RESET);
+                    break;
+                }
+                DeviceWindow(psDevice);
+            }
+            else if((ui32Next == psDevice->ui32Base) && !psDevice->bRewind &&
+                    (psDevice->ui32Rewind != (psDevice->ui32Base + 1)))
+            {
+                //
+                // A frame sent after the one the boot loader expects was
+                // answered, so the expected one was lost.  Send it and those
+                // after it again, once.
+                //
+                psDevice->ui32TotalRetries++;
+                DeviceRewind(psDevice);
+            }
+            break;
+        }
+
+        case PHASE_RESET:
+        {
+            if(ui32Reply == REPLY_ACK)
+            {
+                psDevice->pui32PhaseFrames[ui32Phase]++;
+                psDevice->pui32PhaseBytes[ui32Phase]++;
+                DevicePhase(psDevice, PHASE_DONE);
+            }
+            break;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Returns the kind of reply that starts with the given four bytes, and its
+// size.
+//
+//*****************************************************************************
+static uint32_t
+ReplyType(const uint8_t *pui8Header, uint32_t *pui32Size)
+{
+    if(pui8Header[0] != g_sOptions.ui32ID)
+    {
+        return(REPLY_NONE);
+    }
+    if((pui8Header[1] == 0x03) && (pui8Header[2] == 0x60) &&
+       (pui8Header[3] == 0x01))
+    {
+        *pui32Size = 9;
+        return(REPLY_PING);
+    }
+    if((pui8Header[1] == 0x03) && (pui8Header[2] == 0x04) &&
+       (pui8Header[3] == 0x00))
+    {
+        *pui32Size = 9;
+        return(REPLY_PROGRESS);
+    }
+    if((pui8Header[1] == 0x10) && (pui8Header[2] == 0x60) &&
+       (pui8Header[3] == 0x06))
+    {
+        *pui32Size = 8;
+        return(REPLY_ACK);
+    }
+    if((pui8Header[1] == 0x03) && (pui8Header[2] == 0x08) &&
+       (pui8Header[3] == 0x00))
+    {
+        *pui32Size = 13;
+        return(REPLY_RESUME);
+    }
+
+    return(REPLY_NONE);
+}
+
+//*****************************************************************************
+//
+// Returns true if a whole reply of the given kind and size arrived intact.
+// The progress and resume replies end with the CRC16 of the rest of them;
+// the others end with a fixed 0x11, 0x22.
+//
+//*****************************************************************************
+static bool
+ReplyIntact(uint32_t ui32Reply, const uint8_t *pui8Reply, uint32_t ui32Size)
+{
+    if((ui32Reply != REPLY_PROGRESS) && (ui32Reply != REPLY_RESUME))
+    {
+        return(true);
+    }
+
+    return(CRC16(pui8Reply, ui32Size - FRAME_CRC_SIZE) ==
+           (((uint32_t)pui8Reply[ui32Size - 2] << 8) |
+            pui8Reply[ui32Size - 1]));
+}
+
+//*****************************************************************************
+//
+// Splits the bytes received from the boot loader into replies, dropping any
+// bytes that cannot start one, and any reply that was damaged on the way,
+// which is then treated as lost.
+//
+//*****************************************************************************
+static void
+DeviceReceive(tDevice *psDevice, const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    uint32_t ui32Reply, ui32Need;
+    uint8_t *pui8Rx;
+
+    pui8Rx = psDevice->pui8Rx;
+    while(ui32Size--)
+    {
+        pui8Rx[psDevice->ui32RxCount++] = *pui8Data++;
+
+        //
+        // Drop bytes from the front until they could be the start of a
+        // reply.
+        //
+        while(psDevice->ui32RxCount &&
+              ((pui8Rx[0] != g_sOptions.ui32ID) ||
+               ((psDevice->ui32RxCount >= 4) &&
+                (ReplyType(pui8Rx, &ui32Need) == REPLY_NONE))))
+        {
+            memmove(pui8Rx, pui8Rx + 1, --psDevice->ui32RxCount);
+        }
+
+        if(psDevice->ui32RxCount >= 4)
+        {
+            ui32Reply = ReplyType(pui8Rx, &ui32Need);
+            if(psDevice->ui32RxCount == ui32Need)
+            {
+                psDevice->ui32RxCount = 0;
+                if(ReplyIntact(ui32Reply, pui8Rx, ui32Need))
+                {
+                    DeviceReply(psDevice, ui32Reply, pui8Rx);
+                }
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Handles the port being ready to read or write.
+//
+//*****************************************************************************
+static void
+DeviceService(tDevice *psDevice, bool bReadable, bool bWritable)
+{
+    uint8_t pui8Buffer[256];
+    ssize_t iCount;
+
+    if(psDevice->ui32Phase >= NUM_PHASES)
+    {
+        return;
+    }
+
+    if(bReadable)
+    {
+        iCount = read(psDevice->iFd, pui8Buffer, sizeof(pui8Buffer));
+        if(iCount > 0)
+        {
+            DeviceReceive(psDevice, pui8Buffer, iCount);
+        }
+        else if((iCount == 0) ||
+                ((errno != EAGAIN) && (errno != EINTR)))
+        {
+            DeviceFail(psDevice, "serial port closed");
+            return;
+        }
+    }
+
+    if(bWritable && (psDevice->ui32Phase < NUM_PHASES) &&
+       (psDevice->ui32TxOffset < psDevice->ui32TxEnd))
+    {
+        iCount = write(psDevice->iFd,
+                       psDevice->pui8Tx + psDevice->ui32TxOffset,
+                       psDevice->ui32TxEnd - psDevice->ui32TxOffset);
+        if(iCount > 0)
+        {
+            psDevice->ui32TxOffset += iCount;
+
+            //
+            // Send again now if that was held back by a partly sent frame.
+            //
+            if((psDevice->ui32Phase == PHASE_PROGRAM) && psDevice->bRewind)
+            {
+                DeviceRewind(psDevice);
+            }
+        }
+        else if((errno != EAGAIN) && (errno != EINTR))
+        {
+            DeviceFail(psDevice, "write to serial port failed");
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Handles the boot loader not replying in time: the frames awaiting a reply
+// are sent again until the retries run out.
+//
+//*****************************************************************************
+static void
+DeviceTimeout(tDevice *psDevice)
+{
+    if((psDevice->ui32Phase >= NUM_PHASES) ||
+       (TimeNow() < psDevice->ui64Deadline))
+    {
+        return;
+    }
+
+    if(++psDevice->ui32Tries > g_sOptions.ui32Retries)
+    {
+        if(psDevice->ui32Phase == PHASE_RESET)
+        {
+            //
+            // The boot loader may have reset before its reply got out.
+            //
+            fprintf(stderr, "%s: no reply to the reset command\n",
+                    psDevice->pcPort);
+            DevicePhase(psDevice, PHASE_DONE);
+            return;
+        }
+        DeviceFail(psDevice, (psDevice->ui32Phase == PHASE_CONNECT) ?
+                   "no reply from the boot loader" :
+                   (psDevice->ui32Phase == PHASE_ERASE) ?
+                   "download command rejected or not answered" :
+                   "too many retries");
+        return;
+    }
+    psDevice->ui32TotalRetries++;
+
+    if(psDevice->ui32Phase == PHASE_PROGRAM)
+    {
+        psDevice->ui64Deadline = TimeNow() + (g_sOptions.ui32Timeout * 1000);
+        DeviceRewind(psDevice);
+    }
+    else
+    {
+        DeviceSendControl(psDevice, psDevice->ui32TxEnd,
+                          (psDevice->ui32Phase == PHASE_ERASE) ?
+                          g_sOptions.ui32EraseTimeout :
+                          g_sOptions.ui32Timeout);
+    }
+}
+
+//*****************************************************************************
+//
+// Prints the time taken by each phase of an update.
+//
+//*****************************************************************************
+static void
+DeviceReport(FILE *psOut, const tDevice *psDevice, uint32_t ui32Size)
+{
+    uint32_t ui32Phase, ui32Frames, ui32Bytes;
+    double dSeconds;
+
+    fprintf(psOut, "%s: %s\n", psDevice->pcPort,
+            (psDevice->ui32Phase == PHASE_DONE) ? "updated" :
+            psDevice->pcError);
+    fprintf(psOut, "%-9s %8s %10s %12s %12s %10s\n", "phase", "frames",
+            "bytes", "time (ms)", "bytes/s", "frames/s");
+    ui32Frames = 0;
+    ui32Bytes = 0;
+    for(ui32Phase = 0; ui32Phase < NUM_PHASES; ui32Phase++)
+    {
+        dSeconds = 0.0;
+        if(psDevice->pui64PhaseEnd[ui32Phase] >
+           psDevice->pui64PhaseStart[ui32Phase])
+        {
+            dSeconds = ((psDevice->pui64PhaseEnd[ui32Phase] -
+                         psDevice->pui64PhaseStart[ui32Phase]) / 1000000.0);
+        }
+        fprintf(psOut, "%-9s %8u %10u %12.3f %12.0f %10.1f\n",
+                g_ppcPhaseNames[ui32Phase],
+                psDevice->pui32PhaseFrames[ui32Phase],
+                psDevice->pui32PhaseBytes[ui32Phase], dSeconds * 1000.0,
+                dSeconds ? (psDevice->pui32PhaseBytes[ui32Phase] /
+                            dSeconds) : 0.0,
+                dSeconds ? (psDevice->pui32PhaseFrames[ui32Phase] /
+                            dSeconds) : 0.0);
+        ui32Frames += psDevice->pui32PhaseFrames[ui32Phase];
+        ui32Bytes += psDevice->pui32PhaseBytes[ui32Phase];
+    }
+    if(psDevice->ui32Phase == PHASE_DONE)
+    {
+        dSeconds = ((psDevice->pui64PhaseEnd[PHASE_RESET] -
+                     psDevice->pui64PhaseStart[PHASE_CONNECT]) / 1000000.0);
+        fprintf(psOut, "%-9s %8u %10u %12.3f %12.0f %10.1f\n", "total",
+                ui32Frames, ui32Bytes, dSeconds * 1000.0, ui32Size / dSeconds,
+                ui32Frames / dSeconds);
+    }
+    fprintf(psOut, "retries:   %u\n", psDevice->ui32TotalRetries);
+}
+
+//*****************************************************************************
+//
+// Writes a device's report to <dir>/<port name>.log.
+//
+//*****************************************************************************
+static void
+DeviceLog(const char *pcDir, const tDevice *psDevice, uint32_t ui32Size)
+{
+    char pcPath[PATH_MAX], pcPort[PATH_MAX];
+    FILE *psFile;
+
+    strncpy(pcPort, psDevice->pcPort, sizeof(pcPort) - 1);
+    pcPort[sizeof(pcPort) - 1] = 0;
+    snprintf(pcPath, sizeof(pcPath), "%s/%s.log", pcDir, basename(pcPort));
+    psFile = fopen(pcPath, "w");
+    if(!psFile)
+    {
+        perror(pcPath);
+        return;
+    }
+    DeviceReport(psFile, psDevice, ui32Size);
+    fclose(psFile);
+}
+
+//*****************************************************************************
+//
+// Updates the progress line: the ports finished and the share of all the
+// blocks that have been programmed.
+//
+//*****************************************************************************
+static void
+Progress(const tDevice *psDevices, uint32_t ui32Devices, bool bFinal)
+{
+    uint32_t ui32Idx, ui32Done, ui32Failed;
+    uint64_t ui64Blocks, ui64Total;
+
+    ui32Done = 0;
+    ui32Failed = 0;
+    ui64Blocks = 0;
+    ui64Total = 0;
+    for(ui32Idx = 0; ui32Idx < ui32Devices; ui32Idx++)
+    {
+        ui64Total += psDevices[ui32Idx].psFrames->ui32Blocks;
+        if(psDevices[ui32Idx].ui32Phase == PHASE_DONE)
+        {
+            ui32Done++;
+            ui64Blocks += psDevices[ui32Idx].psFrames->ui32Blocks;
+        }
+        else if(psDevices[ui32Idx].ui32Phase == PHASE_FAILED)
+        {
+            ui32Failed++;
+        }
+        else if(psDevices[ui32Idx].ui32Phase >= PHASE_PROGRAM)
+        {
+            ui64Blocks += psDevices[ui32Idx].ui32Base;
+        }
+    }
+
+    fprintf(stderr, "\r%3u%%  %u of %u updated, %u failed%s",
+            (uint32_t)((ui64Blocks * 100) / ui64Total), ui32Done,
+            ui32Devices, ui32Failed, bFinal ? "\n" : "");
+}
+
+//*****************************************************************************
+//
+// Waits up to the given number of microseconds for bytes from a port, and
+// reads as many as fit.  Returns the number read, which is zero on a
+// timeout, or -1 on an error.
+//
+//*****************************************************************************
+static int
+PortRead(int iFd, uint8_t *pui8Data, uint32_t ui32Size, uint64_t ui64Timeout)
+{
+    struct pollfd sPoll;
+    int iCount;
+
+    sPoll.fd = iFd;
+    sPoll.events = POLLIN;
+    iCount = poll(&sPoll, 1, (int)((ui64Timeout + 999) / 1000));
+    if(iCount <= 0)
+    {
+        return(((iCount < 0) && (errno != EINTR)) ? -1 : 0);
+    }
+    iCount = read(iFd, pui8Data, ui32Size);
+    if(iCount < 0)
+    {
+        return(((errno == EAGAIN) || (errno == EINTR)) ? 0 : -1);
+    }
+
+    return(iCount ? iCount : -1);
+}
+
+//*****************************************************************************
+//
+// Writes all of a frame to a port.  Returns false on an error.
+//
+//*****************************************************************************
+static bool
+PortWrite(int iFd, const uint8_t *pui8Data, uint32_t ui32Size)
+{
+    struct pollfd sPoll;
+    int iCount;
+
+    while(ui32Size)
+    {
+        iCount = write(iFd, pui8Data, ui32Size);
+        if(iCount < 0)
+        {
+            if((errno != EAGAIN) && (errno != EINTR))
+            {
+                return(false);
+            }
+            sPoll.fd = iFd;
+            sPoll.events = POLLOUT;
+            poll(&sPoll, 1, 100);
+            continue;
+        }
+        pui8Data += iCount;
+        ui32Size -= iCount;
+    }
+
+    return(true);
+}
+
+//*****************************************************************************
+//
+// Asks the boot loader for a region of flash and receives the frames that it
+// streams back into pui8Data, starting from the byte at *pui32Done and
+// advancing *pui32Done past each frame that arrives intact.  Frames are
+// picked out of the stream by their header, so that noise between them is
+// passed over.  Returns the status of a refusal, COMMAND_RET_SUCCESS once
+// the whole region has arrived, or 0 if a frame was damaged or did not
+// arrive in time, in which case the stream is drained so that the region
+// can be asked for again.
+//
+//*****************************************************************************
+static uint32_t
+DumpRequest(int iFd, uint32_t ui32Address, uint32_t ui32Size,
+            uint8_t *pui8Data, uint32_t *pui32Done)
+{
+    uint8_t pui8Frame[DUMP_HEADER_SIZE + DUMP_FRAME_SIZE + FRAME_CRC_SIZE];
+    uint8_t pui8Payload[8];
+    uint32_t ui32Count, ui32Length, ui32Start, ui32Left;
+    uint64_t ui64Frame, ui64Deadline, ui64Now;
+    int iCount;
+
+    //
+    // Ask for what is left of the region.
+    //
+    ui32Start = ui32Address + *pui32Done;
+    ui32Left = ui32Size - *pui32Done;
+    pui8Payload[0] = ui32Start >> 24;
+    pui8Payload[1] = (ui32Start >> 16) & 0xff;
+    pui8Payload[2] = (ui32Start >> 8) & 0xff;
+    pui8Payload[3] = ui32Start & 0xff;
+    pui8Payload[4] = ui32Left >> 24;
+    pui8Payload[5] = (ui32Left >> 16) & 0xff;
+    pui8Payload[6] = (ui32Left >> 8) & 0xff;
+    pui8Payload[7] = ui32Left & 0xff;
+    tcflush(iFd, TCIFLUSH);
+    ui32Count = FrameBuild(pui8Frame, 0x03, 0x600E, pui8Payload, 8);
+    if(!PortWrite(iFd, pui8Frame, ui32Count))
+    {
+        return(0);
+    }
+
+    //
+    // Each frame has the reply timeout, plus the time that a whole frame
+    // takes on the line, to arrive in.
+    //
+    ui64Frame = ((uint64_t)g_sOptions.ui32Timeout * 1000) +
+                (((uint64_t)sizeof(pui8Frame) * 10 * 1000000) /
+                 g_sOptions.ui32Baud);
+    ui64Deadline = TimeNow() + ui64Frame;
+    ui32Count = 0;
+    while(1)
+    {
+        //
+        // Pass over bytes until they start with a header for this register,
+        // and then wait for the rest of the frame.
+        //
+        while((ui32Count >= FRAME_HEADER_SIZE) &&
+              ((pui8Frame[0] != g_sOptions.ui32ID) ||
+               (pui8Frame[1] != 0x03) || (pui8Frame[2] != 0x60) ||
+               (pui8Frame[3] != 0x0E)))
+        {
+            memmove(pui8Frame, pui8Frame + 1, --ui32Count);
+        }
+        ui32Length = 0;
+        if(ui32Count >= DUMP_HEADER_SIZE)
+        {
+            ui32Length = (pui8Frame[9] << 8) | pui8Frame[10];
+            if(ui32Length > DUMP_FRAME_SIZE)
+            {
+                break;
+            }
+            if(ui32Count >= (DUMP_HEADER_SIZE + ui32Length + FRAME_CRC_SIZE))
+            {
+                //
+                // A whole frame: it must have a good CRC16 and either be a
+                // refusal or carry the next bytes of the region.
+                //
+                if(CRC16(pui8Frame, DUMP_HEADER_SIZE + ui32Length) !=
+                   (uint32_t)((pui8Frame[DUMP_HEADER_SIZE + ui32Length] <<
+                               8) |
+                              pui8Frame[DUMP_HEADER_SIZE + ui32Length + 1]))
+                {
+                    break;
+                }
+                if(pui8Frame[4] != COMMAND_RET_SUCCESS)
+                {
+                    return(pui8Frame[4]);
+                }
+                if(((uint32_t)((pui8Frame[5] << 24) | (pui8Frame[6] << 16) |
+                               (pui8Frame[7] << 8) | pui8Frame[8]) !=
+                    (ui32Address + *pui32Done)) || !ui32Length ||
+                   (ui32Length > (ui32Size - *pui32Done)))
+                {
+                    break;
+                }
+                memcpy(pui8Data + *pui32Done, pui8Frame + DUMP_HEADER_SIZE,
+                       ui32Length);
+                *pui32Done += ui32Length;
+                if(*pui32Done == ui32Size)
+                {
+                    return(COMMAND_RET_SUCCESS);
+                }
+                ui32Length += DUMP_HEADER_SIZE + FRAME_CRC_SIZE;
+                ui32Count -= ui32Length;
+                memmove(pui8Frame, pui8Frame + ui32Length, ui32Count);
+                ui64Deadline = TimeNow() + ui64Frame;
+                continue;
+            }
+        }
+
+        ui64Now = TimeNow();
+        if(ui64Now >= ui64Deadline)
+        {
+            break;
+        }
+        iCount = PortRead(iFd, pui8Frame + ui32Count,
+                          sizeof(pui8Frame) - ui32Count,
+                          ui64Deadline - ui64Now);
+        if(iCount < 0)
+        {
+            return(0);
+        }
+        ui32Count += iCount;
+    }
+
+    //
+    // Let the rest of the stream go by, until the line has been quiet for
+    // the reply timeout.
+    //
+    while(PortRead(iFd, pui8Frame, sizeof(pui8Frame),
+                   (uint64_t)g_sOptions.ui32Timeout * 1000) > 0)
+    {
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+// Reads a region of flash back over a port and writes it to a file or, with
+// bCompare, compares it with the file, reporting each run of bytes that
+// differ.  Returns the exit status.
+//
+//*****************************************************************************
+static int
+Dump(const char *pcPort, uint32_t ui32Address, uint32_t ui32Size,
+     const char *pcFile, bool bCompare)
+{
+    uint32_t ui32Done, ui32Tries, ui32Retries, ui32Status, ui32Idx, ui32Ref;
+    uint32_t ui32Diffs, ui32Runs;
+    uint8_t *pui8Data, *pui8Ref, ui8Expect;
+    uint64_t ui64Start, ui64Time;
+    FILE *psFile;
+    int iFd;
+
+    pui8Data = malloc(ui32Size);
+    if(!pui8Data)
+    {
+        fprintf(stderr, "blupdate: out of memory\n");
+        return(1);
+    }
+
+    //
+    // Read the file to compare with first, so that a missing one is found
+    // before the port is touched.
+    //
+    pui8Ref = 0;
+    ui32Ref = 0;
+    if(bCompare)
+    {
+        psFile = fopen(pcFile, "rb");
+        if(!psFile)
+        {
+            perror(pcFile);
+            return(1);
+        }
+        fseek(psFile, 0, SEEK_END);
+        ui32Ref = ftell(psFile);
+        fseek(psFile, 0, SEEK_SET);
+        pui8Ref = malloc(ui32Ref ? ui32Ref : 1);
+        if(!pui8Ref || (fread(pui8Ref, 1, ui32Ref, psFile) != ui32Ref))
+        {
+            fprintf(stderr, "blupdate: unable to read %s\n", pcFile);
+            return(1);
+        }
+        fclose(psFile);
+    }
+
+    iFd = PortOpen(pcPort, g_sOptions.ui32Baud);
+    if(iFd < 0)
+    {
+        return(1);
+    }
+
+    //
+    // Read the region, asking again from the first missing byte whenever
+    // the stream is broken.  Only a read that makes no progress at all
+    // counts towards the retries.
+    //
+    ui64Start = TimeNow();
+    ui32Done = 0;
+    ui32Tries = 0;
+    ui32Retries = 0;
+    while(1)
+    {
+        ui32Idx = ui32Done;
+        ui32Status = DumpRequest(iFd, ui32Address, ui32Size, pui8Data,
+                                 &ui32Done);
+        if(ui32Status)
+        {
+            break;
+        }
+        ui32Tries = (ui32Done == ui32Idx) ? (ui32Tries + 1) : 0;
+        if(ui32Tries > g_sOptions.ui32Retries)
+        {
+            break;
+        }
+        ui32Retries++;
+    }
+    ui64Time = TimeNow() - ui64Start;
+    close(iFd);
+
+    if(ui32Status != COMMAND_RET_SUCCESS)
+    {
+        fprintf(stderr, "%s: %s after %u of %u bytes\n", pcPort,
+                (ui32Status == COMMAND_RET_INVALID_ADR) ?
+                "region is outside flash or execute-only" :
+                (ui32Status == COMMAND_RET_INVALID_CMD) ?
+                "flash is read protected" :
+                (ui32Status == COMMAND_RET_UNKNOWN_CMD) ?
+                "boot loader does not support read back" :
+                "no intact reply", ui32Done, ui32Size);
+        return(1);
+    }
+    printf("dump:      %u bytes from 0x%08x in %.3f ms, %.0f bytes/s, "
+           "%u retries\n", ui32Size, ui32Address, ui64Time / 1000.0,
+           ui64Time ? ((ui32Size * 1000000.0) / ui64Time) : 0.0,
+           ui32Retries);
+
+    //
+    // Write the region out, or compare it with the file.
+    //
+    if(!bCompare)
+    {
+        psFile = fopen(pcFile, "wb");
+        if(!psFile || (fwrite(pui8Data, 1, ui32Size, psFile) != ui32Size) ||
+           fclose(psFile))
+        {
+            perror(pcFile);
+            return(1);
+        }
+        return(0);
+    }
+    ui32Diffs = 0;
+    ui32Runs = 0;
+    for(ui32Idx = 0; ui32Idx < ui32Size; ui32Idx++)
+    {
+        ui8Expect = (ui32Idx < ui32Ref) ? pui8Ref[ui32Idx] : 0xff;
+        if(pui8Data[ui32Idx] == ui8Expect)
+        {
+            continue;
+        }
+        if(!ui32Diffs || (pui8Data[ui32Idx - 1] ==
+                          ((ui32Idx - 1 < ui32Ref) ? pui8Ref[ui32Idx - 1] :
+                                                     0xff)))
+        {
+            ui32Runs++;
+            printf("differs:   0x%08x\n", ui32Address + ui32Idx);
+        }
+        ui32Diffs++;
+    }
+    if(ui32Ref > ui32Size)
+    {
+        printf("compare:   %u bytes of %s past the region not read\n",
+               ui32Ref - ui32Size, pcFile);
+    }
+    printf("compare:   %u bytes differ in %u runs, %s\n", ui32Diffs,
+           ui32Runs, ui32Diffs ? "FAILED" : "ok");
+
+    return(ui32Diffs ? 1 : 0);
+}
+
+//*****************************************************************************
+//
+// Prints the options.
+//
+//*****************************************************************************
+static void
+Usage(void)
+{
+    fprintf(stderr,
+            "usage: blupdate -p <port> [-p <port>...] [options] <image.bin>\n"
+            "       blupdate -p <port> -D <addr>:<size> [-x] [options] "
+            "<file.bin>\n"
+            "  -b <baud>    baud rate (default 115200)\n"
+            "  -a <addr>    address to program the image at "
+            "(default 0x8000)\n"
+            "  -i <id>      boot loader node ID (default 0x21)\n"
+            "  -w <frames>  data frames in flight (default 1)\n"
+            "  -t <ms>      reply timeout (default 500)\n"
+            "  -e <ms>      download command (erase) timeout "
+            "(default 10000)\n"
+            "  -r <count>   retries before giving up (default 5)\n"
+            "  -l           send unnumbered 0x6006 frames, one at a time\n"
+            "  -L <dir>     also write each port's report to "
+            "<dir>/<port>.log\n"
+            "  -s           skip blocks that are entirely erased\n"
+            "  -R <file>    send only the blocks in a region list\n"
+            "  -c           resume an interrupted download if possible\n"
+            "  -k <iv>      the image is encrypted from this initial "
+            "counter block\n"
+            "               or IV, given as 32 hex digits\n"
+            "  -D <a>:<s>   read <s> bytes of flash back from <a> into "
+            "<file.bin>\n"
+            "  -x           with -D, compare the flash with <file.bin> "
+            "instead\n");
+    exit(2);
+}
+
+//*****************************************************************************
+//
+// Updates the epoll registration of a device to wait for the port to become
+// writable only while there is something to write.
+//
+//*****************************************************************************
+static void
+DeviceEvents(int iEpoll, tDevice *psDevice)
+{
+    struct epoll_event sEvent;
+    uint32_t ui32Events;
+
+    ui32Events = 0;
+    if(psDevice->ui32Phase < NUM_PHASES)
+    {
+        ui32Events = EPOLLIN;
+        if(psDevice->ui32TxOffset < psDevice->ui32TxEnd)
+        {
+            ui32Events |= EPOLLOUT;
+        }
+    }
+    if(ui32Events == psDevice->ui32Events)
+    {
+        return;
+    }
+
+    sEvent.events = ui32Events;
+    sEvent.data.ptr = psDevice;
+    epoll_ctl(iEpoll, ui32Events ? EPOLL_CTL_MOD : EPOLL_CTL_DEL,
+              psDevice->iFd, &sEvent);
+    psDevice->ui32Events = ui32Events;
+}
+
+//*****************************************************************************
+//
+// Reads the image, frames the update and runs it on every port.
+//
+//*****************************************************************************
+int
+main(int argc, char *argv[])
+{
+    static tDevice psDevices[MAX_DEVICES];
+    struct epoll_event psEvents[MAX_DEVICES], sEvent;
+    uint32_t ui32Size, ui32Devices, ui32Idx, ui32Active, ui32Done;
+    uint64_t ui64Now, ui64Deadline, ui64Start, ui64Progress;
+    const char *pcLogDir, *pcRegions, *pcDump;
+    uint8_t *pui8Image, *pui8Send;
+    tDevice *psDevice;
+    tFrames sFrames;
+    FILE *psFile;
+    uint32_t ui32DumpAddress, ui32DumpSize;
+    int iOpt, iTimeout, iEpoll, iCount;
+    bool bProgress, bCompare;
+    char *pcEnd;
+
+    g_sOptions.ui32Baud = 115200;
+    g_sOptions.ui32Address = 0x8000;
+    g_sOptions.ui32ID = 0x21;
+    g_sOptions.ui32Window = 1;
+    g_sOptions.ui32Timeout = 500;
+    g_sOptions.ui32EraseTimeout = 10000;
+    g_sOptions.ui32Retries = 5;
+    ui32Devices = 0;
+    pcLogDir = 0;
+    pcRegions = 0;
+    pcDump = 0;
+    bCompare = false;
+    while((iOpt = getopt(argc, argv, "p:b:a:i:w:t:e:r:lL:sR:ck:D:x")) != -1)
+    {
+        switch(iOpt)
+        {
+            case 'p':
+                if(ui32Devices == MAX_DEVICES)
+                {
+                    fprintf(stderr, "blupdate: at most %u ports\n",
+                            MAX_DEVICES);
+                    return(2);
+                }
+                psDevices[ui32Devices++].pcPort = optarg;
+                break;
+            case 'b': g_sOptions.ui32Baud = strtoul(optarg, 0, 0); break;
+            case 'a': g_sOptions.ui32Address = strtoul(optarg, 0, 0); break;
+            case 'i': g_sOptions.ui32ID = strtoul(optarg, 0, 0); break;
+            case 'w': g_sOptions.ui32Window = strtoul(optarg, 0, 0); break;
+            case 't': g_sOptions.ui32Timeout = strtoul(optarg, 0, 0); break;
+            case 'e':
+                g_sOptions.ui32EraseTimeout = strtoul(optarg, 0, 0);
+                break;
+            case 'r': g_sOptions.ui32Retries = strtoul(optarg, 0, 0); break;
+            case 'l': g_sOptions.bLegacy = true; break;
+            case 'L': pcLogDir = optarg; break;
+            case 's': g_sOptions.bSparse = true; break;
+            case 'c': g_sOptions.bResume = true; break;
+            case 'k':
+            {
+                if(strlen(optarg) != (2 * DECRYPT_IV_SIZE))
+                {
+                    Usage();
+                }
+                for(ui32Idx = 0; ui32Idx < DECRYPT_IV_SIZE; ui32Idx++)
+                {
+                    if(sscanf(optarg + (2 * ui32Idx), "%2hhx",
+                              &g_sOptions.pui8IV[ui32Idx]) != 1)
+                    {
+                        Usage();
+                    }
+                }
+                g_sOptions.bIV = true;
+                break;
+            }
+            case 'R':
+                g_sOptions.bSparse = true;
+                pcRegions = optarg;
+                break;
+            case 'D': pcDump = optarg; break;
+            case 'x': bCompare = true; break;
+            default: Usage();
+        }
+    }
+    if(!ui32Devices || (optind != (argc - 1)) ||
+       (g_sOptions.bSparse && g_sOptions.bLegacy))
+    {
+        Usage();
+    }
+    if(g_sOptions.bLegacy || !g_sOptions.ui32Window)
+    {
+        g_sOptions.ui32Window = 1;
+    }
+
+    //
+    // A read back is a single exchange with one board, and the boot loader
+    // only reads whole words.
+    //
+    if(bCompare && !pcDump)
+    {
+        Usage();
+    }
+    if(pcDump)
+    {
+        ui32DumpAddress = strtoul(pcDump, &pcEnd, 0);
+        if((*pcEnd != ':') || (ui32Devices != 1))
+        {
+            Usage();
+        }
+        ui32DumpSize = strtoul(pcEnd + 1, &pcEnd, 0);
+        if(*pcEnd || !ui32DumpSize || ((ui32DumpAddress | ui32DumpSize) & 3))
+        {
+            fprintf(stderr, "blupdate: the read back address and size must "
+                    "be multiples of 4\n");
+            return(2);
+        }
+        return(Dump(psDevices[0].pcPort, ui32DumpAddress, ui32DumpSize,
+                    argv[optind], bCompare));
+    }
+
+    //
+    // Updater() only takes the low 16 bits of the address from the download
+    // command.
+    //
+    if((g_sOptions.ui32Address > 0xffff) ||
+       (g_sOptions.ui32Address & (BLOCK_SIZE - 1)))
+    {
+        fprintf(stderr, "blupdate: the address must be a multiple of %u "
+                "below 0x10000\n", BLOCK_SIZE);
+        return(2);
+    }
+
+    //
+    // Read the image and frame it, once for every port.
+    //
+    psFile = fopen(argv[optind], "rb");
+    if(!psFile)
+    {
+        perror(argv[optind]);
+        return(1);
+    }
+    fseek(psFile, 0, SEEK_END);
+    ui32Size = ftell(psFile);
+    fseek(psFile, 0, SEEK_SET);
+    pui8Image = malloc(ui32Size ? ui32Size : 1);
+    if(!pui8Image || !ui32Size ||
+       (fread(pui8Image, 1, ui32Size, psFile) != ui32Size))
+    {
+        fprintf(stderr, "blupdate: unable to read %s\n", argv[optind]);
+        return(1);
+    }
+    fclose(psFile);
+    if(((ui32Size + BLOCK_SIZE - 1) / BLOCK_SIZE) > 0xffff)
+    {
+        fprintf(stderr, "blupdate: image too large\n");
+        return(1);
+    }
+    pui8Send = 0;
+    if(g_sOptions.bSparse)
+    {
+        pui8Send = SparseMap(pcRegions, pui8Image, ui32Size);
+        if(!pui8Send)
+        {
+            return(1);
+        }
+    }
+    if(!FramesBuild(pui8Image, ui32Size, pui8Send, &sFrames))
+    {
+        fprintf(stderr, "blupdate: out of memory\n");
+        return(1);
+    }
+    if(g_sOptions.bSparse)
+    {
+        printf("sparse:    %u frames for %u blocks, %u bytes to send\n",
+               sFrames.ui32Frames, sFrames.ui32Blocks,
+               sFrames.pui32Offset[sFrames.ui32Frames]);
+    }
+
+    //
+    // Open the ports and start the update on each.  A port that cannot be
+    // opened fails without holding up the others.
+    //
+    iEpoll = epoll_create1(0);
+    if(iEpoll < 0)
+    {
+        perror("epoll_create1");
+        return(1);
+    }
+    for(ui32Idx = 0; ui32Idx < ui32Devices; ui32Idx++)
+    {
+        psDevice = &psDevices[ui32Idx];
+        psDevice->psFrames = &sFrames;
+        psDevice->bResume = g_sOptions.bResume && !g_sOptions.bIV;
+        psDevice->ui32Phase = PHASE_FAILED;
+        psDevice->iFd = PortOpen(psDevice->pcPort, g_sOptions.ui32Baud);
+        if(psDevice->iFd < 0)
+        {
+            psDevice->pcError = "unable to open the port";
+            continue;
+        }
+        sEvent.events = EPOLLIN;
+        sEvent.data.ptr = psDevice;
+        epoll_ctl(iEpoll, EPOLL_CTL_ADD, psDevice->iFd, &sEvent);
+        psDevice->ui32Events = EPOLLIN;
+        DevicePhase(psDevice, PHASE_CONNECT);
+        DeviceEvents(iEpoll, psDevice);
+    }
+
+    //
+    // Service the ports until every update has finished one way or the
+    // other.
+    //
+    bProgress = (ui32Devices > 1) && isatty(2);
+    ui64Start = TimeNow();
+    ui64Progress = ui64Start;
+    while(1)
+    {
+        //
+        // Wait no longer than the earliest reply deadline, or the next
+        // progress update.
+        //
+        ui64Now = TimeNow();
+        ui64Deadline = bProgress ? (ui64Progress + PROGRESS_INTERVAL) : 0;
+        ui32Active = 0;
+        for(ui32Idx = 0; ui32Idx < ui32Devices; ui32Idx++)
+        {
+            if(psDevices[ui32Idx].ui32Phase < NUM_PHASES)
+            {
+                ui32Active++;
+                if(!ui64Deadline ||
+                   (psDevices[ui32Idx].ui64Deadline < ui64Deadline))
+                {
+                    ui64Deadline = psDevices[ui32Idx].ui64Deadline;
+                }
+            }
+        }
+        if(!ui32Active)
+        {
+            break;
+        }
+        iTimeout = (ui64Deadline > ui64Now) ?
+                   (int)((ui64Deadline - ui64Now + 999) / 1000) : 0;
+
+        iCount = epoll_wait(iEpoll, psEvents, MAX_DEVICES, iTimeout);
+        if(iCount < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            perror("epoll_wait");
+            return(1);
+        }
+        while(iCount--)
+        {
+            DeviceService(psEvents[iCount].data.ptr,
+                          (psEvents[iCount].events &
+                           (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0,
+                          (psEvents[iCount].events & EPOLLOUT) != 0);
+        }
+        for(ui32Idx = 0; ui32Idx < ui32Devices; ui32Idx++)
+        {
+            DeviceTimeout(&psDevices[ui32Idx]);
+            DeviceEvents(iEpoll, &psDevices[ui32Idx]);
+        }
+
+        if(bProgress && (TimeNow() >= (ui64Progress + PROGRESS_INTERVAL)))
+        {
+            ui64Progress = TimeNow();
+            Progress(psDevices, ui32Devices, false);
+        }
+    }
+    if(bProgress)
+    {
+        Progress(psDevices, ui32Devices, true);
+    }
+
+    //
+    // Report on each port, and on the station as a whole.
+    //
+    ui32Done = 0;
+    for(ui32Idx = 0; ui32Idx < ui32Devices; ui32Idx++)
+    {
+        psDevice = &psDevices[ui32Idx];
+        if(psDevice->iFd >= 0)
+        {
+            close(psDevice->iFd);
+        }
+        if(ui32Idx)
+        {
+            printf("\n");
+        }
+        DeviceReport(stdout, psDevice, ui32Size);
+        if(pcLogDir)
+        {
+            DeviceLog(pcLogDir, psDevice, ui32Size);
+        }
+        if(psDevice->ui32Phase == PHASE_DONE)
+        {
+            ui32Done++;
+        }
+    }
+    if(ui32Devices > 1)
+    {
+        ui64Now = TimeNow();
+        printf("\n%u of %u ports updated in %.3f ms, %.0f bytes/s "
+               "overall\n", ui32Done, ui32Devices,
+               (ui64Now - ui64Start) / 1000.0,
+               ((double)ui32Done * ui32Size * 1000000.0) /
+               (ui64Now - ui64Start));
+    }
+
+    return((ui32Done == ui32Devices) ? 0 : 1);
+}